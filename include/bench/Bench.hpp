@@ -0,0 +1,193 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace server::bench
+{
+
+//! State of a running benchmark.
+//! A benchmark performs the measured operation the requested count of iterations,
+//! the runner keeps increasing the count until the measurement is long enough.
+class State final
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  //! Constructor.
+  //! @param iterations Count of the iterations to perform.
+  explicit State(uint64_t iterations) noexcept;
+
+  //! Returns the count of the iterations to perform.
+  [[nodiscard]] uint64_t GetIterations() const noexcept;
+
+  //! Sets the count of the bytes processed by a single iteration.
+  //! @param bytes Count of the bytes.
+  void SetBytesPerIteration(uint64_t bytes) noexcept;
+
+  //! Sets the count of the items processed by a single iteration.
+  //! @param items Count of the items.
+  void SetItemsPerIteration(uint64_t items) noexcept;
+
+  //! Sets a counter of a single iteration, e.g. the count of the system calls.
+  //! @param name Name of the counter.
+  //! @param value Value of the counter per iteration.
+  void SetCounter(const std::string& name, double value);
+
+  //! Pauses the timing, for the preparation the measurement should not include.
+  void PauseTiming() noexcept;
+
+  //! Resumes the paused timing.
+  void ResumeTiming() noexcept;
+
+  //! Returns the measured time.
+  [[nodiscard]] Clock::duration GetElapsed() const noexcept;
+  //! Returns the count of the bytes processed by a single iteration.
+  [[nodiscard]] uint64_t GetBytesPerIteration() const noexcept;
+  //! Returns the count of the items processed by a single iteration.
+  [[nodiscard]] uint64_t GetItemsPerIteration() const noexcept;
+  //! Returns the counters of a single iteration.
+  [[nodiscard]] const std::map<std::string, double>& GetCounters() const noexcept;
+
+  //! Starts the timing, called by the runner.
+  void Start() noexcept;
+  //! Stops the timing, called by the runner.
+  void Stop() noexcept;
+
+private:
+  uint64_t _iterations{};
+  uint64_t _bytesPerIteration{};
+  uint64_t _itemsPerIteration{};
+  std::map<std::string, double> _counters;
+
+  Clock::duration _elapsed{};
+  Clock::time_point _startedAt{};
+  bool _isRunning{false};
+};
+
+//! Keeps the value observable, so the computation of it is not optimized away.
+//! @param value Value.
+template <typename T>
+void DoNotOptimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile const void* sink;
+  sink = &value;
+#endif
+}
+
+//! Forces the pending memory writes to be performed.
+inline void ClobberMemory()
+{
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : : "memory");
+#endif
+}
+
+//! A registry of the benchmarks.
+class Registry final
+{
+public:
+  //! A benchmark function.
+  using Function = std::function<void(State& state)>;
+
+  //! A registered benchmark.
+  struct Benchmark
+  {
+    //! Name of the benchmark, slash separated from the most general part.
+    std::string name;
+    Function function;
+  };
+
+  //! Registers a benchmark.
+  //! @param name Name of the benchmark.
+  //! @param function Benchmark function.
+  void Add(std::string name, Function function);
+
+  //! Returns the registered benchmarks.
+  [[nodiscard]] const std::vector<Benchmark>& GetBenchmarks() const;
+
+private:
+  std::vector<Benchmark> _benchmarks;
+};
+
+//! Result of a benchmark.
+struct Result
+{
+  std::string name;
+  //! Count of the iterations of every repetition.
+  uint64_t iterations{};
+  //! Count of the repetitions.
+  uint32_t repetitions{};
+  //! Median time per iteration in nanoseconds.
+  double nsPerIteration{};
+  //! Fastest time per iteration in nanoseconds.
+  double minNsPerIteration{};
+  //! Slowest time per iteration in nanoseconds.
+  double maxNsPerIteration{};
+  //! Processed bytes per second, `0` if the benchmark does not report bytes.
+  double bytesPerSecond{};
+  //! Processed items per second, `0` if the benchmark does not report items.
+  double itemsPerSecond{};
+  //! Counters per iteration of the last repetition.
+  std::map<std::string, double> counters;
+};
+
+//! Options of the runner.
+struct RunOptions
+{
+  //! Minimum time of a single repetition.
+  std::chrono::duration<double> minTime{0.2};
+  //! Count of the repetitions, the median of them is reported.
+  uint32_t repetitions{5};
+};
+
+//! Runs the benchmark.
+//! The count of the iterations is calibrated until a single repetition takes
+//! at least the minimum time, then the repetitions are measured.
+//! @param benchmark Benchmark to run.
+//! @param options Options of the runner.
+//! @returns Result of the benchmark.
+[[nodiscard]] Result Run(const Registry::Benchmark& benchmark, const RunOptions& options);
+
+void RegisterStreamBenchmarks(Registry& registry);
+void RegisterCodecBenchmarks(Registry& registry);
+void RegisterMessageBenchmarks(Registry& registry);
+void RegisterDataStorageBenchmarks(Registry& registry);
+void RegisterSchedulerBenchmarks(Registry& registry);
+void RegisterLocaleBenchmarks(Registry& registry);
+void RegisterFileDataSourceBenchmarks(Registry& registry);
+void RegisterIdTableBenchmarks(Registry& registry);
+void RegisterNetworkBenchmarks(Registry& registry);
+void RegisterClientRegistryBenchmarks(Registry& registry);
+void RegisterLoggingBenchmarks(Registry& registry);
+
+} // namespace server::bench
+
+#endif // BENCH_HPP
@@ -53,8 +53,13 @@ struct Field
   {
   }
 
-  //! Deleted copy constructor.
-  Field(const Field& field) = delete;
+  //! Explicit copy constructor, the data are copied only deliberately,
+  //! such as for the read snapshots of the records.
+  explicit Field(const Field& field)
+    : _modified(field.IsModified())
+    , _value(field._value)
+  {
+  }
   //!  Deleted copy assignment operator.
   Field& operator=(const Field& field) = delete;
 
@@ -21,6 +21,7 @@
 #define DATADIRECTOR_HPP
 
 #include "DataDefinitions.hpp"
+#include "DataMemoryUsage.hpp"
 #include "DataSource.hpp"
 #include "DataStorage.hpp"
 
@@ -133,6 +134,15 @@ public:
 
   [[nodiscard]] DataSource& GetDataSource() noexcept;
 
+  //! Get data scheduler.
+  //! @return Data scheduler.
+  [[nodiscard]] Scheduler& GetScheduler() noexcept;
+
+  //! Estimates the memory usage of the storages and of the user data contexts.
+  //! Walks all the entries, must be called from the thread ticking the director.
+  //! @returns Memory usage of the subsystems of the director.
+  [[nodiscard]] util::MemoryUsageReport GetMemoryUsage() const;
+
 private:
   //! An underlying data source of the data director.
   std::unique_ptr<DataSource> _primaryDataSource;
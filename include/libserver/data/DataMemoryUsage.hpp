@@ -0,0 +1,66 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#ifndef DATAMEMORYUSAGE_HPP
+#define DATAMEMORYUSAGE_HPP
+
+#include "libserver/data/DataDefinitions.hpp"
+#include "libserver/util/MemoryUsage.hpp"
+
+namespace server
+{
+
+namespace dao
+{
+
+//! Estimates the heap size owned by the value of the field.
+template <typename T>
+[[nodiscard]] std::size_t EstimateHeapSize(const Field<T>& field) noexcept
+{
+  using util::EstimateHeapSize;
+  return EstimateHeapSize(field());
+}
+
+} // namespace dao
+
+namespace data
+{
+
+// Estimates of the heap size owned by the data, excluding the size of the data itself.
+
+[[nodiscard]] std::size_t EstimateHeapSize(const User& user) noexcept;
+[[nodiscard]] std::size_t EstimateHeapSize(const Infraction& infraction) noexcept;
+[[nodiscard]] std::size_t EstimateHeapSize(const Item& item) noexcept;
+[[nodiscard]] std::size_t EstimateHeapSize(const Pet& pet) noexcept;
+[[nodiscard]] std::size_t EstimateHeapSize(const StorageItem& storageItem) noexcept;
+[[nodiscard]] std::size_t EstimateHeapSize(const Guild& guild) noexcept;
+[[nodiscard]] std::size_t EstimateHeapSize(const Settings& settings) noexcept;
+[[nodiscard]] std::size_t EstimateHeapSize(const Character::Contacts::Group& group) noexcept;
+[[nodiscard]] std::size_t EstimateHeapSize(const Character& character) noexcept;
+[[nodiscard]] std::size_t EstimateHeapSize(const Horse& horse) noexcept;
+[[nodiscard]] std::size_t EstimateHeapSize(const Housing& housing) noexcept;
+[[nodiscard]] std::size_t EstimateHeapSize(const Egg& egg) noexcept;
+[[nodiscard]] std::size_t EstimateHeapSize(const DailyQuest& dailyQuest) noexcept;
+[[nodiscard]] std::size_t EstimateHeapSize(const Mail& mail) noexcept;
+
+} // namespace data
+
+} // namespace server
+
+#endif // DATAMEMORYUSAGE_HPP
@@ -23,11 +23,21 @@
 #include "libserver/data/DataDefinitions.hpp"
 #include "server/Config.hpp"
 
+#include <stdexcept>
 #include <string_view>
 
 namespace server
 {
 
+//! Thrown by a data source when the retrieved record does not exist,
+//! as opposed to the record existing but not being accessible.
+class RecordNotFoundError final
+  : public std::runtime_error
+{
+public:
+  using std::runtime_error::runtime_error;
+};
+
 //! A class managing a data source.
 class DataSource
 {
@@ -21,37 +21,154 @@
 #define DATASTORAGE_HPP
 
 #include "libserver/data/Record.hpp"
+#include "libserver/util/MemoryUsage.hpp"
+#include "libserver/util/Snapshot.hpp"
+#include "libserver/util/Trace.hpp"
 
 #include <atomic>
+#include <chrono>
+#include <deque>
 #include <functional>
+#include <mutex>
 #include <ranges>
 #include <shared_mutex>
 #include <span>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 
 namespace server
 {
 
+//! Result of retrieving a datum from the data source.
+enum class RetrieveResult
+{
+  //! The datum was retrieved.
+  Retrieved,
+  //! The datum does not exist in the data source.
+  Absent,
+  //! The data source failed, the retrieve may succeed when retried.
+  Failed,
+};
+
+//! Policy of the storage caching the missing data, retrying the failed retrieves
+//! and reading the data.
+struct DataStoragePolicy
+{
+  //! Time the absence of a datum is remembered for, before it is retrieved again.
+  std::chrono::steady_clock::duration absentTtl = std::chrono::seconds(30);
+  //! Maximum count of the absent and failed entries, the oldest are evicted first.
+  size_t maxNegativeEntries = 1024;
+  //! Backoff of the first retry of a failed retrieve, doubled with every failure.
+  std::chrono::steady_clock::duration retryBackoff = std::chrono::seconds(1);
+  //! Maximum backoff of the retries.
+  std::chrono::steady_clock::duration maxRetryBackoff = std::chrono::seconds(60);
+  //! Whether the records are read from immutable snapshots without a lock,
+  //! at the cost of copying the datum on every patch. Suits the read-mostly data
+  //! shared by many threads.
+  bool snapshotReads = false;
+};
+
 template <typename Key, typename Data>
 class DataStorage
 {
 public:
   using KeySpan = std::span<const Key>;
+  using Clock = std::chrono::steady_clock;
 
-  using DataSourceRetrieveListener = std::function<bool(const Key& key, Data& data)>;
+  using DataSourceRetrieveListener = std::function<RetrieveResult(const Key& key, Data& data)>;
   using DataSourceStoreListener = std::function<bool(const Key& key, Data& data)>;
   using DataSourceDeleteListener = std::function<bool(const Key& key)>;
 
   using DataSupplier = std::function<std::pair<Key, Data>()>;
 
+  //! State of an entry.
+  enum class State
+  {
+    //! The datum is being retrieved.
+    Loading,
+    //! The datum is available.
+    Present,
+    //! The datum does not exist in the data source.
+    Absent,
+    //! The retrieve failed and is retried after a backoff.
+    Failed,
+  };
+
+  //! Statistics of the storage.
+  struct Statistics
+  {
+    //! Count of the entries at the end of the last tick.
+    size_t entryCount{};
+    //! Count of the absent and failed entries at the end of the last tick.
+    size_t negativeEntryCount{};
+    //! Count of the retrieve requests processed in the last tick.
+    size_t retrieveQueueDepth{};
+    //! Count of the store requests processed in the last tick.
+    size_t storeQueueDepth{};
+    //! Count of the delete requests processed in the last tick.
+    size_t deleteQueueDepth{};
+    //! Total count of the retrieve operations.
+    uint64_t retrieveCount{};
+    //! Total count of the store operations.
+    uint64_t storeCount{};
+    //! Total count of the delete operations.
+    uint64_t deleteCount{};
+    //! Total count of the gets of the present data.
+    uint64_t hitCount{};
+    //! Total count of the gets of the data not yet retrieved.
+    uint64_t missCount{};
+    //! Total count of the gets answered by an absent or a failed entry without a retrieve.
+    uint64_t negativeHitCount{};
+    //! Total count of the retrieves of the data found absent.
+    uint64_t absentCount{};
+    //! Total count of the failed retrieves.
+    uint64_t failureCount{};
+    //! Total count of the retries of the failed retrieves.
+    uint64_t retryCount{};
+    //! Total count of the absent and failed entries evicted over the limit.
+    uint64_t evictionCount{};
+    //! Count of the replaced snapshots not yet reclaimed at the end of the last tick.
+    size_t retiredSnapshotCount{};
+  };
+
+  //! Availability of a set of data.
+  struct Availability
+  {
+    //! Count of the available data.
+    size_t availableCount{};
+    //! Count of the data being retrieved.
+    size_t pendingCount{};
+    //! Count of the data which are absent, failed to be retrieved or were not requested.
+    size_t missingCount{};
+
+    //! Returns whether all the data are available.
+    //! @returns `true` if all the data are available, `false` otherwise.
+    [[nodiscard]] bool IsComplete() const
+    {
+      return pendingCount == 0 and missingCount == 0;
+    }
+  };
+
+  //! Constructor.
+  //! @param retrieveListener Listener retrieving the data from the data source.
+  //! @param storeListener Listener storing the data to the data source.
+  //! @param deleteListener Listener deleting the data from the data source.
+  //! @param name Name of the storage in the traces, must outlive the storage.
+  //! @param policy Policy of caching the missing data, retrying the failed retrieves
+  //!               and reading the data.
   DataStorage(
     const DataSourceRetrieveListener& retrieveListener,
     const DataSourceStoreListener& storeListener,
-    const DataSourceDeleteListener& deleteListener)
+    const DataSourceDeleteListener& deleteListener,
+    std::string_view name = "storage",
+    const DataStoragePolicy& policy = {})
     : _dataSourceRetrieveListener(retrieveListener)
     , _dataSourceStoreListener(storeListener)
     , _dataSourceDeleteListener(deleteListener)
+    , _name(name)
+    , _policy(policy)
   {
   }
 
@@ -63,14 +180,17 @@ public:
   {
     _storeQueue.clear();
     _retrieveQueue.clear();
+    _reclaimQueue.clear();
 
     for (auto& entry : _entries)
     {
-      if (entry.second.available)
+      if (entry.second.state == State::Present)
         _dataSourceStoreListener(entry.first, entry.second.value);
     }
 
     _entries.clear();
+    _negativeKeys.clear();
+    _negativeEntryCount = 0;
   }
 
   //! Whether data record is available.
@@ -81,7 +201,7 @@ public:
     const auto iterator = _entries.find(key);
     if (iterator == _entries.cend())
       return false;
-    return iterator->second.available;
+    return iterator->second.state == State::Present;
   }
 
   //! Whether data records are available.
@@ -98,91 +218,143 @@ public:
     return true;
   }
 
+  //! Returns the state of the entry of a datum.
+  //! @param key Key of the datum.
+  //! @returns State of the entry, or empty if the storage has no entry of the datum.
+  std::optional<State> GetState(const Key& key) const
+  {
+    const auto iterator = _entries.find(key);
+    if (iterator == _entries.cend())
+      return std::nullopt;
+    return iterator->second.state.load(std::memory_order::relaxed);
+  }
+
   Record<Data> Create(DataSupplier supplier)
   {
     auto [key, data] = supplier();
     auto [it, created] = _entries.try_emplace(key);
-    if (not created)
+
+    // Entries of the absent data may be replaced by the created datum.
+    if (not created and it->second.state != State::Absent)
       throw std::runtime_error(std::format("Entry with key {} already exists", key));
 
     auto& entry = it->second;
-    entry.value = std::move(data);
-    entry.available = true;
+    {
+      std::scoped_lock lock(entry.mutex);
+      entry.value = std::move(data);
+      OnValueReplaced(entry);
+    }
+    SetState(key, entry, State::Present);
 
     RequestStore(key);
 
-    return Record(&entry.value, &entry.mutex, [this, key]()
-      {
-        RequestStore(key);
-      });
+    return MakeRecord(*it);
   }
 
   Record<Data> GetOrCreate(DataSupplier supplier)
   {
     auto [key, data] = supplier();
     auto [it, created] = _entries.try_emplace(key);
-    if (not created)
-      return Record(&it->second.value, &it->second.mutex, [this, key]()
-      {
-        RequestStore(key);
-      });
+    if (not created and it->second.state == State::Present)
+      return MakeRecord(*it);
 
     auto& entry = it->second;
-    entry.value = std::move(data);
-    entry.available = true;
+    {
+      std::scoped_lock lock(entry.mutex);
+      entry.value = std::move(data);
+      OnValueReplaced(entry);
+    }
+    SetState(key, entry, State::Present);
 
     RequestStore(key);
 
-    return Record(&entry.value, &entry.mutex, [this, key]()
-      {
-        RequestStore(key);
-      });
+    return MakeRecord(*it);
   }
 
+  //! Returns the record of a datum.
+  //! Requests the retrieve of the datum if it was not yet retrieved, or if its absence
+  //! expired or the backoff of its failed retrieve passed.
+  //! @param key Key of the datum.
+  //! @param retrieve Whether the datum is retrieved if it is not available.
+  //! @returns Record of the datum, or empty if the datum is not available.
   std::optional<Record<Data>> Get(const Key& key, bool retrieve = true)
   {
-    auto [recordIter, created] = _entries.try_emplace(key);
-    auto& record = recordIter->second;
+    LookupCounts counts{};
+    const auto [iterator, state] = Lookup(key, retrieve, counts);
+    RecordLookups(counts);
 
-    if (created && retrieve)
-    {
-      RequestRetrieve(key);
+    if (state != State::Present)
       return std::nullopt;
-    }
-
-    if (record.available)
-      return Record(&record.value, &record.mutex, [this, key]()
-      {
-        RequestStore(key);
-      });
-    return std::nullopt;
+    return MakeRecord(*iterator);
   }
 
+  //! Returns the records of a set of data, if all of them are available.
+  //! @param keys Keys of the data.
+  //! @returns Records of the data in the order of the keys,
+  //!          or empty if any of the data is not available.
   std::optional<std::vector<Record<Data>>> Get(const KeySpan keys)
   {
-    bool isComplete = true;
-
     std::vector<Record<Data>> records;
-    for (const auto& key : keys)
+    if (not Get(keys, records).IsComplete())
+      return std::nullopt;
+    return records;
+  }
+
+  //! Gets the records of the available data of a set into caller-provided storage.
+  //! The records of the available data are provided even if some of the data are not,
+  //! and the retrieves of all the unavailable data are requested in a single pass.
+  //! The data already being retrieved are not requested again.
+  //! @param keys Keys of the data.
+  //! @param records Records of the available data in the order of the keys.
+  //!                Cleared first, its capacity is reused.
+  //! @param retrieve Whether the data are retrieved if they are not available.
+  //! @returns Availability of the data.
+  Availability Get(const KeySpan keys, std::vector<Record<Data>>& records, bool retrieve = true)
+  {
+    records.clear();
+    records.reserve(keys.size());
+
+    return Visit(keys, retrieve, [this, &records](typename EntryMap::value_type& item)
+    {
+      records.emplace_back(MakeRecord(item));
+    });
+  }
+
+  //! Views the available data of a set with immutable access, without creating their records.
+  //! Requests the retrieves of the unavailable data like `Get(KeySpan, std::vector&, bool)`.
+  //! @param keys Keys of the data.
+  //! @param consumer Consumer invoked with the key and the datum of every available datum
+  //!                 in the order of the keys, the datum is locked for shared access.
+  //! @param retrieve Whether the data are retrieved if they are not available.
+  //! @returns Availability of the data.
+  template <typename Consumer>
+  Availability View(const KeySpan keys, Consumer&& consumer, bool retrieve = true)
+  {
+    return Visit(keys, retrieve, [this, &consumer](typename EntryMap::value_type& item)
     {
-      auto record = Get(key);
-      if (not record)
+      auto& [key, entry] = item;
+      // Read the snapshot without a lock, if there is one.
+      if (_policy.snapshotReads and entry.snapshot.Read(
+        [&key, &consumer](const Data& value)
+        {
+          consumer(key, value);
+        }))
       {
-        isComplete = false;
-        continue;
+        return;
       }
 
-      records.emplace_back() = std::move(*record);
-    }
-
-    if (isComplete)
-      return records;
-    return std::nullopt;
+      std::shared_lock lock(entry.mutex);
+      consumer(key, std::as_const(entry.value));
+    });
   }
 
   void Invalidate(const Key& key)
   {
-    _entries.erase(key);
+    const auto iterator = _entries.find(key);
+    if (iterator == _entries.end())
+      return;
+
+    Erase(iterator);
   }
 
   void Delete(const Key& key)
@@ -191,12 +363,15 @@ public:
     RequestDelete(key);
   }
 
+  //! Returns the keys of the present data.
+  //! @returns Keys of the present data.
   std::vector<Key> GetKeys()
   {
     std::vector<Key> keys;
-    for (const auto& key : std::ranges::views::keys(_entries))
+    for (const auto& [key, entry] : _entries)
     {
-      keys.emplace_back(key);
+      if (entry.state == State::Present)
+        keys.emplace_back(key);
     }
     return keys;
   }
@@ -206,41 +381,368 @@ public:
     RequestStore(key);
   }
 
+  //! Returns the statistics of the storage.
+  //! Safe to call from any thread, the statistics are updated every tick.
+  //! @returns Statistics of the storage.
+  [[nodiscard]] Statistics GetStatistics() const
+  {
+    return Statistics{
+      .entryCount = _entryCount.load(std::memory_order::relaxed),
+      .negativeEntryCount = _negativeEntryGauge.load(std::memory_order::relaxed),
+      .retrieveQueueDepth = _retrieveQueueDepth.load(std::memory_order::relaxed),
+      .storeQueueDepth = _storeQueueDepth.load(std::memory_order::relaxed),
+      .deleteQueueDepth = _deleteQueueDepth.load(std::memory_order::relaxed),
+      .retrieveCount = _retrieveCount.load(std::memory_order::relaxed),
+      .storeCount = _storeCount.load(std::memory_order::relaxed),
+      .deleteCount = _deleteCount.load(std::memory_order::relaxed),
+      .hitCount = _hitCount.load(std::memory_order::relaxed),
+      .missCount = _missCount.load(std::memory_order::relaxed),
+      .negativeHitCount = _negativeHitCount.load(std::memory_order::relaxed),
+      .absentCount = _absentCount.load(std::memory_order::relaxed),
+      .failureCount = _failureCount.load(std::memory_order::relaxed),
+      .retryCount = _retryCount.load(std::memory_order::relaxed),
+      .evictionCount = _evictionCount.load(std::memory_order::relaxed),
+      .retiredSnapshotCount = _retiredSnapshotCount.load(std::memory_order::relaxed)};
+  }
+
+  //! Estimates the memory usage of the entries and the request queues.
+  //! Walks all the entries, must be called from the thread ticking the storage.
+  //! The heap owned by the data is estimated by `EstimateHeapSize` of the data type.
+  //! @returns Count of the entries and the estimated bytes.
+  [[nodiscard]] util::MemoryUsage GetMemoryUsage() const
+  {
+    using util::EstimateHeapSize;
+
+    util::MemoryUsage usage{
+      .count = _entries.size(),
+      .bytes = util::EstimateContainerHeapSize(_entries)
+        + util::EstimateContainerHeapSize(_retrieveQueue)
+        + util::EstimateContainerHeapSize(_storeQueue)
+        + util::EstimateContainerHeapSize(_deleteQueue)
+        + util::EstimateContainerHeapSize(_reclaimQueue)};
+
+    for (const auto& [key, entry] : _entries)
+    {
+      usage.bytes += EstimateHeapSize(key) + EstimateHeapSize(entry.value);
+      entry.snapshot.Read([&usage](const Data& snapshot)
+      {
+        usage.bytes += sizeof(Data) + EstimateHeapSize(snapshot);
+      });
+
+      std::scoped_lock lock(entry.version.encodedMutex);
+      if (entry.version.encoded != nullptr)
+        usage.bytes += sizeof(std::vector<std::byte>) + entry.version.encoded->capacity();
+    }
+
+    return usage;
+  }
+
   void Tick()
   {
+    _retrieveQueueDepth.store(_retrieveQueue.size(), std::memory_order::relaxed);
+    _storeQueueDepth.store(_storeQueue.size(), std::memory_order::relaxed);
+    _deleteQueueDepth.store(_deleteQueue.size(), std::memory_order::relaxed);
+
+    _retrieveCount.fetch_add(_retrieveQueue.size(), std::memory_order::relaxed);
+    _storeCount.fetch_add(_storeQueue.size(), std::memory_order::relaxed);
+    _deleteCount.fetch_add(_deleteQueue.size(), std::memory_order::relaxed);
+
+    const auto now = Clock::now();
+
+    // Perform delete operations before the retrieves, so that a datum requested again
+    // since its delete is retrieved as absent rather than read back from the source.
+    // The entries of the deleted data were already invalidated,
+    // only a datum re-created since the request is kept.
+    for (const auto& key : _deleteQueue)
+    {
+      const auto iterator = _entries.find(key);
+      if (iterator != _entries.end() and iterator->second.state == State::Present)
+        continue;
+
+      const util::trace::Span span("data_delete", _name);
+      _dataSourceDeleteListener(key);
+    }
+    _deleteQueue.clear();
+
     // Perform retrieve operations.
     for (const auto& key : _retrieveQueue)
     {
-      auto& entry = _entries[key];
+      const auto iterator = _entries.find(key);
+      // The entry might have been invalidated since the request.
+      if (iterator == _entries.end() or iterator->second.state != State::Loading)
+        continue;
+
+      auto& entry = iterator->second;
 
-      if (_dataSourceRetrieveListener(key, entry.value))
-        entry.available.store(true, std::memory_order::relaxed);
+      RetrieveResult result;
+      {
+        const util::trace::Span span("data_retrieve", _name);
+        result = _dataSourceRetrieveListener(key, entry.value);
+      }
+
+      switch (result)
+      {
+        case RetrieveResult::Retrieved:
+        {
+          OnValueReplaced(entry);
+          if (_policy.snapshotReads)
+            _reclaimQueue.insert(key);
+          entry.failedAttempts = 0;
+          SetState(key, entry, State::Present);
+          break;
+        }
+        case RetrieveResult::Absent:
+        {
+          _absentCount.fetch_add(1, std::memory_order::relaxed);
+          entry.value = Data{};
+          entry.failedAttempts = 0;
+          entry.retryAt = now + _policy.absentTtl;
+          entry.expireAt = entry.retryAt;
+          SetState(key, entry, State::Absent);
+          break;
+        }
+        case RetrieveResult::Failed:
+        {
+          _failureCount.fetch_add(1, std::memory_order::relaxed);
+          entry.value = Data{};
+          entry.retryAt = now + GetRetryBackoff(entry.failedAttempts);
+          // The failed entry is forgotten, along with its backoff,
+          // when it is not requested again for the time of an absence.
+          entry.expireAt = entry.retryAt + _policy.absentTtl;
+          ++entry.failedAttempts;
+          SetState(key, entry, State::Failed);
+          break;
+        }
+      }
     }
     _retrieveQueue.clear();
 
     // Perform store operations.
     for (const auto& key : _storeQueue)
     {
-      auto& entry = _entries[key];
+      const auto iterator = _entries.find(key);
+      if (iterator == _entries.end() or iterator->second.state != State::Present)
+        continue;
+
+      // The stored datum was patched, which published its snapshot.
+      if (_policy.snapshotReads)
+        _reclaimQueue.insert(key);
 
-      if (entry.available)
-        _dataSourceStoreListener(key, entry.value);
+      const util::trace::Span span("data_store", _name);
+      _dataSourceStoreListener(key, iterator->second.value);
     }
     _storeQueue.clear();
 
-    // Perform delete operations.
-    for (const auto& key : _deleteQueue)
+    SweepNegativeEntries(now);
+    ReclaimSnapshots();
+
+    _entryCount.store(_entries.size(), std::memory_order::relaxed);
+    _negativeEntryGauge.store(_negativeEntryCount, std::memory_order::relaxed);
+  }
+
+private:
+  struct Entry
+  {
+    std::atomic<State> state{State::Loading};
+    //! Count of the consecutive failed retrieves.
+    uint32_t failedAttempts{0};
+    //! Time after which the absent or failed datum is retrieved again.
+    Clock::time_point retryAt{};
+    //! Time after which the absent or failed entry is dropped.
+    Clock::time_point expireAt{};
+    //! Serial of the entry in the queue of the absent and failed entries.
+    uint64_t negativeSerial{0};
+    std::shared_mutex mutex{};
+    Data value;
+    //! Snapshot of the value read by the records, if the snapshot reads are enabled.
+    util::SnapshotCell<Data> snapshot;
+    //! Version of the value and its encoded form.
+    RecordVersion version;
+  };
+
+  using EntryMap = std::unordered_map<Key, Entry>;
+
+  //! Counts of the look-ups, added to the statistics once per get.
+  struct LookupCounts
+  {
+    uint64_t hitCount{};
+    uint64_t missCount{};
+    uint64_t negativeHitCount{};
+    uint64_t retryCount{};
+  };
+
+  //! Looks the entry of a datum up, requesting the retrieve of the datum if it was not
+  //! yet retrieved, or if its absence expired or the backoff of its failed retrieve passed.
+  //! @param key Key of the datum.
+  //! @param retrieve Whether the datum is retrieved if it is not available.
+  //! @param counts Counts of the look-ups to add to.
+  //! @returns Iterator of the entry and its state after the look-up.
+  //!          If there is no entry the iterator is the end one and the state is absent.
+  std::pair<typename EntryMap::iterator, State> Lookup(
+    const Key& key,
+    const bool retrieve,
+    LookupCounts& counts)
+  {
+    auto iterator = _entries.find(key);
+    if (iterator == _entries.end())
     {
-      auto& entry = _entries[key];
+      if (not retrieve)
+        return {iterator, State::Absent};
 
-      if (entry.available)
-        if (_dataSourceDeleteListener(key))
-          entry.available.store(false, std::memory_order::relaxed);
+      ++counts.missCount;
+      iterator = _entries.try_emplace(key).first;
+      RequestRetrieve(key);
+      return {iterator, State::Loading};
     }
-    _deleteQueue.clear();
+
+    auto& entry = iterator->second;
+    const auto state = entry.state.load(std::memory_order::relaxed);
+    switch (state)
+    {
+      case State::Present:
+      {
+        ++counts.hitCount;
+        break;
+      }
+      case State::Loading:
+      {
+        ++counts.missCount;
+        break;
+      }
+      case State::Absent:
+      case State::Failed:
+      {
+        if (not retrieve or Clock::now() < entry.retryAt)
+        {
+          ++counts.negativeHitCount;
+          break;
+        }
+
+        if (state == State::Failed)
+          ++counts.retryCount;
+        ++counts.missCount;
+
+        SetState(key, entry, State::Loading);
+        RequestRetrieve(key);
+        return {iterator, State::Loading};
+      }
+    }
+
+    return {iterator, state};
+  }
+
+  //! Adds the counts of the look-ups to the statistics.
+  //! @param counts Counts of the look-ups.
+  void RecordLookups(const LookupCounts& counts)
+  {
+    if (counts.hitCount > 0)
+      _hitCount.fetch_add(counts.hitCount, std::memory_order::relaxed);
+    if (counts.missCount > 0)
+      _missCount.fetch_add(counts.missCount, std::memory_order::relaxed);
+    if (counts.negativeHitCount > 0)
+      _negativeHitCount.fetch_add(counts.negativeHitCount, std::memory_order::relaxed);
+    if (counts.retryCount > 0)
+      _retryCount.fetch_add(counts.retryCount, std::memory_order::relaxed);
+  }
+
+  //! Looks the entries of a set of data up and visits the entries of the available data.
+  //! @param keys Keys of the data.
+  //! @param retrieve Whether the data are retrieved if they are not available.
+  //! @param visitor Visitor of the key and the entry of every available datum.
+  //! @returns Availability of the data.
+  template <typename Visitor>
+  Availability Visit(const KeySpan keys, const bool retrieve, Visitor&& visitor)
+  {
+    Availability availability{};
+    LookupCounts counts{};
+    for (const auto& key : keys)
+    {
+      const auto [iterator, state] = Lookup(key, retrieve, counts);
+      switch (state)
+      {
+        case State::Present:
+        {
+          ++availability.availableCount;
+          visitor(*iterator);
+          break;
+        }
+        case State::Loading:
+        {
+          ++availability.pendingCount;
+          break;
+        }
+        case State::Absent:
+        case State::Failed:
+        {
+          ++availability.missingCount;
+          break;
+        }
+      }
+    }
+
+    RecordLookups(counts);
+    return availability;
+  }
+
+  //! Makes the record of an entry.
+  //! The patch listener refers to the key of the entry, which lives as long as the value,
+  //! so that the listener never allocates.
+  //! @param item Key and entry.
+  //! @returns Record of the entry.
+  Record<Data> MakeRecord(typename EntryMap::value_type& item)
+  {
+    auto& [key, entry] = item;
+    return Record(
+      &entry.value,
+      &entry.mutex,
+      [this, key = &key]()
+      {
+        RequestStore(*key);
+      },
+      _policy.snapshotReads ? &entry.snapshot : nullptr,
+      &entry.version);
+  }
+
+  //! Publishes the replaced value of the entry as its snapshot, if the snapshot reads
+  //! are enabled, and advances its version so that its encoded form is not reused.
+  //! @param entry Entry.
+  void OnValueReplaced(Entry& entry)
+  {
+    if (_policy.snapshotReads)
+      entry.snapshot.Publish(entry.value);
+    entry.version.version.fetch_add(1, std::memory_order::release);
+  }
+
+  //! Reclaims the replaced snapshots of the entries published since, which are otherwise
+  //! reclaimed only by the next publish of the same entry. The entries keep being
+  //! reclaimed every tick until the threads reading their snapshots unpin.
+  void ReclaimSnapshots()
+  {
+    size_t retiredSnapshotCount = 0;
+    std::erase_if(_reclaimQueue, [this, &retiredSnapshotCount](const Key& key)
+    {
+      const auto iterator = _entries.find(key);
+      if (iterator == _entries.end())
+        return true;
+
+      // The records publish under the lock of the entry.
+      auto& entry = iterator->second;
+      std::scoped_lock lock(entry.mutex);
+      if (entry.snapshot.Reclaim())
+        return true;
+
+      retiredSnapshotCount += entry.snapshot.GetRetiredCount();
+      return false;
+    });
+
+    _retiredSnapshotCount.store(retiredSnapshotCount, std::memory_order::relaxed);
+  }
+
+  static bool IsNegative(const State state)
+  {
+    return state == State::Absent or state == State::Failed;
   }
 
-private:
   void RequestRetrieve(const Key& key)
   {
     _retrieveQueue.insert(key);
@@ -256,30 +758,129 @@ private:
     _deleteQueue.insert(key);
   }
 
-  enum class Event
+  //! Transitions the entry to a state, tracking the absent and failed entries.
+  //! @param key Key of the entry.
+  //! @param entry Entry.
+  //! @param state New state of the entry.
+  void SetState(const Key& key, Entry& entry, const State state)
   {
-    Store,
-    Retrieve,
-  };
+    const bool wasNegative = IsNegative(entry.state);
+    entry.state.store(state, std::memory_order::relaxed);
 
-  struct Entry
+    if (not IsNegative(state))
+    {
+      if (wasNegative)
+        --_negativeEntryCount;
+      return;
+    }
+
+    if (not wasNegative)
+      ++_negativeEntryCount;
+
+    // Queue the entry again, its previous position is stale.
+    entry.negativeSerial = ++_negativeSerial;
+    _negativeKeys.emplace_back(NegativeKey{
+      .key = key,
+      .serial = entry.negativeSerial});
+  }
+
+  void Erase(const EntryMap::iterator iterator)
   {
-    std::atomic_bool available{false};
-    std::atomic_bool dirty{false};
-    Record<Data>::PatchListener listener;
-    std::shared_mutex mutex{};
-    Data value;
+    if (IsNegative(iterator->second.state))
+      --_negativeEntryCount;
+    _entries.erase(iterator);
+  }
+
+  //! Returns the backoff of the retry after a count of failed retrieves.
+  //! @param failedAttempts Count of the previous consecutive failed retrieves.
+  //! @returns Backoff of the retry.
+  [[nodiscard]] Clock::duration GetRetryBackoff(const uint32_t failedAttempts) const
+  {
+    auto backoff = _policy.retryBackoff;
+    for (uint32_t attempt = 0; attempt < failedAttempts and backoff < _policy.maxRetryBackoff; ++attempt)
+      backoff *= 2;
+    return std::min(backoff, _policy.maxRetryBackoff);
+  }
+
+  //! Drops the expired absent and failed entries,
+  //! and evicts the oldest of them over the limit.
+  //! @param now Current time.
+  void SweepNegativeEntries(const Clock::time_point now)
+  {
+    while (not _negativeKeys.empty())
+    {
+      const auto& negativeKey = _negativeKeys.front();
+      const auto iterator = _entries.find(negativeKey.key);
+
+      // Skip the stale positions of the entries that were since retrieved,
+      // invalidated or queued again.
+      if (iterator == _entries.end()
+        or not IsNegative(iterator->second.state)
+        or iterator->second.negativeSerial != negativeKey.serial)
+      {
+        _negativeKeys.pop_front();
+        continue;
+      }
+
+      const bool isOverLimit = _negativeEntryCount > _policy.maxNegativeEntries;
+      if (not isOverLimit and now < iterator->second.expireAt)
+        break;
+
+      if (isOverLimit and now < iterator->second.expireAt)
+        _evictionCount.fetch_add(1, std::memory_order::relaxed);
+
+      Erase(iterator);
+      _negativeKeys.pop_front();
+    }
+  }
+
+  //! Position of an absent or a failed entry in the order of becoming so.
+  struct NegativeKey
+  {
+    Key key{};
+    uint64_t serial{};
   };
 
   std::unordered_set<Key> _retrieveQueue;
   std::unordered_set<Key> _storeQueue;
   std::unordered_set<Key> _deleteQueue;
-
-  std::unordered_map<Key, Entry> _entries{};
+  //! Keys of the entries whose replaced snapshots are not yet reclaimed.
+  std::unordered_set<Key> _reclaimQueue;
+
+  EntryMap _entries{};
+
+  //! Absent and failed entries in the order of becoming so, with stale positions.
+  std::deque<NegativeKey> _negativeKeys;
+  //! Count of the absent and failed entries.
+  size_t _negativeEntryCount{0};
+  //! Serial of the last queued absent or failed entry.
+  uint64_t _negativeSerial{0};
+
+  std::atomic<size_t> _entryCount{0};
+  std::atomic<size_t> _negativeEntryGauge{0};
+  std::atomic<size_t> _retrieveQueueDepth{0};
+  std::atomic<size_t> _storeQueueDepth{0};
+  std::atomic<size_t> _deleteQueueDepth{0};
+  std::atomic<uint64_t> _retrieveCount{0};
+  std::atomic<uint64_t> _storeCount{0};
+  std::atomic<uint64_t> _deleteCount{0};
+  std::atomic<uint64_t> _hitCount{0};
+  std::atomic<uint64_t> _missCount{0};
+  std::atomic<uint64_t> _negativeHitCount{0};
+  std::atomic<uint64_t> _absentCount{0};
+  std::atomic<uint64_t> _failureCount{0};
+  std::atomic<uint64_t> _retryCount{0};
+  std::atomic<uint64_t> _evictionCount{0};
+  std::atomic<size_t> _retiredSnapshotCount{0};
 
   DataSourceRetrieveListener _dataSourceRetrieveListener;
   DataSourceStoreListener _dataSourceStoreListener;
   DataSourceDeleteListener _dataSourceDeleteListener;
+
+  //! Name of the storage in the traces.
+  std::string_view _name;
+  //! Policy of caching the missing data and retrying the failed retrieves.
+  DataStoragePolicy _policy;
 };
 
 } // namespace server
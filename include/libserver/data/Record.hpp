@@ -20,18 +20,45 @@
 #ifndef ALICIA_SERVER_RECORD_HPP
 #define ALICIA_SERVER_RECORD_HPP
 
+#include "libserver/util/Snapshot.hpp"
+
+#include <atomic>
+#include <cstddef>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <shared_mutex>
 #include <utility>
+#include <vector>
 
 namespace server
 {
 
+//! Version of a record value and the serialized form of the value cached for that version.
+struct RecordVersion
+{
+  //! An encoded form of the value.
+  using Encoded = std::shared_ptr<const std::vector<std::byte>>;
+
+  //! Version of the value, advanced by every patch.
+  std::atomic<uint64_t> version{0};
+  //! Mutex of the encoded form.
+  mutable std::mutex encodedMutex;
+  //! Version of the value the encoded form was encoded from.
+  uint64_t encodedVersion{0};
+  //! The encoded form, empty if the value was not yet encoded.
+  Encoded encoded;
+};
+
 //! Record holds a non-owning pointer to any value along with the access mutex of that value.
 //! A record provies two access methods to the underlying value:
 //! - An immutable (view) access which requests a shared lock of the value.
 //! - A mutable (patch) access which requests an exclusive lock of the value.
+//! A record of a read-mostly value may be given a snapshot cell of the value,
+//! the immutable access then reads the snapshot without a lock and the mutable access
+//! publishes a copy of the patched value.
+//! A record given the version of the value caches the serialized form of the value
+//! until the value is patched.
 template <typename Data>
 class Record
 {
@@ -54,14 +81,22 @@ public:
   //! @param value Pointer to value.
   //! @param mutex Pointer to value's mutex.
   //! @param patchListener A patch listener.
+  //! @param snapshot Pointer to the snapshot cell of the value, or `nullptr`
+  //!                 if the immutable access locks the value.
+  //! @param version Pointer to the version of the value, or `nullptr`
+  //!                if the serialized form of the value is not cached.
   Record(
     Data *const value,
     std::shared_mutex *const mutex,
-    PatchListener  patchListener)
+    PatchListener  patchListener,
+    util::SnapshotCell<Data>* const snapshot = nullptr,
+    RecordVersion* const version = nullptr)
     : _mutex(mutex)
     , _lock(*_mutex, std::defer_lock)
     , _patchListener(std::move(patchListener))
     , _value(value)
+    , _snapshot(snapshot)
+    , _version(version)
   {
   }
 
@@ -77,6 +112,8 @@ public:
     , _lock(std::move(other._lock))
     , _patchListener(std::move(other._patchListener))
     , _value(other._value)
+    , _snapshot(other._snapshot)
+    , _version(other._version)
   {
   }
 
@@ -88,6 +125,8 @@ public:
     _lock = std::move(other._lock);
     _patchListener = std::move(other._patchListener);
     _value = other._value;
+    _snapshot = other._snapshot;
+    _version = other._version;
 
     return *this;
   }
@@ -117,6 +156,10 @@ public:
     if (not IsAvailable())
       throw std::runtime_error("Value of the record is unavailable");
 
+    // Read the snapshot without a lock, if there is one.
+    if (_snapshot != nullptr and _snapshot->Read(consumer))
+      return;
+
     // Lock the value for shared access.
     std::shared_lock lock(*_mutex);
     consumer(*_value);
@@ -133,9 +176,58 @@ public:
     // Lock the value for exclusive access
     std::scoped_lock lock(*_mutex);
     consumer(*_value);
+    if (_snapshot != nullptr)
+      _snapshot->Publish(*_value);
+    // The version advances once the patched value is readable,
+    // a value read after the version was read is never older.
+    if (_version != nullptr)
+      _version->version.fetch_add(1, std::memory_order::release);
     _patchListener();
   }
 
+  //! Returns the serialized form of the value, encoded on the first use
+  //! and again after the value was patched.
+  //! @param encoder Encoder appending the value to the buffer,
+  //!                must be the same for all the records of the value type.
+  //! @returns The encoded form of the value.
+  //! @throws std::runtime_error if the value is unavailable.
+  template <typename Encoder>
+  RecordVersion::Encoded GetEncoded(Encoder&& encoder) const
+  {
+    const auto encode = [this, &encoder]()
+    {
+      auto buffer = std::make_shared<std::vector<std::byte>>();
+      Immutable([&encoder, &buffer](const Data& value)
+      {
+        encoder(value, *buffer);
+      });
+      return buffer;
+    };
+
+    if (_version == nullptr)
+      return encode();
+
+    const auto version = _version->version.load(std::memory_order::acquire);
+    {
+      std::scoped_lock lock(_version->encodedMutex);
+      if (_version->encoded != nullptr and _version->encodedVersion == version)
+        return _version->encoded;
+    }
+
+    // The value read is at least of the version read before,
+    // a newer value is encoded again when next requested.
+    RecordVersion::Encoded encoded = encode();
+
+    std::scoped_lock lock(_version->encodedMutex);
+    if (_version->encoded == nullptr or _version->encodedVersion <= version)
+    {
+      _version->encoded = encoded;
+      _version->encodedVersion = version;
+    }
+
+    return encoded;
+  }
+
 private:
   //! An access mutex of the value.
   mutable std::shared_mutex* _mutex;
@@ -145,6 +237,10 @@ private:
   PatchListener _patchListener;
   //! A value.
   Data* _value;
+  //! A snapshot cell of the value.
+  util::SnapshotCell<Data>* _snapshot{nullptr};
+  //! A version of the value.
+  RecordVersion* _version{nullptr};
 };
 
 } // namespace servr
@@ -46,6 +46,13 @@ void BuildProtocolHorses(
     std::vector<Horse>& protocolHorses,
     const std::vector<Record<data::Horse>>& horseRecords);
 
+//! Appends the serialized horses, reusing the serialized form cached by each horse record.
+//! @param protocolHorses Serialized horses to append to.
+//! @param horseRecords Horse records.
+void EncodeProtocolHorses(
+  EncodedStructures& protocolHorses,
+  const std::vector<Record<data::Horse>>& horseRecords);
+
 void BuildProtocolItem(
   Item& protocolItem,
   const data::Item& item);
@@ -54,6 +61,13 @@ void BuildProtocolItems(
   std::vector<Item>& protocolItems,
   const std::vector<Record<data::Item>>& itemRecords);
 
+//! Appends the serialized items, reusing the serialized form cached by each item record.
+//! @param protocolItems Serialized items to append to.
+//! @param itemRecords Item records.
+void EncodeProtocolItems(
+  EncodedStructures& protocolItems,
+  const std::vector<Record<data::Item>>& itemRecords);
+
 void BuildProtocolStorageItem(
   StoredItem& protocolStorageItem,
   const data::StorageItem& storageItem);
@@ -0,0 +1,191 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#ifndef ADMISSION_HPP
+#define ADMISSION_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include <boost/asio/ip/address_v4.hpp>
+
+namespace server::network
+{
+
+//! Result of a connection admission.
+enum class AdmissionResult
+{
+  //! The connection was admitted.
+  Admitted,
+  //! The address has too many connections.
+  TooManyConnections,
+  //! The address connects too often.
+  RateLimited,
+  //! The address table is full of addresses with connections.
+  TableFull,
+};
+
+//! Point in time statistics of the connection admission.
+struct AdmissionStatistics
+{
+  //! Count of the admitted connections.
+  uint64_t admitted{};
+  //! Count of the connections rejected because the address had too many connections.
+  uint64_t rejectedTooManyConnections{};
+  //! Count of the connections rejected because the address connected too often.
+  uint64_t rejectedRateLimited{};
+  //! Count of the connections rejected because the address table was full.
+  uint64_t rejectedTableFull{};
+  //! Count of the admitted connections rejected because the server was full.
+  uint64_t rejectedServerFull{};
+  //! Count of the idle addresses evicted to make room for new ones.
+  uint64_t evictions{};
+  //! Count of the addresses tracked.
+  uint64_t trackedAddresses{};
+};
+
+//! Admission of the connections with a token bucket per address.
+//! The addresses are tracked in a fixed-capacity table split into shards,
+//! each with its own lock. When a shard is full, its least recently used
+//! address without connections is evicted, so the memory does not grow
+//! with the count of the distinct addresses connecting.
+class ConnectionAdmission final
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  //! Limits of the admission.
+  struct Limits
+  {
+    //! Maximum count of the connections of an address.
+    uint32_t maxConnectionsPerAddress = 3;
+    //! Count of the connections an address may make in a burst.
+    uint32_t burst = 10;
+    //! Period in which an address regains one connection of its burst.
+    Clock::duration refillPeriod = std::chrono::seconds(3);
+    //! Count of the addresses tracked, rounded up to a multiple of the shard count.
+    uint32_t addressCapacity = 4096;
+  };
+
+  //! Default constructor with the default limits.
+  ConnectionAdmission();
+  //! Constructor.
+  //! @param limits Limits of the admission.
+  explicit ConnectionAdmission(Limits limits);
+
+  ConnectionAdmission(const ConnectionAdmission&) = delete;
+  ConnectionAdmission& operator=(const ConnectionAdmission&) = delete;
+
+  //! Admits a connection from an address, taking a token of its bucket.
+  //! Every admitted connection must be released with `Release`.
+  //! Safe to call from any thread.
+  //! @param address Remote address of the connection.
+  //! @param now Current time.
+  //! @returns Result of the admission.
+  AdmissionResult Admit(
+    const boost::asio::ip::address_v4& address,
+    Clock::time_point now = Clock::now());
+
+  //! Releases an admitted connection of an address.
+  //! Safe to call from any thread.
+  //! @param address Remote address of the connection.
+  void Release(const boost::asio::ip::address_v4& address);
+
+  //! Records an admitted connection rejected because the server was full.
+  //! The connection must still be released with `Release`.
+  void RecordServerFull() noexcept;
+
+  //! Returns the statistics of the admission.
+  //! Safe to call from any thread.
+  //! @returns Statistics.
+  [[nodiscard]] AdmissionStatistics GetStatistics() const noexcept;
+
+private:
+  //! Count of the shards, must be a power of two.
+  static constexpr uint32_t ShardCount = 16;
+  //! Index of no entry.
+  static constexpr uint32_t InvalidIndex = UINT32_MAX;
+
+  //! Tracked address.
+  struct Entry
+  {
+    uint32_t address{};
+    //! Hash of the address.
+    uint64_t hash{};
+    //! Count of the admitted connections not yet released.
+    uint32_t activeConnections{};
+    //! Tokens of the bucket.
+    double tokens{};
+    //! Time point at which the tokens were refilled.
+    Clock::time_point refilledAt{};
+    //! Neighbours in the list of the idle entries, or the next free entry.
+    uint32_t previous = InvalidIndex;
+    uint32_t next = InvalidIndex;
+  };
+
+  //! Shard of the address table.
+  struct Shard
+  {
+    std::mutex mutex;
+    //! Entries of the shard.
+    std::vector<Entry> entries;
+    //! Open-addressed index of the entries, `InvalidIndex` marks an empty slot.
+    std::vector<uint32_t> slots;
+    //! Head of the free entries.
+    uint32_t freeHead = InvalidIndex;
+    //! Most recently used entry without connections.
+    uint32_t idleHead = InvalidIndex;
+    //! Least recently used entry without connections.
+    uint32_t idleTail = InvalidIndex;
+  };
+
+  //! Returns the slot of an address in a shard.
+  //! @returns Slot holding the address, or the empty slot ending its probe sequence.
+  [[nodiscard]] static size_t FindSlot(const Shard& shard, uint32_t address, uint64_t hash) noexcept;
+  //! Removes the entry in a slot, shifting back the entries probed past it.
+  static void RemoveSlot(Shard& shard, size_t slot) noexcept;
+  //! Links an entry at the head of the idle list.
+  static void LinkIdle(Shard& shard, uint32_t entryIndex) noexcept;
+  //! Unlinks an entry from the idle list.
+  static void UnlinkIdle(Shard& shard, uint32_t entryIndex) noexcept;
+
+  [[nodiscard]] Shard& GetShard(uint64_t hash) noexcept;
+
+  Limits _limits;
+  std::array<Shard, ShardCount> _shards;
+
+  struct
+  {
+    std::atomic<uint64_t> admitted{0};
+    std::atomic<uint64_t> rejectedTooManyConnections{0};
+    std::atomic<uint64_t> rejectedRateLimited{0};
+    std::atomic<uint64_t> rejectedTableFull{0};
+    std::atomic<uint64_t> rejectedServerFull{0};
+    std::atomic<uint64_t> evictions{0};
+    std::atomic<uint64_t> trackedAddresses{0};
+  } _statistics;
+};
+
+} // namespace server::network
+
+#endif // ADMISSION_HPP
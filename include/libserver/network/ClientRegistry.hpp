@@ -0,0 +1,307 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#ifndef CLIENTREGISTRY_HPP
+#define CLIENTREGISTRY_HPP
+
+#include "libserver/network/NetworkDefinitions.hpp"
+#include "libserver/util/MemoryUsage.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace server::network
+{
+
+//! A registry of the contexts of the connected clients of a director.
+//! The contexts are stored contiguously and iterated without hashing,
+//! a client is found by the slot index of its ID, which the network server
+//! keeps below its client capacity.
+//!
+//! The owner thread, the network thread of the director, registers, erases
+//! and modifies the clients and reads them without taking a lock. The other threads
+//! read them with `Visit` and `VisitEach` under a shared lock, which the owner
+//! thread takes exclusively only to change the registry or to `Modify` a context.
+//! The reads neither copy the registry nor allocate.
+template <typename Context>
+class ClientRegistry final
+{
+public:
+  //! A registered client, its ID and its context.
+  using Entry = std::pair<ClientId, Context>;
+
+  ClientRegistry() = default;
+
+  ClientRegistry(const ClientRegistry&) = delete;
+  ClientRegistry& operator=(const ClientRegistry&) = delete;
+
+  //! Registers a client with a default context, unless it is registered already.
+  //! Must be called from the owner thread, the first call makes the calling thread the owner.
+  //! @param clientId ID of the client.
+  //! @returns Context of the client.
+  Context& Emplace(const ClientId clientId)
+  {
+    if (const auto context = Find(clientId))
+      return *context;
+
+    _ownerThread.store(std::this_thread::get_id(), std::memory_order::relaxed);
+
+    const auto index = GetIndex(clientId);
+    std::unique_lock lock(_mutex);
+
+    if (index >= _positions.size())
+      _positions.resize(std::max<size_t>(index + 1, _positions.size() * 2), InvalidPosition);
+
+    // A client which was not erased before its slot was reused is replaced.
+    if (const auto position = _positions[index]; position != InvalidPosition)
+    {
+      auto& entry = _entries[position];
+      entry = Entry{clientId, Context{}};
+      return entry.second;
+    }
+
+    _positions[index] = static_cast<uint32_t>(_entries.size());
+    return _entries.emplace_back(clientId, Context{}).second;
+  }
+
+  //! Erases a client. The last client takes its place, references to it are invalidated.
+  //! Must be called from the owner thread.
+  //! @param clientId ID of the client.
+  //! @returns `true` if the client was erased, `false` if it is not registered.
+  bool Erase(const ClientId clientId)
+  {
+    const auto position = FindPosition(clientId);
+    if (position == InvalidPosition)
+      return false;
+
+    std::unique_lock lock(_mutex);
+
+    if (position != _entries.size() - 1)
+    {
+      _entries[position] = std::move(_entries.back());
+      _positions[GetIndex(_entries[position].first)] = position;
+    }
+
+    _entries.pop_back();
+    _positions[GetIndex(clientId)] = InvalidPosition;
+    return true;
+  }
+
+  //! Finds the context of a client.
+  //! Must be called from the owner thread.
+  //! @param clientId ID of the client.
+  //! @returns Pointer to the context, `nullptr` if the client is not registered.
+  [[nodiscard]] Context* Find(const ClientId clientId) noexcept
+  {
+    assert(IsOwnerThread());
+    const auto position = FindPosition(clientId);
+    return position == InvalidPosition ? nullptr : &_entries[position].second;
+  }
+
+  //! Finds the context of a client.
+  //! Must be called from the owner thread.
+  //! @param clientId ID of the client.
+  //! @returns Pointer to the context, `nullptr` if the client is not registered.
+  [[nodiscard]] const Context* Find(const ClientId clientId) const noexcept
+  {
+    assert(IsOwnerThread());
+    const auto position = FindPosition(clientId);
+    return position == InvalidPosition ? nullptr : &_entries[position].second;
+  }
+
+  //! Modifies the context of a client so that the other threads do not read it meanwhile.
+  //! Needed only for the fields read by the other threads. Must be called from the owner thread.
+  //! @param clientId ID of the client.
+  //! @param function Function called with a reference to the context.
+  //! @returns `true` if the client was modified, `false` if it is not registered.
+  template <typename Function>
+  bool Modify(const ClientId clientId, Function&& function)
+  {
+    const auto context = Find(clientId);
+    if (context == nullptr)
+      return false;
+
+    std::unique_lock lock(_mutex);
+    std::forward<Function>(function)(*context);
+    return true;
+  }
+
+  //! Visits the context of a client. Safe to call from any thread.
+  //! @param clientId ID of the client.
+  //! @param function Function called with a const reference to the context.
+  //!                 Must not change the registry.
+  //! @returns `true` if the client was visited, `false` if it is not registered.
+  template <typename Function>
+  bool Visit(const ClientId clientId, Function&& function) const
+  {
+    const auto lock = LockShared();
+
+    const auto position = FindPosition(clientId);
+    if (position == InvalidPosition)
+      return false;
+
+    std::forward<Function>(function)(std::as_const(_entries[position].second));
+    return true;
+  }
+
+  //! Visits the contexts of all the clients in their storage order. Safe to call from any thread.
+  //! @param function Function called with the ID of the client and a const reference to its context.
+  //!                 If it returns a `bool`, `false` stops the visit.
+  //!                 Must not change the registry.
+  //! @returns `false` if the visit was stopped, `true` otherwise.
+  template <typename Function>
+  bool VisitEach(Function&& function) const
+  {
+    const auto lock = LockShared();
+
+    for (const auto& [clientId, context] : _entries)
+    {
+      if constexpr (std::is_same_v<std::invoke_result_t<Function&, ClientId, const Context&>, bool>)
+      {
+        if (not function(clientId, context))
+          return false;
+      }
+      else
+      {
+        function(clientId, context);
+      }
+    }
+
+    return true;
+  }
+
+  //! Returns the count of the clients.
+  //! Must be called from the owner thread.
+  [[nodiscard]] size_t Size() const noexcept
+  {
+    return _entries.size();
+  }
+
+  //! Returns whether there are no clients.
+  //! Must be called from the owner thread.
+  [[nodiscard]] bool Empty() const noexcept
+  {
+    return _entries.empty();
+  }
+
+  //! Returns whether a client is registered.
+  //! Must be called from the owner thread.
+  //! @param clientId ID of the client.
+  [[nodiscard]] bool Contains(const ClientId clientId) const noexcept
+  {
+    return FindPosition(clientId) != InvalidPosition;
+  }
+
+  //! Iterators of the clients, which must be used from the owner thread.
+  //! No client may be registered or erased while iterating.
+  //! Debug builds assert the calling thread, as they do for `Find`.
+  [[nodiscard]] auto begin() noexcept
+  {
+    assert(IsOwnerThread());
+    return _entries.begin();
+  }
+
+  [[nodiscard]] auto end() noexcept
+  {
+    return _entries.end();
+  }
+
+  [[nodiscard]] auto begin() const noexcept
+  {
+    assert(IsOwnerThread());
+    return _entries.cbegin();
+  }
+
+  [[nodiscard]] auto end() const noexcept
+  {
+    return _entries.cend();
+  }
+
+  //! Estimates the heap size of the registry, excluding the heap owned by the contexts.
+  //! Must be called from the owner thread.
+  [[nodiscard]] std::size_t EstimateContainerHeapSize() const noexcept
+  {
+    return util::EstimateContainerHeapSize(_entries)
+      + util::EstimateContainerHeapSize(_positions);
+  }
+
+private:
+  //! A position marking a slot index without a client.
+  static constexpr uint32_t InvalidPosition = std::numeric_limits<uint32_t>::max();
+
+  //! Returns the slot index of the client ID, its lower 32 bits.
+  [[nodiscard]] static constexpr uint32_t GetIndex(const ClientId clientId) noexcept
+  {
+    return static_cast<uint32_t>(clientId);
+  }
+
+  //! Returns the position of the client in the entries, `InvalidPosition` if it is not registered.
+  [[nodiscard]] uint32_t FindPosition(const ClientId clientId) const noexcept
+  {
+    const auto index = GetIndex(clientId);
+    if (index >= _positions.size())
+      return InvalidPosition;
+
+    // The stale ID of a reused slot does not match the ID of the registered client.
+    const auto position = _positions[index];
+    if (position == InvalidPosition || _entries[position].first != clientId)
+      return InvalidPosition;
+
+    return position;
+  }
+
+  //! Returns whether the calling thread is the owner thread,
+  //! or no thread owns the registry yet.
+  [[nodiscard]] bool IsOwnerThread() const noexcept
+  {
+    const auto ownerThread = _ownerThread.load(std::memory_order::relaxed);
+    return ownerThread == std::thread::id{} || ownerThread == std::this_thread::get_id();
+  }
+
+  //! Locks the registry for reading, unless called from the owner thread,
+  //! which is the only writer and may read the registry at any time.
+  [[nodiscard]] std::shared_lock<std::shared_mutex> LockShared() const
+  {
+    if (_ownerThread.load(std::memory_order::relaxed) == std::this_thread::get_id())
+      return {};
+    return std::shared_lock(_mutex);
+  }
+
+  //! Clients stored contiguously.
+  std::vector<Entry> _entries;
+  //! Positions of the clients in the entries indexed by the slot indices of their IDs.
+  std::vector<uint32_t> _positions;
+  //! Mutex excluding the reads of the other threads while the owner thread writes.
+  mutable std::shared_mutex _mutex;
+  //! The thread which registers the clients.
+  std::atomic<std::thread::id> _ownerThread{};
+};
+
+} // namespace server::network
+
+#endif // CLIENTREGISTRY_HPP
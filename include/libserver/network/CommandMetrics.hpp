@@ -0,0 +1,157 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#ifndef COMMAND_METRICS_HPP
+#define COMMAND_METRICS_HPP
+
+#include "libserver/network/HandlerError.hpp"
+#include "libserver/util/Histogram.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace server::network
+{
+
+//! Lock-free per-command counters and histograms of a command server.
+//! Recording costs a few relaxed atomic increments, the storage of a command
+//! is allocated the first time the command is recorded.
+class CommandMetrics final
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  //! Point in time statistics of a command.
+  struct CommandStatistics
+  {
+    uint16_t commandId{};
+    //! Count of the received commands.
+    uint64_t inboundCount{};
+    //! Count of the sent commands.
+    uint64_t outboundCount{};
+    //! Count of the received commands whose handler threw or rejected them.
+    uint64_t failureCount{};
+    //! Count of the received commands whose handler rejected them, per kind of the error.
+    std::array<uint64_t, HandlerErrorCount> errorCounts{};
+    //! Time to descramble and read the received command in nanoseconds.
+    util::Histogram::Snapshot decodeTime{};
+    //! Time spent in the handler of the received command in nanoseconds.
+    util::Histogram::Snapshot handlerTime{};
+    //! Time to build, write and scramble the sent command in nanoseconds.
+    util::Histogram::Snapshot serializeTime{};
+    //! Size of the received command in bytes.
+    util::Histogram::Snapshot inboundSize{};
+    //! Size of the sent command in bytes.
+    util::Histogram::Snapshot outboundSize{};
+
+    //! Returns the total time spent processing the command in nanoseconds.
+    [[nodiscard]] uint64_t GetTotalTime() const;
+  };
+
+  //! Criteria of the command ranking.
+  enum class Ranking
+  {
+    //! Total time spent processing the command.
+    TotalTime,
+    //! 99th percentile of the handler time.
+    HandlerTimeP99,
+    //! Count of the received and sent commands.
+    Count,
+    //! Count of the received and sent bytes.
+    Bytes,
+  };
+
+  //! Constructor.
+  //! @param commandCount Count of the command IDs, higher command IDs are not recorded.
+  explicit CommandMetrics(size_t commandCount);
+  ~CommandMetrics();
+
+  CommandMetrics(const CommandMetrics&) = delete;
+  CommandMetrics& operator=(const CommandMetrics&) = delete;
+
+  //! Records a received command.
+  //! @param commandId ID of the command.
+  //! @param size Size of the command in bytes.
+  //! @param decodeTime Time to decode the command.
+  void RecordInbound(uint16_t commandId, size_t size, Clock::duration decodeTime);
+
+  //! Records a received command which could not be read, as a failure.
+  //! @param commandId ID of the command.
+  //! @param size Size of the command in bytes.
+  void RecordUnreadable(uint16_t commandId, size_t size);
+
+  //! Records the handling of a received command.
+  //! @param commandId ID of the command.
+  //! @param handlerTime Time spent in the handler.
+  //! @param failed Whether the handler threw or rejected the command.
+  void RecordHandled(uint16_t commandId, Clock::duration handlerTime, bool failed);
+
+  //! Records a received command rejected by its handler.
+  //! @param commandId ID of the command.
+  //! @param error Kind of the error.
+  void RecordError(uint16_t commandId, HandlerError error);
+
+  //! Records a sent command.
+  //! @param commandId ID of the command.
+  //! @param size Size of the command in bytes.
+  //! @param serializeTime Time to serialize the command.
+  void RecordOutbound(uint16_t commandId, size_t size, Clock::duration serializeTime);
+
+  //! Returns the statistics of all the recorded commands ordered by the command ID.
+  [[nodiscard]] std::vector<CommandStatistics> GetSnapshot() const;
+
+  //! Returns the statistics of the most expensive commands.
+  //! @param count Maximum count of the commands.
+  //! @param ranking Criteria of the ranking.
+  //! @returns Statistics of the commands, the most expensive one first.
+  [[nodiscard]] std::vector<CommandStatistics> GetTopCommands(
+    size_t count,
+    Ranking ranking) const;
+
+private:
+  //! Recorded data of a command.
+  struct Entry
+  {
+    std::atomic<uint64_t> inboundCount{};
+    std::atomic<uint64_t> outboundCount{};
+    std::atomic<uint64_t> failureCount{};
+    std::array<std::atomic<uint64_t>, HandlerErrorCount> errorCounts{};
+    util::Histogram decodeTime;
+    util::Histogram handlerTime;
+    util::Histogram serializeTime;
+    util::Histogram inboundSize;
+    util::Histogram outboundSize;
+  };
+
+  //! Returns the entry of the command, creating it if necessary.
+  //! @param commandId ID of the command.
+  //! @returns Pointer to the entry or `nullptr` if the command ID is out of range.
+  Entry* GetEntry(uint16_t commandId);
+
+  size_t _commandCount;
+  std::unique_ptr<std::atomic<Entry*>[]> _entries;
+};
+
+} // namespace server::network
+
+#endif // COMMAND_METRICS_HPP
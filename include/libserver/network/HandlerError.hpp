@@ -0,0 +1,81 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#ifndef HANDLER_ERROR_HPP
+#define HANDLER_ERROR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <string_view>
+
+namespace server::network
+{
+
+//! Kind of an ordinary failure of a command handler.
+//! Handlers report these instead of throwing, so that rejecting a command
+//! costs a counter increment instead of an unwind and a formatted message.
+enum class HandlerError : uint8_t
+{
+  //! The client is not known, e.g. it has disconnected in the meantime.
+  UnknownClient,
+  //! The client is not authenticated.
+  Unauthenticated,
+  //! A record required by the command is not available.
+  RecordUnavailable,
+  //! The client is not in a state the command applies to, e.g. not in a race.
+  InvalidState,
+  //! The command is malformed or acts on behalf of another entity.
+  InvalidCommand,
+  //! Count of the kinds, not a kind itself.
+  Count,
+};
+
+//! Count of the kinds of the handler errors.
+constexpr size_t HandlerErrorCount = static_cast<size_t>(HandlerError::Count);
+
+//! Result of a command handler.
+using HandlerResult = std::expected<void, HandlerError>;
+
+//! Returns the name of the handler error.
+//! @param error Handler error.
+//! @returns Name of the error in snake case.
+[[nodiscard]] constexpr std::string_view GetHandlerErrorName(const HandlerError error)
+{
+  switch (error)
+  {
+    case HandlerError::UnknownClient:
+      return "unknown_client";
+    case HandlerError::Unauthenticated:
+      return "unauthenticated";
+    case HandlerError::RecordUnavailable:
+      return "record_unavailable";
+    case HandlerError::InvalidState:
+      return "invalid_state";
+    case HandlerError::InvalidCommand:
+      return "invalid_command";
+    case HandlerError::Count:
+      break;
+  }
+  return "unknown";
+}
+
+} // namespace server::network
+
+#endif // HANDLER_ERROR_HPP
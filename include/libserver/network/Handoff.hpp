@@ -0,0 +1,140 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#ifndef HANDOFF_HPP
+#define HANDOFF_HPP
+
+#include <boost/asio.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <span>
+#include <vector>
+
+//! A handoff of the listening sockets between the processes of the server,
+//! so that the server restarts without refusing connections.
+//!
+//! The running process serves the handoff on a Unix domain socket accessible only
+//! to the user running it, and rejects the peers of any other user. The process
+//! replacing it connects to the socket and receives duplicates of the listening sockets
+//! as `SCM_RIGHTS` ancillary data with a message consisting of the magic `ALHO` and
+//! the 32-bit count of the sockets, then acknowledges them with a single byte.
+//! The previous process then stops accepting, disconnects its clients and writes out
+//! its data, and releases the new process with a single byte. Only then the servers
+//! of the new process adopt the sockets bound to their endpoints, the reconnecting
+//! clients wait in the backlog of the sockets meanwhile, so that the processes
+//! never serve the same players nor write the same records at once.
+//!
+//! Not available on Windows, where the servers always bind their own sockets.
+namespace server::network::handoff
+{
+
+namespace asio = boost::asio;
+
+//! Native handle of a listening socket.
+using ListenerHandle = asio::ip::tcp::acceptor::native_handle_type;
+
+//! Maximum count of the sockets in a handoff.
+constexpr size_t MaxListenerCount = 16;
+
+//! Sends the listening sockets over a connected Unix domain socket.
+//! @param connection Native handle of the connection.
+//! @param listeners Listening sockets to send, which stay open in this process.
+//! @throw std::runtime_error
+void SendListeners(int connection, std::span<const ListenerHandle> listeners);
+
+//! Receives the listening sockets over a connected Unix domain socket.
+//! @param connection Native handle of the connection.
+//! @returns Received listening sockets, owned by the caller.
+//! @throw std::runtime_error
+[[nodiscard]] std::vector<ListenerHandle> ReceiveListeners(int connection);
+
+//! Requests the listening sockets of the process serving the handoff,
+//! keeping them to be adopted by the servers beginning on the same endpoints.
+//! Blocks until the previous process releases its clients and data.
+//! @param path Path of the handoff socket.
+//! @param releaseTimeout Time limit of waiting for the release,
+//!                       the sockets are inherited anyway once it passes.
+//! @returns Count of the inherited sockets, `0` if no process serves the handoff.
+//! @throw std::runtime_error If the handoff failed.
+size_t InheritListeners(
+  const std::filesystem::path& path,
+  std::chrono::seconds releaseTimeout);
+
+//! Takes the inherited listening socket bound to the endpoint.
+//! Thread-safe.
+//! @param endpoint Local endpoint of the socket.
+//! @returns Listening socket, now owned by the caller, or empty if none was inherited.
+[[nodiscard]] std::optional<ListenerHandle> TakeInheritedListener(
+  const asio::ip::tcp::endpoint& endpoint);
+
+//! Closes the inherited listening sockets not taken by any server.
+//! Thread-safe.
+//! @returns Count of the closed sockets.
+size_t CloseInheritedListeners();
+
+//! Serves the listening sockets of this process to the process replacing it.
+class Provider final
+{
+public:
+  //! Supplier of the listening sockets to hand off.
+  using ListenerSupplier = std::function<std::vector<ListenerHandle>()>;
+
+  //! Constructor.
+  //! @param listenerSupplier Supplier of the listening sockets, called on the serving thread.
+  explicit Provider(ListenerSupplier listenerSupplier);
+  ~Provider();
+
+  Provider(const Provider&) = delete;
+  Provider& operator=(const Provider&) = delete;
+
+  //! Serves the handoff on the current thread.
+  //! Blocks the current thread until the sockets were handed off or the provider ends.
+  //! A stale socket file at the path is replaced, and the file is removed
+  //! unless the sockets were handed off, as the next process owns it by then.
+  //! @param path Path of the handoff socket.
+  //! @returns `true` if the sockets were handed off, `false` if the provider ended.
+  //! @throw std::runtime_error If the handoff socket can't be bound.
+  bool Serve(const std::filesystem::path& path);
+
+  //! Releases the next process once this process no longer serves any client
+  //! nor writes any data. Call after the sockets were handed off.
+  void Release();
+
+  //! Ends the provider. Thread-safe.
+  void End();
+
+private:
+  void AcceptLoop();
+
+  asio::io_context _ioContext;
+#ifndef WIN32
+  asio::local::stream_protocol::acceptor _acceptor;
+  //! Connection of the next process, kept open until it is released.
+  asio::local::stream_protocol::socket _connection;
+#endif
+  ListenerSupplier _listenerSupplier;
+  bool _isHandedOff{false};
+};
+
+} // namespace server::network::handoff
+
+#endif // HANDOFF_HPP
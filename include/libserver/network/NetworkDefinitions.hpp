@@ -5,13 +5,38 @@
 #ifndef ALICIA_SERVER_NETWORKDEFINITIONS_HPP
 #define ALICIA_SERVER_NETWORKDEFINITIONS_HPP
 
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 
 namespace server::network
 {
 
 using ClientId = size_t;
 
+//! Options of the sockets of the accepted clients.
+struct SocketOptions
+{
+  //! Whether Nagle's algorithm is disabled.
+  //! The frames are coalesced by `WriteCork` instead of being held back by the kernel.
+  bool noDelay{true};
+  //! Size of the kernel send buffer in bytes, `0` keeps the system default.
+  uint32_t sendBufferSize{0};
+  //! Size of the kernel receive buffer in bytes, `0` keeps the system default.
+  uint32_t receiveBufferSize{0};
+  //! Whether the idle connections are probed with keepalives.
+  bool keepAlive{true};
+  //! Idle time before the first keepalive probe. Linux only.
+  std::chrono::seconds keepAliveIdle{60};
+  //! Interval of the keepalive probes. Linux only.
+  std::chrono::seconds keepAliveInterval{10};
+  //! Count of the unanswered keepalive probes before the connection is dropped. Linux only.
+  uint32_t keepAliveCount{5};
+  //! Time the sent data may remain unacknowledged before the connection is dropped,
+  //! `0` keeps the system default. Linux only.
+  std::chrono::milliseconds userTimeout{0};
+};
+
 } // namespace server::network
 
 #endif // ALICIA_SERVER_NETWORKDEFINITIONS_HPP
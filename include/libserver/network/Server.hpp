@@ -20,14 +20,22 @@
 #ifndef SERVER_HPP
 #define SERVER_HPP
 
+#include "Admission.hpp"
 #include "NetworkDefinitions.hpp"
 
+#include "libserver/util/MemoryUsage.hpp"
+#include "libserver/util/SlabPool.hpp"
+#include "libserver/util/SlotMap.hpp"
+
+#include <atomic>
 #include <chrono>
 #include <cstdint>
-#include <deque>
 #include <functional>
+#include <mutex>
+#include <optional>
 #include <queue>
 #include <span>
+#include <string_view>
 #include <unordered_map>
 
 #include <boost/asio.hpp>
@@ -37,9 +45,77 @@ namespace server::network
 
 namespace asio = boost::asio;
 
+//! Returns the name of the I/O backend of the servers, selected at build time.
+//! @returns `io_uring` if built with `ALICIA_IO_URING`, otherwise the default backend of asio.
+[[nodiscard]] std::string_view GetIoBackendName() noexcept;
+
+//! Returns the statistics of the pool of the read buffers shared by the clients of all the servers.
+//! Safe to call from any thread.
+[[nodiscard]] util::SlabPool::Statistics GetReadBufferPoolStatistics() noexcept;
+
 //! A write handler.
 using WriteSupplier = std::function<size_t(asio::streambuf&)>;
 
+//! Memory held by the buffers of the clients.
+struct BufferMemoryUsage
+{
+  //! Read buffers of the clients.
+  util::MemoryUsage readBuffers;
+  //! Write buffers of the clients.
+  util::MemoryUsage writeBuffers;
+  //! Writes queued by the clients, the heap captured by the write suppliers is not accounted for.
+  util::MemoryUsage writeQueues;
+
+  //! Appends the memory usage of the buffers to the report.
+  //! @param report Report to append to.
+  void AppendTo(util::MemoryUsageReport& report) const;
+};
+
+//! Network statistics of a client.
+struct ClientStatistics
+{
+  //! Count of the bytes received.
+  uint64_t inboundBytes{};
+  //! Count of the frames received.
+  uint64_t inboundFrames{};
+  //! Count of the reads from the socket.
+  uint64_t inboundReads{};
+  //! Count of the bytes sent.
+  uint64_t outboundBytes{};
+  //! Count of the frames queued for sending.
+  uint64_t outboundFrames{};
+  //! Count of the writes issued to the socket, each carrying one or more frames.
+  uint64_t outboundWrites{};
+  //! Count of the writes queued and not yet written to the write buffer.
+  uint64_t writeQueueDepth{};
+  //! Largest count of the queued writes seen.
+  uint64_t maxWriteQueueDepth{};
+  //! Count of the bytes in the write buffer not yet accepted by the socket.
+  uint64_t pendingSendBytes{};
+  //! Time the sends spent waiting for the socket to accept the data.
+  std::chrono::nanoseconds sendBlockedTime{};
+  //! Smoothed round-trip time the kernel estimated for the connection (`TCP_INFO`),
+  //! zero if not available. The protocol has no heartbeat echo to measure it from.
+  std::chrono::microseconds roundTripTime{};
+
+  //! Adds the statistics of another client.
+  //! Sums the counters and keeps the largest queue depth and round-trip time.
+  ClientStatistics& operator+=(const ClientStatistics& other) noexcept;
+};
+
+//! Network statistics of a listener.
+struct ListenerStatistics
+{
+  //! Count of the connected clients.
+  uint64_t clientCount{};
+  //! Totals of the clients. The byte and frame counters, the send blocked time and
+  //! the largest queue depth include the clients which already disconnected,
+  //! the rest are of the connected clients only.
+  ClientStatistics total;
+  //! Average round-trip time of the connected clients with a sample.
+  std::chrono::microseconds averageRoundTripTime{};
+};
+
 //!
 class EventHandlerInterface
 {
@@ -66,6 +142,32 @@ public:
     const std::span<const std::byte>& data) = 0;
 };
 
+class Client;
+
+//! Corks the writes queued by the current thread to the clients of any server.
+//! Until the outermost cork of the thread ends, the queued frames are only buffered.
+//! Then every client written to is flushed once, so the frames of a director tick
+//! or of a batch of received commands leave in a single write per client.
+class WriteCork final
+{
+public:
+  //! Corks the current thread.
+  WriteCork() noexcept;
+  //! Uncorks the current thread, flushing the clients if this is the outermost cork.
+  ~WriteCork();
+
+  WriteCork(const WriteCork&) = delete;
+  WriteCork& operator=(const WriteCork&) = delete;
+
+private:
+  friend class Client;
+
+  //! Defers the flush of a client to the end of the outermost cork.
+  //! @param client Client with the queued write.
+  //! @returns `true` if the current thread is corked and the flush was deferred.
+  static bool Defer(Client& client);
+};
+
 //! Client with event driven reads and writes
 //! to the underlying socket connection.
 class Client : public std::enable_shared_from_this<Client>
@@ -86,11 +188,39 @@ public:
   void QueueWrite(WriteSupplier writeSupplier);
   //!
   asio::ip::address_v4 GetAddress() const noexcept;
+  //! Returns the memory held by the buffers of the client.
+  //! Must be called from the I/O thread.
+  //! @returns Memory held by the buffers.
+  [[nodiscard]] BufferMemoryUsage GetBufferMemoryUsage();
+  //! Records frames received from the client.
+  //! @param count Count of the frames.
+  void RecordInboundFrames(uint64_t count) noexcept;
+  //! Samples the round-trip time of the connection from the kernel's estimate.
+  //! Must be called from the I/O thread.
+  void SampleRoundTripTime() noexcept;
+  //! Returns the network statistics of the client.
+  //! Safe to call from any thread.
+  //! @returns Network statistics.
+  [[nodiscard]] ClientStatistics GetStatistics() const noexcept;
 
 private:
+  friend class WriteCork;
+
+  //! Size of the first read buffer of a client.
+  static constexpr size_t InitialReadSize = 1024;
+  //! Count of the consecutive reads of at most a quarter of the read size
+  //! after which the read size is halved.
+  static constexpr uint32_t ShortReadsBeforeShrink = 16;
+
   void WriteLoop() noexcept;
-  //! Read loop.
+  //! Read loop, waits for the socket to become readable.
   void ReadLoop() noexcept;
+  //! Reads and handles the data available on the socket until it would block.
+  //! @throw std::runtime_error If the connection failed.
+  void ReadAvailable();
+  //! Ensures the read buffer has space, acquiring or growing it.
+  //! @throw std::runtime_error If a partial frame fills the largest read buffer.
+  void ReserveReadBuffer();
 
   //! Indicates whether the client should process I/O.
   std::atomic<bool> _shouldRun = false;
@@ -104,8 +234,32 @@ private:
   asio::streambuf _writeBuffer{};
   std::atomic<bool> _isSending = false;
 
-  //! A read buffer.
-  asio::streambuf _readBuffer{};
+  //! A read buffer drawn from the shared pool, held only while a partial frame is buffered.
+  util::SlabPool::Block _readBuffer;
+  //! Count of the bytes buffered in the read buffer.
+  size_t _readSize{0};
+  //! Size of the next read buffer, grows toward the size of the reads.
+  size_t _readSizeHint{InitialReadSize};
+  //! Count of the consecutive short reads.
+  uint32_t _shortReadCount{0};
+
+  //! Network statistics of the client, readable from other threads.
+  struct
+  {
+    std::atomic<uint64_t> inboundBytes{0};
+    std::atomic<uint64_t> inboundFrames{0};
+    std::atomic<uint64_t> inboundReads{0};
+    std::atomic<uint64_t> outboundBytes{0};
+    std::atomic<uint64_t> outboundFrames{0};
+    std::atomic<uint64_t> outboundWrites{0};
+    std::atomic<uint64_t> writeQueueDepth{0};
+    std::atomic<uint64_t> maxWriteQueueDepth{0};
+    std::atomic<uint64_t> pendingSendBytes{0};
+    std::atomic<int64_t> sendBlockedNanoseconds{0};
+    std::atomic<int64_t> roundTripMicroseconds{0};
+  } _statistics;
+  //! A time point at which the in-flight send was issued, guarded by the write mutex.
+  std::chrono::steady_clock::time_point _sendIssuedAt{};
 
   //! A unique-identifier of the client.
   ClientId _clientId;
@@ -121,15 +275,30 @@ private:
 class Server : public EventHandlerInterface
 {
 public:
+  //! Native handle of a listening socket.
+  using ListenerHandle = asio::ip::tcp::acceptor::native_handle_type;
+
+  //! Default maximum count of the connected clients.
+  static constexpr size_t DefaultMaxClientCount = 1024;
+
   //! Default constructor.
+  //! @param maxClientCount Maximum count of the connected clients.
   explicit Server(
-    EventHandlerInterface& networkEventHandler) noexcept;
+    EventHandlerInterface& networkEventHandler,
+    size_t maxClientCount = DefaultMaxClientCount) noexcept;
+
+  //! Sets the options of the sockets of the accepted clients.
+  //! Must be called before the server begins.
+  //! @param options Socket options.
+  void SetSocketOptions(const SocketOptions& options);
 
   //! Begins the server on the current thread.
   //! Blocks the current thread until stopped.
+  //! Adopts the listening socket inherited from the previous process
+  //! if one is bound to the endpoint, see `handoff::InheritListeners`.
   //!
   //! @param address Address of the interface to bind to.
-  //! @param port Port to bind to.
+  //! @param port Port to bind to, `0` binds to any free port.
   //! @throw std::runtime_error
   void Begin(
     const asio::ip::address& address,
@@ -138,8 +307,78 @@ public:
   //! Ends the server.
   void End();
 
-  //! Get client.
-  std::shared_ptr<Client> GetClient(ClientId clientId);
+  //! Stops accepting new connections.
+  //! The connected clients are served until they disconnect or the server ends.
+  void StopAccepting();
+
+  //! Returns the native handle of the listening socket.
+  //! Safe to call from any thread.
+  //! @returns Native handle, or empty if the server does not accept connections.
+  [[nodiscard]] std::optional<ListenerHandle> GetListenerHandle() const noexcept;
+
+  //! Returns the port the server listens on.
+  //! Safe to call from any thread.
+  //! @returns Port, or `0` if the server does not listen yet.
+  [[nodiscard]] uint16_t GetPort() const noexcept;
+
+  //! Queues a write to a client.
+  //! Safe to call from any thread, takes no lock on the client table.
+  //! @param clientId ID of the client.
+  //! @param writeSupplier Supplier of the write.
+  //! @returns `true` if the write was queued, `false` if the client is not connected.
+  bool QueueWrite(ClientId clientId, WriteSupplier writeSupplier);
+
+  //! Returns the remote address of a client.
+  //! Safe to call from any thread.
+  //! @param clientId ID of the client.
+  //! @returns Remote address, or empty if the client is not connected.
+  [[nodiscard]] std::optional<asio::ip::address_v4> GetClientAddress(ClientId clientId) const;
+
+  //! Disconnects a client.
+  //! Safe to call from any thread.
+  //! @param clientId ID of the client.
+  //! @returns `true` if the client was disconnected, `false` if the client is not connected.
+  bool DisconnectClient(ClientId clientId);
+
+  //! Disconnects all the clients.
+  //! Safe to call from any thread, the clients are disconnected on the I/O thread.
+  void DisconnectAllClients();
+
+  //! Runs a task on the I/O thread, which owns the state of the clients.
+  //! Safe to call from any thread.
+  //! @param task Task to run.
+  void Post(std::function<void()> task);
+
+  //! Returns the count of the connected clients.
+  //! Safe to call from any thread.
+  [[nodiscard]] size_t GetClientCount() const noexcept;
+
+  //! Returns the memory held by the buffers of all the clients.
+  //! Safe to call from any thread, the usage is updated every network tick.
+  //! @returns Memory held by the buffers.
+  [[nodiscard]] BufferMemoryUsage GetBufferMemoryUsage() const noexcept;
+
+  //! Returns the network statistics of the listener.
+  //! Safe to call from any thread, the statistics are updated every network tick.
+  //! @returns Network statistics.
+  [[nodiscard]] ListenerStatistics GetStatistics() const;
+
+  //! Returns the network statistics of a client.
+  //! Safe to call from any thread, the statistics are updated every network tick.
+  //! @param clientId ID of the client.
+  //! @returns Network statistics, or empty if the client is not connected.
+  [[nodiscard]] std::optional<ClientStatistics> GetClientStatistics(ClientId clientId) const;
+
+  //! Returns the statistics of the connection admission.
+  //! Safe to call from any thread.
+  //! @returns Admission statistics.
+  [[nodiscard]] AdmissionStatistics GetAdmissionStatistics() const noexcept;
+
+  //! Records frames received from a client.
+  //! Must be called from the I/O thread, does nothing if the client has disconnected.
+  //! @param clientId ID of the client.
+  //! @param count Count of the frames.
+  void RecordInboundFrames(ClientId clientId, uint64_t count) noexcept;
 
   void HandleNetworkTick() override;
   void OnClientConnected(ClientId clientId) override;
@@ -147,27 +386,49 @@ public:
   size_t OnClientData(ClientId clientId, const std::span<const std::byte>& data) override;
 
 private:
-  struct AddressState
-  {
-    std::size_t activeConnections = 0;
-    std::deque<std::chrono::steady_clock::time_point> connectionTimestamps;
-  };
-
   void AcceptLoop() noexcept;
   void TickLoop() noexcept;
-  bool IsConnectionThrottled(const asio::ip::address_v4& address) noexcept;
-  void OnThrottleDisconnect(const asio::ip::address_v4& address) noexcept;
+  //! Updates the memory usage of the client buffers.
+  void UpdateBufferMemoryUsage() noexcept;
+  //! Samples the round-trip times and updates the network statistics.
+  void UpdateStatistics() noexcept;
+  //! Applies the socket options to the socket of an accepted client.
+  void ApplySocketOptions(asio::ip::tcp::socket& socket) noexcept;
 
   asio::io_context _io_ctx;
   asio::ip::tcp::acceptor _acceptor;
   asio::steady_timer _timer;
 
-  //! Sequential client ID.
-  ClientId _client_id = 0;
-  //! Map of clients.
-  std::unordered_map<ClientId, std::shared_ptr<Client>> _clients;
-  //! Per-address state for connection throttling.
-  std::unordered_map<asio::ip::address_v4, AddressState> _addressStates;
+  //! Whether the server accepts connections, readable from other threads.
+  std::atomic<bool> _isAccepting{false};
+  //! Native handle of the listening socket, readable from other threads.
+  std::atomic<ListenerHandle> _listenerHandle{};
+  //! Port the server listens on, readable from other threads.
+  std::atomic<uint16_t> _port{0};
+  //! Options of the sockets of the accepted clients.
+  SocketOptions _socketOptions;
+
+  //! Table of the clients, changed only on the I/O thread and read from any thread.
+  //! The IDs of the clients are the generation-indexed IDs of the table.
+  util::ConcurrentSlotMap<Client> _clients;
+  //! Memory usage of the client buffers, readable from other threads.
+  struct
+  {
+    std::atomic<uint64_t> readBufferBytes{0};
+    std::atomic<uint64_t> writeBufferBytes{0};
+    std::atomic<uint64_t> queuedWriteCount{0};
+    std::atomic<uint64_t> queuedWriteBytes{0};
+  } _bufferMemoryUsage;
+  //! Totals of the disconnected clients, accessed only from the I/O thread.
+  ClientStatistics _disconnectedStatistics;
+  //! A mutex for the network statistics readable from other threads.
+  mutable std::mutex _statisticsMutex;
+  //! Network statistics of the listener.
+  ListenerStatistics _statistics;
+  //! Network statistics of the connected clients.
+  std::unordered_map<ClientId, ClientStatistics> _clientStatistics;
+  //! Admission of the connections per address.
+  ConnectionAdmission _admission;
 
   //! A network event handler.
   EventHandlerInterface& _networkEventHandler;
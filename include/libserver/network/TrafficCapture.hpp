@@ -0,0 +1,153 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#ifndef TRAFFIC_CAPTURE_HPP
+#define TRAFFIC_CAPTURE_HPP
+
+#include "libserver/network/NetworkDefinitions.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <vector>
+
+//! A capture of the traffic received by a command server.
+//!
+//! The capture file begins with a header consisting of the magic `ATCF` and
+//! a 16-bit version, followed by the records. A record consists of its type
+//! (8-bit), time since the previous record in microseconds (varint) and
+//! the ID of the client (varint), followed by the fields of the type:
+//! - Connected and disconnected records have no fields,
+//! - command records have the command ID (varint), the size of the command data (varint)
+//!   and the command data, descrambled and without the padding,
+//! - code records have the 4-byte XOR code the server set for the client.
+//!
+//! Varints are unsigned LEB128, all the other values are little-endian.
+namespace server::network::capture
+{
+
+//! Magic of the capture file.
+constexpr std::array<char, 4> FileMagic{'A', 'T', 'C', 'F'};
+//! Version of the capture file format.
+constexpr uint16_t FileVersion = 1;
+
+//! Type of a capture record.
+enum class RecordType : uint8_t
+{
+  //! Client connected.
+  Connected = 0,
+  //! Client disconnected.
+  Disconnected = 1,
+  //! Client sent a command.
+  Command = 2,
+  //! Server set the XOR code of the client.
+  Code = 3,
+};
+
+//! A capture record.
+struct Record
+{
+  RecordType type{RecordType::Connected};
+  //! Time of the record since the beginning of the capture.
+  std::chrono::microseconds time{};
+  ClientId clientId{};
+  //! ID of the command, valid for command records.
+  uint16_t commandId{};
+  //! Command data for command records, XOR code for code records.
+  std::vector<std::byte> data;
+};
+
+//! Writes a capture file. All the methods are thread-safe.
+class Writer final
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  //! Opens the capture file for writing, truncating an existing file.
+  //! @param path Path to the file.
+  //! @throw std::runtime_error If the file can't be opened.
+  explicit Writer(const std::filesystem::path& path);
+  ~Writer();
+
+  Writer(const Writer&) = delete;
+  Writer& operator=(const Writer&) = delete;
+
+  void WriteConnected(ClientId clientId);
+  void WriteDisconnected(ClientId clientId);
+  //! Writes a received command.
+  //! @param clientId ID of the client.
+  //! @param commandId ID of the command.
+  //! @param data Descrambled command data.
+  void WriteCommand(ClientId clientId, uint16_t commandId, std::span<const std::byte> data);
+  //! Writes the XOR code set for the client.
+  void WriteCode(ClientId clientId, std::span<const std::byte, 4> code);
+
+  //! Flushes the buffered records to the file.
+  void Flush();
+
+  //! Returns a unique capture file path in a directory.
+  //! @param directory Directory of the captures.
+  //! @param name Name of the captured server.
+  //! @returns Path to the capture file, `<directory>/<name>-<UTC time>.capture`.
+  [[nodiscard]] static std::filesystem::path MakeFilePath(
+    const std::filesystem::path& directory,
+    std::string_view name);
+
+private:
+  //! Writes the header of a record. Must be called with the mutex locked.
+  void WriteRecordHeader(RecordType type, ClientId clientId);
+  void WriteVarint(uint64_t value);
+
+  std::mutex _mutex;
+  std::ofstream _file;
+  //! Buffer of the file stream, sized to keep the writes off the disk.
+  std::vector<char> _fileBuffer;
+  Clock::time_point _lastRecordTime;
+};
+
+//! Reads a capture file.
+class Reader final
+{
+public:
+  //! Opens the capture file for reading and validates its header.
+  //! @param path Path to the file.
+  //! @throw std::runtime_error If the file can't be opened or is not a capture.
+  explicit Reader(const std::filesystem::path& path);
+
+  //! Reads the next record.
+  //! @param record Record to read into, its data storage is reused.
+  //! @returns `true` if a record was read, `false` at the end of the capture.
+  //! @throw std::runtime_error If the record is truncated or malformed.
+  bool Read(Record& record);
+
+private:
+  bool ReadVarint(uint64_t& value);
+
+  std::ifstream _file;
+  std::chrono::microseconds _time{};
+};
+
+} // namespace server::network::capture
+
+#endif // TRAFFIC_CAPTURE_HPP
@@ -21,6 +21,7 @@
 #define CHATTERPROTOCOL_HPP
 
 #include <cstdint>
+#include <optional>
 #include <string_view>
 
 namespace server::protocol
@@ -109,6 +110,7 @@ enum class ChatterCommand : uint16_t
 };
 
 std::string_view GetChatterCommandName(server::protocol::ChatterCommand command);
+std::optional<ChatterCommand> GetChatterCommandByName(std::string_view name);
 
 } // namespace server::protocol
 
@@ -20,6 +20,8 @@
 #ifndef CHATTER_SERVER_HPP
 #define CHATTER_SERVER_HPP
 
+#include "libserver/network/CommandMetrics.hpp"
+#include "libserver/network/HandlerError.hpp"
 #include "libserver/network/Server.hpp"
 #include "libserver/util/Stream.hpp"
 #include "libserver/Constants.hpp"
@@ -30,7 +32,11 @@
 #include <spdlog/spdlog.h>
 
 #include <functional>
+#include <optional>
+#include <string>
+#include <type_traits>
 #include <unordered_map>
+#include <vector>
 
 namespace server
 {
@@ -43,10 +49,16 @@ public:
 
   virtual void HandleClientConnected(network::ClientId clientId) = 0;
   virtual void HandleClientDisconnected(network::ClientId clientId) = 0;
+  //! Handles the network tick, called every second on the network thread.
+  virtual void HandleNetworkTick() {}
 };
 
 //! A raw command handler.
-using RawChatterCommandHandler = std::function<void(network::ClientId, SourceStream&)>;
+//! A chatter command handler. Sets the time point at which the command was read,
+//! which is left empty if the reading throws.
+//! @returns Result of the handler.
+using RawChatterCommandHandler = std::function<network::HandlerResult(
+  network::ClientId, SourceStream&, std::optional<network::CommandMetrics::Clock::time_point>& decodedAt)>;
 
 //! Concept for readable command structs.
 template <typename T>
@@ -62,6 +74,11 @@ public:
   explicit ChatterServer(IChatterServerEventsHandler& chatterServerEventsHandler);
   ~ChatterServer();
 
+  //! Sets the options of the sockets of the accepted clients.
+  //! Must be called before the server begins.
+  //! @param options Socket options.
+  void SetSocketOptions(const network::SocketOptions& options);
+
   void BeginHost(network::asio::ip::address_v4 address, uint16_t port);
   void EndHost();
 
@@ -69,28 +86,46 @@ public:
   void DisconnectClient(network::ClientId clientId);
 
   //! Registers a command handler.
-  template <ReadableChatterCommandStruct C>
-  void RegisterCommandHandler(
-    std::function<void(network::ClientId clientId, const C& command)> handler)
+  //! The handler either returns nothing and signals failures by throwing,
+  //! or returns a `network::HandlerResult` whose errors are counted per kind without unwinding.
+  template <ReadableChatterCommandStruct C, typename Handler>
+  void RegisterCommandHandler(Handler handler)
   {
     _handlers[static_cast<uint16_t>(C::GetCommand())] = 
-      [handler](network::ClientId clientId, SourceStream& source)
+      [handler = std::move(handler)](
+        network::ClientId clientId,
+        SourceStream& source,
+        std::optional<network::CommandMetrics::Clock::time_point>& decodedAt) -> network::HandlerResult
       {
         C command;
         C::Read(command, source);
-        handler(clientId, command);
+        decodedAt = network::CommandMetrics::Clock::now();
+
+        if constexpr (std::is_void_v<
+          std::invoke_result_t<const Handler&, network::ClientId, const C&>>)
+        {
+          handler(clientId, command);
+          return {};
+        }
+        else
+        {
+          return handler(clientId, command);
+        }
       };
   }
 
   template<typename T>
   void QueueCommand(network::ClientId clientId, std::function<T()> commandSupplier)
   {
-    _server.GetClient(clientId)->QueueWrite([this, commandSupplier = std::move(commandSupplier)](
+    // The command is dropped if the client has disconnected in the meantime.
+    _server.QueueWrite(clientId, [this, commandSupplier = std::move(commandSupplier)](
       network::asio::streambuf& buf)
     {
       // todo: this templated function should just write the bytes to the buffer,
       //       rest of the logic should be moved to non-templated function which deals with buffer directly.
 
+      const auto serializeBegin = network::CommandMetrics::Clock::now();
+
       const auto buffer = buf.prepare(4092);
       SinkStream bufferSink({
         static_cast<std::byte*>(buffer.data()),
@@ -107,9 +142,9 @@ public:
         .length = static_cast<uint16_t>(bufferSink.GetCursor()),
         .commandId = static_cast<uint16_t>(T::GetCommand()),};
 
-      if (debugOutgoingCommandData)
+      if (IsOutgoingCommandDataDumped(header.commandId))
       {
-        spdlog::debug("Write data for command '{}' (0x{:X}),\n\n"
+        SPDLOG_DEBUG("Write data for command '{}' (0x{:X}),\n\n"
           "Command data size: {} \n"
           "Data dump: \n\n{}\n",
           GetChatterCommandName(T::GetCommand()),
@@ -148,17 +183,67 @@ public:
       
       if (debugCommands)
       {
-        spdlog::debug("Sent chatter command message '{}' (0x{:X})",
+        SPDLOG_DEBUG("Sent chatter command message '{}' (0x{:X})",
           GetChatterCommandName(T::GetCommand()),
           static_cast<uint16_t>(T::GetCommand()));
       }
 
       buf.commit(bufferSource.GetCursor());
+
+      _metrics.RecordOutbound(
+        header.commandId,
+        header.length,
+        network::CommandMetrics::Clock::now() - serializeBegin);
+
       return bufferSource.GetCursor();
     });
   }
 
+  //! Sets the commands whose data is dumped to the debug log by all chatter servers.
+  //! Data of the other commands is never formatted.
+  //! Must be called before the servers begin hosting.
+  //! @param incomingCommands Names of the commands whose received data is dumped.
+  //! @param outgoingCommands Names of the commands whose sent data is dumped.
+  static void SetCommandDataDumps(
+    const std::vector<std::string>& incomingCommands,
+    const std::vector<std::string>& outgoingCommands);
+
+  //! Returns the per-command metrics of the server.
+  [[nodiscard]] const network::CommandMetrics& GetMetrics() const;
+
+  //! Returns the count of the connected clients.
+  [[nodiscard]] size_t GetClientCount() const;
+
+  //! Returns the memory held by the buffers of the connected clients.
+  [[nodiscard]] network::BufferMemoryUsage GetBufferMemoryUsage() const;
+
+  //! Returns the network statistics of the listener, updated every network tick.
+  [[nodiscard]] network::ListenerStatistics GetStatistics() const;
+
+  //! Returns the network statistics of a client, updated every network tick.
+  //! @param clientId ID of the client.
+  //! @returns Network statistics, or empty if the client is not connected.
+  [[nodiscard]] std::optional<network::ClientStatistics> GetClientStatistics(
+    network::ClientId clientId) const;
+
+  //! Returns the statistics of the connection admission, including the rejections.
+  [[nodiscard]] network::AdmissionStatistics GetAdmissionStatistics() const;
+
+  //! Stops accepting new clients, the connected clients are served until they disconnect.
+  //! Thread-safe.
+  void StopAccepting();
+
+  //! Disconnects all the clients. Thread-safe.
+  void DisconnectAllClients();
+
+  //! Returns the listening socket, used to hand it off to the next process.
+  //! @returns Listening socket, or empty if the server does not accept clients.
+  [[nodiscard]] std::optional<network::Server::ListenerHandle> GetListenerHandle() const;
+
 private:
+  //! Returns whether the sent data of the command is dumped.
+  static bool IsOutgoingCommandDataDumped(uint16_t commandId);
+
   void HandleNetworkTick() override;
   void OnClientConnected(network::ClientId clientId) override;
   void OnClientDisconnected(network::ClientId clientId) override;
@@ -166,13 +251,12 @@ private:
 
   IChatterServerEventsHandler& _chatterServerEventsHandler;
   std::unordered_map<uint16_t, RawChatterCommandHandler> _handlers{};
+  network::CommandMetrics _metrics;
 
   network::Server _server;
   std::thread _serverThread;
 
   // Debug flags for logging command handling
-  bool debugIncomingCommandData = constants::DebugCommands;
-  bool debugOutgoingCommandData = constants::DebugCommands;
   bool debugCommands = constants::DebugCommands;
 };
 
@@ -0,0 +1,66 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#ifndef COMMAND_CLIENT_CODEC_HPP
+#define COMMAND_CLIENT_CODEC_HPP
+
+#include "libserver/network/command/CommandServer.hpp"
+
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace server
+{
+
+//! Frames commands the way the game client does, for tools driving a command server.
+//! Commands sent to the server are scrambled with the rolling XOR code,
+//! commands sent by the server are only prefixed with the message magic.
+class CommandClientCodec final
+{
+public:
+  //! Sets the XOR code, mirroring the code the server set for the client.
+  //! @param code XOR code.
+  void SetCode(const protocol::XorCode& code);
+
+  //! Appends a command to be sent to the server to the buffer.
+  //! Rolls the XOR code if the command has data.
+  //! @param commandId ID of the command.
+  //! @param data Command data.
+  //! @param buffer Buffer to append the command to.
+  //! @throw std::runtime_error If the command data is too large.
+  void Encode(
+    uint16_t commandId,
+    std::span<const std::byte> data,
+    std::vector<std::byte>& buffer);
+
+  //! Reads the magic of a command sent by the server.
+  //! @param buffer Buffered data received from the server.
+  //! @returns Magic of the command, or empty if the command is not buffered whole.
+  //! @throw std::runtime_error If the magic is malformed.
+  [[nodiscard]] static std::optional<protocol::MessageMagic> PeekServerCommand(
+    std::span<const std::byte> buffer);
+
+private:
+  CommandClient _client;
+};
+
+} // namespace server
+
+#endif // COMMAND_CLIENT_CODEC_HPP
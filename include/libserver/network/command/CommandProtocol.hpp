@@ -22,6 +22,7 @@
 
 #include <array>
 #include <cstdint>
+#include <optional>
 #include <string_view>
 
 namespace server::protocol
@@ -730,6 +731,12 @@ enum class Command : uint16_t
 //!          Otherwise, returns "n/a".
 std::string_view GetCommandName(Command command);
 
+//! Get the ID of the command from its name.
+//! @param name Name of the command.
+//! @returns If command is registered, ID of the command.
+//!          Otherwise, returns `std::nullopt`.
+std::optional<Command> GetCommandByName(std::string_view name);
+
 } // namespace server
 
 #endif // COMMAND_PROTOCOL_HPP
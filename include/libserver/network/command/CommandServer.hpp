@@ -22,11 +22,20 @@
 
 #include "CommandProtocol.hpp"
 #include "libserver/Constants.hpp"
+#include "libserver/network/CommandMetrics.hpp"
+#include "libserver/network/HandlerError.hpp"
 #include "libserver/network/Server.hpp"
+#include "libserver/network/TrafficCapture.hpp"
 #include "libserver/util/Stream.hpp"
 
+#include <filesystem>
+#include <memory>
+#include <optional>
 #include <queue>
+#include <string>
+#include <type_traits>
 #include <unordered_map>
+#include <vector>
 
 namespace server
 {
@@ -34,8 +43,11 @@ namespace server
 namespace asio = network::asio;
 using ClientId = network::ClientId;
 
-//! A command handler.
-using RawCommandHandler = std::function<void(ClientId, SourceStream&)>;
+//! A command handler. Sets the time point at which the command was read,
+//! which is left empty if the reading throws.
+//! @returns Result of the handler.
+using RawCommandHandler = std::function<network::HandlerResult(
+  ClientId, SourceStream&, std::optional<network::CommandMetrics::Clock::time_point>& decodedAt)>;
 
 //! A command supplier.
 using CommandSupplier = std::function<void(SinkStream&)>;
@@ -85,6 +97,11 @@ public:
     EventHandlerInterface& events);
   ~CommandServer();
 
+  //! Sets the options of the sockets of the accepted clients.
+  //! Must be called before the server begins.
+  //! @param options Socket options.
+  void SetSocketOptions(const network::SocketOptions& options);
+
   //! Begins the server.
   //! @param address Address.
   //! @param port Port.
@@ -97,17 +114,31 @@ public:
   void DisconnectClient(ClientId clientId);
 
   //! Registers a command handler.
-  //! @param commandId ID of the command to register the handler for.
+  //! The handler either returns nothing and signals failures by throwing,
+  //! or returns a `network::HandlerResult` whose errors are counted per kind without unwinding.
+  //! @tparam C Command to register the handler for.
   //! @param handler Handler of the command.
-  template <ReadableCommandStruct C>
-  void RegisterCommandHandler(
-    std::function<void(ClientId clientId, const C& command)> handler)
+  template <ReadableCommandStruct C, typename Handler>
+  void RegisterCommandHandler(Handler handler)
   {
-    _handlers[C::GetCommand()] = [handler](ClientId clientId, SourceStream& source)
+    _handlers[C::GetCommand()] = [handler = std::move(handler)](
+      ClientId clientId,
+      SourceStream& source,
+      std::optional<network::CommandMetrics::Clock::time_point>& decodedAt) -> network::HandlerResult
     {
       C command;
       C::Read(command, source);
-      handler(clientId, command);
+      decodedAt = network::CommandMetrics::Clock::now();
+
+      if constexpr (std::is_void_v<std::invoke_result_t<const Handler&, ClientId, const C&>>)
+      {
+        handler(clientId, command);
+        return {};
+      }
+      else
+      {
+        return handler(clientId, command);
+      }
     };
   }
 
@@ -127,6 +158,57 @@ public:
 
   void SetCode(ClientId client, protocol::XorCode code);
 
+  //! Begins capturing the received commands to a file.
+  //! Must be called before the server begins hosting.
+  //! @param path Path to the capture file.
+  //! @throw std::runtime_error If the capture file can't be opened.
+  void BeginCapture(const std::filesystem::path& path);
+
+  //! Returns the per-command metrics of the server.
+  [[nodiscard]] const network::CommandMetrics& GetMetrics() const;
+
+  //! Returns the count of the connected clients.
+  [[nodiscard]] size_t GetClientCount() const;
+
+  //! Returns the memory held by the buffers of the connected clients.
+  [[nodiscard]] network::BufferMemoryUsage GetBufferMemoryUsage() const;
+
+  //! Returns the network statistics of the listener, updated every network tick.
+  [[nodiscard]] network::ListenerStatistics GetStatistics() const;
+
+  //! Returns the network statistics of a client, updated every network tick.
+  //! @param clientId ID of the client.
+  //! @returns Network statistics, or empty if the client is not connected.
+  [[nodiscard]] std::optional<network::ClientStatistics> GetClientStatistics(
+    network::ClientId clientId) const;
+
+  //! Returns the statistics of the connection admission, including the rejections.
+  [[nodiscard]] network::AdmissionStatistics GetAdmissionStatistics() const;
+
+  //! Stops accepting new clients, the connected clients are served until they disconnect.
+  //! Thread-safe.
+  void StopAccepting();
+
+  //! Disconnects all the clients. Thread-safe.
+  void DisconnectAllClients();
+
+  //! Runs a task on the network thread, which handles the commands. Thread-safe.
+  //! @param task Task to run.
+  void Post(std::function<void()> task);
+
+  //! Returns the listening socket, used to hand it off to the next process.
+  //! @returns Listening socket, or empty if the server does not accept clients.
+  [[nodiscard]] std::optional<network::Server::ListenerHandle> GetListenerHandle() const;
+
+  //! Sets the commands whose data is dumped to the debug log by all command servers.
+  //! Data of the other commands is never formatted.
+  //! Must be called before the servers begin hosting.
+  //! @param incomingCommands Names of the commands whose received data is dumped.
+  //! @param outgoingCommands Names of the commands whose sent data is dumped.
+  static void SetCommandDataDumps(
+    const std::vector<std::string>& incomingCommands,
+    const std::vector<std::string>& outgoingCommands);
+
 private:
   class NetworkEventHandler
     : public network::EventHandlerInterface
@@ -149,13 +231,15 @@ private:
     protocol::Command commandId,
     CommandSupplier supplier);
 
-  bool debugIncomingCommandData = constants::DebugCommands;
-  bool debugOutgoingCommandData = constants::DebugCommands;
   bool debugCommands = constants::DebugCommands;
 
   std::unordered_map<protocol::Command, RawCommandHandler> _handlers{};
   std::unordered_map<ClientId, CommandClient> _clients{};
 
+  network::CommandMetrics _metrics;
+  //! Capture of the received commands, if enabled.
+  std::unique_ptr<network::capture::Writer> _capture;
+
   EventHandlerInterface& _eventHandler;
   NetworkEventHandler _serverNetworkEventHandler;
 
@@ -25,6 +25,7 @@
 #include <array>
 #include <bitset>
 #include <cstdint>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -48,6 +49,24 @@ enum class TeamColor : uint32_t
   Blue = 3
 };
 
+//! Structures serialized in advance and written as they are.
+//! Lets the cached serialized forms of the records be concatenated
+//! instead of serializing every structure again.
+struct EncodedStructures
+{
+  //! Count of the structures.
+  size_t count{};
+  //! The serialized structures, concatenated.
+  std::vector<std::byte> data{};
+
+  //! Appends a serialized structure.
+  //! @param structure Serialized structure.
+  void Append(std::span<const std::byte> structure);
+
+  static void Write(const EncodedStructures& value, SinkStream& stream);
+  static void Read(EncodedStructures& value, SourceStream& stream);
+};
+
 //! Item
 struct Item
 {
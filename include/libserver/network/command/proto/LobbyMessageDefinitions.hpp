@@ -283,8 +283,10 @@ struct AcCmdCLShowInventory
 //! Clientbound show inventory response.
 struct LobbyCommandShowInventoryOK
 {
-  std::vector<Item> items{};
-  std::vector<Horse> horses{};
+  //! Serialized items.
+  EncodedStructures items{};
+  //! Serialized horses.
+  EncodedStructures horses{};
 
   static Command GetCommand()
   {
@@ -5,11 +5,15 @@
 #ifndef WEBSOCKETSERVER_HPP
 #define WEBSOCKETSERVER_HPP
 
-#include <nlohmann/json.hpp>
-#include <boost/asio/streambuf.hpp>
+#include <boost/asio.hpp>
 #include <boost/beast.hpp>
 
-#include <queue>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_set>
 
 namespace server::websocket
 {
@@ -17,52 +21,86 @@ namespace server::websocket
 namespace asio = boost::asio;
 namespace beast = boost::beast;
 
-class Client
-{
+class HttpSession;
+class Session;
 
+//! A response to an HTTP request.
+struct Response
+{
+  //! Status of the response.
+  beast::http::status status{beast::http::status::ok};
+  //! Content type of the body.
+  std::string contentType{"text/plain"};
+  //! Body of the response.
+  std::string body;
 };
 
-class Server
+//! A lightweight HTTP server which answers GET requests and upgrades
+//! WebSocket requests to sessions receiving the broadcast messages.
+//! All the I/O runs on the thread which begins the server.
+class Server final
 {
-  class Session
-  {
-  public:
-    enum class Id : size_t{};
-
-    explicit Session(asio::ip::tcp::socket socket);
-    ~Session() = default;
+public:
+  //! Handler of the HTTP GET requests.
+  //! @param target Target of the request, the path with the query.
+  //! @returns Response to the request.
+  using RequestHandler = std::function<Response(std::string_view target)>;
 
-    Session(const Session&) = delete;
-    void operator=(const Session&) = delete;
+  //! Constructor.
+  //! @param requestHandler Handler of the HTTP GET requests.
+  explicit Server(RequestHandler requestHandler);
+  ~Server();
 
-    Session(Session&&) = delete;
-    void operator=(Session&&) = delete;
+  Server(const Server&) = delete;
+  Server& operator=(const Server&) = delete;
 
-    void QueueData(const nlohmann::json& data);
+  //! Begins the server on the current thread.
+  //! Blocks the current thread until stopped.
+  //! @param address Address of the interface to bind to.
+  //! @param port Port to bind to, `0` binds to any free port.
+  //! @throw std::runtime_error
+  void Begin(const asio::ip::address& address, uint16_t port);
 
-  private:
-    asio::streambuf _incomingBuffer;
-    asio::streambuf _outgoingBuffer;
-    std::queue<nlohmann::json> _queue;
-    asio::ip::tcp::socket _socket;
-  };
+  //! Ends the server.
+  void End();
 
-  class EventHandler
-  {
-    virtual ~EventHandler() = default;
+  //! Sends a text message to all the WebSocket sessions.
+  //! Sessions which do not keep up with the messages miss some of them.
+  //! @param message Message to send.
+  void Broadcast(std::string message);
 
-    virtual void OnSessionConnected(Session& session);
-    virtual void OnSessionDisconnected(Session& session);
-    virtual void OnSessionDataReceived(Session& session) = 0;
-  };
+  //! Returns the port the server is bound to, `0` if not bound yet.
+  [[nodiscard]] uint16_t GetPort() const;
 
-public:
-  void Host();
-  void GetSession(Session::Id id);
+  //! Returns the count of the open WebSocket sessions.
+  [[nodiscard]] size_t GetSessionCount() const;
 
 private:
+  friend class HttpSession;
+  friend class Session;
+
+  void AcceptLoop();
+
+  //! Upgrades the HTTP connection to a WebSocket session.
+  //! @param socket Socket of the connection.
+  //! @param request Upgrade request.
+  void OnUpgrade(
+    asio::ip::tcp::socket&& socket,
+    beast::http::request<beast::http::string_body>&& request);
+  //! Handles an opened WebSocket session.
+  void OnSessionOpened(const std::shared_ptr<Session>& session);
+  //! Handles a closed WebSocket session.
+  void OnSessionClosed(const std::shared_ptr<Session>& session);
+
   asio::io_context _ioContext{};
-  std::unordered_map<Session::Id, Session> _sessions;
+  asio::ip::tcp::acceptor _acceptor;
+
+  RequestHandler _requestHandler;
+
+  //! Open WebSocket sessions, accessed only from the I/O thread.
+  std::unordered_set<std::shared_ptr<Session>> _sessions;
+  std::atomic<size_t> _sessionCount{0};
+  std::atomic<uint16_t> _port{0};
 };
 
 } // namespace server::websocket
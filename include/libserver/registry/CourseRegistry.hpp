@@ -20,10 +20,13 @@
 #ifndef COURSEREGISTRY_HPP
 #define COURSEREGISTRY_HPP
 
+#include "libserver/util/IdTable.hpp"
+#include "libserver/util/Rcu.hpp"
+
+#include <algorithm>
 #include <array>
+#include <cmath>
 #include <cstdint>
-
-#include <unordered_map>
 #include <filesystem>
 #include <vector>
 
@@ -67,6 +70,76 @@ struct Course
   {
   };
 
+  //! A precomputed runtime layout of a map block in a game mode.
+  struct MapLayout
+  {
+    //! A distance from an item spawner within which the item is spawned for a racer.
+    static constexpr float ItemSpawnDistance = 90.0f;
+
+    struct ItemSpawner
+    {
+      //! A deck item ID of the spawner.
+      uint32_t deckId{};
+      //! A world position of the spawner with the map offset applied.
+      std::array<float, 3> position{};
+      //! Item types the spawner can spawn.
+      std::vector<uint32_t> itemTypes;
+    };
+
+    //! A uniform grid of the item spawners over the horizontal (X, Z) plane.
+    //! A cell is `ItemSpawnDistance` wide, so the spawners in range of a position
+    //! are always within the cell of the position and its neighbouring cells.
+    struct SpawnerGrid
+    {
+      //! An origin of the grid.
+      float originX{};
+      float originZ{};
+      //! A count of the columns (X) and rows (Z) of the grid.
+      uint32_t columns{};
+      uint32_t rows{};
+      //! Offsets of the cells to the spawner indices, one more than there are cells.
+      std::vector<uint32_t> cellOffsets;
+      //! Indices of the spawners ordered by cells.
+      std::vector<uint32_t> spawnerIndices;
+    };
+
+    //! Item spawners in the order they are spawned in.
+    std::vector<ItemSpawner> itemSpawners;
+    //! A spatial index of the item spawners.
+    SpawnerGrid spawnerGrid;
+
+    //! Invokes the callback with the index of every item spawner in the cells
+    //! around the position. The callback still has to check the actual distance.
+    //! @param position Position.
+    //! @param callback Callback invoked with the spawner index.
+    template <typename Callback>
+    void ForEachSpawnerNear(const std::array<float, 3>& position, Callback&& callback) const
+    {
+      if (spawnerGrid.columns == 0 || spawnerGrid.rows == 0)
+        return;
+
+      const auto column = static_cast<int64_t>(
+        std::floor((position[0] - spawnerGrid.originX) / ItemSpawnDistance));
+      const auto row = static_cast<int64_t>(
+        std::floor((position[2] - spawnerGrid.originZ) / ItemSpawnDistance));
+
+      const auto firstColumn = std::max<int64_t>(column - 1, 0);
+      const auto lastColumn = std::min<int64_t>(column + 1, spawnerGrid.columns - 1);
+      const auto firstRow = std::max<int64_t>(row - 1, 0);
+      const auto lastRow = std::min<int64_t>(row + 1, spawnerGrid.rows - 1);
+
+      for (auto cellRow = firstRow; cellRow <= lastRow; ++cellRow)
+      {
+        for (auto cellColumn = firstColumn; cellColumn <= lastColumn; ++cellColumn)
+        {
+          const auto cell = cellRow * spawnerGrid.columns + cellColumn;
+          for (auto idx = spawnerGrid.cellOffsets[cell]; idx < spawnerGrid.cellOffsets[cell + 1]; ++idx)
+            callback(spawnerGrid.spawnerIndices[idx]);
+        }
+      }
+    }
+  };
+
   struct MapBlockInfo
   {
     //! A required level to play the map.
@@ -92,6 +165,9 @@ struct Course
 
     //! A collection of deck item instances.
     std::vector<DeckItemInstance> deckItems;
+
+    //! Layouts of the map precomputed at load, indexed by game mode types.
+    util::IdTable<MapLayout> layouts;
   };
 
   struct DeckItemInfo
@@ -109,29 +185,50 @@ struct Course
 class CourseRegistry
 {
 public:
+  //! An immutable snapshot of the course registry.
+  struct Snapshot
+  {
+    //! A table of game mode infos indexed by game mode types.
+    util::IdTable<Course::GameModeInfo> gameModeInfo;
+    //! A table of map block infos indexed by map block IDs.
+    util::IdTable<Course::MapBlockInfo> mapBlockInfo;
+    //! A table of deck item infos indexed by deck IDs.
+    util::IdTable<Course::DeckItemInfo> deckItemInfo;
+    //! A table of item type infos indexed by item type IDs.
+    util::IdTable<Course::ItemTypeInfo> itemTypeInfo;
+
+    [[nodiscard]] const Course::GameModeInfo& GetCourseGameModeInfo(
+      uint8_t type) const;
+    [[nodiscard]] const Course::MapBlockInfo& GetMapBlockInfo(
+      uint32_t id) const;
+    [[nodiscard]] const Course::DeckItemInfo& GetDeckItemInfo(
+      uint32_t deckId) const;
+    [[nodiscard]] const Course::ItemTypeInfo& GetItemTypeInfo(
+      uint32_t itemTypeId) const;
+    [[nodiscard]] const Course::MapLayout& GetMapLayout(
+      uint8_t gameModeType,
+      uint32_t mapBlockId) const;
+  };
+
+  //! A pinned view of the course registry snapshot.
+  //! References obtained from the view are valid for as long as the view is held.
+  using View = util::Rcu<Snapshot>::View;
+
   CourseRegistry();
 
+  //! Reads the config and publishes it as a new snapshot.
+  //! The current snapshot is left intact if the config fails to load.
+  //! @param configPath Path to the config.
   void ReadConfig(const std::filesystem::path& configPath);
-
-  [[nodiscard]] const Course::GameModeInfo& GetCourseGameModeInfo(
-    uint8_t type);
-  [[nodiscard]] const Course::MapBlockInfo& GetMapBlockInfo(
-    uint32_t id);
-  [[nodiscard]] const Course::DeckItemInfo& GetDeckItemInfo(
-    uint32_t deckId);
-  [[nodiscard]] const Course::ItemTypeInfo& GetItemTypeInfo(
-    uint32_t itemTypeId);
+  //! Pins the current snapshot of the registry.
+  //! @returns View of the current snapshot.
+  [[nodiscard]] View Pin() const noexcept;
+  //! Returns the count of the entries of the current snapshot and their estimated size.
+  //! Safe to call from any thread.
+  [[nodiscard]] util::MemoryUsage GetMemoryUsage() const;
 
 private:
-  //! A collection of game mode infos.
-  std::unordered_map<uint8_t, Course::GameModeInfo> _gameModeInfo;
-  //! A collection of map block infos.
-  std::unordered_map<uint32_t, Course::MapBlockInfo> _mapBlockInfo;
-  //! A collection of deck item infos.
-  std::unordered_map<uint32_t, Course::DeckItemInfo> _deckItemInfo;
-
-  //! A collection of item type infos.
-  std::unordered_map<uint32_t, Course::ItemTypeInfo> _itemTypeInfo;
+  util::Rcu<Snapshot> _snapshot;
  };
 
 }
@@ -24,6 +24,7 @@
 #include <unordered_map>
 
 #include "libserver/data/DataDefinitions.hpp"
+#include "libserver/util/MemoryUsage.hpp"
 
 namespace server::registry
 {
@@ -74,6 +75,9 @@ public:
   void GiveHorseRandomPotential(
     data::Horse::Potential& potential);
 
+  //! Returns the count of the horse parts and their estimated size.
+  [[nodiscard]] util::MemoryUsage GetMemoryUsage() const;
+
 private:
   std::random_device _randomDevice;
 
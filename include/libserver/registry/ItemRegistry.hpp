@@ -20,11 +20,13 @@
 #ifndef ITEMREGISTRY_HPP
 #define ITEMREGISTRY_HPP
 
+#include "libserver/util/IdTable.hpp"
+#include "libserver/util/Rcu.hpp"
+
 #include <cstdint>
 #include <filesystem>
 #include <optional>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 namespace server::registry
@@ -149,15 +151,34 @@ struct Package
 class ItemRegistry
 {
 public:
+  //! An immutable snapshot of the item registry.
+  struct Snapshot
+  {
+    //! A table of items indexed by their TIDs.
+    util::IdTable<Item> items;
+    //! A table of packages indexed by their IDs.
+    util::IdTable<Package> packages;
+  };
+
+  //! A pinned view of the item registry snapshot.
+  using View = util::Rcu<Snapshot>::View;
+
+  //! Reads the config and publishes it as a new snapshot.
+  //! The current snapshot is left intact if the config fails to load.
+  //! @param configPath Path to the config.
   void ReadConfig(const std::filesystem::path& configPath);
-  [[nodiscard]] std::optional<Item> GetItem(uint32_t tid);
-  [[nodiscard]] std::unordered_map<uint32_t, Item> GetItems();
-  [[nodiscard]] std::optional<Package> GetPackage(uint32_t packageId);
-  [[nodiscard]] std::unordered_map<uint32_t, Package> GetPackages();
+  //! Pins the current snapshot of the registry.
+  //! @returns View of the current snapshot.
+  [[nodiscard]] View Pin() const noexcept;
+  //! Returns the count of the entries of the current snapshot and their estimated size.
+  //! Safe to call from any thread.
+  [[nodiscard]] util::MemoryUsage GetMemoryUsage() const;
+
+  [[nodiscard]] std::optional<Item> GetItem(uint32_t tid) const;
+  [[nodiscard]] std::optional<Package> GetPackage(uint32_t packageId) const;
 
 private:
-  std::unordered_map<uint32_t, Item> _items;
-  std::unordered_map<uint32_t, Package> _packages;
+  util::Rcu<Snapshot> _snapshot;
 };
 
 } // namespace server::registry
@@ -20,9 +20,12 @@
 #ifndef MAGICREGISTRY_HPP
 #define MAGICREGISTRY_HPP
 
+#include "libserver/util/IdTable.hpp"
+#include "libserver/util/Rcu.hpp"
+
+#include <chrono>
 #include <cstdint>
 #include <filesystem>
-#include <unordered_map>
 #include <vector>
 
 namespace server::registry
@@ -30,6 +33,49 @@ namespace server::registry
 
 struct Magic
 {
+  //! Server-side effect descriptor of a magic slot, compiled at load.
+  struct EffectInfo
+  {
+    //! Racers the effect is applied to when the magic is used.
+    enum class Target
+    {
+      //! Only the racer the magic hits.
+      Hit,
+      //! The racer using the magic.
+      Self,
+      //! The racer using the magic and their team mates.
+      Allies,
+      //! All the racers not in the team of the racer using the magic.
+      Opponents,
+    } target{Target::Hit};
+
+    //! A racer state held for the duration of the effect.
+    enum class State
+    {
+      None,
+      Shield,
+      CriticalShield,
+      HotRodding,
+      CritChance,
+      GaugeBuff,
+      Darkness,
+    } state{State::None};
+
+    //! What re-applying the effect to a racer already under it does.
+    enum class Stacking
+    {
+      //! Restarts the duration of the effect and notifies it again.
+      Refresh,
+      //! Keeps the current effect.
+      Ignore,
+    } stacking{Stacking::Refresh};
+
+    //! A duration of the effect on a racer.
+    std::chrono::milliseconds duration{};
+    //! A lifetime of the obstacles placed by the magic, zero if it places none.
+    std::chrono::milliseconds obstacleLifetime{};
+  };
+
   //! Per-magic-slot definition (MagicSlotInfo).
   struct SlotInfo
   {
@@ -66,6 +112,9 @@ struct Magic
 
     uint32_t affectByCriticalAura{};
     uint32_t criticalByDarkFire{};
+
+    //! An effect descriptor of the slot.
+    EffectInfo effect{};
   };
 
 };
@@ -73,23 +122,42 @@ struct Magic
 class MagicRegistry
 {
 public:
-  MagicRegistry() = default;
+  //! An immutable snapshot of the magic registry.
+  struct Snapshot
+  {
+    //! A table of slot infos indexed by their types.
+    util::IdTable<Magic::SlotInfo> slotInfo{};
+    //! A table of slot types indexed by their skill effect IDs.
+    //! Basic and critical slots share an effect, the basic slot is preferred.
+    util::IdTable<uint32_t> slotTypeByEffectId{};
+    //! Basic-type slot IDs available in solo mode (teamMode == 0).
+    std::vector<uint32_t> soloPool{};
+    //! Basic-type slot IDs available in team mode (all teamMode values).
+    std::vector<uint32_t> teamPool{};
+
+    [[nodiscard]] const Magic::SlotInfo& GetSlotInfo(uint32_t type) const;
+    [[nodiscard]] const Magic::SlotInfo& GetSlotInfoByEffectId(uint32_t effectId) const;
+  };
 
-  void ReadConfig(const std::filesystem::path& configPath);
+  //! A pinned view of the magic registry snapshot.
+  //! References obtained from the view are valid for as long as the view is held.
+  using View = util::Rcu<Snapshot>::View;
 
-  [[nodiscard]] const Magic::SlotInfo& GetSlotInfo(uint32_t type) const;
-  [[nodiscard]] const Magic::SlotInfo& GetSlotInfoByEffectId(uint32_t effectId) const;
-  [[nodiscard]] const std::unordered_map<uint32_t, Magic::SlotInfo>& GetSlotInfoMap() const;
+  MagicRegistry() = default;
 
-  //! Basic-type slot IDs available in solo mode (teamMode == 0).
-  [[nodiscard]] const std::vector<uint32_t>& GetSoloPool() const;
-  //! Basic-type slot IDs available in team mode (all teamMode values).
-  [[nodiscard]] const std::vector<uint32_t>& GetTeamPool() const;
+  //! Reads the config and publishes it as a new snapshot.
+  //! The current snapshot is left intact if the config fails to load.
+  //! @param configPath Path to the config.
+  void ReadConfig(const std::filesystem::path& configPath);
+  //! Pins the current snapshot of the registry.
+  //! @returns View of the current snapshot.
+  [[nodiscard]] View Pin() const noexcept;
+  //! Returns the count of the entries of the current snapshot and their estimated size.
+  //! Safe to call from any thread.
+  [[nodiscard]] util::MemoryUsage GetMemoryUsage() const;
 
 private:
-  std::unordered_map<uint32_t, Magic::SlotInfo> _slotInfo{};
-  std::vector<uint32_t> _soloPool{};
-  std::vector<uint32_t> _teamPool{};
+  util::Rcu<Snapshot> _snapshot;
 };
 
 } // namespace server::registry
@@ -21,9 +21,10 @@
 #define PETREGISTRY_HPP
 
 #include "libserver/data/DataDefinitions.hpp"
+#include "libserver/util/IdTable.hpp"
+#include "libserver/util/Rcu.hpp"
 
 #include <filesystem>
-#include <unordered_map>
 #include <vector>
 
 namespace server::registry
@@ -48,14 +49,34 @@ struct PetInfo
 class PetRegistry final
 {
 public:
+  //! An immutable snapshot of the pet registry.
+  struct Snapshot
+  {
+    //! A table of eggs indexed by their item TIDs.
+    util::IdTable<EggInfo> eggs;
+    //! A table of pets indexed by their item TIDs.
+    util::IdTable<PetInfo> pets;
+  };
+
+  //! A pinned view of the pet registry snapshot.
+  using View = util::Rcu<Snapshot>::View;
+
+  //! Reads the config and publishes it as a new snapshot.
+  //! The current snapshot is left intact if the config fails to load.
+  //! @param configPath Path to the config.
   void ReadConfig(const std::filesystem::path& configPath);
+  //! Pins the current snapshot of the registry.
+  //! @returns View of the current snapshot.
+  [[nodiscard]] View Pin() const noexcept;
+  //! Returns the count of the entries of the current snapshot and their estimated size.
+  //! Safe to call from any thread.
+  [[nodiscard]] util::MemoryUsage GetMemoryUsage() const;
 
-  EggInfo GetEggInfo(data::Tid eggItemTid);
-  PetInfo GetPetInfo(data::Tid petItemTid);
+  EggInfo GetEggInfo(data::Tid eggItemTid) const;
+  PetInfo GetPetInfo(data::Tid petItemTid) const;
 
 private:
-  std::unordered_map<data::Tid, EggInfo> _eggs;
-  std::unordered_map<data::Tid, PetInfo> _pets;
+  util::Rcu<Snapshot> _snapshot;
 };
 
 } // namespace server::registry
@@ -0,0 +1,68 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#ifndef COMMANDIDSET_HPP
+#define COMMANDIDSET_HPP
+
+#include <bitset>
+#include <cstdint>
+#include <limits>
+
+namespace server::util
+{
+
+//! A set of 16-bit command IDs with constant time lookups.
+class CommandIdSet final
+{
+public:
+  //! Inserts the command ID to the set.
+  //! @param id Command ID.
+  void Insert(uint16_t id) noexcept
+  {
+    _ids.set(id);
+  }
+
+  //! Erases the command ID from the set.
+  //! @param id Command ID.
+  void Erase(uint16_t id) noexcept
+  {
+    _ids.reset(id);
+  }
+
+  //! Returns whether the set contains the command ID.
+  //! @param id Command ID.
+  //! @returns `true` if the set contains the command ID, `false` otherwise.
+  [[nodiscard]] bool Contains(uint16_t id) const noexcept
+  {
+    return _ids.test(id);
+  }
+
+  //! Returns whether the set is empty.
+  [[nodiscard]] bool Empty() const noexcept
+  {
+    return _ids.none();
+  }
+
+private:
+  std::bitset<std::numeric_limits<uint16_t>::max() + 1> _ids;
+};
+
+} // namespace server::util
+
+#endif // COMMANDIDSET_HPP
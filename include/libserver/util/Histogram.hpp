@@ -0,0 +1,134 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#ifndef HISTOGRAM_HPP
+#define HISTOGRAM_HPP
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+
+namespace server::util
+{
+
+//! A lock-free histogram of unsigned values with logarithmic buckets.
+//! Every power of two is split into linear sub-buckets, so a recorded value
+//! is known with a relative error of at most 1/SubBucketCount.
+//! Values may be recorded concurrently from any thread.
+class Histogram final
+{
+public:
+  //! Count of the linear sub-buckets per power of two.
+  static constexpr uint32_t SubBucketBits = 3;
+  static constexpr uint32_t SubBucketCount = 1u << SubBucketBits;
+  //! Highest power of two with its own buckets, larger values are clamped.
+  static constexpr uint32_t MaxMagnitude = 40;
+  //! Count of the buckets.
+  static constexpr uint32_t BucketCount =
+    SubBucketCount + (MaxMagnitude - SubBucketBits + 1) * SubBucketCount;
+
+  //! A point in time copy of the histogram.
+  struct Snapshot
+  {
+    std::array<uint64_t, BucketCount> buckets{};
+    uint64_t count{};
+    uint64_t sum{};
+    uint64_t max{};
+
+    //! Returns the value at the percentile.
+    //! @param percentile Percentile in the range [0, 100].
+    //! @returns Upper bound of the bucket containing the percentile,
+    //!          or 0 if the histogram is empty.
+    [[nodiscard]] uint64_t GetPercentile(double percentile) const;
+
+    //! Returns the mean of the values.
+    [[nodiscard]] double GetMean() const;
+
+    //! Adds the values of the other snapshot to this one.
+    //! @param other Other snapshot.
+    void Merge(const Snapshot& other);
+  };
+
+  //! Records the value.
+  //! @param value Value.
+  void Record(uint64_t value) noexcept
+  {
+    _buckets[GetBucketIndex(value)].fetch_add(1, std::memory_order::relaxed);
+    _count.fetch_add(1, std::memory_order::relaxed);
+    _sum.fetch_add(value, std::memory_order::relaxed);
+
+    uint64_t max = _max.load(std::memory_order::relaxed);
+    while (value > max
+      && not _max.compare_exchange_weak(max, value, std::memory_order::relaxed))
+    {
+    }
+  }
+
+  //! Returns a copy of the histogram. The copy is not atomic as a whole,
+  //! values recorded concurrently might be only partially included.
+  [[nodiscard]] Snapshot GetSnapshot() const;
+
+  //! Returns the count of the recorded values.
+  [[nodiscard]] uint64_t GetCount() const noexcept
+  {
+    return _count.load(std::memory_order::relaxed);
+  }
+
+  //! Returns the bucket index of the value.
+  //! @param value Value.
+  //! @returns Bucket index.
+  [[nodiscard]] static constexpr uint32_t GetBucketIndex(uint64_t value) noexcept
+  {
+    if (value < SubBucketCount)
+      return static_cast<uint32_t>(value);
+
+    const uint32_t magnitude = static_cast<uint32_t>(std::bit_width(value)) - 1;
+    if (magnitude > MaxMagnitude)
+      return BucketCount - 1;
+
+    const auto subBucket = static_cast<uint32_t>(
+      (value >> (magnitude - SubBucketBits)) & (SubBucketCount - 1));
+    return SubBucketCount + (magnitude - SubBucketBits) * SubBucketCount + subBucket;
+  }
+
+  //! Returns the highest value of the bucket.
+  //! @param bucketIndex Bucket index.
+  //! @returns Highest value which belongs to the bucket.
+  [[nodiscard]] static constexpr uint64_t GetBucketUpperBound(uint32_t bucketIndex) noexcept
+  {
+    if (bucketIndex < SubBucketCount)
+      return bucketIndex;
+
+    const uint32_t magnitude = (bucketIndex - SubBucketCount) / SubBucketCount + SubBucketBits;
+    const uint64_t subBucket = (bucketIndex - SubBucketCount) % SubBucketCount;
+    const uint64_t width = uint64_t{1} << (magnitude - SubBucketBits);
+    return (uint64_t{1} << magnitude) + (subBucket + 1) * width - 1;
+  }
+
+private:
+  std::array<std::atomic<uint64_t>, BucketCount> _buckets{};
+  std::atomic<uint64_t> _count{};
+  std::atomic<uint64_t> _sum{};
+  std::atomic<uint64_t> _max{};
+};
+
+} // namespace server::util
+
+#endif // HISTOGRAM_HPP
@@ -0,0 +1,336 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#ifndef IDTABLE_HPP
+#define IDTABLE_HPP
+
+#include "libserver/util/MemoryUsage.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace server::util
+{
+
+//! An immutable lookup table of values indexed by 32-bit IDs.
+//! The table is built once from a fixed set of IDs. A compact ID range is indexed
+//! directly by a dense array, a sparse one by a minimal perfect hash (hash and displace).
+//! Either way a lookup is two array reads and a single key comparison.
+template <typename Value>
+class IdTable final
+{
+public:
+  using Id = uint32_t;
+
+  //! Default constructor initializing an empty table.
+  IdTable() = default;
+
+  //! Builds the table from the entries.
+  //! If an ID repeats, the first entry with that ID is kept.
+  //! @param entries Entries of the table.
+  //! @throws std::runtime_error if the perfect hash could not be built.
+  explicit IdTable(std::vector<std::pair<Id, Value>> entries)
+  {
+    // Order the entries by their IDs, keep the first entry of each ID.
+    std::ranges::stable_sort(entries, {}, &std::pair<Id, Value>::first);
+    const auto [first, last] = std::ranges::unique(entries, {}, &std::pair<Id, Value>::first);
+    entries.erase(first, last);
+
+    if (entries.empty())
+      return;
+
+    const uint64_t idRange = static_cast<uint64_t>(entries.back().first)
+      - entries.front().first + 1;
+
+    if (idRange <= MaxDenseRangeRatio * entries.size() + MinDenseRange)
+      BuildDense(std::move(entries), idRange);
+    else
+      BuildPerfectHash(std::move(entries));
+  }
+
+  //! Finds the value with the specified ID.
+  //! @param id ID of the value.
+  //! @returns Pointer to the value, `nullptr` if there is no value with that ID.
+  [[nodiscard]] const Value* Find(Id id) const noexcept
+  {
+    uint32_t slot;
+    if (_isDense)
+    {
+      // Underflow of IDs below the minimum ID wraps around beyond the dense index.
+      const Id offset = id - _minId;
+      if (offset >= _denseSlots.size())
+        return nullptr;
+      slot = _denseSlots[offset];
+      if (slot == InvalidSlot)
+        return nullptr;
+    }
+    else
+    {
+      const auto hash = Hash(id, _bucketSeed);
+      const auto bucket = Reduce(static_cast<uint32_t>(hash >> 32), _pilots.size());
+      slot = Reduce(Mix(static_cast<uint32_t>(hash) ^ _pilots[bucket]), _ids.size());
+      if (_ids[slot] != id)
+        return nullptr;
+    }
+
+    return &_values[slot];
+  }
+
+  //! Returns whether the table contains a value with the specified ID.
+  //! @param id ID of the value.
+  //! @returns `true` if the value is present, `false` otherwise.
+  [[nodiscard]] bool Contains(Id id) const noexcept
+  {
+    return Find(id) != nullptr;
+  }
+
+  //! Returns the count of values in the table.
+  [[nodiscard]] std::size_t Size() const noexcept
+  {
+    return _values.size();
+  }
+
+  //! Returns whether the table is empty.
+  [[nodiscard]] bool Empty() const noexcept
+  {
+    return _values.empty();
+  }
+
+  //! Returns whether the table is indexed by the dense array.
+  [[nodiscard]] bool IsDense() const noexcept
+  {
+    return _isDense;
+  }
+
+  //! Returns the IDs of the table.
+  //! The ID at an index corresponds to the value at the same index of `GetValues()`.
+  [[nodiscard]] std::span<const Id> GetIds() const noexcept
+  {
+    return _ids;
+  }
+
+  //! Returns the values of the table.
+  [[nodiscard]] std::span<const Value> GetValues() const noexcept
+  {
+    return _values;
+  }
+
+  //! Estimates the heap size of the table, excluding the heap owned by its values.
+  [[nodiscard]] std::size_t EstimateContainerHeapSize() const noexcept
+  {
+    return util::EstimateContainerHeapSize(_denseSlots)
+      + util::EstimateContainerHeapSize(_pilots)
+      + util::EstimateContainerHeapSize(_ids)
+      + util::EstimateContainerHeapSize(_values);
+  }
+
+private:
+  //! A slot marking an ID missing from the dense index.
+  static constexpr uint32_t InvalidSlot = std::numeric_limits<uint32_t>::max();
+  //! Max ratio of the ID range to the ID count for which the dense index is used.
+  static constexpr uint64_t MaxDenseRangeRatio = 4;
+  //! ID range which is always indexed densely regardless of the ID count.
+  static constexpr uint64_t MinDenseRange = 64;
+  //! Average count of IDs per bucket of the perfect hash.
+  static constexpr std::size_t IdsPerBucket = 4;
+  //! Max count of displacements tried per bucket before the hash is rebuilt with a new seed.
+  static constexpr uint32_t MaxDisplacementAttempts = 1u << 20;
+  //! Max count of bucket seeds tried before the build fails.
+  static constexpr uint32_t MaxBucketSeedAttempts = 16;
+
+  //! Hashes the ID with the seed (Fibonacci hashing).
+  //! The upper half selects the bucket, the lower half the slot.
+  static constexpr uint64_t Hash(Id id, uint32_t seed) noexcept
+  {
+    return ((static_cast<uint64_t>(seed) << 32) | id) * 0x9E3779B97F4A7C15ull;
+  }
+
+  //! Mixes the slot hash with the pilot applied.
+  static constexpr uint32_t Mix(uint32_t hash) noexcept
+  {
+    hash ^= hash >> 16;
+    hash *= 0x7FEB352Du;
+    hash ^= hash >> 15;
+    return hash;
+  }
+
+  //! Hashes the displacement of a bucket to its pilot.
+  static constexpr uint32_t HashDisplacement(uint32_t displacement) noexcept
+  {
+    return Mix(displacement * 0x9E3779B9u + 0x5EED);
+  }
+
+  //! Reduces the hash to the range [0, size) without a division.
+  static constexpr uint32_t Reduce(uint32_t hash, std::size_t size) noexcept
+  {
+    return static_cast<uint32_t>((static_cast<uint64_t>(hash) * size) >> 32);
+  }
+
+  void BuildDense(std::vector<std::pair<Id, Value>> entries, uint64_t idRange)
+  {
+    _isDense = true;
+    _minId = entries.front().first;
+    _denseSlots.assign(idRange, InvalidSlot);
+
+    _ids.reserve(entries.size());
+    _values.reserve(entries.size());
+    for (auto& [id, value] : entries)
+    {
+      _denseSlots[id - _minId] = static_cast<uint32_t>(_ids.size());
+      _ids.emplace_back(id);
+      _values.emplace_back(std::move(value));
+    }
+  }
+
+  void BuildPerfectHash(std::vector<std::pair<Id, Value>> entries)
+  {
+    _isDense = false;
+
+    const std::size_t idCount = entries.size();
+    const std::size_t bucketCount = (idCount + IdsPerBucket - 1) / IdsPerBucket;
+
+    std::vector<uint32_t> slots(idCount);
+    for (uint32_t bucketSeed = 0; bucketSeed < MaxBucketSeedAttempts; ++bucketSeed)
+    {
+      if (TryBuildPerfectHash(entries, bucketSeed, bucketCount, slots))
+      {
+        // Place the IDs and the values to their slots.
+        _ids.assign(idCount, 0);
+        std::vector<std::optional<Value>> values(idCount);
+        for (std::size_t idx = 0; idx < idCount; ++idx)
+        {
+          _ids[slots[idx]] = entries[idx].first;
+          values[slots[idx]].emplace(std::move(entries[idx].second));
+        }
+
+        _values.reserve(idCount);
+        for (auto& value : values)
+          _values.emplace_back(std::move(*value));
+        return;
+      }
+    }
+
+    throw std::runtime_error("Could not build the perfect hash of the ID table");
+  }
+
+  bool TryBuildPerfectHash(
+    const std::vector<std::pair<Id, Value>>& entries,
+    uint32_t bucketSeed,
+    std::size_t bucketCount,
+    std::vector<uint32_t>& slots)
+  {
+    const std::size_t idCount = entries.size();
+
+    // Distribute the IDs to the buckets.
+    std::vector<uint64_t> hashes(idCount);
+    std::vector<std::vector<uint32_t>> buckets(bucketCount);
+    for (uint32_t idx = 0; idx < idCount; ++idx)
+    {
+      hashes[idx] = Hash(entries[idx].first, bucketSeed);
+      buckets[Reduce(static_cast<uint32_t>(hashes[idx] >> 32), bucketCount)].emplace_back(idx);
+    }
+
+    // Place the largest buckets first, while most of the slots are still free.
+    std::vector<uint32_t> bucketOrder(bucketCount);
+    std::iota(bucketOrder.begin(), bucketOrder.end(), 0);
+    std::ranges::stable_sort(bucketOrder, std::ranges::greater{}, [&buckets](uint32_t bucket)
+    {
+      return buckets[bucket].size();
+    });
+
+    std::vector<bool> occupiedSlots(idCount, false);
+    std::vector<uint32_t> pilots(bucketCount, 0);
+    std::vector<uint32_t> bucketSlots;
+
+    for (const uint32_t bucket : bucketOrder)
+    {
+      const auto& bucketIds = buckets[bucket];
+      if (bucketIds.empty())
+        break;
+
+      bool isPlaced = false;
+      for (uint32_t displacement = 0; displacement < MaxDisplacementAttempts; ++displacement)
+      {
+        const auto pilot = HashDisplacement(displacement);
+
+        bucketSlots.clear();
+        for (const uint32_t idx : bucketIds)
+        {
+          const auto slot = Reduce(Mix(static_cast<uint32_t>(hashes[idx]) ^ pilot), idCount);
+          if (occupiedSlots[slot] || std::ranges::find(bucketSlots, slot) != bucketSlots.cend())
+            break;
+          bucketSlots.emplace_back(slot);
+        }
+
+        if (bucketSlots.size() != bucketIds.size())
+          continue;
+
+        for (std::size_t idx = 0; idx < bucketIds.size(); ++idx)
+        {
+          occupiedSlots[bucketSlots[idx]] = true;
+          slots[bucketIds[idx]] = bucketSlots[idx];
+        }
+
+        pilots[bucket] = pilot;
+        isPlaced = true;
+        break;
+      }
+
+      if (not isPlaced)
+        return false;
+    }
+
+    _bucketSeed = bucketSeed;
+    _pilots = std::move(pilots);
+    return true;
+  }
+
+  //! Whether the table is indexed by the dense array.
+  bool _isDense{true};
+  //! The minimum ID of the dense index.
+  Id _minId{};
+  //! Slots of the dense index indexed by the ID offset from the minimum ID.
+  std::vector<uint32_t> _denseSlots;
+  //! A seed of the perfect hash distributing IDs to buckets.
+  uint32_t _bucketSeed{};
+  //! Pilots (hashed displacements) of the perfect hash per bucket.
+  std::vector<uint32_t> _pilots;
+  //! IDs by slot.
+  std::vector<Id> _ids;
+  //! Values by slot.
+  std::vector<Value> _values;
+};
+
+//! Estimates the heap size of the table, including the heap owned by its values.
+template <typename Value>
+[[nodiscard]] std::size_t EstimateHeapSize(const IdTable<Value>& table) noexcept
+{
+  return table.EstimateContainerHeapSize() + EstimateElementHeapSize(table.GetValues());
+}
+
+} // namespace server::util
+
+#endif // IDTABLE_HPP
@@ -0,0 +1,296 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#ifndef MEMORYUSAGE_HPP
+#define MEMORYUSAGE_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace server::util
+{
+
+//! Estimated memory usage of a subsystem.
+struct MemoryUsage
+{
+  //! Count of the objects held by the subsystem.
+  uint64_t count{};
+  //! Estimated count of the bytes held by the subsystem on the heap.
+  uint64_t bytes{};
+
+  MemoryUsage& operator+=(const MemoryUsage& other) noexcept
+  {
+    count += other.count;
+    bytes += other.bytes;
+    return *this;
+  }
+};
+
+//! Estimated bookkeeping of the allocator per allocation.
+constexpr std::size_t AllocationOverhead = 16;
+//! Estimated size of a node of the ordered containers besides the value,
+//! the colour and the parent, left and right links.
+constexpr std::size_t TreeNodeOverhead = 4 * sizeof(void*) + AllocationOverhead;
+//! Estimated size of a node of the unordered containers besides the value,
+//! the next link and the cached hash.
+constexpr std::size_t HashNodeOverhead = sizeof(void*) + sizeof(std::size_t) + AllocationOverhead;
+//! Estimated size of a node of the lists besides the value, the previous and the next link.
+constexpr std::size_t ListNodeOverhead = 2 * sizeof(void*) + AllocationOverhead;
+
+// The container estimates only account for the memory of the container itself,
+// the deep estimates below add the memory owned by the elements.
+
+//! Estimates the heap size of the vector, excluding the heap owned by its elements.
+template <typename T, typename Allocator>
+[[nodiscard]] std::size_t EstimateContainerHeapSize(const std::vector<T, Allocator>& container) noexcept
+{
+  if (container.capacity() == 0)
+    return 0;
+  return container.capacity() * sizeof(T) + AllocationOverhead;
+}
+
+//! Estimates the heap size of the list, excluding the heap owned by its elements.
+template <typename T, typename Allocator>
+[[nodiscard]] std::size_t EstimateContainerHeapSize(const std::list<T, Allocator>& container) noexcept
+{
+  return container.size() * (sizeof(T) + ListNodeOverhead);
+}
+
+//! Estimates the heap size of the set, excluding the heap owned by its elements.
+template <typename Key, typename Compare, typename Allocator>
+[[nodiscard]] std::size_t EstimateContainerHeapSize(
+  const std::set<Key, Compare, Allocator>& container) noexcept
+{
+  return container.size() * (sizeof(Key) + TreeNodeOverhead);
+}
+
+//! Estimates the heap size of the map, excluding the heap owned by its elements.
+template <typename Key, typename Value, typename Compare, typename Allocator>
+[[nodiscard]] std::size_t EstimateContainerHeapSize(
+  const std::map<Key, Value, Compare, Allocator>& container) noexcept
+{
+  return container.size() * (sizeof(std::pair<const Key, Value>) + TreeNodeOverhead);
+}
+
+//! Estimates the heap size of the unordered set, excluding the heap owned by its elements.
+template <typename Key, typename Hash, typename Equal, typename Allocator>
+[[nodiscard]] std::size_t EstimateContainerHeapSize(
+  const std::unordered_set<Key, Hash, Equal, Allocator>& container) noexcept
+{
+  return container.bucket_count() * sizeof(void*)
+    + container.size() * (sizeof(Key) + HashNodeOverhead);
+}
+
+//! Estimates the heap size of the unordered map, excluding the heap owned by its elements.
+template <typename Key, typename Value, typename Hash, typename Equal, typename Allocator>
+[[nodiscard]] std::size_t EstimateContainerHeapSize(
+  const std::unordered_map<Key, Value, Hash, Equal, Allocator>& container) noexcept
+{
+  return container.bucket_count() * sizeof(void*)
+    + container.size() * (sizeof(std::pair<const Key, Value>) + HashNodeOverhead);
+}
+
+// Deep estimates. All of them are declared before they are defined,
+// so that the estimates of nested containers find each other.
+// Types of other namespaces provide their own `EstimateHeapSize`, found by ADL.
+
+//! Trivially copyable values own no heap memory.
+template <typename T>
+  requires std::is_trivially_copyable_v<T>
+[[nodiscard]] constexpr std::size_t EstimateHeapSize(const T&) noexcept
+{
+  return 0;
+}
+
+//! Estimates the heap size of the string, zero if it fits the small string buffer.
+[[nodiscard]] std::size_t EstimateHeapSize(const std::string& value) noexcept;
+
+template <typename First, typename Second>
+[[nodiscard]] std::size_t EstimateHeapSize(const std::pair<First, Second>& value) noexcept;
+template <typename T>
+[[nodiscard]] std::size_t EstimateHeapSize(const std::optional<T>& value) noexcept;
+template <typename T, std::size_t Size>
+  requires (not std::is_trivially_copyable_v<T>)
+[[nodiscard]] std::size_t EstimateHeapSize(const std::array<T, Size>& value) noexcept;
+template <typename T, typename Allocator>
+[[nodiscard]] std::size_t EstimateHeapSize(const std::vector<T, Allocator>& value) noexcept;
+template <typename T, typename Allocator>
+[[nodiscard]] std::size_t EstimateHeapSize(const std::list<T, Allocator>& value) noexcept;
+template <typename Key, typename Compare, typename Allocator>
+[[nodiscard]] std::size_t EstimateHeapSize(const std::set<Key, Compare, Allocator>& value) noexcept;
+template <typename Key, typename Value, typename Compare, typename Allocator>
+[[nodiscard]] std::size_t EstimateHeapSize(
+  const std::map<Key, Value, Compare, Allocator>& value) noexcept;
+template <typename Key, typename Hash, typename Equal, typename Allocator>
+[[nodiscard]] std::size_t EstimateHeapSize(
+  const std::unordered_set<Key, Hash, Equal, Allocator>& value) noexcept;
+template <typename Key, typename Value, typename Hash, typename Equal, typename Allocator>
+[[nodiscard]] std::size_t EstimateHeapSize(
+  const std::unordered_map<Key, Value, Hash, Equal, Allocator>& value) noexcept;
+
+//! Estimates the heap size owned by the elements of the range.
+//! @param range Range of the elements.
+//! @returns Estimated count of the bytes.
+[[nodiscard]] std::size_t EstimateElementHeapSize(const auto& range) noexcept
+{
+  std::size_t size = 0;
+  for (const auto& element : range)
+    size += EstimateHeapSize(element);
+  return size;
+}
+
+inline std::size_t EstimateHeapSize(const std::string& value) noexcept
+{
+  // The characters are on the heap when they are not stored within the string object.
+  const auto data = reinterpret_cast<const std::byte*>(value.data());
+  const auto object = reinterpret_cast<const std::byte*>(&value);
+  if (data >= object && data < object + sizeof(std::string))
+    return 0;
+  return value.capacity() + 1 + AllocationOverhead;
+}
+
+template <typename First, typename Second>
+std::size_t EstimateHeapSize(const std::pair<First, Second>& value) noexcept
+{
+  return EstimateHeapSize(value.first) + EstimateHeapSize(value.second);
+}
+
+template <typename T>
+std::size_t EstimateHeapSize(const std::optional<T>& value) noexcept
+{
+  return value ? EstimateHeapSize(*value) : 0;
+}
+
+template <typename T, std::size_t Size>
+  requires (not std::is_trivially_copyable_v<T>)
+std::size_t EstimateHeapSize(const std::array<T, Size>& value) noexcept
+{
+  return EstimateElementHeapSize(value);
+}
+
+template <typename T, typename Allocator>
+std::size_t EstimateHeapSize(const std::vector<T, Allocator>& value) noexcept
+{
+  return EstimateContainerHeapSize(value) + EstimateElementHeapSize(value);
+}
+
+template <typename T, typename Allocator>
+std::size_t EstimateHeapSize(const std::list<T, Allocator>& value) noexcept
+{
+  return EstimateContainerHeapSize(value) + EstimateElementHeapSize(value);
+}
+
+template <typename Key, typename Compare, typename Allocator>
+std::size_t EstimateHeapSize(const std::set<Key, Compare, Allocator>& value) noexcept
+{
+  return EstimateContainerHeapSize(value) + EstimateElementHeapSize(value);
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+std::size_t EstimateHeapSize(const std::map<Key, Value, Compare, Allocator>& value) noexcept
+{
+  return EstimateContainerHeapSize(value) + EstimateElementHeapSize(value);
+}
+
+template <typename Key, typename Hash, typename Equal, typename Allocator>
+std::size_t EstimateHeapSize(const std::unordered_set<Key, Hash, Equal, Allocator>& value) noexcept
+{
+  return EstimateContainerHeapSize(value) + EstimateElementHeapSize(value);
+}
+
+template <typename Key, typename Value, typename Hash, typename Equal, typename Allocator>
+std::size_t EstimateHeapSize(
+  const std::unordered_map<Key, Value, Hash, Equal, Allocator>& value) noexcept
+{
+  return EstimateContainerHeapSize(value) + EstimateElementHeapSize(value);
+}
+
+//! Memory usage of the subsystems of a component, in the order they were reported.
+using MemoryUsageReport = std::vector<std::pair<std::string, MemoryUsage>>;
+
+//! Returns the total memory usage of the report.
+//! @param report Report.
+//! @returns Sum of the memory usage of the subsystems.
+[[nodiscard]] MemoryUsage GetTotal(const MemoryUsageReport& report) noexcept;
+
+//! Formats the count of bytes with a binary unit, e.g. `1.5 MiB`.
+//! @param bytes Count of bytes.
+//! @returns Formatted count of bytes.
+[[nodiscard]] std::string FormatBytes(uint64_t bytes);
+
+//! Memory usage reports of the server components.
+//! Every component collects its report on its own thread and publishes it as a whole,
+//! the reports may be read from any thread.
+class MemoryAccounting final
+{
+public:
+  using Clock = std::chrono::system_clock;
+
+  //! A published report of a component.
+  struct ComponentReport
+  {
+    //! Time the report was published at.
+    Clock::time_point publishedAt{};
+    //! Memory usage of the subsystems of the component.
+    MemoryUsageReport report;
+  };
+
+  //! Returns whether the component is due to publish its report.
+  //! The report is due if it was never published, if the interval elapsed since it was published
+  //! or if the reports were requested since.
+  //! @param component Name of the component.
+  //! @param interval Interval of the reports.
+  //! @returns `true` if the report is due, `false` otherwise.
+  [[nodiscard]] bool IsReportDue(std::string_view component, Clock::duration interval) const;
+
+  //! Requests all the components to publish their reports the next time they check.
+  void RequestReports();
+
+  //! Publishes the report of the component, replacing its previous report.
+  //! @param component Name of the component.
+  //! @param report Memory usage of the subsystems of the component.
+  void Publish(std::string_view component, MemoryUsageReport report);
+
+  //! Returns a copy of the published reports, keyed by the component name.
+  //! @returns Published reports.
+  [[nodiscard]] std::map<std::string, ComponentReport, std::less<>> GetReports() const;
+
+private:
+  mutable std::mutex _mutex;
+  std::map<std::string, ComponentReport, std::less<>> _reports;
+  //! Time the reports were last requested at.
+  Clock::time_point _requestedAt{};
+};
+
+} // namespace server::util
+
+#endif // MEMORYUSAGE_HPP
@@ -0,0 +1,98 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#ifndef RCU_HPP
+#define RCU_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace server::util
+{
+
+//! Holds an immutable snapshot of a value that is replaced with read-copy-update semantics.
+//! Readers pin the current snapshot with a single atomic load and may keep using it for
+//! as long as they hold the view. Writers build a new snapshot on their own thread
+//! and publish it atomically. A replaced snapshot is reclaimed once its last view is released.
+//! Readers never wait for a writer building a snapshot, but the load is not lock-free
+//! everywhere: libstdc++ guards the pointer with an internal spin lock held for the swap
+//! of the reference count only.
+template <typename T>
+class Rcu final
+{
+public:
+  //! A pinned, immutable view of a snapshot.
+  using View = std::shared_ptr<const T>;
+
+  //! Default constructor publishing an empty snapshot.
+  Rcu()
+    : _snapshot(std::make_shared<const Snapshot>())
+  {
+  }
+
+  Rcu(const Rcu&) = delete;
+  Rcu& operator=(const Rcu&) = delete;
+
+  //! Pins the current snapshot.
+  //! @returns View of the current snapshot.
+  [[nodiscard]] View Pin() const noexcept
+  {
+    auto snapshot = _snapshot.load(std::memory_order::acquire);
+    const T* value = &snapshot->value;
+    return View(std::move(snapshot), value);
+  }
+
+  //! Publishes a new snapshot replacing the current one.
+  //! @param value Value of the new snapshot.
+  //! @returns Version of the published snapshot.
+  uint64_t Publish(T value)
+  {
+    const auto version = _lastVersion.fetch_add(1, std::memory_order::relaxed) + 1;
+    _snapshot.store(
+      std::make_shared<const Snapshot>(version, std::move(value)),
+      std::memory_order::release);
+    return version;
+  }
+
+  //! Returns the version of the current snapshot,
+  //! the version travels with the snapshot so that it always matches `Pin()`.
+  //! @returns Version of the current snapshot, `0` if nothing was published yet.
+  [[nodiscard]] uint64_t GetVersion() const noexcept
+  {
+    return _snapshot.load(std::memory_order::acquire)->version;
+  }
+
+private:
+  //! A published snapshot.
+  struct Snapshot
+  {
+    uint64_t version{0};
+    T value{};
+  };
+
+  //! The current snapshot.
+  std::atomic<std::shared_ptr<const Snapshot>> _snapshot;
+  //! The version of the last published snapshot.
+  std::atomic_uint64_t _lastVersion{0};
+};
+
+} // namespace server::util
+
+#endif // RCU_HPP
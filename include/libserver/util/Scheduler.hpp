@@ -20,6 +20,9 @@
 #ifndef SERVER_SCHEDULER_HPP
 #define SERVER_SCHEDULER_HPP
 
+#include "libserver/util/MemoryUsage.hpp"
+
+#include <atomic>
 #include <chrono>
 #include <functional>
 #include <list>
@@ -49,6 +52,14 @@ public:
     const Task& task,
     Clock::time_point when = Clock::now());
 
+  //! Returns the count of the queued jobs.
+  //! Safe to call from any thread.
+  [[nodiscard]] size_t GetJobCount() const;
+
+  //! Returns the count of the queued jobs and the estimated size of the job list.
+  //! The heap captured by the tasks is not accounted for. Safe to call from any thread.
+  [[nodiscard]] util::MemoryUsage GetMemoryUsage() const;
+
 protected:
   //! A job.
   struct Job
@@ -65,6 +76,8 @@ protected:
   std::list<Job> _jobs;
   //! An iterator to the job to execute in the next tick cycle.
   decltype(_jobs)::const_iterator _jobIterator;
+  //! Count of the queued jobs, readable from other threads.
+  std::atomic<size_t> _jobCount{0};
 };
 
 } // namespace server
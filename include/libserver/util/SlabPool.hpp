@@ -0,0 +1,142 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#ifndef SLABPOOL_HPP
+#define SLABPOOL_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace server::util
+{
+
+//! Pool of the byte blocks in the power of two size classes, carved from the slabs.
+//! The free blocks of a class are reused before a new slab is allocated. A slab is freed
+//! once none of its blocks are in use and its class already keeps an empty slab.
+//! Thread-safe, the blocks may be released from any thread.
+class SlabPool final
+{
+public:
+  //! Size of the smallest block.
+  static constexpr size_t MinBlockSize = 512;
+  //! Size of the largest block.
+  static constexpr size_t MaxBlockSize = 64 * 1024;
+  //! Size of a slab, holds at least four of the largest blocks.
+  static constexpr size_t SlabSize = 256 * 1024;
+
+  struct Slab;
+
+  //! Block of the pool, returned to the pool when destroyed.
+  class Block final
+  {
+  public:
+    Block() noexcept = default;
+    ~Block();
+
+    Block(Block&& other) noexcept;
+    Block& operator=(Block&& other) noexcept;
+
+    Block(const Block&) = delete;
+    Block& operator=(const Block&) = delete;
+
+    //! Returns the data of the block.
+    [[nodiscard]] std::byte* GetData() const noexcept;
+    //! Returns the size of the block.
+    [[nodiscard]] size_t GetSize() const noexcept;
+    //! Returns the block to the pool.
+    void Reset() noexcept;
+
+    explicit operator bool() const noexcept;
+
+  private:
+    friend class SlabPool;
+
+    Block(Slab* slab, std::byte* data, size_t size) noexcept;
+
+    Slab* _slab{};
+    std::byte* _data{};
+    size_t _size{};
+  };
+
+  //! Point in time statistics of the pool.
+  struct Statistics
+  {
+    //! Count of the slabs allocated.
+    uint64_t slabCount{};
+    //! Count of the bytes of the slabs allocated.
+    uint64_t residentBytes{};
+    //! Count of the blocks in use.
+    uint64_t usedBlocks{};
+    //! Count of the bytes of the blocks in use.
+    uint64_t usedBytes{};
+  };
+
+  SlabPool();
+  ~SlabPool();
+
+  SlabPool(const SlabPool&) = delete;
+  SlabPool& operator=(const SlabPool&) = delete;
+
+  //! Acquires a block.
+  //! @param size Minimum size of the block.
+  //! @returns Block of the size class of the size.
+  //! @throw std::length_error If the size is larger than `MaxBlockSize`.
+  [[nodiscard]] Block Acquire(size_t size);
+
+  //! Returns the statistics of the pool.
+  [[nodiscard]] Statistics GetStatistics() const noexcept;
+
+  //! Returns the size of the block acquired for a size.
+  //! @param size Minimum size of the block, at most `MaxBlockSize`.
+  //! @returns Size of the block.
+  [[nodiscard]] static size_t GetBlockSize(size_t size) noexcept;
+
+private:
+  //! Count of the size classes from `MinBlockSize` to `MaxBlockSize`.
+  static constexpr size_t ClassCount = 8;
+
+  //! Blocks of a single size.
+  struct SizeClass
+  {
+    std::mutex mutex;
+    //! Slabs of the class.
+    std::vector<std::unique_ptr<Slab>> slabs;
+  };
+
+  //! Returns a block to its slab.
+  void Release(Slab& slab, std::byte* data) noexcept;
+
+  std::array<SizeClass, ClassCount> _classes;
+
+  struct
+  {
+    std::atomic<uint64_t> slabCount{0};
+    std::atomic<uint64_t> usedBlocks{0};
+    std::atomic<uint64_t> usedBytes{0};
+  } _statistics;
+};
+
+} // namespace server::util
+
+#endif // SLABPOOL_HPP
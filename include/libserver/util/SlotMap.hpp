@@ -0,0 +1,274 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#ifndef SLOTMAP_HPP
+#define SLOTMAP_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace server::util
+{
+
+//! Epoch-based reclamation of the objects removed from the concurrent containers.
+//! A reader pins the current thread for the duration of its access, an object removed
+//! by a writer is reclaimed only once no thread pinned before its removal is still pinned.
+namespace epoch
+{
+
+//! Pins the current thread for the lifetime of the pin, pins nest.
+//! Takes no lock, each thread announces its pin in its own cache line.
+class Pin final
+{
+public:
+  Pin() noexcept;
+  ~Pin();
+
+  Pin(const Pin&) = delete;
+  Pin& operator=(const Pin&) = delete;
+};
+
+//! Advances the global epoch, called after an object was removed.
+//! @returns Epoch the removed object is retired at.
+[[nodiscard]] uint64_t Advance() noexcept;
+
+//! Returns the oldest epoch still observed by a pinned thread.
+//! Objects retired at an earlier epoch are no longer reachable by any thread.
+//! @returns Oldest observed epoch.
+[[nodiscard]] uint64_t GetSafeEpoch() noexcept;
+
+} // namespace epoch
+
+//! A fixed-capacity map of shared objects keyed by generation-indexed IDs.
+//! The owner thread inserts and erases the objects, any thread visits them
+//! without taking a lock or a reference. An ID combines the index of its slot
+//! and the generation of the slot, which changes with every erasure,
+//! so an ID of an erased object never resolves to the object reusing its slot.
+template <typename T>
+class ConcurrentSlotMap final
+{
+public:
+  //! An ID of an object, the generation in the upper 32 bits and the index in the lower 32 bits.
+  using Id = uint64_t;
+
+  //! Constructor.
+  //! @param capacity Maximum count of the objects.
+  explicit ConcurrentSlotMap(const size_t capacity)
+    : _slots(std::make_unique<Slot[]>(capacity))
+    , _owners(capacity)
+    , _capacity(capacity)
+  {
+    // Reuse the lowest indices first.
+    _freeIndices.reserve(capacity);
+    for (size_t index = capacity; index > 0; --index)
+      _freeIndices.emplace_back(static_cast<uint32_t>(index - 1));
+  }
+
+  ConcurrentSlotMap(const ConcurrentSlotMap&) = delete;
+  ConcurrentSlotMap& operator=(const ConcurrentSlotMap&) = delete;
+
+  //! Inserts an object created from its ID.
+  //! Must be called from the owner thread.
+  //! @param factory Factory creating the `std::shared_ptr<T>` from the ID.
+  //! @returns ID of the object, or empty if the map is full.
+  template <typename Factory>
+  std::optional<Id> Emplace(Factory&& factory)
+  {
+    if (_freeIndices.empty())
+      return std::nullopt;
+
+    const auto index = _freeIndices.back();
+    auto& slot = _slots[index];
+    const Id id = MakeId(index, slot.generation.load(std::memory_order::relaxed));
+
+    std::shared_ptr<T> object = std::forward<Factory>(factory)(id);
+    _freeIndices.pop_back();
+
+    slot.object.store(object.get(), std::memory_order::seq_cst);
+    _owners[index] = std::move(object);
+    _size.fetch_add(1, std::memory_order::relaxed);
+
+    return id;
+  }
+
+  //! Erases an object. Threads visiting it keep it alive until they finish.
+  //! Must be called from the owner thread.
+  //! @param id ID of the object.
+  //! @returns `true` if the object was erased, `false` if the ID is stale.
+  bool Erase(const Id id)
+  {
+    const auto index = GetIndex(id);
+    if (index >= _capacity || not _owners[index])
+      return false;
+
+    auto& slot = _slots[index];
+    if (slot.generation.load(std::memory_order::relaxed) != GetGeneration(id))
+      return false;
+
+    // The generation changes first, a visitor which still reads the object
+    // afterwards finds the generation mismatched.
+    slot.generation.store(GetGeneration(id) + 1, std::memory_order::seq_cst);
+    slot.object.store(nullptr, std::memory_order::seq_cst);
+
+    _retired.emplace_back(epoch::Advance(), std::move(_owners[index]));
+    _freeIndices.emplace_back(index);
+    _size.fetch_sub(1, std::memory_order::relaxed);
+
+    Reclaim();
+    return true;
+  }
+
+  //! Returns the owning pointer to an object.
+  //! Must be called from the owner thread.
+  //! @param id ID of the object.
+  //! @returns Pointer to the object, `nullptr` if the ID is stale.
+  [[nodiscard]] std::shared_ptr<T> Get(const Id id) const noexcept
+  {
+    const auto index = GetIndex(id);
+    if (index >= _capacity
+      || _slots[index].generation.load(std::memory_order::relaxed) != GetGeneration(id))
+      return nullptr;
+
+    return _owners[index];
+  }
+
+  //! Visits an object. Safe to call from any thread.
+  //! @param id ID of the object.
+  //! @param function Function called with a reference to the object,
+  //!                 which stays alive until the function returns.
+  //! @returns `true` if the object was visited, `false` if the ID is stale.
+  template <typename Function>
+  bool Visit(const Id id, Function&& function) const
+  {
+    const auto index = GetIndex(id);
+    if (index >= _capacity)
+      return false;
+
+    const epoch::Pin pin;
+
+    const auto& slot = _slots[index];
+    if (slot.generation.load(std::memory_order::seq_cst) != GetGeneration(id))
+      return false;
+
+    T* object = slot.object.load(std::memory_order::seq_cst);
+
+    // The object might have been erased and the slot reused in the meantime.
+    if (object == nullptr
+      || slot.generation.load(std::memory_order::seq_cst) != GetGeneration(id))
+      return false;
+
+    std::forward<Function>(function)(*object);
+    return true;
+  }
+
+  //! Calls the function for every object.
+  //! Must be called from the owner thread.
+  //! @param function Function called with the ID of the object and a reference to it.
+  template <typename Function>
+  void ForEach(Function&& function) const
+  {
+    for (uint32_t index = 0; index < _capacity; ++index)
+    {
+      const auto& object = _owners[index];
+      if (not object)
+        continue;
+
+      function(MakeId(index, _slots[index].generation.load(std::memory_order::relaxed)), *object);
+    }
+  }
+
+  //! Releases the erased objects no thread visits anymore.
+  //! Must be called from the owner thread, erasure reclaims too.
+  void Reclaim()
+  {
+    if (_retired.empty())
+      return;
+
+    const auto safeEpoch = epoch::GetSafeEpoch();
+    std::erase_if(_retired, [safeEpoch](const Retired& retired)
+    {
+      return retired.first < safeEpoch;
+    });
+  }
+
+  //! Returns the count of the objects. Safe to call from any thread.
+  [[nodiscard]] size_t GetSize() const noexcept
+  {
+    return _size.load(std::memory_order::relaxed);
+  }
+
+  //! Returns the maximum count of the objects.
+  [[nodiscard]] size_t GetCapacity() const noexcept
+  {
+    return _capacity;
+  }
+
+  //! Returns the count of the erased objects not yet reclaimed.
+  //! Must be called from the owner thread.
+  [[nodiscard]] size_t GetRetiredCount() const noexcept
+  {
+    return _retired.size();
+  }
+
+private:
+  //! A slot of an object, read by the visiting threads.
+  struct Slot
+  {
+    std::atomic<uint32_t> generation{0};
+    std::atomic<T*> object{nullptr};
+  };
+
+  //! An erased object with the epoch it was retired at.
+  using Retired = std::pair<uint64_t, std::shared_ptr<T>>;
+
+  [[nodiscard]] static constexpr Id MakeId(const uint32_t index, const uint32_t generation) noexcept
+  {
+    return static_cast<Id>(generation) << 32 | index;
+  }
+
+  [[nodiscard]] static constexpr uint32_t GetIndex(const Id id) noexcept
+  {
+    return static_cast<uint32_t>(id);
+  }
+
+  [[nodiscard]] static constexpr uint32_t GetGeneration(const Id id) noexcept
+  {
+    return static_cast<uint32_t>(id >> 32);
+  }
+
+  //! Slots read by the visiting threads.
+  std::unique_ptr<Slot[]> _slots;
+  //! Owning pointers to the objects, accessed only from the owner thread.
+  std::vector<std::shared_ptr<T>> _owners;
+  //! Indices of the free slots, accessed only from the owner thread.
+  std::vector<uint32_t> _freeIndices;
+  //! Erased objects waiting to be reclaimed, accessed only from the owner thread.
+  std::vector<Retired> _retired;
+  //! Count of the objects.
+  std::atomic<size_t> _size{0};
+  size_t _capacity;
+};
+
+} // namespace server::util
+
+#endif // SLOTMAP_HPP
@@ -0,0 +1,119 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include "libserver/util/SlotMap.hpp"
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace server::util
+{
+
+//! A cell holding an immutable snapshot of a value, read without a lock.
+//! A writer replaces the snapshot with a copy of the modified value, the readers pin
+//! the current thread while they read and the replaced snapshots are reclaimed once
+//! no thread pinned before their replacement is still pinned.
+//! The readers write to no memory shared with the other threads.
+template <typename T>
+class SnapshotCell final
+{
+public:
+  SnapshotCell() = default;
+
+  ~SnapshotCell()
+  {
+    delete _current.load(std::memory_order::relaxed);
+  }
+
+  SnapshotCell(const SnapshotCell&) = delete;
+  SnapshotCell& operator=(const SnapshotCell&) = delete;
+
+  //! Publishes a copy of the value as the snapshot.
+  //! Must not be called by multiple writers at once.
+  //! @param value Value to copy.
+  void Publish(const T& value)
+  {
+    T* const previous = _current.exchange(new T(value), std::memory_order::seq_cst);
+    if (previous != nullptr)
+      _retired.emplace_back(epoch::Advance(), std::unique_ptr<T>(previous));
+
+    Reclaim();
+  }
+
+  //! Reads the snapshot. Safe to call from any thread.
+  //! @param function Function called with the snapshot,
+  //!                 which stays alive until the function returns.
+  //! @returns `true` if the snapshot was read, `false` if there is no snapshot.
+  template <typename Function>
+  bool Read(Function&& function) const
+  {
+    const epoch::Pin pin;
+
+    const T* const snapshot = _current.load(std::memory_order::seq_cst);
+    if (snapshot == nullptr)
+      return false;
+
+    function(*snapshot);
+    return true;
+  }
+
+  //! Releases the replaced snapshots no thread reads anymore.
+  //! Called by every publish, and by the writer between the publishes
+  //! so that the snapshots of a cell published rarely are not held for long.
+  //! Must not be called by multiple writers at once.
+  //! @returns `true` if all the replaced snapshots were released, `false` otherwise.
+  bool Reclaim()
+  {
+    if (_retired.empty())
+      return true;
+
+    const auto safeEpoch = epoch::GetSafeEpoch();
+    std::erase_if(_retired, [safeEpoch](const Retired& retired)
+    {
+      return retired.first < safeEpoch;
+    });
+    return _retired.empty();
+  }
+
+  //! Returns the count of the replaced snapshots not yet reclaimed.
+  //! Must not be called by multiple writers at once.
+  [[nodiscard]] size_t GetRetiredCount() const noexcept
+  {
+    return _retired.size();
+  }
+
+private:
+
+  //! A replaced snapshot with the epoch it was retired at.
+  using Retired = std::pair<uint64_t, std::unique_ptr<T>>;
+
+  //! The current snapshot, read by any thread.
+  std::atomic<T*> _current{nullptr};
+  //! Replaced snapshots waiting to be reclaimed, accessed only by the writer.
+  std::vector<Retired> _retired;
+};
+
+} // namespace server::util
+
+#endif // SNAPSHOT_HPP
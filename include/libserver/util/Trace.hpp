@@ -0,0 +1,149 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+//! Scoped trace spans recorded into per-thread ring buffers and dumped
+//! as Chrome trace-event JSON, which can be opened in Perfetto or `chrome://tracing`.
+//!
+//! Every thread records into its own buffer, so recording never contends with
+//! the other threads. When a buffer is full, its oldest spans are overwritten.
+//! While the tracing is disabled, a span costs a single relaxed atomic load.
+namespace server::util::trace
+{
+
+//! Clock of the spans.
+using Clock = std::chrono::steady_clock;
+
+namespace detail
+{
+
+//! Whether the tracing is enabled.
+extern std::atomic_bool enabled;
+
+//! Records a span into the buffer of the current thread.
+//! @param category Category of the span.
+//! @param name Name of the span.
+//! @param begin Time the span began at.
+//! @param end Time the span ended at.
+void Record(
+  std::string_view category,
+  std::string_view name,
+  Clock::time_point begin,
+  Clock::time_point end) noexcept;
+
+} // namespace detail
+
+//! Returns whether the tracing is enabled.
+[[nodiscard]] inline bool IsEnabled() noexcept
+{
+  return detail::enabled.load(std::memory_order::relaxed);
+}
+
+//! Enables or disables the tracing. Recorded spans are kept.
+//! @param enabled Whether the tracing is enabled.
+void SetEnabled(bool enabled) noexcept;
+
+//! Sets the capacity of the per-thread buffers.
+//! Applies to the buffers of the threads which did not record any span yet.
+//! @param capacity Count of the spans a buffer holds.
+void SetBufferCapacity(size_t capacity) noexcept;
+
+//! Names the current thread in the dumped traces.
+//! @param name Name of the thread.
+void SetThreadName(std::string_view name);
+
+//! Discards the recorded spans of all the threads.
+void Clear();
+
+//! Dumps the recorded spans of all the threads as Chrome trace-event JSON.
+//! @param path Path of the file to write.
+//! @returns Count of the dumped spans.
+//! @throw std::runtime_error If the file can't be written.
+size_t Dump(const std::filesystem::path& path);
+
+//! Returns a path of a new trace file.
+//! @param directory Directory of the trace files.
+//! @returns Path of the trace file, named after the current time.
+[[nodiscard]] std::filesystem::path MakeFilePath(const std::filesystem::path& directory);
+
+//! A scoped span, recorded when it goes out of scope.
+//! The category and the name are not copied, they must be string literals
+//! or otherwise outlive the dumps of the trace.
+class Span final
+{
+public:
+  //! Begins the span, unless the tracing is disabled.
+  //! @param category Category of the span.
+  //! @param name Name of the span.
+  Span(std::string_view category, std::string_view name) noexcept
+  {
+    if (not IsEnabled())
+      return;
+
+    _category = category;
+    _name = name;
+    _begin = Clock::now();
+  }
+
+  //! Begins the span, unless the tracing is disabled.
+  //! The name is looked up only when the tracing is enabled,
+  //! so that a disabled span costs no look-up either.
+  //! @param category Category of the span.
+  //! @param nameSupplier Function returning the name of the span.
+  template <std::invocable NameSupplier>
+  Span(std::string_view category, NameSupplier&& nameSupplier) noexcept
+  {
+    if (not IsEnabled())
+      return;
+
+    _category = category;
+    _name = std::forward<NameSupplier>(nameSupplier)();
+    _begin = Clock::now();
+  }
+
+  //! Ends the span.
+  ~Span()
+  {
+    if (_begin == Clock::time_point{})
+      return;
+
+    detail::Record(_category, _name, _begin, Clock::now());
+  }
+
+  Span(const Span&) = delete;
+  Span& operator=(const Span&) = delete;
+
+private:
+  std::string_view _category;
+  std::string_view _name;
+  Clock::time_point _begin{};
+};
+
+} // namespace server::util::trace
+
+#endif // TRACE_HPP
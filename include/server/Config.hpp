@@ -20,9 +20,14 @@
 #ifndef CONFIG_HPP
 #define CONFIG_HPP
 
+#include <libserver/network/NetworkDefinitions.hpp>
+
 #include <nlohmann/json.hpp>
 #include <boost/asio/ip/address.hpp>
 
+#include <string>
+#include <vector>
+
 namespace server
 {
 
@@ -41,6 +46,9 @@ public:
     uint16_t port{0};
   };
 
+  //! Default options of the sockets of the clients, overridden per listener.
+  network::SocketOptions socket{};
+
   //!
   struct General
   {
@@ -66,6 +74,8 @@ public:
     bool enabled{true};
     Listen listen{
       .port = 10030};
+    //! Options of the sockets of the clients.
+    network::SocketOptions socket{};
 
     struct Advertisement
     {
@@ -93,6 +103,8 @@ public:
     bool enabled{true};
     Listen listen{
       .port = 10031};
+    //! Options of the sockets of the clients.
+    network::SocketOptions socket{};
   } ranch{};
 
   //!
@@ -101,6 +113,8 @@ public:
     bool enabled{true};
     Listen listen{
       .port = 10032};
+    //! Options of the sockets of the clients.
+    network::SocketOptions socket{};
   } race{};
 
   //!
@@ -109,6 +123,8 @@ public:
     bool enabled{true};
     Listen listen{
       .port = 10033};
+    //! Options of the sockets of the clients.
+    network::SocketOptions socket{};
   } messenger{};
 
   //!
@@ -117,6 +133,8 @@ public:
     bool enabled{true};
     Listen listen{
       .port = 10034};
+    //! Options of the sockets of the clients.
+    network::SocketOptions socket{};
   } allChat{};
 
   struct PrivateChat
@@ -124,8 +142,62 @@ public:
     bool enabled{true};
     Listen listen{
       .port = 10035};
+    //! Options of the sockets of the clients.
+    network::SocketOptions socket{};
   } privateChat{};
 
+  //!
+  struct Admin
+  {
+    bool enabled{false};
+    Listen listen{
+      .address = asio::ip::address_v4::loopback(),
+      .port = 10040};
+    //! Interval of the live metric deltas in milliseconds.
+    uint32_t deltaInterval{1000};
+  } admin{};
+
+  //!
+  struct Capture
+  {
+    //! Whether the commands received by the lobby, ranch and race servers are captured.
+    bool enabled{false};
+    //! Directory of the capture files.
+    std::string directory{"./captures"};
+  } capture{};
+
+  //! Configuration of the tracing.
+  struct Trace
+  {
+    //! Whether the tracing is enabled at the start.
+    bool enabled{false};
+    //! Count of the spans the buffer of every thread holds.
+    size_t bufferSize{32768};
+    //! Directory of the trace files.
+    std::string directory{"./traces"};
+  } trace{};
+
+  //! Configuration of the memory accounting.
+  struct Memory
+  {
+    //! Interval of the memory usage reports in seconds.
+    uint32_t reportInterval{60};
+    //! Whether the memory usage reports are written to the log.
+    bool logReports{true};
+  } memory{};
+
+  //! Handoff of the listening sockets to the next process on restart.
+  struct Handoff
+  {
+    //! Whether the listening sockets are handed off.
+    bool enabled{false};
+    //! Path of the Unix domain socket serving the handoff.
+    std::string path{"./alicia.handoff"};
+    //! Time limit in seconds of disconnecting the clients once the sockets were handed off.
+    //! The next process waits for this process up to this limit, plus the time of writing out the data.
+    uint32_t drainTimeout{300};
+  } handoff{};
+
   //!
   struct Data
   {
@@ -145,6 +217,43 @@ public:
     } postgres{};
   } data{};
 
+  //!
+  struct Logging
+  {
+    //! Policy applied when the asynchronous log queue is full.
+    enum class OverflowPolicy
+    {
+      //! Block the logging thread until there is space in the queue.
+      Block,
+      //! Discard the oldest message in the queue.
+      OverrunOldest,
+      //! Discard the new message.
+      DiscardNew
+    };
+
+    //! Whether the messages are written on a background thread.
+    bool async{true};
+    //! Capacity of the asynchronous log queue in messages.
+    size_t queueSize{8192};
+    //! Policy applied when the asynchronous log queue is full.
+    OverflowPolicy overflowPolicy{OverflowPolicy::Block};
+    //! Runtime log level. Levels below the compile-time level
+    //! `SPDLOG_ACTIVE_LEVEL` are never logged regardless of this value.
+    std::string level{"debug"};
+    //! Names of the commands whose data is dumped.
+    struct CommandDataDumps
+    {
+      //! Names of the commands whose received data is dumped.
+      std::vector<std::string> incoming;
+      //! Names of the commands whose sent data is dumped.
+      std::vector<std::string> outgoing;
+    };
+    //! Commands of the game protocol whose data is dumped.
+    CommandDataDumps commandDataDumps;
+    //! Commands of the chatter protocol whose data is dumped.
+    CommandDataDumps chatterCommandDataDumps;
+  } logging{};
+
   //! Loads the config from the environment.
   void LoadFromEnvironment();
   //! Loads the config from the specified file.
@@ -0,0 +1,46 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#ifndef LOGGING_HPP
+#define LOGGING_HPP
+
+#include "server/Config.hpp"
+
+#include <filesystem>
+
+namespace server
+{
+
+//! Initializes the synchronous application logger writing to the console
+//! and to the daily log files in the specified directory.
+//! @param logDirectory Directory of the log files.
+void InitializeLogging(const std::filesystem::path& logDirectory);
+
+//! Reconfigures the application logger with the logging config.
+//! When asynchronous logging is enabled the messages are queued and written
+//! by a background thread. Must be called before any other thread logs.
+//! @param config Logging config.
+void ConfigureLogging(const Config::Logging& config);
+
+//! Flushes the queued messages and shuts the logging down.
+void TerminateLogging();
+
+} // namespace server
+
+#endif // LOGGING_HPP
@@ -21,6 +21,7 @@
 #define INSTANCE_HPP
 
 #include "server/Config.hpp"
+#include "server/admin/AdminDirector.hpp"
 #include "server/auth/AuthenticationService.hpp"
 #include "server/lobby/LobbyDirector.hpp"
 #include "server/chat/AllChatDirector.hpp"
@@ -36,14 +37,22 @@
 #include "server/system/RoomSystem.hpp"
 
 #include <libserver/data/DataDirector.hpp>
+#include <libserver/network/Handoff.hpp>
+#include <libserver/network/Server.hpp>
 #include <libserver/registry/CourseRegistry.hpp>
 #include <libserver/registry/HorseRegistry.hpp>
 #include <libserver/registry/ItemRegistry.hpp>
 #include <libserver/registry/MagicRegistry.hpp>
 #include <libserver/registry/PetRegistry.hpp>
+#include <libserver/util/Histogram.hpp>
+#include <libserver/util/MemoryUsage.hpp>
+#include <libserver/util/Trace.hpp>
 
 #include <spdlog/spdlog.h>
 
+#include <format>
+#include <map>
+
 namespace server
 {
 
@@ -59,6 +68,16 @@ public:
   void Initialize();
   //! Terminates the server instance.
   void Terminate();
+  //! Returns whether the server instance runs.
+  //! The instance stops by itself once it handed off its listening sockets and drained its clients.
+  //! @returns `true` if the server instance runs, `false` otherwise.
+  [[nodiscard]] bool IsRunning() const;
+
+  //! Reloads the game registries from their configs.
+  //! New snapshots are built on the calling thread and published atomically,
+  //! directors observe them the next time they pin a registry.
+  //! A registry that fails to reload keeps its current snapshot.
+  void ReloadRegistries();
 
   //! Returns reference to the authentication service.
   //! @returns Reference to the authentication service.
@@ -140,13 +159,69 @@ public:
   //! @returns Reference to the settings.
   Config& GetSettings();
 
-private:
+  //! Returns the tick times of the directors in nanoseconds, keyed by the director name.
+  //! @returns Tick times of the directors.
+  const std::map<std::string, util::Histogram, std::less<>>& GetDirectorTickTimes() const;
+
+  //! Begins capturing the commands received by a command server, if enabled by the config.
+  //! Failure to capture is logged and does not prevent the server from hosting.
+  //! @param commandServer Command server to capture.
+  //! @param name Name of the server, used in the capture file name.
+  void BeginCapture(CommandServer& commandServer, std::string_view name);
+
+  //! Dumps the recorded trace spans to a new file in the trace directory.
+  //! @returns Path of the trace file.
+  //! @throw std::runtime_error If the trace can't be written.
+  std::filesystem::path DumpTrace();
+
+  //! Returns whether the component is due to report its memory usage.
+  //! Components check this periodically from the thread owning their state.
+  //! @param component Name of the component.
+  //! @returns `true` if the report is due, `false` otherwise.
+  [[nodiscard]] bool IsMemoryUsageReportDue(std::string_view component) const;
+
+  //! Publishes the memory usage of the component and logs it, if enabled by the config.
+  //! @param component Name of the component.
+  //! @param report Memory usage of the subsystems of the component.
+  void PublishMemoryUsage(std::string_view component, util::MemoryUsageReport report);
+
+  //! Requests all the components to report their memory usage as soon as possible.
+  //! The registries report immediately, the other components on their next tick.
+  void RequestMemoryUsageReports();
+
+  //! Returns the memory usage reports of the components.
+  //! @returns Memory accounting of the components.
+  [[nodiscard]] const util::MemoryAccounting& GetMemoryAccounting() const;
 
+private:
+  //! Publishes the memory usage of the registries.
+  void PublishRegistryMemoryUsage();
+
+  //! Returns the listening sockets of the servers.
+  //! @returns Listening sockets of the servers which accept clients.
+  [[nodiscard]] std::vector<network::handoff::ListenerHandle> GetListenerHandles();
+
+  //! Serves the handoff of the listening sockets on the current thread.
+  //! Once handed off, the servers stop accepting and disconnect their clients,
+  //! the server instance terminates and writes out its data, and only then
+  //! releases the next process to serve the reconnecting clients.
+  void RunHandoff();
+
+  //! Waits for the threads of the directors to finish.
+  void JoinDirectorThreads();
+
+  //! Ticks the director on the current thread until the server stops.
+  //! Directors which provide `GetMemoryUsage()` report it between the ticks when due.
+  //! @param director Director to tick.
+  //! @param name Name of the director, a key of the tick times.
   template<typename T>
-  void RunDirectorTaskLoop(T& director)
+  void RunDirectorTaskLoop(T& director, const char* name)
   {
     using Clock = std::chrono::steady_clock;
 
+    auto& tickTime = _directorTickTimes.at(name);
+    util::trace::SetThreadName(std::format("{} director", name));
+
     constexpr uint64_t TicksPerSecond = 50;
     constexpr uint64_t millisPerTick = 1000ull / TicksPerSecond;
 
@@ -170,12 +245,34 @@ private:
 
       try
       {
+        const util::trace::Span span("director", name);
+        // The frames queued during the tick are flushed together once it ends.
+        const network::WriteCork cork;
         director.Tick();
       }
       catch (const std::exception& x)
       {
         spdlog::error("Exception in tick loop: {}", x.what());
       }
+
+      tickTime.Record(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+          Clock::now() - timeNow).count()));
+
+      if constexpr (requires { director.GetMemoryUsage(); })
+      {
+        if (IsMemoryUsageReportDue(name))
+        {
+          try
+          {
+            PublishMemoryUsage(name, director.GetMemoryUsage());
+          }
+          catch (const std::exception& x)
+          {
+            spdlog::error("Exception reporting the memory usage of the {} director: {}", name, x.what());
+          }
+        }
+      }
     }
   }
 
@@ -187,6 +284,11 @@ private:
   //! A config.
   Config _config;
 
+  //! Tick times of the directors, populated before the director threads start.
+  std::map<std::string, util::Histogram, std::less<>> _directorTickTimes;
+  //! Memory usage reports of the components.
+  util::MemoryAccounting _memoryAccounting;
+
   //! A thread of the authentication service.
   std::thread _authenticationThread;
   //! An authentication service.
@@ -227,6 +329,11 @@ private:
   //! A race director.
   RaceDirector _raceDirector;
 
+  //! A thread of the admin director.
+  std::thread _adminDirectorThread;
+  //! An admin director.
+  AdminDirector _adminDirector;
+
   //! A registry of courses.
   registry::CourseRegistry _courseRegistry;
   //! A registry of horses.
@@ -251,6 +358,10 @@ private:
   //! A room system.
   RoomSystem _roomSystem;
 
+  //! A thread of the handoff.
+  std::thread _handoffThread;
+  //! A provider of the listening sockets to the next process.
+  network::handoff::Provider _handoffProvider;
 };
 
 } // namespace server
@@ -0,0 +1,111 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#ifndef ADMINDIRECTOR_HPP
+#define ADMINDIRECTOR_HPP
+
+#include "server/Config.hpp"
+
+#include <libserver/network/http/WebSocket.hpp>
+
+#include <chrono>
+#include <deque>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace server
+{
+
+class ServerInstance;
+
+//! Serves the metrics of the running server on a local HTTP endpoint.
+//! Prometheus metrics are served at `/metrics` and the WebSocket clients
+//! receive the metric deltas every delta interval. The metrics are read
+//! from atomic counters, the game threads are never blocked.
+class AdminDirector final
+{
+public:
+  //! Constructor.
+  //! @param serverInstance Server instance.
+  explicit AdminDirector(ServerInstance& serverInstance);
+
+  void Initialize();
+  void Terminate();
+  void Tick();
+
+  //! Get admin config.
+  //! @return Admin config.
+  [[nodiscard]] Config::Admin& GetConfig();
+
+private:
+  //! A family of metric samples sharing the name and the type.
+  struct MetricFamily
+  {
+    enum class Type
+    {
+      Counter,
+      Gauge,
+      Summary
+    };
+
+    //! A metric sample.
+    struct Sample
+    {
+      //! Suffix appended to the family name.
+      std::string suffix;
+      //! Labels of the sample in the exposition format, without the braces.
+      std::string labels;
+      double value{};
+      //! Whether the sample is cumulative and its deltas are streamed.
+      bool isCumulative{};
+    };
+
+    std::string name;
+    std::string help;
+    Type type{Type::Gauge};
+    std::vector<Sample> samples;
+  };
+
+  //! Collects the metrics of the server.
+  //! Safe to call from any thread.
+  //! @returns Metric families.
+  [[nodiscard]] std::deque<MetricFamily> CollectMetrics();
+
+  //! Handles an HTTP request of the admin endpoint.
+  websocket::Response HandleRequest(std::string_view target);
+
+  //! Broadcasts the metric deltas since the last broadcast.
+  void BroadcastMetricDeltas();
+
+  ServerInstance& _serverInstance;
+
+  websocket::Server _server;
+  std::thread _serverThread;
+
+  //! Time of the last delta broadcast.
+  std::chrono::steady_clock::time_point _lastDeltaBroadcast;
+  //! Values of the cumulative samples at the last delta broadcast.
+  std::unordered_map<std::string, double> _lastCumulativeValues;
+};
+
+} // namespace server
+
+#endif // ADMINDIRECTOR_HPP
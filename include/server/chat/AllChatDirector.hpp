@@ -5,6 +5,7 @@
 #ifndef ALLCHATDIRECTOR_HPP
 #define ALLCHATDIRECTOR_HPP
 
+#include <libserver/network/ClientRegistry.hpp>
 #include <libserver/network/chatter/ChatterServer.hpp>
 #include <libserver/data/DataDefinitions.hpp>
 
@@ -39,6 +40,10 @@ public:
   //! @return Chat config.
   [[nodiscard]] Config::AllChat& GetConfig();
 
+  //! Get chatter server.
+  //! @return Chatter server.
+  [[nodiscard]] ChatterServer& GetChatterServer();
+
   void Initialize();
   void Terminate();
   ClientContext& GetClientContext(
@@ -49,6 +54,12 @@ public:
 private:
   void HandleClientConnected(network::ClientId clientId) override;
   void HandleClientDisconnected(network::ClientId clientId) override;
+  void HandleNetworkTick() override;
+
+  //! Estimates the memory usage of the clients and network buffers.
+  //! Must be called from the network thread.
+  //! @returns Memory usage of the subsystems of the director.
+  [[nodiscard]] util::MemoryUsageReport GetMemoryUsage() const;
 
   // Handler methods for chatter commands
   void HandleChatterEnterRoom(
@@ -66,7 +77,7 @@ private:
   ChatterServer _chatterServer;
   ServerInstance& _serverInstance;
 
-  std::unordered_map<network::ClientId, ClientContext> _clients;
+  network::ClientRegistry<ClientContext> _clients;
 };
 
 } // namespace server
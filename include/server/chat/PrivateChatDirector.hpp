@@ -37,6 +37,10 @@ public:
   //! @return Chat config.
   [[nodiscard]] Config::PrivateChat& GetConfig();
 
+  //! Get chatter server.
+  //! @return Chatter server.
+  [[nodiscard]] ChatterServer& GetChatterServer();
+
   void Initialize();
   void Terminate();
   ConversationContext& GetConversationContext(
@@ -47,6 +51,12 @@ public:
 private:
   void HandleClientConnected(network::ClientId clientId) override;
   void HandleClientDisconnected(network::ClientId clientId) override;
+  void HandleNetworkTick() override;
+
+  //! Estimates the memory usage of the conversations and network buffers.
+  //! Must be called from the network thread.
+  //! @returns Memory usage of the subsystems of the director.
+  [[nodiscard]] util::MemoryUsageReport GetMemoryUsage() const;
 
   const std::optional<network::ClientId> GetTargetClientIdByContext(
     const ConversationContext& conversationContext) const;
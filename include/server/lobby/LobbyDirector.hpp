@@ -150,6 +150,11 @@ public:
   //! @return Lobby network handler.
   [[nodiscard]] LobbyNetworkHandler& GetNetworkHandler();
 
+  //! Estimates the memory usage of the logins, users and guilds.
+  //! Must be called from the thread ticking the director.
+  //! @returns Memory usage of the subsystems of the director.
+  [[nodiscard]] util::MemoryUsageReport GetMemoryUsage() const;
+
 private:
   struct QueuedLogin
   {
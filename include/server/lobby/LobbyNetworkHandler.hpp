@@ -6,9 +6,12 @@
 #define ALICIA_SERVER_LOBBYNETWORKHANDLER_HPP
 
 #include <libserver/data/DataDefinitions.hpp>
+#include <libserver/network/HandlerError.hpp>
 #include <libserver/network/command/CommandServer.hpp>
 #include <libserver/network/command/proto/LobbyMessageDefinitions.hpp>
 
+#include <expected>
+
 namespace server
 {
 
@@ -51,6 +54,16 @@ public:
   void NotifyAchievementReward(
     data::Uid characterUid);
 
+  //! Get command server.
+  //! @return Command server.
+  [[nodiscard]] CommandServer& GetCommandServer();
+
+  //! Returns the network statistics of the client of a character.
+  //! @param characterUid UID of the character.
+  //! @returns Network statistics, or empty if the character is not connected.
+  [[nodiscard]] std::optional<network::ClientStatistics> GetClientStatistics(
+    data::Uid characterUid);
+
 private:
   struct ClientContext
   {
@@ -89,8 +102,17 @@ private:
   ClientContext& GetClientContext(
     ClientId clientId,
     bool requireAuthentication = true);
+  //! Get client context without throwing.
+  //! @returns Pointer to the client context or the error.
+  std::expected<ClientContext*, network::HandlerError> TryGetClientContext(
+    ClientId clientId,
+    bool requireAuthentication = true);
 
   void HandleNetworkTick() override;
+  //! Estimates the memory usage of the clients and their network buffers.
+  //! Must be called from the network thread.
+  //! @returns Memory usage of the subsystems of the network handler.
+  [[nodiscard]] util::MemoryUsageReport GetMemoryUsage() const;
   void HandleClientConnected(ClientId clientId) override;
   void HandleClientDisconnected(ClientId clientId) override;
 
@@ -109,7 +131,7 @@ private:
     ClientId clientId,
     const protocol::AcCmdCLRoomList& command);
 
-  void HandleHeartbeat(
+  network::HandlerResult HandleHeartbeat(
     ClientId clientId);
 
   void HandleMakeRoom(
@@ -142,7 +164,7 @@ private:
     ClientId clientId,
     protocol::AcCmdCLCreateNicknameCancel::Reason reason);
 
-  void HandleShowInventory(
+  network::HandlerResult HandleShowInventory(
     ClientId clientId,
     const protocol::AcCmdCLShowInventory& command);
 
@@ -166,7 +188,7 @@ private:
     ClientId clientId,
     const protocol::AcCmdCLRequestPersonalInfo& command);
 
-  void HandleEnterRanch(
+  network::HandlerResult HandleEnterRanch(
     ClientId clientId,
     const protocol::AcCmdCLEnterRanch& command);
 
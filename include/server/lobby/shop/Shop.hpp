@@ -6,6 +6,7 @@
 #define ALICIA_SERVER_SHOP_HPP
 
 #include <libserver/util/Locale.hpp>
+#include <libserver/util/Rcu.hpp>
 
 #include <cstdint>
 #include <string>
@@ -24,7 +25,7 @@ struct ShopList
 {
   struct Goods
   {
-    //! Goods sequence number (internal unique shop item number, incremental, cannot be 0)
+    //! Goods sequence number (the TID of the item, stable across reloads, cannot be 0)
     uint32_t goodsSq{};
     //! 0 - Goods info | 1 - Set (package)
     uint32_t setType{};
@@ -92,13 +93,28 @@ struct ShopList
 class ShopManager
 {
 public:
-  void GenerateShopList(registry::ItemRegistry& itemRegistry);
-  ShopList& GetShopList();
-  const std::string& GetSerializedShopList();
+  //! A shop list generated from a snapshot of the item registry.
+  struct Snapshot
+  {
+    ShopList shopList;
+    //! The shop list serialized for the clients.
+    std::string serializedShopList;
+  };
+
+  //! A pinned, immutable view of the shop list.
+  using View = util::Rcu<Snapshot>::View;
+
+  //! Generates the shop list from the current snapshot of the item registry
+  //! and publishes it, replacing the current one. Safe to call from any thread.
+  //! @param itemRegistry Item registry.
+  void GenerateShopList(const registry::ItemRegistry& itemRegistry);
+
+  //! Pins the current shop list. Safe to call from any thread.
+  //! @returns View of the current shop list.
+  [[nodiscard]] View Pin() const noexcept;
 
 private:
-  ShopList _shopList;
-  std::string _serializedShopList;
+  util::Rcu<Snapshot> _snapshot;
 };
 
 
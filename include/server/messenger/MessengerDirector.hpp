@@ -5,6 +5,7 @@
 #ifndef MESSENGERDIRECTOR_HPP
 #define MESSENGERDIRECTOR_HPP
 
+#include <libserver/network/ClientRegistry.hpp>
 #include <libserver/network/chatter/ChatterServer.hpp>
 #include <libserver/data/DataDefinitions.hpp>
 
@@ -50,6 +51,10 @@ public:
   //! @return Messenger config.
   [[nodiscard]] Config::Messenger& GetConfig();
 
+  //! Get chatter server.
+  //! @return Chatter server.
+  [[nodiscard]] ChatterServer& GetChatterServer();
+
   ClientContext& GetClientContext(
     network::ClientId clientId,
     bool requireAuthentication = true);
@@ -62,6 +67,12 @@ public:
 private:
   void HandleClientConnected(network::ClientId clientId) override;
   void HandleClientDisconnected(network::ClientId clientId) override;
+  void HandleNetworkTick() override;
+
+  //! Estimates the memory usage of the clients and network buffers.
+  //! Must be called from the network thread.
+  //! @returns Memory usage of the subsystems of the director.
+  [[nodiscard]] util::MemoryUsageReport GetMemoryUsage() const;
 
   // Handler methods for chatter commands
   void HandleChatterLogin(
@@ -135,7 +146,7 @@ private:
   ChatterServer _chatterServer;
   ServerInstance& _serverInstance;
 
-  std::unordered_map<network::ClientId, ClientContext> _clients;
+  network::ClientRegistry<ClientContext> _clients;
 };
 
 } // namespace server
@@ -22,14 +22,20 @@
 
 #include "server/Config.hpp"
 
+#include "server/tracker/EffectTracker.hpp"
 #include "server/tracker/RaceTracker.hpp"
 
+#include "libserver/registry/CourseRegistry.hpp"
 #include "libserver/registry/MagicRegistry.hpp"
+#include "libserver/network/ClientRegistry.hpp"
+#include "libserver/network/HandlerError.hpp"
 #include "libserver/network/command/CommandServer.hpp"
 #include "libserver/network/command/proto/RaceMessageDefinitions.hpp"
 #include "libserver/network/command/proto/RanchMessageDefinitions.hpp"
 #include "libserver/util/Scheduler.hpp"
 
+#include <expected>
+#include <optional>
 #include <random>
 #include <unordered_map>
 #include <unordered_set>
@@ -85,6 +91,19 @@ public:
 
   ServerInstance& GetServerInstance();
   Config::Race& GetConfig();
+  Scheduler& GetScheduler();
+  CommandServer& GetCommandServer();
+
+  //! Returns the network statistics of the client of a character.
+  //! @param characterUid UID of the character.
+  //! @returns Network statistics, or empty if the character is not connected.
+  [[nodiscard]] std::optional<network::ClientStatistics> GetClientStatistics(
+    data::Uid characterUid);
+
+  //! Estimates the memory usage of the clients, races, rooms and network buffers.
+  //! Must be called from the thread ticking the director.
+  //! @returns Memory usage of the subsystems of the director.
+  [[nodiscard]] util::MemoryUsageReport GetMemoryUsage();
 
 private:
   std::random_device _randomDevice;
@@ -113,6 +132,8 @@ private:
     data::Uid masterUid{data::InvalidUid};
     //! A race object tracker.
     tracker::RaceTracker tracker;
+    //! A magic effect tracker.
+    tracker::EffectTracker effects;
 
     //! A game mode of the race.
     protocol::GameMode raceGameMode;
@@ -122,6 +143,13 @@ private:
     uint16_t raceMapBlockId{};
     //! A mission ID of the race.
     uint16_t raceMissionId{};
+    //! A course registry snapshot pinned for the race, keeps the map layout alive.
+    registry::CourseRegistry::View course;
+    //! A layout of the race map, `nullptr` if the map has no layout.
+    const registry::Course::MapLayout* mapLayout{nullptr};
+    //! An OID of the item of the first item spawner.
+    //! Items are added in the order of the spawners, one per spawner.
+    tracker::Oid firstItemOid{};
 
     //! A time point of when the race is actually started (a countdown is finished).
     std::chrono::steady_clock::time_point raceStartTimePoint;
@@ -132,12 +160,38 @@ private:
   };
 
   ClientContext& GetClientContext(ClientId clientId, bool requireAuthorized = true);
+  //! Get client context without throwing.
+  //! @returns Pointer to the client context or the error.
+  std::expected<ClientContext*, network::HandlerError> TryGetClientContext(
+    ClientId clientId,
+    bool requireAuthorized = true);
+  //! Find the client ID by the character's unique ID. Safe to call from any thread.
+  //! @param characterUid UID of the character.
+  //! @returns Client ID or empty if the character is not associated with any client.
+  [[nodiscard]] std::optional<ClientId> FindClientIdByCharacterUid(data::Uid characterUid) const;
   ClientId GetClientIdByCharacterUid(data::Uid characterUid);
-  ClientContext& GetClientContextByCharacterUid(data::Uid characterUid);
   RaceInstance& GetRaceInstance(
     const RaceDirector::ClientContext clientContext,
     const bool checkRacer = true);
-  void ScheduleSkillEffect(server::RaceDirector::RaceInstance& raceInstance, server::tracker::Oid attackerId, server::tracker::Oid targetId, const server::registry::Magic::SlotInfo& magicSlotInfo, std::optional<std::function<void()>> afterEffectRemoved = std::nullopt);
+  //! Get the race instance of the client without throwing.
+  //! @returns Pointer to the race instance or `HandlerError::InvalidState`
+  //!          if the client is not in a room or, when checked, not a racer.
+  std::expected<RaceInstance*, network::HandlerError> TryGetRaceInstance(
+    const ClientContext& clientContext,
+    bool checkRacer = true);
+
+  //! Applies the skill effect of the magic slot to the target and broadcasts it.
+  void ApplySkillEffect(
+    RaceInstance& raceInstance,
+    tracker::Oid attackerOid,
+    tracker::Oid targetOid,
+    const registry::Magic::SlotInfo& magicSlotInfo);
+  //! Updates the states of the racer from the effects active on them.
+  void UpdateRacerEffectStates(
+    RaceInstance& raceInstance,
+    tracker::Oid racerOid);
+  //! Expires the magic effects and obstacles of the race and broadcasts their removal.
+  void TickMagicEffects(RaceInstance& raceInstance);
 
   void HandleEnterRoom(
     ClientId clientId,
@@ -206,15 +260,15 @@ private:
     ClientId clientId,
     const protocol::AcCmdCRRequestSpur& command);
 
-  void HandleHurdleClearResult(
+  network::HandlerResult HandleHurdleClearResult(
     ClientId clientId,
     const protocol::AcCmdCRHurdleClearResult& command);
 
-  void HandleStartingRate(
+  network::HandlerResult HandleStartingRate(
     ClientId clientId,
     const protocol::AcCmdCRStartingRate& command);
 
-  void HandleRaceUserPos(
+  network::HandlerResult HandleRaceUserPos(
     ClientId clientId,
     const protocol::AcCmdUserRaceUpdatePos& command);
 
@@ -222,11 +276,11 @@ private:
     ClientId clientId,
     const protocol::AcCmdCRChat& command);
 
-  void HandleRelayCommand(
+  network::HandlerResult HandleRelayCommand(
     ClientId clientId,
     const protocol::AcCmdCRRelayCommand& command);
 
-  void HandleRelay(
+  network::HandlerResult HandleRelay(
     ClientId clientId,
     const protocol::AcCmdCRRelay& command);
 
@@ -305,9 +359,13 @@ private:
   //! A command server instance.
   CommandServer _commandServer;
   //! A map of all client contexts.
-  std::unordered_map<ClientId, ClientContext> _clients;
+  network::ClientRegistry<ClientContext> _clients;
   //! A map of all race instanced indexed by room UIDs.
   std::unordered_map<uint32_t, RaceInstance> _raceInstances;
+  //! Effects expired by the last magic effect tick, reused between ticks.
+  std::vector<tracker::EffectTracker::Effect> _expiredEffects;
+  //! Obstacles expired by the last magic effect tick, reused between ticks.
+  std::vector<tracker::EffectTracker::Obstacles> _expiredObstacles;
 };
 
 } // namespace server
@@ -23,9 +23,13 @@
 #include "server/Config.hpp"
 #include "server/tracker/RanchTracker.hpp"
 
+#include "libserver/network/ClientRegistry.hpp"
+#include "libserver/network/HandlerError.hpp"
 #include "libserver/network/command/CommandServer.hpp"
 #include "libserver/network/command/proto/RanchMessageDefinitions.hpp"
 
+#include <expected>
+#include <optional>
 #include <random>
 #include <unordered_map>
 #include <unordered_set>
@@ -50,6 +54,7 @@ public:
 
   void HandleClientConnected(ClientId clientId) override;
   void HandleClientDisconnected(ClientId client) override;
+  void HandleNetworkTick() override;
 
 
   //!
@@ -103,8 +108,21 @@ public:
 
   ServerInstance& GetServerInstance();
   Config::Ranch& GetConfig();
+  CommandServer& GetCommandServer();
+
+  //! Returns the network statistics of the client of a character.
+  //! @param characterUid UID of the character.
+  //! @returns Network statistics, or empty if the character is not connected.
+  [[nodiscard]] std::optional<network::ClientStatistics> GetClientStatistics(
+    data::Uid characterUid);
 
 private:
+  //! Estimates the memory usage of the clients, ranches and network buffers.
+  //! Must be called from the network thread, hence private and reported
+  //! from the network tick rather than the director tick.
+  //! @returns Memory usage of the subsystems of the director.
+  [[nodiscard]] util::MemoryUsageReport GetMemoryUsage() const;
+
   std::random_device _randomDevice;
 
   struct ClientContext
@@ -136,31 +154,39 @@ private:
   //! @returns Client context.
   [[nodiscard]] ClientContext& GetClientContext(ClientId clientId, bool requireAuthentication = true);
 
+  //! Get client context without throwing.
+  //! @param clientId Id of the client.
+  //! @param requireAuthentication Require the client to be authorized.
+  //! @returns Pointer to the client context or the error.
+  [[nodiscard]] std::expected<ClientContext*, network::HandlerError> TryGetClientContext(
+    ClientId clientId,
+    bool requireAuthentication = true);
+
+  //! Find the client ID by the character's unique ID. Safe to call from any thread.
+  //! @param characterUid UID of the character.
+  //! @returns Client ID or empty if the character is not associated with any client.
+  [[nodiscard]] std::optional<ClientId> FindClientIdByCharacterUid(data::Uid characterUid) const;
+
   //! Get the client ID by the character's unique ID.
   //! @param characterUid UID of the character.
   //! @returns Client ID.
   [[nodiscard]] ClientId GetClientIdByCharacterUid(data::Uid characterUid);
 
-  //! Get the client context by the character's unique ID.
-  //! @param characterUid UID of the character.
-  //! @returns Client context.
-  [[nodiscard]] ClientContext& GetClientContextByCharacterUid(data::Uid characterUid);
-
   //! Handles the ranch enter command.
   //! @param clientId ID of the client
   //! @param command Command
-  void HandleEnterRanch(
+  network::HandlerResult HandleEnterRanch(
     ClientId clientId,
     const protocol::AcCmdCREnterRanch& command);
 
-  void HandleRanchLeave(
+  network::HandlerResult HandleRanchLeave(
     ClientId clientId);
 
-  void HandleChat(
+  network::HandlerResult HandleChat(
     ClientId clientId,
     const protocol::AcCmdCRRanchChat& command);
 
-  void HandleSnapshot(
+  network::HandlerResult HandleSnapshot(
     ClientId clientId,
     const protocol::AcCmdCRRanchSnapshot& command);
 
@@ -448,7 +474,7 @@ private:
   CommandServer _commandServer;
 
   //!
-  std::unordered_map<ClientId, ClientContext> _clients;
+  network::ClientRegistry<ClientContext> _clients;
   //!
   std::unordered_map<data::Uid, RanchInstance> _ranches;
 };
@@ -21,6 +21,7 @@
 #define ROOMREGISTRY_HPP
 
 #include <libserver/data/DataDefinitions.hpp>
+#include <libserver/util/MemoryUsage.hpp>
 
 #include <cstdint>
 #include <functional>
@@ -105,6 +106,9 @@ public:
   [[nodiscard]] Snapshot GetRoomSnapshot() const;
   [[nodiscard]] std::unordered_map<data::Uid, Player>& GetPlayers();
 
+  //! Returns the estimated heap size owned by the room.
+  [[nodiscard]] std::size_t EstimateHeapSize() const;
+
 private:
   Details _details;
   uint32_t _uid{};
@@ -123,6 +127,10 @@ public:
 
   std::vector<Room::Snapshot> GetRoomsSnapshot();
 
+  //! Returns the count of the rooms and their estimated size.
+  //! Safe to call from any thread.
+  [[nodiscard]] util::MemoryUsage GetMemoryUsage();
+
 private:
   struct Entry
   {
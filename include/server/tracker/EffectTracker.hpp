@@ -0,0 +1,130 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#ifndef EFFECTTRACKER_HPP
+#define EFFECTTRACKER_HPP
+
+#include "server/tracker/Tracker.hpp"
+
+#include <libserver/registry/MagicRegistry.hpp>
+#include <libserver/util/MemoryUsage.hpp>
+
+#include <chrono>
+#include <vector>
+
+namespace server::tracker
+{
+
+//! A tracker of the magic effects and obstacles active in a race.
+//! Effects are applied as the magic is used and expired in batch by the race tick.
+class EffectTracker
+{
+public:
+  using Clock = std::chrono::steady_clock;
+  using State = registry::Magic::EffectInfo::State;
+
+  //! An effect active on a racer.
+  struct Effect
+  {
+    //! An OID of the racer who caused the effect.
+    Oid attackerOid{InvalidEntityOid};
+    //! An OID of the racer under the effect.
+    Oid targetOid{InvalidEntityOid};
+    //! A type of the magic slot of the effect.
+    uint32_t magicType{};
+    //! A skill effect ID.
+    uint32_t skillEffectId{};
+    //! A racer state held by the effect.
+    State state{State::None};
+    //! A time point of when the effect expires.
+    Clock::time_point expiryTimePoint;
+  };
+
+  //! Obstacles placed by a magic.
+  struct Obstacles
+  {
+    //! A type of the magic slot which placed the obstacles.
+    uint32_t magicType{};
+    //! An instance ID of the first obstacle.
+    uint16_t firstObstacleInstanceId{};
+    //! A count of the obstacle instances.
+    uint16_t obstacleInstanceCount{};
+    //! A time point of when the obstacles expire.
+    Clock::time_point expiryTimePoint;
+  };
+
+  //! Applies the effect of the magic slot to the target.
+  //! An effect the target is already under is handled by the stacking rule of the effect.
+  //! @param attackerOid OID of the racer who caused the effect.
+  //! @param targetOid OID of the racer under the effect.
+  //! @param slotInfo Magic slot of the effect.
+  //! @param now Current time point.
+  //! @returns `true` if the effect was applied or refreshed, `false` if it was ignored.
+  bool Apply(
+    Oid attackerOid,
+    Oid targetOid,
+    const registry::Magic::SlotInfo& slotInfo,
+    Clock::time_point now);
+
+  //! Adds obstacles placed by the magic slot for its obstacle lifetime.
+  //! @param slotInfo Magic slot which placed the obstacles.
+  //! @param firstObstacleInstanceId Instance ID of the first obstacle.
+  //! @param obstacleInstanceCount Count of the obstacle instances.
+  //! @param now Current time point.
+  void AddObstacles(
+    const registry::Magic::SlotInfo& slotInfo,
+    uint16_t firstObstacleInstanceId,
+    uint16_t obstacleInstanceCount,
+    Clock::time_point now);
+
+  //! Expires the effects and the obstacles which are due.
+  //! The output vectors are cleared first, so the caller can reuse them between ticks.
+  //! @param now Current time point.
+  //! @param expiredEffects Output of the expired effects.
+  //! @param expiredObstacles Output of the expired obstacles.
+  void Expire(
+    Clock::time_point now,
+    std::vector<Effect>& expiredEffects,
+    std::vector<Obstacles>& expiredObstacles);
+
+  //! Returns whether any effect active on the target holds the state.
+  //! @param targetOid OID of the racer.
+  //! @param state Racer state.
+  //! @returns `true` if the target holds the state, `false` otherwise.
+  [[nodiscard]] bool HasState(Oid targetOid, State state) const;
+
+  //! Returns whether there are no effects or obstacles tracked.
+  [[nodiscard]] bool IsEmpty() const;
+
+  //! Clears all the effects and obstacles.
+  void Clear();
+
+  //! Returns the count of the tracked effects and obstacles and the estimated size of their vectors.
+  [[nodiscard]] util::MemoryUsage GetMemoryUsage() const;
+
+private:
+  //! Effects active in the race.
+  std::vector<Effect> _effects;
+  //! Obstacles placed in the race.
+  std::vector<Obstacles> _obstacles;
+};
+
+} // namespace server::tracker
+
+#endif // EFFECTTRACKER_HPP
@@ -24,10 +24,12 @@
 
 #include <libserver/data/DataDefinitions.hpp>
 #include <libserver/network/command/proto/CommonStructureDefinitions.hpp>
+#include <libserver/util/MemoryUsage.hpp>
 
 #include <array>
 #include <chrono>
 #include <map>
+#include <span>
 #include <unordered_set>
 
 namespace server::tracker
@@ -84,7 +86,8 @@ public:
   struct Item
   {
     Oid oid{};
-    std::vector<uint32_t> itemTypes{};
+    //! Item types of the spawner, views the map layout pinned by the race.
+    std::span<const uint32_t> itemTypes{};
     uint32_t currentType{};
     std::chrono::steady_clock::time_point respawnTimePoint{};
     std::array<float, 3> position{};
@@ -145,6 +148,9 @@ public:
 
   void Clear();
 
+  //! Returns the count of the tracked racers and items and the estimated size of their maps.
+  [[nodiscard]] util::MemoryUsage GetMemoryUsage() const;
+
 
 private:
   //! The next entity OID.
@@ -23,6 +23,7 @@
 #include "server/tracker/Tracker.hpp"
 
 #include <libserver/data/DataDefinitions.hpp>
+#include <libserver/util/MemoryUsage.hpp>
 
 #include <map>
 
@@ -65,6 +66,9 @@ public:
   //! @return Tracked horses.
   [[nodiscard]] const ObjectMap& GetHorses() const;
 
+  //! Returns the count of the tracked objects and the estimated size of the object maps.
+  [[nodiscard]] util::MemoryUsage GetMemoryUsage() const;
+
 private:
   //! The next entity ID.
   Oid _nextObjectId = 1;
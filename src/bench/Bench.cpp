@@ -0,0 +1,193 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "bench/Bench.hpp"
+
+#include <algorithm>
+
+namespace server::bench
+{
+
+State::State(const uint64_t iterations) noexcept
+  : _iterations(iterations)
+{
+}
+
+uint64_t State::GetIterations() const noexcept
+{
+  return _iterations;
+}
+
+void State::SetBytesPerIteration(const uint64_t bytes) noexcept
+{
+  _bytesPerIteration = bytes;
+}
+
+void State::SetItemsPerIteration(const uint64_t items) noexcept
+{
+  _itemsPerIteration = items;
+}
+
+void State::SetCounter(const std::string& name, const double value)
+{
+  _counters[name] = value;
+}
+
+void State::PauseTiming() noexcept
+{
+  Stop();
+}
+
+void State::ResumeTiming() noexcept
+{
+  Start();
+}
+
+State::Clock::duration State::GetElapsed() const noexcept
+{
+  return _elapsed;
+}
+
+uint64_t State::GetBytesPerIteration() const noexcept
+{
+  return _bytesPerIteration;
+}
+
+uint64_t State::GetItemsPerIteration() const noexcept
+{
+  return _itemsPerIteration;
+}
+
+const std::map<std::string, double>& State::GetCounters() const noexcept
+{
+  return _counters;
+}
+
+void State::Start() noexcept
+{
+  if (_isRunning)
+    return;
+
+  _isRunning = true;
+  _startedAt = Clock::now();
+}
+
+void State::Stop() noexcept
+{
+  if (not _isRunning)
+    return;
+
+  _elapsed += Clock::now() - _startedAt;
+  _isRunning = false;
+}
+
+void Registry::Add(std::string name, Function function)
+{
+  _benchmarks.emplace_back(Benchmark{
+    .name = std::move(name),
+    .function = std::move(function)});
+}
+
+const std::vector<Registry::Benchmark>& Registry::GetBenchmarks() const
+{
+  return _benchmarks;
+}
+
+namespace
+{
+
+//! Maximum count of the iterations of a repetition.
+constexpr uint64_t MaxIterations = 1'000'000'000;
+
+//! Performs the iterations of the benchmark.
+//! @returns State of the benchmark after the iterations.
+State Measure(const Registry::Benchmark& benchmark, const uint64_t iterations)
+{
+  State state(iterations);
+  state.Start();
+  benchmark.function(state);
+  state.Stop();
+  return state;
+}
+
+} // anon namespace
+
+Result Run(const Registry::Benchmark& benchmark, const RunOptions& options)
+{
+  const auto minTime = std::chrono::duration_cast<State::Clock::duration>(options.minTime);
+
+  // Calibrate the count of the iterations, the first run also warms up the caches.
+  uint64_t iterations = 1;
+  while (true)
+  {
+    const auto state = Measure(benchmark, iterations);
+    const auto elapsed = state.GetElapsed();
+    if (elapsed >= minTime || iterations >= MaxIterations)
+      break;
+
+    // Aim a little above the minimum time, grow at most tenfold at once
+    // as the short runs are imprecise.
+    const double ratio = elapsed.count() > 0
+      ? 1.2 * static_cast<double>(minTime.count()) / static_cast<double>(elapsed.count())
+      : 10.0;
+    iterations = std::min(
+      MaxIterations,
+      std::max(iterations + 1, static_cast<uint64_t>(
+        static_cast<double>(iterations) * std::min(ratio, 10.0))));
+  }
+
+  std::vector<double> nsPerIteration;
+  uint64_t bytesPerIteration = 0;
+  uint64_t itemsPerIteration = 0;
+  std::map<std::string, double> counters;
+
+  const auto repetitions = std::max(options.repetitions, 1u);
+  for (uint32_t repetition = 0; repetition < repetitions; ++repetition)
+  {
+    const auto state = Measure(benchmark, iterations);
+    nsPerIteration.emplace_back(
+      std::chrono::duration<double, std::nano>(state.GetElapsed()).count()
+      / static_cast<double>(iterations));
+
+    bytesPerIteration = state.GetBytesPerIteration();
+    itemsPerIteration = state.GetItemsPerIteration();
+    counters = state.GetCounters();
+  }
+
+  std::ranges::sort(nsPerIteration);
+
+  Result result{
+    .name = benchmark.name,
+    .iterations = iterations,
+    .repetitions = repetitions,
+    .nsPerIteration = nsPerIteration[nsPerIteration.size() / 2],
+    .minNsPerIteration = nsPerIteration.front(),
+    .maxNsPerIteration = nsPerIteration.back(),
+    .counters = std::move(counters)};
+
+  if (result.nsPerIteration > 0.0)
+  {
+    result.bytesPerSecond = static_cast<double>(bytesPerIteration) * 1e9 / result.nsPerIteration;
+    result.itemsPerSecond = static_cast<double>(itemsPerIteration) * 1e9 / result.nsPerIteration;
+  }
+
+  return result;
+}
+
+} // namespace server::bench
@@ -0,0 +1,171 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "bench/Bench.hpp"
+
+#include <libserver/network/ClientRegistry.hpp>
+
+#include <format>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace server::bench
+{
+
+namespace
+{
+
+//! Count of the connected clients of a director.
+constexpr uint32_t ClientCount = 1000;
+
+//! A context resembling the context of a ranch client.
+struct ClientContext
+{
+  std::string userName;
+  bool isAuthenticated{false};
+  uint32_t characterUid{0};
+  uint32_t visitingRancherUid{0};
+  uint8_t busyState{0};
+};
+
+//! Clients of a director, in the map and in the registry.
+struct Clients
+{
+  std::unordered_map<network::ClientId, ClientContext> map;
+  network::ClientRegistry<ClientContext> registry;
+};
+
+std::shared_ptr<Clients> MakeClients()
+{
+  auto clients = std::make_shared<Clients>();
+  for (uint32_t index = 0; index < ClientCount; ++index)
+  {
+    // IDs of the network server, the generation in the upper 32 bits.
+    const network::ClientId clientId = static_cast<network::ClientId>(index % 7) << 32 | index;
+    const ClientContext clientContext{
+      .userName = std::format("user{:016}", index),
+      .isAuthenticated = index % 10 != 0,
+      .characterUid = 1000 + index};
+
+    clients->map.try_emplace(clientId, clientContext);
+    clients->registry.Emplace(clientId) = clientContext;
+  }
+  return clients;
+}
+
+} // anon namespace
+
+void RegisterClientRegistryBenchmarks(Registry& registry)
+{
+  const auto clients = MakeClients();
+
+  // Broadcast scans of the authenticated clients.
+  registry.Add("client_registry/scan_1000/unordered_map_copy", [clients](State& state)
+  {
+    uint64_t checksum = 0;
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+    {
+      const auto clientsSnapshot = clients->map;
+      for (const auto& [clientId, clientContext] : clientsSnapshot)
+      {
+        if (clientContext.isAuthenticated)
+          checksum += clientId;
+      }
+    }
+    DoNotOptimize(checksum);
+  });
+
+  registry.Add("client_registry/scan_1000/unordered_map", [clients](State& state)
+  {
+    uint64_t checksum = 0;
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+    {
+      for (const auto& [clientId, clientContext] : clients->map)
+      {
+        if (clientContext.isAuthenticated)
+          checksum += clientId;
+      }
+    }
+    DoNotOptimize(checksum);
+  });
+
+  registry.Add("client_registry/scan_1000/registry", [clients](State& state)
+  {
+    uint64_t checksum = 0;
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+    {
+      for (const auto& [clientId, clientContext] : clients->registry)
+      {
+        if (clientContext.isAuthenticated)
+          checksum += clientId;
+      }
+    }
+    DoNotOptimize(checksum);
+  });
+
+  // Scans of the other threads, under the shared lock of the registry.
+  registry.Add("client_registry/scan_1000/registry_visit", [clients](State& state)
+  {
+    uint64_t checksum = 0;
+    std::thread([&clients, &state, &checksum]()
+    {
+      for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+      {
+        clients->registry.VisitEach(
+          [&checksum](const network::ClientId clientId, const ClientContext& clientContext)
+          {
+            if (clientContext.isAuthenticated)
+              checksum += clientId;
+          });
+      }
+    }).join();
+    DoNotOptimize(checksum);
+  });
+
+  // Look-ups of the clients by their IDs.
+  registry.Add("client_registry/find/unordered_map", [clients](State& state)
+  {
+    uint64_t checksum = 0;
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+    {
+      const auto index = static_cast<uint32_t>(iteration % ClientCount);
+      const auto clientIter = clients->map.find(
+        static_cast<network::ClientId>(index % 7) << 32 | index);
+      checksum += clientIter->second.characterUid;
+    }
+    DoNotOptimize(checksum);
+  });
+
+  registry.Add("client_registry/find/registry", [clients](State& state)
+  {
+    uint64_t checksum = 0;
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+    {
+      const auto index = static_cast<uint32_t>(iteration % ClientCount);
+      const auto clientContext = clients->registry.Find(
+        static_cast<network::ClientId>(index % 7) << 32 | index);
+      checksum += clientContext->characterUid;
+    }
+    DoNotOptimize(checksum);
+  });
+}
+
+} // namespace server::bench
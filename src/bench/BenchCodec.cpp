@@ -0,0 +1,134 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "bench/Bench.hpp"
+
+#include <libserver/network/command/CommandClientCodec.hpp>
+
+#include <array>
+#include <bit>
+#include <format>
+#include <span>
+#include <vector>
+
+namespace server::bench
+{
+
+namespace
+{
+
+//! Sizes of the command data encoded by the codec benchmarks.
+constexpr std::array CommandDataSizes{16uz, 256uz, 4096uz};
+
+} // anon namespace
+
+void RegisterCodecBenchmarks(Registry& registry)
+{
+  registry.Add("codec/magic/encode", [](State& state)
+  {
+    uint32_t sum = 0;
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+    {
+      sum += protocol::encode_message_magic({
+        .id = static_cast<uint16_t>(iteration),
+        .length = static_cast<uint16_t>(iteration & 0xFFF)});
+    }
+    DoNotOptimize(sum);
+  });
+
+  registry.Add("codec/magic/decode", [](State& state)
+  {
+    uint32_t sum = 0;
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+    {
+      const auto magic = protocol::decode_message_magic(
+        static_cast<uint32_t>(iteration * 0x9E3779B1));
+      sum += magic.id + magic.length;
+    }
+    DoNotOptimize(sum);
+  });
+
+  registry.Add("codec/roll_code", [](State& state)
+  {
+    CommandClient client;
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+    {
+      client.RollCode();
+      DoNotOptimize(client.GetRollingCode());
+    }
+  });
+
+  // Scrambling of the command data with the rolling XOR code,
+  // the same work the server does descrambling them.
+  for (const auto commandDataSize : CommandDataSizes)
+  {
+    registry.Add(
+      std::format("codec/client_encode/{}", commandDataSize),
+      [commandDataSize](State& state)
+      {
+        std::vector<std::byte> data(commandDataSize, std::byte{0x5A});
+        std::vector<std::byte> buffer;
+        buffer.reserve(commandDataSize + 64);
+
+        CommandClientCodec codec;
+        for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+        {
+          buffer.clear();
+          codec.Encode(
+            static_cast<uint16_t>(protocol::Command::AcCmdCRRanchSnapshot),
+            data,
+            buffer);
+          DoNotOptimize(buffer.data());
+        }
+
+        state.SetBytesPerIteration(commandDataSize);
+      });
+  }
+
+  registry.Add("codec/peek_server_command", [](State& state)
+  {
+    constexpr size_t CommandCount = 64;
+
+    // A buffer of the server commands, as received by a client.
+    std::vector<std::byte> buffer;
+    for (size_t idx = 0; idx < CommandCount; ++idx)
+    {
+      const uint16_t length = sizeof(protocol::MessageMagic) + 60;
+      const auto magic = protocol::encode_message_magic({
+        .id = static_cast<uint16_t>(protocol::Command::AcCmdCRRanchSnapshotNotify),
+        .length = length});
+      const auto magicBytes = std::bit_cast<std::array<std::byte, sizeof(magic)>>(magic);
+      buffer.insert(buffer.end(), magicBytes.begin(), magicBytes.end());
+      buffer.resize(buffer.size() + length - sizeof(protocol::MessageMagic));
+    }
+
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+    {
+      std::span<const std::byte> remaining(buffer);
+      while (const auto magic = CommandClientCodec::PeekServerCommand(remaining))
+        remaining = remaining.subspan(magic->length);
+      DoNotOptimize(remaining.data());
+    }
+
+    state.SetBytesPerIteration(buffer.size());
+    state.SetItemsPerIteration(CommandCount);
+  });
+}
+
+} // namespace server::bench
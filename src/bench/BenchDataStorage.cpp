@@ -0,0 +1,453 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "bench/Bench.hpp"
+
+#include <libserver/data/DataDefinitions.hpp>
+#include <libserver/data/DataStorage.hpp>
+#include <libserver/data/helper/ProtocolHelper.hpp>
+
+#include <array>
+#include <format>
+#include <numeric>
+#include <thread>
+
+namespace server::bench
+{
+
+namespace
+{
+
+using CharacterStorage = DataStorage<data::Uid, data::Character>;
+using ItemStorage = DataStorage<data::Uid, data::Item>;
+using HorseStorage = DataStorage<data::Uid, data::Horse>;
+
+//! Count of the characters loaded in the storage, resembling a busy server.
+constexpr uint32_t LoadedCharacterCount = 4096;
+//! Count of the characters modified between the ticks.
+constexpr uint32_t ModifiedCharacterCount = 256;
+//! Count of the threads reading a shared character.
+constexpr uint32_t ReaderThreadCount = 4;
+//! Count of the items in a full inventory, the protocol limit.
+constexpr uint32_t InventoryItemCount = 250;
+//! Count of the horses in a full stable.
+constexpr uint32_t StableHorseCount = 40;
+//! Size of the serialization buffer, the maximum size of the command data.
+constexpr size_t CommandBufferSize = 8192;
+
+//! Returns a storage with the characters loaded.
+//! @param policy Policy of the storage.
+std::unique_ptr<CharacterStorage> MakeStorage(const DataStoragePolicy& policy = {})
+{
+  auto storage = std::make_unique<CharacterStorage>(
+    [](const data::Uid& uid, data::Character& character)
+    {
+      character.uid = uid;
+      character.name = std::format("Character {}", uid);
+      return RetrieveResult::Retrieved;
+    },
+    [](const data::Uid&, data::Character&)
+    {
+      return true;
+    },
+    [](const data::Uid&)
+    {
+      return true;
+    },
+    "character",
+    policy);
+
+  for (data::Uid uid = 1; uid <= LoadedCharacterCount; ++uid)
+  {
+    storage->Create([uid]()
+    {
+      data::Character character;
+      character.uid = uid;
+      character.name = std::format("Character {}", uid);
+      return std::make_pair(uid, std::move(character));
+    });
+  }
+
+  // Process the stores of the created characters.
+  storage->Tick();
+  return storage;
+}
+
+//! Returns a storage with the items of an inventory loaded.
+std::unique_ptr<ItemStorage> MakeItemStorage()
+{
+  auto storage = std::make_unique<ItemStorage>(
+    [](const data::Uid&, data::Item&)
+    {
+      return RetrieveResult::Failed;
+    },
+    [](const data::Uid&, data::Item&)
+    {
+      return true;
+    },
+    [](const data::Uid&)
+    {
+      return true;
+    },
+    "item");
+
+  for (data::Uid uid = 1; uid <= InventoryItemCount; ++uid)
+  {
+    storage->Create([uid]()
+    {
+      data::Item item;
+      item.uid = uid;
+      item.tid = 30000 + uid;
+      item.count = 1;
+      return std::make_pair(uid, std::move(item));
+    });
+  }
+
+  storage->Tick();
+  return storage;
+}
+
+//! Returns a storage with the horses of a stable loaded.
+std::unique_ptr<HorseStorage> MakeHorseStorage()
+{
+  auto storage = std::make_unique<HorseStorage>(
+    [](const data::Uid&, data::Horse&)
+    {
+      return RetrieveResult::Failed;
+    },
+    [](const data::Uid&, data::Horse&)
+    {
+      return true;
+    },
+    [](const data::Uid&)
+    {
+      return true;
+    },
+    "horse");
+
+  for (data::Uid uid = 1; uid <= StableHorseCount; ++uid)
+  {
+    storage->Create([uid]()
+    {
+      data::Horse horse;
+      horse.uid = uid;
+      horse.tid = 20001;
+      horse.name = std::format("Horse {}", uid);
+      return std::make_pair(uid, std::move(horse));
+    });
+  }
+
+  storage->Tick();
+  return storage;
+}
+
+//! Reads a single character from multiple threads at once, like the directors
+//! reading a popular character.
+//! @param state State of the benchmark.
+//! @param policy Policy of the storage.
+void BenchSharedReads(State& state, const DataStoragePolicy& policy)
+{
+  state.PauseTiming();
+  const auto storage = MakeStorage(policy);
+  state.ResumeTiming();
+
+  std::vector<std::thread> readers;
+  for (uint32_t idx = 0; idx < ReaderThreadCount; ++idx)
+  {
+    readers.emplace_back([&storage, &state]()
+    {
+      const auto record = storage->Get(1);
+
+      uint32_t sum = 0;
+      for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+      {
+        record->Immutable([&sum](const data::Character& character)
+        {
+          sum += character.uid();
+        });
+      }
+      DoNotOptimize(sum);
+    });
+  }
+
+  for (auto& reader : readers)
+    reader.join();
+
+  state.PauseTiming();
+  state.SetItemsPerIteration(ReaderThreadCount);
+}
+
+} // anon namespace
+
+void RegisterDataStorageBenchmarks(Registry& registry)
+{
+  registry.Add("data_storage/get/available", [](State& state)
+  {
+    state.PauseTiming();
+    const auto storage = MakeStorage();
+    state.ResumeTiming();
+
+    uint32_t sum = 0;
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+    {
+      const auto uid = static_cast<data::Uid>(iteration % LoadedCharacterCount + 1);
+      auto record = storage->Get(uid);
+      record->Immutable([&sum](const data::Character& character)
+      {
+        sum += character.uid();
+      });
+    }
+    DoNotOptimize(sum);
+
+    state.PauseTiming();
+  });
+
+  registry.Add(std::format("data_storage/get/inventory_{}/copied", InventoryItemCount), [](State& state)
+  {
+    state.PauseTiming();
+    const auto storage = MakeItemStorage();
+    std::vector<data::Uid> inventory(InventoryItemCount);
+    std::iota(inventory.begin(), inventory.end(), 1);
+    state.ResumeTiming();
+
+    // Every get allocates a new vector of the records.
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+    {
+      DoNotOptimize(storage->Get(inventory));
+    }
+
+    state.PauseTiming();
+  });
+
+  registry.Add(std::format("data_storage/get/inventory_{}/reused", InventoryItemCount), [](State& state)
+  {
+    state.PauseTiming();
+    const auto storage = MakeItemStorage();
+    std::vector<data::Uid> inventory(InventoryItemCount);
+    std::iota(inventory.begin(), inventory.end(), 1);
+    state.ResumeTiming();
+
+    // Every get fills the same vector of the records.
+    std::vector<Record<data::Item>> records;
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+    {
+      DoNotOptimize(storage->Get(inventory, records));
+      DoNotOptimize(records);
+    }
+
+    state.PauseTiming();
+  });
+
+  registry.Add(std::format("data_storage/get/inventory_{}/view", InventoryItemCount), [](State& state)
+  {
+    state.PauseTiming();
+    const auto storage = MakeItemStorage();
+    std::vector<data::Uid> inventory(InventoryItemCount);
+    std::iota(inventory.begin(), inventory.end(), 1);
+    state.ResumeTiming();
+
+    // The items are read without their records.
+    uint32_t sum = 0;
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+    {
+      storage->View(inventory, [&sum](const data::Uid&, const data::Item& item)
+      {
+        sum += item.tid();
+      });
+    }
+    DoNotOptimize(sum);
+
+    state.PauseTiming();
+  });
+
+  registry.Add(std::format("data_storage/immutable/shared_{}/locked", ReaderThreadCount), [](State& state)
+  {
+    BenchSharedReads(state, {});
+  });
+
+  registry.Add(std::format("data_storage/immutable/shared_{}/snapshot", ReaderThreadCount), [](State& state)
+  {
+    BenchSharedReads(state, {.snapshotReads = true});
+  });
+
+  registry.Add(std::format("data_storage/inventory_{}/build", InventoryItemCount), [](State& state)
+  {
+    state.PauseTiming();
+    const auto storage = MakeItemStorage();
+    std::vector<data::Uid> inventory(InventoryItemCount);
+    std::iota(inventory.begin(), inventory.end(), 1);
+    state.ResumeTiming();
+
+    // Every item is copied to its protocol structure and serialized.
+    std::array<std::byte, CommandBufferSize> buffer{};
+    size_t size = 0;
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+    {
+      std::vector<protocol::Item> items;
+      protocol::BuildProtocolItems(items, *storage->Get(inventory));
+
+      SinkStream sink(buffer);
+      sink.Write(static_cast<uint8_t>(items.size()));
+      for (const auto& item : items)
+        sink.Write(item);
+      size = sink.GetCursor();
+      DoNotOptimize(buffer);
+    }
+
+    state.PauseTiming();
+    state.SetBytesPerIteration(size);
+  });
+
+  registry.Add(std::format("data_storage/inventory_{}/encoded", InventoryItemCount), [](State& state)
+  {
+    state.PauseTiming();
+    const auto storage = MakeItemStorage();
+    std::vector<data::Uid> inventory(InventoryItemCount);
+    std::iota(inventory.begin(), inventory.end(), 1);
+    state.ResumeTiming();
+
+    // The serialized forms cached by the item records are concatenated.
+    std::array<std::byte, CommandBufferSize> buffer{};
+    size_t size = 0;
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+    {
+      protocol::LobbyCommandShowInventoryOK command{};
+      protocol::EncodeProtocolItems(command.items, *storage->Get(inventory));
+
+      SinkStream sink(buffer);
+      sink.Write(command);
+      size = sink.GetCursor();
+      DoNotOptimize(buffer);
+    }
+
+    state.PauseTiming();
+    state.SetBytesPerIteration(size);
+  });
+
+  registry.Add(std::format("data_storage/stable_{}/build", StableHorseCount), [](State& state)
+  {
+    state.PauseTiming();
+    const auto storage = MakeHorseStorage();
+    std::vector<data::Uid> stable(StableHorseCount);
+    std::iota(stable.begin(), stable.end(), 1);
+    state.ResumeTiming();
+
+    std::array<std::byte, CommandBufferSize> buffer{};
+    size_t size = 0;
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+    {
+      std::vector<protocol::Horse> horses;
+      protocol::BuildProtocolHorses(horses, *storage->Get(stable));
+
+      SinkStream sink(buffer);
+      sink.Write(static_cast<uint8_t>(horses.size()));
+      for (const auto& horse : horses)
+        sink.Write(horse);
+      size = sink.GetCursor();
+      DoNotOptimize(buffer);
+    }
+
+    state.PauseTiming();
+    state.SetBytesPerIteration(size);
+  });
+
+  registry.Add(std::format("data_storage/stable_{}/encoded", StableHorseCount), [](State& state)
+  {
+    state.PauseTiming();
+    const auto storage = MakeHorseStorage();
+    std::vector<data::Uid> stable(StableHorseCount);
+    std::iota(stable.begin(), stable.end(), 1);
+    state.ResumeTiming();
+
+    std::array<std::byte, CommandBufferSize> buffer{};
+    size_t size = 0;
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+    {
+      protocol::LobbyCommandShowInventoryOK command{};
+      protocol::EncodeProtocolHorses(command.horses, *storage->Get(stable));
+
+      SinkStream sink(buffer);
+      sink.Write(command);
+      size = sink.GetCursor();
+      DoNotOptimize(buffer);
+    }
+
+    state.PauseTiming();
+    state.SetBytesPerIteration(size);
+  });
+
+  registry.Add("data_storage/get/retrieve", [](State& state)
+  {
+    state.PauseTiming();
+    const auto storage = MakeStorage();
+    state.ResumeTiming();
+
+    // Every iteration requests a character which is not loaded,
+    // retrieves it in a tick and evicts it afterwards.
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+    {
+      const auto uid = static_cast<data::Uid>(LoadedCharacterCount + 1 + iteration % 1024);
+      DoNotOptimize(storage->Get(uid));
+      storage->Tick();
+      DoNotOptimize(storage->Get(uid));
+      storage->Invalidate(uid);
+    }
+
+    state.PauseTiming();
+  });
+
+  registry.Add("data_storage/tick/idle", [](State& state)
+  {
+    state.PauseTiming();
+    const auto storage = MakeStorage();
+    state.ResumeTiming();
+
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+      storage->Tick();
+
+    state.PauseTiming();
+  });
+
+  registry.Add(std::format("data_storage/tick/store_{}", ModifiedCharacterCount), [](State& state)
+  {
+    state.PauseTiming();
+    const auto storage = MakeStorage();
+
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+    {
+      for (uint32_t idx = 0; idx < ModifiedCharacterCount; ++idx)
+      {
+        auto record = storage->Get(static_cast<data::Uid>(
+          (iteration * ModifiedCharacterCount + idx) % LoadedCharacterCount + 1));
+        record->Mutable([](data::Character& character)
+        {
+          character.carrots() += 1;
+        });
+      }
+
+      state.ResumeTiming();
+      storage->Tick();
+      state.PauseTiming();
+    }
+
+    state.SetItemsPerIteration(ModifiedCharacterCount);
+  });
+}
+
+} // namespace server::bench
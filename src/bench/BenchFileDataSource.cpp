@@ -0,0 +1,157 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "bench/Bench.hpp"
+
+#include <libserver/data/file/FileDataSource.hpp>
+
+#include <filesystem>
+#include <format>
+#include <memory>
+
+namespace server::bench
+{
+
+namespace
+{
+
+//! A data source in a temporary directory, removed with the data source.
+class TemporaryDataSource final
+{
+public:
+  TemporaryDataSource()
+    : _path(std::filesystem::temp_directory_path() / "alicia_bench_data")
+  {
+    std::filesystem::remove_all(_path);
+    _dataSource.Initialize(_path);
+  }
+
+  ~TemporaryDataSource()
+  {
+    std::error_code error;
+    std::filesystem::remove_all(_path, error);
+  }
+
+  TemporaryDataSource(const TemporaryDataSource&) = delete;
+  void operator=(const TemporaryDataSource&) = delete;
+
+  FileDataSource& Get()
+  {
+    return _dataSource;
+  }
+
+private:
+  std::filesystem::path _path;
+  FileDataSource _dataSource;
+};
+
+//! Returns a character of a well progressed player.
+data::Character MakeCharacter()
+{
+  data::Character character;
+  character.name() = "SomeCharacterName";
+  character.introduction() = "Racing through the forest every evening, add me!";
+  character.level = 60;
+  character.carrots = 100'000;
+
+  for (data::Uid uid = 1; uid <= 64; ++uid)
+    character.inventory().emplace_back(uid);
+  for (data::Uid uid = 1; uid <= 8; ++uid)
+    character.characterEquipment().emplace_back(uid);
+  for (data::Uid uid = 100; uid < 110; ++uid)
+    character.horses().emplace_back(uid);
+  return character;
+}
+
+} // anon namespace
+
+void RegisterFileDataSourceBenchmarks(Registry& registry)
+{
+  registry.Add("file_data_source/character/store", [](State& state)
+  {
+    state.PauseTiming();
+    TemporaryDataSource dataSource;
+    auto character = MakeCharacter();
+    dataSource.Get().CreateCharacter(character);
+    state.ResumeTiming();
+
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+      dataSource.Get().StoreCharacter(character.uid(), character);
+
+    state.PauseTiming();
+  });
+
+  registry.Add("file_data_source/character/retrieve", [](State& state)
+  {
+    state.PauseTiming();
+    TemporaryDataSource dataSource;
+    auto character = MakeCharacter();
+    dataSource.Get().CreateCharacter(character);
+    dataSource.Get().StoreCharacter(character.uid(), character);
+    state.ResumeTiming();
+
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+    {
+      data::Character retrieved;
+      dataSource.Get().RetrieveCharacter(character.uid(), retrieved);
+      DoNotOptimize(retrieved);
+    }
+
+    state.PauseTiming();
+  });
+
+  registry.Add("file_data_source/item/store", [](State& state)
+  {
+    state.PauseTiming();
+    TemporaryDataSource dataSource;
+    data::Item item;
+    item.tid = 30001;
+    item.count = 1;
+    dataSource.Get().CreateItem(item);
+    state.ResumeTiming();
+
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+      dataSource.Get().StoreItem(item.uid(), item);
+
+    state.PauseTiming();
+  });
+
+  registry.Add("file_data_source/item/retrieve", [](State& state)
+  {
+    state.PauseTiming();
+    TemporaryDataSource dataSource;
+    data::Item item;
+    item.tid = 30001;
+    item.count = 1;
+    dataSource.Get().CreateItem(item);
+    dataSource.Get().StoreItem(item.uid(), item);
+    state.ResumeTiming();
+
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+    {
+      data::Item retrieved;
+      dataSource.Get().RetrieveItem(item.uid(), retrieved);
+      DoNotOptimize(retrieved);
+    }
+
+    state.PauseTiming();
+  });
+}
+
+} // namespace server::bench
@@ -0,0 +1,129 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "bench/Bench.hpp"
+
+#include <libserver/util/IdTable.hpp>
+
+#include <format>
+#include <memory>
+#include <random>
+#include <unordered_map>
+
+namespace server::bench
+{
+
+namespace
+{
+
+//! Count of distinct lookup IDs, a power of two.
+constexpr uint32_t LookupIdCount = 4096;
+
+//! A value resembling a registry record.
+struct Record
+{
+  uint32_t tid{};
+  uint32_t payload[15]{};
+};
+
+//! Tables with the same records and a lookup sequence of them.
+struct Tables
+{
+  std::unordered_map<uint32_t, Record> map;
+  std::unique_ptr<util::IdTable<Record>> table;
+  std::vector<uint32_t> lookupIds;
+};
+
+std::shared_ptr<const Tables> MakeTables(uint32_t idCount, uint32_t minId, uint32_t maxId)
+{
+  std::mt19937 generator(0xA11C1A);
+  std::uniform_int_distribution<uint32_t> idDistribution(minId, maxId);
+
+  auto tables = std::make_shared<Tables>();
+  std::vector<std::pair<uint32_t, Record>> entries;
+  while (tables->map.size() < idCount)
+  {
+    const auto id = idDistribution(generator);
+    if (tables->map.try_emplace(id, Record{.tid = id}).second)
+      entries.emplace_back(id, Record{.tid = id});
+  }
+
+  tables->table = std::make_unique<util::IdTable<Record>>(std::move(entries));
+
+  // Lookup sequence of mostly present IDs with a few missing ones.
+  for (uint32_t idx = 0; idx < LookupIdCount; ++idx)
+  {
+    const auto id = idDistribution(generator);
+    tables->lookupIds.emplace_back(idx % 8 == 0 || tables->map.contains(id)
+      ? id
+      : std::next(tables->map.cbegin(), id % tables->map.size())->first);
+  }
+
+  return tables;
+}
+
+void AddLookups(
+  Registry& registry,
+  const std::string& name,
+  uint32_t idCount,
+  uint32_t minId,
+  uint32_t maxId)
+{
+  const auto tables = MakeTables(idCount, minId, maxId);
+
+  registry.Add(std::format("id_table/{}/unordered_map", name), [tables](State& state)
+  {
+    uint64_t checksum = 0;
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+    {
+      const auto recordIter = tables->map.find(
+        tables->lookupIds[iteration & (LookupIdCount - 1)]);
+      checksum += recordIter == tables->map.cend() ? 0 : recordIter->second.tid;
+    }
+    DoNotOptimize(checksum);
+  });
+
+  registry.Add(
+    std::format("id_table/{}/{}", name, tables->table->IsDense() ? "dense" : "perfect_hash"),
+    [tables](State& state)
+    {
+      uint64_t checksum = 0;
+      for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+      {
+        const auto record = tables->table->Find(
+          tables->lookupIds[iteration & (LookupIdCount - 1)]);
+        checksum += record == nullptr ? 0 : record->tid;
+      }
+      DoNotOptimize(checksum);
+    });
+}
+
+} // anon namespace
+
+void RegisterIdTableBenchmarks(Registry& registry)
+{
+  // Ranges resembling the shipped registries.
+  AddLookups(registry, "items", 745, 10002, 99185);
+  AddLookups(registry, "pets", 157, 99000, 99999);
+  AddLookups(registry, "mapBlocks", 55, 1, 20009);
+  AddLookups(registry, "magic", 24, 2, 25);
+  AddLookups(registry, "packages", 74, 1001, 1083);
+}
+
+} // namespace server::bench
@@ -0,0 +1,65 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "bench/Bench.hpp"
+
+#include <libserver/util/Locale.hpp>
+
+#include <string>
+
+namespace server::bench
+{
+
+namespace
+{
+
+//! A chat message in UTF-8, mixing korean and latin characters.
+const std::string Utf8Message = "안녕하세요! 오늘 저녁에 숲에서 경주할 사람? race in the forest tonight?";
+//! A korean character name in UTF-8.
+const std::string Utf8Name = "빠른기수";
+
+} // anon namespace
+
+void RegisterLocaleBenchmarks(Registry& registry)
+{
+  registry.Add("locale/from_utf8", [](State& state)
+  {
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+      DoNotOptimize(locale::FromUtf8(Utf8Message));
+
+    state.SetBytesPerIteration(Utf8Message.size());
+  });
+
+  registry.Add("locale/to_utf8", [](State& state)
+  {
+    const auto eucKrMessage = locale::FromUtf8(Utf8Message);
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+      DoNotOptimize(locale::ToUtf8(eucKrMessage));
+
+    state.SetBytesPerIteration(eucKrMessage.size());
+  });
+
+  registry.Add("locale/is_name_valid", [](State& state)
+  {
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+      DoNotOptimize(locale::IsNameValid(Utf8Name));
+  });
+}
+
+} // namespace server::bench
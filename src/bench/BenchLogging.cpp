@@ -0,0 +1,197 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+#include "bench/Bench.hpp"
+
+#include <spdlog/async.h>
+#include <spdlog/sinks/daily_file_sink.h>
+#include <spdlog/spdlog.h>
+
+#ifdef _WIN32
+#include <spdlog/sinks/basic_file_sink.h>
+#else
+#include <spdlog/details/console_globals.h>
+#include <spdlog/sinks/ansicolor_sink.h>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <format>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace server::bench
+{
+
+namespace
+{
+
+//! Count of the threads logging chat messages, like the director and network threads.
+constexpr uint32_t ThreadCount = 4;
+//! Capacity of the asynchronous log queue, the default of the config.
+constexpr size_t QueueSize = 8192;
+//! Pattern of the server logger.
+constexpr const char* LoggerPattern = "%H:%M:%S:%e [%^%l%$] [Thread %t] %v";
+
+//! The sinks of the server logger, a daily file and a colored console.
+//! The console writes to a temporary file, so that the results stay readable.
+class Sinks final
+{
+public:
+  //! Constructor.
+  //! @param name Name of the directory of the files.
+  explicit Sinks(const std::string_view name)
+    : _directory(std::filesystem::temp_directory_path() / std::format("alicia_bench_logging_{}", name))
+  {
+    std::filesystem::create_directories(_directory);
+
+    const auto fileSink = std::make_shared<spdlog::sinks::daily_file_sink_mt>(
+      (_directory / "log.txt").string(), 0, 0, true);
+#ifdef _WIN32
+    const auto consoleSink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(
+      (_directory / "console.txt").string(), true);
+#else
+    _console = std::tmpfile();
+    const auto consoleSink = std::make_shared<spdlog::sinks::ansicolor_sink<spdlog::details::console_mutex>>(
+      _console, spdlog::color_mode::always);
+#endif
+
+    _sinks = {fileSink, consoleSink};
+  }
+
+  ~Sinks()
+  {
+    _sinks.clear();
+#ifndef _WIN32
+    if (_console != nullptr)
+      std::fclose(_console);
+#endif
+    std::error_code error;
+    std::filesystem::remove_all(_directory, error);
+  }
+
+  Sinks(const Sinks&) = delete;
+  Sinks& operator=(const Sinks&) = delete;
+
+  [[nodiscard]] const std::vector<spdlog::sink_ptr>& Get() const noexcept
+  {
+    return _sinks;
+  }
+
+private:
+  std::filesystem::path _directory;
+#ifndef _WIN32
+  FILE* _console{nullptr};
+#endif
+  std::vector<spdlog::sink_ptr> _sinks;
+};
+
+//! Logs the chat messages from the threads and reports the latency percentiles
+//! of a single log call.
+//! @param state State of the benchmark.
+//! @param logger Logger to measure.
+void LogChat(State& state, spdlog::logger& logger)
+{
+  const uint64_t messageCount = std::max<uint64_t>(state.GetIterations() / ThreadCount, 1);
+
+  std::vector<std::vector<int64_t>> latencies(ThreadCount);
+  std::vector<std::thread> threads;
+
+  for (uint32_t threadIdx = 0; threadIdx < ThreadCount; ++threadIdx)
+  {
+    threads.emplace_back([&logger, &threadLatencies = latencies[threadIdx], messageCount, threadIdx]()
+    {
+      threadLatencies.reserve(messageCount);
+      for (uint64_t messageIdx = 0; messageIdx < messageCount; ++messageIdx)
+      {
+        const auto begin = State::Clock::now();
+        logger.info(
+          "[Global] {} ({}): {}",
+          "SomeCharacterName",
+          threadIdx * messageCount + messageIdx,
+          "hello everyone, anyone up for a race in the forest?");
+        threadLatencies.emplace_back(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(State::Clock::now() - begin).count());
+      }
+    });
+  }
+
+  for (auto& thread : threads)
+    thread.join();
+
+  state.PauseTiming();
+  std::vector<int64_t> allLatencies;
+  for (const auto& threadLatencies : latencies)
+    allLatencies.insert(allLatencies.end(), threadLatencies.begin(), threadLatencies.end());
+  std::ranges::sort(allLatencies);
+
+  const auto percentile = [&allLatencies](const double value)
+  {
+    return static_cast<double>(
+      allLatencies[static_cast<size_t>(value * static_cast<double>(allLatencies.size() - 1))]);
+  };
+
+  state.SetCounter("p50_ns", percentile(0.5));
+  state.SetCounter("p99_ns", percentile(0.99));
+  state.SetCounter("p999_ns", percentile(0.999));
+  state.ResumeTiming();
+}
+
+} // anon namespace
+
+void RegisterLoggingBenchmarks(Registry& registry)
+{
+  // Compare the synchronous and the asynchronous logger of the server under chat load,
+  // with the sinks of the server.
+  registry.Add(std::format("logging/chat/sync/{}", ThreadCount), [](State& state)
+  {
+    state.PauseTiming();
+    static Sinks sinks("sync");
+    spdlog::logger logger("sync", sinks.Get().begin(), sinks.Get().end());
+    logger.set_pattern(LoggerPattern);
+    state.ResumeTiming();
+
+    LogChat(state, logger);
+    logger.flush();
+  });
+
+  registry.Add(std::format("logging/chat/async/{}", ThreadCount), [](State& state)
+  {
+    state.PauseTiming();
+    static Sinks sinks("async");
+    const auto threadPool = std::make_shared<spdlog::details::thread_pool>(QueueSize, 1);
+    // The messages are queued with a reference to the logger.
+    auto logger = std::make_shared<spdlog::async_logger>(
+      "async",
+      sinks.Get().begin(),
+      sinks.Get().end(),
+      threadPool,
+      spdlog::async_overflow_policy::block);
+    logger->set_pattern(LoggerPattern);
+    state.ResumeTiming();
+
+    // The time includes writing out the queue, the pool drains it before it stops.
+    LogChat(state, *logger);
+    logger.reset();
+  });
+}
+
+} // namespace server::bench
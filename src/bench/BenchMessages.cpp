@@ -0,0 +1,208 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "bench/Bench.hpp"
+
+#include <libserver/network/command/proto/LobbyMessageDefinitions.hpp>
+#include <libserver/network/command/proto/RanchMessageDefinitions.hpp>
+
+#include <array>
+#include <format>
+
+namespace server::bench
+{
+
+namespace
+{
+
+//! Size of the serialization buffer, the maximum size of the command data.
+constexpr size_t BufferSize = 8192;
+
+//! Count of the equipped items of a character.
+constexpr uint32_t EquipmentCount = 8;
+//! Count of the horses shown in a full ranch.
+constexpr uint32_t RanchHorseCount = 10;
+//! Count of the characters in a busy ranch, the response fits the command data limit.
+constexpr uint32_t RanchCharacterCount = 12;
+//! Count of the rooms on a page of the room list.
+constexpr uint32_t RoomsPerPage = 9;
+
+protocol::Horse MakeHorse(const uint32_t uid)
+{
+  protocol::Horse horse{
+    .uid = uid,
+    .tid = 20001,
+    .name = std::format("Horse {}", uid)};
+  return horse;
+}
+
+std::vector<protocol::Item> MakeEquipment(const uint32_t uid)
+{
+  std::vector<protocol::Item> items;
+  for (uint32_t idx = 0; idx < EquipmentCount; ++idx)
+  {
+    items.emplace_back(protocol::Item{
+      .uid = uid + idx,
+      .tid = 30000 + idx,
+      .count = 1});
+  }
+  return items;
+}
+
+//! Returns a login response of a well progressed character.
+protocol::LobbyCommandLoginOK MakeLoginOK()
+{
+  protocol::LobbyCommandLoginOK command{
+    .uid = 1,
+    .name = "FastRider",
+    .notice = "Players online: 1234",
+    .introduction = "Racing through the forest every evening, add me!",
+    .equipmentItems = MakeEquipment(100),
+    .level = 60,
+    .carrots = 100'000};
+
+  for (uint16_t missionIdx = 0; missionIdx < 16; ++missionIdx)
+  {
+    auto& mission = command.missions.emplace_back();
+    mission.id = missionIdx;
+    mission.progress.resize(4);
+  }
+
+  command.horse = MakeHorse(200);
+  for (uint32_t value = 0; value < 16; ++value)
+    command.systemContent.values[value] = value;
+  for (uint8_t skillId = 0; skillId < 32; ++skillId)
+    command.skillRanks.values.emplace_back(skillId, 1);
+
+  return command;
+}
+
+//! Returns a ranch response of a busy ranch.
+protocol::AcCmdCREnterRanchOK MakeEnterRanchOK()
+{
+  protocol::AcCmdCREnterRanchOK command{
+    .rancherUid = 1,
+    .rancherName = "FastRider",
+    .ranchName = "FastRider's ranch"};
+
+  for (uint32_t idx = 0; idx < RanchHorseCount; ++idx)
+  {
+    command.horses.emplace_back(protocol::RanchHorse{
+      .horseOid = static_cast<uint16_t>(idx + 1),
+      .horse = MakeHorse(1000 + idx)});
+  }
+
+  for (uint32_t idx = 0; idx < RanchCharacterCount; ++idx)
+  {
+    auto& character = command.characters.emplace_back();
+    character.uid = 2000 + idx;
+    character.name = std::format("Character {}", idx);
+    character.introduction = "Racing through the forest every evening, add me!";
+    character.mount = MakeHorse(3000 + idx);
+    character.characterEquipment = MakeEquipment(4000 + idx * EquipmentCount);
+    character.guild.name = "SomeGuild";
+    character.oid = static_cast<uint16_t>(RanchHorseCount + idx + 1);
+  }
+
+  for (uint16_t idx = 0; idx < 12; ++idx)
+  {
+    command.housing.emplace_back(protocol::Housing{
+      .uid = 5000u + idx,
+      .tid = static_cast<uint16_t>(idx + 1),
+      .durability = 100});
+  }
+
+  return command;
+}
+
+//! Returns a full page of the room list.
+protocol::LobbyCommandRoomListOK MakeRoomListOK()
+{
+  protocol::LobbyCommandRoomListOK command{};
+  for (uint32_t idx = 0; idx < RoomsPerPage; ++idx)
+  {
+    command.rooms.emplace_back(protocol::LobbyCommandRoomListOK::Room{
+      .uid = idx + 1,
+      .name = std::format("Room of the fast riders {}", idx),
+      .playerCount = 4,
+      .maxPlayerCount = 8,
+      .map = 10002});
+  }
+  return command;
+}
+
+//! Registers a benchmark writing the command.
+template <typename Command>
+void AddWrite(Registry& registry, const std::string& name, Command command)
+{
+  registry.Add(
+    std::format("message/write/{}", name),
+    [command = std::move(command)](State& state)
+    {
+      std::array<std::byte, BufferSize> buffer{};
+      size_t size = 0;
+      for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+      {
+        SinkStream sink(buffer);
+        sink.Write(command);
+        size = sink.GetCursor();
+        DoNotOptimize(buffer);
+      }
+
+      state.SetBytesPerIteration(size);
+    });
+}
+
+//! Registers a benchmark reading the command.
+template <typename Command>
+void AddRead(Registry& registry, const std::string& name, const Command& command)
+{
+  std::array<std::byte, BufferSize> buffer{};
+  SinkStream sink(buffer);
+  sink.Write(command);
+  const auto size = sink.GetCursor();
+
+  registry.Add(
+    std::format("message/read/{}", name),
+    [buffer, size](State& state)
+    {
+      for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+      {
+        Command command{};
+        SourceStream source({buffer.data(), size});
+        source.Read(command);
+        DoNotOptimize(command);
+      }
+
+      state.SetBytesPerIteration(size);
+    });
+}
+
+} // anon namespace
+
+void RegisterMessageBenchmarks(Registry& registry)
+{
+  AddWrite(registry, "AcCmdCLLoginOK", MakeLoginOK());
+  AddRead(registry, "AcCmdCLLoginOK", MakeLoginOK());
+  AddWrite(registry, "AcCmdCREnterRanchOK", MakeEnterRanchOK());
+  AddRead(registry, "AcCmdCREnterRanchOK", MakeEnterRanchOK());
+  AddWrite(registry, "AcCmdCLRoomListOK", MakeRoomListOK());
+}
+
+} // namespace server::bench
@@ -0,0 +1,715 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "bench/Bench.hpp"
+
+#include <libserver/network/Server.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace server::bench
+{
+
+namespace
+{
+
+namespace asio = boost::asio;
+
+//! Size of a message.
+constexpr size_t MessageSize = 64;
+//! Count of the messages sent at once by the burst benchmark.
+constexpr size_t BurstSize = 32;
+//! Count of the bots connected to the relay.
+constexpr size_t BotCount = 16;
+//! Count of the frames a bot receives for every relayed message,
+//! like a chat message followed by the status updates of a room.
+constexpr size_t FramesPerRelay = 4;
+
+//! Size of a frame of the ingest benchmark, like a ranch snapshot.
+constexpr size_t IngestFrameSize = 16 * 1024;
+//! Count of the clients of the idle benchmark.
+constexpr size_t IdleClientCount = 5000;
+
+//! Queues a frame of the message size to a client.
+void QueueFrame(network::Server& server, const network::ClientId clientId)
+{
+  server.QueueWrite(clientId, [](asio::streambuf& buffer)
+  {
+    std::memset(buffer.prepare(MessageSize).data(), 0x2A, MessageSize);
+    buffer.commit(MessageSize);
+    return MessageSize;
+  });
+}
+
+//! Counts the system calls of the current thread and the threads it creates afterwards,
+//! through the `raw_syscalls:sys_enter` tracepoint. Unavailable unless the tracepoints
+//! may be traced, see `/proc/sys/kernel/perf_event_paranoid`.
+class SyscallCounter final
+{
+public:
+  SyscallCounter()
+  {
+#ifdef __linux__
+    std::ifstream idFile("/sys/kernel/tracing/events/raw_syscalls/sys_enter/id");
+    if (not idFile.is_open())
+      idFile.open("/sys/kernel/debug/tracing/events/raw_syscalls/sys_enter/id");
+
+    uint64_t tracepointId{};
+    if (not (idFile >> tracepointId))
+      return;
+
+    perf_event_attr attributes{};
+    attributes.type = PERF_TYPE_TRACEPOINT;
+    attributes.size = sizeof(attributes);
+    attributes.config = tracepointId;
+    attributes.inherit = 1;
+
+    _handle = static_cast<int>(::syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+#endif
+  }
+
+  ~SyscallCounter()
+  {
+#ifdef __linux__
+    if (_handle >= 0)
+      ::close(_handle);
+#endif
+  }
+
+  SyscallCounter(const SyscallCounter&) = delete;
+  SyscallCounter& operator=(const SyscallCounter&) = delete;
+
+  //! Returns the count of the system calls.
+  //! @returns Count of the system calls, or empty if unavailable.
+  [[nodiscard]] std::optional<uint64_t> Read() const
+  {
+#ifdef __linux__
+    uint64_t count{};
+    if (_handle >= 0 && ::read(_handle, &count, sizeof(count)) == sizeof(count))
+      return count;
+#endif
+    return std::nullopt;
+  }
+
+private:
+  int _handle{-1};
+};
+
+//! An echo server on the loopback with a connected client.
+//! Kept for all the repetitions, as the server throttles the connections per address.
+class Loopback final
+  : public network::EventHandlerInterface
+{
+public:
+  Loopback()
+    : _server(*this)
+  {
+    _serverThread = std::thread([this]()
+    {
+      _server.Begin(asio::ip::address_v4::loopback(), 0);
+    });
+
+    while (_server.GetPort() == 0)
+      std::this_thread::yield();
+
+    _client.connect({asio::ip::address_v4::loopback(), _server.GetPort()});
+    _client.set_option(asio::ip::tcp::no_delay(true));
+  }
+
+  ~Loopback() override
+  {
+    _client.close();
+    _server.End();
+    _serverThread.join();
+  }
+
+  void HandleNetworkTick() override
+  {
+  }
+
+  void OnClientConnected(network::ClientId) override
+  {
+  }
+
+  void OnClientDisconnected(network::ClientId) override
+  {
+  }
+
+  size_t OnClientData(network::ClientId clientId, const std::span<const std::byte>& data) override
+  {
+    // A single write per read, like a handler responding to a command.
+    _server.QueueWrite(
+      clientId,
+      [echo = std::vector<std::byte>(data.begin(), data.end())](asio::streambuf& buffer)
+      {
+        std::memcpy(buffer.prepare(echo.size()).data(), echo.data(), echo.size());
+        buffer.commit(echo.size());
+        return echo.size();
+      });
+
+    return data.size();
+  }
+
+  [[nodiscard]] asio::ip::tcp::socket& GetClient()
+  {
+    return _client;
+  }
+
+  [[nodiscard]] const SyscallCounter& GetSyscallCounter() const
+  {
+    return _syscallCounter;
+  }
+
+private:
+  //! Created before the server thread, so that its system calls are counted.
+  SyscallCounter _syscallCounter;
+
+  network::Server _server;
+  std::thread _serverThread;
+
+  asio::io_context _ioContext;
+  asio::ip::tcp::socket _client{_ioContext};
+};
+
+Loopback& GetLoopback(State& state)
+{
+  state.PauseTiming();
+  static Loopback loopback;
+  state.ResumeTiming();
+  return loopback;
+}
+
+//! Sends the messages and receives their echoes.
+//! @param state State of the benchmark.
+//! @param messageCount Count of the messages sent before receiving the echoes.
+void Echo(State& state, const size_t messageCount)
+{
+  auto& loopback = GetLoopback(state);
+  auto& client = loopback.GetClient();
+
+  const std::vector<std::byte> message(MessageSize, std::byte{0x2A});
+  std::vector<std::byte> echo(MessageSize * messageCount);
+
+  const auto syscallsBefore = loopback.GetSyscallCounter().Read();
+
+  for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+  {
+    for (size_t idx = 0; idx < messageCount; ++idx)
+      asio::write(client, asio::buffer(message));
+
+    asio::read(client, asio::buffer(echo));
+  }
+
+  const auto syscallsAfter = loopback.GetSyscallCounter().Read();
+
+  state.SetBytesPerIteration(2 * MessageSize * messageCount);
+  state.SetItemsPerIteration(messageCount);
+
+  // Include the system calls of both the server and the client,
+  // the client's are the same regardless of the backend.
+  if (syscallsBefore && syscallsAfter)
+  {
+    state.SetCounter(
+      "syscalls_per_message",
+      static_cast<double>(*syscallsAfter - *syscallsBefore)
+        / static_cast<double>(state.GetIterations() * messageCount));
+  }
+}
+
+//! A relay server on the loopback with connected bots. A director thread relays every
+//! message received from a bot to all the other bots during its tick, like a room.
+//! Kept for all the repetitions, as the server throttles the connections per address.
+class Relay final
+  : public network::EventHandlerInterface
+{
+public:
+  //! Constructor.
+  //! @param isCorked Whether the ticks of the director are corked.
+  //! @param botNetwork Third octet of the loopback addresses of the bots,
+  //!                   every bot connects from its own address.
+  Relay(const bool isCorked, const uint8_t botNetwork)
+    : _isCorked(isCorked)
+    , _server(*this)
+  {
+    _serverThread = std::thread([this]()
+    {
+      _server.Begin(asio::ip::address_v4::loopback(), 0);
+    });
+    _directorThread = std::thread([this]()
+    {
+      DirectorLoop();
+    });
+
+    while (_server.GetPort() == 0)
+      std::this_thread::yield();
+
+    for (size_t idx = 0; idx < BotCount; ++idx)
+    {
+      auto& bot = _bots.emplace_back(_ioContext);
+      bot.open(asio::ip::tcp::v4());
+      bot.bind({asio::ip::address_v4((127u << 24) | (botNetwork << 8) | (idx + 1)), 0});
+      bot.connect({asio::ip::address_v4::loopback(), _server.GetPort()});
+      bot.set_option(asio::ip::tcp::no_delay(true));
+    }
+
+    std::unique_lock lock(_mutex);
+    _condition.wait(lock, [this](){ return _clients.size() == BotCount; });
+  }
+
+  ~Relay() override
+  {
+    {
+      std::scoped_lock lock(_mutex);
+      _shouldRun = false;
+    }
+    _condition.notify_all();
+    _directorThread.join();
+
+    _bots.clear();
+    _server.End();
+    _serverThread.join();
+  }
+
+  void HandleNetworkTick() override
+  {
+  }
+
+  void OnClientConnected(const network::ClientId clientId) override
+  {
+    {
+      std::scoped_lock lock(_mutex);
+      _clients.emplace_back(clientId);
+    }
+    _condition.notify_all();
+  }
+
+  void OnClientDisconnected(network::ClientId) override
+  {
+  }
+
+  size_t OnClientData(const network::ClientId clientId, const std::span<const std::byte>& data) override
+  {
+    const size_t messageCount = data.size() / MessageSize;
+    {
+      std::scoped_lock lock(_mutex);
+      for (size_t idx = 0; idx < messageCount; ++idx)
+        _pendingMessages.emplace_back(clientId);
+    }
+    _condition.notify_all();
+
+    return messageCount * MessageSize;
+  }
+
+  [[nodiscard]] std::vector<asio::ip::tcp::socket>& GetBots()
+  {
+    return _bots;
+  }
+
+  [[nodiscard]] network::Server& GetServer()
+  {
+    return _server;
+  }
+
+private:
+  //! Ticks the director whenever there are messages to relay.
+  void DirectorLoop()
+  {
+    std::vector<network::ClientId> messages;
+    while (true)
+    {
+      std::vector<network::ClientId> clients;
+      {
+        std::unique_lock lock(_mutex);
+        _condition.wait(lock, [this](){ return not _shouldRun or not _pendingMessages.empty(); });
+        if (not _shouldRun)
+          return;
+
+        messages.swap(_pendingMessages);
+        clients = _clients;
+      }
+
+      {
+        std::optional<network::WriteCork> cork;
+        if (_isCorked)
+          cork.emplace();
+
+        for (const auto senderId : messages)
+        {
+          for (const auto clientId : clients)
+          {
+            if (clientId == senderId)
+              continue;
+            for (size_t frame = 0; frame < FramesPerRelay; ++frame)
+              QueueFrame(_server, clientId);
+          }
+        }
+      }
+
+      messages.clear();
+    }
+  }
+
+  bool _isCorked;
+
+  std::mutex _mutex;
+  std::condition_variable _condition;
+  bool _shouldRun{true};
+  //! IDs of the connected bots on the server.
+  std::vector<network::ClientId> _clients;
+  //! Senders of the messages to relay.
+  std::vector<network::ClientId> _pendingMessages;
+
+  network::Server _server;
+  std::thread _serverThread;
+  std::thread _directorThread;
+
+  asio::io_context _ioContext;
+  std::vector<asio::ip::tcp::socket> _bots;
+};
+
+//! Relays a message of a bot to the other bots.
+//! Reports the 99th percentile of the time until all the bots received the relay,
+//! and the count of the writes per bot and message. On the loopback every write
+//! leaves as a single segment, so the writes are the packets the bots receive.
+//! @param state State of the benchmark.
+//! @param relay Relay to measure.
+void RelayMessages(State& state, Relay& relay)
+{
+  auto& bots = relay.GetBots();
+  auto& server = relay.GetServer();
+
+  const std::vector<std::byte> message(MessageSize, std::byte{0x2A});
+  std::vector<std::byte> frames(MessageSize * FramesPerRelay);
+
+  std::vector<State::Clock::duration> latencies;
+  latencies.reserve(state.GetIterations());
+
+  // The statistics of the server are updated every network tick.
+  const auto waitForStatistics = [&server](const uint64_t outboundFrames)
+  {
+    const auto deadline = State::Clock::now() + std::chrono::seconds(3);
+    auto statistics = server.GetStatistics().total;
+    while (statistics.outboundFrames < outboundFrames && State::Clock::now() < deadline)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      statistics = server.GetStatistics().total;
+    }
+    return statistics;
+  };
+
+  state.PauseTiming();
+  const auto statisticsBefore = waitForStatistics(0);
+  state.ResumeTiming();
+
+  for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+  {
+    const auto sentAt = State::Clock::now();
+    asio::write(bots.front(), asio::buffer(message));
+
+    for (size_t idx = 1; idx < bots.size(); ++idx)
+      asio::read(bots[idx], asio::buffer(frames));
+
+    latencies.emplace_back(State::Clock::now() - sentAt);
+  }
+
+  state.PauseTiming();
+  const uint64_t relayCount = state.GetIterations() * (BotCount - 1);
+  const auto statisticsAfter = waitForStatistics(
+    statisticsBefore.outboundFrames + relayCount * FramesPerRelay);
+  state.ResumeTiming();
+
+  std::ranges::sort(latencies);
+  const auto p99 = latencies[std::min(latencies.size() - 1, latencies.size() * 99 / 100)];
+
+  state.SetItemsPerIteration(BotCount - 1);
+  state.SetCounter(
+    "p99_relay_us",
+    std::chrono::duration<double, std::micro>(p99).count());
+  state.SetCounter(
+    "writes_per_relay",
+    static_cast<double>(statisticsAfter.outboundWrites - statisticsBefore.outboundWrites)
+      / static_cast<double>(relayCount));
+}
+
+//! A server on the loopback consuming the frames of a fixed size, like a director
+//! handling the commands. Kept for all the repetitions, as the server throttles
+//! the connections per address.
+class Sink final
+  : public network::EventHandlerInterface
+{
+public:
+  //! Constructor.
+  //! @param frameSize Size of the frames.
+  //! @param isAcknowledging Whether every frame is acknowledged with a byte.
+  //! @param maxClientCount Maximum count of the connected clients.
+  Sink(const size_t frameSize, const bool isAcknowledging, const size_t maxClientCount)
+    : _frameSize(frameSize)
+    , _isAcknowledging(isAcknowledging)
+    , _server(*this, maxClientCount)
+  {
+    _serverThread = std::thread([this]()
+    {
+      _server.Begin(asio::ip::address_v4::loopback(), 0);
+    });
+
+    while (_server.GetPort() == 0)
+      std::this_thread::yield();
+  }
+
+  ~Sink() override
+  {
+    _clients.clear();
+    _server.End();
+    _serverThread.join();
+  }
+
+  void HandleNetworkTick() override
+  {
+  }
+
+  void OnClientConnected(network::ClientId) override
+  {
+  }
+
+  void OnClientDisconnected(network::ClientId) override
+  {
+  }
+
+  size_t OnClientData(const network::ClientId clientId, const std::span<const std::byte>& data) override
+  {
+    const size_t frameCount = data.size() / _frameSize;
+    if (frameCount == 0)
+      return 0;
+
+    if (_isAcknowledging)
+    {
+      _server.QueueWrite(clientId, [frameCount](asio::streambuf& buffer)
+      {
+        std::memset(buffer.prepare(frameCount).data(), 0x2A, frameCount);
+        buffer.commit(frameCount);
+        return frameCount;
+      });
+    }
+
+    _frameCount.fetch_add(frameCount, std::memory_order::release);
+    return frameCount * _frameSize;
+  }
+
+  //! Connects a client.
+  //! @param address Loopback address the client connects from.
+  //! @returns Client socket.
+  asio::ip::tcp::socket& Connect(const asio::ip::address_v4& address)
+  {
+    auto& client = _clients.emplace_back(_ioContext);
+    client.open(asio::ip::tcp::v4());
+    client.bind({address, 0});
+    client.connect({asio::ip::address_v4::loopback(), _server.GetPort()});
+    client.set_option(asio::ip::tcp::no_delay(true));
+    return client;
+  }
+
+  [[nodiscard]] std::vector<asio::ip::tcp::socket>& GetClients()
+  {
+    return _clients;
+  }
+
+  [[nodiscard]] uint64_t GetFrameCount() const
+  {
+    return _frameCount.load(std::memory_order::acquire);
+  }
+
+  [[nodiscard]] network::Server& GetServer()
+  {
+    return _server;
+  }
+
+  [[nodiscard]] const SyscallCounter& GetSyscallCounter() const
+  {
+    return _syscallCounter;
+  }
+
+private:
+  size_t _frameSize;
+  bool _isAcknowledging;
+  std::atomic<uint64_t> _frameCount{0};
+
+  //! Created before the server thread, so that its system calls are counted.
+  SyscallCounter _syscallCounter;
+
+  network::Server _server;
+  std::thread _serverThread;
+
+  asio::io_context _ioContext;
+  std::vector<asio::ip::tcp::socket> _clients;
+};
+
+//! Returns the inbound statistics of a server once they include a count of the frames.
+//! The statistics of the server are updated every network tick.
+network::ClientStatistics WaitForInboundStatistics(
+  network::Server& server,
+  const uint64_t inboundBytes)
+{
+  const auto deadline = State::Clock::now() + std::chrono::seconds(3);
+  auto statistics = server.GetStatistics().total;
+  while (statistics.inboundBytes < inboundBytes && State::Clock::now() < deadline)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    statistics = server.GetStatistics().total;
+  }
+  return statistics;
+}
+
+//! Sends the frames of the ingest size, each acknowledged by the server.
+//! Reports the reads and, if available, the system calls of the server per inbound KiB.
+void Ingest(State& state)
+{
+  state.PauseTiming();
+  static Sink sink(IngestFrameSize, true, network::Server::DefaultMaxClientCount);
+  static auto& client = sink.Connect(asio::ip::address_v4((127u << 24) | (3u << 8) | 1u));
+
+  const std::vector<std::byte> frame(IngestFrameSize, std::byte{0x2A});
+  std::byte acknowledgement{};
+
+  const auto statisticsBefore = WaitForInboundStatistics(sink.GetServer(), 0);
+  const auto syscallsBefore = sink.GetSyscallCounter().Read();
+  state.ResumeTiming();
+
+  for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+  {
+    asio::write(client, asio::buffer(frame));
+    asio::read(client, asio::buffer(&acknowledgement, 1));
+  }
+
+  state.PauseTiming();
+  const auto syscallsAfter = sink.GetSyscallCounter().Read();
+  const auto statisticsAfter = WaitForInboundStatistics(
+    sink.GetServer(),
+    statisticsBefore.inboundBytes + state.GetIterations() * IngestFrameSize);
+  state.ResumeTiming();
+
+  const double inboundKiB = static_cast<double>(state.GetIterations() * IngestFrameSize) / 1024.0;
+
+  state.SetBytesPerIteration(IngestFrameSize);
+  state.SetCounter(
+    "reads_per_kib",
+    static_cast<double>(statisticsAfter.inboundReads - statisticsBefore.inboundReads) / inboundKiB);
+
+  // Include the system calls of both the server and the client.
+  if (syscallsBefore && syscallsAfter)
+  {
+    state.SetCounter(
+      "syscalls_per_kib",
+      static_cast<double>(*syscallsAfter - *syscallsBefore) / inboundKiB);
+  }
+}
+
+//! Sends a message from each of the many connected clients, which are idle in between.
+//! Reports the memory of the read buffers once the clients are idle.
+void Idle(State& state)
+{
+  state.PauseTiming();
+  static Sink sink(MessageSize, false, IdleClientCount + 1);
+  if (sink.GetClients().empty())
+  {
+    // The server admits three connections per address.
+    for (size_t idx = 0; idx < IdleClientCount; ++idx)
+    {
+      const auto addressIndex = static_cast<uint32_t>(idx / 3);
+      sink.Connect(asio::ip::address_v4((127u << 24) | (4u << 16) | (addressIndex + 1)));
+    }
+  }
+  state.ResumeTiming();
+
+  const std::vector<std::byte> message(MessageSize, std::byte{0x2A});
+  auto expectedFrameCount = sink.GetFrameCount();
+
+  for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+  {
+    for (auto& client : sink.GetClients())
+      asio::write(client, asio::buffer(message));
+
+    expectedFrameCount += IdleClientCount;
+    while (sink.GetFrameCount() < expectedFrameCount)
+      std::this_thread::yield();
+  }
+
+  const auto pool = network::GetReadBufferPoolStatistics();
+
+  state.SetItemsPerIteration(IdleClientCount);
+  state.SetCounter(
+    "read_buffer_kib",
+    static_cast<double>(pool.usedBytes) / 1024.0);
+  state.SetCounter(
+    "pool_resident_kib",
+    static_cast<double>(pool.residentBytes) / 1024.0);
+}
+
+} // anon namespace
+
+void RegisterNetworkBenchmarks(Registry& registry)
+{
+  // Compare builds with and without `ALICIA_IO_URING`, the backend is recorded
+  // in the context of the JSON results.
+  registry.Add(std::format("network/loopback/echo/{}", MessageSize), [](State& state)
+  {
+    Echo(state, 1);
+  });
+
+  registry.Add(std::format("network/loopback/burst/{}x{}", BurstSize, MessageSize), [](State& state)
+  {
+    Echo(state, BurstSize);
+  });
+
+  registry.Add(std::format("network/loopback/ingest/{}", IngestFrameSize), Ingest);
+  registry.Add(std::format("network/loopback/idle/{}", IdleClientCount), Idle);
+
+  // Compare the frames of a director tick flushed together with the frames written
+  // as they are queued.
+  registry.Add(std::format("network/loopback/relay/corked/{}x{}", BotCount, FramesPerRelay), [](State& state)
+  {
+    state.PauseTiming();
+    static Relay relay(true, 1);
+    state.ResumeTiming();
+    RelayMessages(state, relay);
+  });
+
+  registry.Add(std::format("network/loopback/relay/uncorked/{}x{}", BotCount, FramesPerRelay), [](State& state)
+  {
+    state.PauseTiming();
+    static Relay relay(false, 2);
+    state.ResumeTiming();
+    RelayMessages(state, relay);
+  });
+}
+
+} // namespace server::bench
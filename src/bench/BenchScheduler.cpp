@@ -0,0 +1,81 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "bench/Bench.hpp"
+
+#include <libserver/util/Scheduler.hpp>
+
+#include <format>
+
+namespace server::bench
+{
+
+namespace
+{
+
+//! Count of the tasks queued per iteration.
+constexpr uint32_t TaskCount = 1024;
+
+} // anon namespace
+
+void RegisterSchedulerBenchmarks(Registry& registry)
+{
+  registry.Add(std::format("scheduler/queue_tick/{}", TaskCount), [](State& state)
+  {
+    Scheduler scheduler;
+    uint64_t counter = 0;
+
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+    {
+      for (uint32_t idx = 0; idx < TaskCount; ++idx)
+      {
+        scheduler.Queue([&counter]()
+        {
+          ++counter;
+        });
+      }
+
+      // A tick executes a single due task.
+      for (uint32_t idx = 0; idx < TaskCount; ++idx)
+        scheduler.Tick();
+    }
+
+    DoNotOptimize(counter);
+    state.SetItemsPerIteration(TaskCount);
+  });
+
+  // Ticks with the tasks which are not due yet, like the timeouts of the rooms.
+  registry.Add(std::format("scheduler/tick/pending_{}", TaskCount), [](State& state)
+  {
+    Scheduler scheduler;
+    for (uint32_t idx = 0; idx < TaskCount; ++idx)
+    {
+      scheduler.Queue(
+        []()
+        {
+        },
+        Scheduler::Clock::now() + std::chrono::hours(1));
+    }
+
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+      scheduler.Tick();
+  });
+}
+
+} // namespace server::bench
@@ -0,0 +1,119 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "bench/Bench.hpp"
+
+#include <libserver/util/Stream.hpp>
+
+#include <array>
+#include <string>
+
+namespace server::bench
+{
+
+namespace
+{
+
+//! Size of the stream buffers, the maximum size of the command data.
+constexpr size_t BufferSize = 8192;
+//! Count of the values written or read per iteration.
+constexpr size_t ValueCount = BufferSize / sizeof(uint32_t);
+//! A string resembling a character introduction.
+const std::string String = "Racing through the forest every evening, add me!";
+//! Count of the strings written or read per iteration.
+constexpr size_t StringCount = 128;
+
+} // anon namespace
+
+void RegisterStreamBenchmarks(Registry& registry)
+{
+  registry.Add("stream/sink/write_u32", [](State& state)
+  {
+    std::array<std::byte, BufferSize> buffer{};
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+    {
+      SinkStream sink(buffer);
+      for (uint32_t value = 0; value < ValueCount; ++value)
+        sink.Write(value);
+      DoNotOptimize(buffer);
+    }
+
+    state.SetBytesPerIteration(BufferSize);
+    state.SetItemsPerIteration(ValueCount);
+  });
+
+  registry.Add("stream/sink/write_string", [](State& state)
+  {
+    std::array<std::byte, BufferSize> buffer{};
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+    {
+      SinkStream sink(buffer);
+      for (size_t idx = 0; idx < StringCount; ++idx)
+        sink.Write(String);
+      DoNotOptimize(buffer);
+    }
+
+    state.SetBytesPerIteration(StringCount * (String.size() + 1));
+    state.SetItemsPerIteration(StringCount);
+  });
+
+  registry.Add("stream/source/read_u32", [](State& state)
+  {
+    std::array<std::byte, BufferSize> buffer{};
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+    {
+      SourceStream source(buffer);
+      uint32_t sum = 0;
+      for (size_t idx = 0; idx < ValueCount; ++idx)
+      {
+        uint32_t value{};
+        source.Read(value);
+        sum += value;
+      }
+      DoNotOptimize(sum);
+    }
+
+    state.SetBytesPerIteration(BufferSize);
+    state.SetItemsPerIteration(ValueCount);
+  });
+
+  registry.Add("stream/source/read_string", [](State& state)
+  {
+    std::array<std::byte, BufferSize> buffer{};
+    SinkStream sink(buffer);
+    for (size_t idx = 0; idx < StringCount; ++idx)
+      sink.Write(String);
+
+    std::string value;
+    for (uint64_t iteration = 0; iteration < state.GetIterations(); ++iteration)
+    {
+      SourceStream source(buffer);
+      for (size_t idx = 0; idx < StringCount; ++idx)
+      {
+        source.Read(value);
+        DoNotOptimize(value);
+      }
+    }
+
+    state.SetBytesPerIteration(StringCount * (String.size() + 1));
+    state.SetItemsPerIteration(StringCount);
+  });
+}
+
+} // namespace server::bench
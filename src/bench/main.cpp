@@ -0,0 +1,390 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "bench/Bench.hpp"
+
+#include <libserver/network/Server.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <charconv>
+#include <cstdio>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <regex>
+#include <string_view>
+#include <unordered_map>
+
+//! Microbenchmarks of the protocol and data hot paths.
+//! The results are printed as a table, or written as JSON to compare them
+//! across commits, either by a script or with the `--baseline` option.
+
+namespace
+{
+
+namespace bench = server::bench;
+
+constexpr std::string_view Usage =
+  "Usage: alicia-bench [options]\n"
+  "Options:\n"
+  "  --list                   Lists the benchmarks and exits.\n"
+  "  --filter <regex>         Runs only the benchmarks whose names match the expression.\n"
+  "  --min-time <seconds>     Minimum time of a repetition. Defaults to 0.2.\n"
+  "  --repetitions <count>    Count of the repetitions, the median is reported. Defaults to 5.\n"
+  "  --format <table|json>    Format of the results. Defaults to `table`.\n"
+  "  --output <path>          File to write the results to instead of the standard output.\n"
+  "  --label <label>          Label of the results, e.g. the commit, recorded in the JSON.\n"
+  "  --baseline <path>        JSON results to compare the results with.\n"
+  "  --max-regression <%>     Fails if a benchmark is slower than the baseline by more\n"
+  "                           than the percentage.\n";
+
+//! Options of the benchmarks.
+struct Options
+{
+  bool list{false};
+  std::optional<std::regex> filter;
+  bench::RunOptions run;
+  bool json{false};
+  std::string output;
+  std::string label;
+  std::string baseline;
+  std::optional<double> maxRegression;
+};
+
+template <typename T>
+bool ParseNumber(const std::string_view value, T& number)
+{
+  const auto result = std::from_chars(value.data(), value.data() + value.size(), number);
+  return result.ec == std::errc{} && result.ptr == value.data() + value.size();
+}
+
+std::optional<Options> ParseOptions(const int argc, char** argv)
+{
+  Options options;
+
+  for (int idx = 1; idx < argc; ++idx)
+  {
+    const std::string_view argument = argv[idx];
+    if (argument == "--list")
+    {
+      options.list = true;
+      continue;
+    }
+
+    if (idx + 1 >= argc)
+      return std::nullopt;
+    const std::string_view value = argv[++idx];
+
+    if (argument == "--filter")
+    {
+      try
+      {
+        options.filter.emplace(std::string(value));
+      }
+      catch (const std::regex_error&)
+      {
+        return std::nullopt;
+      }
+    }
+    else if (argument == "--min-time")
+    {
+      double minTime{};
+      if (not ParseNumber(value, minTime) || minTime <= 0.0)
+        return std::nullopt;
+      options.run.minTime = std::chrono::duration<double>(minTime);
+    }
+    else if (argument == "--repetitions")
+    {
+      if (not ParseNumber(value, options.run.repetitions) || options.run.repetitions == 0)
+        return std::nullopt;
+    }
+    else if (argument == "--format")
+    {
+      if (value != "table" && value != "json")
+        return std::nullopt;
+      options.json = value == "json";
+    }
+    else if (argument == "--output")
+    {
+      options.output = value;
+    }
+    else if (argument == "--label")
+    {
+      options.label = value;
+    }
+    else if (argument == "--baseline")
+    {
+      options.baseline = value;
+    }
+    else if (argument == "--max-regression")
+    {
+      double maxRegression{};
+      if (not ParseNumber(value, maxRegression) || maxRegression < 0.0)
+        return std::nullopt;
+      options.maxRegression = maxRegression;
+    }
+    else
+    {
+      return std::nullopt;
+    }
+  }
+
+  if (options.maxRegression && options.baseline.empty())
+    return std::nullopt;
+
+  return options;
+}
+
+//! Reads the times per iteration of the benchmarks from JSON results.
+//! @param path Path to the results.
+//! @returns Times per iteration in nanoseconds by the benchmark names.
+//! @throw std::runtime_error If the results can't be read.
+std::unordered_map<std::string, double> ReadBaseline(const std::string& path)
+{
+  std::ifstream file(path);
+  if (not file.is_open())
+    throw std::runtime_error(std::format("Couldn't open the baseline '{}'", path));
+
+  std::unordered_map<std::string, double> baseline;
+  try
+  {
+    const auto json = nlohmann::json::parse(file);
+    for (const auto& benchmark : json.at("benchmarks"))
+    {
+      baseline.emplace(
+        benchmark.at("name").get<std::string>(),
+        benchmark.at("ns_per_iteration").get<double>());
+    }
+  }
+  catch (const nlohmann::json::exception& x)
+  {
+    throw std::runtime_error(std::format("Malformed baseline '{}': {}", path, x.what()));
+  }
+
+  return baseline;
+}
+
+std::string FormatRate(const double rate, const std::string_view unit)
+{
+  if (rate <= 0.0)
+    return "";
+  if (rate >= 1e9)
+    return std::format("{:.2f}G{}/s", rate / 1e9, unit);
+  if (rate >= 1e6)
+    return std::format("{:.2f}M{}/s", rate / 1e6, unit);
+  if (rate >= 1e3)
+    return std::format("{:.2f}k{}/s", rate / 1e3, unit);
+  return std::format("{:.2f}{}/s", rate, unit);
+}
+
+std::string FormatTable(
+  const std::vector<bench::Result>& results,
+  const std::unordered_map<std::string, double>& changes)
+{
+  std::string table = std::format(
+    "{:<44} {:>14} {:>12} {:>12} {:>14} {:>14}{}\n",
+    "Benchmark",
+    "Time",
+    "Min",
+    "Iterations",
+    "Bytes",
+    "Items",
+    changes.empty() ? "" : "     Change");
+
+  for (const auto& result : results)
+  {
+    table += std::format(
+      "{:<44} {:>11.2f} ns {:>9.2f} ns {:>12} {:>14} {:>14}",
+      result.name,
+      result.nsPerIteration,
+      result.minNsPerIteration,
+      result.iterations,
+      FormatRate(result.bytesPerSecond, "B"),
+      FormatRate(result.itemsPerSecond, ""));
+
+    if (const auto changeIter = changes.find(result.name); changeIter != changes.cend())
+      table += std::format(" {:>+9.1f}%", changeIter->second);
+    for (const auto& [name, value] : result.counters)
+      table += std::format(" {}={:.2f}", name, value);
+    table += '\n';
+  }
+
+  return table;
+}
+
+std::string FormatJson(const std::vector<bench::Result>& results, const Options& options)
+{
+  // Ordered, so the name of a benchmark comes first.
+  nlohmann::ordered_json json;
+
+  auto& context = json["context"];
+  context["date"] = std::format(
+    "{:%FT%TZ}",
+    std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now()));
+  context["label"] = options.label;
+#if defined(__clang__)
+  context["compiler"] = std::format("clang {}", __clang_version__);
+#elif defined(__GNUC__)
+  context["compiler"] = std::format("gcc {}", __VERSION__);
+#elif defined(_MSC_VER)
+  context["compiler"] = std::format("msvc {}", _MSC_VER);
+#endif
+#ifdef NDEBUG
+  context["build"] = "release";
+#else
+  context["build"] = "debug";
+#endif
+  context["io_backend"] = server::network::GetIoBackendName();
+  context["min_time"] = options.run.minTime.count();
+  context["repetitions"] = options.run.repetitions;
+
+  auto& benchmarks = json["benchmarks"];
+  benchmarks = nlohmann::ordered_json::array();
+  for (const auto& result : results)
+  {
+    benchmarks.push_back({
+      {"name", result.name},
+      {"iterations", result.iterations},
+      {"repetitions", result.repetitions},
+      {"ns_per_iteration", result.nsPerIteration},
+      {"min_ns_per_iteration", result.minNsPerIteration},
+      {"max_ns_per_iteration", result.maxNsPerIteration},
+      {"bytes_per_second", result.bytesPerSecond},
+      {"items_per_second", result.itemsPerSecond}});
+
+    if (not result.counters.empty())
+      benchmarks.back()["counters"] = result.counters;
+  }
+
+  return json.dump(2) + '\n';
+}
+
+} // anon namespace
+
+int main(int argc, char** argv)
+{
+  const auto options = ParseOptions(argc, argv);
+  if (not options)
+  {
+    std::fputs(Usage.data(), stderr);
+    return 1;
+  }
+
+  bench::Registry registry;
+  bench::RegisterStreamBenchmarks(registry);
+  bench::RegisterCodecBenchmarks(registry);
+  bench::RegisterMessageBenchmarks(registry);
+  bench::RegisterDataStorageBenchmarks(registry);
+  bench::RegisterSchedulerBenchmarks(registry);
+  bench::RegisterLocaleBenchmarks(registry);
+  bench::RegisterFileDataSourceBenchmarks(registry);
+  bench::RegisterIdTableBenchmarks(registry);
+  bench::RegisterNetworkBenchmarks(registry);
+  bench::RegisterClientRegistryBenchmarks(registry);
+  bench::RegisterLoggingBenchmarks(registry);
+
+  std::vector<const bench::Registry::Benchmark*> benchmarks;
+  for (const auto& benchmark : registry.GetBenchmarks())
+  {
+    if (options->filter && not std::regex_search(benchmark.name, *options->filter))
+      continue;
+    benchmarks.emplace_back(&benchmark);
+  }
+
+  if (options->list)
+  {
+    for (const auto* benchmark : benchmarks)
+      std::printf("%s\n", benchmark->name.c_str());
+    return 0;
+  }
+
+  std::unordered_map<std::string, double> baseline;
+  try
+  {
+    if (not options->baseline.empty())
+      baseline = ReadBaseline(options->baseline);
+  }
+  catch (const std::exception& x)
+  {
+    std::fprintf(stderr, "%s\n", x.what());
+    return 1;
+  }
+
+  std::vector<bench::Result> results;
+  std::unordered_map<std::string, double> changes;
+  bool hasRegressed = false;
+
+  for (const auto* benchmark : benchmarks)
+  {
+    // Progress goes to the standard error, so the results may be piped.
+    std::fprintf(stderr, "Running %s\n", benchmark->name.c_str());
+
+    try
+    {
+      auto& result = results.emplace_back(bench::Run(*benchmark, options->run));
+
+      const auto baselineIter = baseline.find(result.name);
+      if (baselineIter == baseline.cend() || baselineIter->second <= 0.0)
+        continue;
+
+      const auto change = (result.nsPerIteration / baselineIter->second - 1.0) * 100.0;
+      changes.emplace(result.name, change);
+
+      if (options->maxRegression && change > *options->maxRegression)
+      {
+        hasRegressed = true;
+        std::fprintf(
+          stderr,
+          "Regression of %s: %.2f ns -> %.2f ns (%+.1f%%)\n",
+          result.name.c_str(),
+          baselineIter->second,
+          result.nsPerIteration,
+          change);
+      }
+    }
+    catch (const std::exception& x)
+    {
+      std::fprintf(stderr, "Benchmark %s failed: %s\n", benchmark->name.c_str(), x.what());
+      return 1;
+    }
+  }
+
+  const auto output = options->json
+    ? FormatJson(results, *options)
+    : FormatTable(results, changes);
+
+  if (options->output.empty())
+  {
+    std::fputs(output.c_str(), stdout);
+  }
+  else
+  {
+    std::ofstream file(options->output);
+    if (not file.is_open())
+    {
+      std::fprintf(stderr, "Couldn't open the output '%s'\n", options->output.c_str());
+      return 1;
+    }
+    file << output;
+  }
+
+  return hasRegressed ? 2 : 0;
+}
@@ -27,6 +27,16 @@
 namespace server
 {
 
+namespace
+{
+
+//! Policy of the storages of the read-mostly data read by many threads,
+//! such as the characters, horses and guilds of the ranch visitors.
+const DataStoragePolicy SharedDataPolicy{
+  .snapshotReads = true};
+
+} // anon namespace
+
 DataDirector::DataDirector(const std::filesystem::path& basePath)
   : _userStorage(
       [&](const auto& key, auto& user)
@@ -34,7 +44,11 @@ DataDirector::DataDirector(const std::filesystem::path& basePath)
         try
         {
           _primaryDataSource->RetrieveUser(key, user);
-          return true;
+          return RetrieveResult::Retrieved;
+        }
+        catch (const RecordNotFoundError&)
+        {
+          return RetrieveResult::Absent;
         }
         catch (const std::exception& x)
         {
@@ -44,7 +58,7 @@ DataDirector::DataDirector(const std::filesystem::path& basePath)
             x.what());
         }
 
-        return false;
+        return RetrieveResult::Failed;
       },
       [&](const auto& key, auto& user)
       {
@@ -65,14 +79,19 @@ DataDirector::DataDirector(const std::filesystem::path& basePath)
       {
         spdlog::error("Invalid delete operation on user '{}' from the primary data source", key);
         return false;
-      })
+      },
+      "user")
   , _infractionStorage(
     [&](const auto& key, auto& infraction)
     {
       try
       {
         _primaryDataSource->RetrieveInfraction(key, infraction);
-        return true;
+        return RetrieveResult::Retrieved;
+      }
+      catch (const RecordNotFoundError&)
+      {
+        return RetrieveResult::Absent;
       }
       catch (const std::exception& x)
       {
@@ -80,7 +99,7 @@ DataDirector::DataDirector(const std::filesystem::path& basePath)
           "Exception retrieving infraction {} from the primary data source: {}", key, x.what());
       }
 
-      return false;
+      return RetrieveResult::Failed;
     },
     [&](const auto& key, auto& infraction)
     {
@@ -110,14 +129,19 @@ DataDirector::DataDirector(const std::filesystem::path& basePath)
           "Exception deleting infraction {} from the primary data source: {}", key, x.what());
       }
       return false;
-    })
+    },
+    "infraction")
   , _characterStorage(
       [&](const auto& key, auto& character)
       {
         try
         {
           _primaryDataSource->RetrieveCharacter(key, character);
-          return true;
+          return RetrieveResult::Retrieved;
+        }
+        catch (const RecordNotFoundError&)
+        {
+          return RetrieveResult::Absent;
         }
         catch (const std::exception& x)
         {
@@ -125,7 +149,7 @@ DataDirector::DataDirector(const std::filesystem::path& basePath)
             "Exception retrieving character {} from the primary data source: {}", key, x.what());
         }
 
-        return false;
+        return RetrieveResult::Failed;
       },
       [&](const auto& key, auto& character)
       {
@@ -155,14 +179,20 @@ DataDirector::DataDirector(const std::filesystem::path& basePath)
             "Exception deleting character {} from the primary data source: {}", key, x.what());
         }
         return false;
-      })
+      },
+      "character",
+      SharedDataPolicy)
   , _horseStorage(
       [&](const auto& key, auto& horse)
       {
         try
         {
           _primaryDataSource->RetrieveHorse(key, horse);
-          return true;
+          return RetrieveResult::Retrieved;
+        }
+        catch (const RecordNotFoundError&)
+        {
+          return RetrieveResult::Absent;
         }
         catch (const std::exception& x)
         {
@@ -170,7 +200,7 @@ DataDirector::DataDirector(const std::filesystem::path& basePath)
             "Exception retrieving horse {} from the primary data source: {}", key, x.what());
         }
 
-        return false;
+        return RetrieveResult::Failed;
       },
       [&](const auto& key, auto& horse)
       {
@@ -200,14 +230,20 @@ DataDirector::DataDirector(const std::filesystem::path& basePath)
             "Exception deleting horse {} from the primary data source: {}", key, x.what());
         }
         return false;
-      })
+      },
+      "horse",
+      SharedDataPolicy)
   , _itemStorage(
       [&](const auto& key, auto& item)
       {
         try
         {
           _primaryDataSource->RetrieveItem(key, item);
-          return true;
+          return RetrieveResult::Retrieved;
+        }
+        catch (const RecordNotFoundError&)
+        {
+          return RetrieveResult::Absent;
         }
         catch (const std::exception& x)
         {
@@ -215,7 +251,7 @@ DataDirector::DataDirector(const std::filesystem::path& basePath)
             "Exception retrieving item {} from the primary data source: {}", key, x.what());
         }
 
-        return false;
+        return RetrieveResult::Failed;
       },
       [&](const auto& key, auto& item)
       {
@@ -245,14 +281,19 @@ DataDirector::DataDirector(const std::filesystem::path& basePath)
             "Exception deleting item {} from the primary data source: {}", key, x.what());
         }
         return false;
-      })
+      },
+      "item")
   , _storageItemStorage(
       [&](const auto& key, auto& storedItem)
       {
         try
         {
           _primaryDataSource->RetrieveStorageItem(key, storedItem);
-          return true;
+          return RetrieveResult::Retrieved;
+        }
+        catch (const RecordNotFoundError&)
+        {
+          return RetrieveResult::Absent;
         }
         catch (const std::exception& x)
         {
@@ -260,7 +301,7 @@ DataDirector::DataDirector(const std::filesystem::path& basePath)
             "Exception retrieving storage item {} from the primary data source: {}", key, x.what());
         }
 
-        return false;
+        return RetrieveResult::Failed;
       },
       [&](const auto& key, auto& storedItem)
       {
@@ -290,14 +331,19 @@ DataDirector::DataDirector(const std::filesystem::path& basePath)
             "Exception deleting storage item {} from the primary data source: {}", key, x.what());
         }
         return false;
-      })
+      },
+      "storage_item")
   , _eggStorage(
       [&](const auto& key, auto& egg)
       {
         try
         {
           _primaryDataSource->RetrieveEgg(key, egg);
-          return true;
+          return RetrieveResult::Retrieved;
+        }
+        catch (const RecordNotFoundError&)
+        {
+          return RetrieveResult::Absent;
         }
         catch (const std::exception& x)
         {
@@ -305,7 +351,7 @@ DataDirector::DataDirector(const std::filesystem::path& basePath)
             "Exception retrieving egg {} from the primary data source: {}", key, x.what());
         }
 
-        return false;
+        return RetrieveResult::Failed;
       },
       [&](const auto& key, auto& egg)
       {
@@ -335,14 +381,19 @@ DataDirector::DataDirector(const std::filesystem::path& basePath)
             "Exception deleting egg {} from the primary data source: {}", key, x.what());
         }
         return false;
-      })
+      },
+      "egg")
   , _petStorage(
       [&](const auto& key, auto& pet)
       {
         try
         {
           _primaryDataSource->RetrievePet(key, pet);
-          return true;
+          return RetrieveResult::Retrieved;
+        }
+        catch (const RecordNotFoundError&)
+        {
+          return RetrieveResult::Absent;
         }
         catch (const std::exception& x)
         {
@@ -350,7 +401,7 @@ DataDirector::DataDirector(const std::filesystem::path& basePath)
             "Exception retrieving pet {} from the primary data source: {}", key, x.what());
         }
 
-        return false;
+        return RetrieveResult::Failed;
       },
       [&](const auto& key, auto& pet)
       {
@@ -380,14 +431,19 @@ DataDirector::DataDirector(const std::filesystem::path& basePath)
             "Exception deleting pet {} from the primary data source: {}", key, x.what());
         }
         return false;
-      })
+      },
+      "pet")
   , _housingStorage(
       [&](const auto& key, auto& housing)
       {
         try
         {
           _primaryDataSource->RetrieveHousing(key, housing);
-          return true;
+          return RetrieveResult::Retrieved;
+        }
+        catch (const RecordNotFoundError&)
+        {
+          return RetrieveResult::Absent;
         }
         catch (const std::exception& x)
         {
@@ -395,7 +451,7 @@ DataDirector::DataDirector(const std::filesystem::path& basePath)
             "Exception retrieving housing {} from the primary data source: {}", key, x.what());
         }
 
-        return false;
+        return RetrieveResult::Failed;
       },
       [&](const auto& key, auto& housing)
       {
@@ -425,14 +481,19 @@ DataDirector::DataDirector(const std::filesystem::path& basePath)
             "Exception deleting housing {} from the primary data source: {}", key, x.what());
         }
         return false;
-      })
+      },
+      "housing")
   , _guildStorage(
      [&](const auto& key, auto& guild)
      {
        try
        {
          _primaryDataSource->RetrieveGuild(key, guild);
-         return true;
+         return RetrieveResult::Retrieved;
+       }
+       catch (const RecordNotFoundError&)
+       {
+         return RetrieveResult::Absent;
        }
        catch (const std::exception& x)
        {
@@ -440,7 +501,7 @@ DataDirector::DataDirector(const std::filesystem::path& basePath)
            "Exception retrieving guild {} from the primary data source: {}", key, x.what());
        }
 
-       return false;
+       return RetrieveResult::Failed;
      },
      [&](const auto& key, auto& guild)
      {
@@ -470,21 +531,27 @@ DataDirector::DataDirector(const std::filesystem::path& basePath)
             "Exception deleting guild {} from the primary data source: {}", key, x.what());
         }
         return false;
-      })
+      },
+      "guild",
+      SharedDataPolicy)
   , _settingsStorage(
       [&](const auto& key, auto& settings)
       {
         try
         {
           _primaryDataSource->RetrieveSettings(key, settings);
-          return true;
+          return RetrieveResult::Retrieved;
+        }
+        catch (const RecordNotFoundError&)
+        {
+          return RetrieveResult::Absent;
         }
         catch (const std::exception& x)
         {
           spdlog::error(
             "Exception retrieving settings {} from the primary data source: {}", key, x.what());
         }
-        return false;
+        return RetrieveResult::Failed;
       },
       [&](const auto& key, auto& settings)
       {
@@ -513,14 +580,19 @@ DataDirector::DataDirector(const std::filesystem::path& basePath)
             "Exception deleting settings {} from the primary data source: {}", key, x.what());
         }
         return false;
-      })
+      },
+      "settings")
   , _dailyQuestStorage(
       [&](const auto& key, auto& quest)
       {
         try
         {
           _primaryDataSource->RetrieveDailyQuest(key, quest);
-          return true;
+          return RetrieveResult::Retrieved;
+        }
+        catch (const RecordNotFoundError&)
+        {
+          return RetrieveResult::Absent;
         }
         catch (const std::exception& x)
         {
@@ -528,7 +600,7 @@ DataDirector::DataDirector(const std::filesystem::path& basePath)
             "Exception retrieving daily quest {} from the primary data source: {}", key, x.what());
         }
 
-        return false;
+        return RetrieveResult::Failed;
       },
       [&](const auto& key, auto& quest)
       {
@@ -557,21 +629,26 @@ DataDirector::DataDirector(const std::filesystem::path& basePath)
             "Exception deleting daily quest {} from the primary data source: {}", key, x.what());
            }
         return false;
-      })
+      },
+      "daily_quest")
   , _mailStorage(
       [&](const auto& key, auto& mail)
       {
         try
         {
           _primaryDataSource->RetrieveMail(key, mail);
-          return true;
+          return RetrieveResult::Retrieved;
+        }
+        catch (const RecordNotFoundError&)
+        {
+          return RetrieveResult::Absent;
         }
         catch (const std::exception& x)
         {
           spdlog::error(
             "Exception retrieving mail {} from the primary data source: {}", key, x.what());
         }
-        return false;
+        return RetrieveResult::Failed;
       },
       [&](const auto& key, auto& mail)
       {
@@ -600,7 +677,8 @@ DataDirector::DataDirector(const std::filesystem::path& basePath)
             "Exception deleting mail {} from the primary data source: {}", key, x.what());
         }
         return false;
-      })
+      },
+      "mail")
 {
   _primaryDataSource = std::make_unique<FileDataSource>();
   if (auto* fileDataSource = dynamic_cast<FileDataSource*>(_primaryDataSource.get()))
@@ -1113,6 +1191,49 @@ DataSource& DataDirector::GetDataSource() noexcept
   return *_primaryDataSource;
 }
 
+Scheduler& DataDirector::GetScheduler() noexcept
+{
+  return _scheduler;
+}
+
+util::MemoryUsageReport DataDirector::GetMemoryUsage() const
+{
+  util::MemoryUsageReport report;
+
+  const auto addStorage = [&report](const std::string_view storageName, const auto& storage)
+  {
+    report.emplace_back(std::format("storage.{}", storageName), storage.GetMemoryUsage());
+  };
+
+  addStorage("user", _userStorage);
+  addStorage("infraction", _infractionStorage);
+  addStorage("character", _characterStorage);
+  addStorage("horse", _horseStorage);
+  addStorage("item", _itemStorage);
+  addStorage("storage_item", _storageItemStorage);
+  addStorage("egg", _eggStorage);
+  addStorage("pet", _petStorage);
+  addStorage("housing", _housingStorage);
+  addStorage("guild", _guildStorage);
+  addStorage("settings", _settingsStorage);
+  addStorage("daily_quest", _dailyQuestStorage);
+  addStorage("mail", _mailStorage);
+
+  util::MemoryUsage userDataContexts{
+    .count = _userDataContext.size(),
+    .bytes = util::EstimateContainerHeapSize(_userDataContext)};
+  for (const auto& [userName, userDataContext] : _userDataContext)
+  {
+    userDataContexts.bytes += util::EstimateHeapSize(userName)
+      + util::EstimateHeapSize(userDataContext.debugMessage);
+  }
+  report.emplace_back("user_data_contexts", userDataContexts);
+
+  report.emplace_back("scheduler", _scheduler.GetMemoryUsage());
+
+  return report;
+}
+
 void DataDirector::ScheduleUserLoad(
   UserDataContext& userDataContext,
   const std::string& userName)
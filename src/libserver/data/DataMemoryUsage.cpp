@@ -0,0 +1,124 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "libserver/data/DataMemoryUsage.hpp"
+
+namespace server::data
+{
+
+namespace
+{
+
+//! Sums the heap size estimates of the fields.
+std::size_t SumHeapSize(const auto&... fields) noexcept
+{
+  using dao::EstimateHeapSize;
+  return (EstimateHeapSize(fields) + ... + 0);
+}
+
+} // anon namespace
+
+std::size_t EstimateHeapSize(const User& user) noexcept
+{
+  return SumHeapSize(user.name, user.token, user.infractions);
+}
+
+std::size_t EstimateHeapSize(const Infraction& infraction) noexcept
+{
+  return SumHeapSize(infraction.description);
+}
+
+std::size_t EstimateHeapSize(const Item&) noexcept
+{
+  return 0;
+}
+
+std::size_t EstimateHeapSize(const Pet& pet) noexcept
+{
+  return SumHeapSize(pet.name);
+}
+
+std::size_t EstimateHeapSize(const StorageItem& storageItem) noexcept
+{
+  return SumHeapSize(storageItem.sender, storageItem.message, storageItem.items);
+}
+
+std::size_t EstimateHeapSize(const Guild& guild) noexcept
+{
+  return SumHeapSize(guild.name, guild.description, guild.officers, guild.members);
+}
+
+std::size_t EstimateHeapSize(const Settings& settings) noexcept
+{
+  return SumHeapSize(settings.keyboardBindings, settings.macros, settings.gamepadBindings);
+}
+
+std::size_t EstimateHeapSize(const Character::Contacts::Group& group) noexcept
+{
+  using util::EstimateHeapSize;
+  return EstimateHeapSize(group.name) + EstimateHeapSize(group.members);
+}
+
+std::size_t EstimateHeapSize(const Character& character) noexcept
+{
+  return SumHeapSize(
+    character.name,
+    character.introduction,
+    character.contacts.pending,
+    character.contacts.groups,
+    character.gifts,
+    character.purchases,
+    character.inventory,
+    character.characterEquipment,
+    character.expiredEquipment,
+    character.horses,
+    character.pets,
+    character.eggs,
+    character.housing,
+    character.dailyQuests,
+    character.mailbox.inbox,
+    character.mailbox.sent);
+}
+
+std::size_t EstimateHeapSize(const Horse& horse) noexcept
+{
+  return SumHeapSize(horse.name);
+}
+
+std::size_t EstimateHeapSize(const Housing&) noexcept
+{
+  return 0;
+}
+
+std::size_t EstimateHeapSize(const Egg&) noexcept
+{
+  return 0;
+}
+
+std::size_t EstimateHeapSize(const DailyQuest&) noexcept
+{
+  return 0;
+}
+
+std::size_t EstimateHeapSize(const Mail& mail) noexcept
+{
+  return SumHeapSize(mail.body);
+}
+
+} // namespace server::data
@@ -140,6 +140,12 @@ void server::FileDataSource::RetrieveUser(const std::string_view& name, data::Us
   const std::filesystem::path dataFilePath = ProduceDataFilePath(
     _userDataPath, user.name());
 
+  if (not std::filesystem::exists(dataFilePath))
+  {
+    throw RecordNotFoundError(
+      std::format("User file '{}' does not exist", dataFilePath.string()));
+  }
+
   std::ifstream dataFile(dataFilePath);
   if (not dataFile.is_open())
   {
@@ -202,6 +208,12 @@ void server::FileDataSource::RetrieveInfraction(data::Uid uid, data::Infraction&
   const std::filesystem::path dataFilePath = ProduceDataFilePath(
    _infractionDataPath, std::format("{}", uid));
 
+  if (not std::filesystem::exists(dataFilePath))
+  {
+    throw RecordNotFoundError(
+      std::format("Infraction file '{}' does not exist", dataFilePath.string()));
+  }
+
   std::ifstream dataFile(dataFilePath);
   if (not dataFile.is_open())
   {
@@ -260,6 +272,12 @@ void server::FileDataSource::RetrieveCharacter(data::Uid uid, data::Character& c
   const std::filesystem::path dataFilePath = ProduceDataFilePath(
     _characterDataPath, std::format("{}", uid));
 
+  if (not std::filesystem::exists(dataFilePath))
+  {
+    throw RecordNotFoundError(
+      std::format("Character file '{}' does not exist", dataFilePath.string()));
+  }
+
   std::ifstream dataFile(dataFilePath);
   if (not dataFile.is_open())
   {
@@ -526,6 +544,12 @@ void server::FileDataSource::RetrieveHorse(data::Uid uid, data::Horse& horse)
   const std::filesystem::path dataFilePath = ProduceDataFilePath(
     _horseDataPath, std::format("{}", uid));
 
+  if (not std::filesystem::exists(dataFilePath))
+  {
+    throw RecordNotFoundError(
+      std::format("Horse file '{}' does not exist", dataFilePath.string()));
+  }
+
   std::ifstream dataFile(dataFilePath);
   if (not dataFile.is_open())
   {
@@ -737,6 +761,12 @@ void server::FileDataSource::RetrieveItem(data::Uid uid, data::Item& item)
   const std::filesystem::path dataFilePath = ProduceDataFilePath(
     _itemDataPath, std::format("{}", uid));
 
+  if (not std::filesystem::exists(dataFilePath))
+  {
+    throw RecordNotFoundError(
+      std::format("Item file '{}' does not exist", dataFilePath.string()));
+  }
+
   std::ifstream dataFile(dataFilePath);
   if (not dataFile.is_open())
   {
@@ -795,6 +825,12 @@ void server::FileDataSource::RetrieveStorageItem(data::Uid uid, data::StorageIte
   const std::filesystem::path dataFilePath = ProduceDataFilePath(
     _storageItemPath, std::format("{}", uid));
 
+  if (not std::filesystem::exists(dataFilePath))
+  {
+    throw RecordNotFoundError(
+      std::format("Storage item file '{}' does not exist", dataFilePath.string()));
+  }
+
   std::ifstream dataFile(dataFilePath);
   if (not dataFile.is_open())
   {
@@ -888,6 +924,12 @@ void server::FileDataSource::RetrieveEgg(data::Uid uid, data::Egg& egg)
   const std::filesystem::path dataFilePath = ProduceDataFilePath(
     _eggDataPath, std::format("{}", uid));
 
+  if (not std::filesystem::exists(dataFilePath))
+  {
+    throw RecordNotFoundError(
+      std::format("Egg file '{}' does not exist", dataFilePath.string()));
+  }
+
   std::ifstream dataFile(dataFilePath);
   if (not dataFile.is_open())
   {
@@ -949,6 +991,12 @@ void server::FileDataSource::RetrievePet(data::Uid uid, data::Pet& pet)
   const std::filesystem::path dataFilePath = ProduceDataFilePath(
     _petDataPath, std::format("{}", uid));
 
+  if (not std::filesystem::exists(dataFilePath))
+  {
+    throw RecordNotFoundError(
+      std::format("Pet file '{}' does not exist", dataFilePath.string()));
+  }
+
   std::ifstream dataFile(dataFilePath);
   if (not dataFile.is_open())
   {
@@ -1007,6 +1055,12 @@ void server::FileDataSource::RetrieveHousing(data::Uid uid, data::Housing& housi
   const std::filesystem::path dataFilePath = ProduceDataFilePath(
     _housingDataPath, std::format("{}", uid));
 
+  if (not std::filesystem::exists(dataFilePath))
+  {
+    throw RecordNotFoundError(
+      std::format("Housing file '{}' does not exist", dataFilePath.string()));
+  }
+
   std::ifstream dataFile(dataFilePath);
   if (not dataFile.is_open())
   {
@@ -1062,6 +1116,12 @@ void server::FileDataSource::RetrieveGuild(data::Uid uid, data::Guild& guild)
   const std::filesystem::path dataFilePath = ProduceDataFilePath(
     _guildDataPath, std::format("{}", uid));
 
+  if (not std::filesystem::exists(dataFilePath))
+  {
+    throw RecordNotFoundError(
+      std::format("Guild file '{}' does not exist", dataFilePath.string()));
+  }
+
   std::ifstream dataFile(dataFilePath);
   if (not dataFile.is_open())
   {
@@ -1157,6 +1217,12 @@ void server::FileDataSource::RetrieveSettings(data::Uid uid, data::Settings& set
   const std::filesystem::path dataFilePath = ProduceDataFilePath(
     _settingsDataPath, std::format("{}", uid));
 
+  if (not std::filesystem::exists(dataFilePath))
+  {
+    throw RecordNotFoundError(
+      std::format("Settings file '{}' does not exist", dataFilePath.string()));
+  }
+
   std::ifstream dataFile(dataFilePath);
   if (!dataFile.is_open())
   {
@@ -1293,6 +1359,12 @@ void server::FileDataSource::RetrieveDailyQuest(data::Uid uid, data::DailyQuest&
   const std::filesystem::path dataFilePath = ProduceDataFilePath(
     _dailyQuestDataPath, std::format("{}", uid));
 
+  if (not std::filesystem::exists(dataFilePath))
+  {
+    throw RecordNotFoundError(
+      std::format("Daily quest file '{}' does not exist", dataFilePath.string()));
+  }
+
   std::ifstream dataFile(dataFilePath);
   if (not dataFile.is_open())
   {
@@ -1340,6 +1412,12 @@ void server::FileDataSource::RetrieveMail(data::Uid uid, data::Mail& mail)
   const std::filesystem::path dataFilePath = ProduceDataFilePath(
     _mailDataPath, std::format("{}", uid));
 
+  if (not std::filesystem::exists(dataFilePath))
+  {
+    throw RecordNotFoundError(
+      std::format("Mail file '{}' does not exist", dataFilePath.string()));
+  }
+
   std::ifstream dataFile(dataFilePath);
   if (!dataFile.is_open())
   {
@@ -4,12 +4,55 @@
 
 #include "libserver/data/helper/ProtocolHelper.hpp"
 
+#include <array>
+
 namespace server
 {
 
 namespace protocol
 {
 
+namespace
+{
+
+//! Maximum size of a single serialized structure.
+constexpr size_t MaxEncodedStructureSize = 4096;
+
+//! Serializes a structure.
+//! @param structure Structure to serialize.
+//! @param buffer Buffer to serialize the structure to.
+template <typename T>
+void EncodeStructure(const T& structure, std::vector<std::byte>& buffer)
+{
+  std::array<std::byte, MaxEncodedStructureSize> scratch{};
+  SinkStream sink(scratch);
+  sink.Write(structure);
+
+  buffer.assign(scratch.begin(), scratch.begin() + sink.GetCursor());
+}
+
+//! Appends the serialized forms of the records.
+//! @param structures Serialized structures to append to.
+//! @param records Records.
+//! @param encoder Encoder serializing the value of a record.
+template <typename Data, typename Encoder>
+void EncodeRecords(
+  EncodedStructures& structures,
+  const std::vector<Record<Data>>& records,
+  const Encoder& encoder)
+{
+  for (const auto& record : records)
+  {
+    const auto encoded = record.GetEncoded(encoder);
+    // Structures of a type are mostly of the same size.
+    if (structures.data.empty())
+      structures.data.reserve(encoded->size() * records.size());
+    structures.Append(*encoded);
+  }
+}
+
+} // anon namespace
+
 void BuildProtocolCharacter(
   Character& protocolCharacter,
   const data::Character& character)
@@ -171,6 +214,21 @@ void BuildProtocolHorses(
   }
 }
 
+void EncodeProtocolHorses(
+  EncodedStructures& protocolHorses,
+  const std::vector<Record<data::Horse>>& horseRecords)
+{
+  EncodeRecords(
+    protocolHorses,
+    horseRecords,
+    [](const data::Horse& horse, std::vector<std::byte>& buffer)
+    {
+      Horse protocolHorse{};
+      BuildProtocolHorse(protocolHorse, horse);
+      EncodeStructure(protocolHorse, buffer);
+    });
+}
+
 void BuildProtocolItem(
   Item& protocolItem,
   const data::Item& item)
@@ -196,6 +254,21 @@ void BuildProtocolItems(
   }
 }
 
+void EncodeProtocolItems(
+  EncodedStructures& protocolItems,
+  const std::vector<Record<data::Item>>& itemRecords)
+{
+  EncodeRecords(
+    protocolItems,
+    itemRecords,
+    [](const data::Item& item, std::vector<std::byte>& buffer)
+    {
+      Item protocolItem{};
+      BuildProtocolItem(protocolItem, item);
+      EncodeStructure(protocolItem, buffer);
+    });
+}
+
 void BuildProtocolStorageItem(
   StoredItem& protocolStorageItem,
   const data::StorageItem& storageItem)
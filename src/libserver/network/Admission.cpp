@@ -0,0 +1,276 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "libserver/network/Admission.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace server::network
+{
+
+namespace
+{
+
+//! Returns the Fibonacci hash of an address.
+uint64_t HashAddress(const uint32_t address) noexcept
+{
+  return static_cast<uint64_t>(address) * 0x9E3779B97F4A7C15ull;
+}
+
+} // anon namespace
+
+ConnectionAdmission::ConnectionAdmission()
+  : ConnectionAdmission(Limits{})
+{
+}
+
+ConnectionAdmission::ConnectionAdmission(const Limits limits)
+  : _limits(limits)
+{
+  const uint32_t entryCount = std::max<uint32_t>(
+    (_limits.addressCapacity + ShardCount - 1) / ShardCount, 1);
+  // Keep the load factor of the index at or below a half.
+  const size_t slotCount = std::bit_ceil(static_cast<size_t>(entryCount) * 2);
+
+  for (auto& shard : _shards)
+  {
+    shard.entries.resize(entryCount);
+    shard.slots.assign(slotCount, InvalidIndex);
+
+    // Chain all the entries into the free list.
+    for (uint32_t entryIndex = 0; entryIndex < entryCount; ++entryIndex)
+      shard.entries[entryIndex].next = entryIndex + 1 < entryCount ? entryIndex + 1 : InvalidIndex;
+    shard.freeHead = 0;
+  }
+}
+
+AdmissionResult ConnectionAdmission::Admit(
+  const boost::asio::ip::address_v4& address,
+  const Clock::time_point now)
+{
+  const uint32_t key = address.to_uint();
+  const uint64_t hash = HashAddress(key);
+
+  auto& shard = GetShard(hash);
+  std::scoped_lock lock(shard.mutex);
+
+  auto slot = FindSlot(shard, key, hash);
+  uint32_t entryIndex = shard.slots[slot];
+
+  if (entryIndex == InvalidIndex)
+  {
+    // Make room for the address by evicting the least recently used idle address.
+    if (shard.freeHead == InvalidIndex)
+    {
+      const uint32_t evictedIndex = shard.idleTail;
+      if (evictedIndex == InvalidIndex)
+      {
+        _statistics.rejectedTableFull.fetch_add(1, std::memory_order::relaxed);
+        return AdmissionResult::TableFull;
+      }
+
+      const auto& evicted = shard.entries[evictedIndex];
+      UnlinkIdle(shard, evictedIndex);
+      RemoveSlot(shard, FindSlot(shard, evicted.address, evicted.hash));
+
+      shard.entries[evictedIndex].next = shard.freeHead;
+      shard.freeHead = evictedIndex;
+
+      _statistics.evictions.fetch_add(1, std::memory_order::relaxed);
+      _statistics.trackedAddresses.fetch_sub(1, std::memory_order::relaxed);
+
+      // The removal may have shifted the probe sequence of the address.
+      slot = FindSlot(shard, key, hash);
+    }
+
+    entryIndex = shard.freeHead;
+    auto& entry = shard.entries[entryIndex];
+    shard.freeHead = entry.next;
+
+    entry = Entry{
+      .address = key,
+      .hash = hash,
+      .activeConnections = 0,
+      .tokens = static_cast<double>(_limits.burst),
+      .refilledAt = now};
+    shard.slots[slot] = entryIndex;
+    LinkIdle(shard, entryIndex);
+
+    _statistics.trackedAddresses.fetch_add(1, std::memory_order::relaxed);
+  }
+
+  auto& entry = shard.entries[entryIndex];
+
+  // Refill the bucket with the tokens regained since the last refill.
+  if (now > entry.refilledAt)
+  {
+    const auto regained = std::chrono::duration<double>(now - entry.refilledAt)
+      / std::chrono::duration<double>(_limits.refillPeriod);
+    entry.tokens = std::min(entry.tokens + regained, static_cast<double>(_limits.burst));
+    entry.refilledAt = now;
+  }
+
+  if (entry.activeConnections >= _limits.maxConnectionsPerAddress)
+  {
+    _statistics.rejectedTooManyConnections.fetch_add(1, std::memory_order::relaxed);
+    return AdmissionResult::TooManyConnections;
+  }
+
+  if (entry.tokens < 1.0)
+  {
+    // Keep the rejected address away from the eviction.
+    if (entry.activeConnections == 0)
+    {
+      UnlinkIdle(shard, entryIndex);
+      LinkIdle(shard, entryIndex);
+    }
+
+    _statistics.rejectedRateLimited.fetch_add(1, std::memory_order::relaxed);
+    return AdmissionResult::RateLimited;
+  }
+
+  entry.tokens -= 1.0;
+  // Addresses with connections are never evicted.
+  if (entry.activeConnections++ == 0)
+    UnlinkIdle(shard, entryIndex);
+
+  _statistics.admitted.fetch_add(1, std::memory_order::relaxed);
+  return AdmissionResult::Admitted;
+}
+
+void ConnectionAdmission::Release(const boost::asio::ip::address_v4& address)
+{
+  const uint32_t key = address.to_uint();
+  const uint64_t hash = HashAddress(key);
+
+  auto& shard = GetShard(hash);
+  std::scoped_lock lock(shard.mutex);
+
+  const uint32_t entryIndex = shard.slots[FindSlot(shard, key, hash)];
+  if (entryIndex == InvalidIndex)
+    return;
+
+  auto& entry = shard.entries[entryIndex];
+  if (entry.activeConnections == 0)
+    return;
+
+  if (--entry.activeConnections == 0)
+    LinkIdle(shard, entryIndex);
+}
+
+void ConnectionAdmission::RecordServerFull() noexcept
+{
+  _statistics.rejectedServerFull.fetch_add(1, std::memory_order::relaxed);
+}
+
+AdmissionStatistics ConnectionAdmission::GetStatistics() const noexcept
+{
+  return AdmissionStatistics{
+    .admitted = _statistics.admitted.load(std::memory_order::relaxed),
+    .rejectedTooManyConnections = _statistics.rejectedTooManyConnections.load(std::memory_order::relaxed),
+    .rejectedRateLimited = _statistics.rejectedRateLimited.load(std::memory_order::relaxed),
+    .rejectedTableFull = _statistics.rejectedTableFull.load(std::memory_order::relaxed),
+    .rejectedServerFull = _statistics.rejectedServerFull.load(std::memory_order::relaxed),
+    .evictions = _statistics.evictions.load(std::memory_order::relaxed),
+    .trackedAddresses = _statistics.trackedAddresses.load(std::memory_order::relaxed)};
+}
+
+size_t ConnectionAdmission::FindSlot(
+  const Shard& shard,
+  const uint32_t address,
+  const uint64_t hash) noexcept
+{
+  const size_t mask = shard.slots.size() - 1;
+  // The top bits select the shard, the slot is taken from the bits below.
+  size_t slot = (hash >> 20) & mask;
+
+  while (true)
+  {
+    const uint32_t entryIndex = shard.slots[slot];
+    if (entryIndex == InvalidIndex || shard.entries[entryIndex].address == address)
+      return slot;
+    slot = (slot + 1) & mask;
+  }
+}
+
+void ConnectionAdmission::RemoveSlot(Shard& shard, size_t slot) noexcept
+{
+  const size_t mask = shard.slots.size() - 1;
+
+  size_t nextSlot = slot;
+  while (true)
+  {
+    nextSlot = (nextSlot + 1) & mask;
+    const uint32_t entryIndex = shard.slots[nextSlot];
+    if (entryIndex == InvalidIndex)
+      break;
+
+    // Shift the entry back into the hole unless its home slot lies
+    // cyclically between the hole and its current slot.
+    const size_t homeSlot = (shard.entries[entryIndex].hash >> 20) & mask;
+    const size_t distanceFromHome = (nextSlot - homeSlot) & mask;
+    const size_t distanceFromHole = (nextSlot - slot) & mask;
+    if (distanceFromHome >= distanceFromHole)
+    {
+      shard.slots[slot] = entryIndex;
+      slot = nextSlot;
+    }
+  }
+
+  shard.slots[slot] = InvalidIndex;
+}
+
+void ConnectionAdmission::LinkIdle(Shard& shard, const uint32_t entryIndex) noexcept
+{
+  auto& entry = shard.entries[entryIndex];
+  entry.previous = InvalidIndex;
+  entry.next = shard.idleHead;
+
+  if (shard.idleHead != InvalidIndex)
+    shard.entries[shard.idleHead].previous = entryIndex;
+  else
+    shard.idleTail = entryIndex;
+  shard.idleHead = entryIndex;
+}
+
+void ConnectionAdmission::UnlinkIdle(Shard& shard, const uint32_t entryIndex) noexcept
+{
+  auto& entry = shard.entries[entryIndex];
+
+  if (entry.previous != InvalidIndex)
+    shard.entries[entry.previous].next = entry.next;
+  else
+    shard.idleHead = entry.next;
+
+  if (entry.next != InvalidIndex)
+    shard.entries[entry.next].previous = entry.previous;
+  else
+    shard.idleTail = entry.previous;
+
+  entry.previous = InvalidIndex;
+  entry.next = InvalidIndex;
+}
+
+ConnectionAdmission::Shard& ConnectionAdmission::GetShard(const uint64_t hash) noexcept
+{
+  return _shards[hash >> (64 - std::countr_zero(ShardCount))];
+}
+
+} // namespace server::network
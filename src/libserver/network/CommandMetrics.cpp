@@ -0,0 +1,213 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "libserver/network/CommandMetrics.hpp"
+
+#include <algorithm>
+
+namespace server::network
+{
+
+namespace
+{
+
+uint64_t ToNanoseconds(const CommandMetrics::Clock::duration duration)
+{
+  const auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    duration).count();
+  return nanoseconds > 0 ? static_cast<uint64_t>(nanoseconds) : 0;
+}
+
+} // anon namespace
+
+uint64_t CommandMetrics::CommandStatistics::GetTotalTime() const
+{
+  return decodeTime.sum + handlerTime.sum + serializeTime.sum;
+}
+
+CommandMetrics::CommandMetrics(const size_t commandCount)
+  : _commandCount(commandCount)
+  , _entries(std::make_unique<std::atomic<Entry*>[]>(commandCount))
+{
+}
+
+CommandMetrics::~CommandMetrics()
+{
+  for (size_t commandIdx = 0; commandIdx < _commandCount; ++commandIdx)
+    delete _entries[commandIdx].load(std::memory_order::acquire);
+}
+
+void CommandMetrics::RecordInbound(
+  const uint16_t commandId,
+  const size_t size,
+  const Clock::duration decodeTime)
+{
+  const auto entry = GetEntry(commandId);
+  if (entry == nullptr)
+    return;
+
+  entry->inboundCount.fetch_add(1, std::memory_order::relaxed);
+  entry->inboundSize.Record(size);
+  entry->decodeTime.Record(ToNanoseconds(decodeTime));
+}
+
+void CommandMetrics::RecordUnreadable(
+  const uint16_t commandId,
+  const size_t size)
+{
+  const auto entry = GetEntry(commandId);
+  if (entry == nullptr)
+    return;
+
+  entry->inboundCount.fetch_add(1, std::memory_order::relaxed);
+  entry->inboundSize.Record(size);
+  entry->failureCount.fetch_add(1, std::memory_order::relaxed);
+}
+
+void CommandMetrics::RecordHandled(
+  const uint16_t commandId,
+  const Clock::duration handlerTime,
+  const bool failed)
+{
+  const auto entry = GetEntry(commandId);
+  if (entry == nullptr)
+    return;
+
+  entry->handlerTime.Record(ToNanoseconds(handlerTime));
+  if (failed)
+    entry->failureCount.fetch_add(1, std::memory_order::relaxed);
+}
+
+void CommandMetrics::RecordError(
+  const uint16_t commandId,
+  const HandlerError error)
+{
+  const auto entry = GetEntry(commandId);
+  if (entry == nullptr || error >= HandlerError::Count)
+    return;
+
+  entry->errorCounts[static_cast<size_t>(error)].fetch_add(1, std::memory_order::relaxed);
+}
+
+void CommandMetrics::RecordOutbound(
+  const uint16_t commandId,
+  const size_t size,
+  const Clock::duration serializeTime)
+{
+  const auto entry = GetEntry(commandId);
+  if (entry == nullptr)
+    return;
+
+  entry->outboundCount.fetch_add(1, std::memory_order::relaxed);
+  entry->outboundSize.Record(size);
+  entry->serializeTime.Record(ToNanoseconds(serializeTime));
+}
+
+std::vector<CommandMetrics::CommandStatistics> CommandMetrics::GetSnapshot() const
+{
+  std::vector<CommandStatistics> snapshot;
+
+  for (size_t commandIdx = 0; commandIdx < _commandCount; ++commandIdx)
+  {
+    const Entry* entry = _entries[commandIdx].load(std::memory_order::acquire);
+    if (entry == nullptr)
+      continue;
+
+    auto& statistics = snapshot.emplace_back(CommandStatistics{
+      .commandId = static_cast<uint16_t>(commandIdx),
+      .inboundCount = entry->inboundCount.load(std::memory_order::relaxed),
+      .outboundCount = entry->outboundCount.load(std::memory_order::relaxed),
+      .failureCount = entry->failureCount.load(std::memory_order::relaxed),
+      .decodeTime = entry->decodeTime.GetSnapshot(),
+      .handlerTime = entry->handlerTime.GetSnapshot(),
+      .serializeTime = entry->serializeTime.GetSnapshot(),
+      .inboundSize = entry->inboundSize.GetSnapshot(),
+      .outboundSize = entry->outboundSize.GetSnapshot()});
+
+    for (size_t errorIdx = 0; errorIdx < HandlerErrorCount; ++errorIdx)
+    {
+      statistics.errorCounts[errorIdx] = entry->errorCounts[errorIdx].load(
+        std::memory_order::relaxed);
+    }
+  }
+
+  return snapshot;
+}
+
+std::vector<CommandMetrics::CommandStatistics> CommandMetrics::GetTopCommands(
+  const size_t count,
+  const Ranking ranking) const
+{
+  auto snapshot = GetSnapshot();
+
+  const auto getCost = [ranking](const CommandStatistics& statistics) -> uint64_t
+  {
+    switch (ranking)
+    {
+      case Ranking::TotalTime:
+        return statistics.GetTotalTime();
+      case Ranking::HandlerTimeP99:
+        return statistics.handlerTime.GetPercentile(99.0);
+      case Ranking::Count:
+        return statistics.inboundCount + statistics.outboundCount;
+      case Ranking::Bytes:
+        return statistics.inboundSize.sum + statistics.outboundSize.sum;
+    }
+    return 0;
+  };
+
+  const auto topCount = std::min(count, snapshot.size());
+  std::partial_sort(
+    snapshot.begin(),
+    snapshot.begin() + static_cast<std::ptrdiff_t>(topCount),
+    snapshot.end(),
+    [&getCost](const CommandStatistics& lhs, const CommandStatistics& rhs)
+    {
+      return getCost(lhs) > getCost(rhs);
+    });
+  snapshot.resize(topCount);
+
+  return snapshot;
+}
+
+CommandMetrics::Entry* CommandMetrics::GetEntry(const uint16_t commandId)
+{
+  if (commandId >= _commandCount)
+    return nullptr;
+
+  auto& slot = _entries[commandId];
+  Entry* entry = slot.load(std::memory_order::acquire);
+  if (entry != nullptr)
+    return entry;
+
+  // Racing threads allocate their own entry, only one of them is published.
+  auto newEntry = std::make_unique<Entry>();
+  if (slot.compare_exchange_strong(
+    entry,
+    newEntry.get(),
+    std::memory_order::acq_rel,
+    std::memory_order::acquire))
+  {
+    return newEntry.release();
+  }
+
+  return entry;
+}
+
+} // namespace server::network
@@ -0,0 +1,472 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "libserver/network/Handoff.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <format>
+#include <mutex>
+
+#ifndef WIN32
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+namespace server::network::handoff
+{
+
+namespace
+{
+
+//! Magic of the handoff message.
+constexpr std::array<char, 4> MessageMagic{'A', 'L', 'H', 'O'};
+//! Size of the handoff message.
+constexpr size_t MessageSize = MessageMagic.size() + sizeof(uint32_t);
+//! Time limit of the acknowledgement of the handoff.
+constexpr std::chrono::seconds AcknowledgementTimeout{10};
+
+//! A listening socket inherited from the previous process.
+struct InheritedListener
+{
+  asio::ip::tcp::endpoint endpoint;
+  ListenerHandle handle;
+};
+
+std::mutex inheritedListenersMutex;
+std::vector<InheritedListener> inheritedListeners;
+
+#ifndef WIN32
+
+static_assert(std::is_same_v<ListenerHandle, int>);
+
+#ifdef MSG_NOSIGNAL
+constexpr int SendFlags = MSG_NOSIGNAL;
+#else
+constexpr int SendFlags = 0;
+#endif
+
+std::string GetErrorMessage()
+{
+  return std::system_category().message(errno);
+}
+
+//! Returns whether the peer of the connection runs as the same user as this process.
+bool IsPeerTrusted(const int connection)
+{
+#if defined(SO_PEERCRED)
+  ucred credentials{};
+  socklen_t credentialsSize = sizeof(credentials);
+  if (::getsockopt(connection, SOL_SOCKET, SO_PEERCRED, &credentials, &credentialsSize) != 0)
+    return false;
+  return credentials.uid == ::geteuid();
+#else
+  uid_t peerUid{};
+  gid_t peerGid{};
+  if (::getpeereid(connection, &peerUid, &peerGid) != 0)
+    return false;
+  return peerUid == ::geteuid();
+#endif
+}
+
+#endif
+
+} // anon namespace
+
+#ifndef WIN32
+
+void SendListeners(const int connection, const std::span<const ListenerHandle> listeners)
+{
+  if (listeners.size() > MaxListenerCount)
+  {
+    throw std::runtime_error(
+      std::format("Too many listening sockets to hand off: {}", listeners.size()));
+  }
+
+  std::array<std::byte, MessageSize> payload{};
+  const uint32_t listenerCount = static_cast<uint32_t>(listeners.size());
+  std::memcpy(payload.data(), MessageMagic.data(), MessageMagic.size());
+  std::memcpy(payload.data() + MessageMagic.size(), &listenerCount, sizeof(listenerCount));
+
+  iovec payloadVector{
+    .iov_base = payload.data(),
+    .iov_len = payload.size()};
+
+  alignas(cmsghdr) std::array<std::byte, CMSG_SPACE(sizeof(int) * MaxListenerCount)> control{};
+
+  msghdr message{};
+  message.msg_iov = &payloadVector;
+  message.msg_iovlen = 1;
+
+  if (not listeners.empty())
+  {
+    const size_t handlesSize = sizeof(int) * listeners.size();
+    message.msg_control = control.data();
+    message.msg_controllen = CMSG_SPACE(handlesSize);
+
+    cmsghdr* header = CMSG_FIRSTHDR(&message);
+    header->cmsg_level = SOL_SOCKET;
+    header->cmsg_type = SCM_RIGHTS;
+    header->cmsg_len = CMSG_LEN(handlesSize);
+    std::memcpy(CMSG_DATA(header), listeners.data(), handlesSize);
+  }
+
+  const auto sentSize = ::sendmsg(connection, &message, SendFlags);
+  if (sentSize != static_cast<ssize_t>(payload.size()))
+  {
+    throw std::runtime_error(
+      std::format("Failed to send the listening sockets: {}", GetErrorMessage()));
+  }
+}
+
+std::vector<ListenerHandle> ReceiveListeners(const int connection)
+{
+  std::array<std::byte, MessageSize> payload{};
+  iovec payloadVector{
+    .iov_base = payload.data(),
+    .iov_len = payload.size()};
+
+  alignas(cmsghdr) std::array<std::byte, CMSG_SPACE(sizeof(int) * MaxListenerCount)> control{};
+
+  msghdr message{};
+  message.msg_iov = &payloadVector;
+  message.msg_iovlen = 1;
+  message.msg_control = control.data();
+  message.msg_controllen = control.size();
+
+  const auto receivedSize = ::recvmsg(connection, &message, 0);
+  if (receivedSize < 0)
+  {
+    throw std::runtime_error(
+      std::format("Failed to receive the listening sockets: {}", GetErrorMessage()));
+  }
+
+  // Collect the received sockets first, so that they are closed if the message is invalid.
+  std::vector<ListenerHandle> listeners;
+  for (cmsghdr* header = CMSG_FIRSTHDR(&message);
+    header != nullptr;
+    header = CMSG_NXTHDR(&message, header))
+  {
+    if (header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS)
+      continue;
+
+    const size_t handleCount = (header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+    for (size_t handleIdx = 0; handleIdx < handleCount; ++handleIdx)
+    {
+      int handle{};
+      std::memcpy(&handle, CMSG_DATA(header) + handleIdx * sizeof(int), sizeof(int));
+      listeners.emplace_back(handle);
+    }
+  }
+
+  const auto reject = [&listeners](const std::string_view reason)
+  {
+    for (const auto handle : listeners)
+      ::close(handle);
+    throw std::runtime_error(
+      std::format("Invalid handoff message: {}", reason));
+  };
+
+  if (message.msg_flags & MSG_CTRUNC)
+    reject("truncated sockets");
+  if (receivedSize != static_cast<ssize_t>(payload.size())
+    || std::memcmp(payload.data(), MessageMagic.data(), MessageMagic.size()) != 0)
+    reject("bad magic");
+
+  uint32_t listenerCount{};
+  std::memcpy(&listenerCount, payload.data() + MessageMagic.size(), sizeof(listenerCount));
+  if (listenerCount != listeners.size())
+    reject(std::format("expected {} sockets, received {}", listenerCount, listeners.size()));
+
+  return listeners;
+}
+
+size_t InheritListeners(
+  const std::filesystem::path& path,
+  const std::chrono::seconds releaseTimeout)
+{
+  asio::io_context ioContext;
+  asio::local::stream_protocol::socket connection(ioContext);
+
+  boost::system::error_code error;
+  connection.connect(asio::local::stream_protocol::endpoint(path.string()), error);
+  if (error)
+  {
+    // Nobody serves the handoff, the servers bind their own sockets.
+    if (error == boost::system::errc::no_such_file_or_directory
+      || error == asio::error::connection_refused)
+      return 0;
+
+    throw std::runtime_error(
+      std::format(
+        "Failed to connect to the handoff socket '{}': {}",
+        path.string(),
+        error.message()));
+  }
+
+  const auto listeners = ReceiveListeners(connection.native_handle());
+
+  std::vector<InheritedListener> inherited;
+  for (const auto handle : listeners)
+  {
+    asio::ip::tcp::endpoint endpoint;
+    socklen_t endpointSize = static_cast<socklen_t>(endpoint.capacity());
+    if (::getsockname(handle, endpoint.data(), &endpointSize) != 0)
+    {
+      spdlog::warn("Closing an inherited socket of unknown endpoint: {}", GetErrorMessage());
+      ::close(handle);
+      continue;
+    }
+
+    endpoint.resize(endpointSize);
+    inherited.emplace_back(InheritedListener{
+      .endpoint = endpoint,
+      .handle = handle});
+  }
+
+  // Acknowledge the sockets, the previous process stops accepting from now on.
+  const std::byte acknowledgement{1};
+  if (::send(connection.native_handle(), &acknowledgement, 1, SendFlags) != 1)
+  {
+    spdlog::warn("Failed to acknowledge the handoff: {}", GetErrorMessage());
+  }
+  else
+  {
+    // Wait for the previous process to disconnect its clients and write out its data,
+    // the connection closing means the previous process exited.
+    spdlog::info("Waiting up to {} seconds for the previous process to release", releaseTimeout.count());
+    timeval timeout{
+      .tv_sec = static_cast<decltype(timeval::tv_sec)>(releaseTimeout.count()),
+      .tv_usec = 0};
+    ::setsockopt(
+      connection.native_handle(), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    std::byte release{};
+    if (::recv(connection.native_handle(), &release, 1, 0) < 0)
+    {
+      spdlog::warn("The previous process did not release: {}", GetErrorMessage());
+    }
+  }
+
+  std::scoped_lock lock(inheritedListenersMutex);
+  inheritedListeners.insert(inheritedListeners.end(), inherited.begin(), inherited.end());
+  return inherited.size();
+}
+
+size_t CloseInheritedListeners()
+{
+  std::scoped_lock lock(inheritedListenersMutex);
+  for (const auto& listener : inheritedListeners)
+    ::close(listener.handle);
+
+  const auto closedCount = inheritedListeners.size();
+  inheritedListeners.clear();
+  return closedCount;
+}
+
+Provider::Provider(ListenerSupplier listenerSupplier)
+  : _acceptor(_ioContext)
+  , _connection(_ioContext)
+  , _listenerSupplier(std::move(listenerSupplier))
+{
+}
+
+bool Provider::Serve(const std::filesystem::path& path)
+{
+  // The socket file is left behind by a process which crashed or handed off to this one.
+  std::error_code removeError;
+  std::filesystem::remove(path, removeError);
+
+  const asio::local::stream_protocol::endpoint endpoint(path.string());
+  try
+  {
+    _acceptor.open(endpoint.protocol());
+    _acceptor.bind(endpoint);
+
+    // Only the user running the server may take its listening sockets.
+    std::filesystem::permissions(
+      path,
+      std::filesystem::perms::owner_read | std::filesystem::perms::owner_write,
+      std::filesystem::perm_options::replace);
+
+    _acceptor.listen();
+  }
+  catch (const std::exception& x)
+  {
+    throw std::runtime_error(
+      std::format(
+        "Exception while trying to serve the handoff on '{}': {}",
+        path.string(),
+        x.what()));
+  }
+
+  AcceptLoop();
+  _ioContext.run();
+
+  boost::system::error_code closeError;
+  _acceptor.close(closeError);
+
+  // Once handed off, the file belongs to the next process.
+  if (not _isHandedOff)
+    std::filesystem::remove(path, removeError);
+
+  return _isHandedOff;
+}
+
+void Provider::Release()
+{
+  if (not _connection.is_open())
+    return;
+
+  const std::byte release{1};
+  if (::send(_connection.native_handle(), &release, 1, SendFlags) != 1)
+  {
+    spdlog::warn("Failed to release the next process: {}", GetErrorMessage());
+  }
+
+  boost::system::error_code closeError;
+  _connection.close(closeError);
+}
+
+void Provider::AcceptLoop()
+{
+  _acceptor.async_accept(
+    [this](const boost::system::error_code& error, asio::local::stream_protocol::socket connection)
+    {
+      if (error)
+      {
+        if (error == asio::error::operation_aborted)
+          return;
+
+        spdlog::warn("Failed to accept a handoff connection: {}", error.message());
+        AcceptLoop();
+        return;
+      }
+
+      if (not IsPeerTrusted(connection.native_handle()))
+      {
+        spdlog::warn("Rejected a handoff connection of a different user");
+        AcceptLoop();
+        return;
+      }
+
+      try
+      {
+        // The raw socket calls below rely on blocking semantics.
+        connection.native_non_blocking(false);
+
+        const auto listeners = _listenerSupplier();
+        SendListeners(connection.native_handle(), listeners);
+
+        // The sockets are handed off only once the next process acknowledges them,
+        // until then this process keeps accepting.
+        timeval timeout{
+          .tv_sec = static_cast<decltype(timeval::tv_sec)>(AcknowledgementTimeout.count()),
+          .tv_usec = 0};
+        ::setsockopt(
+          connection.native_handle(), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+        std::byte acknowledgement{};
+        if (::recv(connection.native_handle(), &acknowledgement, 1, 0) != 1)
+          throw std::runtime_error("The next process did not acknowledge the sockets");
+
+        spdlog::info("Handed off {} listening sockets", listeners.size());
+        _connection = std::move(connection);
+        _isHandedOff = true;
+        _ioContext.stop();
+        return;
+      }
+      catch (const std::exception& x)
+      {
+        spdlog::error("Failed to hand off the listening sockets: {}", x.what());
+      }
+
+      AcceptLoop();
+    });
+}
+
+#else
+
+void SendListeners(int, std::span<const ListenerHandle>)
+{
+  throw std::runtime_error("The handoff of the listening sockets is not supported on this platform");
+}
+
+std::vector<ListenerHandle> ReceiveListeners(int)
+{
+  throw std::runtime_error("The handoff of the listening sockets is not supported on this platform");
+}
+
+size_t InheritListeners(const std::filesystem::path&, std::chrono::seconds)
+{
+  return 0;
+}
+
+size_t CloseInheritedListeners()
+{
+  return 0;
+}
+
+Provider::Provider(ListenerSupplier listenerSupplier)
+  : _listenerSupplier(std::move(listenerSupplier))
+{
+}
+
+bool Provider::Serve(const std::filesystem::path&)
+{
+  spdlog::warn("The handoff of the listening sockets is not supported on this platform");
+  return false;
+}
+
+void Provider::Release()
+{
+}
+
+void Provider::AcceptLoop()
+{
+}
+
+#endif
+
+std::optional<ListenerHandle> TakeInheritedListener(const asio::ip::tcp::endpoint& endpoint)
+{
+  std::scoped_lock lock(inheritedListenersMutex);
+  const auto listenerIter = std::ranges::find(
+    inheritedListeners, endpoint, &InheritedListener::endpoint);
+  if (listenerIter == inheritedListeners.cend())
+    return std::nullopt;
+
+  const auto handle = listenerIter->handle;
+  inheritedListeners.erase(listenerIter);
+  return handle;
+}
+
+Provider::~Provider() = default;
+
+void Provider::End()
+{
+  _ioContext.stop();
+}
+
+} // namespace server::network::handoff
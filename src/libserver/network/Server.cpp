@@ -18,10 +18,13 @@
  **/
 
 #include "libserver/network/Server.hpp"
+#include "libserver/network/Handoff.hpp"
 
 #include "libserver/util/Deferred.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <ranges>
 #include <spdlog/spdlog.h>
 
@@ -29,19 +32,136 @@
 #include <stacktrace>
 #endif
 
+#ifdef __linux__
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#endif
+
 namespace server::network
 {
 
 namespace
 {
 
-constexpr std::size_t MaxConnectionsPerAddress = 3;
-constexpr std::size_t MaxTotalConnections = 1024;
-constexpr std::size_t MaxConnectRatePerAddress = 10;
-constexpr auto RateWindow = std::chrono::seconds(30);
+//! Returns the name of an admission rejection.
+std::string_view GetRejectionName(const AdmissionResult result) noexcept
+{
+  switch (result)
+  {
+    case AdmissionResult::TooManyConnections:
+      return "too many connections";
+    case AdmissionResult::RateLimited:
+      return "throttled";
+    case AdmissionResult::TableFull:
+      return "address table full";
+    default:
+      return "admitted";
+  }
+}
+
+//! Returns the pool of the read buffers shared by the clients of all the servers.
+util::SlabPool& GetReadBufferPool()
+{
+  // Never destroyed, the clients of the static servers may still
+  // release their buffers during the static destruction.
+  static auto* const pool = new util::SlabPool();
+  return *pool;
+}
+
+//! Writes corked by the current thread.
+struct CorkedWrites
+{
+  //! Depth of the nested corks.
+  uint32_t depth{0};
+  //! Clients to flush once the outermost cork ends, may repeat.
+  std::vector<std::shared_ptr<Client>> clients;
+};
+
+thread_local CorkedWrites corkedWrites;
 
 } // namespace
 
+util::SlabPool::Statistics GetReadBufferPoolStatistics() noexcept
+{
+  return GetReadBufferPool().GetStatistics();
+}
+
+std::string_view GetIoBackendName() noexcept
+{
+#if defined(BOOST_ASIO_HAS_IO_URING_AS_DEFAULT)
+  return "io_uring";
+#elif defined(BOOST_ASIO_HAS_IOCP)
+  return "iocp";
+#elif defined(BOOST_ASIO_HAS_EPOLL)
+  return "epoll";
+#elif defined(BOOST_ASIO_HAS_KQUEUE)
+  return "kqueue";
+#else
+  return "select";
+#endif
+}
+
+void BufferMemoryUsage::AppendTo(util::MemoryUsageReport& report) const
+{
+  report.emplace_back("network.read_buffers", readBuffers);
+  report.emplace_back("network.write_buffers", writeBuffers);
+  report.emplace_back("network.write_queues", writeQueues);
+}
+
+ClientStatistics& ClientStatistics::operator+=(const ClientStatistics& other) noexcept
+{
+  inboundBytes += other.inboundBytes;
+  inboundFrames += other.inboundFrames;
+  outboundBytes += other.outboundBytes;
+  outboundFrames += other.outboundFrames;
+  outboundWrites += other.outboundWrites;
+  inboundReads += other.inboundReads;
+  writeQueueDepth += other.writeQueueDepth;
+  maxWriteQueueDepth = std::max(maxWriteQueueDepth, other.maxWriteQueueDepth);
+  pendingSendBytes += other.pendingSendBytes;
+  sendBlockedTime += other.sendBlockedTime;
+  roundTripTime = std::max(roundTripTime, other.roundTripTime);
+  return *this;
+}
+
+WriteCork::WriteCork() noexcept
+{
+  ++corkedWrites.depth;
+}
+
+WriteCork::~WriteCork()
+{
+  if (--corkedWrites.depth > 0)
+    return;
+
+  // Keep the capacity of the list for the next cork of the thread.
+  std::vector<std::shared_ptr<Client>> clients;
+  clients.swap(corkedWrites.clients);
+
+  std::ranges::sort(clients);
+  const auto duplicates = std::ranges::unique(clients);
+  clients.erase(duplicates.begin(), duplicates.end());
+
+  for (const auto& client : clients)
+    client->WriteLoop();
+
+  clients.clear();
+  if (corkedWrites.clients.empty())
+    corkedWrites.clients.swap(clients);
+}
+
+bool WriteCork::Defer(Client& client)
+{
+  if (corkedWrites.depth == 0)
+    return false;
+
+  // Consecutive writes to the same client are common, skip the obvious repeats.
+  if (corkedWrites.clients.empty() || corkedWrites.clients.back().get() != &client)
+    corkedWrites.clients.emplace_back(client.shared_from_this());
+  return true;
+}
+
 Client::Client(
   ClientId clientId,
   asio::ip::tcp::socket&& socket,
@@ -60,6 +180,10 @@ void Client::Begin()
 
   _networkEventHandler.OnClientConnected(_clientId);
 
+  // The reads drain the socket until it would block.
+  boost::system::error_code error;
+  _socket.non_blocking(true, error);
+
   ReadLoop();
 }
 
@@ -68,20 +192,25 @@ void Client::End()
   if (not _shouldRun.exchange(false, std::memory_order::seq_cst))
     return;
 
-  try
+  // The socket and the client table belong to the I/O thread,
+  // the client may be ended from any thread.
+  asio::dispatch(_socket.get_executor(), [clientPtr = shared_from_this()]()
   {
-    if (_socket.is_open())
+    try
     {
-      _socket.shutdown(asio::socket_base::shutdown_both);
-      _socket.close();
+      if (clientPtr->_socket.is_open())
+      {
+        clientPtr->_socket.shutdown(asio::socket_base::shutdown_both);
+        clientPtr->_socket.close();
+      }
+    }
+    catch (const std::exception&)
+    {
+      // Ignore
     }
-  }
-  catch (const std::exception&)
-  {
-    // Ignore
-  }
 
-  _networkEventHandler.OnClientDisconnected(_clientId);
+    clientPtr->_networkEventHandler.OnClientDisconnected(clientPtr->_clientId);
+  });
 }
 
 void Client::QueueWrite(WriteSupplier writeSupplier)
@@ -92,8 +221,18 @@ void Client::QueueWrite(WriteSupplier writeSupplier)
   {
     std::scoped_lock lock(_writeMutex);
     _writeQueue.emplace(writeSupplier);
+
+    const uint64_t queueDepth = _writeQueue.size();
+    _statistics.writeQueueDepth.store(queueDepth, std::memory_order::relaxed);
+    if (queueDepth > _statistics.maxWriteQueueDepth.load(std::memory_order::relaxed))
+      _statistics.maxWriteQueueDepth.store(queueDepth, std::memory_order::relaxed);
   }
 
+  _statistics.outboundFrames.fetch_add(1, std::memory_order::relaxed);
+
+  if (WriteCork::Defer(*this))
+    return;
+
   WriteLoop();
 }
 
@@ -102,6 +241,57 @@ asio::ip::address_v4 Client::GetAddress() const noexcept
   return _remoteAddress;
 }
 
+BufferMemoryUsage Client::GetBufferMemoryUsage()
+{
+  BufferMemoryUsage usage{
+    .readBuffers = {.count = _readBuffer ? 1u : 0u, .bytes = _readBuffer.GetSize()},
+    .writeBuffers = {},
+    .writeQueues = {}};
+
+  std::scoped_lock lock(_writeMutex);
+  usage.writeBuffers = {.count = 1, .bytes = _writeBuffer.capacity()};
+  usage.writeQueues = {
+    .count = _writeQueue.size(),
+    .bytes = _writeQueue.size() * sizeof(WriteSupplier)};
+
+  return usage;
+}
+
+void Client::RecordInboundFrames(const uint64_t count) noexcept
+{
+  _statistics.inboundFrames.fetch_add(count, std::memory_order::relaxed);
+}
+
+void Client::SampleRoundTripTime() noexcept
+{
+#ifdef __linux__
+  // The protocol has no echo of the heartbeat, the kernel's estimate
+  // from the acknowledgements of the sent data is used instead.
+  tcp_info info{};
+  socklen_t infoLength = sizeof(info);
+  if (::getsockopt(_socket.native_handle(), IPPROTO_TCP, TCP_INFO, &info, &infoLength) == 0)
+    _statistics.roundTripMicroseconds.store(info.tcpi_rtt, std::memory_order::relaxed);
+#endif
+}
+
+ClientStatistics Client::GetStatistics() const noexcept
+{
+  return ClientStatistics{
+    .inboundBytes = _statistics.inboundBytes.load(std::memory_order::relaxed),
+    .inboundFrames = _statistics.inboundFrames.load(std::memory_order::relaxed),
+    .inboundReads = _statistics.inboundReads.load(std::memory_order::relaxed),
+    .outboundBytes = _statistics.outboundBytes.load(std::memory_order::relaxed),
+    .outboundFrames = _statistics.outboundFrames.load(std::memory_order::relaxed),
+    .outboundWrites = _statistics.outboundWrites.load(std::memory_order::relaxed),
+    .writeQueueDepth = _statistics.writeQueueDepth.load(std::memory_order::relaxed),
+    .maxWriteQueueDepth = _statistics.maxWriteQueueDepth.load(std::memory_order::relaxed),
+    .pendingSendBytes = _statistics.pendingSendBytes.load(std::memory_order::relaxed),
+    .sendBlockedTime = std::chrono::nanoseconds(
+      _statistics.sendBlockedNanoseconds.load(std::memory_order::relaxed)),
+    .roundTripTime = std::chrono::microseconds(
+      _statistics.roundTripMicroseconds.load(std::memory_order::relaxed))};
+}
+
 void Client::WriteLoop() noexcept
 {
   // todo: forgive me for this, its not clean, its not pretty and i'm pretty sure there some side effects
@@ -138,6 +328,11 @@ void Client::WriteLoop() noexcept
     }
   }
 
+  _statistics.writeQueueDepth.store(0, std::memory_order::relaxed);
+  _statistics.pendingSendBytes.store(_writeBuffer.size(), std::memory_order::relaxed);
+  _sendIssuedAt = std::chrono::steady_clock::now();
+  _statistics.outboundWrites.fetch_add(1, std::memory_order::relaxed);
+
   _isSending.store(true, std::memory_order::release);
 
   // Asynchronously write the data to the socket.
@@ -165,6 +360,15 @@ void Client::WriteLoop() noexcept
         {
           std::scoped_lock lock(clientPtr->_writeMutex);
           clientPtr->_writeBuffer.consume(size);
+
+          auto& statistics = clientPtr->_statistics;
+          statistics.outboundBytes.fetch_add(size, std::memory_order::relaxed);
+          statistics.pendingSendBytes.store(
+            clientPtr->_writeBuffer.size(), std::memory_order::relaxed);
+          statistics.sendBlockedNanoseconds.fetch_add(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now() - clientPtr->_sendIssuedAt).count(),
+            std::memory_order::relaxed);
         }
       }
       catch (const std::exception& x)
@@ -187,9 +391,11 @@ void Client::ReadLoop() noexcept
   if (not _shouldRun.load(std::memory_order::acquire))
     return;
 
-  _socket.async_read_some(
-    _readBuffer.prepare(1024),
-    [clientPtr = this->shared_from_this()](boost::system::error_code error, std::size_t size)
+  // Wait for the data without reading it, so that the buffer is only drawn
+  // from the pool once there is something to read.
+  _socket.async_wait(
+    asio::socket_base::wait_read,
+    [clientPtr = this->shared_from_this()](const boost::system::error_code& error)
     {
       try
       {
@@ -199,26 +405,13 @@ void Client::ReadLoop() noexcept
           {
             case asio::error::operation_aborted:
               throw std::runtime_error("Connection aborted by the server");
-            case asio::error::misc_errors::eof:
-            case asio::error::connection_reset:
-              throw std::runtime_error("Connection reset by the client");
             default:
               throw std::runtime_error(
                 std::format("Generic network error {}", error.message()));
           }
         }
 
-        clientPtr->_readBuffer.commit(size);
-
-        const std::span receivedData{
-          static_cast<const std::byte*>(clientPtr->_readBuffer.data().data()),
-          clientPtr->_readBuffer.data().size()};
-
-        const auto consumedBytes = clientPtr->_networkEventHandler.OnClientData(
-          clientPtr->_clientId,
-          receivedData);
-
-        clientPtr->_readBuffer.consume(consumedBytes);
+        clientPtr->ReadAvailable();
 
         // Continue the read loop.
         clientPtr->ReadLoop();
@@ -235,22 +428,140 @@ void Client::ReadLoop() noexcept
     });
 }
 
-Server::Server(EventHandlerInterface& networkEventHandler) noexcept
+void Client::ReadAvailable()
+{
+  while (_shouldRun.load(std::memory_order::acquire))
+  {
+    ReserveReadBuffer();
+
+    const std::span space{
+      _readBuffer.GetData() + _readSize,
+      _readBuffer.GetSize() - _readSize};
+
+    boost::system::error_code error;
+    const size_t size = _socket.read_some(asio::buffer(space.data(), space.size()), error);
+    if (error)
+    {
+      switch (error.value())
+      {
+        case asio::error::would_block:
+          break;
+        case asio::error::misc_errors::eof:
+        case asio::error::connection_reset:
+          throw std::runtime_error("Connection reset by the client");
+        default:
+          throw std::runtime_error(
+            std::format("Generic network error {}", error.message()));
+      }
+
+      break;
+    }
+
+    _readSize += size;
+    _statistics.inboundBytes.fetch_add(size, std::memory_order::relaxed);
+    _statistics.inboundReads.fetch_add(1, std::memory_order::relaxed);
+
+    size_t consumedBytes = 0;
+    {
+      // The responses to the commands of the read are flushed together.
+      const WriteCork cork;
+      consumedBytes = _networkEventHandler.OnClientData(
+        _clientId,
+        std::span<const std::byte>(_readBuffer.GetData(), _readSize));
+    }
+
+    // Keep the partial frame at the start of the buffer.
+    _readSize -= consumedBytes;
+    if (_readSize > 0 && consumedBytes > 0)
+      std::memmove(_readBuffer.GetData(), _readBuffer.GetData() + consumedBytes, _readSize);
+
+    // Size the next buffers after the reads.
+    if (size == space.size())
+    {
+      _readSizeHint = std::min(_readBuffer.GetSize() * 2, util::SlabPool::MaxBlockSize);
+      _shortReadCount = 0;
+    }
+    else if (size <= _readSizeHint / 4 && _readSizeHint > InitialReadSize)
+    {
+      if (++_shortReadCount >= ShortReadsBeforeShrink)
+      {
+        _readSizeHint /= 2;
+        _shortReadCount = 0;
+      }
+    }
+    else
+    {
+      _shortReadCount = 0;
+    }
+
+    // A read which did not fill the space drained the socket.
+    if (size < space.size())
+      break;
+  }
+
+  // Return the buffer to the pool unless a partial frame is buffered.
+  if (_readSize == 0)
+    _readBuffer.Reset();
+}
+
+void Client::ReserveReadBuffer()
+{
+  if (not _readBuffer)
+  {
+    _readBuffer = GetReadBufferPool().Acquire(_readSizeHint);
+    return;
+  }
+
+  if (_readSize < _readBuffer.GetSize())
+    return;
+
+  // The buffer is full of a partial frame, move it to a larger buffer.
+  if (_readBuffer.GetSize() >= util::SlabPool::MaxBlockSize)
+    throw std::runtime_error("Frame exceeds the largest read buffer");
+
+  auto readBuffer = GetReadBufferPool().Acquire(_readBuffer.GetSize() * 2);
+  std::memcpy(readBuffer.GetData(), _readBuffer.GetData(), _readSize);
+  _readBuffer = std::move(readBuffer);
+  _readSizeHint = std::max(_readSizeHint, _readBuffer.GetSize());
+}
+
+Server::Server(
+  EventHandlerInterface& networkEventHandler,
+  const size_t maxClientCount) noexcept
   : _acceptor(_io_ctx)
   , _timer(_io_ctx)
+  , _clients(maxClientCount)
   , _networkEventHandler(networkEventHandler)
 {
 }
 
+void Server::SetSocketOptions(const SocketOptions& options)
+{
+  _socketOptions = options;
+}
+
 void Server::Begin(const asio::ip::address& address, uint16_t port)
 {
   const asio::ip::tcp::endpoint server_endpoint(address, port);
 
   try
   {
-    _acceptor.open(server_endpoint.protocol());
-    _acceptor.bind(server_endpoint);
-    _acceptor.listen();
+    if (const auto inheritedListener = handoff::TakeInheritedListener(server_endpoint))
+    {
+      // The socket is already bound and listening, the connections
+      // queued in its backlog are accepted as if nothing happened.
+      _acceptor.assign(server_endpoint.protocol(), *inheritedListener);
+      spdlog::info(
+        "Adopted the inherited listening socket on {}:{}",
+        address.to_string(),
+        port);
+    }
+    else
+    {
+      _acceptor.open(server_endpoint.protocol());
+      _acceptor.bind(server_endpoint);
+      _acceptor.listen();
+    }
   }
   catch (const std::exception& x)
   {
@@ -262,6 +573,10 @@ void Server::Begin(const asio::ip::address& address, uint16_t port)
         x.what()));
   }
 
+  _listenerHandle.store(_acceptor.native_handle(), std::memory_order::release);
+  _port.store(_acceptor.local_endpoint().port(), std::memory_order::release);
+  _isAccepting.store(true, std::memory_order::release);
+
   // Run the accept loop.
   AcceptLoop();
 
@@ -293,101 +608,167 @@ void Server::Begin(const asio::ip::address& address, uint16_t port)
 
 void Server::End()
 {
+  _isAccepting.store(false, std::memory_order::release);
   _acceptor.close();
   _io_ctx.stop();
 }
 
-std::shared_ptr<Client> Server::GetClient(ClientId clientId)
+void Server::StopAccepting()
 {
-  const auto clientItr = _clients.find(clientId);
-  if (clientItr == _clients.end())
+  if (not _isAccepting.exchange(false, std::memory_order::acq_rel))
+    return;
+
+  asio::post(_io_ctx, [this]()
   {
-    throw std::runtime_error("Invalid client");
-  }
+    boost::system::error_code error;
+    _acceptor.close(error);
+  });
+}
 
-  return clientItr->second->shared_from_this();
+std::optional<Server::ListenerHandle> Server::GetListenerHandle() const noexcept
+{
+  if (not _isAccepting.load(std::memory_order::acquire))
+    return std::nullopt;
+  return _listenerHandle.load(std::memory_order::acquire);
 }
 
-void Server::HandleNetworkTick()
+uint16_t Server::GetPort() const noexcept
 {
+  return _port.load(std::memory_order::acquire);
 }
 
-void Server::OnClientConnected(
-  ClientId clientId)
+bool Server::QueueWrite(const ClientId clientId, WriteSupplier writeSupplier)
 {
-  _networkEventHandler.OnClientConnected(clientId);
+  return _clients.Visit(clientId, [&writeSupplier](Client& client)
+  {
+    client.QueueWrite(std::move(writeSupplier));
+  });
 }
 
-void Server::OnClientDisconnected(
-  ClientId clientId)
+std::optional<asio::ip::address_v4> Server::GetClientAddress(const ClientId clientId) const
 {
-  const auto clientIt = _clients.find(clientId);
-  assert(clientIt != _clients.end());
+  std::optional<asio::ip::address_v4> address;
+  _clients.Visit(clientId, [&address](const Client& client)
+  {
+    address = client.GetAddress();
+  });
+  return address;
+}
 
-  const auto address = clientIt->second->GetAddress();
-  OnThrottleDisconnect(address);
+bool Server::DisconnectClient(const ClientId clientId)
+{
+  return _clients.Visit(clientId, [](Client& client)
+  {
+    client.End();
+  });
+}
 
-  _networkEventHandler.OnClientDisconnected(clientId);
+void Server::DisconnectAllClients()
+{
+  asio::post(_io_ctx, [this]()
+  {
+    // Collect the IDs first, disconnecting a client erases it from the table.
+    std::vector<ClientId> clientIds;
+    _clients.ForEach([&clientIds](const ClientId clientId, Client&)
+    {
+      clientIds.emplace_back(clientId);
+    });
 
-  _clients.erase(clientIt);
+    for (const auto clientId : clientIds)
+      DisconnectClient(clientId);
+  });
 }
 
-size_t Server::OnClientData(
-  ClientId clientId,
-  const std::span<const std::byte>& data)
+void Server::Post(std::function<void()> task)
 {
-  return _networkEventHandler.OnClientData(clientId, data);
+  asio::post(_io_ctx, std::move(task));
 }
 
-bool Server::IsConnectionThrottled(const asio::ip::address_v4& address) noexcept
+size_t Server::GetClientCount() const noexcept
 {
-  auto& state = _addressStates[address];
-  // If there are more active connections than allowed by `MaxConnectionsPerAddress`
-  // throttle the connection from the address.
-  if (state.activeConnections >= MaxConnectionsPerAddress)
-    return true;
+  return _clients.GetSize();
+}
 
-  const auto now = std::chrono::steady_clock::now();
+BufferMemoryUsage Server::GetBufferMemoryUsage() const noexcept
+{
+  const uint64_t clientCount = GetClientCount();
+  return BufferMemoryUsage{
+    .readBuffers = {
+      .count = clientCount,
+      .bytes = _bufferMemoryUsage.readBufferBytes.load(std::memory_order::relaxed)},
+    .writeBuffers = {
+      .count = clientCount,
+      .bytes = _bufferMemoryUsage.writeBufferBytes.load(std::memory_order::relaxed)},
+    .writeQueues = {
+      .count = _bufferMemoryUsage.queuedWriteCount.load(std::memory_order::relaxed),
+      .bytes = _bufferMemoryUsage.queuedWriteBytes.load(std::memory_order::relaxed)}};
+}
 
-  // Pop the connection timestamps which are over the rate window and have expired.
-  while (not state.connectionTimestamps.empty())
-  {
-    const auto timeSinceConnection = now - state.connectionTimestamps.front();
-    if (timeSinceConnection < RateWindow)
-      break;
+ListenerStatistics Server::GetStatistics() const
+{
+  std::scoped_lock lock(_statisticsMutex);
+  return _statistics;
+}
 
-    state.connectionTimestamps.pop_front();
-  }
+std::optional<ClientStatistics> Server::GetClientStatistics(const ClientId clientId) const
+{
+  std::scoped_lock lock(_statisticsMutex);
+  const auto statisticsIter = _clientStatistics.find(clientId);
+  if (statisticsIter == _clientStatistics.cend())
+    return std::nullopt;
+  return statisticsIter->second;
+}
 
-  // If there are more connection attempts than allowed by `MaxConnectRatePerAddress`
-  // throttle the connection from the address.
-  if (state.connectionTimestamps.size() >= MaxConnectRatePerAddress)
-    return true;
+AdmissionStatistics Server::GetAdmissionStatistics() const noexcept
+{
+  return _admission.GetStatistics();
+}
 
-  state.activeConnections++;
-  state.connectionTimestamps.push_back(now);
+void Server::RecordInboundFrames(const ClientId clientId, const uint64_t count) noexcept
+{
+  _clients.Visit(clientId, [count](Client& client)
+  {
+    client.RecordInboundFrames(count);
+  });
+}
 
-  return false;
+void Server::HandleNetworkTick()
+{
 }
 
-void Server::OnThrottleDisconnect(const asio::ip::address_v4& address) noexcept
+void Server::OnClientConnected(
+  ClientId clientId)
 {
-  const auto it = _addressStates.find(address);
-  if (it == _addressStates.end())
-  {
-    return;
-  }
+  _networkEventHandler.OnClientConnected(clientId);
+}
 
-  if (it->second.activeConnections > 0)
-  {
-    --it->second.activeConnections;
-  }
+void Server::OnClientDisconnected(
+  ClientId clientId)
+{
+  const auto client = _clients.Get(clientId);
+  assert(client);
 
-  if (it->second.activeConnections == 0 &&
-      it->second.connectionTimestamps.empty())
-  {
-    _addressStates.erase(it);
-  }
+  _admission.Release(client->GetAddress());
+
+  // Keep the counters of the client in the totals of the listener,
+  // what was still queued or pending is gone with the client.
+  auto statistics = client->GetStatistics();
+  statistics.writeQueueDepth = 0;
+  statistics.pendingSendBytes = 0;
+  statistics.roundTripTime = {};
+  _disconnectedStatistics += statistics;
+
+  _networkEventHandler.OnClientDisconnected(clientId);
+
+  // Threads still sending to the client keep it alive until they finish.
+  _clients.Erase(clientId);
+}
+
+size_t Server::OnClientData(
+  ClientId clientId,
+  const std::span<const std::byte>& data)
+{
+  return _networkEventHandler.OnClientData(clientId, data);
 }
 
 void Server::AcceptLoop() noexcept
@@ -399,36 +780,60 @@ void Server::AcceptLoop() noexcept
       {
         if (error)
         {
+          // The acceptor was closed, the server stopped accepting.
+          if (error == asio::error::operation_aborted)
+            return;
+
           throw std::runtime_error(
             fmt::format("Network exception 0x{}", error.value()));
         }
 
-        const auto remoteAddr = client_socket.remote_endpoint().address().to_v4();
+        // The connection may have been reset while queued in the backlog.
+        boost::system::error_code endpointError;
+        const auto remoteEndpoint = client_socket.remote_endpoint(endpointError);
+        if (endpointError)
+        {
+          client_socket.close();
+          AcceptLoop();
+          return;
+        }
+
+        const auto remoteAddr = remoteEndpoint.address().to_v4();
 
-        if (IsConnectionThrottled(remoteAddr))
+        // Rejected connections are closed before anything is allocated for them.
+        const auto admission = _admission.Admit(remoteAddr);
+        if (admission != AdmissionResult::Admitted)
         {
-          spdlog::warn(
-            "Connection rejected from {} (throttled)",
-            remoteAddr.to_string());
+          spdlog::debug(
+            "Connection rejected from {} ({})",
+            remoteAddr.to_string(),
+            GetRejectionName(admission));
           client_socket.close();
           AcceptLoop();
           return;
         }
 
-        // Sequential Id.
-        const ClientId clientId = _client_id++;
+        ApplySocketOptions(client_socket);
 
-        // Create the client.
-        const auto [itr, emplaced] = _clients.try_emplace(
-          clientId,
-          std::make_shared<Client>(clientId,
-            std::move(client_socket),
-            *this));
+        // Create the client, its ID is the generation-indexed ID of its slot.
+        const auto clientId = _clients.Emplace([this, &client_socket](const ClientId id)
+        {
+          return std::make_shared<Client>(id, std::move(client_socket), *this);
+        });
 
-        // Id is sequential so emplacement should never fail.
-        assert(emplaced);
+        if (not clientId)
+        {
+          spdlog::warn(
+            "Connection rejected from {} (server full)",
+            remoteAddr.to_string());
+          _admission.RecordServerFull();
+          _admission.Release(remoteAddr);
+          client_socket.close();
+          AcceptLoop();
+          return;
+        }
 
-        itr->second->Begin();
+        _clients.Get(*clientId)->Begin();
 
         // Continue the accept loop.
         AcceptLoop();
@@ -442,9 +847,127 @@ void Server::AcceptLoop() noexcept
     });
 }
 
+void Server::UpdateBufferMemoryUsage() noexcept
+{
+  BufferMemoryUsage total;
+  _clients.ForEach([&total](ClientId, Client& client)
+  {
+    const auto usage = client.GetBufferMemoryUsage();
+    total.readBuffers += usage.readBuffers;
+    total.writeBuffers += usage.writeBuffers;
+    total.writeQueues += usage.writeQueues;
+  });
+
+  _bufferMemoryUsage.readBufferBytes.store(total.readBuffers.bytes, std::memory_order::relaxed);
+  _bufferMemoryUsage.writeBufferBytes.store(total.writeBuffers.bytes, std::memory_order::relaxed);
+  _bufferMemoryUsage.queuedWriteCount.store(total.writeQueues.count, std::memory_order::relaxed);
+  _bufferMemoryUsage.queuedWriteBytes.store(total.writeQueues.bytes, std::memory_order::relaxed);
+}
+
+void Server::UpdateStatistics() noexcept
+{
+  ListenerStatistics statistics{
+    .clientCount = _clients.GetSize(),
+    .total = _disconnectedStatistics,
+    .averageRoundTripTime = {}};
+
+  std::unordered_map<ClientId, ClientStatistics> clientStatistics;
+  clientStatistics.reserve(_clients.GetSize());
+
+  std::chrono::microseconds roundTripTimeSum{};
+  uint64_t roundTripSampleCount = 0;
+
+  _clients.ForEach([&](const ClientId clientId, Client& client)
+  {
+    client.SampleRoundTripTime();
+
+    const auto& clientStatistic = clientStatistics.try_emplace(
+      clientId, client.GetStatistics()).first->second;
+    statistics.total += clientStatistic;
+
+    if (clientStatistic.roundTripTime.count() > 0)
+    {
+      roundTripTimeSum += clientStatistic.roundTripTime;
+      ++roundTripSampleCount;
+    }
+  });
+
+  if (roundTripSampleCount > 0)
+    statistics.averageRoundTripTime = roundTripTimeSum / roundTripSampleCount;
+
+  std::scoped_lock lock(_statisticsMutex);
+  _statistics = statistics;
+  _clientStatistics = std::move(clientStatistics);
+}
+
+void Server::ApplySocketOptions(asio::ip::tcp::socket& socket) noexcept
+{
+  // The options are a tuning, a failure to apply one is not fatal to the client.
+  const auto check = [](const char* option, const boost::system::error_code& error)
+  {
+    if (error)
+      spdlog::debug("Failed to set the socket option {}: {}", option, error.message());
+  };
+
+  boost::system::error_code error;
+  socket.set_option(asio::ip::tcp::no_delay(_socketOptions.noDelay), error);
+  check("TCP_NODELAY", error);
+
+  if (_socketOptions.sendBufferSize > 0)
+  {
+    socket.set_option(
+      asio::socket_base::send_buffer_size(static_cast<int>(_socketOptions.sendBufferSize)),
+      error);
+    check("SO_SNDBUF", error);
+  }
+
+  if (_socketOptions.receiveBufferSize > 0)
+  {
+    socket.set_option(
+      asio::socket_base::receive_buffer_size(static_cast<int>(_socketOptions.receiveBufferSize)),
+      error);
+    check("SO_RCVBUF", error);
+  }
+
+  socket.set_option(asio::socket_base::keep_alive(_socketOptions.keepAlive), error);
+  check("SO_KEEPALIVE", error);
+
+#ifdef __linux__
+  const auto setIntegerOption = [&socket, &check](const char* name, const int option, const int value)
+  {
+    if (::setsockopt(socket.native_handle(), IPPROTO_TCP, option, &value, sizeof(value)) != 0)
+      check(name, boost::system::error_code(errno, boost::system::system_category()));
+  };
+
+  if (_socketOptions.keepAlive)
+  {
+    setIntegerOption("TCP_KEEPIDLE", TCP_KEEPIDLE,
+      static_cast<int>(_socketOptions.keepAliveIdle.count()));
+    setIntegerOption("TCP_KEEPINTVL", TCP_KEEPINTVL,
+      static_cast<int>(_socketOptions.keepAliveInterval.count()));
+    setIntegerOption("TCP_KEEPCNT", TCP_KEEPCNT,
+      static_cast<int>(_socketOptions.keepAliveCount));
+  }
+
+  if (_socketOptions.userTimeout.count() > 0)
+  {
+    setIntegerOption("TCP_USER_TIMEOUT", TCP_USER_TIMEOUT,
+      static_cast<int>(_socketOptions.userTimeout.count()));
+  }
+#endif
+}
+
 void Server::TickLoop() noexcept
 {
-  _networkEventHandler.HandleNetworkTick();
+  {
+    const WriteCork cork;
+    _networkEventHandler.HandleNetworkTick();
+  }
+
+  // Release the disconnected clients the other threads no longer send to.
+  _clients.Reclaim();
+  UpdateBufferMemoryUsage();
+  UpdateStatistics();
 
   _timer.expires_after(std::chrono::seconds(1));
   _timer.async_wait([this](const boost::system::error_code& error)
@@ -0,0 +1,235 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "libserver/network/TrafficCapture.hpp"
+
+#include <format>
+#include <stdexcept>
+
+namespace server::network::capture
+{
+
+namespace
+{
+
+//! Size of the write buffer of the capture file.
+constexpr size_t FileBufferSize = 64 * 1024;
+//! Max size of the command data in a record.
+constexpr uint64_t MaxCommandDataSize = 0xFFFF;
+
+} // anon namespace
+
+Writer::Writer(const std::filesystem::path& path)
+  : _fileBuffer(FileBufferSize)
+{
+  // The buffer must be set before the file is opened.
+  _file.rdbuf()->pubsetbuf(_fileBuffer.data(), static_cast<std::streamsize>(_fileBuffer.size()));
+  _file.open(path, std::ios::binary | std::ios::trunc);
+  if (not _file.is_open())
+  {
+    throw std::runtime_error(
+      std::format("Couldn't open the capture file '{}'", path.string()));
+  }
+
+  _file.write(FileMagic.data(), FileMagic.size());
+  const std::array version{
+    static_cast<char>(FileVersion & 0xFF),
+    static_cast<char>(FileVersion >> 8)};
+  _file.write(version.data(), version.size());
+
+  _lastRecordTime = Clock::now();
+}
+
+Writer::~Writer()
+{
+  Flush();
+}
+
+void Writer::WriteConnected(const ClientId clientId)
+{
+  std::scoped_lock lock(_mutex);
+  WriteRecordHeader(RecordType::Connected, clientId);
+}
+
+void Writer::WriteDisconnected(const ClientId clientId)
+{
+  std::scoped_lock lock(_mutex);
+  WriteRecordHeader(RecordType::Disconnected, clientId);
+}
+
+void Writer::WriteCommand(
+  const ClientId clientId,
+  const uint16_t commandId,
+  const std::span<const std::byte> data)
+{
+  std::scoped_lock lock(_mutex);
+  WriteRecordHeader(RecordType::Command, clientId);
+  WriteVarint(commandId);
+  WriteVarint(data.size());
+  _file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+}
+
+void Writer::WriteCode(const ClientId clientId, const std::span<const std::byte, 4> code)
+{
+  std::scoped_lock lock(_mutex);
+  WriteRecordHeader(RecordType::Code, clientId);
+  _file.write(reinterpret_cast<const char*>(code.data()), static_cast<std::streamsize>(code.size()));
+}
+
+void Writer::Flush()
+{
+  std::scoped_lock lock(_mutex);
+  _file.flush();
+}
+
+std::filesystem::path Writer::MakeFilePath(
+  const std::filesystem::path& directory,
+  const std::string_view name)
+{
+  const auto now = std::chrono::floor<std::chrono::seconds>(
+    std::chrono::system_clock::now());
+  return directory / std::format("{}-{:%Y%m%dT%H%M%SZ}.capture", name, now);
+}
+
+void Writer::WriteRecordHeader(const RecordType type, const ClientId clientId)
+{
+  const auto now = Clock::now();
+  const auto timeDelta = std::chrono::duration_cast<std::chrono::microseconds>(
+    now - _lastRecordTime);
+  // Advance by the recorded delta only, so that the truncated
+  // remainders do not accumulate over the capture.
+  _lastRecordTime += timeDelta;
+
+  _file.put(static_cast<char>(type));
+  WriteVarint(static_cast<uint64_t>(timeDelta.count()));
+  WriteVarint(clientId);
+}
+
+void Writer::WriteVarint(uint64_t value)
+{
+  do
+  {
+    auto byte = static_cast<uint8_t>(value & 0x7F);
+    value >>= 7;
+    if (value != 0)
+      byte |= 0x80;
+    _file.put(static_cast<char>(byte));
+  } while (value != 0);
+}
+
+Reader::Reader(const std::filesystem::path& path)
+  : _file(path, std::ios::binary)
+{
+  if (not _file.is_open())
+  {
+    throw std::runtime_error(
+      std::format("Couldn't open the capture file '{}'", path.string()));
+  }
+
+  std::array<char, FileMagic.size()> magic{};
+  std::array<uint8_t, 2> version{};
+  _file.read(magic.data(), magic.size());
+  _file.read(reinterpret_cast<char*>(version.data()), version.size());
+
+  if (not _file || magic != FileMagic)
+  {
+    throw std::runtime_error(
+      std::format("File '{}' is not a capture", path.string()));
+  }
+
+  const uint16_t fileVersion = version[0] | version[1] << 8;
+  if (fileVersion != FileVersion)
+  {
+    throw std::runtime_error(
+      std::format("Unsupported capture version {}", fileVersion));
+  }
+}
+
+bool Reader::Read(Record& record)
+{
+  const auto type = _file.get();
+  if (type == std::ifstream::traits_type::eof())
+    return false;
+
+  uint64_t timeDelta{};
+  uint64_t clientId{};
+  if (not ReadVarint(timeDelta) || not ReadVarint(clientId))
+    throw std::runtime_error("Truncated capture record");
+
+  _time += std::chrono::microseconds(timeDelta);
+
+  record.type = static_cast<RecordType>(type);
+  record.time = _time;
+  record.clientId = static_cast<ClientId>(clientId);
+  record.commandId = 0;
+  record.data.clear();
+
+  switch (record.type)
+  {
+    case RecordType::Connected:
+    case RecordType::Disconnected:
+      break;
+    case RecordType::Command:
+    {
+      uint64_t commandId{};
+      uint64_t dataSize{};
+      if (not ReadVarint(commandId) || not ReadVarint(dataSize))
+        throw std::runtime_error("Truncated capture record");
+      if (commandId > 0xFFFF || dataSize > MaxCommandDataSize)
+        throw std::runtime_error("Malformed capture command record");
+
+      record.commandId = static_cast<uint16_t>(commandId);
+      record.data.resize(dataSize);
+      break;
+    }
+    case RecordType::Code:
+    {
+      record.data.resize(4);
+      break;
+    }
+    default:
+      throw std::runtime_error(
+        std::format("Unknown capture record type {}", type));
+  }
+
+  _file.read(reinterpret_cast<char*>(record.data.data()), static_cast<std::streamsize>(record.data.size()));
+  if (not _file)
+    throw std::runtime_error("Truncated capture record");
+
+  return true;
+}
+
+bool Reader::ReadVarint(uint64_t& value)
+{
+  value = 0;
+  for (uint32_t shift = 0; shift < 64; shift += 7)
+  {
+    const auto byte = _file.get();
+    if (byte == std::ifstream::traits_type::eof())
+      return false;
+
+    value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0)
+      return true;
+  }
+
+  return false;
+}
+
+} // namespace server::network::capture
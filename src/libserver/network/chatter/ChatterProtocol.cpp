@@ -108,4 +108,15 @@ std::string_view GetChatterCommandName(server::protocol::ChatterCommand command)
   return commandIter == commands.cend() ? "n/a" : commandIter->second;
 }
 
+std::optional<ChatterCommand> GetChatterCommandByName(std::string_view name)
+{
+  for (const auto& [command, commandName] : commands)
+  {
+    if (commandName == name)
+      return command;
+  }
+
+  return std::nullopt;
+}
+
 } // namespace server::protocol
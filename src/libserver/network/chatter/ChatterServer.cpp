@@ -18,7 +18,9 @@
  **/
 
 #include "libserver/network/chatter/ChatterServer.hpp"
+#include "libserver/util/CommandIdSet.hpp"
 #include "libserver/util/Stream.hpp"
+#include "libserver/util/Trace.hpp"
 #include "libserver/util/Util.hpp"
 
 #ifndef DISABLE_STACKTRACE
@@ -40,6 +42,14 @@ constexpr std::array XorCode{
   static_cast<std::byte>(0xB8),
   static_cast<std::byte>(0x02)};
 
+//! Count of the chatter command IDs recorded by the metrics.
+constexpr size_t ChatterCommandCount = 0x100;
+
+//! Commands whose received data is dumped.
+util::CommandIdSet incomingCommandDataDumps;
+//! Commands whose sent data is dumped.
+util::CommandIdSet outgoingCommandDataDumps;
+
 // todo: de/serializer map, handler map
 
 } // anon namespace
@@ -47,6 +57,7 @@ constexpr std::array XorCode{
 ChatterServer::ChatterServer(
   IChatterServerEventsHandler& chatterServerEventsHandler)
   : _chatterServerEventsHandler(chatterServerEventsHandler)
+  , _metrics(ChatterCommandCount)
   , _server(*this)
 {
 }
@@ -58,6 +69,11 @@ ChatterServer::~ChatterServer()
     _serverThread.join();
 }
 
+void ChatterServer::SetSocketOptions(const network::SocketOptions& options)
+{
+  _server.SetSocketOptions(options);
+}
+
 void ChatterServer::BeginHost(network::asio::ip::address_v4 address, uint16_t port)
 {
   _serverThread = std::thread([this, address, port]()
@@ -93,6 +109,7 @@ void ChatterServer::EndHost()
 
 void ChatterServer::HandleNetworkTick()
 {
+  _chatterServerEventsHandler.HandleNetworkTick();
 }
 
 void ChatterServer::OnClientConnected(network::ClientId clientId)
@@ -109,6 +126,9 @@ size_t ChatterServer::OnClientData(
   network::ClientId clientId,
   const std::span<const std::byte>& data)
 {
+  // Count of the frames received in the data.
+  uint64_t receivedFrameCount = 0;
+
   SourceStream commandStream{data};
 
   while (commandStream.GetCursor() != commandStream.Size())
@@ -148,6 +168,9 @@ size_t ChatterServer::OnClientData(
       break;
     }
 
+    const auto receivedAt = network::CommandMetrics::Clock::now();
+    ++receivedFrameCount;
+
     const size_t commandDataLength = header.length - sizeof(protocol::ChatterCommandHeader);
     std::vector<std::byte> commandData(commandDataLength);
 
@@ -163,9 +186,9 @@ size_t ChatterServer::OnClientData(
 
     SourceStream commandDataSource({commandData.begin(), commandData.end()});
 
-    if (debugIncomingCommandData)
+    if (incomingCommandDataDumps.Contains(header.commandId))
     {
-      spdlog::debug("Read data for command '{}' (0x{:X}),\n\n"
+      SPDLOG_DEBUG("Read data for command '{}' (0x{:X}),\n\n"
         "Command data size: {} \n"
         "Data dump: \n\n{}\n",
         GetChatterCommandName(static_cast<protocol::ChatterCommand>(header.commandId)),
@@ -178,6 +201,10 @@ size_t ChatterServer::OnClientData(
     const auto handlerIter = _handlers.find(header.commandId);
     if (handlerIter == _handlers.cend())
     {
+      // Unless the command is handled, the decoding is just the descrambling.
+      const auto decodedAt = network::CommandMetrics::Clock::now();
+      _metrics.RecordInbound(header.commandId, header.length, decodedAt - receivedAt);
+
       if (debugCommands)
       {
         spdlog::warn("Unhandled chatter command: {} ({:#x})", 
@@ -188,38 +215,152 @@ size_t ChatterServer::OnClientData(
     else
     {
       const auto& handler = handlerIter->second;
+      bool handlerFailed = false;
+      std::optional<network::CommandMetrics::Clock::time_point> decodedAt;
+      network::HandlerResult handlerResult;
       try
       {
-        handler(clientId, commandDataSource);
+        const util::trace::Span span("chatter_command", [commandId = header.commandId]()
+        {
+          return GetChatterCommandName(static_cast<protocol::ChatterCommand>(commandId));
+        });
+        handlerResult = handler(clientId, commandDataSource, decodedAt);
         
         if (debugCommands)
         {
-          spdlog::debug("Handled chatter command: {} ({:#x})", 
+          SPDLOG_DEBUG("Handled chatter command: {} ({:#x})", 
             GetChatterCommandName(static_cast<protocol::ChatterCommand>(header.commandId)),
             header.commandId);
         }
       }
       catch (const std::exception& ex)
       {
+        handlerFailed = true;
         spdlog::error("Unhandled exception handling chatter command {} ({:#x}): {}",
           GetChatterCommandName(static_cast<protocol::ChatterCommand>(header.commandId)),
           header.commandId,
           ex.what());
       }
+
+      const auto handledAt = network::CommandMetrics::Clock::now();
+      if (decodedAt)
+      {
+        _metrics.RecordInbound(header.commandId, header.length, *decodedAt - receivedAt);
+        _metrics.RecordHandled(
+          header.commandId,
+          handledAt - *decodedAt,
+          handlerFailed or not handlerResult);
+      }
+      else
+      {
+        // The reading of the command threw, there is no decode or handler time to record.
+        _metrics.RecordUnreadable(header.commandId, header.length);
+      }
+
+      // The rejected commands are routine, they are only counted.
+      if (not handlerResult)
+      {
+        _metrics.RecordError(header.commandId, handlerResult.error());
+        SPDLOG_DEBUG("Chatter command {} ({:#x}) of client {} rejected: {}",
+          GetChatterCommandName(static_cast<protocol::ChatterCommand>(header.commandId)),
+          header.commandId,
+          clientId,
+          network::GetHandlerErrorName(handlerResult.error()));
+      }
     }
   }
 
+  _server.RecordInboundFrames(clientId, receivedFrameCount);
   return commandStream.GetCursor();
 }
 
 network::asio::ip::address_v4 ChatterServer::GetClientAddress(const network::ClientId clientId)
 {
-  return _server.GetClient(clientId)->GetAddress();
+  const auto address = _server.GetClientAddress(clientId);
+  if (not address)
+    throw std::runtime_error("Invalid client");
+  return *address;
 }
 
 void ChatterServer::DisconnectClient(network::ClientId clientId)
 {
-  _server.GetClient(clientId)->End();
+  _server.DisconnectClient(clientId);
+}
+
+void ChatterServer::SetCommandDataDumps(
+  const std::vector<std::string>& incomingCommands,
+  const std::vector<std::string>& outgoingCommands)
+{
+  const auto resolve = [](const std::vector<std::string>& commandNames)
+  {
+    util::CommandIdSet commands;
+    for (const auto& commandName : commandNames)
+    {
+      const auto command = protocol::GetChatterCommandByName(commandName);
+      if (not command)
+      {
+        spdlog::warn("Unknown chatter command '{}' to dump the data of", commandName);
+        continue;
+      }
+
+      commands.Insert(static_cast<uint16_t>(*command));
+    }
+    return commands;
+  };
+
+  incomingCommandDataDumps = resolve(incomingCommands);
+  outgoingCommandDataDumps = resolve(outgoingCommands);
+}
+
+const network::CommandMetrics& ChatterServer::GetMetrics() const
+{
+  return _metrics;
+}
+
+size_t ChatterServer::GetClientCount() const
+{
+  return _server.GetClientCount();
+}
+
+network::BufferMemoryUsage ChatterServer::GetBufferMemoryUsage() const
+{
+  return _server.GetBufferMemoryUsage();
+}
+
+network::ListenerStatistics ChatterServer::GetStatistics() const
+{
+  return _server.GetStatistics();
+}
+
+std::optional<network::ClientStatistics> ChatterServer::GetClientStatistics(
+  const network::ClientId clientId) const
+{
+  return _server.GetClientStatistics(clientId);
+}
+
+network::AdmissionStatistics ChatterServer::GetAdmissionStatistics() const
+{
+  return _server.GetAdmissionStatistics();
+}
+
+void ChatterServer::StopAccepting()
+{
+  _server.StopAccepting();
+}
+
+void ChatterServer::DisconnectAllClients()
+{
+  _server.DisconnectAllClients();
+}
+
+std::optional<network::Server::ListenerHandle> ChatterServer::GetListenerHandle() const
+{
+  return _server.GetListenerHandle();
+}
+
+bool ChatterServer::IsOutgoingCommandDataDumped(const uint16_t commandId)
+{
+  return outgoingCommandDataDumps.Contains(commandId);
 }
 
 } // namespace server
\ No newline at end of file
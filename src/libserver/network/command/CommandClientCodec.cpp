@@ -0,0 +1,104 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "libserver/network/command/CommandClientCodec.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+
+namespace server
+{
+
+namespace
+{
+
+//! Max size of the command data, including the padding.
+//! Mirrors the limit of the command server.
+constexpr size_t MaxCommandDataSize = 8192;
+
+} // anon namespace
+
+void CommandClientCodec::SetCode(const protocol::XorCode& code)
+{
+  _client.SetCode(code);
+}
+
+void CommandClientCodec::Encode(
+  const uint16_t commandId,
+  const std::span<const std::byte> data,
+  std::vector<std::byte>& buffer)
+{
+  size_t padding = 0;
+  if (not data.empty())
+  {
+    _client.RollCode();
+    // The padding is derived from the code like the server expects it.
+    padding = static_cast<uint32_t>(_client.GetRollingCodeInt()) & 7;
+  }
+
+  const size_t commandDataSize = data.size() + padding;
+  if (commandDataSize > MaxCommandDataSize)
+  {
+    throw std::runtime_error(
+      std::format("Command data size {} exceeds the limit", commandDataSize));
+  }
+
+  const protocol::MessageMagic magic{
+    .id = commandId,
+    .length = static_cast<uint16_t>(sizeof(uint32_t) + commandDataSize)};
+  const uint32_t magicValue = protocol::encode_message_magic(magic);
+
+  const size_t origin = buffer.size();
+  buffer.resize(origin + sizeof(magicValue) + commandDataSize);
+
+  std::memcpy(buffer.data() + origin, &magicValue, sizeof(magicValue));
+
+  const auto commandData = std::span(buffer).subspan(origin + sizeof(magicValue));
+  std::ranges::copy(data, commandData.begin());
+
+  // The padding is scrambled along with the data.
+  const auto& code = _client.GetRollingCode();
+  for (size_t idx = 0; idx < commandData.size(); ++idx)
+    commandData[idx] ^= code[idx % 4];
+}
+
+std::optional<protocol::MessageMagic> CommandClientCodec::PeekServerCommand(
+  const std::span<const std::byte> buffer)
+{
+  uint32_t magicValue{};
+  if (buffer.size() < sizeof(magicValue))
+    return std::nullopt;
+
+  std::memcpy(&magicValue, buffer.data(), sizeof(magicValue));
+  const auto magic = protocol::decode_message_magic(magicValue);
+
+  if (magic.length < sizeof(magicValue))
+  {
+    throw std::runtime_error(
+      std::format("Invalid command magic: Bad command size '{}'", magic.length));
+  }
+
+  if (buffer.size() < magic.length)
+    return std::nullopt;
+
+  return magic;
+}
+
+} // namespace server
@@ -714,4 +714,15 @@ std::string_view GetCommandName(Command command)
   return commandIter == commands.cend() ? "n/a" : commandIter->second;
 }
 
+std::optional<Command> GetCommandByName(std::string_view name)
+{
+  for (const auto& [command, commandName] : commands)
+  {
+    if (commandName == name)
+      return command;
+  }
+
+  return std::nullopt;
+}
+
 } // namespace server
@@ -19,7 +19,9 @@
 
 #include "libserver/network/command/CommandServer.hpp"
 
+#include "libserver/util/CommandIdSet.hpp"
 #include "libserver/util/Deferred.hpp"
+#include "libserver/util/Trace.hpp"
 #include "libserver/util/Util.hpp"
 
 #include <ranges>
@@ -68,6 +70,11 @@ void XorAlgorithm(
   }
 }
 
+//! Commands whose received data is dumped.
+util::CommandIdSet incomingCommandDataDumps;
+//! Commands whose sent data is dumped.
+util::CommandIdSet outgoingCommandDataDumps;
+
 bool IsMuted(protocol::Command id)
 {
   return id == protocol::Command::AcCmdCLHeartbeat
@@ -114,7 +121,8 @@ int32_t CommandClient::GetRollingCodeInt() const
 
 CommandServer::CommandServer(
   EventHandlerInterface& networkEventHandler)
-  : _eventHandler(networkEventHandler)
+  : _metrics(static_cast<size_t>(protocol::Command::Count) + 1)
+  , _eventHandler(networkEventHandler)
   , _serverNetworkEventHandler(*this)
   , _server(_serverNetworkEventHandler)
 {
@@ -124,6 +132,11 @@ CommandServer::~CommandServer()
 {
 }
 
+void CommandServer::SetSocketOptions(const network::SocketOptions& options)
+{
+  _server.SetSocketOptions(options);
+}
+
 void CommandServer::BeginHost(const asio::ip::address& address, uint16_t port)
 {
   _serverThread = std::thread(
@@ -160,17 +173,80 @@ void CommandServer::EndHost()
 
 asio::ip::address_v4 CommandServer::GetClientAddress(ClientId clientId)
 {
-  return _server.GetClient(clientId)->GetAddress();
+  const auto address = _server.GetClientAddress(clientId);
+  if (not address)
+    throw std::runtime_error("Invalid client");
+  return *address;
 }
 
 void CommandServer::DisconnectClient(ClientId clientId)
 {
-  _server.GetClient(clientId)->End();
+  _server.DisconnectClient(clientId);
 }
 
 void CommandServer::SetCode(ClientId client, protocol::XorCode code)
 {
   _clients[client].SetCode(code);
+
+  if (_capture)
+    _capture->WriteCode(client, code);
+}
+
+void CommandServer::BeginCapture(const std::filesystem::path& path)
+{
+  _capture = std::make_unique<network::capture::Writer>(path);
+  spdlog::info("Capturing the received commands to '{}'", path.string());
+}
+
+const network::CommandMetrics& CommandServer::GetMetrics() const
+{
+  return _metrics;
+}
+
+size_t CommandServer::GetClientCount() const
+{
+  return _server.GetClientCount();
+}
+
+network::BufferMemoryUsage CommandServer::GetBufferMemoryUsage() const
+{
+  return _server.GetBufferMemoryUsage();
+}
+
+network::ListenerStatistics CommandServer::GetStatistics() const
+{
+  return _server.GetStatistics();
+}
+
+std::optional<network::ClientStatistics> CommandServer::GetClientStatistics(
+  const network::ClientId clientId) const
+{
+  return _server.GetClientStatistics(clientId);
+}
+
+network::AdmissionStatistics CommandServer::GetAdmissionStatistics() const
+{
+  return _server.GetAdmissionStatistics();
+}
+
+void CommandServer::StopAccepting()
+{
+  _server.StopAccepting();
+}
+
+void CommandServer::DisconnectAllClients()
+{
+  _server.DisconnectAllClients();
+}
+
+void CommandServer::Post(std::function<void()> task)
+{
+  _server.Post(std::move(task));
+}
+
+std::optional<network::Server::ListenerHandle> CommandServer::GetListenerHandle() const
+{
+  return _server.GetListenerHandle();
 }
 
 CommandServer::NetworkEventHandler::NetworkEventHandler(
@@ -187,12 +263,18 @@ void CommandServer::NetworkEventHandler::HandleNetworkTick()
 void CommandServer::NetworkEventHandler::OnClientConnected(
   network::ClientId clientId)
 {
+  if (_commandServer._capture)
+    _commandServer._capture->WriteConnected(clientId);
+
   _commandServer._eventHandler.HandleClientConnected(clientId);
 }
 
 void CommandServer::NetworkEventHandler::OnClientDisconnected(
   network::ClientId clientId)
 {
+  if (_commandServer._capture)
+    _commandServer._capture->WriteDisconnected(clientId);
+
   _commandServer._eventHandler.HandleClientDisconnected(clientId);
 }
 
@@ -200,6 +282,9 @@ size_t CommandServer::NetworkEventHandler::OnClientData(
   network::ClientId clientId,
   const std::span<const std::byte>& data)
 {
+  // Count of the frames received in the data.
+  uint64_t receivedFrameCount = 0;
+
   SourceStream commandStream(data);
 
   while (commandStream.GetCursor() != commandStream.Size())
@@ -267,6 +352,9 @@ size_t CommandServer::NetworkEventHandler::OnClientData(
       break;
     }
 
+    const auto receivedAt = network::CommandMetrics::Clock::now();
+    ++receivedFrameCount;
+
     // Buffer for the command data.
     std::array<std::byte, MaxCommandDataSize> commandDataBuffer{};
 
@@ -323,10 +411,9 @@ size_t CommandServer::NetworkEventHandler::OnClientData(
       commandDataStream = std::move(SourceStream(
         {commandDataBuffer.begin(), actualCommandDataSize}));
 
-      if (_commandServer.debugIncomingCommandData
-        && not IsMuted(commandId))
+      if (incomingCommandDataDumps.Contains(magic.id))
       {
-        spdlog::debug("Read data for command '{}' (0x{:X}),\n\n"
+        SPDLOG_DEBUG("Read data for command '{}' (0x{:X}),\n\n"
           "XOR code: {:#X},\n"
           "Command data size: {} (padding: {}),\n"
           "Actual command data size: {}\n"
@@ -341,10 +428,22 @@ size_t CommandServer::NetworkEventHandler::OnClientData(
       }
     }
 
+    if (_commandServer._capture)
+    {
+      _commandServer._capture->WriteCommand(
+        clientId,
+        magic.id,
+        {commandDataBuffer.data(), commandDataStream.Size()});
+    }
+
     // Find the handler of the command.
     const auto handlerIter = _commandServer._handlers.find(commandId);
     if (handlerIter == _commandServer._handlers.cend())
     {
+      // Unless the command is handled, the decoding is just the descrambling.
+      const auto decodedAt = network::CommandMetrics::Clock::now();
+      _commandServer._metrics.RecordInbound(magic.id, magic.length, decodedAt - receivedAt);
+
       if (_commandServer.debugCommands
         && not IsMuted(commandId))
       {
@@ -360,13 +459,21 @@ size_t CommandServer::NetworkEventHandler::OnClientData(
       // Handler validity is checked when registering.
       assert(handler);
 
+      bool handlerFailed = false;
+      std::optional<network::CommandMetrics::Clock::time_point> decodedAt;
+      network::HandlerResult handlerResult;
       try
       {
         // Call the handler.
-        handler(clientId, commandDataStream);
+        const util::trace::Span span("command", [commandId]()
+        {
+          return GetCommandName(commandId);
+        });
+        handlerResult = handler(clientId, commandDataStream, decodedAt);
       }
       catch (const std::exception& x)
       {
+        handlerFailed = true;
         spdlog::error(
           "Unhandled exception handling command '{}' (0x{:x}): {}",
           protocol::GetCommandName(commandId),
@@ -374,13 +481,40 @@ size_t CommandServer::NetworkEventHandler::OnClientData(
           x.what());
       }
 
+      const auto handledAt = network::CommandMetrics::Clock::now();
+      if (decodedAt)
+      {
+        _commandServer._metrics.RecordInbound(magic.id, magic.length, *decodedAt - receivedAt);
+        _commandServer._metrics.RecordHandled(
+          magic.id,
+          handledAt - *decodedAt,
+          handlerFailed or not handlerResult);
+      }
+      else
+      {
+        // The reading of the command threw, there is no decode or handler time to record.
+        _commandServer._metrics.RecordUnreadable(magic.id, magic.length);
+      }
+
+      // The rejected commands are routine, they are only counted.
+      if (not handlerResult)
+      {
+        _commandServer._metrics.RecordError(magic.id, handlerResult.error());
+        SPDLOG_DEBUG(
+          "Command '{}' (0x{:x}) of client {} rejected: {}",
+          GetCommandName(commandId),
+          magic.id,
+          clientId,
+          network::GetHandlerErrorName(handlerResult.error()));
+      }
+
       // There shouldn't be any left-over data in the stream.
       assert(commandDataStream.GetCursor() == commandDataStream.Size());
 
       if (_commandServer.debugCommands
         && not IsMuted(commandId))
       {
-        spdlog::debug(
+        SPDLOG_DEBUG(
           "Handled command '{}' (0x{:x})",
           GetCommandName(commandId),
           magic.id);
@@ -388,6 +522,7 @@ size_t CommandServer::NetworkEventHandler::OnClientData(
     }
   }
 
+  _commandServer._server.RecordInboundFrames(clientId, receivedFrameCount);
   return commandStream.GetCursor();
 }
 
@@ -396,69 +531,95 @@ void CommandServer::SendCommand(
   protocol::Command commandId,
   CommandSupplier supplier)
 {
-  try
-  {
-    _server.GetClient(clientId)->QueueWrite(
-      [this, commandId, supplier = std::move(supplier)](asio::streambuf& writeBuffer)
-      {
-        const auto mutableBuffer = writeBuffer.prepare(MaxCommandSize);
-        const auto writeBufferView = std::span(
-          static_cast<std::byte*>(mutableBuffer.data()),
-          mutableBuffer.size());
+  // The command is dropped if the client has disconnected in the meantime.
+  _server.QueueWrite(
+    clientId,
+    [this, commandId, supplier = std::move(supplier)](asio::streambuf& writeBuffer)
+    {
+      const auto mutableBuffer = writeBuffer.prepare(MaxCommandSize);
+      const auto writeBufferView = std::span(
+        static_cast<std::byte*>(mutableBuffer.data()),
+        mutableBuffer.size());
 
-        SinkStream commandSink(writeBufferView);
+      const auto serializeBegin = network::CommandMetrics::Clock::now();
 
-        const auto streamOrigin = commandSink.GetCursor();
-        commandSink.Seek(streamOrigin + sizeof(protocol::MessageMagic));
+      SinkStream commandSink(writeBufferView);
 
-        // Write the message data.
-        supplier(commandSink);
+      const auto streamOrigin = commandSink.GetCursor();
+      commandSink.Seek(streamOrigin + sizeof(protocol::MessageMagic));
 
-        // Command size is the size of the whole command.
-        const size_t commandSize = commandSink.GetCursor();
+      // Write the message data.
+      supplier(commandSink);
 
-        if (debugOutgoingCommandData
-          && not IsMuted(commandId))
-        {
-          spdlog::debug("Write data for command '{}' (0x{:X}),\n\n"
-            "Command data size: {} \n"
-            "Data dump: \n\n{}\n",
-            GetCommandName(commandId),
-            static_cast<uint32_t>(commandId),
-            commandSize,
-            util::GenerateByteDump(
-              std::span(
-                static_cast<std::byte*>(mutableBuffer.data()) + sizeof(protocol::MessageMagic),
-                commandSize - sizeof(protocol::MessageMagic))));
-        }
+      // Command size is the size of the whole command.
+      const size_t commandSize = commandSink.GetCursor();
+
+      if (outgoingCommandDataDumps.Contains(static_cast<uint16_t>(commandId)))
+      {
+        SPDLOG_DEBUG("Write data for command '{}' (0x{:X}),\n\n"
+          "Command data size: {} \n"
+          "Data dump: \n\n{}\n",
+          GetCommandName(commandId),
+          static_cast<uint32_t>(commandId),
+          commandSize,
+          util::GenerateByteDump(
+            std::span(
+              static_cast<std::byte*>(mutableBuffer.data()) + sizeof(protocol::MessageMagic),
+              commandSize - sizeof(protocol::MessageMagic))));
+      }
 
-        // Traverse back the stream before the message data,
-        // and write the message magic.
-        commandSink.Seek(streamOrigin);
+      // Traverse back the stream before the message data,
+      // and write the message magic.
+      commandSink.Seek(streamOrigin);
 
-        // Write the message magic.
-        const protocol::MessageMagic magic{
-          .id = static_cast<uint16_t>(commandId),
-          .length = static_cast<uint16_t>(commandSize)};
+      // Write the message magic.
+      const protocol::MessageMagic magic{
+        .id = static_cast<uint16_t>(commandId),
+        .length = static_cast<uint16_t>(commandSize)};
 
-        commandSink.Write(encode_message_magic(magic));
-        writeBuffer.commit(magic.length);
+      commandSink.Write(encode_message_magic(magic));
+      writeBuffer.commit(magic.length);
 
-        if (debugCommands
-          && not IsMuted(commandId))
-        {
-          spdlog::debug("Sent command message '{}' (0x{:X})",
-          GetCommandName(commandId),
-          static_cast<uint32_t>(commandId));
-        }
+      _metrics.RecordOutbound(
+        magic.id,
+        magic.length,
+        network::CommandMetrics::Clock::now() - serializeBegin);
 
-        return commandSize;
-      });
-  }
-  catch (std::exception&)
+      if (debugCommands
+        && not IsMuted(commandId))
+      {
+        SPDLOG_DEBUG("Sent command message '{}' (0x{:X})",
+        GetCommandName(commandId),
+        static_cast<uint32_t>(commandId));
+      }
+
+      return commandSize;
+    });
+}
+
+void CommandServer::SetCommandDataDumps(
+  const std::vector<std::string>& incomingCommands,
+  const std::vector<std::string>& outgoingCommands)
+{
+  const auto resolve = [](const std::vector<std::string>& commandNames)
   {
-    // the client disconnected, todo dont use client ids, or dont
-  }
+    util::CommandIdSet commands;
+    for (const auto& commandName : commandNames)
+    {
+      const auto command = protocol::GetCommandByName(commandName);
+      if (not command)
+      {
+        spdlog::warn("Unknown command '{}' to dump the data of", commandName);
+        continue;
+      }
+
+      commands.Insert(static_cast<uint16_t>(*command));
+    }
+    return commands;
+  };
+
+  incomingCommandDataDumps = resolve(incomingCommands);
+  outgoingCommandDataDumps = resolve(outgoingCommands);
 }
 
 } // namespace server
@@ -24,6 +24,22 @@
 namespace server::protocol
 {
 
+void EncodedStructures::Append(const std::span<const std::byte> structure)
+{
+  data.insert(data.end(), structure.begin(), structure.end());
+  ++count;
+}
+
+void EncodedStructures::Write(const EncodedStructures& value, SinkStream& stream)
+{
+  stream.Write(value.data.data(), value.data.size());
+}
+
+void EncodedStructures::Read(EncodedStructures&, SourceStream&)
+{
+  throw std::runtime_error("Not implemented.");
+}
+
 void Item::Write(const Item& item, SinkStream& stream)
 {
   stream.Write(item.uid)
@@ -23,10 +23,15 @@ namespace server::protocol
 {
 
 void AcCmdCLLogin::Write(
-  const AcCmdCLLogin&,
-  SinkStream&)
+  const AcCmdCLLogin& command,
+  SinkStream& stream)
 {
-  throw std::runtime_error("Not implemented.");
+  stream.Write(command.constant0)
+    .Write(command.constant1)
+    .Write(command.loginId)
+    .Write(command.memberNo)
+    .Write(command.authKey)
+    .Write(command.val0);
 }
 
 void AcCmdCLLogin::Read(
@@ -52,10 +57,21 @@ void LobbyCommandLoginOK::SystemContent::Write(const SystemContent& command, Sin
 }
 
 void LobbyCommandLoginOK::SystemContent::Read(
-  SystemContent&,
-  SourceStream&)
+  SystemContent& command,
+  SourceStream& stream)
 {
-  throw std::runtime_error("Not implemented.");
+  uint8_t size{};
+  stream.Read(size);
+
+  command.values.clear();
+  for (size_t idx = 0; idx < size; ++idx)
+  {
+    uint32_t key{};
+    uint32_t value{};
+    stream.Read(key)
+      .Read(value);
+    command.values[key] = value;
+  }
 }
 
 void LobbyCommandLoginOK::Write(
@@ -195,10 +211,136 @@ void LobbyCommandLoginOK::Write(
 }
 
 void LobbyCommandLoginOK::Read(
-  LobbyCommandLoginOK&,
-  SourceStream&)
+  LobbyCommandLoginOK& command,
+  SourceStream& stream)
 {
-  throw std::runtime_error("Not implemented.");
+  stream.Read(command.lobbyTime.dwLowDateTime)
+    .Read(command.lobbyTime.dwHighDateTime)
+    .Read(command.member0);
+
+  // Profile
+  stream.Read(command.uid)
+    .Read(command.name)
+    .Read(command.notice)
+    .Read(command.gender)
+    .Read(command.introduction);
+
+  uint8_t equipmentItemCount{};
+  stream.Read(equipmentItemCount);
+  command.equipmentItems.resize(equipmentItemCount);
+  for (auto& item : command.equipmentItems)
+  {
+    stream.Read(item);
+  }
+
+  uint8_t expiredItemCount{};
+  stream.Read(expiredItemCount);
+  command.expiredItems.resize(expiredItemCount);
+  for (auto& item : command.expiredItems)
+  {
+    stream.Read(item);
+  }
+
+  //
+  stream.Read(command.level)
+    .Read(command.carrots)
+    .Read(command.val1)
+    .Read(command.role)
+    .Read(command.val3);
+
+  //
+  stream.Read(command.settings);
+
+  //
+  uint8_t missionCount{};
+  stream.Read(missionCount);
+  command.missions.resize(missionCount);
+  for (auto& val : command.missions)
+  {
+    stream.Read(val.id);
+
+    uint8_t progressCount{};
+    stream.Read(progressCount);
+    val.progress.resize(progressCount);
+    for (auto& nestedVal : val.progress)
+    {
+      stream.Read(nestedVal.id)
+        .Read(nestedVal.value);
+    }
+  }
+
+  stream.Read(command.val6);
+
+  stream.Read(command.ranchAddress)
+    .Read(command.ranchPort)
+    .Read(command.scramblingConstant);
+
+  stream.Read(command.character)
+    .Read(command.horse);
+
+  stream.Read(command.systemContent)
+    .Read(command.bitfield);
+
+  // Struct2
+  auto& struct1 = command.val9;
+  stream.Read(struct1.val0)
+    .Read(struct1.val1)
+    .Read(struct1.val2);
+
+  stream.Read(command.val10);
+
+  auto& managementSkills = command.managementSkills;
+  stream.Read(managementSkills.val0)
+    .Read(managementSkills.progress)
+    .Read(managementSkills.points);
+
+  auto& skillRanks = command.skillRanks;
+  uint8_t skillRankCount{};
+  stream.Read(skillRankCount);
+  skillRanks.values.resize(skillRankCount);
+  for (auto& value : skillRanks.values)
+  {
+    stream.Read(value.id)
+      .Read(value.rank);
+  }
+
+  auto& struct4 = command.val13;
+  uint8_t struct4Count{};
+  stream.Read(struct4Count);
+  struct4.values.resize(struct4Count);
+  for (auto& value : struct4.values)
+  {
+    stream.Read(value.val0)
+      .Read(value.val1)
+      .Read(value.val2);
+  }
+
+  stream.Read(command.val14);
+
+  // Guild
+  auto& struct5 = command.guild;
+  stream.Read(struct5.uid)
+    .Read(struct5.val1)
+    .Read(struct5.val2)
+    .Read(struct5.name)
+    .Read(struct5.guildRole)
+    .Read(struct5.val5)
+    .Read(struct5.val6);
+
+  stream.Read(command.val16);
+
+  // Rent
+  auto& struct6 = command.val17;
+  stream.Read(struct6.mountUid)
+    .Read(struct6.val1)
+    .Read(struct6.val2);
+
+  stream.Read(command.val18)
+    .Read(command.val19)
+    .Read(command.val20);
+
+  // Pet
+  stream.Read(command.pet);
 }
 
 void AcCmdCLLoginCancel::Write(
@@ -209,10 +351,10 @@ void AcCmdCLLoginCancel::Write(
 }
 
 void AcCmdCLLoginCancel::Read(
-  AcCmdCLLoginCancel&,
-  SourceStream&)
+  AcCmdCLLoginCancel& command,
+  SourceStream& stream)
 {
-  throw std::runtime_error("Not implemented.");
+  stream.Read(command.reason);
 }
 
 void AcCmdCLShowInventory::Write(
@@ -233,22 +375,16 @@ void LobbyCommandShowInventoryOK::Write(
   const LobbyCommandShowInventoryOK& command,
   SinkStream& stream)
 {
-  if (command.items.size() > 255)
+  if (command.items.count > 255)
     throw std::runtime_error("Item count greater than protocol max (255)");
-  if (command.horses.size() > 255)
+  if (command.horses.count > 255)
     throw std::runtime_error("Horse count greater than protocol max (255)");
 
-  stream.Write(static_cast<uint8_t>(command.items.size()));
-  for (const auto& item : command.items)
-  {
-    stream.Write(item);
-  }
+  stream.Write(static_cast<uint8_t>(command.items.count))
+    .Write(command.items);
 
-  stream.Write(static_cast<uint8_t>(command.horses.size()));
-  for (const auto& horse : command.horses)
-  {
-    stream.Write(horse);
-  }
+  stream.Write(static_cast<uint8_t>(command.horses.count))
+    .Write(command.horses);
 }
 
 void LobbyCommandShowInventoryOK::Read(
@@ -273,10 +409,12 @@ void LobbyCommandCreateNicknameNotify::Read(
 }
 
 void AcCmdCLCreateNickname::Write(
-  const AcCmdCLCreateNickname&,
-  SinkStream&)
+  const AcCmdCLCreateNickname& command,
+  SinkStream& stream)
 {
-  throw std::runtime_error("Not implemented.");
+  stream.Write(command.nickname)
+    .Write(command.character)
+    .Write(command.requestedHorseTid);
 }
 
 void AcCmdCLCreateNickname::Read(
@@ -537,10 +675,18 @@ void LobbyCommandRoomListOK::Read(
 }
 
 void AcCmdCLMakeRoom::Write(
-  const AcCmdCLMakeRoom&,
-  SinkStream&)
+  const AcCmdCLMakeRoom& command,
+  SinkStream& stream)
 {
-  throw std::runtime_error("Not implemented.");
+  stream.Write(command.name)
+    .Write(command.password)
+    .Write(command.playerCount)
+    .Write(command.gameMode)
+    .Write(command.teamMode)
+    .Write(command.missionId)
+    .Write(command.unk3)
+    .Write(command.bitset)
+    .Write(command.unk4);
 }
 
 void AcCmdCLMakeRoom::Read(
@@ -570,10 +716,15 @@ void AcCmdCLMakeRoomOK::Write(
 }
 
 void AcCmdCLMakeRoomOK::Read(
-  AcCmdCLMakeRoomOK&,
-  SourceStream&)
+  AcCmdCLMakeRoomOK& command,
+  SourceStream& stream)
 {
-  throw std::runtime_error("Not implemented.");
+  stream.Read(command.roomUid)
+    .Read(command.oneTimePassword)
+    .Read(command.raceServerAddress)
+    .Read(command.raceServerPort)
+    .Read(command.unk2);
+  command.raceServerAddress = ntohl(command.raceServerAddress);
 }
 
 void AcCmdCLMakeRoomCancel::Write(
@@ -591,10 +742,12 @@ void AcCmdCLMakeRoomCancel::Read(
 }
 
 void AcCmdCLEnterRoom::Write(
-  const AcCmdCLEnterRoom&,
-  SinkStream&)
+  const AcCmdCLEnterRoom& command,
+  SinkStream& stream)
 {
-  throw std::runtime_error("Not implemented.");
+  stream.Write(command.roomUid)
+    .Write(command.password)
+    .Write(command.member3);
 }
 
 void AcCmdCLEnterRoom::Read(
@@ -618,10 +771,15 @@ void AcCmdCLEnterRoomOK::Write(
 }
 
 void AcCmdCLEnterRoomOK::Read(
-  AcCmdCLEnterRoomOK&,
-  SourceStream&)
+  AcCmdCLEnterRoomOK& command,
+  SourceStream& stream)
 {
-  throw std::runtime_error("Not implemented.");
+  stream.Read(command.roomUid)
+    .Read(command.oneTimePassword)
+    .Read(command.raceServerAddress)
+    .Read(command.raceServerPort)
+    .Read(command.member6);
+  command.raceServerAddress = ntohl(command.raceServerAddress);
 }
 
 void AcCmdCLEnterRoomCancel::Write(
@@ -741,10 +899,12 @@ void AcCmdCLRequestDailyQuestListOK::Read(
 }
 
 void AcCmdCLEnterRanch::Write(
-  const AcCmdCLEnterRanch&,
-  SinkStream&)
+  const AcCmdCLEnterRanch& command,
+  SinkStream& stream)
 {
-  throw std::runtime_error("Not implemented.");
+  stream.Write(command.rancherUid)
+    .Write(command.unk1)
+    .Write(command.unk2);
 }
 
 void AcCmdCLEnterRanch::Read(
@@ -767,10 +927,14 @@ void AcCmdCLEnterRanchOK::Write(
 }
 
 void AcCmdCLEnterRanchOK::Read(
-  AcCmdCLEnterRanchOK&,
-  SourceStream&)
+  AcCmdCLEnterRanchOK& command,
+  SourceStream& stream)
 {
-  throw std::runtime_error("Not implemented.");
+  stream.Read(command.rancherUid)
+    .Read(command.otp)
+    .Read(command.ranchAddress)
+    .Read(command.ranchPort);
+  command.ranchAddress = ntohl(command.ranchAddress);
 }
 
 void AcCmdCLEnterRanchCancel::Write(
@@ -905,7 +1069,7 @@ void AcCmdCLHeartbeat::Write(
   const AcCmdCLHeartbeat&,
   SinkStream&)
 {
-  throw std::runtime_error("Not implemented.");
+  // Empty.
 }
 
 void AcCmdCLHeartbeat::Read(
@@ -1071,7 +1235,7 @@ void AcCmdCLEnterRanchRandomly::Write(
   const AcCmdCLEnterRanchRandomly&,
   SinkStream&)
 {
-  throw std::runtime_error("Not implemented");
+  // Empty.
 }
 
 void AcCmdCLEnterRanchRandomly::Read(
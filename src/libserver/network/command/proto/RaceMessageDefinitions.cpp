@@ -94,10 +94,12 @@ void WriteRoomDescription(SinkStream& stream, const RoomDescription& roomDescrip
 }
 
 void AcCmdCREnterRoom::Write(
-  const AcCmdCREnterRoom&,
-  SinkStream&)
+  const AcCmdCREnterRoom& command,
+  SinkStream& stream)
 {
-  throw std::logic_error("Not implemented.");
+  stream.Write(command.characterUid)
+    .Write(command.oneTimePassword)
+    .Write(command.roomUid);
 }
 
 void AcCmdCREnterRoom::Read(
@@ -311,7 +313,7 @@ void AcCmdCRLeaveRoom::Write(
   const AcCmdCRLeaveRoom&,
   SinkStream&)
 {
-  throw std::logic_error("Not implemented.");
+  // Empty.
 }
 
 void AcCmdCRLeaveRoom::Read(
@@ -350,10 +352,14 @@ void AcCmdCRLeaveRoomNotify::Read(
 }
 
 void AcCmdCRStartRace::Write(
-  const AcCmdCRStartRace&,
-  SinkStream&)
+  const AcCmdCRStartRace& command,
+  SinkStream& stream)
 {
-  throw std::logic_error("Not implemented.");
+  stream.Write(static_cast<uint8_t>(command.unk0.size()));
+  for (const auto& element : command.unk0)
+  {
+    stream.Write(element);
+  }
 }
 
 void AcCmdCRStartRace::Read(
@@ -550,7 +556,7 @@ void AcCmdCRLoadingComplete::Write(
   const AcCmdCRLoadingComplete&,
   SinkStream&)
 {
-  throw std::logic_error("Not implemented.");
+  // Empty.
 }
 
 void AcCmdCRLoadingComplete::Read(
@@ -609,7 +615,7 @@ void AcCmdCRReadyRace::Write(
   const AcCmdCRReadyRace&,
   SinkStream&)
 {
-  throw std::runtime_error("Not implemented");
+  // Empty.
 }
 
 void AcCmdCRReadyRace::Read(
@@ -628,10 +634,11 @@ void AcCmdCRReadyRaceNotify::Write(
 }
 
 void AcCmdCRReadyRaceNotify::Read(
-  AcCmdCRReadyRaceNotify&,
-  SourceStream&)
+  AcCmdCRReadyRaceNotify& command,
+  SourceStream& stream)
 {
-  throw std::runtime_error("Not implemented");
+  stream.Read(command.characterUid)
+    .Read(command.isReady);
 }
 
 void AcCmdUserRaceCountdown::Write(
@@ -649,10 +656,12 @@ void AcCmdUserRaceCountdown::Read(
 }
 
 void AcCmdUserRaceFinal::Write(
-  const AcCmdUserRaceFinal&,
-  SinkStream&)
+  const AcCmdUserRaceFinal& command,
+  SinkStream& stream)
 {
-  throw std::runtime_error("Not implemented");
+  stream.Write(command.oid)
+    .Write(static_cast<uint32_t>(command.courseTime.count()))
+    .Write(command.member3);
 }
 
 void AcCmdUserRaceFinal::Read(
@@ -684,10 +693,29 @@ void AcCmdUserRaceFinalNotify::Read(
 }
 
 void AcCmdCRRaceResult::Write(
-  const AcCmdCRRaceResult&,
-  SinkStream&)
+  const AcCmdCRRaceResult& command,
+  SinkStream& stream)
 {
-  throw std::runtime_error("Not implemented");
+  stream.Write(command.member1)
+    .Write(command.member2)
+    .Write(command.member3)
+    .Write(command.member4)
+    .Write(command.member5)
+    .Write(command.member6)
+    .Write(command.member7)
+    .Write(command.member8)
+    .Write(command.member9);
+
+  stream.Write(static_cast<uint8_t>(command.member10.size()));
+  for (const auto& value : command.member10)
+  {
+    stream.Write(value);
+  }
+
+  stream.Write(command.member11)
+    .Write(command.member12)
+    .Write(command.member13)
+    .Write(command.member14);
 }
 
 void AcCmdCRRaceResult::Read(
@@ -1168,10 +1196,18 @@ void AcCmdCRRelayCommandNotify::Read(
 }
 
 void AcCmdCRRelay::Write(
-  const AcCmdCRRelay&,
-  SinkStream&)
+  const AcCmdCRRelay& command,
+  SinkStream& stream)
 {
-  throw std::runtime_error("Not implemented");
+  stream.Write(command.oid)
+    .Write(command.member2)
+    .Write(command.member3);
+
+  stream.Write(static_cast<uint16_t>(command.data.size()));
+  for (const uint8_t datum : command.data)
+  {
+    stream.Write(datum);
+  }
 }
 
 void AcCmdCRRelay::Read(
@@ -1208,10 +1244,21 @@ void AcCmdCRRelayNotify::Write(
 }
 
 void AcCmdCRRelayNotify::Read(
-  AcCmdCRRelayNotify&,
-  SourceStream&)
+  AcCmdCRRelayNotify& command,
+  SourceStream& stream)
 {
-  throw std::runtime_error("Not implemented");
+  stream.Read(command.oid)
+    .Read(command.member2)
+    .Read(command.member3);
+
+  uint16_t bufferSize;
+  stream.Read(bufferSize);
+  command.data.resize(bufferSize);
+
+  for (uint8_t& datum : command.data)
+  {
+    stream.Read(datum);
+  }
 }
 
 void AcCmdRCTeamSpurGauge::Write(
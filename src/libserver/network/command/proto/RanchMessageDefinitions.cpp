@@ -136,10 +136,12 @@ void RanchCommandMountFamilyTreeCancel::Read(
 }
 
 void AcCmdCREnterRanch::Write(
-  const AcCmdCREnterRanch&,
-  SinkStream&)
+  const AcCmdCREnterRanch& command,
+  SinkStream& stream)
 {
-  throw std::runtime_error("Not implemented.");
+  stream.Write(command.characterUid)
+    .Write(command.otp)
+    .Write(command.rancherUid);
 }
 
 void AcCmdCREnterRanch::Read(
@@ -213,10 +215,57 @@ void AcCmdCREnterRanchOK::Write(
 }
 
 void AcCmdCREnterRanchOK::Read(
-  AcCmdCREnterRanchOK&,
-  SourceStream&)
+  AcCmdCREnterRanchOK& command,
+  SourceStream& stream)
 {
-  throw std::runtime_error("Not implemented.");
+  stream.Read(command.rancherUid)
+    .Read(command.rancherName)
+    .Read(command.ranchName);
+
+  // Read the ranch horses
+  uint8_t ranchHorseCount{};
+  stream.Read(ranchHorseCount);
+  command.horses.resize(ranchHorseCount);
+  for (auto& horse : command.horses)
+  {
+    stream.Read(horse);
+  }
+
+  // Read the ranch characters
+  uint8_t ranchCharacterCount{};
+  stream.Read(ranchCharacterCount);
+  command.characters.resize(ranchCharacterCount);
+  for (auto& character : command.characters)
+  {
+    stream.Read(character);
+  }
+
+  stream.Read(command.member6)
+    .Read(command.scramblingConstant)
+    .Read(command.ranchProgress);
+
+  // Read the ranch housing
+  uint8_t housingCount{};
+  stream.Read(housingCount);
+  command.housing.resize(housingCount);
+  for (auto& housing : command.housing)
+  {
+    stream.Read(housing);
+  }
+
+  stream.Read(command.horseSlots)
+    .Read(command.member11)
+    .Read(command.bitset)
+    .Read(command.incubatorSlots)
+    .Read(command.incubatorUseCount);
+
+  for (auto& egg : command.incubator)
+  {
+    stream.Read(egg);
+  }
+
+  stream.Read(command.league)
+    .Read(command.member17);
 }
 
 void RanchCommandEnterRanchCancel::Write(
@@ -336,10 +385,31 @@ void AcCmdCRRanchSnapshot::PartialSpatial::Read(
 }
 
 void AcCmdCRRanchSnapshot::Write(
-  const AcCmdCRRanchSnapshot&,
-  SinkStream&)
+  const AcCmdCRRanchSnapshot& command,
+  SinkStream& stream)
 {
-  throw std::runtime_error("Not implemented.");
+  stream.Write(command.type);
+
+  switch (command.type)
+  {
+    case Full:
+      {
+        stream.Write(command.full);
+        break;
+      }
+    case Partial:
+      {
+        stream.Write(command.partial);
+        break;
+      }
+    default:
+      {
+        throw std::runtime_error(
+          std::format(
+            "Update type {} not implemented",
+            static_cast<uint32_t>(command.type)));
+      }
+  }
 }
 
 void AcCmdCRRanchSnapshot::Read(
@@ -398,10 +468,30 @@ void RanchCommandRanchSnapshotNotify::Write(
 }
 
 void RanchCommandRanchSnapshotNotify::Read(
-  RanchCommandRanchSnapshotNotify&,
-  SourceStream&)
+  RanchCommandRanchSnapshotNotify& command,
+  SourceStream& stream)
 {
-  throw std::runtime_error("Not implemented.");
+  stream.Read(command.ranchIndex)
+    .Read(command.type);
+
+  switch (command.type)
+  {
+    case AcCmdCRRanchSnapshot::Full:
+      {
+        stream.Read(command.full);
+        break;
+      }
+    case AcCmdCRRanchSnapshot::Partial:
+      {
+        stream.Read(command.partial);
+        break;
+      }
+    default:
+      {
+        throw std::runtime_error(
+          std::format("Update type {} not implemented", static_cast<uint32_t>(command.type)));
+      }
+  }
 }
 
 void AcCmdCRRanchCmdAction::Write(
@@ -513,7 +603,7 @@ void AcCmdCRHeartbeat::Write(
   const AcCmdCRHeartbeat&,
   SinkStream&)
 {
-  throw std::runtime_error("Not implemented.");
+  // Empty.
 }
 
 void AcCmdCRHeartbeat::Read(
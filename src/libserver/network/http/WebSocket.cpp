@@ -4,7 +4,302 @@
 
 #include "libserver/network/http/WebSocket.hpp"
 
+#include <spdlog/spdlog.h>
+
+#include <deque>
+#include <format>
+
 namespace server::websocket
 {
 
-} // namespace server::websocket
\ No newline at end of file
+namespace http = beast::http;
+
+namespace
+{
+
+//! Time limit of an HTTP request and response.
+constexpr std::chrono::seconds HttpTimeout{10};
+//! Maximum count of the messages queued for a WebSocket session.
+constexpr size_t MaxQueuedMessages = 64;
+
+} // anon namespace
+
+//! An HTTP connection serving a single request.
+class HttpSession final
+  : public std::enable_shared_from_this<HttpSession>
+{
+public:
+  HttpSession(asio::ip::tcp::socket&& socket, Server& server)
+    : _stream(std::move(socket))
+    , _server(server)
+  {
+  }
+
+  void Begin()
+  {
+    _stream.expires_after(HttpTimeout);
+    http::async_read(
+      _stream,
+      _buffer,
+      _request,
+      [self = shared_from_this()](const beast::error_code& error, size_t)
+      {
+        if (error)
+          return;
+        self->OnRequest();
+      });
+  }
+
+private:
+  void OnRequest()
+  {
+    if (beast::websocket::is_upgrade(_request))
+    {
+      // Cancel the HTTP timeout, the WebSocket session has its own.
+      _stream.expires_never();
+      _server.OnUpgrade(_stream.release_socket(), std::move(_request));
+      return;
+    }
+
+    Response response;
+    if (_request.method() != http::verb::get)
+    {
+      response.status = http::status::method_not_allowed;
+    }
+    else
+    {
+      try
+      {
+        const auto target = _request.target();
+        response = _server._requestHandler(std::string_view(target.data(), target.size()));
+      }
+      catch (const std::exception& x)
+      {
+        spdlog::error("Unhandled exception handling HTTP request: {}", x.what());
+        response = Response{};
+        response.status = http::status::internal_server_error;
+      }
+    }
+
+    _response.result(response.status);
+    _response.version(_request.version());
+    _response.set(http::field::content_type, response.contentType);
+    _response.keep_alive(false);
+    _response.body() = std::move(response.body);
+    _response.prepare_payload();
+
+    http::async_write(
+      _stream,
+      _response,
+      [self = shared_from_this()](beast::error_code error, size_t)
+      {
+        self->_stream.socket().shutdown(asio::ip::tcp::socket::shutdown_send, error);
+      });
+  }
+
+  beast::tcp_stream _stream;
+  beast::flat_buffer _buffer;
+  http::request<http::string_body> _request;
+  http::response<http::string_body> _response;
+  Server& _server;
+};
+
+//! A WebSocket session receiving the broadcast messages.
+class Session final
+  : public std::enable_shared_from_this<Session>
+{
+public:
+  Session(asio::ip::tcp::socket&& socket, Server& server)
+    : _stream(std::move(socket))
+    , _server(server)
+  {
+  }
+
+  void Begin(http::request<http::string_body>&& request)
+  {
+    _stream.set_option(
+      beast::websocket::stream_base::timeout::suggested(beast::role_type::server));
+    _stream.text(true);
+
+    _stream.async_accept(
+      request,
+      [self = shared_from_this()](const beast::error_code& error)
+      {
+        if (error)
+          return;
+
+        self->_server.OnSessionOpened(self);
+        self->ReadLoop();
+      });
+  }
+
+  void Send(const std::shared_ptr<const std::string>& message)
+  {
+    if (_writeQueue.size() >= MaxQueuedMessages)
+      return;
+
+    _writeQueue.emplace_back(message);
+    if (_writeQueue.size() == 1)
+      WriteLoop();
+  }
+
+private:
+  void ReadLoop()
+  {
+    // Received messages are discarded, reading keeps the control frames flowing
+    // and detects the closure of the session.
+    _stream.async_read(
+      _readBuffer,
+      [self = shared_from_this()](const beast::error_code& error, size_t size)
+      {
+        if (error)
+        {
+          self->_server.OnSessionClosed(self);
+          return;
+        }
+
+        self->_readBuffer.consume(size);
+        self->ReadLoop();
+      });
+  }
+
+  void WriteLoop()
+  {
+    _stream.async_write(
+      asio::buffer(*_writeQueue.front()),
+      [self = shared_from_this()](const beast::error_code& error, size_t)
+      {
+        if (error)
+        {
+          self->_writeQueue.clear();
+          return;
+        }
+
+        self->_writeQueue.pop_front();
+        if (not self->_writeQueue.empty())
+          self->WriteLoop();
+      });
+  }
+
+  beast::websocket::stream<beast::tcp_stream> _stream;
+  beast::flat_buffer _readBuffer;
+  std::deque<std::shared_ptr<const std::string>> _writeQueue;
+  Server& _server;
+};
+
+Server::Server(RequestHandler requestHandler)
+  : _acceptor(_ioContext)
+  , _requestHandler(std::move(requestHandler))
+{
+}
+
+Server::~Server()
+{
+  // Sessions keep references to the server in their handlers.
+  _sessions.clear();
+}
+
+void Server::Begin(const asio::ip::address& address, uint16_t port)
+{
+  const asio::ip::tcp::endpoint endpoint(address, port);
+
+  try
+  {
+    _acceptor.open(endpoint.protocol());
+    _acceptor.set_option(asio::socket_base::reuse_address(true));
+    _acceptor.bind(endpoint);
+    _acceptor.listen();
+  }
+  catch (const std::exception& x)
+  {
+    throw std::runtime_error(
+      std::format(
+        "Exception while trying to host HTTP server on {}:{}: {}",
+        address.to_string(),
+        port,
+        x.what()));
+  }
+
+  _port.store(_acceptor.local_endpoint().port(), std::memory_order::release);
+
+  AcceptLoop();
+
+  try
+  {
+    _ioContext.run();
+  }
+  catch (const std::exception& x)
+  {
+    throw std::runtime_error(
+      std::format(
+        "Exception in HTTP server IO context: {}",
+        x.what()));
+  }
+}
+
+void Server::End()
+{
+  _ioContext.stop();
+}
+
+void Server::Broadcast(std::string message)
+{
+  asio::post(
+    _ioContext,
+    [this, message = std::make_shared<const std::string>(std::move(message))]()
+    {
+      for (const auto& session : _sessions)
+        session->Send(message);
+    });
+}
+
+uint16_t Server::GetPort() const
+{
+  return _port.load(std::memory_order::acquire);
+}
+
+size_t Server::GetSessionCount() const
+{
+  return _sessionCount.load(std::memory_order::relaxed);
+}
+
+void Server::AcceptLoop()
+{
+  _acceptor.async_accept(
+    [this](const boost::system::error_code& error, asio::ip::tcp::socket socket)
+    {
+      if (error)
+      {
+        if (error == asio::error::operation_aborted)
+          return;
+        spdlog::warn("Failed to accept HTTP connection: {}", error.message());
+      }
+      else
+      {
+        std::make_shared<HttpSession>(std::move(socket), *this)->Begin();
+      }
+
+      AcceptLoop();
+    });
+}
+
+void Server::OnUpgrade(
+  asio::ip::tcp::socket&& socket,
+  http::request<http::string_body>&& request)
+{
+  std::make_shared<Session>(std::move(socket), *this)->Begin(std::move(request));
+}
+
+void Server::OnSessionOpened(const std::shared_ptr<Session>& session)
+{
+  _sessions.emplace(session);
+  _sessionCount.store(_sessions.size(), std::memory_order::relaxed);
+}
+
+void Server::OnSessionClosed(const std::shared_ptr<Session>& session)
+{
+  _sessions.erase(session);
+  _sessionCount.store(_sessions.size(), std::memory_order::relaxed);
+}
+
+} // namespace server::websocket
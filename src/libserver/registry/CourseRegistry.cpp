@@ -22,6 +22,7 @@
 #include <spdlog/spdlog.h>
 #include <yaml-cpp/yaml.h>
 
+#include <ranges>
 #include <stdexcept>
 
 namespace server::registry
@@ -116,6 +117,93 @@ uint32_t ReadItemTypeInfo(
   return section["id"].as<uint32_t>();
 }
 
+void BuildSpawnerGrid(Course::MapLayout& layout)
+{
+  auto& grid = layout.spawnerGrid;
+  if (layout.itemSpawners.empty())
+    return;
+
+  const auto [minX, maxX] = std::ranges::minmax(
+    layout.itemSpawners | std::views::transform([](const auto& spawner)
+    {
+      return spawner.position[0];
+    }));
+  const auto [minZ, maxZ] = std::ranges::minmax(
+    layout.itemSpawners | std::views::transform([](const auto& spawner)
+    {
+      return spawner.position[2];
+    }));
+
+  grid.originX = minX;
+  grid.originZ = minZ;
+  grid.columns = static_cast<uint32_t>((maxX - minX) / Course::MapLayout::ItemSpawnDistance) + 1;
+  grid.rows = static_cast<uint32_t>((maxZ - minZ) / Course::MapLayout::ItemSpawnDistance) + 1;
+
+  const auto getCell = [&grid](const Course::MapLayout::ItemSpawner& spawner)
+  {
+    const auto column = static_cast<uint32_t>(
+      (spawner.position[0] - grid.originX) / Course::MapLayout::ItemSpawnDistance);
+    const auto row = static_cast<uint32_t>(
+      (spawner.position[2] - grid.originZ) / Course::MapLayout::ItemSpawnDistance);
+    return row * grid.columns + column;
+  };
+
+  // Count the spawners per cell and turn the counts into offsets.
+  grid.cellOffsets.assign(grid.columns * grid.rows + 1, 0);
+  for (const auto& spawner : layout.itemSpawners)
+    ++grid.cellOffsets[getCell(spawner) + 1];
+  for (std::size_t cell = 1; cell < grid.cellOffsets.size(); ++cell)
+    grid.cellOffsets[cell] += grid.cellOffsets[cell - 1];
+
+  grid.spawnerIndices.resize(layout.itemSpawners.size());
+  auto cellCursors = grid.cellOffsets;
+  for (uint32_t spawnerIdx = 0; spawnerIdx < layout.itemSpawners.size(); ++spawnerIdx)
+  {
+    const auto cell = getCell(layout.itemSpawners[spawnerIdx]);
+    grid.spawnerIndices[cellCursors[cell]++] = spawnerIdx;
+  }
+}
+
+Course::MapLayout BuildMapLayout(
+  uint32_t mapBlockId,
+  const Course::MapBlockInfo& mapBlock,
+  const Course::GameModeInfo& gameMode,
+  const util::IdTable<Course::DeckItemInfo>& deckItemInfo)
+{
+  Course::MapLayout layout;
+
+  // Spawn items based on map positions and game mode allowed deck IDs.
+  for (const uint32_t usedDeckItemId : gameMode.usedDeckItemIds)
+  {
+    const auto deckItem = deckItemInfo.Find(usedDeckItemId);
+    if (deckItem == nullptr)
+    {
+      spdlog::warn(
+        "Map block {} uses unknown deck item {}, skipping its spawners",
+        mapBlockId,
+        usedDeckItemId);
+      continue;
+    }
+
+    for (const auto& mapDeckItemInstance : mapBlock.deckItems)
+    {
+      if (mapDeckItemInstance.deckId != usedDeckItemId)
+        continue;
+
+      layout.itemSpawners.emplace_back(Course::MapLayout::ItemSpawner{
+        .deckId = usedDeckItemId,
+        .position = {
+          mapDeckItemInstance.position[0] + mapBlock.offset[0],
+          mapDeckItemInstance.position[1] + mapBlock.offset[1],
+          mapDeckItemInstance.position[2] + mapBlock.offset[2]},
+        .itemTypes = deckItem->itemTypes});
+    }
+  }
+
+  BuildSpawnerGrid(layout);
+  return layout;
+}
+
 } // namespace
 
 CourseRegistry::CourseRegistry()
@@ -131,6 +219,11 @@ void CourseRegistry::ReadConfig(
   if (not coursesSection)
     throw std::runtime_error("Missing courses section");
 
+  std::vector<std::pair<uint32_t, Course::GameModeInfo>> gameModeInfo;
+  std::vector<std::pair<uint32_t, Course::MapBlockInfo>> mapBlockInfo;
+  std::vector<std::pair<uint32_t, Course::DeckItemInfo>> deckItemInfo;
+  std::vector<std::pair<uint32_t, Course::ItemTypeInfo>> itemTypeInfo;
+
   // Game modes
   {
     const auto gameModeInfosSection = coursesSection["gameModeInfo"];
@@ -145,7 +238,7 @@ void CourseRegistry::ReadConfig(
     {
       Course::GameModeInfo gameMode;
       const auto type = ReadGameModeInfo(gameModeInfoSection, gameMode);
-      _gameModeInfo.emplace(type, gameMode);
+      gameModeInfo.emplace_back(type, std::move(gameMode));
     }
   }
 
@@ -163,7 +256,7 @@ void CourseRegistry::ReadConfig(
     {
       Course::MapBlockInfo mapBlock;
       const auto id = ReadMapBlockInfo(mapBlockInfoSection, mapBlock);
-      _mapBlockInfo.emplace(id, mapBlock);
+      mapBlockInfo.emplace_back(id, std::move(mapBlock));
     }
   }
 
@@ -179,7 +272,7 @@ void CourseRegistry::ReadConfig(
         {
           Course::DeckItemInfo deckItem;
           const auto id = ReadDeckItemInfo(deckItemInfoSection, deckItem);
-          _deckItemInfo.emplace(id, deckItem);
+          deckItemInfo.emplace_back(id, std::move(deckItem));
         }
       }
     }
@@ -197,51 +290,141 @@ void CourseRegistry::ReadConfig(
         {
           Course::ItemTypeInfo itemType;
           const auto id = ReadItemTypeInfo(itemTypeInfoSection, itemType);
-          _itemTypeInfo.emplace(id, itemType);
+          itemTypeInfo.emplace_back(id, std::move(itemType));
         }
       }
     }
   }
 
+  Snapshot snapshot{
+    .gameModeInfo = util::IdTable<Course::GameModeInfo>(std::move(gameModeInfo)),
+    .deckItemInfo = util::IdTable<Course::DeckItemInfo>(std::move(deckItemInfo)),
+    .itemTypeInfo = util::IdTable<Course::ItemTypeInfo>(std::move(itemTypeInfo))};
+
+  // Precompute the layouts of every map in every game mode,
+  // so that starting a race does not have to walk the course data.
+  const auto gameModeTypes = snapshot.gameModeInfo.GetIds();
+  const auto gameModes = snapshot.gameModeInfo.GetValues();
+  for (auto& [id, mapBlock] : mapBlockInfo)
+  {
+    std::vector<std::pair<uint32_t, Course::MapLayout>> layouts;
+    for (std::size_t idx = 0; idx < gameModes.size(); ++idx)
+    {
+      layouts.emplace_back(
+        gameModeTypes[idx],
+        BuildMapLayout(id, mapBlock, gameModes[idx], snapshot.deckItemInfo));
+    }
+
+    mapBlock.layouts = util::IdTable<Course::MapLayout>(std::move(layouts));
+  }
+
+  snapshot.mapBlockInfo = util::IdTable<Course::MapBlockInfo>(std::move(mapBlockInfo));
+
+  const auto gameModeCount = snapshot.gameModeInfo.Size();
+  const auto mapBlockCount = snapshot.mapBlockInfo.Size();
+  const auto deckItemCount = snapshot.deckItemInfo.Size();
+  const auto itemTypeCount = snapshot.itemTypeInfo.Size();
+  const auto version = _snapshot.Publish(std::move(snapshot));
+
   spdlog::info(
-    "Course registry loaded {} game modes, {} maps, {} deck items and {} item types",
-    _gameModeInfo.size(),
-    _mapBlockInfo.size(),
-    _deckItemInfo.size(),
-    _itemTypeInfo.size());
+    "Course registry loaded {} game modes, {} maps, {} deck items and {} item types (version {})",
+    gameModeCount,
+    mapBlockCount,
+    deckItemCount,
+    itemTypeCount,
+    version);
+}
+
+CourseRegistry::View CourseRegistry::Pin() const noexcept
+{
+  return _snapshot.Pin();
 }
 
-const Course::GameModeInfo& CourseRegistry::GetCourseGameModeInfo(
-  uint8_t type)
+// Estimates of the heap size owned by the course infos, found by the ID tables through ADL.
+
+std::size_t EstimateHeapSize(const Course::GameModeInfo& info) noexcept
+{
+  return util::EstimateHeapSize(info.usedDeckItemIds) + util::EstimateHeapSize(info.mapPool);
+}
+
+std::size_t EstimateHeapSize(const Course::MapLayout::ItemSpawner& spawner) noexcept
 {
-  const auto gameModeInfo = _gameModeInfo.find(type);
-  if (gameModeInfo == _gameModeInfo.cend())
+  return util::EstimateHeapSize(spawner.itemTypes);
+}
+
+std::size_t EstimateHeapSize(const Course::MapLayout& layout) noexcept
+{
+  return util::EstimateHeapSize(layout.itemSpawners)
+    + util::EstimateHeapSize(layout.spawnerGrid.cellOffsets)
+    + util::EstimateHeapSize(layout.spawnerGrid.spawnerIndices);
+}
+
+std::size_t EstimateHeapSize(const Course::MapBlockInfo& info) noexcept
+{
+  return util::EstimateHeapSize(info.deckItems) + util::EstimateHeapSize(info.layouts);
+}
+
+std::size_t EstimateHeapSize(const Course::DeckItemInfo& info) noexcept
+{
+  return util::EstimateHeapSize(info.itemTypes);
+}
+
+util::MemoryUsage CourseRegistry::GetMemoryUsage() const
+{
+  const auto snapshot = Pin();
+  return util::MemoryUsage{
+    .count = snapshot->gameModeInfo.Size()
+      + snapshot->mapBlockInfo.Size()
+      + snapshot->deckItemInfo.Size()
+      + snapshot->itemTypeInfo.Size(),
+    .bytes = sizeof(Snapshot)
+      + util::EstimateHeapSize(snapshot->gameModeInfo)
+      + util::EstimateHeapSize(snapshot->mapBlockInfo)
+      + util::EstimateHeapSize(snapshot->deckItemInfo)
+      + util::EstimateHeapSize(snapshot->itemTypeInfo)};
+}
+
+const Course::GameModeInfo& CourseRegistry::Snapshot::GetCourseGameModeInfo(
+  uint8_t type) const
+{
+  const auto info = gameModeInfo.Find(type);
+  if (info == nullptr)
     throw std::runtime_error("Invalid course game mode");
-  return gameModeInfo->second;
+  return *info;
 }
 
-const Course::MapBlockInfo& CourseRegistry::GetMapBlockInfo(uint32_t id)
+const Course::MapBlockInfo& CourseRegistry::Snapshot::GetMapBlockInfo(uint32_t id) const
 {
-  const auto mapBlockInfo = _mapBlockInfo.find(id);
-  if (mapBlockInfo == _mapBlockInfo.cend())
+  const auto info = mapBlockInfo.Find(id);
+  if (info == nullptr)
     throw std::runtime_error("Invalid course map block");
-  return mapBlockInfo->second;
+  return *info;
 }
  
-const Course::DeckItemInfo& CourseRegistry::GetDeckItemInfo(uint32_t deckId)
+const Course::DeckItemInfo& CourseRegistry::Snapshot::GetDeckItemInfo(uint32_t deckId) const
 {
-  const auto deckItemInfo = _deckItemInfo.find(deckId);
-  if (deckItemInfo == _deckItemInfo.cend())
+  const auto info = deckItemInfo.Find(deckId);
+  if (info == nullptr)
     throw std::runtime_error("Invalid deck item ID");
-  return deckItemInfo->second;
+  return *info;
 }
 
-const Course::ItemTypeInfo& CourseRegistry::GetItemTypeInfo(uint32_t itemTypeId)
+const Course::ItemTypeInfo& CourseRegistry::Snapshot::GetItemTypeInfo(uint32_t itemTypeId) const
 {
-  const auto itemTypeInfo = _itemTypeInfo.find(itemTypeId);
-  if (itemTypeInfo == _itemTypeInfo.cend())
+  const auto info = itemTypeInfo.Find(itemTypeId);
+  if (info == nullptr)
     throw std::runtime_error("Invalid item type ID");
-  return itemTypeInfo->second;
+  return *info;
+}
+
+const Course::MapLayout& CourseRegistry::Snapshot::GetMapLayout(
+  uint8_t gameModeType,
+  uint32_t mapBlockId) const
+{
+  const auto layout = GetMapBlockInfo(mapBlockId).layouts.Find(gameModeType);
+  if (layout == nullptr)
+    throw std::runtime_error("Invalid course game mode");
+  return *layout;
 }
 
 } // namespace server::registry
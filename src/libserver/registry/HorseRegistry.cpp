@@ -242,4 +242,20 @@ void HorseRegistry::GiveHorseRandomPotential(
   potential.value = randomDist(_randomDevice);
 }
 
+util::MemoryUsage HorseRegistry::GetMemoryUsage() const
+{
+  return util::MemoryUsage{
+    .count = _coats.size() + _faces.size() + _manes.size() + _tails.size(),
+    .bytes = util::EstimateHeapSize(_coats)
+      + util::EstimateHeapSize(_faces)
+      + util::EstimateHeapSize(_manes)
+      + util::EstimateHeapSize(_tails)
+      + util::EstimateHeapSize(_possibleCoats)
+      + util::EstimateHeapSize(_possibleFaces)
+      + util::EstimateHeapSize(_possibleManes)
+      + util::EstimateHeapSize(_possibleTails)
+      + util::EstimateHeapSize(_potentials)
+      + util::EstimateHeapSize(maneTailColorGroups)};
+}
+
 } // namespace server
\ No newline at end of file
@@ -147,7 +147,8 @@ void ItemRegistry::ReadConfig(const std::filesystem::path& configPath)
   if (not packagesCollectionSection)
     throw std::runtime_error("Missing packages collection section");
 
-  _items.clear();
+  std::vector<std::pair<uint32_t, Item>> items;
+  std::vector<std::pair<uint32_t, Package>> packages;
 
   for (const auto& itemSection : collectionSection)
   {
@@ -187,7 +188,8 @@ void ItemRegistry::ReadConfig(const std::filesystem::path& configPath)
     else if (const auto playParametersSection = itemSection["playParameters"])
       ReadPlayParameters(item.playParameters.emplace(), playParametersSection);
 
-    _items.try_emplace(item.tid, item);
+    const auto tid = item.tid;
+    items.emplace_back(tid, std::move(item));
   }
 
   for (const auto& packageSection : packagesCollectionSection )
@@ -200,36 +202,68 @@ void ItemRegistry::ReadConfig(const std::filesystem::path& configPath)
       .tid = packageSection["tid"].as<decltype(Package::tid)>()
     };
 
-    _packages.try_emplace(package.packageId, package);
+    const auto packageId = package.packageId;
+    packages.emplace_back(packageId, std::move(package));
   }
 
-  spdlog::info("Item registry loaded {} items and {} packages", _items.size() , _packages.size());
+  Snapshot snapshot{
+    .items = util::IdTable<Item>(std::move(items)),
+    .packages = util::IdTable<Package>(std::move(packages))};
+
+  const auto itemCount = snapshot.items.Size();
+  const auto packageCount = snapshot.packages.Size();
+  const auto version = _snapshot.Publish(std::move(snapshot));
+
+  spdlog::info(
+    "Item registry loaded {} items and {} packages (version {})",
+    itemCount,
+    packageCount,
+    version);
 }
 
-std::optional<Item> ItemRegistry::GetItem(uint32_t tid)
+ItemRegistry::View ItemRegistry::Pin() const noexcept
 {
-  const auto itemIter = _items.find(tid);
-  if (itemIter == _items.cend())
-    return std::nullopt;
-  return itemIter->second;
+  return _snapshot.Pin();
 }
 
-std::unordered_map<uint32_t, Item> ItemRegistry::GetItems()
+// Estimates of the heap size owned by the items, found by the ID tables through ADL.
+
+std::size_t EstimateHeapSize(const Item& item) noexcept
 {
-  return _items;
+  return util::EstimateHeapSize(item.name) + util::EstimateHeapSize(item.description);
 }
 
-std::optional<Package> ItemRegistry::GetPackage(uint32_t packageId)
+std::size_t EstimateHeapSize(const Package& package) noexcept
 {
-  const auto packageIter = _packages.find(packageId);
-  if (packageIter == _packages.cend())
+  return util::EstimateHeapSize(package.packageName) + util::EstimateHeapSize(package.itemName);
+}
+
+util::MemoryUsage ItemRegistry::GetMemoryUsage() const
+{
+  const auto snapshot = Pin();
+  return util::MemoryUsage{
+    .count = snapshot->items.Size() + snapshot->packages.Size(),
+    .bytes = sizeof(Snapshot)
+      + util::EstimateHeapSize(snapshot->items)
+      + util::EstimateHeapSize(snapshot->packages)};
+}
+
+std::optional<Item> ItemRegistry::GetItem(uint32_t tid) const
+{
+  const auto snapshot = _snapshot.Pin();
+  const auto item = snapshot->items.Find(tid);
+  if (item == nullptr)
     return std::nullopt;
-  return packageIter->second;
+  return *item;
 }
 
-std::unordered_map<uint32_t, Package> ItemRegistry::GetPackages()
+std::optional<Package> ItemRegistry::GetPackage(uint32_t packageId) const
 {
-  return _packages;
+  const auto snapshot = _snapshot.Pin();
+  const auto package = snapshot->packages.Find(packageId);
+  if (package == nullptr)
+    return std::nullopt;
+  return *package;
 }
 
 } // namespace server::registry
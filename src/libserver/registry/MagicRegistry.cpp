@@ -22,6 +22,7 @@
 #include <spdlog/spdlog.h>
 #include <yaml-cpp/yaml.h>
 
+#include <algorithm>
 #include <stdexcept>
 
 namespace server::registry
@@ -69,6 +70,62 @@ uint32_t ReadSlotInfo(const YAML::Node& section, Magic::SlotInfo& slot)
   return slot.type;
 }
 
+Magic::EffectInfo::Target ReadEffectTarget(const std::string& target)
+{
+  if (target == "Hit")
+    return Magic::EffectInfo::Target::Hit;
+  if (target == "Self")
+    return Magic::EffectInfo::Target::Self;
+  if (target == "Allies")
+    return Magic::EffectInfo::Target::Allies;
+  if (target == "Opponents")
+    return Magic::EffectInfo::Target::Opponents;
+  throw std::runtime_error("Unknown magic effect target: " + target);
+}
+
+Magic::EffectInfo::State ReadEffectState(const std::string& state)
+{
+  if (state == "None")
+    return Magic::EffectInfo::State::None;
+  if (state == "Shield")
+    return Magic::EffectInfo::State::Shield;
+  if (state == "CriticalShield")
+    return Magic::EffectInfo::State::CriticalShield;
+  if (state == "HotRodding")
+    return Magic::EffectInfo::State::HotRodding;
+  if (state == "CritChance")
+    return Magic::EffectInfo::State::CritChance;
+  if (state == "GaugeBuff")
+    return Magic::EffectInfo::State::GaugeBuff;
+  if (state == "Darkness")
+    return Magic::EffectInfo::State::Darkness;
+  throw std::runtime_error("Unknown magic effect state: " + state);
+}
+
+Magic::EffectInfo::Stacking ReadEffectStacking(const std::string& stacking)
+{
+  if (stacking == "Refresh")
+    return Magic::EffectInfo::Stacking::Refresh;
+  if (stacking == "Ignore")
+    return Magic::EffectInfo::Stacking::Ignore;
+  throw std::runtime_error("Unknown magic effect stacking: " + stacking);
+}
+
+uint32_t ReadEffectInfo(const YAML::Node& section, Magic::EffectInfo& effect)
+{
+  if (const auto targetSection = section["target"])
+    effect.target = ReadEffectTarget(targetSection.as<std::string>());
+  if (const auto stateSection = section["state"])
+    effect.state = ReadEffectState(stateSection.as<std::string>());
+  if (const auto stackingSection = section["stacking"])
+    effect.stacking = ReadEffectStacking(stackingSection.as<std::string>());
+
+  effect.obstacleLifetime = std::chrono::milliseconds(static_cast<int64_t>(
+    section["obstacleLifetime"].as<float>(0.0f) * 1000.0f));
+
+  return section["type"].as<uint32_t>();
+}
+
 } // anonymous namespace
 
 void MagicRegistry::ReadConfig(const std::filesystem::path& configPath)
@@ -79,6 +136,8 @@ void MagicRegistry::ReadConfig(const std::filesystem::path& configPath)
   if (not magicSection)
     throw std::runtime_error("Missing magic section");
 
+  std::vector<std::pair<uint32_t, Magic::SlotInfo>> slotInfo;
+
   // Slot info
   {
     const auto slotSection = magicSection["slotInfo"];
@@ -93,58 +152,105 @@ void MagicRegistry::ReadConfig(const std::filesystem::path& configPath)
     {
       Magic::SlotInfo slot;
       const auto type = ReadSlotInfo(entry, slot);
-      _slotInfo.emplace(type, std::move(slot));
+      // The effect lasts for the effect delay of the slot.
+      slot.effect.duration = std::chrono::milliseconds(
+        static_cast<int64_t>(slot.effectDelay * 1000.0f));
+      slotInfo.emplace_back(type, std::move(slot));
     }
   }
 
+  // Effects
+  if (const auto effectsSection = magicSection["effects"])
+  {
+    for (const auto& entry : effectsSection["collection"])
+    {
+      Magic::EffectInfo effect;
+      const auto type = ReadEffectInfo(entry, effect);
+
+      const auto slotIter = std::ranges::find(
+        slotInfo, type, &std::pair<uint32_t, Magic::SlotInfo>::first);
+      if (slotIter == slotInfo.cend())
+        throw std::runtime_error("Magic effect of unknown slot: " + std::to_string(type));
+
+      effect.duration = slotIter->second.effect.duration;
+      slotIter->second.effect = effect;
+    }
+  }
+
+  Snapshot snapshot{
+    .slotInfo = util::IdTable<Magic::SlotInfo>(std::move(slotInfo))};
+
   // Pre-build the pick pools so RandomMagicItem never has to filter at runtime.
-  for (const auto& [type, slot] : _slotInfo)
+  // Index the slots by their effect IDs, the basic slots go first so that they win
+  // over the critical slots sharing the same effect.
+  std::vector<std::pair<uint32_t, uint32_t>> basicSlotTypeByEffectId;
+  std::vector<std::pair<uint32_t, uint32_t>> criticalSlotTypeByEffectId;
+  for (const auto& slot : snapshot.slotInfo.GetValues())
   {
-    if (slot.basicType != type)
-      continue; // skip critical variants
-    _teamPool.push_back(type);
+    if (slot.basicType != slot.type)
+    {
+      // skip critical variants
+      criticalSlotTypeByEffectId.emplace_back(slot.skillEffectId, slot.type);
+      continue;
+    }
+
+    basicSlotTypeByEffectId.emplace_back(slot.skillEffectId, slot.type);
+    snapshot.teamPool.push_back(slot.type);
     if (slot.teamMode == 0)
-      _soloPool.push_back(type);
+      snapshot.soloPool.push_back(slot.type);
   }
 
-  spdlog::info(
-    "Magic registry loaded {} slot(s) ({} solo, {} team)",
-    _slotInfo.size(),
-    _soloPool.size(),
-    _teamPool.size());
-}
+  basicSlotTypeByEffectId.insert(
+    basicSlotTypeByEffectId.end(),
+    criticalSlotTypeByEffectId.cbegin(),
+    criticalSlotTypeByEffectId.cend());
+  snapshot.slotTypeByEffectId = util::IdTable<uint32_t>(
+    std::move(basicSlotTypeByEffectId));
 
-const Magic::SlotInfo& MagicRegistry::GetSlotInfo(uint32_t type) const
-{
-  const auto it = _slotInfo.find(type);
-  if (it == _slotInfo.end())
-    throw std::runtime_error("Magic slot not found: " + std::to_string(type));
-  return it->second;
+  const auto slotCount = snapshot.slotInfo.Size();
+  const auto soloPoolSize = snapshot.soloPool.size();
+  const auto teamPoolSize = snapshot.teamPool.size();
+  const auto version = _snapshot.Publish(std::move(snapshot));
+
+  spdlog::info(
+    "Magic registry loaded {} slot(s) ({} solo, {} team) (version {})",
+    slotCount,
+    soloPoolSize,
+    teamPoolSize,
+    version);
 }
 
-const Magic::SlotInfo& MagicRegistry::GetSlotInfoByEffectId(uint32_t effectId) const
+MagicRegistry::View MagicRegistry::Pin() const noexcept
 {
-  for (const auto& [type, slot] : _slotInfo)
-  {
-    if (slot.skillEffectId == effectId)
-      return slot;
-  }
-  throw std::runtime_error("Magic slot not found for effect ID: " + std::to_string(effectId));
+  return _snapshot.Pin();
 }
 
-const std::unordered_map<uint32_t, Magic::SlotInfo>& MagicRegistry::GetSlotInfoMap() const
+util::MemoryUsage MagicRegistry::GetMemoryUsage() const
 {
-  return _slotInfo;
+  const auto snapshot = Pin();
+  return util::MemoryUsage{
+    .count = snapshot->slotInfo.Size(),
+    .bytes = sizeof(Snapshot)
+      + util::EstimateHeapSize(snapshot->slotInfo)
+      + util::EstimateHeapSize(snapshot->slotTypeByEffectId)
+      + util::EstimateHeapSize(snapshot->soloPool)
+      + util::EstimateHeapSize(snapshot->teamPool)};
 }
 
-const std::vector<uint32_t>& MagicRegistry::GetSoloPool() const
+const Magic::SlotInfo& MagicRegistry::Snapshot::GetSlotInfo(uint32_t type) const
 {
-  return _soloPool;
+  const auto slot = slotInfo.Find(type);
+  if (slot == nullptr)
+    throw std::runtime_error("Magic slot not found: " + std::to_string(type));
+  return *slot;
 }
 
-const std::vector<uint32_t>& MagicRegistry::GetTeamPool() const
+const Magic::SlotInfo& MagicRegistry::Snapshot::GetSlotInfoByEffectId(uint32_t effectId) const
 {
-  return _teamPool;
+  const auto type = slotTypeByEffectId.Find(effectId);
+  if (type == nullptr)
+    throw std::runtime_error("Magic slot not found for effect ID: " + std::to_string(effectId));
+  return GetSlotInfo(*type);
 }
 
 } // namespace server::registry
@@ -77,39 +77,77 @@ void PetRegistry::ReadConfig(const std::filesystem::path& configPath)
   const auto petsSection = root["pets"];
   const auto eggsSection = petsSection["eggs"];
 
+  std::vector<std::pair<data::Tid, EggInfo>> eggs;
+  std::vector<std::pair<data::Tid, PetInfo>> pets;
+
   for (const auto& eggSection : eggsSection["collection"])
   {
     EggInfo info;
     const auto eggItemTid = ReadEggInfo(eggSection, info);
-    _eggs.try_emplace(eggItemTid, info);
+    eggs.emplace_back(eggItemTid, std::move(info));
   }
 
   for (const auto& petSection : petsSection["collection"])
   {
     PetInfo info;
     const auto petItemTid = ReadPetInfo(petSection, info);
-    _pets.try_emplace(petItemTid, info);
+    pets.emplace_back(petItemTid, info);
   }
 
-  spdlog::info("Pet registry loaded {} pets and {} eggs", _pets.size(), _eggs.size());
+  Snapshot snapshot{
+    .eggs = util::IdTable<EggInfo>(std::move(eggs)),
+    .pets = util::IdTable<PetInfo>(std::move(pets))};
+
+  const auto petCount = snapshot.pets.Size();
+  const auto eggCount = snapshot.eggs.Size();
+  const auto version = _snapshot.Publish(std::move(snapshot));
+
+  spdlog::info(
+    "Pet registry loaded {} pets and {} eggs (version {})",
+    petCount,
+    eggCount,
+    version);
+}
+
+PetRegistry::View PetRegistry::Pin() const noexcept
+{
+  return _snapshot.Pin();
+}
+
+// Estimate of the heap size owned by the egg, found by the ID table through ADL.
+std::size_t EstimateHeapSize(const EggInfo& egg) noexcept
+{
+  return util::EstimateHeapSize(egg.hatchablePets);
+}
+
+util::MemoryUsage PetRegistry::GetMemoryUsage() const
+{
+  const auto snapshot = Pin();
+  return util::MemoryUsage{
+    .count = snapshot->eggs.Size() + snapshot->pets.Size(),
+    .bytes = sizeof(Snapshot)
+      + util::EstimateHeapSize(snapshot->eggs)
+      + util::EstimateHeapSize(snapshot->pets)};
 }
 
-EggInfo PetRegistry::GetEggInfo(server::data::Tid tid)
+EggInfo PetRegistry::GetEggInfo(server::data::Tid tid) const
 {
-  auto it = _eggs.find(tid);
-  if (it != _eggs.end())
+  const auto snapshot = _snapshot.Pin();
+  const auto egg = snapshot->eggs.Find(tid);
+  if (egg != nullptr)
   {
-    return it->second;
+    return *egg;
   }
 
   throw std::runtime_error("Egg with given TID not found.");
 }
 
-PetInfo PetRegistry::GetPetInfo(server::data::Tid tid)
+PetInfo PetRegistry::GetPetInfo(server::data::Tid tid) const
 {
-  auto it = _pets.find(tid);
-  if (it != _pets.end())
-    return it->second;
+  const auto snapshot = _snapshot.Pin();
+  const auto pet = snapshot->pets.Find(tid);
+  if (pet != nullptr)
+    return *pet;
 
   throw std::runtime_error("Pet with given TID not found");
 }
@@ -0,0 +1,86 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "libserver/util/Histogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace server::util
+{
+
+uint64_t Histogram::Snapshot::GetPercentile(const double percentile) const
+{
+  if (count == 0)
+    return 0;
+
+  // Rank of the value at the percentile, at least the first value.
+  const auto rank = std::max<uint64_t>(
+    1,
+    static_cast<uint64_t>(std::ceil(
+      std::clamp(percentile, 0.0, 100.0) / 100.0 * static_cast<double>(count))));
+
+  uint64_t seen = 0;
+  for (uint32_t bucketIdx = 0; bucketIdx < BucketCount; ++bucketIdx)
+  {
+    seen += buckets[bucketIdx];
+    if (seen < rank)
+      continue;
+
+    // The last bucket holds the clamped values, the max is the only bound.
+    if (bucketIdx == BucketCount - 1)
+      return max;
+    return std::min(GetBucketUpperBound(bucketIdx), max);
+  }
+
+  return max;
+}
+
+double Histogram::Snapshot::GetMean() const
+{
+  if (count == 0)
+    return 0.0;
+  return static_cast<double>(sum) / static_cast<double>(count);
+}
+
+void Histogram::Snapshot::Merge(const Snapshot& other)
+{
+  for (uint32_t bucketIdx = 0; bucketIdx < BucketCount; ++bucketIdx)
+    buckets[bucketIdx] += other.buckets[bucketIdx];
+  count += other.count;
+  sum += other.sum;
+  max = std::max(max, other.max);
+}
+
+Histogram::Snapshot Histogram::GetSnapshot() const
+{
+  Snapshot snapshot;
+  for (uint32_t bucketIdx = 0; bucketIdx < BucketCount; ++bucketIdx)
+    snapshot.buckets[bucketIdx] = _buckets[bucketIdx].load(std::memory_order::relaxed);
+
+  // The count is derived from the buckets so that the percentiles are consistent.
+  for (const auto bucket : snapshot.buckets)
+    snapshot.count += bucket;
+  snapshot.sum = _sum.load(std::memory_order::relaxed);
+  snapshot.max = _max.load(std::memory_order::relaxed);
+
+  return snapshot;
+}
+
+} // namespace server::util
@@ -0,0 +1,94 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "libserver/util/MemoryUsage.hpp"
+
+#include <array>
+#include <format>
+#include <ranges>
+
+namespace server::util
+{
+
+MemoryUsage GetTotal(const MemoryUsageReport& report) noexcept
+{
+  MemoryUsage total;
+  for (const auto& usage : report | std::views::values)
+    total += usage;
+  return total;
+}
+
+std::string FormatBytes(const uint64_t bytes)
+{
+  constexpr std::array Units{"B", "KiB", "MiB", "GiB", "TiB"};
+
+  if (bytes < 1024)
+    return std::format("{} B", bytes);
+
+  auto value = static_cast<double>(bytes);
+  size_t unit = 0;
+  while (value >= 1024.0 && unit + 1 < Units.size())
+  {
+    value /= 1024.0;
+    ++unit;
+  }
+
+  return std::format("{:.1f} {}", value, Units[unit]);
+}
+
+bool MemoryAccounting::IsReportDue(
+  const std::string_view component,
+  const Clock::duration interval) const
+{
+  const auto now = Clock::now();
+
+  std::scoped_lock lock(_mutex);
+  const auto reportIter = _reports.find(component);
+  if (reportIter == _reports.cend())
+    return true;
+
+  const auto publishedAt = reportIter->second.publishedAt;
+  return now - publishedAt >= interval || publishedAt < _requestedAt;
+}
+
+void MemoryAccounting::RequestReports()
+{
+  const auto requestedAt = Clock::now();
+
+  std::scoped_lock lock(_mutex);
+  _requestedAt = requestedAt;
+}
+
+void MemoryAccounting::Publish(const std::string_view component, MemoryUsageReport report)
+{
+  const auto publishedAt = Clock::now();
+
+  std::scoped_lock lock(_mutex);
+  auto& componentReport = _reports[std::string(component)];
+  componentReport.publishedAt = publishedAt;
+  componentReport.report = std::move(report);
+}
+
+std::map<std::string, MemoryAccounting::ComponentReport, std::less<>> MemoryAccounting::GetReports() const
+{
+  std::scoped_lock lock(_mutex);
+  return _reports;
+}
+
+} // namespace server::util
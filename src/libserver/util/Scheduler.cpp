@@ -18,6 +18,7 @@
  **/
 
 #include "libserver/util/Scheduler.hpp"
+#include "libserver/util/Trace.hpp"
 
 namespace server
 {
@@ -49,8 +50,10 @@ void Scheduler::Tick()
     {
       try
       {
+        const util::trace::Span span("scheduler", "job");
         job.task();
         _jobIterator = _jobs.erase(_jobIterator);
+        _jobCount.fetch_sub(1, std::memory_order::relaxed);
       }
       catch (const std::exception& x)
       {
@@ -73,6 +76,20 @@ void Scheduler::Queue(
   _jobs.emplace_back(Job{
     .when = when,
     .task = task});
+  _jobCount.fetch_add(1, std::memory_order::relaxed);
+}
+
+size_t Scheduler::GetJobCount() const
+{
+  return _jobCount.load(std::memory_order::relaxed);
+}
+
+util::MemoryUsage Scheduler::GetMemoryUsage() const
+{
+  const auto jobCount = GetJobCount();
+  return util::MemoryUsage{
+    .count = jobCount,
+    .bytes = jobCount * (sizeof(Job) + util::ListNodeOverhead)};
 }
 
 
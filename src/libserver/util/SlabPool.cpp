@@ -0,0 +1,209 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "libserver/util/SlabPool.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <stdexcept>
+#include <utility>
+
+namespace server::util
+{
+
+//! Slab of the blocks of a size class.
+struct SlabPool::Slab
+{
+  SlabPool& pool;
+  size_t classIndex{};
+  size_t blockSize{};
+  std::unique_ptr<std::byte[]> memory;
+  //! Indices of the free blocks.
+  std::vector<uint32_t> freeBlocks;
+  //! Count of the blocks in use.
+  uint32_t usedCount{};
+};
+
+SlabPool::Block::Block(Slab* slab, std::byte* data, const size_t size) noexcept
+  : _slab(slab)
+  , _data(data)
+  , _size(size)
+{
+}
+
+SlabPool::Block::~Block()
+{
+  Reset();
+}
+
+SlabPool::Block::Block(Block&& other) noexcept
+  : _slab(std::exchange(other._slab, nullptr))
+  , _data(std::exchange(other._data, nullptr))
+  , _size(std::exchange(other._size, 0))
+{
+}
+
+SlabPool::Block& SlabPool::Block::operator=(Block&& other) noexcept
+{
+  if (this != &other)
+  {
+    Reset();
+    _slab = std::exchange(other._slab, nullptr);
+    _data = std::exchange(other._data, nullptr);
+    _size = std::exchange(other._size, 0);
+  }
+  return *this;
+}
+
+std::byte* SlabPool::Block::GetData() const noexcept
+{
+  return _data;
+}
+
+size_t SlabPool::Block::GetSize() const noexcept
+{
+  return _size;
+}
+
+void SlabPool::Block::Reset() noexcept
+{
+  if (_slab == nullptr)
+    return;
+
+  _slab->pool.Release(*_slab, _data);
+  _slab = nullptr;
+  _data = nullptr;
+  _size = 0;
+}
+
+SlabPool::Block::operator bool() const noexcept
+{
+  return _data != nullptr;
+}
+
+SlabPool::SlabPool() = default;
+
+SlabPool::~SlabPool()
+{
+  assert(_statistics.usedBlocks.load(std::memory_order::relaxed) == 0);
+}
+
+SlabPool::Block SlabPool::Acquire(const size_t size)
+{
+  if (size > MaxBlockSize)
+    throw std::length_error("Block size exceeds the largest size class");
+
+  const size_t blockSize = GetBlockSize(size);
+  const size_t classIndex = std::countr_zero(blockSize) - std::countr_zero(MinBlockSize);
+  auto& sizeClass = _classes[classIndex];
+
+  std::scoped_lock lock(sizeClass.mutex);
+
+  // Prefer the slabs in use, so that the empty slabs may be freed.
+  Slab* slab = nullptr;
+  for (const auto& candidate : sizeClass.slabs)
+  {
+    if (candidate->freeBlocks.empty())
+      continue;
+
+    slab = candidate.get();
+    if (slab->usedCount > 0)
+      break;
+  }
+
+  if (slab == nullptr)
+  {
+    const auto blockCount = static_cast<uint32_t>(SlabSize / blockSize);
+
+    auto& newSlab = sizeClass.slabs.emplace_back(std::make_unique<Slab>(Slab{
+      .pool = *this,
+      .classIndex = classIndex,
+      .blockSize = blockSize,
+      .memory = std::make_unique_for_overwrite<std::byte[]>(SlabSize),
+      .freeBlocks = {},
+      .usedCount = 0}));
+
+    // Hand out the blocks from the start of the slab first.
+    newSlab->freeBlocks.reserve(blockCount);
+    for (uint32_t blockIndex = blockCount; blockIndex > 0; --blockIndex)
+      newSlab->freeBlocks.emplace_back(blockIndex - 1);
+
+    slab = newSlab.get();
+    _statistics.slabCount.fetch_add(1, std::memory_order::relaxed);
+  }
+
+  const uint32_t blockIndex = slab->freeBlocks.back();
+  slab->freeBlocks.pop_back();
+  ++slab->usedCount;
+
+  _statistics.usedBlocks.fetch_add(1, std::memory_order::relaxed);
+  _statistics.usedBytes.fetch_add(blockSize, std::memory_order::relaxed);
+
+  return Block(slab, slab->memory.get() + blockIndex * blockSize, blockSize);
+}
+
+SlabPool::Statistics SlabPool::GetStatistics() const noexcept
+{
+  const uint64_t slabCount = _statistics.slabCount.load(std::memory_order::relaxed);
+  return Statistics{
+    .slabCount = slabCount,
+    .residentBytes = slabCount * SlabSize,
+    .usedBlocks = _statistics.usedBlocks.load(std::memory_order::relaxed),
+    .usedBytes = _statistics.usedBytes.load(std::memory_order::relaxed)};
+}
+
+size_t SlabPool::GetBlockSize(const size_t size) noexcept
+{
+  return std::bit_ceil(std::max(size, MinBlockSize));
+}
+
+void SlabPool::Release(Slab& slab, std::byte* data) noexcept
+{
+  auto& sizeClass = _classes[slab.classIndex];
+  std::scoped_lock lock(sizeClass.mutex);
+
+  const auto blockIndex = static_cast<uint32_t>((data - slab.memory.get()) / slab.blockSize);
+  slab.freeBlocks.emplace_back(blockIndex);
+  --slab.usedCount;
+
+  _statistics.usedBlocks.fetch_sub(1, std::memory_order::relaxed);
+  _statistics.usedBytes.fetch_sub(slab.blockSize, std::memory_order::relaxed);
+
+  if (slab.usedCount > 0)
+    return;
+
+  // Keep a single empty slab per class, so that a client going idle and active
+  // again does not allocate and free a slab every time.
+  const auto emptySlabCount = std::ranges::count_if(
+    sizeClass.slabs,
+    [](const auto& candidate) { return candidate->usedCount == 0; });
+  if (emptySlabCount <= 1)
+    return;
+
+  const auto slabIter = std::ranges::find_if(
+    sizeClass.slabs,
+    [&slab](const auto& candidate) { return candidate.get() == &slab; });
+  std::swap(*slabIter, sizeClass.slabs.back());
+  sizeClass.slabs.pop_back();
+
+  _statistics.slabCount.fetch_sub(1, std::memory_order::relaxed);
+}
+
+} // namespace server::util
@@ -0,0 +1,135 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "libserver/util/SlotMap.hpp"
+
+#include <array>
+#include <limits>
+
+namespace server::util::epoch
+{
+
+namespace
+{
+
+//! Maximum count of the threads pinning at once through their own record.
+constexpr size_t MaxRecordCount = 128;
+//! Epoch of a record whose thread is not pinned.
+constexpr uint64_t Unpinned = std::numeric_limits<uint64_t>::max();
+
+//! A record of the epoch observed by a pinned thread, in its own cache line.
+struct alignas(64) Record
+{
+  std::atomic<uint64_t> epoch{Unpinned};
+  std::atomic<bool> isUsed{false};
+};
+
+//! The global epoch.
+std::atomic<uint64_t> globalEpoch{1};
+//! Records of the threads.
+std::array<Record, MaxRecordCount> records;
+//! Count of the pins of the threads without a record, nothing is reclaimed while non-zero.
+alignas(64) std::atomic<uint64_t> sharedPinCount{0};
+
+//! The record of the current thread, released when the thread exits.
+class ThreadRecord final
+{
+public:
+  ThreadRecord() noexcept
+  {
+    for (auto& record : records)
+    {
+      bool isUsed = false;
+      if (record.isUsed.compare_exchange_strong(isUsed, true, std::memory_order::acq_rel))
+      {
+        _record = &record;
+        break;
+      }
+    }
+  }
+
+  ~ThreadRecord()
+  {
+    if (_record != nullptr)
+      _record->isUsed.store(false, std::memory_order::release);
+  }
+
+  //! The record, `nullptr` if all the records are used by other threads.
+  Record* _record{nullptr};
+  //! Depth of the nested pins.
+  uint32_t _depth{0};
+};
+
+thread_local ThreadRecord threadRecord;
+
+} // anon namespace
+
+Pin::Pin() noexcept
+{
+  if (threadRecord._depth++ > 0)
+    return;
+
+  if (threadRecord._record == nullptr)
+  {
+    sharedPinCount.fetch_add(1, std::memory_order::seq_cst);
+    return;
+  }
+
+  // The epoch is announced before the pinned thread reads any object.
+  threadRecord._record->epoch.store(
+    globalEpoch.load(std::memory_order::seq_cst),
+    std::memory_order::seq_cst);
+}
+
+Pin::~Pin()
+{
+  if (--threadRecord._depth > 0)
+    return;
+
+  if (threadRecord._record == nullptr)
+  {
+    sharedPinCount.fetch_sub(1, std::memory_order::seq_cst);
+    return;
+  }
+
+  threadRecord._record->epoch.store(Unpinned, std::memory_order::release);
+}
+
+uint64_t Advance() noexcept
+{
+  return globalEpoch.fetch_add(1, std::memory_order::seq_cst);
+}
+
+uint64_t GetSafeEpoch() noexcept
+{
+  if (sharedPinCount.load(std::memory_order::seq_cst) > 0)
+    return 0;
+
+  uint64_t safeEpoch = globalEpoch.load(std::memory_order::seq_cst);
+  for (const auto& record : records)
+  {
+    const auto epoch = record.epoch.load(std::memory_order::seq_cst);
+    if (epoch < safeEpoch)
+      safeEpoch = epoch;
+  }
+
+  return safeEpoch;
+}
+
+} // namespace server::util::epoch
@@ -0,0 +1,276 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "libserver/util/Trace.hpp"
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace server::util::trace
+{
+
+namespace detail
+{
+
+std::atomic_bool enabled{false};
+
+} // namespace detail
+
+namespace
+{
+
+//! Default count of the spans a per-thread buffer holds.
+constexpr size_t DefaultBufferCapacity = 32768;
+
+//! A recorded span.
+struct Event
+{
+  std::string_view category;
+  std::string_view name;
+  Clock::time_point begin{};
+  Clock::time_point end{};
+};
+
+//! A ring buffer of the spans recorded by a thread.
+struct Buffer
+{
+  //! Guards the buffer, contended only while dumping.
+  std::mutex mutex;
+  //! ID of the thread in the traces.
+  uint32_t threadId{};
+  //! Name of the thread in the traces.
+  std::string threadName;
+  std::vector<Event> events;
+  //! Count of the spans recorded since the last clear.
+  uint64_t recordedCount{};
+};
+
+//! Buffers of all the threads.
+struct Registry
+{
+  std::mutex mutex;
+  std::vector<std::shared_ptr<Buffer>> buffers;
+  uint32_t nextThreadId{1};
+  std::atomic<size_t> bufferCapacity{DefaultBufferCapacity};
+  //! Origin of the timestamps in the traces.
+  Clock::time_point origin{Clock::now()};
+};
+
+Registry& GetRegistry()
+{
+  static Registry registry;
+  return registry;
+}
+
+//! Returns the buffer of the current thread, registers it on the first use.
+Buffer& GetThreadBuffer()
+{
+  thread_local const std::shared_ptr<Buffer> threadBuffer = []()
+  {
+    auto& registry = GetRegistry();
+
+    auto buffer = std::make_shared<Buffer>();
+    buffer->events.resize(
+      std::max<size_t>(registry.bufferCapacity.load(std::memory_order::relaxed), 1));
+
+    std::scoped_lock lock(registry.mutex);
+    buffer->threadId = registry.nextThreadId++;
+    registry.buffers.emplace_back(buffer);
+    return buffer;
+  }();
+
+  return *threadBuffer;
+}
+
+//! Writes the value as a JSON string.
+void WriteString(std::ostream& stream, const std::string_view value)
+{
+  stream.put('"');
+  for (const char character : value)
+  {
+    switch (character)
+    {
+      case '"':
+        stream << "\\\"";
+        break;
+      case '\\':
+        stream << "\\\\";
+        break;
+      default:
+        if (static_cast<unsigned char>(character) < 0x20)
+          stream << std::format("\\u{:04x}", static_cast<unsigned>(character));
+        else
+          stream.put(character);
+    }
+  }
+  stream.put('"');
+}
+
+} // anon namespace
+
+void detail::Record(
+  const std::string_view category,
+  const std::string_view name,
+  const Clock::time_point begin,
+  const Clock::time_point end) noexcept
+{
+  try
+  {
+    auto& buffer = GetThreadBuffer();
+
+    std::scoped_lock lock(buffer.mutex);
+    buffer.events[buffer.recordedCount % buffer.events.size()] = Event{
+      .category = category,
+      .name = name,
+      .begin = begin,
+      .end = end};
+    ++buffer.recordedCount;
+  }
+  catch (const std::exception&)
+  {
+    // The span is lost if the buffer could not be allocated.
+  }
+}
+
+void SetEnabled(const bool enabled) noexcept
+{
+  detail::enabled.store(enabled, std::memory_order::relaxed);
+}
+
+void SetBufferCapacity(const size_t capacity) noexcept
+{
+  GetRegistry().bufferCapacity.store(capacity, std::memory_order::relaxed);
+}
+
+void SetThreadName(const std::string_view name)
+{
+  auto& buffer = GetThreadBuffer();
+
+  std::scoped_lock lock(buffer.mutex);
+  buffer.threadName = name;
+}
+
+void Clear()
+{
+  auto& registry = GetRegistry();
+  std::scoped_lock lock(registry.mutex);
+
+  // Forget the buffers of the threads which ended.
+  std::erase_if(registry.buffers, [](const std::shared_ptr<Buffer>& buffer)
+  {
+    return buffer.use_count() == 1;
+  });
+
+  for (const auto& buffer : registry.buffers)
+  {
+    std::scoped_lock bufferLock(buffer->mutex);
+    buffer->recordedCount = 0;
+  }
+}
+
+size_t Dump(const std::filesystem::path& path)
+{
+  auto& registry = GetRegistry();
+
+  std::vector<std::shared_ptr<Buffer>> buffers;
+  {
+    std::scoped_lock lock(registry.mutex);
+    buffers = registry.buffers;
+  }
+
+  std::ofstream file(path, std::ios::binary);
+  if (not file.is_open())
+    throw std::runtime_error(std::format("Couldn't open the trace file '{}'", path.string()));
+
+  file << R"({"displayTimeUnit":"ns","traceEvents":[)";
+
+  size_t eventCount = 0;
+  bool isFirst = true;
+  const auto separate = [&file, &isFirst]()
+  {
+    if (not isFirst)
+      file.put(',');
+    file.put('\n');
+    isFirst = false;
+  };
+
+  std::vector<Event> events;
+  for (const auto& buffer : buffers)
+  {
+    uint32_t threadId{};
+    std::string threadName;
+
+    // Copy the spans oldest first, so the thread is blocked only briefly.
+    {
+      std::scoped_lock lock(buffer->mutex);
+      threadId = buffer->threadId;
+      threadName = buffer->threadName.empty()
+        ? std::format("thread {}", buffer->threadId)
+        : buffer->threadName;
+
+      const auto capacity = buffer->events.size();
+      const auto count = std::min<uint64_t>(buffer->recordedCount, capacity);
+      events.clear();
+      for (uint64_t idx = buffer->recordedCount - count; idx < buffer->recordedCount; ++idx)
+        events.emplace_back(buffer->events[idx % capacity]);
+    }
+
+    separate();
+    file << std::format(R"({{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":)", threadId);
+    WriteString(file, threadName);
+    file << "}}";
+
+    for (const auto& event : events)
+    {
+      separate();
+      file << R"({"name":)";
+      WriteString(file, event.name);
+      file << R"(,"cat":)";
+      WriteString(file, event.category);
+      file << std::format(
+        R"(,"ph":"X","ts":{:.3f},"dur":{:.3f},"pid":1,"tid":{}}})",
+        std::chrono::duration<double, std::micro>(event.begin - registry.origin).count(),
+        std::chrono::duration<double, std::micro>(event.end - event.begin).count(),
+        threadId);
+    }
+
+    eventCount += events.size();
+  }
+
+  file << "\n]}\n";
+
+  if (not file.good())
+    throw std::runtime_error(std::format("Couldn't write the trace file '{}'", path.string()));
+
+  return eventCount;
+}
+
+std::filesystem::path MakeFilePath(const std::filesystem::path& directory)
+{
+  const auto now = std::chrono::floor<std::chrono::seconds>(
+    std::chrono::system_clock::now());
+  return directory / std::format("trace-{:%Y%m%dT%H%M%SZ}.json", now);
+}
+
+} // namespace server::util::trace
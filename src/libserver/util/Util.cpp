@@ -19,6 +19,8 @@
 
 #include "libserver/util/Util.hpp"
 
+#include <algorithm>
+#include <cctype>
 #include <ranges>
 
 namespace server::util
@@ -233,19 +235,35 @@ std::string GenerateByteDump(const std::span<const std::byte> data)
   if (data.empty())
     return "";
 
+  constexpr std::string_view HexDigits = "0123456789ABCDEF";
+  constexpr size_t RowSize = 16;
+
+  // Each row has 3 characters per byte, a tab, 1 character per byte and a new line.
   std::string dump;
+  dump.reserve((data.size() + RowSize - 1) / RowSize * (RowSize * 4 + 2));
 
-  for (const auto row : data | std::views::chunk(16))
+  for (size_t rowOffset = 0; rowOffset < data.size(); rowOffset += RowSize)
   {
-    std::string bytes;
-    std::string ascii;
+    const auto row = data.subspan(rowOffset, std::min(RowSize, data.size() - rowOffset));
+    const auto padding = RowSize - row.size();
+
     for (const auto& byte : row)
     {
-      bytes += std::format("{:02X} ", static_cast<uint8_t>(byte));
-      ascii += std::format("{:c}", std::isalnum(static_cast<uint8_t>(byte)) ? static_cast<uint8_t>(byte) : '.');
+      const auto value = static_cast<uint8_t>(byte);
+      dump += HexDigits[value >> 4];
+      dump += HexDigits[value & 0xF];
+      dump += ' ';
     }
+    dump.append(padding * 3, ' ');
+    dump += '\t';
 
-    dump += std::format("{:<48}\t{:<16}\n", bytes, ascii);
+    for (const auto& byte : row)
+    {
+      const auto value = static_cast<uint8_t>(byte);
+      dump += std::isalnum(value) ? static_cast<char>(value) : '.';
+    }
+    dump.append(padding, ' ');
+    dump += '\n';
   }
 
   return dump;
@@ -0,0 +1,1196 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include <libserver/network/command/CommandClientCodec.hpp>
+#include <libserver/network/command/proto/LobbyMessageDefinitions.hpp>
+#include <libserver/network/command/proto/RaceMessageDefinitions.hpp>
+#include <libserver/network/command/proto/RanchMessageDefinitions.hpp>
+#include <libserver/util/Histogram.hpp>
+
+#include <boost/asio.hpp>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <concepts>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+//! Simulates a swarm of game clients against a local server.
+//! Every bot speaks the real protocol, including the scrambling, and follows
+//! a scenario of steps: it logs in, visits ranches, sends snapshots and races
+//! in rooms with the other bots of its group. The latencies are reported as percentiles.
+
+namespace
+{
+
+namespace asio = boost::asio;
+namespace protocol = server::protocol;
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::string_view Usage =
+  "Usage: alicia-loadgen [options]\n"
+  "Options:\n"
+  "  --address <address>  Address of the lobby server, defaults to 127.0.0.1.\n"
+  "  --port <port>        Port of the lobby server, defaults to 10030.\n"
+  "  --bots <count>       Count of the bots. Defaults to 100.\n"
+  "  --group <count>      Count of the bots sharing a ranch and a room, at most 8. Defaults to 4.\n"
+  "  --ramp <rate>        Bots started per second, 0 starts all at once. Defaults to 50.\n"
+  "  --threads <count>    Count of the network threads. Defaults to 1.\n"
+  "  --prefix <prefix>    Prefix of the bot user names. Defaults to `lg`.\n"
+  "  --scenario <path>    Scenario file, one step per line:\n"
+  "                         login\n"
+  "                         ranch\n"
+  "                         snapshot <count> <interval ms>\n"
+  "                         leave-ranch\n"
+  "                         race <relay count> <relay interval ms>\n"
+  "                         wait <ms>\n"
+  "                         logout\n"
+  "                       Lines starting with `#` are ignored.\n"
+  "                       Defaults to: login, ranch, snapshot 20 100, leave-ranch, race 50 50.\n";
+
+//! Time limit of waiting for a response of the server.
+constexpr auto ResponseTimeout = std::chrono::seconds(30);
+//! Interval of the heartbeats, well below the timeouts of the servers.
+constexpr auto HeartbeatInterval = std::chrono::seconds(10);
+//! Maximum count of the received commands nobody waited for yet.
+constexpr size_t MaxQueuedCommands = 256;
+//! Size of the relay data, including the timestamp.
+constexpr size_t RelayDataSize = 32;
+//! Horse TID requested when creating the characters of new bots.
+constexpr uint32_t DefaultHorseTid = 20001;
+
+//! A step of the scenario.
+struct Step
+{
+  enum class Type
+  {
+    Login,
+    Ranch,
+    Snapshot,
+    LeaveRanch,
+    Race,
+    Wait,
+    Logout,
+  };
+
+  Type type{};
+  uint32_t count{};
+  std::chrono::milliseconds interval{};
+};
+
+std::string_view GetStepName(const Step::Type type)
+{
+  switch (type)
+  {
+    case Step::Type::Login:
+      return "login";
+    case Step::Type::Ranch:
+      return "ranch";
+    case Step::Type::Snapshot:
+      return "snapshot";
+    case Step::Type::LeaveRanch:
+      return "leave-ranch";
+    case Step::Type::Race:
+      return "race";
+    case Step::Type::Wait:
+      return "wait";
+    case Step::Type::Logout:
+      return "logout";
+  }
+  return "unknown";
+}
+
+//! Options of the load generator.
+struct Options
+{
+  asio::ip::address_v4 address{asio::ip::address_v4::loopback()};
+  uint16_t port{10030};
+  uint32_t bots{100};
+  uint32_t groupSize{4};
+  double ramp{50.0};
+  uint32_t threads{1};
+  std::string prefix{"lg"};
+  std::vector<Step> scenario{
+    {.type = Step::Type::Login},
+    {.type = Step::Type::Ranch},
+    {.type = Step::Type::Snapshot, .count = 20, .interval = std::chrono::milliseconds(100)},
+    {.type = Step::Type::LeaveRanch},
+    {.type = Step::Type::Race, .count = 50, .interval = std::chrono::milliseconds(50)}};
+};
+
+//! Statistics of the swarm, shared by all the bots.
+struct Statistics
+{
+  std::atomic<uint64_t> completedBots{0};
+  std::atomic<uint64_t> failedBots{0};
+  std::atomic<uint64_t> sentCommands{0};
+  std::atomic<uint64_t> receivedCommands{0};
+  std::atomic<uint64_t> completedRaces{0};
+  //! Time from connecting to the lobby to the login OK in nanoseconds.
+  server::util::Histogram login;
+  //! Time from requesting the ranch in the lobby to entering it in nanoseconds.
+  server::util::Histogram ranchEnter;
+  //! Time from making or entering the room in the lobby to entering it
+  //! on the race server in nanoseconds.
+  server::util::Histogram roomJoin;
+  //! Time from sending a snapshot to it being received by another bot in nanoseconds.
+  server::util::Histogram snapshotFanOut;
+  //! Time from sending a relay to it being received by another bot in nanoseconds.
+  server::util::Histogram relayFanOut;
+};
+
+//! A group of bots sharing a ranch and a room. The first bot of the group leads it,
+//! the others visit its ranch and enter the rooms it makes.
+struct Group
+{
+  //! Count of the bots in the group.
+  uint32_t size{};
+  //! Character UID of the leader, `0` until the leader logs in.
+  std::atomic<uint32_t> leaderCharacterUid{0};
+  //! UID of the room the leader is in, `0` until the leader enters one.
+  std::atomic<uint32_t> roomUid{0};
+};
+
+template <typename T>
+bool ParseNumber(const std::string_view value, T& number)
+{
+  const auto result = std::from_chars(value.data(), value.data() + value.size(), number);
+  return result.ec == std::errc{} && result.ptr == value.data() + value.size();
+}
+
+//! Parses the scenario.
+//! @param stream Stream of the scenario.
+//! @returns Steps of the scenario.
+//! @throw std::runtime_error If the scenario is malformed.
+std::vector<Step> ParseScenario(std::istream& stream)
+{
+  std::vector<Step> steps;
+
+  std::string line;
+  size_t lineNumber = 0;
+  while (std::getline(stream, line))
+  {
+    ++lineNumber;
+
+    std::istringstream lineStream(line);
+    std::vector<std::string> tokens;
+    for (std::string token; lineStream >> token;)
+      tokens.emplace_back(std::move(token));
+
+    if (tokens.empty() || tokens.front().starts_with('#'))
+      continue;
+
+    const auto& name = tokens.front();
+    const auto parseArguments = [&](Step& step, const size_t argumentCount)
+    {
+      uint32_t interval{};
+      const bool isValid = tokens.size() == argumentCount + 1
+        && (argumentCount < 1 || ParseNumber(tokens[1], step.count))
+        && (argumentCount < 2 || ParseNumber(tokens[2], interval));
+      if (not isValid)
+      {
+        throw std::runtime_error(
+          std::format("Line {}: Invalid arguments of step '{}'", lineNumber, name));
+      }
+      step.interval = std::chrono::milliseconds(interval);
+    };
+
+    Step step;
+    if (name == "login")
+    {
+      step.type = Step::Type::Login;
+      parseArguments(step, 0);
+    }
+    else if (name == "ranch")
+    {
+      step.type = Step::Type::Ranch;
+      parseArguments(step, 0);
+    }
+    else if (name == "snapshot")
+    {
+      step.type = Step::Type::Snapshot;
+      parseArguments(step, 2);
+    }
+    else if (name == "leave-ranch")
+    {
+      step.type = Step::Type::LeaveRanch;
+      parseArguments(step, 0);
+    }
+    else if (name == "race")
+    {
+      step.type = Step::Type::Race;
+      parseArguments(step, 2);
+    }
+    else if (name == "wait")
+    {
+      step.type = Step::Type::Wait;
+      parseArguments(step, 1);
+      step.interval = std::chrono::milliseconds(step.count);
+    }
+    else if (name == "logout")
+    {
+      step.type = Step::Type::Logout;
+      parseArguments(step, 0);
+    }
+    else
+    {
+      throw std::runtime_error(
+        std::format("Line {}: Unknown step '{}'", lineNumber, name));
+    }
+
+    steps.emplace_back(step);
+  }
+
+  if (steps.empty())
+    throw std::runtime_error("The scenario has no steps");
+
+  return steps;
+}
+
+std::optional<Options> ParseOptions(const int argc, char** argv)
+{
+  Options options;
+
+  for (int idx = 1; idx < argc; ++idx)
+  {
+    const std::string_view argument = argv[idx];
+    if (idx + 1 >= argc)
+      return std::nullopt;
+    const std::string_view value = argv[++idx];
+
+    if (argument == "--address")
+    {
+      boost::system::error_code error;
+      options.address = asio::ip::make_address_v4(value, error);
+      if (error)
+        return std::nullopt;
+    }
+    else if (argument == "--port")
+    {
+      if (not ParseNumber(value, options.port))
+        return std::nullopt;
+    }
+    else if (argument == "--bots")
+    {
+      if (not ParseNumber(value, options.bots) || options.bots == 0)
+        return std::nullopt;
+    }
+    else if (argument == "--group")
+    {
+      // The rooms hold at most 8 players.
+      if (not ParseNumber(value, options.groupSize)
+        || options.groupSize == 0
+        || options.groupSize > 8)
+        return std::nullopt;
+    }
+    else if (argument == "--ramp")
+    {
+      if (not ParseNumber(value, options.ramp) || options.ramp < 0.0)
+        return std::nullopt;
+    }
+    else if (argument == "--threads")
+    {
+      if (not ParseNumber(value, options.threads) || options.threads == 0)
+        return std::nullopt;
+    }
+    else if (argument == "--prefix")
+    {
+      options.prefix = value;
+    }
+    else if (argument == "--scenario")
+    {
+      std::ifstream stream{std::filesystem::path(value)};
+      if (not stream.is_open())
+      {
+        spdlog::error("Couldn't open the scenario '{}'", value);
+        return std::nullopt;
+      }
+
+      try
+      {
+        options.scenario = ParseScenario(stream);
+      }
+      catch (const std::exception& x)
+      {
+        spdlog::error("Couldn't parse the scenario '{}': {}", value, x.what());
+        return std::nullopt;
+      }
+    }
+    else
+    {
+      return std::nullopt;
+    }
+  }
+
+  return options;
+}
+
+//! Returns the timestamp embedded by the bots into the commands they send.
+uint64_t GetTimestamp()
+{
+  return static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      Clock::now().time_since_epoch()).count());
+}
+
+//! Records the delay since the embedded timestamp.
+//! @param histogram Histogram to record the delay to.
+//! @param timestamp Embedded timestamp.
+void RecordTimestampDelay(server::util::Histogram& histogram, const uint64_t timestamp)
+{
+  const auto now = GetTimestamp();
+  histogram.Record(now > timestamp ? now - timestamp : 0);
+}
+
+//! A command received from the server.
+struct ReceivedCommand
+{
+  protocol::Command command{};
+  std::vector<std::byte> data;
+
+  //! Reads the command.
+  //! @tparam T Type of the command.
+  //! @returns Read command.
+  //! @throw std::runtime_error If the command data are malformed.
+  template <server::ReadableCommandStruct T>
+  [[nodiscard]] T Read() const
+  {
+    server::SourceStream source({data.data(), data.size()});
+    T command{};
+    source.Read(command);
+    return command;
+  }
+};
+
+//! A connection of a bot to one of the servers.
+class Connection final
+  : public std::enable_shared_from_this<Connection>
+{
+public:
+  //! Handler of the received commands, consuming them before they are queued.
+  //! @returns Whether the command was consumed.
+  using Interceptor = std::function<bool(const ReceivedCommand&)>;
+
+  Connection(const asio::any_io_executor& executor, Statistics& statistics)
+    : _socket(executor)
+    , _signal(executor)
+    , _heartbeatTimer(executor)
+    , _statistics(statistics)
+  {
+  }
+
+  //! Connects to the server and begins reading the commands.
+  //! @throw boost::system::system_error If the connection fails.
+  asio::awaitable<void> Connect(const asio::ip::address_v4 address, const uint16_t port)
+  {
+    co_await _socket.async_connect({address, port}, asio::use_awaitable);
+    _socket.set_option(asio::ip::tcp::no_delay(true));
+
+    asio::co_spawn(_socket.get_executor(), ReadLoop(shared_from_this()), asio::detached);
+  }
+
+  //! Queues the command to be sent to the server.
+  //! @tparam T Type of the command.
+  //! @param command Command.
+  template <server::WritableCommandStruct T>
+  void Send(const T& command)
+  {
+    if (_isClosed)
+      throw std::runtime_error("Connection closed");
+
+    std::array<std::byte, 4096> commandData{};
+    server::SinkStream sink(commandData);
+    sink.Write(command);
+
+    _codec.Encode(
+      static_cast<uint16_t>(T::GetCommand()),
+      {commandData.data(), sink.GetCursor()},
+      _pendingWrite);
+    _statistics.sentCommands.fetch_add(1, std::memory_order::relaxed);
+
+    if (not _isWriting)
+    {
+      _isWriting = true;
+      asio::co_spawn(_socket.get_executor(), WriteLoop(shared_from_this()), asio::detached);
+    }
+  }
+
+  //! Waits for one of the commands.
+  //! Commands received before the wait are returned in the order they were received.
+  //! @param command Command to wait for.
+  //! @param alternatives Other commands to wait for.
+  //! @returns Received command.
+  //! @throw std::runtime_error If the connection closes or the wait times out.
+  template <std::same_as<protocol::Command>... Alternatives>
+  asio::awaitable<ReceivedCommand> Receive(
+    const protocol::Command command,
+    const Alternatives... alternatives)
+  {
+    const auto deadline = Clock::now() + ResponseTimeout;
+    while (true)
+    {
+      const auto commandIter = std::ranges::find_if(
+        _receivedCommands,
+        [command, alternatives...](const ReceivedCommand& receivedCommand)
+        {
+          return receivedCommand.command == command
+            || ((receivedCommand.command == alternatives) || ...);
+        });
+
+      if (commandIter != _receivedCommands.end())
+      {
+        auto receivedCommand = std::move(*commandIter);
+        _receivedCommands.erase(commandIter);
+        co_return receivedCommand;
+      }
+
+      if (_isClosed)
+        throw std::runtime_error("Connection closed by the server");
+      if (Clock::now() >= deadline)
+      {
+        throw std::runtime_error(
+          std::format("Timed out waiting for '{}'", protocol::GetCommandName(command)));
+      }
+
+      // The read loop cancels the wait when a command is received.
+      boost::system::error_code error;
+      _signal.expires_at(deadline);
+      co_await _signal.async_wait(asio::redirect_error(asio::use_awaitable, error));
+    }
+  }
+
+  //! Sets the handler consuming the received commands before they are queued.
+  //! @param interceptor Handler.
+  void SetInterceptor(Interceptor interceptor)
+  {
+    _interceptor = std::move(interceptor);
+  }
+
+  //! Resets the XOR code, mirroring the server resetting the code of the client.
+  void ResetCode()
+  {
+    _codec.SetCode({});
+  }
+
+  //! Begins sending the heartbeat command periodically until the connection closes.
+  //! @tparam T Type of the heartbeat command.
+  template <server::WritableCommandStruct T>
+  void BeginHeartbeat()
+  {
+    asio::co_spawn(
+      _socket.get_executor(),
+      [](std::shared_ptr<Connection> self) -> asio::awaitable<void>
+      {
+        while (not self->_isClosed)
+        {
+          boost::system::error_code error;
+          self->_heartbeatTimer.expires_after(HeartbeatInterval);
+          co_await self->_heartbeatTimer.async_wait(
+            asio::redirect_error(asio::use_awaitable, error));
+
+          if (not self->_isClosed)
+            self->Send(T{});
+        }
+      }(shared_from_this()),
+      asio::detached);
+  }
+
+  //! Closes the connection.
+  void Close()
+  {
+    if (_isClosed)
+      return;
+    _isClosed = true;
+
+    boost::system::error_code error;
+    _signal.cancel();
+    _heartbeatTimer.cancel();
+    _socket.shutdown(asio::ip::tcp::socket::shutdown_both, error);
+    _socket.close(error);
+  }
+
+private:
+  static asio::awaitable<void> ReadLoop(std::shared_ptr<Connection> self)
+  {
+    std::vector<std::byte> buffer(protocol::BufferSize * 4);
+    size_t bufferedSize = 0;
+
+    try
+    {
+      while (not self->_isClosed)
+      {
+        if (bufferedSize == buffer.size())
+          throw std::runtime_error("Command exceeds the read buffer");
+
+        bufferedSize += co_await self->_socket.async_read_some(
+          asio::buffer(buffer.data() + bufferedSize, buffer.size() - bufferedSize),
+          asio::use_awaitable);
+
+        size_t consumedSize = 0;
+        while (const auto magic = server::CommandClientCodec::PeekServerCommand(
+          std::span(buffer).subspan(consumedSize, bufferedSize - consumedSize)))
+        {
+          const auto commandData = std::span(buffer).subspan(
+            consumedSize + sizeof(uint32_t), magic->length - sizeof(uint32_t));
+          consumedSize += magic->length;
+
+          self->OnCommand(ReceivedCommand{
+            .command = static_cast<protocol::Command>(magic->id),
+            .data = {commandData.begin(), commandData.end()}});
+        }
+
+        std::memmove(buffer.data(), buffer.data() + consumedSize, bufferedSize - consumedSize);
+        bufferedSize -= consumedSize;
+      }
+    }
+    catch (const std::exception&)
+    {
+      // The connection was closed by either side.
+    }
+
+    self->Close();
+  }
+
+  static asio::awaitable<void> WriteLoop(std::shared_ptr<Connection> self)
+  {
+    try
+    {
+      while (not self->_pendingWrite.empty() && not self->_isClosed)
+      {
+        std::swap(self->_pendingWrite, self->_activeWrite);
+        co_await asio::async_write(
+          self->_socket, asio::buffer(self->_activeWrite), asio::use_awaitable);
+        self->_activeWrite.clear();
+      }
+    }
+    catch (const std::exception&)
+    {
+      self->Close();
+    }
+
+    self->_isWriting = false;
+  }
+
+  void OnCommand(ReceivedCommand&& receivedCommand)
+  {
+    _statistics.receivedCommands.fetch_add(1, std::memory_order::relaxed);
+
+    if (_interceptor && _interceptor(receivedCommand))
+      return;
+
+    if (_receivedCommands.size() == MaxQueuedCommands)
+      _receivedCommands.pop_front();
+    _receivedCommands.emplace_back(std::move(receivedCommand));
+    _signal.cancel();
+  }
+
+  asio::ip::tcp::socket _socket;
+  //! Timer waited on by the receive, cancelled when a command is received.
+  asio::steady_timer _signal;
+  asio::steady_timer _heartbeatTimer;
+  Statistics& _statistics;
+
+  server::CommandClientCodec _codec;
+  Interceptor _interceptor;
+  std::deque<ReceivedCommand> _receivedCommands;
+
+  std::vector<std::byte> _pendingWrite;
+  std::vector<std::byte> _activeWrite;
+  bool _isWriting{false};
+  bool _isClosed{false};
+};
+
+//! A bot following the scenario.
+class Bot final
+{
+public:
+  Bot(
+    const asio::any_io_executor& executor,
+    std::string name,
+    const bool isLeader,
+    Group& group,
+    const Options& options,
+    Statistics& statistics)
+    : _executor(executor)
+    , _name(std::move(name))
+    , _isLeader(isLeader)
+    , _group(group)
+    , _options(options)
+    , _statistics(statistics)
+  {
+  }
+
+  //! Runs the scenario.
+  asio::awaitable<void> Run()
+  {
+    std::string_view stepName = "connect";
+    try
+    {
+      for (const auto& step : _options.scenario)
+      {
+        stepName = GetStepName(step.type);
+        switch (step.type)
+        {
+          case Step::Type::Login:
+            co_await Login();
+            break;
+          case Step::Type::Ranch:
+            co_await EnterRanch();
+            break;
+          case Step::Type::Snapshot:
+            co_await SendSnapshots(step.count, step.interval);
+            break;
+          case Step::Type::LeaveRanch:
+            Close(_ranch);
+            break;
+          case Step::Type::Race:
+            co_await Race(step.count, step.interval);
+            break;
+          case Step::Type::Wait:
+            co_await Sleep(step.interval);
+            break;
+          case Step::Type::Logout:
+            Close(_race);
+            Close(_ranch);
+            Close(_lobby);
+            break;
+        }
+      }
+
+      _statistics.completedBots.fetch_add(1, std::memory_order::relaxed);
+    }
+    catch (const std::exception& x)
+    {
+      _statistics.failedBots.fetch_add(1, std::memory_order::relaxed);
+      spdlog::warn("Bot '{}' failed at step '{}': {}", _name, stepName, x.what());
+    }
+
+    Close(_race);
+    Close(_ranch);
+    Close(_lobby);
+  }
+
+private:
+  asio::awaitable<void> Login()
+  {
+    if (_lobby)
+      throw std::runtime_error("Already logged in");
+
+    const auto beginTime = Clock::now();
+
+    _lobby = std::make_shared<Connection>(_executor, _statistics);
+    co_await _lobby->Connect(_options.address, _options.port);
+
+    // The local authentication backend accepts any non-empty token.
+    _lobby->Send(protocol::AcCmdCLLogin{
+      .constant0 = 50,
+      .constant1 = 281,
+      .loginId = _name,
+      .authKey = "loadgen"});
+
+    auto response = co_await _lobby->Receive(
+      protocol::Command::AcCmdCLLoginOK,
+      protocol::Command::AcCmdCLLoginCancel,
+      protocol::Command::AcCmdCLCreateNicknameNotify);
+
+    // Bots logging in for the first time create their character.
+    if (response.command == protocol::Command::AcCmdCLCreateNicknameNotify)
+    {
+      _lobby->Send(protocol::AcCmdCLCreateNickname{
+        .nickname = _name,
+        .requestedHorseTid = DefaultHorseTid});
+
+      response = co_await _lobby->Receive(
+        protocol::Command::AcCmdCLLoginOK,
+        protocol::Command::AcCmdCLLoginCancel,
+        protocol::Command::AcCmdCLCreateNicknameCancel);
+    }
+
+    if (response.command != protocol::Command::AcCmdCLLoginOK)
+    {
+      throw std::runtime_error(
+        std::format("Login rejected with '{}'", protocol::GetCommandName(response.command)));
+    }
+
+    // The server resets the code with the login OK.
+    _lobby->ResetCode();
+    _characterUid = response.Read<protocol::LobbyCommandLoginOK>().uid;
+    _statistics.login.Record((Clock::now() - beginTime).count());
+
+    _lobby->BeginHeartbeat<protocol::AcCmdCLHeartbeat>();
+
+    if (_isLeader)
+      _group.leaderCharacterUid.store(_characterUid, std::memory_order::release);
+  }
+
+  asio::awaitable<void> EnterRanch()
+  {
+    RequireLobby();
+    if (_ranch)
+      throw std::runtime_error("Already in a ranch");
+
+    // Visit the ranch of the group leader.
+    const auto rancherUid = co_await WaitFor(_group.leaderCharacterUid, 0);
+
+    const auto beginTime = Clock::now();
+    _lobby->Send(protocol::AcCmdCLEnterRanch{
+      .rancherUid = rancherUid,
+      .unk1 = {},
+      .unk2 = 0});
+
+    const auto response = co_await _lobby->Receive(
+      protocol::Command::AcCmdCLEnterRanchOK,
+      protocol::Command::AcCmdCLEnterRanchCancel);
+    if (response.command != protocol::Command::AcCmdCLEnterRanchOK)
+      throw std::runtime_error("Ranch entry rejected by the lobby");
+
+    const auto enterRanchOk = response.Read<protocol::AcCmdCLEnterRanchOK>();
+
+    _ranch = std::make_shared<Connection>(_executor, _statistics);
+    co_await _ranch->Connect(
+      asio::ip::address_v4(enterRanchOk.ranchAddress),
+      enterRanchOk.ranchPort);
+
+    _ranch->Send(protocol::AcCmdCREnterRanch{
+      .characterUid = _characterUid,
+      .otp = enterRanchOk.otp,
+      .rancherUid = rancherUid});
+
+    const auto ranchResponse = co_await _ranch->Receive(
+      protocol::Command::AcCmdCREnterRanchOK,
+      protocol::Command::AcCmdCREnterRanchCancel);
+    if (ranchResponse.command != protocol::Command::AcCmdCREnterRanchOK)
+      throw std::runtime_error("Ranch entry rejected by the ranch");
+
+    // The server resets the code with the enter ranch OK.
+    _ranch->ResetCode();
+    _statistics.ranchEnter.Record((Clock::now() - beginTime).count());
+
+    // Snapshots are sent for the character's ranch object.
+    const auto enterRanchOkRanch = ranchResponse.Read<protocol::AcCmdCREnterRanchOK>();
+    const auto characterIter = std::ranges::find_if(
+      enterRanchOkRanch.characters,
+      [this](const protocol::RanchCharacter& character)
+      {
+        return character.uid == _characterUid;
+      });
+    if (characterIter == enterRanchOkRanch.characters.cend())
+      throw std::runtime_error("Character missing in the ranch");
+    _ranchOid = characterIter->oid;
+
+    _ranch->SetInterceptor([&statistics = _statistics](const ReceivedCommand& receivedCommand)
+    {
+      if (receivedCommand.command != protocol::Command::AcCmdCRRanchSnapshotNotify)
+        return false;
+
+      // The bots embed the timestamp in the action of the snapshot.
+      const auto notify = receivedCommand.Read<protocol::RanchCommandRanchSnapshotNotify>();
+      RecordTimestampDelay(statistics.snapshotFanOut, notify.full.action);
+      return true;
+    });
+
+    _ranch->BeginHeartbeat<protocol::AcCmdCRHeartbeat>();
+  }
+
+  asio::awaitable<void> SendSnapshots(
+    const uint32_t count,
+    const std::chrono::milliseconds interval)
+  {
+    if (not _ranch)
+      throw std::runtime_error("Not in a ranch");
+
+    for (uint32_t idx = 0; idx < count; ++idx)
+    {
+      protocol::AcCmdCRRanchSnapshot snapshot{
+        .type = protocol::AcCmdCRRanchSnapshot::Full};
+      snapshot.full.ranchIndex = _ranchOid;
+      snapshot.full.time = idx;
+      snapshot.full.action = GetTimestamp();
+
+      _ranch->Send(snapshot);
+      co_await Sleep(interval);
+    }
+  }
+
+  asio::awaitable<void> Race(
+    const uint32_t relayCount,
+    const std::chrono::milliseconds relayInterval)
+  {
+    RequireLobby();
+    if (_race)
+      throw std::runtime_error("Already in a room");
+
+    uint32_t roomUid{};
+    uint32_t otp{};
+    uint32_t raceAddress{};
+    uint16_t racePort{};
+
+    const auto beginTime = Clock::now();
+
+    if (_isLeader)
+    {
+      _lobby->Send(protocol::AcCmdCLMakeRoom{
+        .name = std::format("{} room", _name),
+        .password = {},
+        .playerCount = static_cast<uint8_t>(_group.size),
+        .gameMode = protocol::GameMode::Speed,
+        .teamMode = protocol::TeamMode::FFA,
+        .missionId = 0,
+        .unk3 = 0,
+        .bitset = {},
+        .unk4 = 0});
+
+      const auto response = co_await _lobby->Receive(
+        protocol::Command::AcCmdCLMakeRoomOK,
+        protocol::Command::AcCmdCLMakeRoomCancel);
+      if (response.command != protocol::Command::AcCmdCLMakeRoomOK)
+        throw std::runtime_error("Room creation rejected");
+
+      const auto makeRoomOk = response.Read<protocol::AcCmdCLMakeRoomOK>();
+      roomUid = makeRoomOk.roomUid;
+      otp = makeRoomOk.oneTimePassword;
+      raceAddress = makeRoomOk.raceServerAddress;
+      racePort = makeRoomOk.raceServerPort;
+    }
+    else
+    {
+      // Enter the room the leader made after the previous one.
+      roomUid = co_await WaitFor(_group.roomUid, _lastRoomUid);
+
+      _lobby->Send(protocol::AcCmdCLEnterRoom{
+        .roomUid = roomUid});
+
+      const auto response = co_await _lobby->Receive(
+        protocol::Command::AcCmdCLEnterRoomOK,
+        protocol::Command::AcCmdCLEnterRoomCancel);
+      if (response.command != protocol::Command::AcCmdCLEnterRoomOK)
+        throw std::runtime_error("Room entry rejected");
+
+      const auto enterRoomOk = response.Read<protocol::AcCmdCLEnterRoomOK>();
+      otp = enterRoomOk.oneTimePassword;
+      raceAddress = enterRoomOk.raceServerAddress;
+      racePort = enterRoomOk.raceServerPort;
+    }
+
+    _lastRoomUid = roomUid;
+
+    _race = std::make_shared<Connection>(_executor, _statistics);
+    co_await _race->Connect(asio::ip::address_v4(raceAddress), racePort);
+
+    _race->Send(protocol::AcCmdCREnterRoom{
+      .characterUid = _characterUid,
+      .oneTimePassword = otp,
+      .roomUid = roomUid});
+
+    const auto enterRoomResponse = co_await _race->Receive(
+      protocol::Command::AcCmdCREnterRoomOK,
+      protocol::Command::AcCmdCREnterRoomCancel);
+    if (enterRoomResponse.command != protocol::Command::AcCmdCREnterRoomOK)
+      throw std::runtime_error("Room entry rejected by the race server");
+
+    // The server resets the code with the enter room OK.
+    _race->ResetCode();
+    _statistics.roomJoin.Record((Clock::now() - beginTime).count());
+
+    _race->SetInterceptor([&statistics = _statistics](const ReceivedCommand& receivedCommand)
+    {
+      if (receivedCommand.command != protocol::Command::AcCmdCRRelayNotify)
+        return false;
+
+      // The bots embed the timestamp at the beginning of the relay data.
+      const auto notify = receivedCommand.Read<protocol::AcCmdCRRelayNotify>();
+      uint64_t timestamp{};
+      if (notify.data.size() >= sizeof(timestamp))
+      {
+        std::memcpy(&timestamp, notify.data.data(), sizeof(timestamp));
+        RecordTimestampDelay(statistics.relayFanOut, timestamp);
+      }
+      return true;
+    });
+
+    if (_isLeader)
+    {
+      // The room master enters first, the others enter after the room is published.
+      _group.roomUid.store(roomUid, std::memory_order::release);
+
+      // Wait for the others to get ready and start the race.
+      std::vector<uint32_t> readyCharacterUids;
+      while (readyCharacterUids.size() + 1 < _group.size)
+      {
+        const auto response = co_await _race->Receive(
+          protocol::Command::AcCmdCRReadyRaceNotify);
+        const auto notify = response.Read<protocol::AcCmdCRReadyRaceNotify>();
+        if (notify.isReady
+          && notify.characterUid != _characterUid
+          && std::ranges::find(readyCharacterUids, notify.characterUid) == readyCharacterUids.cend())
+        {
+          readyCharacterUids.emplace_back(notify.characterUid);
+        }
+      }
+
+      _race->Send(protocol::AcCmdCRStartRace{});
+    }
+    else
+    {
+      _race->Send(protocol::AcCmdCRReadyRace{});
+    }
+
+    // The race starts after the room countdown.
+    const auto startResponse = co_await _race->Receive(
+      protocol::Command::AcCmdCRStartRaceNotify,
+      protocol::Command::AcCmdCRStartRaceCancel);
+    if (startResponse.command != protocol::Command::AcCmdCRStartRaceNotify)
+      throw std::runtime_error("Race start rejected");
+
+    _race->Send(protocol::AcCmdCRLoadingComplete{});
+    co_await _race->Receive(protocol::Command::AcCmdUserRaceCountdown);
+    const auto raceBeginTime = Clock::now();
+
+    for (uint32_t idx = 0; idx < relayCount; ++idx)
+    {
+      protocol::AcCmdCRRelay relay{
+        .oid = 0,
+        .member2 = 0,
+        .member3 = 0,
+        .data = std::vector<uint8_t>(RelayDataSize)};
+
+      const auto timestamp = GetTimestamp();
+      std::memcpy(relay.data.data(), &timestamp, sizeof(timestamp));
+
+      _race->Send(relay);
+      co_await Sleep(relayInterval);
+    }
+
+    // Negative progress finishes the race with the course time.
+    _race->Send(protocol::AcCmdUserRaceFinal{
+      .oid = 0,
+      .courseTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+        Clock::now() - raceBeginTime),
+      .member3 = -1.0f});
+
+    co_await _race->Receive(protocol::Command::AcCmdRCRaceResultNotify);
+
+    _race->Send(protocol::AcCmdCRRaceResult{});
+    co_await _race->Receive(protocol::Command::AcCmdCRRaceResultOK);
+
+    _race->Send(protocol::AcCmdCRLeaveRoom{});
+    co_await _race->Receive(protocol::Command::AcCmdCRLeaveRoomOK);
+    Close(_race);
+
+    _statistics.completedRaces.fetch_add(1, std::memory_order::relaxed);
+  }
+
+  //! Waits until the shared value differs from the previous value.
+  //! @returns The new value.
+  //! @throw std::runtime_error If the wait times out.
+  asio::awaitable<uint32_t> WaitFor(
+    const std::atomic<uint32_t>& value,
+    const uint32_t previousValue)
+  {
+    constexpr auto PollInterval = std::chrono::milliseconds(10);
+
+    const auto deadline = Clock::now() + ResponseTimeout;
+    while (true)
+    {
+      const auto currentValue = value.load(std::memory_order::acquire);
+      if (currentValue != 0 && currentValue != previousValue)
+        co_return currentValue;
+
+      if (Clock::now() >= deadline)
+        throw std::runtime_error("Timed out waiting for the group leader");
+
+      co_await Sleep(PollInterval);
+    }
+  }
+
+  asio::awaitable<void> Sleep(const std::chrono::milliseconds duration)
+  {
+    asio::steady_timer timer(_executor, duration);
+    co_await timer.async_wait(asio::use_awaitable);
+  }
+
+  void RequireLobby() const
+  {
+    if (not _lobby)
+      throw std::runtime_error("Not logged in");
+  }
+
+  static void Close(std::shared_ptr<Connection>& connection)
+  {
+    if (not connection)
+      return;
+
+    connection->Close();
+    connection.reset();
+  }
+
+  asio::any_io_executor _executor;
+  const std::string _name;
+  const bool _isLeader;
+  Group& _group;
+  const Options& _options;
+  Statistics& _statistics;
+
+  uint32_t _characterUid{};
+  uint16_t _ranchOid{};
+  uint32_t _lastRoomUid{};
+
+  std::shared_ptr<Connection> _lobby;
+  std::shared_ptr<Connection> _ranch;
+  std::shared_ptr<Connection> _race;
+};
+
+void PrintLatency(const char* name, const server::util::Histogram& histogram)
+{
+  const auto snapshot = histogram.GetSnapshot();
+  const auto toMilliseconds = [](const double nanoseconds)
+  {
+    return nanoseconds / 1'000'000.0;
+  };
+
+  std::printf(
+    "%-18s count %10llu  p50 %9.3fms  p90 %9.3fms  p99 %9.3fms  max %9.3fms\n",
+    name,
+    static_cast<unsigned long long>(snapshot.count),
+    toMilliseconds(static_cast<double>(snapshot.GetPercentile(50.0))),
+    toMilliseconds(static_cast<double>(snapshot.GetPercentile(90.0))),
+    toMilliseconds(static_cast<double>(snapshot.GetPercentile(99.0))),
+    toMilliseconds(static_cast<double>(snapshot.max)));
+}
+
+} // anon namespace
+
+int main(int argc, char** argv)
+{
+  const auto options = ParseOptions(argc, argv);
+  if (not options)
+  {
+    std::fputs(Usage.data(), stderr);
+    return 1;
+  }
+
+  const auto groupCount = (options->bots + options->groupSize - 1) / options->groupSize;
+  spdlog::info(
+    "Simulating {} bots in {} groups of {} against {}:{}",
+    options->bots,
+    groupCount,
+    options->groupSize,
+    options->address.to_string(),
+    options->port);
+
+  Statistics statistics;
+
+  std::vector<std::unique_ptr<Group>> groups;
+  for (uint32_t groupIdx = 0; groupIdx < groupCount; ++groupIdx)
+  {
+    auto& group = groups.emplace_back(std::make_unique<Group>());
+    group->size = std::min(options->groupSize, options->bots - groupIdx * options->groupSize);
+  }
+
+  std::vector<std::unique_ptr<asio::io_context>> ioContexts;
+  for (uint32_t threadIdx = 0; threadIdx < options->threads; ++threadIdx)
+    ioContexts.emplace_back(std::make_unique<asio::io_context>(1));
+
+  const auto beginTime = Clock::now();
+
+  for (uint32_t botIdx = 0; botIdx < options->bots; ++botIdx)
+  {
+    auto& ioContext = *ioContexts[botIdx % ioContexts.size()];
+    auto& group = *groups[botIdx / options->groupSize];
+
+    const auto startDelay = options->ramp > 0.0
+      ? std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<double>(botIdx / options->ramp))
+      : Clock::duration::zero();
+
+    asio::co_spawn(
+      ioContext,
+      [](
+        std::unique_ptr<Bot> bot,
+        asio::any_io_executor executor,
+        Clock::time_point startTime) -> asio::awaitable<void>
+      {
+        asio::steady_timer timer(executor, startTime);
+        co_await timer.async_wait(asio::use_awaitable);
+        co_await bot->Run();
+      }(
+        std::make_unique<Bot>(
+          ioContext.get_executor(),
+          std::format("{}{:04}", options->prefix, botIdx),
+          botIdx % options->groupSize == 0,
+          group,
+          *options,
+          statistics),
+        ioContext.get_executor(),
+        beginTime + startDelay),
+      asio::detached);
+  }
+
+  std::vector<std::thread> threads;
+  for (auto& ioContext : ioContexts)
+  {
+    threads.emplace_back([&ioContext]()
+    {
+      ioContext->run();
+    });
+  }
+
+  for (auto& thread : threads)
+    thread.join();
+
+  const auto elapsed = std::chrono::duration<double>(Clock::now() - beginTime).count();
+  const auto sentCommands = statistics.sentCommands.load();
+  const auto receivedCommands = statistics.receivedCommands.load();
+
+  std::printf("Bots               %10u\n", options->bots);
+  std::printf("Completed          %10llu\n",
+    static_cast<unsigned long long>(statistics.completedBots.load()));
+  std::printf("Failed             %10llu\n",
+    static_cast<unsigned long long>(statistics.failedBots.load()));
+  std::printf("Races              %10llu\n",
+    static_cast<unsigned long long>(statistics.completedRaces.load()));
+  std::printf("Elapsed            %10.3fs\n", elapsed);
+  std::printf("Sent               %10llu commands  %10.1f commands/s\n",
+    static_cast<unsigned long long>(sentCommands),
+    static_cast<double>(sentCommands) / elapsed);
+  std::printf("Received           %10llu commands  %10.1f commands/s\n",
+    static_cast<unsigned long long>(receivedCommands),
+    static_cast<double>(receivedCommands) / elapsed);
+  PrintLatency("Login", statistics.login);
+  PrintLatency("Ranch enter", statistics.ranchEnter);
+  PrintLatency("Room join", statistics.roomJoin);
+  PrintLatency("Snapshot fan-out", statistics.snapshotFanOut);
+  PrintLatency("Relay fan-out", statistics.relayFanOut);
+
+  return statistics.failedBots.load() == 0 ? 0 : 2;
+}
@@ -0,0 +1,606 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include <libserver/network/TrafficCapture.hpp>
+#include <libserver/network/command/CommandClientCodec.hpp>
+#include <libserver/util/Histogram.hpp>
+
+#include <boost/asio.hpp>
+#include <spdlog/spdlog.h>
+
+#include <atomic>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+//! Replays a traffic capture of a command server against a local server.
+//! Every captured connection is replayed on its own socket with the original
+//! timing, scaled by the rate, and the throughput and latency are reported.
+
+namespace
+{
+
+namespace asio = boost::asio;
+
+using Clock = std::chrono::steady_clock;
+using server::network::capture::RecordType;
+
+constexpr std::string_view Usage =
+  "Usage: alicia-replay <capture> [options]\n"
+  "Options:\n"
+  "  --address <address>  Address of the server, defaults to 127.0.0.1.\n"
+  "  --port <port>        Port of the server, defaults to 10030.\n"
+  "  --rate <rate>        Replay rate, 2 replays twice as fast as captured,\n"
+  "                       0 sends the commands as fast as possible. Defaults to 1.\n"
+  "  --clones <count>     Count of the replays of every captured connection. Defaults to 1.\n"
+  "  --threads <count>    Count of the network threads. Defaults to 1.\n"
+  "  --drain <ms>         Time to wait for the responses after the last event\n"
+  "                       of a connection. Defaults to 1000.\n";
+
+//! Options of the replay.
+struct Options
+{
+  std::filesystem::path capturePath;
+  asio::ip::address_v4 address{asio::ip::address_v4::loopback()};
+  uint16_t port{10030};
+  double rate{1.0};
+  uint32_t clones{1};
+  uint32_t threads{1};
+  std::chrono::milliseconds drain{1000};
+};
+
+//! An event of a captured connection.
+struct Event
+{
+  RecordType type{};
+  //! Time of the event since the beginning of the capture.
+  std::chrono::microseconds time{};
+  uint16_t commandId{};
+  std::vector<std::byte> data;
+};
+
+//! A captured connection.
+struct Connection
+{
+  //! Time of the connection since the beginning of the capture.
+  std::chrono::microseconds connectTime{};
+  std::vector<Event> events;
+};
+
+//! Statistics of the replay, shared by all the sessions.
+struct Statistics
+{
+  std::atomic<uint64_t> connectFailures{0};
+  std::atomic<uint64_t> socketErrors{0};
+  std::atomic<uint64_t> sentCommands{0};
+  std::atomic<uint64_t> sentBytes{0};
+  std::atomic<uint64_t> receivedCommands{0};
+  std::atomic<uint64_t> receivedBytes{0};
+  //! Time of the last command sent or received, excludes the draining.
+  std::atomic<Clock::rep> lastCommandTime{0};
+  //! Time from sending a command to receiving the first command
+  //! of the server in nanoseconds.
+  server::util::Histogram responseLatency;
+  //! Delay of the sent commands behind their schedule in nanoseconds.
+  server::util::Histogram scheduleLag;
+};
+
+void UpdateLastCommandTime(Statistics& statistics, const Clock::time_point time)
+{
+  const auto timeValue = time.time_since_epoch().count();
+  auto lastTimeValue = statistics.lastCommandTime.load(std::memory_order::relaxed);
+  while (lastTimeValue < timeValue
+    && not statistics.lastCommandTime.compare_exchange_weak(
+      lastTimeValue, timeValue, std::memory_order::relaxed))
+  {
+  }
+}
+
+template <typename T>
+bool ParseNumber(const std::string_view value, T& number)
+{
+  const auto result = std::from_chars(value.data(), value.data() + value.size(), number);
+  return result.ec == std::errc{} && result.ptr == value.data() + value.size();
+}
+
+std::optional<Options> ParseOptions(const int argc, char** argv)
+{
+  Options options;
+
+  for (int idx = 1; idx < argc; ++idx)
+  {
+    const std::string_view argument = argv[idx];
+    if (not argument.starts_with("--"))
+    {
+      if (not options.capturePath.empty())
+        return std::nullopt;
+      options.capturePath = argument;
+      continue;
+    }
+
+    if (idx + 1 >= argc)
+      return std::nullopt;
+    const std::string_view value = argv[++idx];
+
+    bool isValid = false;
+    if (argument == "--address")
+    {
+      boost::system::error_code error;
+      options.address = asio::ip::make_address_v4(value, error);
+      isValid = not error;
+    }
+    else if (argument == "--port")
+    {
+      isValid = ParseNumber(value, options.port);
+    }
+    else if (argument == "--rate")
+    {
+      isValid = ParseNumber(value, options.rate) && options.rate >= 0.0;
+    }
+    else if (argument == "--clones")
+    {
+      isValid = ParseNumber(value, options.clones) && options.clones > 0;
+    }
+    else if (argument == "--threads")
+    {
+      isValid = ParseNumber(value, options.threads) && options.threads > 0;
+    }
+    else if (argument == "--drain")
+    {
+      uint32_t drain{};
+      isValid = ParseNumber(value, drain);
+      options.drain = std::chrono::milliseconds(drain);
+    }
+
+    if (not isValid)
+      return std::nullopt;
+  }
+
+  if (options.capturePath.empty())
+    return std::nullopt;
+
+  return options;
+}
+
+//! Loads the connections of a capture.
+//! @param path Path to the capture.
+//! @returns Captured connections, ordered by the time of connection.
+//! @throw std::runtime_error If the capture can't be read.
+std::vector<Connection> LoadCapture(const std::filesystem::path& path)
+{
+  server::network::capture::Reader reader(path);
+
+  std::vector<Connection> connections;
+  // Indices of the connections of the connected clients.
+  std::unordered_map<server::network::ClientId, size_t> openConnections;
+
+  server::network::capture::Record record;
+  while (reader.Read(record))
+  {
+    auto openConnectionIter = openConnections.find(record.clientId);
+    if (record.type == RecordType::Connected || openConnectionIter == openConnections.end())
+    {
+      // Client IDs may be reused after a disconnect.
+      connections.emplace_back(Connection{.connectTime = record.time, .events = {}});
+      openConnectionIter = openConnections.insert_or_assign(
+        record.clientId, connections.size() - 1).first;
+
+      if (record.type == RecordType::Connected)
+        continue;
+    }
+
+    auto& connection = connections[openConnectionIter->second];
+    connection.events.emplace_back(Event{
+      .type = record.type,
+      .time = record.time,
+      .commandId = record.commandId,
+      .data = record.data});
+
+    if (record.type == RecordType::Disconnected)
+      openConnections.erase(openConnectionIter);
+  }
+
+  return connections;
+}
+
+//! A replay of a captured connection.
+class Session final
+  : public std::enable_shared_from_this<Session>
+{
+public:
+  Session(
+    asio::io_context& ioContext,
+    const Connection& connection,
+    const Options& options,
+    const Clock::time_point beginTime,
+    Statistics& statistics)
+    : _socket(ioContext)
+    , _timer(ioContext)
+    , _connection(connection)
+    , _options(options)
+    , _beginTime(beginTime)
+    , _statistics(statistics)
+    , _readBuffer(ReadBufferSize)
+  {
+  }
+
+  void Begin()
+  {
+    _timer.expires_at(GetScheduledTime(_connection.connectTime));
+    _timer.async_wait(
+      [self = shared_from_this()](const boost::system::error_code& error)
+      {
+        if (error)
+          return;
+        self->Connect();
+      });
+  }
+
+private:
+  //! Size of the read buffer, fits the largest command.
+  static constexpr size_t ReadBufferSize = 16 * 1024;
+
+  [[nodiscard]] Clock::time_point GetScheduledTime(const std::chrono::microseconds time) const
+  {
+    if (_options.rate <= 0.0)
+      return _beginTime;
+
+    return _beginTime + std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double, std::micro>(time.count() / _options.rate));
+  }
+
+  void Connect()
+  {
+    _socket.async_connect(
+      asio::ip::tcp::endpoint(_options.address, _options.port),
+      [self = shared_from_this()](const boost::system::error_code& error)
+      {
+        if (error)
+        {
+          self->_statistics.connectFailures.fetch_add(1, std::memory_order::relaxed);
+          return;
+        }
+
+        self->_socket.set_option(asio::ip::tcp::no_delay(true));
+        self->ReadLoop();
+        self->ProcessNextEvent();
+      });
+  }
+
+  void ReadLoop()
+  {
+    _socket.async_read_some(
+      asio::buffer(_readBuffer.data() + _readSize, _readBuffer.size() - _readSize),
+      [self = shared_from_this()](const boost::system::error_code& error, const size_t size)
+      {
+        if (error)
+        {
+          if (not self->_isClosed)
+          {
+            self->_statistics.socketErrors.fetch_add(1, std::memory_order::relaxed);
+            self->Close();
+          }
+          return;
+        }
+
+        self->_readSize += size;
+        try
+        {
+          self->OnData();
+        }
+        catch (const std::exception& x)
+        {
+          spdlog::warn("Malformed data received from the server: {}", x.what());
+          self->_statistics.socketErrors.fetch_add(1, std::memory_order::relaxed);
+          self->Close();
+          return;
+        }
+
+        self->ReadLoop();
+      });
+  }
+
+  void OnData()
+  {
+    const auto receivedAt = Clock::now();
+
+    size_t cursor = 0;
+    while (const auto magic = server::CommandClientCodec::PeekServerCommand(
+      std::span(_readBuffer).subspan(cursor, _readSize - cursor)))
+    {
+      cursor += magic->length;
+
+      _statistics.receivedCommands.fetch_add(1, std::memory_order::relaxed);
+      _statistics.receivedBytes.fetch_add(magic->length, std::memory_order::relaxed);
+
+      // The first command received after a sent command is taken as its response.
+      if (_awaitingResponseSince)
+      {
+        _statistics.responseLatency.Record(static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+            receivedAt - *_awaitingResponseSince).count()));
+        _awaitingResponseSince.reset();
+      }
+    }
+
+    if (cursor > 0)
+      UpdateLastCommandTime(_statistics, receivedAt);
+
+    std::memmove(_readBuffer.data(), _readBuffer.data() + cursor, _readSize - cursor);
+    _readSize -= cursor;
+
+    if (_readSize == _readBuffer.size())
+      throw std::runtime_error("Command exceeds the read buffer");
+  }
+
+  void ProcessNextEvent()
+  {
+    if (_isClosed)
+      return;
+
+    if (_eventIdx == _connection.events.size())
+    {
+      // Wait for the responses to the last commands and close.
+      _timer.expires_after(_options.drain);
+      _timer.async_wait(
+        [self = shared_from_this()](const boost::system::error_code& error)
+        {
+          if (error)
+            return;
+          self->Close();
+        });
+      return;
+    }
+
+    const auto scheduledAt = GetScheduledTime(_connection.events[_eventIdx].time);
+    if (Clock::now() < scheduledAt)
+    {
+      _timer.expires_at(scheduledAt);
+      _timer.async_wait(
+        [self = shared_from_this()](const boost::system::error_code& error)
+        {
+          if (error)
+            return;
+          self->ProcessEvent();
+        });
+      return;
+    }
+
+    ProcessEvent();
+  }
+
+  void ProcessEvent()
+  {
+    const auto& event = _connection.events[_eventIdx++];
+    switch (event.type)
+    {
+      case RecordType::Code:
+      {
+        server::protocol::XorCode code{};
+        std::ranges::copy(event.data, code.begin());
+        _codec.SetCode(code);
+        ProcessNextEvent();
+        break;
+      }
+      case RecordType::Command:
+      {
+        const auto now = Clock::now();
+        if (_options.rate > 0.0)
+        {
+          _statistics.scheduleLag.Record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+              now - GetScheduledTime(event.time)).count()));
+        }
+
+        _writeBuffer.clear();
+        _codec.Encode(event.commandId, event.data, _writeBuffer);
+
+        if (not _awaitingResponseSince)
+          _awaitingResponseSince = now;
+
+        asio::async_write(
+          _socket,
+          asio::buffer(_writeBuffer),
+          [self = shared_from_this()](const boost::system::error_code& error, const size_t size)
+          {
+            if (error)
+            {
+              if (not self->_isClosed)
+              {
+                self->_statistics.socketErrors.fetch_add(1, std::memory_order::relaxed);
+                self->Close();
+              }
+              return;
+            }
+
+            self->_statistics.sentCommands.fetch_add(1, std::memory_order::relaxed);
+            self->_statistics.sentBytes.fetch_add(size, std::memory_order::relaxed);
+            UpdateLastCommandTime(self->_statistics, Clock::now());
+            self->ProcessNextEvent();
+          });
+        break;
+      }
+      case RecordType::Disconnected:
+      default:
+      {
+        // Disconnected is the last event, the responses are drained before closing.
+        ProcessNextEvent();
+        break;
+      }
+    }
+  }
+
+  void Close()
+  {
+    if (_isClosed)
+      return;
+    _isClosed = true;
+
+    boost::system::error_code error;
+    _timer.cancel();
+    _socket.shutdown(asio::ip::tcp::socket::shutdown_both, error);
+    _socket.close(error);
+  }
+
+  asio::ip::tcp::socket _socket;
+  asio::steady_timer _timer;
+
+  const Connection& _connection;
+  const Options& _options;
+  const Clock::time_point _beginTime;
+  Statistics& _statistics;
+
+  server::CommandClientCodec _codec;
+  size_t _eventIdx{0};
+  bool _isClosed{false};
+  std::optional<Clock::time_point> _awaitingResponseSince;
+
+  std::vector<std::byte> _writeBuffer;
+  std::vector<std::byte> _readBuffer;
+  size_t _readSize{0};
+};
+
+void PrintLatency(const char* name, const server::util::Histogram& histogram)
+{
+  const auto snapshot = histogram.GetSnapshot();
+  const auto toMilliseconds = [](const double nanoseconds)
+  {
+    return nanoseconds / 1'000'000.0;
+  };
+
+  std::printf(
+    "%-18s count %10llu  p50 %9.3fms  p90 %9.3fms  p99 %9.3fms  max %9.3fms\n",
+    name,
+    static_cast<unsigned long long>(snapshot.count),
+    toMilliseconds(static_cast<double>(snapshot.GetPercentile(50.0))),
+    toMilliseconds(static_cast<double>(snapshot.GetPercentile(90.0))),
+    toMilliseconds(static_cast<double>(snapshot.GetPercentile(99.0))),
+    toMilliseconds(static_cast<double>(snapshot.max)));
+}
+
+} // anon namespace
+
+int main(int argc, char** argv)
+{
+  const auto options = ParseOptions(argc, argv);
+  if (not options)
+  {
+    std::fputs(Usage.data(), stderr);
+    return 1;
+  }
+
+  std::vector<Connection> connections;
+  try
+  {
+    connections = LoadCapture(options->capturePath);
+  }
+  catch (const std::exception& x)
+  {
+    spdlog::error("Couldn't load the capture: {}", x.what());
+    return 1;
+  }
+
+  size_t commandCount = 0;
+  std::chrono::microseconds captureDuration{};
+  for (const auto& connection : connections)
+  {
+    captureDuration = std::max(captureDuration, connection.connectTime);
+    for (const auto& event : connection.events)
+    {
+      if (event.type == RecordType::Command)
+        ++commandCount;
+      captureDuration = std::max(captureDuration, event.time);
+    }
+  }
+
+  spdlog::info(
+    "Replaying {} connections with {} commands captured over {}ms, {} times each, at rate {}",
+    connections.size(),
+    commandCount,
+    std::chrono::duration_cast<std::chrono::milliseconds>(captureDuration).count(),
+    options->clones,
+    options->rate);
+
+  Statistics statistics;
+
+  std::vector<std::unique_ptr<asio::io_context>> ioContexts;
+  for (uint32_t threadIdx = 0; threadIdx < options->threads; ++threadIdx)
+    ioContexts.emplace_back(std::make_unique<asio::io_context>(1));
+
+  // Leave time to set up the sessions before the first connection is due.
+  const auto beginTime = Clock::now() + std::chrono::milliseconds(100);
+
+  size_t sessionIdx = 0;
+  for (uint32_t clone = 0; clone < options->clones; ++clone)
+  {
+    for (const auto& connection : connections)
+    {
+      auto& ioContext = *ioContexts[sessionIdx++ % ioContexts.size()];
+      std::make_shared<Session>(
+        ioContext, connection, *options, beginTime, statistics)->Begin();
+    }
+  }
+
+  std::vector<std::thread> threads;
+  for (auto& ioContext : ioContexts)
+  {
+    threads.emplace_back([&ioContext]()
+    {
+      ioContext->run();
+    });
+  }
+
+  for (auto& thread : threads)
+    thread.join();
+
+  // The throughput is measured until the last command, not until the sessions drained.
+  const auto lastCommandTime = Clock::time_point(
+    Clock::duration(statistics.lastCommandTime.load()));
+  const auto elapsed = std::chrono::duration<double>(
+    std::max(lastCommandTime, beginTime + std::chrono::milliseconds(1)) - beginTime).count();
+  const auto sentCommands = statistics.sentCommands.load();
+  const auto receivedCommands = statistics.receivedCommands.load();
+
+  std::printf("Sessions           %10zu\n", sessionIdx);
+  std::printf("Connect failures   %10llu\n",
+    static_cast<unsigned long long>(statistics.connectFailures.load()));
+  std::printf("Socket errors      %10llu\n",
+    static_cast<unsigned long long>(statistics.socketErrors.load()));
+  std::printf("Elapsed            %10.3fs\n", elapsed);
+  std::printf("Sent               %10llu commands  %12llu bytes  %10.1f commands/s\n",
+    static_cast<unsigned long long>(sentCommands),
+    static_cast<unsigned long long>(statistics.sentBytes.load()),
+    static_cast<double>(sentCommands) / elapsed);
+  std::printf("Received           %10llu commands  %12llu bytes  %10.1f commands/s\n",
+    static_cast<unsigned long long>(receivedCommands),
+    static_cast<unsigned long long>(statistics.receivedBytes.load()),
+    static_cast<double>(receivedCommands) / elapsed);
+  PrintLatency("Response latency", statistics.responseLatency);
+  if (options->rate > 0.0)
+    PrintLatency("Schedule lag", statistics.scheduleLag);
+
+  return 0;
+}
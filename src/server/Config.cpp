@@ -130,6 +130,13 @@ void Config::LoadFromEnvironment()
     std::format("PRIVATE_CHAT_SERVER_PORT"),
     privateChat.listen.address,
     privateChat.listen.port);
+
+  // Admin address and port.
+  getAddressAndPortVariables(
+    std::format("ADMIN_SERVER_ADDRESS"),
+    std::format("ADMIN_SERVER_PORT"),
+    admin.listen.address,
+    admin.listen.port);
 }
 
 void Config::LoadFromFile(const std::filesystem::path& filePath)
@@ -161,11 +168,48 @@ void Config::LoadFromFile(const std::filesystem::path& filePath)
     return Listen{};
   };
 
+  const auto parseSocketSection = [](const YAML::Node& node, network::SocketOptions options)
+  {
+    if (not node)
+      return options;
+
+    try
+    {
+      options.noDelay = node["noDelay"].as<bool>(options.noDelay);
+      options.sendBufferSize = node["sendBufferSize"].as<uint32_t>(options.sendBufferSize);
+      options.receiveBufferSize = node["receiveBufferSize"].as<uint32_t>(options.receiveBufferSize);
+      options.keepAlive = node["keepAlive"].as<bool>(options.keepAlive);
+      options.keepAliveIdle = std::chrono::seconds(
+        node["keepAliveIdle"].as<uint32_t>(options.keepAliveIdle.count()));
+      options.keepAliveInterval = std::chrono::seconds(
+        node["keepAliveInterval"].as<uint32_t>(options.keepAliveInterval.count()));
+      options.keepAliveCount = node["keepAliveCount"].as<uint32_t>(options.keepAliveCount);
+      options.userTimeout = std::chrono::milliseconds(
+        node["userTimeout"].as<uint32_t>(options.userTimeout.count()));
+    }
+    catch (const std::exception& e)
+    {
+      spdlog::error("Failed parsing socket options: {}", e.what());
+    }
+
+    return options;
+  };
+
   try
   {
     const YAML::Node yamlConfig = YAML::Load(file);
     const auto serverYaml = yamlConfig["server"];
 
+    // Socket config, the defaults of the listeners
+    try
+    {
+      socket = parseSocketSection(serverYaml["socket"], socket);
+    }
+    catch (const std::exception& e)
+    {
+      spdlog::error("Unhandled exception parsing the socket config: {}", e.what());
+    }
+
     // General config
     try
     {
@@ -196,6 +240,7 @@ void Config::LoadFromFile(const std::filesystem::path& filePath)
       const auto lobbyYaml = serverYaml["lobby"];
       lobby.enabled = lobbyYaml["enabled"].as<bool>();
       lobby.listen = parseListenSection(lobbyYaml["listen"]);
+      lobby.socket = parseSocketSection(lobbyYaml["socket"], socket);
 
       const auto lobbyAdvertisementYaml = lobbyYaml["advertisement"];
       lobby.advertisement.ranch = parseListenSection(lobbyAdvertisementYaml["ranch"]);
@@ -215,6 +260,7 @@ void Config::LoadFromFile(const std::filesystem::path& filePath)
       const auto ranchYaml = serverYaml["ranch"];
       ranch.enabled = ranchYaml["enabled"].as<bool>();
       ranch.listen = parseListenSection(ranchYaml["listen"]);
+      ranch.socket = parseSocketSection(ranchYaml["socket"], socket);
     }
     catch (const std::exception& e)
     {
@@ -227,6 +273,7 @@ void Config::LoadFromFile(const std::filesystem::path& filePath)
       const auto raceYaml = serverYaml["race"];
       race.enabled = raceYaml["enabled"].as<bool>();
       race.listen = parseListenSection(raceYaml["listen"]);
+      race.socket = parseSocketSection(raceYaml["socket"], socket);
     }
     catch (const std::exception& e)
     {
@@ -239,6 +286,7 @@ void Config::LoadFromFile(const std::filesystem::path& filePath)
       const auto messengerYaml = serverYaml["messenger"];
       messenger.enabled = messengerYaml["enabled"].as<bool>();
       messenger.listen = parseListenSection(messengerYaml["listen"]);
+      messenger.socket = parseSocketSection(messengerYaml["socket"], socket);
     }
     catch (const std::exception& e)
     {
@@ -251,6 +299,7 @@ void Config::LoadFromFile(const std::filesystem::path& filePath)
       const auto allChatYaml = serverYaml["all_chat"];
       allChat.enabled = allChatYaml["enabled"].as<bool>();
       allChat.listen = parseListenSection(allChatYaml["listen"]);
+      allChat.socket = parseSocketSection(allChatYaml["socket"], socket);
     }
     catch (const std::exception& e)
     {
@@ -263,13 +312,92 @@ void Config::LoadFromFile(const std::filesystem::path& filePath)
       const auto privateChatYaml = serverYaml["private_chat"];
       privateChat.enabled = privateChatYaml["enabled"].as<bool>();
       privateChat.listen = parseListenSection(privateChatYaml["listen"]);
+      privateChat.socket = parseSocketSection(privateChatYaml["socket"], socket);
     }
     catch (const std::exception& e)
     {
       spdlog::error("Unhandled exception parsing the private chat config: {}", e.what());
     }
 
-    // Messenger config
+    // Admin config
+    try
+    {
+      const auto adminYaml = serverYaml["admin"];
+      if (adminYaml)
+      {
+        admin.enabled = adminYaml["enabled"].as<bool>();
+        admin.listen = parseListenSection(adminYaml["listen"]);
+        admin.deltaInterval = adminYaml["deltaInterval"].as<uint32_t>(admin.deltaInterval);
+      }
+    }
+    catch (const std::exception& e)
+    {
+      spdlog::error("Unhandled exception parsing the admin config: {}", e.what());
+    }
+
+    // Capture config
+    try
+    {
+      const auto captureYaml = serverYaml["capture"];
+      if (captureYaml)
+      {
+        capture.enabled = captureYaml["enabled"].as<bool>();
+        capture.directory = captureYaml["directory"].as<std::string>(capture.directory);
+      }
+    }
+    catch (const std::exception& e)
+    {
+      spdlog::error("Unhandled exception parsing the capture config: {}", e.what());
+    }
+
+    // Trace config
+    try
+    {
+      const auto traceYaml = serverYaml["trace"];
+      if (traceYaml)
+      {
+        trace.enabled = traceYaml["enabled"].as<bool>(trace.enabled);
+        trace.bufferSize = traceYaml["bufferSize"].as<size_t>(trace.bufferSize);
+        trace.directory = traceYaml["directory"].as<std::string>(trace.directory);
+      }
+    }
+    catch (const std::exception& e)
+    {
+      spdlog::error("Unhandled exception parsing the trace config: {}", e.what());
+    }
+
+    // Memory config
+    try
+    {
+      const auto memoryYaml = serverYaml["memory"];
+      if (memoryYaml)
+      {
+        memory.reportInterval = memoryYaml["reportInterval"].as<uint32_t>(memory.reportInterval);
+        memory.logReports = memoryYaml["logReports"].as<bool>(memory.logReports);
+      }
+    }
+    catch (const std::exception& e)
+    {
+      spdlog::error("Unhandled exception parsing the memory config: {}", e.what());
+    }
+
+    // Handoff config
+    try
+    {
+      const auto handoffYaml = serverYaml["handoff"];
+      if (handoffYaml)
+      {
+        handoff.enabled = handoffYaml["enabled"].as<bool>(handoff.enabled);
+        handoff.path = handoffYaml["path"].as<std::string>(handoff.path);
+        handoff.drainTimeout = handoffYaml["drainTimeout"].as<uint32_t>(handoff.drainTimeout);
+      }
+    }
+    catch (const std::exception& e)
+    {
+      spdlog::error("Unhandled exception parsing the handoff config: {}", e.what());
+    }
+
+    // Data config
     try
     {
       const auto dataYaml = serverYaml["data"];
@@ -289,6 +417,46 @@ void Config::LoadFromFile(const std::filesystem::path& filePath)
     {
       spdlog::error("Unhandled exception parsing the dat config: {}", e.what());
     }
+
+    // Logging config
+    try
+    {
+      const auto loggingYaml = serverYaml["logging"];
+      if (loggingYaml)
+      {
+        logging.async = loggingYaml["async"].as<bool>(logging.async);
+        logging.queueSize = loggingYaml["queueSize"].as<size_t>(logging.queueSize);
+        logging.level = loggingYaml["level"].as<std::string>(logging.level);
+
+        const auto overflowPolicyName = loggingYaml["overflowPolicy"].as<std::string>("block");
+        if (overflowPolicyName == "block")
+          logging.overflowPolicy = Logging::OverflowPolicy::Block;
+        else if (overflowPolicyName == "overrun_oldest")
+          logging.overflowPolicy = Logging::OverflowPolicy::OverrunOldest;
+        else if (overflowPolicyName == "discard_new")
+          logging.overflowPolicy = Logging::OverflowPolicy::DiscardNew;
+        else
+          spdlog::error("Unsupported log overflow policy: {}", overflowPolicyName);
+
+        const auto readDumps = [](const YAML::Node& dumpsYaml, Logging::CommandDataDumps& dumps)
+        {
+          if (not dumpsYaml)
+            return;
+
+          dumps.incoming = dumpsYaml["incoming"].as<std::vector<std::string>>(
+            std::vector<std::string>{});
+          dumps.outgoing = dumpsYaml["outgoing"].as<std::vector<std::string>>(
+            std::vector<std::string>{});
+        };
+
+        readDumps(loggingYaml["commandDataDumps"], logging.commandDataDumps);
+        readDumps(loggingYaml["chatterCommandDataDumps"], logging.chatterCommandDataDumps);
+      }
+    }
+    catch (const std::exception& e)
+    {
+      spdlog::error("Unhandled exception parsing the logging config: {}", e.what());
+    }
   }
   catch (const std::exception& e)
   {
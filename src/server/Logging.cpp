@@ -0,0 +1,139 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "server/Logging.hpp"
+
+#include <spdlog/async.h>
+#include <spdlog/sinks/daily_file_sink.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/spdlog.h>
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace server
+{
+
+namespace
+{
+
+constexpr std::string_view LoggerName = "server";
+constexpr std::string_view LoggerPattern = "%H:%M:%S:%e [%^%l%$] [Thread %t] %v";
+
+//! Sinks shared by the synchronous and the asynchronous logger.
+std::vector<spdlog::sink_ptr> sinks;
+
+spdlog::async_overflow_policy ToSpdlogOverflowPolicy(
+  const Config::Logging::OverflowPolicy policy)
+{
+  switch (policy)
+  {
+    case Config::Logging::OverflowPolicy::OverrunOldest:
+      return spdlog::async_overflow_policy::overrun_oldest;
+    case Config::Logging::OverflowPolicy::DiscardNew:
+      return spdlog::async_overflow_policy::discard_new;
+    case Config::Logging::OverflowPolicy::Block:
+    default:
+      return spdlog::async_overflow_policy::block;
+  }
+}
+
+} // anon namespace
+
+void InitializeLogging(const std::filesystem::path& logDirectory)
+{
+  // Daily file sink.
+  const auto fileSink = std::make_shared<spdlog::sinks::daily_file_sink_mt>(
+    (logDirectory / "log.txt").string(), 0, 0);
+
+  // Console sink.
+  const auto consoleSink = std::make_shared<
+    spdlog::sinks::stdout_color_sink_mt>();
+
+  sinks = {fileSink, consoleSink};
+
+  // Initialize the application logger with file sink and console sink.
+  const auto logger = std::make_shared<spdlog::logger>(
+    std::string(LoggerName),
+    sinks.begin(),
+    sinks.end());
+
+  logger->set_level(spdlog::level::debug);
+  logger->set_pattern(std::string(LoggerPattern));
+
+  // Set is as the default logger for the application.
+  spdlog::set_default_logger(logger);
+}
+
+void ConfigureLogging(const Config::Logging& config)
+{
+  std::shared_ptr<spdlog::logger> logger;
+
+  if (config.async)
+  {
+    // A single worker thread keeps the order of the messages.
+    spdlog::init_thread_pool(config.queueSize, 1);
+
+    logger = std::make_shared<spdlog::async_logger>(
+      std::string(LoggerName),
+      sinks.begin(),
+      sinks.end(),
+      spdlog::thread_pool(),
+      ToSpdlogOverflowPolicy(config.overflowPolicy));
+  }
+  else
+  {
+    logger = std::make_shared<spdlog::logger>(
+      std::string(LoggerName),
+      sinks.begin(),
+      sinks.end());
+  }
+
+  const auto level = spdlog::level::from_str(config.level);
+  if (level == spdlog::level::off && config.level != "off")
+  {
+    spdlog::warn("Unknown log level '{}', keeping debug", config.level);
+    logger->set_level(spdlog::level::debug);
+  }
+  else
+  {
+    logger->set_level(level);
+  }
+
+  logger->set_pattern(std::string(LoggerPattern));
+  // Errors are flushed right away so that they survive a crash.
+  logger->flush_on(spdlog::level::err);
+
+  spdlog::set_default_logger(logger);
+
+  if (config.async)
+  {
+    spdlog::info(
+      "Logging asynchronously with a queue of {} messages",
+      config.queueSize);
+  }
+}
+
+void TerminateLogging()
+{
+  spdlog::shutdown();
+}
+
+} // namespace server
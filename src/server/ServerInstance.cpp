@@ -18,6 +18,11 @@
  **/
 
 #include "server/ServerInstance.hpp"
+#include "server/Logging.hpp"
+#include "server/lobby/LobbyNetworkHandler.hpp"
+
+#include <libserver/network/chatter/ChatterServer.hpp>
+#include <libserver/network/command/CommandServer.hpp>
 
 #ifndef DISABLE_STACKTRACE
 #include <stacktrace>
@@ -38,6 +43,44 @@ void DumpStackTrace()
   #endif
 }
 
+//! Time limit of the servers beginning, after which the inherited
+//! listening sockets not adopted by any server are closed.
+constexpr std::chrono::seconds ServerBeginTimeout{10};
+
+//! Time allowed to the previous process to write out its data once
+//! its clients were disconnected, on top of the drain timeout.
+constexpr std::chrono::seconds HandoffReleaseAllowance{60};
+
+std::filesystem::path GetCourseRegistryConfigPath(const std::filesystem::path& resourceDirectory)
+{
+  return resourceDirectory / "config/game/courses.yaml";
+}
+
+std::filesystem::path GetItemRegistryConfigPath(const std::filesystem::path& resourceDirectory)
+{
+  return resourceDirectory / "config/game/items.yaml";
+}
+
+std::filesystem::path GetMagicRegistryConfigPath(const std::filesystem::path& resourceDirectory)
+{
+  return resourceDirectory / "config/game/magic.yaml";
+}
+
+std::filesystem::path GetPetRegistryConfigPath(const std::filesystem::path& resourceDirectory)
+{
+  return resourceDirectory / "config/game/pets.yaml";
+}
+
+void WaitForThread(const std::string& threadName, std::thread& thread)
+{
+  if (thread.joinable())
+  {
+    spdlog::debug("Waiting for the '{}' thread to finish...", threadName);
+    thread.join();
+    spdlog::debug("Thread for '{}' finished", threadName);
+  }
+}
+
 } // anon namespace
 
 ServerInstance::ServerInstance(
@@ -51,32 +94,37 @@ ServerInstance::ServerInstance(
   , _privateChatDirector(*this)
   , _ranchDirector(*this)
   , _raceDirector(*this)
+  , _adminDirector(*this)
   , _chatSystem(*this)
   , _infractionSystem(*this)
   , _itemSystem(*this)
+  , _handoffProvider([this]()
+    {
+      return GetListenerHandles();
+    })
 {
 }
 
 ServerInstance::~ServerInstance()
 {
-  const auto waitForThread = [](const std::string& threadName, std::thread& thread)
-  {
-    if (thread.joinable())
-    {
-      spdlog::debug("Waiting for the '{}' thread to finish...", threadName);
-      thread.join();
-      spdlog::debug("Thread for '{}' finished", threadName);
-    }
-  };
+  WaitForThread("handoff", _handoffThread);
+  JoinDirectorThreads();
+
+  // No thread logs from now on, write out the queued messages.
+  TerminateLogging();
+}
 
-  waitForThread("race director", _raceDirectorThread);
-  waitForThread("ranch director", _ranchDirectorThread);
-  waitForThread("private chat director", _privateChatDirectorThread);
-  waitForThread("all chat director", _allChatDirectorThread);
-  waitForThread("messenger director", _messengerThread);
-  waitForThread("lobby director", _lobbyDirectorThread);
-  waitForThread("data director", _dataDirectorThread);
-  waitForThread("authentication", _authenticationThread);
+void ServerInstance::JoinDirectorThreads()
+{
+  WaitForThread("admin director", _adminDirectorThread);
+  WaitForThread("race director", _raceDirectorThread);
+  WaitForThread("ranch director", _ranchDirectorThread);
+  WaitForThread("private chat director", _privateChatDirectorThread);
+  WaitForThread("all chat director", _allChatDirectorThread);
+  WaitForThread("messenger director", _messengerThread);
+  WaitForThread("lobby director", _lobbyDirectorThread);
+  WaitForThread("data director", _dataDirectorThread);
+  WaitForThread("authentication", _authenticationThread);
 }
 
 void ServerInstance::Initialize()
@@ -86,25 +134,69 @@ void ServerInstance::Initialize()
   _config.LoadFromFile(_resourceDirectory / "config/server/config.yaml");
   _config.LoadFromEnvironment();
 
+  // Configure the logging before any of the directors start logging.
+  ConfigureLogging(_config.logging);
+
+  spdlog::info("Using the {} network I/O backend", network::GetIoBackendName());
+
+  util::trace::SetBufferCapacity(_config.trace.bufferSize);
+  util::trace::SetEnabled(_config.trace.enabled);
+  CommandServer::SetCommandDataDumps(
+    _config.logging.commandDataDumps.incoming,
+    _config.logging.commandDataDumps.outgoing);
+  ChatterServer::SetCommandDataDumps(
+    _config.logging.chatterCommandDataDumps.incoming,
+    _config.logging.chatterCommandDataDumps.outgoing);
+
+  // Inherit the listening sockets of the process being replaced before the servers begin,
+  // the servers adopt them instead of binding their own.
+  if (_config.handoff.enabled)
+  {
+    try
+    {
+      // The previous process disconnects its clients and writes out its data
+      // before this process serves any client or reads any data.
+      const auto inheritedCount = network::handoff::InheritListeners(
+        _config.handoff.path,
+        std::chrono::seconds(_config.handoff.drainTimeout) + HandoffReleaseAllowance);
+      if (inheritedCount > 0)
+        spdlog::info("Inherited {} listening sockets from the previous process", inheritedCount);
+    }
+    catch (const std::exception& x)
+    {
+      spdlog::error("Failed to inherit the listening sockets: {}", x.what());
+    }
+  }
+
   // Read configurations
 
-  _courseRegistry.ReadConfig(_resourceDirectory / "config/game/courses.yaml");
-  _itemRegistry.ReadConfig(_resourceDirectory / "config/game/items.yaml");
-  _magicRegistry.ReadConfig(_resourceDirectory / "config/game/magic.yaml");
-  _petRegistry.ReadConfig(_resourceDirectory / "config/game/pets.yaml");
+  _courseRegistry.ReadConfig(GetCourseRegistryConfigPath(_resourceDirectory));
+  _itemRegistry.ReadConfig(GetItemRegistryConfigPath(_resourceDirectory));
+  _magicRegistry.ReadConfig(GetMagicRegistryConfigPath(_resourceDirectory));
+  _petRegistry.ReadConfig(GetPetRegistryConfigPath(_resourceDirectory));
 
   _moderationSystem.ReadConfig(_resourceDirectory / "config/server/automod.yaml");
 
+  PublishRegistryMemoryUsage();
+
   // Initialize the directors and tick them on their own threads.
   // Directors will terminate their tick loop once `_shouldRun` flag is set to false.
 
+  // The tick times are read by the admin director, the map must not change
+  // once the threads start.
+  for (const auto directorName : {
+    "authentication", "data", "lobby", "messenger", "all_chat", "private_chat", "ranch", "race", "admin"})
+  {
+    _directorTickTimes.try_emplace(directorName);
+  }
+
   // Authentication service
   _authenticationThread = std::thread([this]()
   {
     try
     {
       _authenticationService.Initialize();
-      RunDirectorTaskLoop(_authenticationService);
+      RunDirectorTaskLoop(_authenticationService, "authentication");
       _authenticationService.Terminate();
     }
     catch (const std::exception& x)
@@ -122,7 +214,7 @@ void ServerInstance::Initialize()
     try
     {
       _dataDirector.Initialize();
-      RunDirectorTaskLoop(_dataDirector);
+      RunDirectorTaskLoop(_dataDirector, "data");
       _dataDirector.Terminate();
     }
     catch (const std::exception& x)
@@ -140,7 +232,7 @@ void ServerInstance::Initialize()
     try
     {
       _lobbyDirector.Initialize();
-      RunDirectorTaskLoop(_lobbyDirector);
+      RunDirectorTaskLoop(_lobbyDirector, "lobby");
       _lobbyDirector.Terminate();
     }
     catch (const std::exception& x)
@@ -160,7 +252,7 @@ void ServerInstance::Initialize()
       try
       {
         _messengerDirector.Initialize();
-        RunDirectorTaskLoop(_messengerDirector);
+        RunDirectorTaskLoop(_messengerDirector, "messenger");
         _messengerDirector.Terminate();
       }
       catch (const std::exception& x)
@@ -180,7 +272,7 @@ void ServerInstance::Initialize()
         try
         {
           _allChatDirector.Initialize();
-          RunDirectorTaskLoop(_allChatDirector);
+          RunDirectorTaskLoop(_allChatDirector, "all_chat");
           _allChatDirector.Terminate();
         }
         catch (const std::exception& x)
@@ -201,7 +293,7 @@ void ServerInstance::Initialize()
         try
         {
           _privateChatDirector.Initialize();
-          RunDirectorTaskLoop(_privateChatDirector);
+          RunDirectorTaskLoop(_privateChatDirector, "private_chat");
           _privateChatDirector.Terminate();
         }
         catch (const std::exception& x)
@@ -221,7 +313,7 @@ void ServerInstance::Initialize()
     try
     {
       _ranchDirector.Initialize();
-      RunDirectorTaskLoop(_ranchDirector);
+      RunDirectorTaskLoop(_ranchDirector, "ranch");
       _ranchDirector.Terminate();
     }
     catch (const std::exception& x)
@@ -239,7 +331,7 @@ void ServerInstance::Initialize()
     try
     {
       _raceDirector.Initialize();
-      RunDirectorTaskLoop(_raceDirector);
+      RunDirectorTaskLoop(_raceDirector, "race");
       _raceDirector.Terminate();
     }
     catch (const std::exception& x)
@@ -250,11 +342,192 @@ void ServerInstance::Initialize()
       _shouldRun = false;
     }
   });
+
+  // Admin director
+  if (_config.admin.enabled)
+  {
+    _adminDirectorThread = std::thread([this]()
+    {
+      try
+      {
+        _adminDirector.Initialize();
+        RunDirectorTaskLoop(_adminDirector, "admin");
+        _adminDirector.Terminate();
+      }
+      catch (const std::exception& x)
+      {
+        // The admin endpoint is not essential, the server keeps running without it.
+        spdlog::error("Unhandled exception in the admin director: {}", x.what());
+        DumpStackTrace();
+      }
+    });
+  }
+
+  // Handoff
+  if (_config.handoff.enabled)
+  {
+    _handoffThread = std::thread([this]()
+    {
+      try
+      {
+        RunHandoff();
+      }
+      catch (const std::exception& x)
+      {
+        // The handoff is not essential, the server keeps running without it.
+        spdlog::error("Unhandled exception in the handoff: {}", x.what());
+        DumpStackTrace();
+      }
+    });
+  }
 }
 
 void ServerInstance::Terminate()
 {
   _shouldRun.store(false, std::memory_order::relaxed);
+  _handoffProvider.End();
+}
+
+bool ServerInstance::IsRunning() const
+{
+  return _shouldRun.load(std::memory_order::relaxed);
+}
+
+std::vector<network::handoff::ListenerHandle> ServerInstance::GetListenerHandles()
+{
+  const std::array listenerHandles{
+    _lobbyDirector.GetNetworkHandler().GetCommandServer().GetListenerHandle(),
+    _ranchDirector.GetCommandServer().GetListenerHandle(),
+    _raceDirector.GetCommandServer().GetListenerHandle(),
+    _messengerDirector.GetChatterServer().GetListenerHandle(),
+    _allChatDirector.GetChatterServer().GetListenerHandle(),
+    _privateChatDirector.GetChatterServer().GetListenerHandle()};
+
+  std::vector<network::handoff::ListenerHandle> handles;
+  for (const auto& listenerHandle : listenerHandles)
+  {
+    if (listenerHandle)
+      handles.emplace_back(*listenerHandle);
+  }
+
+  return handles;
+}
+
+void ServerInstance::RunHandoff()
+{
+  using Clock = std::chrono::steady_clock;
+
+  util::trace::SetThreadName("handoff");
+
+  // The servers begin on the director threads, wait for them before closing
+  // the inherited sockets none of them adopted.
+  size_t listenerCount = 3;
+  if (_config.messenger.enabled)
+    listenerCount += 1 + _config.allChat.enabled + _config.privateChat.enabled;
+
+  const auto beginDeadline = Clock::now() + ServerBeginTimeout;
+  while (_shouldRun.load(std::memory_order::relaxed)
+    && GetListenerHandles().size() < listenerCount
+    && Clock::now() < beginDeadline)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+
+  if (const auto closedCount = network::handoff::CloseInheritedListeners(); closedCount > 0)
+    spdlog::warn("Closed {} inherited listening sockets not adopted by any server", closedCount);
+
+  if (not _shouldRun.load(std::memory_order::relaxed))
+    return;
+
+  spdlog::info("Serving the handoff of the listening sockets on '{}'", _config.handoff.path);
+  if (not _handoffProvider.Serve(_config.handoff.path))
+    return;
+
+  const auto forEachServer = [this](const auto& function)
+  {
+    function(_lobbyDirector.GetNetworkHandler().GetCommandServer());
+    function(_ranchDirector.GetCommandServer());
+    function(_raceDirector.GetCommandServer());
+    function(_messengerDirector.GetChatterServer());
+    function(_allChatDirector.GetChatterServer());
+    function(_privateChatDirector.GetChatterServer());
+  };
+
+  // The next process accepts the new clients from now on, but serves none of them
+  // until released. Disconnect the clients so that they reconnect to the next process,
+  // which must not read any of their data before this process wrote it out.
+  forEachServer([](auto& server)
+  {
+    server.StopAccepting();
+    server.DisconnectAllClients();
+  });
+
+  const auto getClientCount = [&forEachServer]()
+  {
+    size_t clientCount = 0;
+    forEachServer([&clientCount](const auto& server)
+    {
+      clientCount += server.GetClientCount();
+    });
+    return clientCount;
+  };
+
+  spdlog::info(
+    "Handed off the listening sockets, disconnecting {} clients for up to {} seconds",
+    getClientCount(),
+    _config.handoff.drainTimeout);
+
+  const auto drainDeadline = Clock::now() + std::chrono::seconds(_config.handoff.drainTimeout);
+  while (_shouldRun.load(std::memory_order::relaxed)
+    && getClientCount() > 0
+    && Clock::now() < drainDeadline)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+
+  // The data director writes out every storage as it terminates.
+  spdlog::info("Terminating after the handoff with {} clients remaining", getClientCount());
+  Terminate();
+  JoinDirectorThreads();
+
+  spdlog::info("Wrote out the data, releasing the next process");
+  _handoffProvider.Release();
+}
+
+void ServerInstance::ReloadRegistries()
+{
+  const auto reloadRegistry = [](const std::string& registryName, const std::function<void()>& reload)
+  {
+    try
+    {
+      reload();
+    }
+    catch (const std::exception& x)
+    {
+      spdlog::error("Failed to reload the {} registry, keeping the current one: {}", registryName, x.what());
+    }
+  };
+
+  reloadRegistry("course", [this]()
+  {
+    _courseRegistry.ReadConfig(GetCourseRegistryConfigPath(_resourceDirectory));
+  });
+  reloadRegistry("item", [this]()
+  {
+    _itemRegistry.ReadConfig(GetItemRegistryConfigPath(_resourceDirectory));
+    // The shop list is generated from the items, publish it for the new snapshot.
+    _lobbyDirector.GetShopManager().GenerateShopList(_itemRegistry);
+  });
+  reloadRegistry("magic", [this]()
+  {
+    _magicRegistry.ReadConfig(GetMagicRegistryConfigPath(_resourceDirectory));
+  });
+  reloadRegistry("pet", [this]()
+  {
+    _petRegistry.ReadConfig(GetPetRegistryConfigPath(_resourceDirectory));
+  });
+
+  PublishRegistryMemoryUsage();
 }
 
 AuthenticationService& ServerInstance::GetAuthenticationService()
@@ -357,4 +630,99 @@ Config& ServerInstance::GetSettings()
   return _config;
 }
 
+const std::map<std::string, util::Histogram, std::less<>>& ServerInstance::GetDirectorTickTimes() const
+{
+  return _directorTickTimes;
+}
+
+void ServerInstance::BeginCapture(CommandServer& commandServer, const std::string_view name)
+{
+  if (not _config.capture.enabled)
+    return;
+
+  try
+  {
+    std::filesystem::create_directories(_config.capture.directory);
+    commandServer.BeginCapture(
+      network::capture::Writer::MakeFilePath(_config.capture.directory, name));
+  }
+  catch (const std::exception& x)
+  {
+    spdlog::error("Couldn't begin capturing the {} server: {}", name, x.what());
+  }
+}
+
+std::filesystem::path ServerInstance::DumpTrace()
+{
+  std::filesystem::create_directories(_config.trace.directory);
+
+  const auto path = util::trace::MakeFilePath(_config.trace.directory);
+  const auto spanCount = util::trace::Dump(path);
+  spdlog::info("Dumped {} trace spans to '{}'", spanCount, path.string());
+
+  return path;
+}
+
+bool ServerInstance::IsMemoryUsageReportDue(const std::string_view component) const
+{
+  return _memoryAccounting.IsReportDue(
+    component,
+    std::chrono::seconds(_config.memory.reportInterval));
+}
+
+void ServerInstance::PublishMemoryUsage(
+  const std::string_view component,
+  util::MemoryUsageReport report)
+{
+  if (_config.memory.logReports)
+  {
+    std::string subsystems;
+    for (const auto& [subsystem, usage] : report)
+    {
+      std::format_to(
+        std::back_inserter(subsystems),
+        "{}{}: {} ({})",
+        subsystems.empty() ? "" : ", ",
+        subsystem,
+        util::FormatBytes(usage.bytes),
+        usage.count);
+    }
+
+    spdlog::info(
+      "Memory usage of '{}': {} [{}]",
+      component,
+      util::FormatBytes(util::GetTotal(report).bytes),
+      subsystems);
+  }
+
+  _memoryAccounting.Publish(component, std::move(report));
+}
+
+void ServerInstance::RequestMemoryUsageReports()
+{
+  _memoryAccounting.RequestReports();
+  PublishRegistryMemoryUsage();
+
+  // The read buffers of the clients are reported by the listeners,
+  // the pool reports the slabs which hold them.
+  const auto readBufferPool = network::GetReadBufferPoolStatistics();
+  PublishMemoryUsage("network", util::MemoryUsageReport{
+    {"read_buffer_pool", {.count = readBufferPool.slabCount, .bytes = readBufferPool.residentBytes}}});
+}
+
+const util::MemoryAccounting& ServerInstance::GetMemoryAccounting() const
+{
+  return _memoryAccounting;
+}
+
+void ServerInstance::PublishRegistryMemoryUsage()
+{
+  PublishMemoryUsage("registries", util::MemoryUsageReport{
+    {"course", _courseRegistry.GetMemoryUsage()},
+    {"horse", _horseRegistry.GetMemoryUsage()},
+    {"item", _itemRegistry.GetMemoryUsage()},
+    {"magic", _magicRegistry.GetMemoryUsage()},
+    {"pet", _petRegistry.GetMemoryUsage()}});
+}
+
 } // namespace server
\ No newline at end of file
@@ -0,0 +1,598 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "server/admin/AdminDirector.hpp"
+
+#include "server/ServerInstance.hpp"
+#include "server/lobby/LobbyNetworkHandler.hpp"
+
+#include <libserver/network/chatter/ChatterProtocol.hpp>
+#include <libserver/network/command/CommandProtocol.hpp>
+
+#include <nlohmann/json.hpp>
+#include <spdlog/async.h>
+#include <spdlog/spdlog.h>
+
+#include <format>
+#include <functional>
+
+namespace server
+{
+
+namespace
+{
+
+//! Scale of the nanoseconds to seconds.
+constexpr double NanosecondsToSeconds = 1e-9;
+
+//! Quantiles reported for the summaries.
+constexpr std::array SummaryQuantiles{0.5, 0.9, 0.99};
+
+//! A listener of the server reporting the command metrics.
+struct Listener
+{
+  std::string_view name;
+  size_t clientCount;
+  network::ListenerStatistics statistics;
+  network::AdmissionStatistics admission;
+  const network::CommandMetrics& metrics;
+  std::function<std::string_view(uint16_t)> getCommandName;
+};
+
+std::string_view GetTypeName(const auto type)
+{
+  using Type = decltype(type);
+  switch (type)
+  {
+    case Type::Counter:
+      return "counter";
+    case Type::Summary:
+      return "summary";
+    case Type::Gauge:
+    default:
+      return "gauge";
+  }
+}
+
+} // anon namespace
+
+AdminDirector::AdminDirector(ServerInstance& serverInstance)
+  : _serverInstance(serverInstance)
+  , _server([this](std::string_view target)
+    {
+      return HandleRequest(target);
+    })
+{
+}
+
+void AdminDirector::Initialize()
+{
+  spdlog::debug(
+    "Admin endpoint listening on {}:{}",
+    GetConfig().listen.address.to_string(),
+    GetConfig().listen.port);
+
+  _serverThread = std::thread([this]()
+  {
+    try
+    {
+      _server.Begin(GetConfig().listen.address, GetConfig().listen.port);
+    }
+    catch (const std::exception& x)
+    {
+      spdlog::error("Admin endpoint stopped: {}", x.what());
+    }
+  });
+
+  _lastDeltaBroadcast = std::chrono::steady_clock::now();
+}
+
+void AdminDirector::Terminate()
+{
+  _server.End();
+  if (_serverThread.joinable())
+    _serverThread.join();
+}
+
+void AdminDirector::Tick()
+{
+  const auto now = std::chrono::steady_clock::now();
+  if (now - _lastDeltaBroadcast < std::chrono::milliseconds(GetConfig().deltaInterval))
+    return;
+
+  BroadcastMetricDeltas();
+  _lastDeltaBroadcast = now;
+}
+
+Config::Admin& AdminDirector::GetConfig()
+{
+  return _serverInstance.GetSettings().admin;
+}
+
+std::deque<AdminDirector::MetricFamily> AdminDirector::CollectMetrics()
+{
+  using Type = MetricFamily::Type;
+
+  // Families are filled through references, which the deque keeps valid.
+  std::deque<MetricFamily> families;
+
+  const auto addFamily = [&families](
+    std::string name,
+    std::string help,
+    const Type type) -> MetricFamily&
+  {
+    return families.emplace_back(MetricFamily{
+      .name = std::move(name),
+      .help = std::move(help),
+      .type = type,
+      .samples = {}});
+  };
+
+  const auto addSample = [](
+    MetricFamily& family,
+    std::string labels,
+    const double value)
+  {
+    family.samples.emplace_back(MetricFamily::Sample{
+      .suffix = {},
+      .labels = std::move(labels),
+      .value = value,
+      .isCumulative = family.type == Type::Counter});
+  };
+
+  const auto addSummary = [](
+    MetricFamily& family,
+    const std::string& labels,
+    const util::Histogram::Snapshot& snapshot,
+    const double scale)
+  {
+    for (const auto quantile : SummaryQuantiles)
+    {
+      family.samples.emplace_back(MetricFamily::Sample{
+        .suffix = {},
+        .labels = std::format(
+          "{}{}quantile=\"{}\"",
+          labels,
+          labels.empty() ? "" : ",",
+          quantile),
+        .value = static_cast<double>(snapshot.GetPercentile(quantile * 100.0)) * scale,
+        .isCumulative = false});
+    }
+
+    family.samples.emplace_back(MetricFamily::Sample{
+      .suffix = "_sum",
+      .labels = labels,
+      .value = static_cast<double>(snapshot.sum) * scale,
+      .isCumulative = true});
+    family.samples.emplace_back(MetricFamily::Sample{
+      .suffix = "_count",
+      .labels = labels,
+      .value = static_cast<double>(snapshot.count),
+      .isCumulative = true});
+  };
+
+  // Listeners and their commands.
+  auto& lobbyServer = _serverInstance.GetLobbyDirector().GetNetworkHandler().GetCommandServer();
+  auto& ranchServer = _serverInstance.GetRanchDirector().GetCommandServer();
+  auto& raceServer = _serverInstance.GetRaceDirector().GetCommandServer();
+  auto& messengerServer = _serverInstance.GetMessengerDirector().GetChatterServer();
+  auto& allChatServer = _serverInstance.GetAllChatDirector().GetChatterServer();
+  auto& privateChatServer = _serverInstance.GetPrivateChatDirector().GetChatterServer();
+
+  const auto getCommandName = [](const uint16_t commandId)
+  {
+    return protocol::GetCommandName(static_cast<protocol::Command>(commandId));
+  };
+  const auto getChatterCommandName = [](const uint16_t commandId)
+  {
+    return protocol::GetChatterCommandName(static_cast<protocol::ChatterCommand>(commandId));
+  };
+
+  const std::array listeners{
+    Listener{"lobby", lobbyServer.GetClientCount(), lobbyServer.GetStatistics(), lobbyServer.GetAdmissionStatistics(), lobbyServer.GetMetrics(), getCommandName},
+    Listener{"ranch", ranchServer.GetClientCount(), ranchServer.GetStatistics(), ranchServer.GetAdmissionStatistics(), ranchServer.GetMetrics(), getCommandName},
+    Listener{"race", raceServer.GetClientCount(), raceServer.GetStatistics(), raceServer.GetAdmissionStatistics(), raceServer.GetMetrics(), getCommandName},
+    Listener{"messenger", messengerServer.GetClientCount(), messengerServer.GetStatistics(), messengerServer.GetAdmissionStatistics(), messengerServer.GetMetrics(), getChatterCommandName},
+    Listener{"all_chat", allChatServer.GetClientCount(), allChatServer.GetStatistics(), allChatServer.GetAdmissionStatistics(), allChatServer.GetMetrics(), getChatterCommandName},
+    Listener{"private_chat", privateChatServer.GetClientCount(), privateChatServer.GetStatistics(), privateChatServer.GetAdmissionStatistics(), privateChatServer.GetMetrics(), getChatterCommandName}};
+
+  auto& connections = addFamily(
+    "alicia_connections", "Count of the connected clients.", Type::Gauge);
+  auto& commandsReceived = addFamily(
+    "alicia_commands_received_total", "Count of the received commands.", Type::Counter);
+  auto& commandsSent = addFamily(
+    "alicia_commands_sent_total", "Count of the sent commands.", Type::Counter);
+  auto& commandFailures = addFamily(
+    "alicia_command_failures_total",
+    "Count of the received commands whose handler threw or rejected them.",
+    Type::Counter);
+  auto& commandErrors = addFamily(
+    "alicia_command_errors_total", "Count of the received commands rejected by their handler.", Type::Counter);
+  auto& bytesReceived = addFamily(
+    "alicia_command_received_bytes_total", "Count of the received command bytes.", Type::Counter);
+  auto& bytesSent = addFamily(
+    "alicia_command_sent_bytes_total", "Count of the sent command bytes.", Type::Counter);
+  auto& networkBytes = addFamily(
+    "alicia_network_bytes_total", "Count of the bytes received and sent by the clients.", Type::Counter);
+  auto& networkFrames = addFamily(
+    "alicia_network_frames_total", "Count of the frames received and sent by the clients.", Type::Counter);
+  auto& networkReads = addFamily(
+    "alicia_network_reads_total", "Count of the reads from the sockets of the clients.", Type::Counter);
+  auto& networkWrites = addFamily(
+    "alicia_network_writes_total", "Count of the writes issued to the sockets of the clients.", Type::Counter);
+  auto& writeQueueDepth = addFamily(
+    "alicia_network_write_queue_depth", "Count of the writes queued by the clients.", Type::Gauge);
+  auto& maxWriteQueueDepth = addFamily(
+    "alicia_network_write_queue_depth_max", "Largest count of the writes queued by a client.", Type::Gauge);
+  auto& pendingSendBytes = addFamily(
+    "alicia_network_pending_send_bytes", "Count of the bytes waiting to be accepted by the sockets.", Type::Gauge);
+  auto& sendBlockedTime = addFamily(
+    "alicia_network_send_blocked_seconds_total", "Time the sends spent waiting for the sockets.", Type::Counter);
+  auto& rejectedConnections = addFamily(
+    "alicia_network_rejected_connections_total", "Count of the rejected connections.", Type::Counter);
+  auto& trackedAddresses = addFamily(
+    "alicia_network_tracked_addresses", "Count of the addresses tracked by the connection admission.", Type::Gauge);
+  auto& evictedAddresses = addFamily(
+    "alicia_network_evicted_addresses_total", "Count of the idle addresses evicted by the connection admission.", Type::Counter);
+  auto& roundTripTime = addFamily(
+    "alicia_network_round_trip_seconds", "Round-trip time of the connected clients.", Type::Gauge);
+  auto& decodeTime = addFamily(
+    "alicia_command_decode_seconds", "Time to decode a received command.", Type::Summary);
+  auto& handlerTime = addFamily(
+    "alicia_command_handler_seconds", "Time spent in the handler of a received command.", Type::Summary);
+  auto& serializeTime = addFamily(
+    "alicia_command_serialize_seconds", "Time to serialize a sent command.", Type::Summary);
+
+  for (const auto& listener : listeners)
+  {
+    const auto listenerLabel = std::format("listener=\"{}\"", listener.name);
+    addSample(connections, listenerLabel, static_cast<double>(listener.clientCount));
+
+    const auto& network = listener.statistics.total;
+    addSample(networkBytes,
+      std::format("{},direction=\"in\"", listenerLabel),
+      static_cast<double>(network.inboundBytes));
+    addSample(networkBytes,
+      std::format("{},direction=\"out\"", listenerLabel),
+      static_cast<double>(network.outboundBytes));
+    addSample(networkFrames,
+      std::format("{},direction=\"in\"", listenerLabel),
+      static_cast<double>(network.inboundFrames));
+    addSample(networkFrames,
+      std::format("{},direction=\"out\"", listenerLabel),
+      static_cast<double>(network.outboundFrames));
+    addSample(networkReads, listenerLabel, static_cast<double>(network.inboundReads));
+    addSample(networkWrites, listenerLabel, static_cast<double>(network.outboundWrites));
+    addSample(writeQueueDepth, listenerLabel, static_cast<double>(network.writeQueueDepth));
+    addSample(maxWriteQueueDepth, listenerLabel, static_cast<double>(network.maxWriteQueueDepth));
+    addSample(pendingSendBytes, listenerLabel, static_cast<double>(network.pendingSendBytes));
+    addSample(sendBlockedTime, listenerLabel,
+      std::chrono::duration<double>(network.sendBlockedTime).count());
+    addSample(roundTripTime,
+      std::format("{},stat=\"average\"", listenerLabel),
+      std::chrono::duration<double>(listener.statistics.averageRoundTripTime).count());
+    addSample(roundTripTime,
+      std::format("{},stat=\"max\"", listenerLabel),
+      std::chrono::duration<double>(network.roundTripTime).count());
+
+    const auto& admission = listener.admission;
+    const std::array rejections{
+      std::pair{"too_many_connections", admission.rejectedTooManyConnections},
+      std::pair{"rate_limited", admission.rejectedRateLimited},
+      std::pair{"table_full", admission.rejectedTableFull},
+      std::pair{"server_full", admission.rejectedServerFull}};
+    for (const auto& [reason, count] : rejections)
+    {
+      addSample(rejectedConnections,
+        std::format("{},reason=\"{}\"", listenerLabel, reason),
+        static_cast<double>(count));
+    }
+    addSample(trackedAddresses, listenerLabel, static_cast<double>(admission.trackedAddresses));
+    addSample(evictedAddresses, listenerLabel, static_cast<double>(admission.evictions));
+
+    for (const auto& statistics : listener.metrics.GetSnapshot())
+    {
+      const auto labels = std::format(
+        "{},command=\"{}\"",
+        listenerLabel,
+        listener.getCommandName(statistics.commandId));
+
+      addSample(commandsReceived, labels, static_cast<double>(statistics.inboundCount));
+      addSample(commandsSent, labels, static_cast<double>(statistics.outboundCount));
+      addSample(commandFailures, labels, static_cast<double>(statistics.failureCount));
+      addSample(bytesReceived, labels, static_cast<double>(statistics.inboundSize.sum));
+      addSample(bytesSent, labels, static_cast<double>(statistics.outboundSize.sum));
+
+      for (size_t errorIdx = 0; errorIdx < server::network::HandlerErrorCount; ++errorIdx)
+      {
+        // Only the kinds which occurred are exported, to keep the count of the series low.
+        const auto errorCount = statistics.errorCounts[errorIdx];
+        if (errorCount == 0)
+          continue;
+
+        addSample(commandErrors,
+          std::format("{},kind=\"{}\"",
+            labels,
+            server::network::GetHandlerErrorName(
+              static_cast<server::network::HandlerError>(errorIdx))),
+          static_cast<double>(errorCount));
+      }
+
+      if (statistics.inboundCount > 0)
+      {
+        addSummary(decodeTime, labels, statistics.decodeTime, NanosecondsToSeconds);
+        addSummary(handlerTime, labels, statistics.handlerTime, NanosecondsToSeconds);
+      }
+      if (statistics.outboundCount > 0)
+      {
+        addSummary(serializeTime, labels, statistics.serializeTime, NanosecondsToSeconds);
+      }
+    }
+  }
+
+  // Directors.
+  auto& tickTime = addFamily(
+    "alicia_director_tick_seconds", "Time of a director tick.", Type::Summary);
+  for (const auto& [directorName, histogram] : _serverInstance.GetDirectorTickTimes())
+  {
+    addSummary(
+      tickTime,
+      std::format("director=\"{}\"", directorName),
+      histogram.GetSnapshot(),
+      NanosecondsToSeconds);
+  }
+
+  auto& schedulerJobs = addFamily(
+    "alicia_scheduler_jobs", "Count of the jobs queued in a scheduler.", Type::Gauge);
+  addSample(
+    schedulerJobs,
+    "director=\"lobby\"",
+    static_cast<double>(_serverInstance.GetLobbyDirector().GetScheduler().GetJobCount()));
+  addSample(
+    schedulerJobs,
+    "director=\"race\"",
+    static_cast<double>(_serverInstance.GetRaceDirector().GetScheduler().GetJobCount()));
+  addSample(
+    schedulerJobs,
+    "director=\"data\"",
+    static_cast<double>(_serverInstance.GetDataDirector().GetScheduler().GetJobCount()));
+
+  // Storages.
+  auto& storageEntries = addFamily(
+    "alicia_storage_entries", "Count of the entries in a storage.", Type::Gauge);
+  auto& storageQueueDepth = addFamily(
+    "alicia_storage_queue_depth", "Count of the requests processed in the last storage tick.", Type::Gauge);
+  auto& storageOperations = addFamily(
+    "alicia_storage_operations_total", "Count of the storage operations.", Type::Counter);
+  auto& storageNegativeEntries = addFamily(
+    "alicia_storage_negative_entries", "Count of the absent and failed entries in a storage.", Type::Gauge);
+  auto& storageLookups = addFamily(
+    "alicia_storage_lookups_total", "Count of the storage gets by their result.", Type::Counter);
+  auto& storageRetrieveOutcomes = addFamily(
+    "alicia_storage_unsuccessful_retrieves_total", "Count of the retrieves of absent data and the failed retrieves.", Type::Counter);
+  auto& storageRetries = addFamily(
+    "alicia_storage_retries_total", "Count of the retries of the failed retrieves.", Type::Counter);
+  auto& storageEvictions = addFamily(
+    "alicia_storage_negative_evictions_total", "Count of the absent and failed entries evicted over the limit.", Type::Counter);
+  auto& storageRetiredSnapshots = addFamily(
+    "alicia_storage_retired_snapshots", "Count of the replaced snapshots of a storage not yet reclaimed.", Type::Gauge);
+
+  const auto addStorage = [&](const std::string_view storageName, const auto& storage)
+  {
+    const auto statistics = storage.GetStatistics();
+    const auto storageLabel = std::format("storage=\"{}\"", storageName);
+
+    addSample(storageEntries, storageLabel, static_cast<double>(statistics.entryCount));
+
+    addSample(storageQueueDepth,
+      std::format("{},queue=\"retrieve\"", storageLabel),
+      static_cast<double>(statistics.retrieveQueueDepth));
+    addSample(storageQueueDepth,
+      std::format("{},queue=\"store\"", storageLabel),
+      static_cast<double>(statistics.storeQueueDepth));
+    addSample(storageQueueDepth,
+      std::format("{},queue=\"delete\"", storageLabel),
+      static_cast<double>(statistics.deleteQueueDepth));
+
+    addSample(storageOperations,
+      std::format("{},operation=\"retrieve\"", storageLabel),
+      static_cast<double>(statistics.retrieveCount));
+    addSample(storageOperations,
+      std::format("{},operation=\"store\"", storageLabel),
+      static_cast<double>(statistics.storeCount));
+    addSample(storageOperations,
+      std::format("{},operation=\"delete\"", storageLabel),
+      static_cast<double>(statistics.deleteCount));
+
+    addSample(storageNegativeEntries, storageLabel, static_cast<double>(statistics.negativeEntryCount));
+
+    addSample(storageLookups,
+      std::format("{},result=\"hit\"", storageLabel),
+      static_cast<double>(statistics.hitCount));
+    addSample(storageLookups,
+      std::format("{},result=\"miss\"", storageLabel),
+      static_cast<double>(statistics.missCount));
+    addSample(storageLookups,
+      std::format("{},result=\"negative_hit\"", storageLabel),
+      static_cast<double>(statistics.negativeHitCount));
+
+    addSample(storageRetrieveOutcomes,
+      std::format("{},result=\"absent\"", storageLabel),
+      static_cast<double>(statistics.absentCount));
+    addSample(storageRetrieveOutcomes,
+      std::format("{},result=\"failed\"", storageLabel),
+      static_cast<double>(statistics.failureCount));
+
+    addSample(storageRetries, storageLabel, static_cast<double>(statistics.retryCount));
+    addSample(storageEvictions, storageLabel, static_cast<double>(statistics.evictionCount));
+    addSample(storageRetiredSnapshots, storageLabel, static_cast<double>(statistics.retiredSnapshotCount));
+  };
+
+  auto& dataDirector = _serverInstance.GetDataDirector();
+  addStorage("user", dataDirector.GetUserCache());
+  addStorage("infraction", dataDirector.GetInfractionCache());
+  addStorage("character", dataDirector.GetCharacterCache());
+  addStorage("horse", dataDirector.GetHorseCache());
+  addStorage("item", dataDirector.GetItemCache());
+  addStorage("storage_item", dataDirector.GetStorageItemCache());
+  addStorage("egg", dataDirector.GetEggCache());
+  addStorage("pet", dataDirector.GetPetCache());
+  addStorage("housing", dataDirector.GetHousingCache());
+  addStorage("guild", dataDirector.GetGuildCache());
+  addStorage("settings", dataDirector.GetSettingsCache());
+  addStorage("daily_quest", dataDirector.GetDailyQuestCache());
+  addStorage("mail", dataDirector.GetMailCache());
+
+  // Memory, as of the last reports of the components.
+  auto& memoryBytes = addFamily(
+    "alicia_memory_bytes", "Estimated heap size of a subsystem.", Type::Gauge);
+  auto& memoryObjects = addFamily(
+    "alicia_memory_objects", "Count of the objects held by a subsystem.", Type::Gauge);
+  for (const auto& [componentName, componentReport] :
+    _serverInstance.GetMemoryAccounting().GetReports())
+  {
+    for (const auto& [subsystemName, usage] : componentReport.report)
+    {
+      const auto labels = std::format(
+        "component=\"{}\",subsystem=\"{}\"", componentName, subsystemName);
+      addSample(memoryBytes, labels, static_cast<double>(usage.bytes));
+      addSample(memoryObjects, labels, static_cast<double>(usage.count));
+    }
+  }
+
+  // Logging.
+  if (const auto logThreadPool = spdlog::thread_pool())
+  {
+    auto& logQueueDepth = addFamily(
+      "alicia_log_queue_depth", "Count of the log messages waiting to be written.", Type::Gauge);
+    addSample(logQueueDepth, "", static_cast<double>(logThreadPool->queue_size()));
+
+    auto& logOverruns = addFamily(
+      "alicia_log_overruns_total", "Count of the log messages dropped because the queue was full.", Type::Counter);
+    addSample(logOverruns, "", static_cast<double>(logThreadPool->overrun_counter()));
+  }
+
+  auto& adminSessions = addFamily(
+    "alicia_admin_sessions", "Count of the WebSocket sessions of the admin endpoint.", Type::Gauge);
+  addSample(adminSessions, "", static_cast<double>(_server.GetSessionCount()));
+
+  return families;
+}
+
+websocket::Response AdminDirector::HandleRequest(const std::string_view target)
+{
+  websocket::Response response;
+
+  if (target != "/metrics")
+  {
+    response.status = boost::beast::http::status::not_found;
+    response.body = "Metrics are served at /metrics\n";
+    return response;
+  }
+
+  std::string text;
+  for (const auto& family : CollectMetrics())
+  {
+    std::format_to(
+      std::back_inserter(text),
+      "# HELP {} {}\n# TYPE {} {}\n",
+      family.name,
+      family.help,
+      family.name,
+      GetTypeName(family.type));
+
+    for (const auto& sample : family.samples)
+    {
+      if (sample.labels.empty())
+      {
+        std::format_to(
+          std::back_inserter(text),
+          "{}{} {}\n",
+          family.name,
+          sample.suffix,
+          sample.value);
+      }
+      else
+      {
+        std::format_to(
+          std::back_inserter(text),
+          "{}{}{{{}}} {}\n",
+          family.name,
+          sample.suffix,
+          sample.labels,
+          sample.value);
+      }
+    }
+  }
+
+  response.contentType = "text/plain; version=0.0.4";
+  response.body = std::move(text);
+  return response;
+}
+
+void AdminDirector::BroadcastMetricDeltas()
+{
+  // Nobody is listening, start over once somebody connects.
+  if (_server.GetSessionCount() == 0)
+  {
+    _lastCumulativeValues.clear();
+    return;
+  }
+
+  nlohmann::json deltas = nlohmann::json::object();
+  nlohmann::json gauges = nlohmann::json::object();
+
+  for (const auto& family : CollectMetrics())
+  {
+    for (const auto& sample : family.samples)
+    {
+      auto key = sample.labels.empty()
+        ? std::format("{}{}", family.name, sample.suffix)
+        : std::format("{}{}{{{}}}", family.name, sample.suffix, sample.labels);
+
+      if (not sample.isCumulative)
+      {
+        gauges[key] = sample.value;
+        continue;
+      }
+
+      // The first value of a sample is the baseline of its deltas.
+      const auto [lastValueIter, isFirstValue] = _lastCumulativeValues.try_emplace(
+        key, sample.value);
+      if (isFirstValue)
+        continue;
+
+      const auto delta = sample.value - lastValueIter->second;
+      lastValueIter->second = sample.value;
+
+      // Only the changed counters are streamed.
+      if (delta != 0.0)
+        deltas[std::move(key)] = delta;
+    }
+  }
+
+  nlohmann::json message;
+  message["interval"] = static_cast<double>(GetConfig().deltaInterval) / 1000.0;
+  message["deltas"] = std::move(deltas);
+  message["gauges"] = std::move(gauges);
+
+  _server.Broadcast(message.dump());
+}
+
+} // namespace server
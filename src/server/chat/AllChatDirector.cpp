@@ -57,6 +57,7 @@ void AllChatDirector::Initialize()
     GetConfig().listen.address.to_string(),
     GetConfig().listen.port);
 
+  _chatterServer.SetSocketOptions(GetConfig().socket);
   _chatterServer.BeginHost(GetConfig().listen.address, GetConfig().listen.port);
 }
 
@@ -69,15 +70,14 @@ AllChatDirector::ClientContext& AllChatDirector::GetClientContext(
   const network::ClientId clientId,
   bool requireAuthentication)
 {
-  auto clientContextIter = _clients.find(clientId);
-  if (clientContextIter == _clients.end())
+  const auto clientContext = _clients.Find(clientId);
+  if (clientContext == nullptr)
     throw std::runtime_error("All chat client is not available");
 
-  auto& clientContext = clientContextIter->second;
-  if (requireAuthentication && not clientContext.isAuthenticated)
+  if (requireAuthentication && not clientContext->isAuthenticated)
     throw std::runtime_error("All chat client is not authenticated");
 
-  return clientContext;
+  return *clientContext;
 }
 
 void AllChatDirector::Tick()
@@ -89,18 +89,39 @@ Config::AllChat& AllChatDirector::GetConfig()
   return _serverInstance.GetSettings().allChat;
 }
 
+ChatterServer& AllChatDirector::GetChatterServer()
+{
+  return _chatterServer;
+}
+
 void AllChatDirector::HandleClientConnected(network::ClientId clientId)
 {
   spdlog::debug("Client {} connected to the all chat server from {}",
     clientId,
     _chatterServer.GetClientAddress(clientId).to_string());
-  _clients.try_emplace(clientId);
+  _clients.Emplace(clientId);
 }
 
 void AllChatDirector::HandleClientDisconnected(network::ClientId clientId)
 {
   spdlog::debug("Client {} disconnected from the all chat server", clientId);
-  _clients.erase(clientId);
+  _clients.Erase(clientId);
+}
+
+void AllChatDirector::HandleNetworkTick()
+{
+  if (_serverInstance.IsMemoryUsageReportDue("all_chat"))
+    _serverInstance.PublishMemoryUsage("all_chat", GetMemoryUsage());
+}
+
+util::MemoryUsageReport AllChatDirector::GetMemoryUsage() const
+{
+  util::MemoryUsageReport report{
+    {"clients", util::MemoryUsage{
+      .count = _clients.Size(),
+      .bytes = _clients.EstimateContainerHeapSize()}}};
+  _chatterServer.GetBufferMemoryUsage().AppendTo(report);
+  return report;
 }
 
 void AllChatDirector::HandleChatterEnterRoom(
@@ -180,7 +201,7 @@ void AllChatDirector::HandleChatterChat(
   const auto userName = _serverInstance.GetLobbyDirector().GetUserByCharacterUid(
     clientContext.characterUid).userName;
 
-  spdlog::info("[Global] {} ({}): {}",
+  SPDLOG_DEBUG("[Global] {} ({}): {}",
     characterName,
     userName,
     command.message);
@@ -57,6 +57,7 @@ void PrivateChatDirector::Initialize()
     GetConfig().listen.address.to_string(),
     GetConfig().listen.port);
 
+  _chatterServer.SetSocketOptions(GetConfig().socket);
   _chatterServer.BeginHost(GetConfig().listen.address, GetConfig().listen.port);
 }
 
@@ -85,6 +86,11 @@ Config::PrivateChat& PrivateChatDirector::GetConfig()
   return _serverInstance.GetSettings().privateChat;
 }
 
+ChatterServer& PrivateChatDirector::GetChatterServer()
+{
+  return _chatterServer;
+}
+
 const std::optional<network::ClientId> PrivateChatDirector::GetTargetClientIdByContext(
   const ConversationContext& conversationContext) const
 {
@@ -140,6 +146,22 @@ void PrivateChatDirector::HandleClientDisconnected(network::ClientId clientId)
   _conversations.erase(clientId);
 }
 
+void PrivateChatDirector::HandleNetworkTick()
+{
+  if (_serverInstance.IsMemoryUsageReportDue("private_chat"))
+    _serverInstance.PublishMemoryUsage("private_chat", GetMemoryUsage());
+}
+
+util::MemoryUsageReport PrivateChatDirector::GetMemoryUsage() const
+{
+  util::MemoryUsageReport report{
+    {"conversations", util::MemoryUsage{
+      .count = _conversations.size(),
+      .bytes = util::EstimateContainerHeapSize(_conversations)}}};
+  _chatterServer.GetBufferMemoryUsage().AppendTo(report);
+  return report;
+}
+
 void PrivateChatDirector::HandleChatterEnterRoom(
   network::ClientId clientId,
   const protocol::ChatCmdEnterRoom& command)
@@ -22,6 +22,8 @@
 #include "server/lobby/LobbyNetworkHandler.hpp"
 #include "server/ServerInstance.hpp"
 
+#include <ranges>
+
 namespace server
 {
 
@@ -275,6 +277,45 @@ LobbyNetworkHandler& LobbyDirector::GetNetworkHandler()
   return *_networkHandler;
 }
 
+util::MemoryUsageReport LobbyDirector::GetMemoryUsage() const
+{
+  util::MemoryUsageReport report;
+
+  util::MemoryUsage logins{
+    .count = _clientLogins.size(),
+    .bytes = util::EstimateContainerHeapSize(_clientLogins)
+      + util::EstimateContainerHeapSize(_loginRequestQueue)
+      + util::EstimateContainerHeapSize(_loginResponseQueue)};
+  for (const auto& login : _clientLogins | std::views::values)
+  {
+    logins.bytes += util::EstimateHeapSize(login.userName)
+      + util::EstimateHeapSize(login.userToken);
+  }
+  report.emplace_back("logins", logins);
+
+  util::MemoryUsage users{
+    .count = _userInstances.size(),
+    .bytes = util::EstimateContainerHeapSize(_userInstances)
+      + util::EstimateContainerHeapSize(_charactersForcedIntoCreator)};
+  for (const auto& [userName, userInstance] : _userInstances)
+  {
+    users.bytes += util::EstimateHeapSize(userName)
+      + util::EstimateHeapSize(userInstance.userName);
+  }
+  report.emplace_back("users", users);
+
+  util::MemoryUsage guilds{
+    .count = _guildInstances.size(),
+    .bytes = util::EstimateContainerHeapSize(_guildInstances)};
+  for (const auto& guildInstance : _guildInstances | std::views::values)
+    guilds.bytes += util::EstimateHeapSize(guildInstance.invites);
+  report.emplace_back("guilds", guilds);
+
+  report.emplace_back("scheduler", _scheduler.GetMemoryUsage());
+
+  return report;
+}
+
 void LobbyDirector::ProcessLoginRequest()
 {
   const network::ClientId clientId = _loginRequestQueue.front();
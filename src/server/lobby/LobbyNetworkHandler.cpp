@@ -13,6 +13,7 @@
 #include <zlib.h>
 
 #include <random>
+#include <ranges>
 
 namespace server
 {
@@ -45,7 +46,7 @@ LobbyNetworkHandler::LobbyNetworkHandler(
   _commandServer.RegisterCommandHandler<protocol::AcCmdCLHeartbeat>(
     [this](const ClientId clientId, [[maybe_unused]] const auto& command)
     {
-      HandleHeartbeat(clientId);
+      return HandleHeartbeat(clientId);
     });
 
   _commandServer.RegisterCommandHandler<protocol::AcCmdCLMakeRoom>(
@@ -87,7 +88,7 @@ LobbyNetworkHandler::LobbyNetworkHandler(
   _commandServer.RegisterCommandHandler<protocol::AcCmdCLShowInventory>(
     [this](const ClientId clientId, const auto& command)
     {
-      HandleShowInventory(clientId, command);
+      return HandleShowInventory(clientId, command);
     });
 
   _commandServer.RegisterCommandHandler<protocol::AcCmdCLUpdateUserSettings>(
@@ -123,7 +124,7 @@ LobbyNetworkHandler::LobbyNetworkHandler(
   _commandServer.RegisterCommandHandler<protocol::AcCmdCLEnterRanch>(
     [this](const ClientId clientId, const auto& command)
     {
-      HandleEnterRanch(clientId, command);
+      return HandleEnterRanch(clientId, command);
     });
 
   _commandServer.RegisterCommandHandler<protocol::AcCmdCLEnterRanchRandomly>(
@@ -292,6 +293,8 @@ void LobbyNetworkHandler::Initialize()
     lobbyConfig.listen.address.to_string(),
     lobbyConfig.listen.port);
 
+  _serverInstance.BeginCapture(_commandServer, "lobby");
+  _commandServer.SetSocketOptions(lobbyConfig.socket);
   _commandServer.BeginHost(lobbyConfig.listen.address, lobbyConfig.listen.port);
 }
 
@@ -300,6 +303,26 @@ void LobbyNetworkHandler::Terminate()
   _commandServer.EndHost();
 }
 
+CommandServer& LobbyNetworkHandler::GetCommandServer()
+{
+  return _commandServer;
+}
+
+std::optional<network::ClientStatistics> LobbyNetworkHandler::GetClientStatistics(
+  const data::Uid characterUid)
+{
+  for (const auto& [clientId, clientContext] : _clients)
+  {
+    if (clientContext.characterUid != characterUid
+      || not clientContext.isAuthenticated)
+      continue;
+
+    return _commandServer.GetClientStatistics(clientId);
+  }
+
+  return std::nullopt;
+}
+
 void LobbyNetworkHandler::AcceptLogin(
   ClientId clientId,
   const bool sendToCharacterCreator)
@@ -525,16 +548,32 @@ ClientId LobbyNetworkHandler::GetClientIdByCharacterUid(
 LobbyNetworkHandler::ClientContext& LobbyNetworkHandler::GetClientContext(
   const ClientId clientId,
   bool requireAuthentication)
+{
+  const auto clientContext = TryGetClientContext(clientId, requireAuthentication);
+  if (not clientContext)
+  {
+    if (clientContext.error() == network::HandlerError::UnknownClient)
+      throw std::runtime_error("Lobby client is not available");
+    throw std::runtime_error("Lobby client is not authenticated");
+  }
+
+  return **clientContext;
+}
+
+std::expected<LobbyNetworkHandler::ClientContext*, network::HandlerError>
+LobbyNetworkHandler::TryGetClientContext(
+  const ClientId clientId,
+  bool requireAuthentication)
 {
   auto clientContextIter = _clients.find(clientId);
   if (clientContextIter == _clients.end())
-    throw std::runtime_error("Lobby client is not available");
+    return std::unexpected(network::HandlerError::UnknownClient);
 
   auto& clientContext = clientContextIter->second;
   if (requireAuthentication && not clientContext.isAuthenticated)
-    throw std::runtime_error("Lobby client is not authenticated");
+    return std::unexpected(network::HandlerError::Unauthenticated);
 
-  return clientContext;
+  return &clientContext;
 }
 
 void LobbyNetworkHandler::HandleNetworkTick()
@@ -572,6 +611,22 @@ void LobbyNetworkHandler::HandleNetworkTick()
   {
     _commandServer.DisconnectClient(clientId);
   }
+
+  if (_serverInstance.IsMemoryUsageReportDue("lobby_network"))
+    _serverInstance.PublishMemoryUsage("lobby_network", GetMemoryUsage());
+}
+
+util::MemoryUsageReport LobbyNetworkHandler::GetMemoryUsage() const
+{
+  util::MemoryUsage clients{
+    .count = _clients.size(),
+    .bytes = util::EstimateContainerHeapSize(_clients)};
+  for (const auto& clientContext : _clients | std::views::values)
+    clients.bytes += util::EstimateHeapSize(clientContext.userName);
+
+  util::MemoryUsageReport report{{"clients", clients}};
+  _commandServer.GetBufferMemoryUsage().AppendTo(report);
+  return report;
 }
 
 void LobbyNetworkHandler::HandleClientConnected(ClientId clientId)
@@ -1030,11 +1085,15 @@ void LobbyNetworkHandler::HandleRoomList(
     });
 }
 
-void LobbyNetworkHandler::HandleHeartbeat(
+network::HandlerResult LobbyNetworkHandler::HandleHeartbeat(
   const ClientId clientId)
 {
-  auto& clientContext = GetClientContext(clientId);
-  clientContext.lastHeartbeat = std::chrono::steady_clock::now();
+  const auto clientContext = TryGetClientContext(clientId);
+  if (not clientContext)
+    return std::unexpected(clientContext.error());
+
+  (*clientContext)->lastHeartbeat = std::chrono::steady_clock::now();
+  return {};
 }
 
 void LobbyNetworkHandler::HandleMakeRoom(
@@ -1534,39 +1593,54 @@ void LobbyNetworkHandler::SendCreateNicknameCancel(
     });
 }
 
-void LobbyNetworkHandler::HandleShowInventory(
+network::HandlerResult LobbyNetworkHandler::HandleShowInventory(
   const ClientId clientId,
   const protocol::AcCmdCLShowInventory&)
 {
-  const auto& clientContext = GetClientContext(clientId);
+  const auto clientContextResult = TryGetClientContext(clientId);
+  if (not clientContextResult)
+    return std::unexpected(clientContextResult.error());
+  const auto& clientContext = **clientContextResult;
   const auto characterRecord = _serverInstance.GetDataDirector().GetCharacter(
     clientContext.characterUid);
 
   if (not characterRecord)
-    throw std::runtime_error("Character record unavailable");
+    return std::unexpected(network::HandlerError::RecordUnavailable);
 
   protocol::LobbyCommandShowInventoryOK response{
     .items = {},
     .horses = {}};
 
+  // The retrieves of all the items and horses not yet available are requested at once.
+  std::vector<Record<data::Item>> itemRecords;
+  std::vector<Record<data::Horse>> horseRecords;
+  bool recordsAvailable = false;
   characterRecord.Immutable(
-    [this, &response](const data::Character& character)
+    [this, &itemRecords, &horseRecords, &recordsAvailable](const data::Character& character)
     {
-      const auto itemRecords = _serverInstance.GetDataDirector().GetItemCache().Get(
-        character.inventory());
-      protocol::BuildProtocolItems(response.items, *itemRecords);
-
-      const auto horseRecords = _serverInstance.GetDataDirector().GetHorseCache().Get(
-        character.horses());
-      protocol::BuildProtocolHorses(response.horses, *horseRecords);
+      const auto itemAvailability = _serverInstance.GetDataDirector().GetItemCache().Get(
+        character.inventory(),
+        itemRecords);
+      const auto horseAvailability = _serverInstance.GetDataDirector().GetHorseCache().Get(
+        character.horses(),
+        horseRecords);
+      recordsAvailable = itemAvailability.IsComplete() && horseAvailability.IsComplete();
     });
 
+  if (not recordsAvailable)
+    return std::unexpected(network::HandlerError::RecordUnavailable);
+
+  protocol::EncodeProtocolItems(response.items, itemRecords);
+  protocol::EncodeProtocolHorses(response.horses, horseRecords);
+
   _commandServer.QueueCommand<decltype(response)>(
     clientId,
     [response]()
     {
       return response;
     });
+
+  return {};
 }
 
 void LobbyNetworkHandler::HandleUpdateUserSettings(
@@ -1675,7 +1749,8 @@ void LobbyNetworkHandler::HandleGoodsShopList(
   const ClientId clientId,
   const protocol::AcCmdCLGoodsShopList&)
 {
-  auto shopList = _serverInstance.GetLobbyDirector().GetShopManager().GetSerializedShopList();
+  const auto shop = _serverInstance.GetLobbyDirector().GetShopManager().Pin();
+  const auto& shopList = shop->serializedShopList;
 
   std::vector<std::byte> compressedXml;
   compressedXml.resize(shopList.size());
@@ -1838,11 +1913,14 @@ void LobbyNetworkHandler::HandleRequestPersonalInfo(
     });
 }
 
-void LobbyNetworkHandler::HandleEnterRanch(
+network::HandlerResult LobbyNetworkHandler::HandleEnterRanch(
   const ClientId clientId,
   const protocol::AcCmdCLEnterRanch& command)
 {
-  const auto& clientContext = GetClientContext(clientId);
+  const auto clientContextResult = TryGetClientContext(clientId);
+  if (not clientContextResult)
+    return std::unexpected(clientContextResult.error());
+  const auto& clientContext = **clientContextResult;
   const auto rancherRecord = _serverInstance.GetDataDirector().GetCharacter(
     command.rancherUid);
 
@@ -1867,10 +1945,11 @@ void LobbyNetworkHandler::HandleEnterRanch(
       {
         return response;
       });
-    return;
+    return {};
   }
 
   SendEnterRanchOK(clientId, command.rancherUid);
+  return {};
 }
 
 void LobbyNetworkHandler::HandleEnterRanchRandomly(
@@ -81,15 +81,19 @@ std::string ShopListToXmlString(const ShopList& shopList)
 
 }
 
-void ShopManager::GenerateShopList(registry::ItemRegistry& itemRegistry)
+void ShopManager::GenerateShopList(const registry::ItemRegistry& itemRegistry)
 {
-  uint32_t goodsSequenceId = 0;
+  Snapshot snapshot;
+  auto& shopList = snapshot.shopList;
+
   uint32_t recommendNoId = 0;
 
-  for (const auto& [tid, item] : itemRegistry.GetItems())
+  const auto itemRegistrySnapshot = itemRegistry.Pin();
+  for (const auto& item : itemRegistrySnapshot->items.GetValues())
   {
-    ++goodsSequenceId;
-
+    // The goods sequence number is the TID of the item, so that a reload of
+    // the registry never hands a number the clients already know to another item.
+    const auto tid = item.tid;
 
     if (not item.isPurchasable)
       continue;
@@ -98,7 +102,7 @@ void ShopManager::GenerateShopList(registry::ItemRegistry& itemRegistry)
     {
       // Item is permanent or consumable
       ShopList::Goods goods{
-          .goodsSq = goodsSequenceId,
+          .goodsSq = tid,
           .setType = 0,
           .moneyType = ShopList::Goods::MoneyType::Carrots,
           .goodsType = ShopList::Goods::GoodsType::Default,
@@ -143,17 +147,17 @@ void ShopManager::GenerateShopList(registry::ItemRegistry& itemRegistry)
             .goodsPrice = 100}};
       }
 
-      _shopList.goodsList.emplace(
-        goodsSequenceId,
+      shopList.goodsList.emplace(
+        tid,
         goods);
     }
     else if (item.type == registry::Item::Type::Temporary)
     {
       // Expirable items, can have a range of prices (preferable and max 3, can be less)
-      _shopList.goodsList.emplace(
-        goodsSequenceId,
+      shopList.goodsList.emplace(
+        tid,
         ShopList::Goods{
-          .goodsSq = goodsSequenceId,
+          .goodsSq = tid,
           .setType = 0,
           .moneyType = ShopList::Goods::MoneyType::Carrots,
           .goodsType = ShopList::Goods::GoodsType::Default,
@@ -182,21 +186,14 @@ void ShopManager::GenerateShopList(registry::ItemRegistry& itemRegistry)
               .goodsPrice = 3}}});
     }
   }
-}
 
-ShopList& ShopManager::GetShopList()
-{
-  return _shopList;
+  snapshot.serializedShopList = ShopListToXmlString(shopList);
+  _snapshot.Publish(std::move(snapshot));
 }
 
-const std::string& ShopManager::GetSerializedShopList()
+ShopManager::View ShopManager::Pin() const noexcept
 {
-  if (_serializedShopList.empty())
-  {
-    _serializedShopList = ShopListToXmlString(_shopList);
-  }
-
-  return _serializedShopList;
+  return _snapshot.Pin();
 }
 
 } // namespace server
\ No newline at end of file
@@ -18,22 +18,21 @@
  **/
 
 #include "Version.hpp"
+#include "server/Logging.hpp"
 #include "server/ServerInstance.hpp"
 #include <libserver/util/Util.hpp>
 
-#include <spdlog/sinks/daily_file_sink.h>
-#include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
 
 #include <atomic>
 #include <condition_variable>
 #include <mutex>
 #include <iostream>
-#include <memory>
 
 #ifdef WIN32
   #include <windows.h>
 #else
+  #include <poll.h>
   #include <unistd.h>
   #include <signal.h>
 #endif
@@ -44,10 +43,9 @@ namespace
 using Clock = std::chrono::steady_clock;
 
 std::atomic_bool shouldProgramRun = true;
+std::atomic_bool shouldReloadRegistries = false;
 std::condition_variable shouldProgramRunCv;
 
-std::shared_ptr<spdlog::logger> g_logger;
-
 Clock::time_point serverStartupTime;
 
 #ifdef WIN32
@@ -79,16 +77,54 @@ void handler(int sig, siginfo_t*, void*)
     shouldProgramRun.store(false, std::memory_order::relaxed);
     shouldProgramRunCv.notify_all();
   }
+  else if (sig == SIGHUP)
+  {
+    shouldReloadRegistries.store(true, std::memory_order::relaxed);
+    shouldProgramRunCv.notify_all();
+  }
 }
 
 #endif
 
-void InteractiveLoop()
+//! Waits for a line of the standard input.
+//! @param timeout Time limit of the wait.
+//! @returns `true` if a line can be read without blocking, `false` if the wait timed out.
+bool WaitForInputLine(const std::chrono::milliseconds timeout)
 {
-  while (shouldProgramRun)
+#ifdef WIN32
+  // The console control handler ends the program, the read may block.
+  return true;
+#else
+  if (std::cin.rdbuf()->in_avail() > 0)
+    return true;
+
+  pollfd input{
+    .fd = STDIN_FILENO,
+    .events = POLLIN,
+    .revents = 0};
+  return ::poll(&input, 1, static_cast<int>(timeout.count())) > 0;
+#endif
+}
+
+void InteractiveLoop(server::ServerInstance& serverInstance)
+{
+  while (shouldProgramRun && serverInstance.IsRunning())
   {
+    // Wake up periodically so that the loop ends once the server instance stops by itself,
+    // as it does after handing off its listening sockets.
+    if (not WaitForInputLine(std::chrono::seconds(1)))
+      continue;
+
     std::string commandLine;
-    std::getline(std::cin, commandLine);
+    if (not std::getline(std::cin, commandLine))
+    {
+      // The input was closed, keep running until stopped otherwise.
+      std::cin.clear();
+      std::mutex threadMtx;
+      std::unique_lock threadLock(threadMtx);
+      shouldProgramRunCv.wait_for(threadLock, std::chrono::seconds(1));
+      continue;
+    }
 
     const auto command = server::util::TokenizeString(
       commandLine, ' ');
@@ -97,6 +133,10 @@ void InteractiveLoop()
     {
       shouldProgramRun.exchange(false, std::memory_order::relaxed);
     }
+    else if (command[0] == "reload")
+    {
+      serverInstance.ReloadRegistries();
+    }
   }
 }
 
@@ -138,28 +178,16 @@ int main(int argc, char** argv)
     spdlog::error("Failed to change the signal action handler for SIGTERM");
     return 1;
   }
+  if (sigaction(SIGHUP, &act, nullptr) == -1)
+  {
+    spdlog::error("Failed to change the signal action handler for SIGHUP");
+    return 1;
+  }
 #endif
 
   serverStartupTime = std::chrono::steady_clock::now();
 
-  // Daily file sink.
-  const auto fileSink = std::make_shared<spdlog::sinks::daily_file_sink_mt>(
-    (baseDirectory / "logs" / "log.txt").string(), 0, 0);
-
-  // Console sink.
-  const auto consoleSink = std::make_shared<
-    spdlog::sinks::stdout_color_sink_mt>();
-
-  // Initialize the application logger with file sink and console sink.
-  g_logger = std::make_shared<spdlog::logger>(
-    "server",
-    spdlog::sinks_init_list{fileSink, consoleSink});
-
-  g_logger->set_level(spdlog::level::debug);
-  g_logger->set_pattern("%H:%M:%S:%e [%^%l%$] [Thread %t] %v");
-
-  // Set is as the default logger for the application.
-  spdlog::set_default_logger(g_logger);
+  server::InitializeLogging(baseDirectory / "logs");
 
   spdlog::info("Running dedicated Alicia server v{}.", server::BuildVersion);
   if (not baseDirectory.empty())
@@ -193,14 +221,23 @@ int main(int argc, char** argv)
     std::mutex threadMtx;
     std::unique_lock threadLock(threadMtx);
 
-    while (shouldProgramRun)
+    // The server instance stops by itself once it handed off its listening sockets.
+    while (shouldProgramRun && serverInstance.IsRunning())
     {
-      shouldProgramRunCv.wait(threadLock);
+      shouldProgramRunCv.wait_for(threadLock, std::chrono::seconds(1));
+
+      // Registries are reloaded on this thread, directors keep
+      // reading the previous snapshots until the new ones are published.
+      if (shouldReloadRegistries.exchange(false, std::memory_order::relaxed))
+      {
+        spdlog::info("Reloading registries because of SIGHUP");
+        serverInstance.ReloadRegistries();
+      }
     }
   }
   else
   {
-    InteractiveLoop();
+    InteractiveLoop(serverInstance);
   }
 
   serverInstance.Terminate();
@@ -146,6 +146,7 @@ void MessengerDirector::Initialize()
     GetConfig().listen.address.to_string(),
     GetConfig().listen.port);
 
+  _chatterServer.SetSocketOptions(GetConfig().socket);
   _chatterServer.BeginHost(GetConfig().listen.address, GetConfig().listen.port);
 }
 
@@ -158,15 +159,14 @@ MessengerDirector::ClientContext& MessengerDirector::GetClientContext(
   const network::ClientId clientId,
   bool requireAuthentication)
 {
-  auto clientContextIter = _clients.find(clientId);
-  if (clientContextIter == _clients.end())
+  const auto clientContext = _clients.Find(clientId);
+  if (clientContext == nullptr)
     throw std::runtime_error("Messenger client is not available");
 
-  auto& clientContext = clientContextIter->second;
-  if (requireAuthentication && not clientContext.isAuthenticated)
+  if (requireAuthentication && not clientContext->isAuthenticated)
     throw std::runtime_error("Messenger client is not authenticated");
 
-  return clientContext;
+  return *clientContext;
 }
 
 std::optional<MessengerDirector::Client> MessengerDirector::GetClientByCharacterUid(
@@ -174,22 +174,17 @@ std::optional<MessengerDirector::Client> MessengerDirector::GetClientByCharacter
 {
   std::optional<Client> client{};
 
-  // Get snapshot of current clients
-  const auto clientsSnapshot = _clients;
-  // Find client iterator by character uid
-  const auto& iter = std::ranges::find_if(
-    clientsSnapshot,
-    [characterUid](const auto& client)
+  // Called from the other directors too, the clients are visited without copying them.
+  _clients.VisitEach(
+    [characterUid, &client](const network::ClientId clientId, const ClientContext& clientContext)
     {
-      const ClientContext& clientContext = client.second;
-      return clientContext.characterUid == characterUid;
-    });
+      if (clientContext.characterUid != characterUid)
+        return true;
 
-  // If client is found, set client id
-  if (iter != clientsSnapshot.cend())
-    client.emplace(Client{
-      .clientId = iter->first,
-      .clientContext = iter->second
+      client.emplace(Client{
+        .clientId = clientId,
+        .clientContext = clientContext});
+      return false;
     });
 
   return client;
@@ -209,12 +204,17 @@ Config::Messenger& MessengerDirector::GetConfig()
   return _serverInstance.GetSettings().messenger;
 }
 
+ChatterServer& MessengerDirector::GetChatterServer()
+{
+  return _chatterServer;
+}
+
 void MessengerDirector::HandleClientConnected(network::ClientId clientId)
 {
   spdlog::debug("Client {} connected to the messenger server from {}",
     clientId,
     _chatterServer.GetClientAddress(clientId).to_string());
-  _clients.try_emplace(clientId);
+  _clients.Emplace(clientId);
 }
 
 void MessengerDirector::HandleClientDisconnected(network::ClientId clientId)
@@ -231,7 +231,23 @@ void MessengerDirector::HandleClientDisconnected(network::ClientId clientId)
 
   // TODO: broadcast notify to friends & guilds that character is offline
 
-  _clients.erase(clientId);
+  _clients.Erase(clientId);
+}
+
+void MessengerDirector::HandleNetworkTick()
+{
+  if (_serverInstance.IsMemoryUsageReportDue("messenger"))
+    _serverInstance.PublishMemoryUsage("messenger", GetMemoryUsage());
+}
+
+util::MemoryUsageReport MessengerDirector::GetMemoryUsage() const
+{
+  util::MemoryUsageReport report{
+    {"clients", util::MemoryUsage{
+      .count = _clients.Size(),
+      .bytes = _clients.EstimateContainerHeapSize()}}};
+  _chatterServer.GetBufferMemoryUsage().AppendTo(report);
+  return report;
 }
 
 void MessengerDirector::HandleChatterLogin(
@@ -253,10 +269,17 @@ void MessengerDirector::HandleChatterLogin(
   boost::hash_combine(identityHash, MessengerOtpConstant);
 
   // Authorise the code received in the command against the calculated identity hash
-  clientContext.isAuthenticated = _serverInstance.GetOtpSystem().AuthorizeCode(
+  const bool isAuthenticated = _serverInstance.GetOtpSystem().AuthorizeCode(
     identityHash,
     command.code);
 
+  // The other directors look the clients up by their character, the fields they read
+  // are modified exclusively.
+  _clients.Modify(clientId, [isAuthenticated](ClientContext& context)
+  {
+    context.isAuthenticated = isAuthenticated;
+  });
+
   if (not clientContext.isAuthenticated)
   {
     // Login failed, bad actor, log and return
@@ -281,24 +304,29 @@ void MessengerDirector::HandleChatterLogin(
 
   protocol::ChatCmdLoginAckOK response{};
 
-  // TODO: remember status from last login?
-  clientContext.presence = protocol::Presence{
-    .status = protocol::Status::Online,
-    .scene = protocol::Presence::Scene::Ranch,
-    .sceneUid = clientContext.characterUid
-  };
-
   // Client request could be logging in as another character
+  data::Uid characterUid = clientContext.characterUid;
   _serverInstance.GetDataDirector().GetCharacter(command.characterUid).Mutable(
-    [&clientContext](data::Character& character)
+    [&characterUid](data::Character& character)
     {
-      clientContext.characterUid = character.uid();
+      characterUid = character.uid();
 
       // TODO: implement unread mail mechanics
 
       character.mailbox.hasNewMail() = false;
     });
 
+  _clients.Modify(clientId, [characterUid](ClientContext& context)
+  {
+    // TODO: remember status from last login?
+    context.presence = protocol::Presence{
+      .status = protocol::Status::Online,
+      .scene = protocol::Presence::Scene::Ranch,
+      .sceneUid = context.characterUid
+    };
+    context.characterUid = characterUid;
+  });
+
   response.member1 = clientContext.characterUid;
 
   // Load friends from character's stored friends list
@@ -464,16 +492,15 @@ void MessengerDirector::HandleChatterBuddyAdd(
 
   // Check if character is online, if so send request live, 
   // else queue it up for when character next comes online.
-  const auto clientsSnapshot = _clients;
   auto targetClient = std::ranges::find_if(
-    clientsSnapshot,
+    _clients,
     [targetCharacterUid](const auto& client)
     {
       return client.second.characterUid == targetCharacterUid;
     });
 
   // Notify responding character, if they are online
-  if (targetClient != clientsSnapshot.cend())
+  if (targetClient != _clients.end())
   {
     // Target is online, send friend request to recipient
     const ClientId targetClientId = targetClient->first;
@@ -563,9 +590,8 @@ void MessengerDirector::HandleChatterBuddyAddReply(
 
     // Check if requesting character is online, if so send response live,
     // else simply add responding character to friends list
-    const auto clientsSnapshot = _clients;
     auto requestingClient = std::ranges::find_if(
-      clientsSnapshot,
+      _clients,
       [requestingCharacterUid = command.requestingCharacterUid](const auto& client)
       {
         return client.second.characterUid == requestingCharacterUid;
@@ -577,7 +603,7 @@ void MessengerDirector::HandleChatterBuddyAddReply(
     std::optional<protocol::Presence> requestingCharacterPresence{};
 
     // Check if requesting character is still online to notify of friend request result
-    if (requestingClient != clientsSnapshot.cend())
+    if (requestingClient != _clients.end())
     {
       // Requesting character is online
       const ClientId requestingClientId = requestingClient->first;
@@ -684,16 +710,15 @@ void MessengerDirector::HandleChatterBuddyDelete(
   _chatterServer.QueueCommand<decltype(response)>(clientId, [response](){ return response; });
 
   // Send delete confirmation to target character if they are online
-  const auto clientsSnapshot = _clients;
   auto targetClient = std::ranges::find_if(
-    clientsSnapshot,
+    _clients,
     [targetCharacterUid = command.characterUid](const auto& client)
     {
       return client.second.characterUid == targetCharacterUid;
     });
 
   // If target character is online then send
-  if (targetClient != clientsSnapshot.cend())
+  if (targetClient != _clients.end())
   {
     const ClientId targetClientId = targetClient->first;
     // Invoking character's uid to be used for indicating friend delete to target character
@@ -1218,7 +1243,7 @@ void MessengerDirector::HandleChatterLetterSend(
       return client.second.characterUid == recipientCharacterUid;
     });
 
-  if (client == _clients.cend())
+  if (client == _clients.end())
     // Character is not online, all good and handled
     return;
 
@@ -1461,7 +1486,10 @@ void MessengerDirector::HandleChatterUpdateState(
   }
 
   // Update state for client context
-  clientContext.presence = command.presence;
+  _clients.Modify(clientId, [&command](ClientContext& context)
+  {
+    context.presence = command.presence;
+  });
 
   // Get guild uid of the invoking character
   data::Uid guildUid{data::InvalidUid};
@@ -1476,8 +1504,7 @@ void MessengerDirector::HandleChatterUpdateState(
   // This mechanism goes through all the online clients and checks if the invoker is in their stored friends list.
   std::vector<network::ClientId> friendsToNotify{};
 
-  const auto clientsSnapshot = _clients;
-  for (const auto& [onlineClientId, onlineClientContext] : clientsSnapshot)
+  for (const auto& [onlineClientId, onlineClientContext] : _clients)
   {
     // Skip unauthenticated clients
     bool isAuthenticated = onlineClientContext.isAuthenticated;
@@ -1493,9 +1520,11 @@ void MessengerDirector::HandleChatterUpdateState(
     }
 
     // Check if invoker is in the online client's stored friends list
+    // and get online character's guild uid
     bool isFriend = false;
+    data::Uid onlineCharacterGuildUid{data::InvalidUid};
     _serverInstance.GetDataDirector().GetCharacter(onlineClientContext.characterUid).Immutable(
-      [&isFriend, &clientContext](const data::Character& character)
+      [&isFriend, &onlineCharacterGuildUid, &clientContext](const data::Character& character)
       {
         isFriend = std::ranges::any_of(
           character.contacts.groups() | std::views::values,
@@ -1503,6 +1532,7 @@ void MessengerDirector::HandleChatterUpdateState(
           {
             return std::ranges::contains(group.members, clientContext.characterUid);
           });
+        onlineCharacterGuildUid = character.guildUid();
       });
 
     if (isFriend)
@@ -1510,14 +1540,6 @@ void MessengerDirector::HandleChatterUpdateState(
       friendsToNotify.emplace_back(onlineClientId);
     }
 
-    // Get online character's guild uid
-    data::Uid onlineCharacterGuildUid{data::InvalidUid};
-    _serverInstance.GetDataDirector().GetCharacter(onlineClientContext.characterUid).Immutable(
-      [&onlineCharacterGuildUid](const data::Character& character)
-      {
-        onlineCharacterGuildUid = character.guildUid();
-      });
-
     bool isInvokerInAGuild = guildUid != data::InvalidUid;
     bool isOnlineCharacterInAGuild = onlineCharacterGuildUid != data::InvalidUid;
     bool isInvokerAndOnlineCharacterInSameGuild = guildUid == onlineCharacterGuildUid;
@@ -1777,7 +1799,10 @@ void MessengerDirector::HandleChatterGuildLogin(
     return;
   }
 
-  clientContext.isAuthenticated = true;
+  _clients.Modify(clientId, [](ClientContext& context)
+  {
+    context.isAuthenticated = true;
+  });
 
   // Check if client belongs to the guild in the command
   data::Uid characterGuildUid{data::InvalidUid};
@@ -1837,8 +1862,7 @@ void MessengerDirector::HandleChatterGuildLogin(
             .characterUid = guildMemberUid});
 
         // Find if the guild member is connected to the messenger server
-        const auto clientsSnapshot = _clients;
-        for (auto& onlineClientContext : clientsSnapshot | std::views::values)
+        for (const auto& onlineClientContext : _clients | std::views::values)
         {
           // If guild member is connected, set status to the one set by the character
           if (onlineClientContext.characterUid == guildMemberUid)
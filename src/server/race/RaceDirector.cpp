@@ -28,6 +28,7 @@
 #include <spdlog/spdlog.h>
 
 #include <bitset>
+#include <ranges>
 
 namespace server
 {
@@ -56,15 +57,16 @@ bool RollCritical(tracker::RaceTracker::Racer& racer, const server::registry::Ma
 
 const server::registry::Magic::SlotInfo RandomMagicItem(ServerInstance& serverInstance,tracker::RaceTracker::Racer& racer)
 {
+  const auto magicRegistry = serverInstance.GetMagicRegistry().Pin();
   const auto& itemPool = (racer.team == tracker::RaceTracker::Racer::Team::Solo
-    ? serverInstance.GetMagicRegistry().GetSoloPool()
-    : serverInstance.GetMagicRegistry().GetTeamPool());
+    ? magicRegistry->soloPool
+    : magicRegistry->teamPool);
   static std::random_device rd;
   std::uniform_int_distribution distribution(0, static_cast<int>(itemPool.size() - 1));
-  auto magicSlotInfo = serverInstance.GetMagicRegistry().GetSlotInfo(itemPool[distribution(rd)]);
+  auto magicSlotInfo = magicRegistry->GetSlotInfo(itemPool[distribution(rd)]);
   if (RollCritical(racer, magicSlotInfo))
   {
-    magicSlotInfo = serverInstance.GetMagicRegistry().GetSlotInfo(magicSlotInfo.criticalType);
+    magicSlotInfo = magicRegistry->GetSlotInfo(magicSlotInfo.criticalType);
   }
   return magicSlotInfo;
 }
@@ -175,19 +177,19 @@ RaceDirector::RaceDirector(ServerInstance& serverInstance)
   _commandServer.RegisterCommandHandler<protocol::AcCmdCRHurdleClearResult>(
     [this](ClientId clientId, const auto& message)
     {
-      HandleHurdleClearResult(clientId, message);
+      return HandleHurdleClearResult(clientId, message);
     });
 
   _commandServer.RegisterCommandHandler<protocol::AcCmdCRStartingRate>(
     [this](ClientId clientId, const auto& message)
     {
-      HandleStartingRate(clientId, message);
+      return HandleStartingRate(clientId, message);
     });
 
   _commandServer.RegisterCommandHandler<protocol::AcCmdUserRaceUpdatePos>(
     [this](ClientId clientId, const auto& message)
     {
-      HandleRaceUserPos(clientId, message);
+      return HandleRaceUserPos(clientId, message);
     });
 
   _commandServer.RegisterCommandHandler<protocol::AcCmdCRChat>(
@@ -199,13 +201,13 @@ RaceDirector::RaceDirector(ServerInstance& serverInstance)
   _commandServer.RegisterCommandHandler<protocol::AcCmdCRRelayCommand>(
     [this](ClientId clientId, const auto& message)
     {
-      HandleRelayCommand(clientId, message);
+      return HandleRelayCommand(clientId, message);
     });
 
   _commandServer.RegisterCommandHandler<protocol::AcCmdCRRelay>(
     [this](ClientId clientId, const auto& message)
     {
-      HandleRelay(clientId, message);
+      return HandleRelay(clientId, message);
     });
 
   _commandServer.RegisterCommandHandler<protocol::AcCmdUserRaceActivateInteractiveEvent>(
@@ -296,7 +298,7 @@ RaceDirector::RaceDirector(ServerInstance& serverInstance)
 
 void RaceDirector::Initialize()
 {
-  spdlog::debug(
+  SPDLOG_DEBUG(
     "Race server listening on {}:{}",
     GetConfig().listen.address.to_string(),
     GetConfig().listen.port);
@@ -363,6 +365,8 @@ void RaceDirector::Initialize()
   });
   test.detach();
 
+  _serverInstance.BeginCapture(_commandServer, "race");
+  _commandServer.SetSocketOptions(GetConfig().socket);
   _commandServer.BeginHost(GetConfig().listen.address, GetConfig().listen.port);
 }
 
@@ -383,6 +387,22 @@ void RaceDirector::Tick()
     spdlog::error("Exception ticking a race scheduler: {}", x.what());
   }
 
+  // Expire the magic effects of the rooms in batch.
+  for (auto& [raceUid, raceInstance] : _raceInstances)
+  {
+    if (raceInstance.effects.IsEmpty())
+      continue;
+
+    try
+    {
+      TickMagicEffects(raceInstance);
+    }
+    catch (const std::exception& x)
+    {
+      spdlog::error("Exception ticking magic effects of room {}: {}", raceUid, x.what());
+    }
+  }
+
   // Process rooms which are loading
   for (auto& [raceUid, raceInstance] : _raceInstances)
   {
@@ -418,7 +438,8 @@ void RaceDirector::Tick()
         racer.state = tracker::RaceTracker::Racer::State::Disconnected;
     }
 
-    const auto mapBlockTemplate = _serverInstance.GetCourseRegistry().GetMapBlockInfo(
+    const auto courseRegistry = _serverInstance.GetCourseRegistry().Pin();
+    const auto& mapBlockTemplate = courseRegistry->GetMapBlockInfo(
       raceInstance.raceMapBlockId);
 
     // Switch to the racing stage and set the timeout time point.
@@ -480,18 +501,15 @@ void RaceDirector::Tick()
       std::scoped_lock lock(raceInstance.clientsMutex);
       for (const ClientId& raceClientId : raceInstance.clients)
       {
+        // The clients belong to the network thread, the client is visited
+        // and the disconnected client is not found.
         bool isParticipant = false;
-        try
-        {
-          const auto& raceClientContext = GetClientContext(raceClientId);
-          isParticipant = raceInstance.tracker.IsRacer(
-            raceClientContext.characterUid);
-        }
-        catch ([[maybe_unused]] const std::exception& x)
+        _clients.Visit(raceClientId, [&isParticipant, &raceInstance](
+          const ClientContext& raceClientContext)
         {
-          // the client has disconnected
-          // this is a data race
-        }
+          isParticipant = raceClientContext.isAuthenticated
+            && raceInstance.tracker.IsRacer(raceClientContext.characterUid);
+        });
 
         if (not isParticipant)
           continue;
@@ -627,9 +645,9 @@ void RaceDirector::BroadcastChangeRoomOptions(
 
 void RaceDirector::HandleClientConnected(ClientId clientId)
 {
-  _clients.try_emplace(clientId);
+  _clients.Emplace(clientId);
 
-  spdlog::debug(
+  SPDLOG_TRACE(
     "Client {} connected to the race server from {}",
     clientId,
     _commandServer.GetClientAddress(clientId).to_string());
@@ -648,14 +666,18 @@ void RaceDirector::HandleClientDisconnected(ClientId clientId)
   }
 
   spdlog::info("Client {} disconnected from the race server", clientId);
-  _clients.erase(clientId);
+  _clients.Erase(clientId);
 }
 
 void RaceDirector::DisconnectCharacter(data::Uid characterUid)
 {
   try
   {
-    _commandServer.DisconnectClient(GetClientIdByCharacterUid(characterUid));
+    // Disconnecting from the network thread erases the client right away,
+    // so the client is disconnected only after the visit.
+    const auto clientId = FindClientIdByCharacterUid(characterUid);
+    if (clientId)
+      _commandServer.DisconnectClient(*clientId);
   }
   catch (const std::exception&)
   {
@@ -673,42 +695,116 @@ Config::Race& RaceDirector::GetConfig()
   return GetServerInstance().GetSettings().race;
 }
 
-RaceDirector::ClientContext& RaceDirector::GetClientContext(ClientId clientId, bool requireAuthorized)
+Scheduler& RaceDirector::GetScheduler()
 {
-  auto clientContextIter = _clients.find(clientId);
-  if (clientContextIter == _clients.end())
-    throw std::runtime_error("Race client is not available");
+  return _scheduler;
+}
 
-  auto& clientContext = clientContextIter->second;
-  if (requireAuthorized && not clientContext.isAuthenticated)
-    throw std::runtime_error("Race client is not authenticated");
+CommandServer& RaceDirector::GetCommandServer()
+{
+  return _commandServer;
+}
 
-  return clientContext;
+std::optional<network::ClientStatistics> RaceDirector::GetClientStatistics(
+  const data::Uid characterUid)
+{
+  const auto clientId = FindClientIdByCharacterUid(characterUid);
+  if (not clientId)
+    return std::nullopt;
+
+  return _commandServer.GetClientStatistics(*clientId);
 }
 
-ClientId RaceDirector::GetClientIdByCharacterUid(data::Uid characterUid)
+util::MemoryUsageReport RaceDirector::GetMemoryUsage()
 {
-  for (auto& [clientId, clientContext] : _clients)
+  util::MemoryUsageReport report;
+
+  report.emplace_back("clients", util::MemoryUsage{
+    .count = _clients.Size(),
+    .bytes = _clients.EstimateContainerHeapSize()});
+
+  util::MemoryUsage races{
+    .count = _raceInstances.size(),
+    .bytes = util::EstimateContainerHeapSize(_raceInstances)};
+  util::MemoryUsage trackers{};
+  util::MemoryUsage effects{};
+  for (auto& raceInstance : _raceInstances | std::views::values)
   {
-    if (clientContext.characterUid == characterUid
-      && clientContext.isAuthenticated)
-      return clientId;
+    trackers += raceInstance.tracker.GetMemoryUsage();
+    effects += raceInstance.effects.GetMemoryUsage();
+
+    std::scoped_lock lock(raceInstance.clientsMutex);
+    races.bytes += util::EstimateContainerHeapSize(raceInstance.clients);
   }
+  report.emplace_back("races", races);
+  report.emplace_back("race_trackers", trackers);
+  report.emplace_back("race_effects", effects);
 
-  throw std::runtime_error("Character not associated with any client");
+  report.emplace_back("expired_effects", util::MemoryUsage{
+    .count = _expiredEffects.size() + _expiredObstacles.size(),
+    .bytes = util::EstimateContainerHeapSize(_expiredEffects)
+      + util::EstimateContainerHeapSize(_expiredObstacles)});
+
+  report.emplace_back("rooms", _serverInstance.GetRoomSystem().GetMemoryUsage());
+  report.emplace_back("scheduler", _scheduler.GetMemoryUsage());
+  _commandServer.GetBufferMemoryUsage().AppendTo(report);
+
+  return report;
 }
 
-RaceDirector::ClientContext& RaceDirector::GetClientContextByCharacterUid(
-  data::Uid characterUid)
+RaceDirector::ClientContext& RaceDirector::GetClientContext(ClientId clientId, bool requireAuthorized)
 {
-  for (auto& clientContext : _clients | std::views::values)
+  const auto clientContext = TryGetClientContext(clientId, requireAuthorized);
+  if (not clientContext)
   {
-    if (clientContext.characterUid == characterUid
-      && clientContext.isAuthenticated)
-      return clientContext;
+    if (clientContext.error() == network::HandlerError::UnknownClient)
+      throw std::runtime_error("Race client is not available");
+    throw std::runtime_error("Race client is not authenticated");
   }
 
-  throw std::runtime_error("Character not associated with any client");
+  return **clientContext;
+}
+
+std::expected<RaceDirector::ClientContext*, network::HandlerError> RaceDirector::TryGetClientContext(
+  ClientId clientId,
+  bool requireAuthorized)
+{
+  const auto clientContext = _clients.Find(clientId);
+  if (clientContext == nullptr)
+    return std::unexpected(network::HandlerError::UnknownClient);
+
+  if (requireAuthorized && not clientContext->isAuthenticated)
+    return std::unexpected(network::HandlerError::Unauthenticated);
+
+  return clientContext;
+}
+
+std::optional<ClientId> RaceDirector::FindClientIdByCharacterUid(
+  const data::Uid characterUid) const
+{
+  std::optional<ClientId> foundClientId;
+  _clients.VisitEach([characterUid, &foundClientId](
+    const ClientId clientId,
+    const ClientContext& clientContext)
+  {
+    if (clientContext.characterUid != characterUid
+      || not clientContext.isAuthenticated)
+      return true;
+
+    foundClientId.emplace(clientId);
+    return false;
+  });
+
+  return foundClientId;
+}
+
+ClientId RaceDirector::GetClientIdByCharacterUid(data::Uid characterUid)
+{
+  const auto clientId = FindClientIdByCharacterUid(characterUid);
+  if (not clientId)
+    throw std::runtime_error("Character not associated with any client");
+
+  return *clientId;
 }
 
 RaceDirector::RaceInstance& RaceDirector::GetRaceInstance(
@@ -746,18 +842,42 @@ RaceDirector::RaceInstance& RaceDirector::GetRaceInstance(
   return raceInstance;
 }
 
+std::expected<RaceDirector::RaceInstance*, network::HandlerError> RaceDirector::TryGetRaceInstance(
+  const ClientContext& clientContext,
+  const bool checkRacer)
+{
+  const auto raceInstanceIter = _raceInstances.find(clientContext.roomUid);
+  if (clientContext.roomUid == data::InvalidUid
+    || raceInstanceIter == _raceInstances.end())
+  {
+    return std::unexpected(network::HandlerError::InvalidState);
+  }
+
+  auto& raceInstance = raceInstanceIter->second;
+  if (checkRacer && not raceInstance.tracker.IsRacer(clientContext.characterUid))
+    return std::unexpected(network::HandlerError::InvalidState);
+
+  return &raceInstance;
+}
+
 void RaceDirector::HandleEnterRoom(
   ClientId clientId,
   const protocol::AcCmdCREnterRoom& command)
 {
-  auto& clientContext = _clients[clientId];
+  auto& clientContext = _clients.Emplace(clientId);
 
   size_t identityHash = std::hash<uint32_t>()(command.characterUid);
   boost::hash_combine(identityHash, command.roomUid);
 
-  clientContext.isAuthenticated = _serverInstance.GetOtpSystem().AuthorizeCode(
+  // The other threads look the clients up by their character, the fields they read
+  // are modified exclusively.
+  const bool isAuthenticated = _serverInstance.GetOtpSystem().AuthorizeCode(
     identityHash,
     command.oneTimePassword);
+  _clients.Modify(clientId, [isAuthenticated](ClientContext& context)
+  {
+    context.isAuthenticated = isAuthenticated;
+  });
 
   const bool doesRoomExist = _serverInstance.GetRoomSystem().RoomExists(
     command.roomUid);
@@ -793,8 +913,11 @@ void RaceDirector::HandleEnterRoom(
 
   // The client is authorized so we can trust the identifiers
   // that were provided.
-  clientContext.characterUid = command.characterUid;
-  clientContext.roomUid = command.roomUid;
+  _clients.Modify(clientId, [&command](ClientContext& context)
+  {
+    context.characterUid = command.characterUid;
+    context.roomUid = command.roomUid;
+  });
 
   // Try to emplace the room instance.
   const auto& [raceInstanceIter, inserted] = _raceInstances.try_emplace(
@@ -1356,44 +1479,40 @@ void RaceDirector::HandleReadyRace(
 void RaceDirector::PrepareItemSpawners(data::Uid roomUid)
 {
   auto& raceInstance = _raceInstances[roomUid];
+  raceInstance.mapLayout = nullptr;
 
   try {
-    const auto& gameModeInfo = GetServerInstance().GetCourseRegistry().GetCourseGameModeInfo(
-      static_cast<uint32_t>(raceInstance.raceGameMode));
-    const auto& mapBlockInfo = GetServerInstance().GetCourseRegistry().GetMapBlockInfo(
+    // The layout is precomputed by the registry, the race only pins it
+    // and adds one item per spawner.
+    raceInstance.course = GetServerInstance().GetCourseRegistry().Pin();
+    raceInstance.mapLayout = &raceInstance.course->GetMapLayout(
+      static_cast<uint8_t>(raceInstance.raceGameMode),
       raceInstance.raceMapBlockId);
 
-    // Get the map position offset
-    const auto& offset = mapBlockInfo.offset;
-
-    // Spawn items based on map positions and game mode allowed deck IDs
-    for (const uint32_t usedDeckItemId : gameModeInfo.usedDeckItemIds)
+    static std::random_device rd;
+    bool isFirstItem = true;
+    for (const auto& spawner : raceInstance.mapLayout->itemSpawners)
     {
-      const auto& deckItemInfo = GetServerInstance().GetCourseRegistry().GetDeckItemInfo(usedDeckItemId);
-      for (const auto& mapDeckItemInstance : mapBlockInfo.deckItems)
+      auto& item = raceInstance.tracker.AddItem();
+      if (isFirstItem)
       {
-        if (mapDeckItemInstance.deckId != usedDeckItemId)
-          continue;
+        raceInstance.firstItemOid = item.oid;
+        isFirstItem = false;
+      }
 
-        auto& item = raceInstance.tracker.AddItem();
-        item.itemTypes = deckItemInfo.itemTypes;
-        
-        // Randomly pick an initial type
-        if (!item.itemTypes.empty())
-        {
-          static std::random_device rd;
-          std::uniform_int_distribution<size_t> distribution(0, item.itemTypes.size() - 1);
-          item.currentType = item.itemTypes[distribution(rd)];
-        }
+      item.itemTypes = spawner.itemTypes;
+      item.position = spawner.position;
 
-        item.position[0] = mapDeckItemInstance.position[0] + offset[0];
-        item.position[1] = mapDeckItemInstance.position[1] + offset[1];
-        item.position[2] = mapDeckItemInstance.position[2] + offset[2];
+      // Randomly pick an initial type
+      if (!item.itemTypes.empty())
+      {
+        std::uniform_int_distribution<size_t> distribution(0, item.itemTypes.size() - 1);
+        item.currentType = item.itemTypes[distribution(rd)];
       }
     }
-
   }
   catch (const std::exception& e) {
+    raceInstance.mapLayout = nullptr;
     spdlog::warn("Failed to prepare item spawners for room {}: {}", roomUid, e.what());
   }
 }
@@ -1489,7 +1608,8 @@ void RaceDirector::HandleStartRace(
     || roomSelectedCourses == NewMapsCourseId
     || roomSelectedCourses == HotMapsCourseId)
   {
-    const auto& gameMode = _serverInstance.GetCourseRegistry().GetCourseGameModeInfo(
+    const auto courseRegistry = _serverInstance.GetCourseRegistry().Pin();
+    const auto& gameMode = courseRegistry->GetCourseGameModeInfo(
       roomGameMode);
     if (not gameMode.mapPool.empty())
     {
@@ -1508,11 +1628,11 @@ void RaceDirector::HandleStartRace(
         gameMode.mapPool.cbegin(),
         gameMode.mapPool.cend(),
         std::back_inserter(filteredMaps),
-        [this, masterLevel](uint32_t mapBlockId)
+        [&courseRegistry, masterLevel](uint32_t mapBlockId)
         {
           try
           {
-            const auto& mapBlockInfo = _serverInstance.GetCourseRegistry().GetMapBlockInfo(
+            const auto& mapBlockInfo = courseRegistry->GetMapBlockInfo(
               mapBlockId);
             return mapBlockInfo.requiredLevel <= masterLevel;
           }
@@ -1553,8 +1673,9 @@ void RaceDirector::HandleStartRace(
       });
   }
 
-  // Clear the tracker before the race.
+  // Clear the trackers before the race.
   raceInstance.tracker.Clear();
+  raceInstance.effects.Clear();
 
   // Add the items.
   PrepareItemSpawners(roomUid);
@@ -1795,7 +1916,7 @@ void RaceDirector::HandleUserRaceFinal(
 {
   bool isDnf = command.member3 > 0;
   std::chrono::hh_mm_ss raceTime{command.courseTime};
-  spdlog::debug("[{}] AcCmdUserRaceFinal: {} {} {}",
+  SPDLOG_DEBUG("[{}] AcCmdUserRaceFinal: {} {} {}",
     clientId,
     command.oid,
     isDnf ?
@@ -1906,7 +2027,7 @@ void RaceDirector::HandleAwardStart(
   // Send to clients not participating in races.
   for (const auto raceClientId : raceInstance.clients)
   {
-    const auto& raceClientContext = _clients[raceClientId];
+    const auto& raceClientContext = _clients.Emplace(raceClientId);
 
     // Whether the client is a participating racer that did not disconnect.
     bool isParticipatingRacer = false;
@@ -1984,7 +2105,8 @@ void RaceDirector::HandleStarPointGet(
       "Client tried to perform action on behalf of different racer");
   }
 
-  const auto& gameModeTemplate = GetServerInstance().GetCourseRegistry().GetCourseGameModeInfo(
+  const auto courseRegistry = GetServerInstance().GetCourseRegistry().Pin();
+  const auto& gameModeTemplate = courseRegistry->GetCourseGameModeInfo(
     static_cast<uint8_t>(raceInstance.raceGameMode));
 
   uint32_t gainedStarPoints = command.gainedStarPoints;
@@ -2029,7 +2151,8 @@ void RaceDirector::HandleRequestSpur(
       "Client tried to perform action on behalf of different racer");
   }
 
-  const auto& gameModeTemplate = GetServerInstance().GetCourseRegistry().GetCourseGameModeInfo(
+  const auto courseRegistry = GetServerInstance().GetCourseRegistry().Pin();
+  const auto& gameModeTemplate = courseRegistry->GetCourseGameModeInfo(
     static_cast<uint8_t>(raceInstance.raceGameMode));
 
   if (racer.starPointValue < gameModeTemplate.spurConsumeStarPoints)
@@ -2064,22 +2187,26 @@ void RaceDirector::HandleRequestSpur(
     });
 }
 
-void RaceDirector::HandleHurdleClearResult(
+network::HandlerResult RaceDirector::HandleHurdleClearResult(
   ClientId clientId,
   const protocol::AcCmdCRHurdleClearResult& command)
 {
-  const auto& clientContext = GetClientContext(clientId);
-  auto& raceInstance = GetRaceInstance(clientContext);
+  const auto clientContextResult = TryGetClientContext(clientId);
+  if (not clientContextResult)
+    return std::unexpected(clientContextResult.error());
+  const auto& clientContext = **clientContextResult;
+
+  const auto raceInstanceResult = TryGetRaceInstance(clientContext);
+  if (not raceInstanceResult)
+    return std::unexpected(raceInstanceResult.error());
+  auto& raceInstance = **raceInstanceResult;
 
   auto& racer = raceInstance.tracker.GetRacer(
     clientContext.characterUid);
 
   // TODO: Revise this in NPC races
   if (command.characterOid != racer.oid)
-  {
-    throw std::runtime_error(
-      "Client tried to perform action on behalf of different racer");
-  }
+    return std::unexpected(network::HandlerError::InvalidCommand);
 
   protocol::AcCmdCRHurdleClearResultOK response{
     .characterOid = command.characterOid,
@@ -2095,7 +2222,8 @@ void RaceDirector::HandleHurdleClearResult(
     .giveMagicItem = false
   };
 
-  const auto& gameModeTemplate = GetServerInstance().GetCourseRegistry().GetCourseGameModeInfo(
+  const auto courseRegistry = GetServerInstance().GetCourseRegistry().Pin();
+  const auto& gameModeTemplate = courseRegistry->GetCourseGameModeInfo(
       static_cast<uint8_t>(raceInstance.raceGameMode));
 
   switch (command.hurdleClearType)
@@ -2159,9 +2287,7 @@ void RaceDirector::HandleHurdleClearResult(
     }
     default:
     {
-      spdlog::warn("Unhandled hurdle clear type {}",
-        static_cast<uint8_t>(command.hurdleClearType));
-      return;
+      return std::unexpected(network::HandlerError::InvalidCommand);
     }
   }
 
@@ -2190,9 +2316,11 @@ void RaceDirector::HandleHurdleClearResult(
     {
       return response;
     });
+
+  return {};
 }
 
-void RaceDirector::HandleStartingRate(
+network::HandlerResult RaceDirector::HandleStartingRate(
   ClientId clientId,
   const protocol::AcCmdCRStartingRate& command)
 {
@@ -2200,24 +2328,28 @@ void RaceDirector::HandleStartingRate(
   if (command.unk1 < 1 && command.boostGained < 1)
   {
     // Velocity and boost gained is not valid
-    // TODO: throw?
-    return;
+    return std::unexpected(network::HandlerError::InvalidCommand);
   }
 
-  const auto& clientContext = GetClientContext(clientId);
-  auto& raceInstance = GetRaceInstance(clientContext);
+  const auto clientContextResult = TryGetClientContext(clientId);
+  if (not clientContextResult)
+    return std::unexpected(clientContextResult.error());
+  const auto& clientContext = **clientContextResult;
+
+  const auto raceInstanceResult = TryGetRaceInstance(clientContext);
+  if (not raceInstanceResult)
+    return std::unexpected(raceInstanceResult.error());
+  auto& raceInstance = **raceInstanceResult;
 
   auto& racer = raceInstance.tracker.GetRacer(
     clientContext.characterUid);
 
   // TODO: Revise this in NPC races
   if (command.characterOid != racer.oid)
-  {
-    throw std::runtime_error(
-      "Client tried to perform action on behalf of different racer");
-  }
+    return std::unexpected(network::HandlerError::InvalidCommand);
 
-  const auto& gameModeTemplate = GetServerInstance().GetCourseRegistry().GetCourseGameModeInfo(
+  const auto courseRegistry = GetServerInstance().GetCourseRegistry().Pin();
+  const auto& gameModeTemplate = courseRegistry->GetCourseGameModeInfo(
     static_cast<uint8_t>(raceInstance.raceGameMode));
 
   // TODO: validate boost gained against a table and determine good/perfect start
@@ -2238,57 +2370,70 @@ void RaceDirector::HandleStartingRate(
     {
       return response;
     });
+
+  return {};
 }
 
-void RaceDirector::HandleRaceUserPos(
+network::HandlerResult RaceDirector::HandleRaceUserPos(
   ClientId clientId,
   const protocol::AcCmdUserRaceUpdatePos& command)
 {
-  const auto& clientContext = GetClientContext(clientId);
-  auto& raceInstance = GetRaceInstance(clientContext);
+  const auto clientContextResult = TryGetClientContext(clientId);
+  if (not clientContextResult)
+    return std::unexpected(clientContextResult.error());
+  const auto& clientContext = **clientContextResult;
+
+  const auto raceInstanceResult = TryGetRaceInstance(clientContext);
+  if (not raceInstanceResult)
+    return std::unexpected(raceInstanceResult.error());
+  auto& raceInstance = **raceInstanceResult;
   auto& racer = raceInstance.tracker.GetRacer(clientContext.characterUid);
 
   // TODO: Revise this in NPC races
   if (command.oid != racer.oid)
-  {
-    throw std::runtime_error(
-      "Client tried to perform action on behalf of different racer");
-  }
+    return std::unexpected(network::HandlerError::InvalidCommand);
 
-  const auto& gameModeTemplate = GetServerInstance().GetCourseRegistry().GetCourseGameModeInfo(
+  const auto courseRegistry = GetServerInstance().GetCourseRegistry().Pin();
+  const auto& gameModeTemplate = courseRegistry->GetCourseGameModeInfo(
     static_cast<uint8_t>(raceInstance.raceGameMode));
 
-  for (const auto& [itemOid, item] : raceInstance.tracker.GetItems())
-  {
-    const bool canItemRespawn = std::chrono::steady_clock::now() >= item.respawnTimePoint;
-    if (not canItemRespawn)
-      continue;
+  const auto now = std::chrono::steady_clock::now();
+  auto& items = raceInstance.tracker.GetItems();
 
+  // Whether the player is close enough to the item for it to be spawned.
+  const auto isItemInPlayerProximity = [&command](const tracker::RaceTracker::Item& item)
+  {
     // The distance between the player and the item.
     const auto distanceBetweenPlayerAndItem = std::sqrt(
       std::pow(command.member2[0] - item.position[0], 2) +
       std::pow(command.member2[1] - item.position[1], 2) +
       std::pow(command.member2[2] - item.position[2], 2));
 
-    // A distance of the player from the item before it can be spawned.
-    constexpr double ItemSpawnDistanceThreshold = 90.0;
+    return distanceBetweenPlayerAndItem < registry::Course::MapLayout::ItemSpawnDistance;
+  };
 
-    const bool isItemInPlayerProximity = distanceBetweenPlayerAndItem < ItemSpawnDistanceThreshold;
-    const bool isItemAlreadyTracked = racer.trackedItems.contains(itemOid);
+  // If the tracked item is not in the player's proximity anymore
+  // then remove it from the tracked items.
+  std::erase_if(racer.trackedItems, [&](const tracker::Oid itemOid)
+  {
+    const auto itemIter = items.find(itemOid);
+    if (itemIter == items.cend())
+      return true;
 
-    if (isItemAlreadyTracked)
-    {
-      // If the item is not in the player's proximity anymore
-      // then remove it from the tracked items.
-      if (not isItemInPlayerProximity)
-        racer.trackedItems.erase(itemOid);
+    const auto& item = itemIter->second;
+    const bool canItemRespawn = now >= item.respawnTimePoint;
+    return canItemRespawn && not isItemInPlayerProximity(item);
+  });
 
-      continue;
-    }
+  const auto trySpawnItem = [&](const tracker::RaceTracker::Item& item)
+  {
+    const bool canItemRespawn = now >= item.respawnTimePoint;
+    if (not canItemRespawn)
+      return;
 
-    // If the item is not in player's proximity do not spawn it.
-    if (not isItemInPlayerProximity)
-      continue;
+    // If the item is already spawned or it is not in player's proximity do not spawn it.
+    if (racer.trackedItems.contains(item.oid) || not isItemInPlayerProximity(item))
+      return;
 
     protocol::AcCmdRCCreateItem spawn{
       .itemId = item.oid,
@@ -2304,6 +2449,25 @@ void RaceDirector::HandleRaceUserPos(
     {
       return spawn;
     });
+  };
+
+  if (raceInstance.mapLayout != nullptr)
+  {
+    // Only visit the items of the spawners around the player.
+    raceInstance.mapLayout->ForEachSpawnerNear(
+      command.member2,
+      [&](const uint32_t spawnerIdx)
+      {
+        const auto itemIter = items.find(
+          static_cast<tracker::Oid>(raceInstance.firstItemOid + spawnerIdx));
+        if (itemIter != items.cend())
+          trySpawnItem(itemIter->second);
+      });
+  }
+  else
+  {
+    for (const auto& item : items | std::views::values)
+      trySpawnItem(item);
   }
 
   // Only regenerate magic during active race (after countdown finishes)
@@ -2357,6 +2521,8 @@ void RaceDirector::HandleRaceUserPos(
     if (clientId == raceClientId)
       continue;
   }
+
+  return {};
 }
 
 void RaceDirector::HandleChat(ClientId clientId, const protocol::AcCmdCRChat& command)
@@ -2379,7 +2545,7 @@ void RaceDirector::HandleChat(ClientId clientId, const protocol::AcCmdCRChat& co
   const auto userName = _serverInstance.GetLobbyDirector().GetUserByCharacterUid(
     clientContext.characterUid).userName;
 
-  spdlog::info("[Room {}] {} ({}): {}",
+  SPDLOG_DEBUG("[Room {}] {} ({}): {}",
     clientContext.roomUid,
     characterName,
     userName,
@@ -2442,11 +2608,14 @@ void RaceDirector::HandleChat(ClientId clientId, const protocol::AcCmdCRChat& co
   }
 }
 
-void RaceDirector::HandleRelayCommand(
+network::HandlerResult RaceDirector::HandleRelayCommand(
   ClientId clientId,
   const protocol::AcCmdCRRelayCommand& command)
 {
-  const auto& clientContext = GetClientContext(clientId);
+  const auto clientContextResult = TryGetClientContext(clientId);
+  if (not clientContextResult)
+    return std::unexpected(clientContextResult.error());
+  const auto& clientContext = **clientContextResult;
 
   // Create relay notify message
   protocol::AcCmdCRRelayCommandNotify notify{
@@ -2454,7 +2623,10 @@ void RaceDirector::HandleRelayCommand(
     .member2 = command.member2};
 
   // Get the room instance for this client
-  const auto& raceInstance = GetRaceInstance(clientContext);
+  const auto raceInstanceResult = TryGetRaceInstance(clientContext);
+  if (not raceInstanceResult)
+    return std::unexpected(raceInstanceResult.error());
+  const auto& raceInstance = **raceInstanceResult;
 
   // Relay the command to all other clients in the room
   for (const ClientId raceClientId : raceInstance.clients)
@@ -2466,13 +2638,18 @@ void RaceDirector::HandleRelayCommand(
         [notify]{return notify;});
     }
   }
+
+  return {};
 }
 
-void RaceDirector::HandleRelay(
+network::HandlerResult RaceDirector::HandleRelay(
   ClientId clientId,
   const protocol::AcCmdCRRelay& command)
 {
-  const auto& clientContext = GetClientContext(clientId);
+  const auto clientContextResult = TryGetClientContext(clientId);
+  if (not clientContextResult)
+    return std::unexpected(clientContextResult.error());
+  const auto& clientContext = **clientContextResult;
 
   // Create relay notify message
   protocol::AcCmdCRRelayNotify notify{
@@ -2482,7 +2659,10 @@ void RaceDirector::HandleRelay(
     .data = std::move(command.data),};
 
   // Get the room instance for this client
-  const auto& raceInstance = GetRaceInstance(clientContext);
+  const auto raceInstanceResult = TryGetRaceInstance(clientContext);
+  if (not raceInstanceResult)
+    return std::unexpected(raceInstanceResult.error());
+  const auto& raceInstance = **raceInstanceResult;
 
   // Relay the command to all other clients in the room
   for (const ClientId raceClientId : raceInstance.clients)
@@ -2494,6 +2674,8 @@ void RaceDirector::HandleRelay(
         [notify]{return notify;});
     }
   }
+
+  return {};
 }
 
 void RaceDirector::HandleUserRaceActivateInteractiveEvent
@@ -2695,143 +2877,48 @@ void RaceDirector::HandleUseMagicItem(
       [usageNotify]() { return usageNotify; });
   }
 
-  const auto& magicSlotInfo = GetServerInstance().GetMagicRegistry().GetSlotInfo(command.magicItemId);
+  const auto magicRegistry = GetServerInstance().GetMagicRegistry().Pin();
+  const auto& magicSlotInfo = magicRegistry->GetSlotInfo(command.magicItemId);
 
-  // Send effect for items that have instant effects
-  std::vector<std::tuple<server::tracker::Oid, std::optional<std::function<void()>>>> affectedOidsAndAfterEffectCallbacks;
-  switch (magicSlotInfo.type)
+  const auto now = std::chrono::steady_clock::now();
+  const auto& effectInfo = magicSlotInfo.effect;
+
+  // Obstacles placed by the magic expire after their lifetime.
+  if (effectInfo.obstacleLifetime.count() > 0)
   {
-    // Shield
-    // TODO: Maybe not change it if they already have a stronger shield?
-    case 4:
-    {
-      racer.shield = tracker::RaceTracker::Racer::Shield::Normal;
-      const auto afterEffectRemoved = [&racer]()
-      {
-        racer.shield = tracker::RaceTracker::Racer::Shield::None;
-      };
-      this->ScheduleSkillEffect(raceInstance, command.characterOid, racer.oid, magicSlotInfo, afterEffectRemoved);
-      break;
-    }
-    case 5:
-    {
-      racer.shield = tracker::RaceTracker::Racer::Shield::Critical;
-      const auto afterEffectRemoved = [&racer]()
-      {
-        racer.shield = tracker::RaceTracker::Racer::Shield::None;
-      };
-      this->ScheduleSkillEffect(raceInstance, command.characterOid, racer.oid, magicSlotInfo, afterEffectRemoved);
-      break;
-    }
-    // Booster
-    case 6:
-    case 7:
-      this->ScheduleSkillEffect(raceInstance, command.characterOid, racer.oid, magicSlotInfo, std::nullopt);
-      break;
-    // Phoenix
-    case 8:
-    {
-      racer.hotRodded = true;
-      const auto afterEffectRemoved = [&racer]()
-      {
-        racer.hotRodded = false;
-      };
-      this->ScheduleSkillEffect(raceInstance, command.characterOid, racer.oid, magicSlotInfo, afterEffectRemoved);
-      break;
-    }
-    case 9:
+    raceInstance.effects.AddObstacles(
+      magicSlotInfo,
+      nextObstacleInstanceId,
+      obstacleInstanceCount,
+      now);
+  }
+
+  // Apply the effect to the racers targeted by the magic.
+  // TODO: Apply shackles only to opponents ahead of the racer
+  for (const auto& otherRacer : raceInstance.tracker.GetRacers() | std::views::values)
+  {
+    const bool isSelf = racer.oid == otherRacer.oid;
+    const bool isTeamMate = racer.team != tracker::RaceTracker::Racer::Team::Solo
+      && racer.team == otherRacer.team;
+
+    bool isTargeted = false;
+    switch (effectInfo.target)
     {
-      racer.hotRodded = true;
-      const auto afterEffectRemoved = [&racer]()
-      {
-        racer.hotRodded = false;
-      };
-      this->ScheduleSkillEffect(raceInstance, command.characterOid, racer.oid, magicSlotInfo, afterEffectRemoved);
-      break;
-    }
-    // IceWall
-    case 10:
-    case 11:
-    {
-      // TODO: How do we distinguish between different obstacles?
-      auto magicExpire = protocol::AcCmdRCMagicExpire{
-        .magicType = magicSlotInfo.type,
-        .firstObstacleInstanceId = nextObstacleInstanceId,
-        .obstacleInstanceCount = obstacleInstanceCount,
-        .breakdown = 0
-      };
-      _scheduler.Queue(
-        [this, magicExpire, &raceInstance]()
-        {
-          for (const ClientId& raceClientId : raceInstance.clients)
-          {
-            _commandServer.QueueCommand<decltype(magicExpire)>(
-              raceClientId,
-              [magicExpire]() { return magicExpire; });
-          }
-        },
-        Scheduler::Clock::now() + std::chrono::seconds(4)); // TODO: Change to 4 seconds
-      break;
+      case registry::Magic::EffectInfo::Target::Hit:
+        break;
+      case registry::Magic::EffectInfo::Target::Self:
+        isTargeted = isSelf;
+        break;
+      case registry::Magic::EffectInfo::Target::Allies:
+        isTargeted = isSelf || isTeamMate;
+        break;
+      case registry::Magic::EffectInfo::Target::Opponents:
+        isTargeted = not isSelf && not isTeamMate;
+        break;
     }
-    // Shackles
-    // TODO: Apply only to opponents ahead of the racer
-    case 12:
-    case 13:
-      for (auto& otherRacer : raceInstance.tracker.GetRacers() | std::views::values)
-      {
-        if (racer.oid != otherRacer.oid
-        && (racer.team == tracker::RaceTracker::Racer::Team::Solo || racer.team != otherRacer.team))
-        {
-          this->ScheduleSkillEffect(raceInstance, command.characterOid, otherRacer.oid, magicSlotInfo, std::nullopt);
-        }
-      }
-      break;
-    // BufPower
-    case 20:
-    case 21:
-      for (auto& otherRacer : raceInstance.tracker.GetRacers() | std::views::values)
-      {
-        if (racer.oid == otherRacer.oid
-        || (racer.team != tracker::RaceTracker::Racer::Team::Solo && racer.team == otherRacer.team))
-        {
-          otherRacer.critChance = true;
-          const auto afterEffectRemoved = [&otherRacer]()
-          {
-            otherRacer.critChance = false;
-          };
-          this->ScheduleSkillEffect(raceInstance, command.characterOid, otherRacer.oid, magicSlotInfo, afterEffectRemoved);
-        }
-      }
-      break;
-    // BufGauge
-    case 22:
-    case 23:
-      for (auto& otherRacer : raceInstance.tracker.GetRacers() | std::views::values)
-      {
-        if (racer.oid == otherRacer.oid
-        || (racer.team != tracker::RaceTracker::Racer::Team::Solo && racer.team == otherRacer.team))
-        {
-          otherRacer.gaugeBuff = true;
-          const auto afterEffectRemoved = [&otherRacer]()
-          {
-            otherRacer.gaugeBuff = false;
-          };
-          this->ScheduleSkillEffect(raceInstance, command.characterOid, otherRacer.oid, magicSlotInfo, afterEffectRemoved);
-        }
-      }
-      break;
-    // BufSpeed
-    case 24:
-    case 25:
-      for (auto& otherRacer : raceInstance.tracker.GetRacers() | std::views::values)
-      {
-        if (racer.oid == otherRacer.oid
-        || (racer.team != tracker::RaceTracker::Racer::Team::Solo && racer.team == otherRacer.team))
-        {
-          this->ScheduleSkillEffect(raceInstance, command.characterOid, otherRacer.oid, magicSlotInfo, std::nullopt);
-        }
-      }
-      break;
+
+    if (isTargeted)
+      ApplySkillEffect(raceInstance, command.characterOid, otherRacer.oid, magicSlotInfo);
   }
 
   racer.magicItem.reset();
@@ -2851,13 +2938,14 @@ void RaceDirector::HandleUserRaceItemGet(
   auto& racer = raceInstance.tracker.GetRacer(clientContext.characterUid);
 
   Room::GameMode gameMode;
-  registry::Course::GameModeInfo gameModeInfo;
-  _serverInstance.GetRoomSystem().GetRoom(clientContext.roomUid, [this, &gameMode, &gameModeInfo](const Room& room)
+  _serverInstance.GetRoomSystem().GetRoom(clientContext.roomUid, [&gameMode](const Room& room)
   {
     gameMode = room.GetRoomSnapshot().details.gameMode;
-    gameModeInfo = this->GetServerInstance().GetCourseRegistry().GetCourseGameModeInfo(static_cast<uint8_t>(gameMode));
   });
 
+  const auto courseRegistry = _serverInstance.GetCourseRegistry().Pin();
+  const auto& gameModeInfo = courseRegistry->GetCourseGameModeInfo(static_cast<uint8_t>(gameMode));
+
   switch(gameMode)
   {
     // TODO: Deduplicate from StarPointGet
@@ -2910,8 +2998,7 @@ void RaceDirector::HandleUserRaceItemGet(
 
         // Get the magic slot index to indicate to the racer that they
         // have the item (water shield, ice wall etc).
-        magicItem = _serverInstance.GetCourseRegistry()
-          .GetItemTypeInfo(magicItemType).magicSlot;
+        magicItem = courseRegistry->GetItemTypeInfo(magicItemType).magicSlot;
 
         // Response with OK to the client that they have a new item in hand
         protocol::AcCmdCRRequestMagicItemOK magicItemOk{
@@ -3064,10 +3151,11 @@ void RaceDirector::HandleActivateSkillEffect(
 
   auto& targetRacer = raceInstance.tracker.GetRacer(clientContext.characterUid);
 
-  auto magicSlotInfo = GetServerInstance().GetMagicRegistry().GetSlotInfoByEffectId(command.effectId);
+  const auto magicRegistry = GetServerInstance().GetMagicRegistry().Pin();
+  auto magicSlotInfo = magicRegistry->GetSlotInfoByEffectId(command.effectId);
   if (targetRacer.darkness && magicSlotInfo.criticalByDarkFire)
   {
-    magicSlotInfo = GetServerInstance().GetMagicRegistry().GetSlotInfo(magicSlotInfo.criticalType);
+    magicSlotInfo = magicRegistry->GetSlotInfo(magicSlotInfo.criticalType);
   }
 
   // Break down hit ice wall
@@ -3097,23 +3185,14 @@ void RaceDirector::HandleActivateSkillEffect(
     return;
   }
 
-  std::optional<std::function<void()>> afterEffectRemoved = std::nullopt;
-  switch (magicSlotInfo.type)
-  {
-      // Darkness
-      // As it is, this applies darkness to everyone. No idea why. It's the only effect that behaves like this.
-      case 14:
-      case 15:
-        targetRacer.darkness = true;
-        afterEffectRemoved = [&targetRacer]()
-        {
-          targetRacer.darkness = false;
-        };
-        break;
-  }
+  // Darkness is held by the racer who reported the effect, as that is the racer
+  // whose darkness makes the next fire critical above.
+  const tracker::Oid targetOid = magicSlotInfo.effect.state == tracker::EffectTracker::State::Darkness
+    ? targetRacer.oid
+    : command.targetOid;
 
   // TODO: Remove held item
-  this->ScheduleSkillEffect(raceInstance, command.attackerOid, command.targetOid, magicSlotInfo, afterEffectRemoved);
+  ApplySkillEffect(raceInstance, command.attackerOid, targetOid, magicSlotInfo);
 }
 
 void RaceDirector::HandleOpCmd(
@@ -3180,7 +3259,23 @@ void RaceDirector::HandleChangeSkillCardPresetId(
   // No response command
 }
 
-void RaceDirector::ScheduleSkillEffect(RaceDirector::RaceInstance& raceInstance, tracker::Oid attackerOid, tracker::Oid targetOid, const server::registry::Magic::SlotInfo& magicSlotInfo, std::optional<std::function<void()>> afterEffectRemoved){
+void RaceDirector::ApplySkillEffect(
+  RaceInstance& raceInstance,
+  tracker::Oid attackerOid,
+  tracker::Oid targetOid,
+  const registry::Magic::SlotInfo& magicSlotInfo)
+{
+  // The effect is removed by the race tick once it expires.
+  const bool isApplied = raceInstance.effects.Apply(
+    attackerOid,
+    targetOid,
+    magicSlotInfo,
+    std::chrono::steady_clock::now());
+  if (not isApplied)
+    return;
+
+  UpdateRacerEffectStates(raceInstance, targetOid);
+
   // Broadcast skill effect activation to all clients in the room
   // TODO: Verify if characterOid and targetOid should be the same once we have NPCs
   protocol::AcCmdRCAddSkillEffect addSkillEffect{
@@ -3194,7 +3289,7 @@ void RaceDirector::ScheduleSkillEffect(RaceDirector::RaceInstance& raceInstance,
       .unk0 = 0,
       .unk1 = 0,
     },
-    .boostEffectMs = static_cast<uint32_t>(magicSlotInfo.effectDelay * 1000.0f),
+    .boostEffectMs = static_cast<uint32_t>(magicSlotInfo.effect.duration.count()),
   };
 
   // Broadcast
@@ -3204,36 +3299,82 @@ void RaceDirector::ScheduleSkillEffect(RaceDirector::RaceInstance& raceInstance,
       raceClientId,
       [addSkillEffect]() { return addSkillEffect; });
   }
+}
 
-  // Remove the effect after a delay
-  // TODO: Handle overlapping effects of the same type
-  uint32_t effectId = magicSlotInfo.skillEffectId;
-  _scheduler.Queue(
-    [this, attackerOid, targetOid, effectId, &raceInstance, afterEffectRemoved]()
-    {
-      // Broadcast skill effect deactivation to all clients in the room
-      protocol::AcCmdRCRemoveSkillEffect removeSkillEffect{
-        .characterOid = targetOid,
-        .effectId = effectId,
-        .targetOid = targetOid,
-        .unk1 = 0,
-      };
+void RaceDirector::UpdateRacerEffectStates(
+  RaceInstance& raceInstance,
+  tracker::Oid racerOid)
+{
+  using State = tracker::EffectTracker::State;
 
-      std::scoped_lock lock(raceInstance.clientsMutex);
-      // Broadcast
-      for (const ClientId& raceClientId : raceInstance.clients)
-      {
-        _commandServer.QueueCommand<decltype(removeSkillEffect)>(
-          raceClientId,
-          [removeSkillEffect]() { return removeSkillEffect; });
-      }
+  for (auto& racer : raceInstance.tracker.GetRacers() | std::views::values)
+  {
+    if (racer.oid != racerOid)
+      continue;
 
-      if (afterEffectRemoved.has_value())
-      {
-        afterEffectRemoved.value()();
-      }
-    },
-    Scheduler::Clock::now() + std::chrono::milliseconds(static_cast<int64_t>(magicSlotInfo.effectDelay * 1000.0)));
+    // A state is held for as long as any effect on the racer holds it.
+    const auto& effects = raceInstance.effects;
+    racer.shield = effects.HasState(racerOid, State::CriticalShield)
+      ? tracker::RaceTracker::Racer::Shield::Critical
+      : effects.HasState(racerOid, State::Shield)
+        ? tracker::RaceTracker::Racer::Shield::Normal
+        : tracker::RaceTracker::Racer::Shield::None;
+    racer.hotRodded = effects.HasState(racerOid, State::HotRodding);
+    racer.critChance = effects.HasState(racerOid, State::CritChance);
+    racer.gaugeBuff = effects.HasState(racerOid, State::GaugeBuff);
+    racer.darkness = effects.HasState(racerOid, State::Darkness);
+    break;
+  }
+}
+
+void RaceDirector::TickMagicEffects(RaceInstance& raceInstance)
+{
+  raceInstance.effects.Expire(
+    std::chrono::steady_clock::now(),
+    _expiredEffects,
+    _expiredObstacles);
+
+  if (_expiredEffects.empty() && _expiredObstacles.empty())
+    return;
+
+  std::scoped_lock lock(raceInstance.clientsMutex);
+
+  for (const auto& effect : _expiredEffects)
+  {
+    UpdateRacerEffectStates(raceInstance, effect.targetOid);
+
+    // Broadcast skill effect deactivation to all clients in the room
+    protocol::AcCmdRCRemoveSkillEffect removeSkillEffect{
+      .characterOid = effect.targetOid,
+      .effectId = effect.skillEffectId,
+      .targetOid = effect.targetOid,
+      .unk1 = 0,
+    };
+
+    for (const ClientId& raceClientId : raceInstance.clients)
+    {
+      _commandServer.QueueCommand<decltype(removeSkillEffect)>(
+        raceClientId,
+        [removeSkillEffect]() { return removeSkillEffect; });
+    }
+  }
+
+  for (const auto& obstacles : _expiredObstacles)
+  {
+    // TODO: How do we distinguish between different obstacles?
+    const protocol::AcCmdRCMagicExpire magicExpire{
+      .magicType = obstacles.magicType,
+      .firstObstacleInstanceId = obstacles.firstObstacleInstanceId,
+      .obstacleInstanceCount = obstacles.obstacleInstanceCount,
+      .breakdown = 0};
+
+    for (const ClientId& raceClientId : raceInstance.clients)
+    {
+      _commandServer.QueueCommand<decltype(magicExpire)>(
+        raceClientId,
+        [magicExpire]() { return magicExpire; });
+    }
+  }
 }
 
 void RaceDirector::HandleInviteUser(
@@ -3327,7 +3468,9 @@ void RaceDirector::HandleKickUser(
     raceInstance.clients,
     [this, &command](const ClientId& raceClientId)
     {
-      return _clients[raceClientId].characterUid == command.characterUid;
+      const auto raceClientContext = _clients.Find(raceClientId);
+      return raceClientContext != nullptr
+        && raceClientContext->characterUid == command.characterUid;
     });
 
   if (!targetInRoom)
@@ -3626,7 +3769,8 @@ void RaceDirector::HandleTriggerizeAct(
   auto& raceInstance = GetRaceInstance(clientContext);
 
   const bool isSpeedGameMode = raceInstance.raceGameMode == protocol::GameMode::Speed;
-  const auto& mapBlockInfo = _serverInstance.GetCourseRegistry().GetMapBlockInfo(raceInstance.raceMapBlockId);
+  const auto courseRegistry = _serverInstance.GetCourseRegistry().Pin();
+  const auto& mapBlockInfo = courseRegistry->GetMapBlockInfo(raceInstance.raceMapBlockId);
   const bool isAdvMap = mapBlockInfo.trainingFee > 0;
 
   // The racer is neither in a speed mode or adv map
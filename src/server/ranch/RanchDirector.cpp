@@ -56,25 +56,25 @@ RanchDirector::RanchDirector(ServerInstance& serverInstance)
   _commandServer.RegisterCommandHandler<protocol::AcCmdCREnterRanch>(
     [this](ClientId clientId, const auto& message)
     {
-      HandleEnterRanch(clientId, message);
+      return HandleEnterRanch(clientId, message);
     });
 
   _commandServer.RegisterCommandHandler<protocol::AcCmdCRLeaveRanch>(
     [this](ClientId clientId, const auto&)
     {
-      HandleRanchLeave(clientId);
+      return HandleRanchLeave(clientId);
     });
 
   _commandServer.RegisterCommandHandler<protocol::AcCmdCRRanchChat>(
     [this](ClientId clientId, const auto& command)
     {
-      HandleChat(clientId, command);
+      return HandleChat(clientId, command);
     });
 
   _commandServer.RegisterCommandHandler<protocol::AcCmdCRRanchSnapshot>(
     [this](ClientId clientId, const auto& message)
     {
-      HandleSnapshot(clientId, message);
+      return HandleSnapshot(clientId, message);
     });
 
   _commandServer.RegisterCommandHandler<protocol::AcCmdCREnterBreedingMarket>(
@@ -458,6 +458,8 @@ void RanchDirector::Initialize()
     GetConfig().listen.address.to_string(),
     GetConfig().listen.port);
 
+  _serverInstance.BeginCapture(_commandServer, "ranch");
+  _commandServer.SetSocketOptions(GetConfig().socket);
   _commandServer.BeginHost(GetConfig().listen.address, GetConfig().listen.port);
 }
 
@@ -474,12 +476,12 @@ std::vector<data::Uid> RanchDirector::GetOnlineCharacters()
 {
   std::vector<data::Uid> onlineCharacterUids;
 
-  for (const auto& clientContext : _clients | std::views::values)
+  _clients.VisitEach([&onlineCharacterUids](ClientId, const ClientContext& clientContext)
   {
     if (not clientContext.isAuthenticated)
-      continue;
+      return;
     onlineCharacterUids.emplace_back(clientContext.characterUid);
-  }
+  });
 
   return onlineCharacterUids;
 }
@@ -490,7 +492,7 @@ void RanchDirector::HandleClientConnected(ClientId clientId)
     "Client {} connected to the ranch server from {}",
     clientId,
     _commandServer.GetClientAddress(clientId).to_string());
-  _clients.try_emplace(clientId);
+  _clients.Emplace(clientId);
 }
 
 void RanchDirector::HandleClientDisconnected(ClientId clientId)
@@ -503,36 +505,78 @@ void RanchDirector::HandleClientDisconnected(ClientId clientId)
     HandleRanchLeave(clientId);
   }
 
-  _clients.erase(clientId);
+  _clients.Erase(clientId);
 }
 
-void RanchDirector::Disconnect(data::Uid characterUid)
+void RanchDirector::HandleNetworkTick()
+{
+  if (_serverInstance.IsMemoryUsageReportDue("ranch"))
+    _serverInstance.PublishMemoryUsage("ranch", GetMemoryUsage());
+}
+
+util::MemoryUsageReport RanchDirector::GetMemoryUsage() const
 {
-  for (auto& clientContext : _clients)
+  util::MemoryUsage clients{
+    .count = _clients.Size(),
+    .bytes = _clients.EstimateContainerHeapSize()};
+  for (const auto& clientContext : _clients | std::views::values)
+    clients.bytes += util::EstimateHeapSize(clientContext.userName);
+
+  util::MemoryUsage ranches{
+    .count = _ranches.size(),
+    .bytes = util::EstimateContainerHeapSize(_ranches)};
+  util::MemoryUsage trackers{};
+  for (const auto& ranchInstance : _ranches | std::views::values)
   {
-    if (clientContext.second.characterUid == characterUid
-      && clientContext.second.isAuthenticated)
-    {
-      _commandServer.DisconnectClient(clientContext.first);
-      return;
-    }
+    trackers += ranchInstance.tracker.GetMemoryUsage();
+    ranches.bytes += util::EstimateContainerHeapSize(ranchInstance.clients);
   }
+
+  util::MemoryUsageReport report{
+    {"clients", clients},
+    {"ranches", ranches},
+    {"ranch_trackers", trackers}};
+  _commandServer.GetBufferMemoryUsage().AppendTo(report);
+  return report;
+}
+
+void RanchDirector::Disconnect(data::Uid characterUid)
+{
+  // Disconnecting from the network thread erases the client right away,
+  // so the client is disconnected only after the visit.
+  const auto clientId = FindClientIdByCharacterUid(characterUid);
+  if (clientId)
+    _commandServer.DisconnectClient(*clientId);
 }
 
 void RanchDirector::BroadcastSetIntroductionNotify(
   uint32_t characterUid,
   const std::string& introduction)
 {
-  const auto& clientContext = GetClientContextByCharacterUid(characterUid);
+  // Called from the lobby, the client is visited instead of referenced.
+  data::Uid visitingRancherUid{data::InvalidUid};
+  const bool isClientFound = not _clients.VisitEach(
+    [characterUid, &visitingRancherUid](ClientId, const ClientContext& clientContext)
+    {
+      if (clientContext.characterUid != characterUid
+        || not clientContext.isAuthenticated)
+        return true;
+
+      visitingRancherUid = clientContext.visitingRancherUid;
+      return false;
+    });
+
+  if (not isClientFound)
+    throw std::runtime_error("Character not associated with any client");
 
   protocol::RanchCommandSetIntroductionNotify notify{
     .characterUid = characterUid,
     .introduction = introduction};
 
-  for (const ClientId& ranchClientId : _ranches[clientContext.visitingRancherUid].clients)
+  for (const ClientId& ranchClientId : _ranches[visitingRancherUid].clients)
   {
     // Prevent broadcast to self.
-    if (ranchClientId == clientContext.characterUid)
+    if (ranchClientId == characterUid)
       continue;
 
     _commandServer.QueueCommand<decltype(notify)>(
@@ -560,10 +604,13 @@ void RanchDirector::BroadcastUpdateMountInfoNotify(
 
   for (const ClientId& ranchClientId : _ranches[rancherUid].clients)
   {
-    const auto& ranchClientContext = GetClientContext(ranchClientId);
-
     // Prevent broadcast to self.
-    if (ranchClientContext.characterUid == characterUid)
+    bool isSelf = false;
+    _clients.Visit(ranchClientId, [characterUid, &isSelf](const ClientContext& ranchClientContext)
+    {
+      isSelf = ranchClientContext.characterUid == characterUid;
+    });
+    if (isSelf)
       continue;
 
     _commandServer.QueueCommand<decltype(notify)>(
@@ -613,10 +660,13 @@ void RanchDirector::BroadcastChangeAgeNotify(
 
   for (const ClientId& ranchClientId : _ranches[rancherUid].clients)
   {
-    const auto& ranchClientContext = GetClientContext(ranchClientId);
-
     // Prevent broadcast to self.
-    if (ranchClientContext.characterUid == characterUid)
+    bool isSelf = false;
+    _clients.Visit(ranchClientId, [characterUid, &isSelf](const ClientContext& ranchClientContext)
+    {
+      isSelf = ranchClientContext.characterUid == characterUid;
+    });
+    if (isSelf)
       continue;
 
     _commandServer.QueueCommand<decltype(notify)>(
@@ -641,10 +691,13 @@ void RanchDirector::BroadcastHideAgeNotify(
 
   for (const ClientId& ranchClientId : _ranches[rancherUid].clients)
   {
-    const auto& ranchClientContext = GetClientContext(ranchClientId);
-
     // Prevent broadcast to self.
-    if (ranchClientContext.characterUid == characterUid)
+    bool isSelf = false;
+    _clients.Visit(ranchClientId, [characterUid, &isSelf](const ClientContext& ranchClientContext)
+    {
+      isSelf = ranchClientContext.characterUid == characterUid;
+    });
+    if (isSelf)
       continue;
 
     _commandServer.QueueCommand<decltype(notify)>(
@@ -676,23 +729,25 @@ void RanchDirector::BroadcastUpdateGuildMemberGradeNotify(
     for (const auto& guildMember : guild.members())
     {
       // Self broadcast is needed, OK response is not sufficient
-      for (auto& [clientId, clientContext] : _clients)
+      _clients.VisitEach([this, &notify, guildMember](
+        const ClientId clientId,
+        const ClientContext& clientContext)
       {
         // Skip offline clients
         if (not clientContext.isAuthenticated)
-          continue;
+          return;
 
         // Client is not a guild member
         if (clientContext.characterUid != guildMember)
-          continue;
-        
+          return;
+
         _commandServer.QueueCommand<decltype(notify)>(
           clientId,
           [notify]()
           {
             return notify;
           });
-      }
+      });
     }
   });
 }
@@ -712,16 +767,17 @@ void RanchDirector::SendGuildInviteDeclined(
     .unk4 = guildUid // is this true?
   };
 
-  for (const auto& client : _clients)
+  // Called from the lobby, the clients are visited.
+  _clients.VisitEach([this, &reply, inviterCharacterUid](
+    const ClientId clientId,
+    const ClientContext& clientContext)
   {
-    const auto& clientContext = client.second;
     // Notify online characters only
     if (not clientContext.isAuthenticated)
     {
-      continue;
+      return true;
     }
 
-    const auto& clientId = client.first;
     bool foundInviter = false;
     GetServerInstance().GetDataDirector().GetCharacter(clientContext.characterUid).Immutable(
       [&foundInviter, inviterCharacterUid](const data::Character& character){
@@ -740,9 +796,11 @@ void RanchDirector::SendGuildInviteDeclined(
         {
           return reply;
         });
-      break;
+      return false;
     }
-  }
+
+    return true;
+  });
 }
 
 void RanchDirector::SendGuildInviteAccepted(
@@ -755,17 +813,18 @@ void RanchDirector::SendGuildInviteAccepted(
     .newMemberCharacterName = newMemberCharacterName
   };
   
-  // Notify (online) guild members that a new member is in
-  for (const auto& client : _clients)
+  // Notify (online) guild members that a new member is in,
+  // called from the lobby, the clients are visited.
+  _clients.VisitEach([this, &notify, guildUid](
+    const ClientId clientId,
+    const ClientContext& clientContext)
   {
-    const auto& clientContext = client.second;
     // Notify online characters only
     if (not clientContext.isAuthenticated)
     {
-      continue;
+      return;
     }
-    
-    const auto& clientId = client.first;
+
     bool isCharacterInGuild = false;
     GetServerInstance().GetDataDirector().GetCharacter(clientContext.characterUid).Immutable(
       [guildUid, &isCharacterInGuild, &notify](const data::Character& character)
@@ -779,7 +838,7 @@ void RanchDirector::SendGuildInviteAccepted(
 
     if (not isCharacterInGuild)
     {
-      continue;
+      return;
     }
 
     _commandServer.QueueCommand<decltype(notify)>(
@@ -788,15 +847,19 @@ void RanchDirector::SendGuildInviteAccepted(
       {
         return notify;
       });
-  }
+  });
 }
 
 void RanchDirector::AddRanchHorse(
   data::Uid& rancherUid,
   data::Uid& horseUid)
 {
-  auto& ranchInstance = _ranches[rancherUid];
-  ranchInstance.tracker.AddHorse(horseUid);
+  // Called from the chat of any director, the ranches belong to the network thread.
+  _commandServer.Post([this, rancherUid, horseUid]()
+  {
+    auto& ranchInstance = _ranches[rancherUid];
+    ranchInstance.tracker.AddHorse(horseUid);
+  });
 }
 
 ServerInstance& RanchDirector::GetServerInstance()
@@ -809,60 +872,100 @@ Config::Ranch& RanchDirector::GetConfig()
   return GetServerInstance().GetSettings().ranch;
 }
 
+CommandServer& RanchDirector::GetCommandServer()
+{
+  return _commandServer;
+}
+
+std::optional<network::ClientStatistics> RanchDirector::GetClientStatistics(
+  const data::Uid characterUid)
+{
+  const auto clientId = FindClientIdByCharacterUid(characterUid);
+  if (not clientId)
+    return std::nullopt;
+
+  return _commandServer.GetClientStatistics(*clientId);
+}
+
 RanchDirector::ClientContext& RanchDirector::GetClientContext(
   const ClientId clientId,
   const bool requireAuthentication)
 {
-  const auto clientIter = _clients.find(clientId);
-  if (clientIter == _clients.cend())
-    throw std::runtime_error("Ranch client is not available");
-
-  auto& clientContext = clientIter->second;
-  if (requireAuthentication && not clientContext.isAuthenticated)
+  const auto clientContext = TryGetClientContext(clientId, requireAuthentication);
+  if (not clientContext)
+  {
+    if (clientContext.error() == network::HandlerError::UnknownClient)
+      throw std::runtime_error("Ranch client is not available");
     throw std::runtime_error("Ranch client is not authenticated");
+  }
+
+  return **clientContext;
+}
+
+std::expected<RanchDirector::ClientContext*, network::HandlerError> RanchDirector::TryGetClientContext(
+  const ClientId clientId,
+  const bool requireAuthentication)
+{
+  const auto clientContext = _clients.Find(clientId);
+  if (clientContext == nullptr)
+    return std::unexpected(network::HandlerError::UnknownClient);
+
+  if (requireAuthentication && not clientContext->isAuthenticated)
+    return std::unexpected(network::HandlerError::Unauthenticated);
 
   return clientContext;
 }
 
-ClientId RanchDirector::GetClientIdByCharacterUid(data::Uid characterUid)
+std::optional<ClientId> RanchDirector::FindClientIdByCharacterUid(
+  const data::Uid characterUid) const
 {
-  for (auto& [clientId, clientContext] : _clients)
+  std::optional<ClientId> foundClientId;
+  _clients.VisitEach([characterUid, &foundClientId](
+    const ClientId clientId,
+    const ClientContext& clientContext)
   {
-    if (clientContext.characterUid == characterUid
-      && clientContext.isAuthenticated)
-      return clientId;
-  }
+    if (clientContext.characterUid != characterUid
+      || not clientContext.isAuthenticated)
+      return true;
+
+    foundClientId.emplace(clientId);
+    return false;
+  });
 
-  throw std::runtime_error("Character not associated with any client");
+  return foundClientId;
 }
 
-RanchDirector::ClientContext& RanchDirector::GetClientContextByCharacterUid(
-  data::Uid characterUid)
+ClientId RanchDirector::GetClientIdByCharacterUid(data::Uid characterUid)
 {
-  for (auto& clientContext : _clients | std::views::values)
-  {
-    if (clientContext.characterUid == characterUid
-      && clientContext.isAuthenticated)
-      return clientContext;
-  }
+  const auto clientId = FindClientIdByCharacterUid(characterUid);
+  if (not clientId)
+    throw std::runtime_error("Character not associated with any client");
 
-  throw std::runtime_error("Character not associated with any client");
+  return *clientId;
 }
 
-void RanchDirector::HandleEnterRanch(
+network::HandlerResult RanchDirector::HandleEnterRanch(
   ClientId clientId,
   const protocol::AcCmdCREnterRanch& command)
 {
-  auto& clientContext = GetClientContext(clientId, false);
+  const auto clientContextResult = TryGetClientContext(clientId, false);
+  if (not clientContextResult)
+    return std::unexpected(clientContextResult.error());
+  auto& clientContext = **clientContextResult;
 
   const auto rancherRecord = GetServerInstance().GetDataDirector().GetCharacterCache().Get(
     command.rancherUid);
   if (not rancherRecord)
-    throw std::runtime_error(
-      std::format("Rancher's character '{}' not available", command.rancherUid));
+    return std::unexpected(network::HandlerError::RecordUnavailable);
 
-  clientContext.isAuthenticated = GetServerInstance().GetOtpSystem().AuthorizeCode(
+  // The other directors look the clients up by their character, the fields they read
+  // are modified exclusively.
+  const bool isAuthenticated = GetServerInstance().GetOtpSystem().AuthorizeCode(
     command.characterUid, command.otp);
+  _clients.Modify(clientId, [isAuthenticated](ClientContext& context)
+  {
+    context.isAuthenticated = isAuthenticated;
+  });
 
   // Determine whether the ranch is locked.
   bool isRanchLocked = false;
@@ -892,11 +995,14 @@ void RanchDirector::HandleEnterRanch(
         return response;
       });
 
-    return;
+    return {};
   }
 
-  clientContext.characterUid = command.characterUid;
-  clientContext.visitingRancherUid = command.rancherUid;
+  _clients.Modify(clientId, [&command](ClientContext& context)
+  {
+    context.characterUid = command.characterUid;
+    context.visitingRancherUid = command.rancherUid;
+  });
 
   clientContext.userName = _serverInstance.GetLobbyDirector().GetUserByCharacterUid(
     clientContext.characterUid).userName;
@@ -992,8 +1098,7 @@ void RanchDirector::HandleEnterRanch(
 
     auto horseRecord = GetServerInstance().GetDataDirector().GetHorseCache().Get(horseUid);
     if (not horseRecord)
-      throw std::runtime_error(
-        std::format("Ranch horse [{}] not available", horseUid));
+      return std::unexpected(network::HandlerError::RecordUnavailable);
 
     horseRecord->Immutable([&ranchHorse](const data::Horse& horse)
     {
@@ -1009,8 +1114,7 @@ void RanchDirector::HandleEnterRanch(
 
     auto characterRecord = GetServerInstance().GetDataDirector().GetCharacter(characterUid);
     if (not characterRecord)
-      throw std::runtime_error(
-        std::format("Ranch character [{}] not available", characterUid));
+      return std::unexpected(network::HandlerError::RecordUnavailable);
 
     characterRecord.Immutable([this, &protocolCharacter](const data::Character& character)
     {
@@ -1154,21 +1258,19 @@ void RanchDirector::HandleEnterRanch(
   }
 
   ranchInstance.clients.emplace(clientId);
+  return {};
 }
 
-void RanchDirector::HandleRanchLeave(ClientId clientId)
+network::HandlerResult RanchDirector::HandleRanchLeave(ClientId clientId)
 {
-  const auto& clientContext = GetClientContext(clientId);
+  const auto clientContextResult = TryGetClientContext(clientId);
+  if (not clientContextResult)
+    return std::unexpected(clientContextResult.error());
+  const auto& clientContext = **clientContextResult;
 
   const auto ranchIter = _ranches.find(clientContext.visitingRancherUid);
   if (ranchIter == _ranches.cend())
-  {
-    spdlog::warn(
-      "Client {} tried to leave a ranch of {} which is not instanced",
-      clientId,
-      clientContext.visitingRancherUid);
-    return;
-  }
+    return std::unexpected(network::HandlerError::InvalidState);
 
   auto& ranchInstance = ranchIter->second;
 
@@ -1198,19 +1300,26 @@ void RanchDirector::HandleRanchLeave(ClientId clientId)
         return notify;
       });
   }
+
+  return {};
 }
 
 
-void RanchDirector::HandleChat(
+network::HandlerResult RanchDirector::HandleChat(
   ClientId clientId,
   const protocol::AcCmdCRRanchChat& chat)
 {
-  const auto& clientContext = GetClientContext(clientId);
+  const auto clientContextResult = TryGetClientContext(clientId);
+  if (not clientContextResult)
+    return std::unexpected(clientContextResult.error());
+  const auto& clientContext = **clientContextResult;
 
   const auto characterRecord = GetServerInstance().GetDataDirector().GetCharacter(
     clientContext.characterUid);
   const auto rancherRecord = GetServerInstance().GetDataDirector().GetCharacter(
     clientContext.visitingRancherUid);
+  if (not characterRecord || not rancherRecord)
+    return std::unexpected(network::HandlerError::RecordUnavailable);
 
   const auto& ranchInstance = _ranches[clientContext.visitingRancherUid];
 
@@ -1263,7 +1372,7 @@ void RanchDirector::HandleChat(
   if (verdict.commandVerdict)
   {
     sendAllMessages(clientId, characterName, true, verdict.commandVerdict->result);
-    return;
+    return {};
   }
 
   // Message is not a command, check if user has been muted
@@ -1276,21 +1385,30 @@ void RanchDirector::HandleChat(
       .message = verdict.message,
       .isSystem = true};
     _commandServer.QueueCommand<decltype(notify)>(clientId, [notify](){ return notify; });
-    return;
+    return {};
   }
 
   for (const auto& ranchClientId : ranchInstance.clients)
   {
     sendAllMessages(ranchClientId, characterName, false, {verdict.message});
   }
+
+  return {};
 }
 
-void RanchDirector::HandleSnapshot(
+network::HandlerResult RanchDirector::HandleSnapshot(
   ClientId clientId,
   const protocol::AcCmdCRRanchSnapshot& command)
 {
-  const auto& clientContext = GetClientContext(clientId);
-  const auto& ranchInstance = _ranches[clientContext.visitingRancherUid];
+  const auto clientContextResult = TryGetClientContext(clientId);
+  if (not clientContextResult)
+    return std::unexpected(clientContextResult.error());
+  const auto& clientContext = **clientContextResult;
+
+  const auto ranchIter = _ranches.find(clientContext.visitingRancherUid);
+  if (ranchIter == _ranches.cend())
+    return std::unexpected(network::HandlerError::InvalidState);
+  const auto& ranchInstance = ranchIter->second;
 
   protocol::RanchCommandRanchSnapshotNotify notify{
     .ranchIndex = ranchInstance.tracker.GetCharacterOid(
@@ -1303,14 +1421,14 @@ void RanchDirector::HandleSnapshot(
     case protocol::AcCmdCRRanchSnapshot::Full:
     {
       if (command.full.ranchIndex != notify.ranchIndex)
-        throw std::runtime_error("Client sent a snapshot for an entity it's not controlling");
+        return std::unexpected(network::HandlerError::InvalidCommand);
       notify.full = command.full;
       break;
     }
     case protocol::AcCmdCRRanchSnapshot::Partial:
     {
       if (command.full.ranchIndex != notify.ranchIndex)
-        throw std::runtime_error("Client sent a snapshot for an entity it's not controlling");
+        return std::unexpected(network::HandlerError::InvalidCommand);
       notify.partial = command.partial;
       break;
     }
@@ -4616,7 +4734,8 @@ void RanchDirector::HandleConfirmItem(
     });
 
   // Get current shop list
-  const auto& shopList = GetServerInstance().GetLobbyDirector().GetShopManager().GetShopList();
+  const auto shop = GetServerInstance().GetLobbyDirector().GetShopManager().Pin();
+  const auto& shopList = shop->shopList;
 
   // Get recipient character uid, if it even exists
   // TODO: this checks against the data source if character by that name exists but does not load character
@@ -4686,7 +4805,8 @@ void RanchDirector::HandleConfirmSetItem(
   const auto& clientContext = GetClientContext(clientId);
 
   // Get current shop list
-  const auto& shopList = GetServerInstance().GetLobbyDirector().GetShopManager().GetShopList();
+  const auto shop = GetServerInstance().GetLobbyDirector().GetShopManager().Pin();
+  const auto& shopList = shop->shopList;
 
   // Check if current shop list contains the goods
   if (not shopList.goodsList.contains(command.goodsSq))
@@ -4757,7 +4877,8 @@ void RanchDirector::HandleBuyOwnItem(
   protocol::AcCmdCRBuyOwnItemOK response{};
 
   // Get current shop list
-  const auto& shopList = GetServerInstance().GetLobbyDirector().GetShopManager().GetShopList();
+  const auto shop = GetServerInstance().GetLobbyDirector().GetShopManager().Pin();
+  const auto& shopList = shop->shopList;
 
   std::vector<data::Uid> newEquipmentUids{};
   GetServerInstance().GetDataDirector().GetCharacter(clientContext.characterUid).Mutable(
@@ -4824,6 +4945,14 @@ void RanchDirector::HandleBuyOwnItem(
         // `itemUid` in the goods entry is actually the item TID
         const auto& itemRegistryRecord = GetServerInstance().GetItemRegistry().GetItem(goods.itemUid);
 
+        // The goods sequence number must still name the same item the registry knows,
+        // otherwise the client is buying from a shop list that was reloaded since
+        if (goods.itemUid != order.goodsSq or not itemRegistryRecord.has_value())
+        {
+          orderResult.result = OrderResult::Result::NotAvailable;
+          continue;
+        }
+
         const bool isCashItem = goods.moneyType == ShopList::Goods::MoneyType::Cash;
         const int32_t cost = costOpt.value();
 
@@ -4946,7 +5075,8 @@ void RanchDirector::HandleSendGift(
     });
 
   // Get current shop list
-  const auto& shopList = GetServerInstance().GetLobbyDirector().GetShopManager().GetShopList();
+  const auto shop = GetServerInstance().GetLobbyDirector().GetShopManager().Pin();
+  const auto& shopList = shop->shopList;
 
   // Get recipient character uid, if it even exists
   // TODO: this checks against the data source if character by that name exists but does not load character
@@ -4995,9 +5125,9 @@ void RanchDirector::HandleSendGift(
 
   // Get item information
   const auto& itemRegistryRecord = GetServerInstance().GetItemRegistry().GetItem(goods.itemUid);
-  if (not itemRegistryRecord.has_value())
+  if (goods.itemUid != command.order.goodsSq or not itemRegistryRecord.has_value())
   {
-    // Item does not exist in registry
+    // Item does not exist in registry or the goods names another item
     spdlog::warn("Character '{}' tried to gift shop item (goods sq '{}') with invalid item tid '{}'.",
       clientContext.characterUid,
       command.order.goodsSq,
@@ -5315,28 +5445,27 @@ void RanchDirector::HandleOpenRandomBox(
   else
   {
     data::Uid uid = data::InvalidUid;
-    const auto packageKeysView = std::views::keys(_serverInstance.GetItemRegistry().GetPackages());
-    std::vector<data::Tid> possiblePackages;
-    std::ranges::copy(packageKeysView, std::back_inserter(possiblePackages));
+    // Pin the item registry so that the package pool and the package template
+    // are read from the same snapshot.
+    const auto itemRegistry = _serverInstance.GetItemRegistry().Pin();
+    const auto possiblePackages = itemRegistry->packages.GetValues();
 
     std::uniform_int_distribution<uint32_t> randomPackageDistribution(
       0,
       static_cast<uint32_t>(possiblePackages.size()) - 1);
     const auto randomPackageIdx = randomPackageDistribution(rd);
 
-    const data::Tid PackageTid = possiblePackages[randomPackageIdx];
-
-    const auto packageTemplate = _serverInstance.GetItemRegistry().GetPackage(PackageTid);
+    const auto& packageTemplate = possiblePackages[randomPackageIdx];
 
     response = {
-      .packageId = packageTemplate->packageId,
+      .packageId = packageTemplate.packageId,
     };
 
     //add package to inventory
     characterRecord.Mutable(
-      [this, packageTemplate, &uid](data::Character& character)
+      [this, &packageTemplate, &uid](data::Character& character)
       {
-        uid = _serverInstance.GetItemSystem().AddItem(character,packageTemplate->tid, packageTemplate->count);
+        uid = _serverInstance.GetItemSystem().AddItem(character,packageTemplate.tid, packageTemplate.count);
       });
   }
   // TODO: figure out how to make the open box window appear after opening
@@ -20,10 +20,13 @@
 #include "server/system/ChatSystem.hpp"
 
 #include "server/ServerInstance.hpp"
+#include "server/lobby/LobbyNetworkHandler.hpp"
 #include "Version.hpp"
 
+#include <libserver/util/Trace.hpp>
 #include <libserver/util/Util.hpp>
 
+#include <ranges>
 #include <regex>
 #include <format>
 
@@ -1964,6 +1967,273 @@ void ChatSystem::RegisterAdminCommands()
         std::format("Nobody with the name '{}' is online.", visitingCharacterName),
         "Use //online to view online players."};
     });
+
+  // trace command
+  _commandManager.RegisterCommand(
+    "trace",
+    [this](
+      const std::span<const std::string>& arguments,
+      data::Uid characterUid) -> std::vector<std::string>
+    {
+      const auto invokerRecord = _serverInstance.GetDataDirector().GetCharacter(characterUid);
+      if (not invokerRecord)
+        return {"Server error"};
+
+      bool isAdmin = false;
+      invokerRecord.Immutable([&isAdmin](const data::Character& character)
+      {
+        isAdmin = character.role() != data::Character::Role::User;
+      });
+
+      if (not isAdmin)
+        return {};
+
+      if (arguments.empty())
+        return {"Invalid command argument. (//trace <start/stop/dump>)"};
+
+      const auto& action = arguments[0];
+      if (action == "start")
+      {
+        // Begin a fresh trace.
+        util::trace::Clear();
+        util::trace::SetEnabled(true);
+        return {"Tracing started"};
+      }
+
+      if (action == "stop" || action == "dump")
+      {
+        if (action == "stop")
+          util::trace::SetEnabled(false);
+
+        try
+        {
+          const auto path = _serverInstance.DumpTrace();
+          return {std::format("Trace written to '{}'", path.string())};
+        }
+        catch (const std::exception& x)
+        {
+          spdlog::error("Couldn't dump the trace: {}", x.what());
+          return {"Couldn't write the trace, see the server log."};
+        }
+      }
+
+      return {"Invalid command argument. (//trace <start/stop/dump>)"};
+    });
+
+  // network command
+  const auto networkHandler = [this](
+      const std::span<const std::string>& arguments,
+      data::Uid characterUid) -> std::vector<std::string>
+    {
+      const auto invokerRecord = _serverInstance.GetDataDirector().GetCharacter(characterUid);
+      if (not invokerRecord)
+        return {"Server error"};
+
+      bool isAdmin = false;
+      invokerRecord.Immutable([&isAdmin](const data::Character& character)
+      {
+        isAdmin = character.role() != data::Character::Role::User;
+      });
+
+      if (not isAdmin)
+        return {};
+
+      const auto toMilliseconds = [](const auto duration)
+      {
+        return std::chrono::duration<double, std::milli>(duration).count();
+      };
+
+      const auto appendStatistics = [&toMilliseconds](
+        std::vector<std::string>& response,
+        const std::string_view listenerName,
+        const network::ClientStatistics& statistics)
+      {
+        response.emplace_back(std::format(
+          " {}: in {} ({} frames, {} reads), out {} ({} frames, {} writes)",
+          listenerName,
+          util::FormatBytes(statistics.inboundBytes),
+          statistics.inboundFrames,
+          statistics.inboundReads,
+          util::FormatBytes(statistics.outboundBytes),
+          statistics.outboundFrames,
+          statistics.outboundWrites));
+        response.emplace_back(std::format(
+          "  queue {} (max {}), pending {}, blocked {:.1f}ms, rtt {:.1f}ms",
+          statistics.writeQueueDepth,
+          statistics.maxWriteQueueDepth,
+          util::FormatBytes(statistics.pendingSendBytes),
+          toMilliseconds(statistics.sendBlockedTime),
+          toMilliseconds(statistics.roundTripTime)));
+      };
+
+      // Aggregates of the listeners.
+      if (arguments.empty())
+      {
+        const std::array<std::pair<std::string_view, network::ListenerStatistics>, 6> listeners{{
+          {"lobby", _serverInstance.GetLobbyDirector().GetNetworkHandler().GetCommandServer().GetStatistics()},
+          {"ranch", _serverInstance.GetRanchDirector().GetCommandServer().GetStatistics()},
+          {"race", _serverInstance.GetRaceDirector().GetCommandServer().GetStatistics()},
+          {"messenger", _serverInstance.GetMessengerDirector().GetChatterServer().GetStatistics()},
+          {"all_chat", _serverInstance.GetAllChatDirector().GetChatterServer().GetStatistics()},
+          {"private_chat", _serverInstance.GetPrivateChatDirector().GetChatterServer().GetStatistics()}}};
+
+        std::vector<std::string> response;
+        response.emplace_back("Network statistics (//network <character name>):");
+        for (const auto& [listenerName, statistics] : listeners)
+        {
+          appendStatistics(response, listenerName, statistics.total);
+          response.emplace_back(std::format(
+            "  {} clients, average rtt {:.1f}ms",
+            statistics.clientCount,
+            toMilliseconds(statistics.averageRoundTripTime)));
+        }
+        return response;
+      }
+
+      // Statistics of the connections of a character.
+      const auto& name = arguments[0];
+      auto targetCharacterUid = data::InvalidUid;
+      for (const auto& userInstance : _serverInstance.GetLobbyDirector().GetUsers() | std::views::values)
+      {
+        const auto characterRecord = _serverInstance.GetDataDirector().GetCharacter(
+          userInstance.characterUid);
+        if (not characterRecord)
+          continue;
+
+        characterRecord.Immutable([&targetCharacterUid, &name](const data::Character& character)
+        {
+          if (character.name() == name)
+            targetCharacterUid = character.uid();
+        });
+
+        if (targetCharacterUid != data::InvalidUid)
+          break;
+      }
+
+      if (targetCharacterUid == data::InvalidUid)
+        return {std::format("Character '{}' is not online", name)};
+
+      std::vector<std::string> response;
+      response.emplace_back(std::format("Network statistics of '{}':", name));
+
+      const auto appendClientStatistics = [&response, &appendStatistics](
+        const std::string_view listenerName,
+        const std::optional<network::ClientStatistics>& statistics)
+      {
+        if (statistics)
+          appendStatistics(response, listenerName, *statistics);
+      };
+
+      appendClientStatistics(
+        "lobby",
+        _serverInstance.GetLobbyDirector().GetNetworkHandler().GetClientStatistics(targetCharacterUid));
+      appendClientStatistics(
+        "ranch",
+        _serverInstance.GetRanchDirector().GetClientStatistics(targetCharacterUid));
+      appendClientStatistics(
+        "race",
+        _serverInstance.GetRaceDirector().GetClientStatistics(targetCharacterUid));
+
+      auto& messengerDirector = _serverInstance.GetMessengerDirector();
+      if (const auto messengerClient = messengerDirector.GetClientByCharacterUid(targetCharacterUid))
+      {
+        appendClientStatistics(
+          "messenger",
+          messengerDirector.GetChatterServer().GetClientStatistics(messengerClient->clientId));
+      }
+
+      if (response.size() == 1)
+        response.emplace_back(" No connection statistics yet.");
+      return response;
+    };
+
+  _commandManager.RegisterCommand("network", networkHandler);
+  _commandManager.RegisterCommand("netstat", networkHandler);
+
+  // memory command
+  _commandManager.RegisterCommand(
+    "memory",
+    [this](
+      const std::span<const std::string>& arguments,
+      data::Uid characterUid) -> std::vector<std::string>
+    {
+      const auto invokerRecord = _serverInstance.GetDataDirector().GetCharacter(characterUid);
+      if (not invokerRecord)
+        return {"Server error"};
+
+      bool isAdmin = false;
+      invokerRecord.Immutable([&isAdmin](const data::Character& character)
+      {
+        isAdmin = character.role() != data::Character::Role::User;
+      });
+
+      if (not isAdmin)
+        return {};
+
+      if (not arguments.empty() && arguments[0] == "refresh")
+      {
+        _serverInstance.RequestMemoryUsageReports();
+        return {"Memory usage reports requested, they arrive with the next ticks."};
+      }
+
+      const auto reports = _serverInstance.GetMemoryAccounting().GetReports();
+      const auto now = util::MemoryAccounting::Clock::now();
+      const auto formatAge = [now](const util::MemoryAccounting::ComponentReport& componentReport)
+      {
+        return std::chrono::duration_cast<std::chrono::seconds>(
+          now - componentReport.publishedAt).count();
+      };
+
+      // Totals of the components.
+      if (arguments.empty())
+      {
+        std::vector<std::string> response;
+        response.emplace_back("Memory usage (//memory <component/refresh>):");
+
+        util::MemoryUsage total{};
+        for (const auto& [componentName, componentReport] : reports)
+        {
+          const auto componentTotal = util::GetTotal(componentReport.report);
+          total += componentTotal;
+
+          response.emplace_back(std::format(
+            " {}: {} ({} objects, {}s ago)",
+            componentName,
+            util::FormatBytes(componentTotal.bytes),
+            componentTotal.count,
+            formatAge(componentReport)));
+        }
+
+        response.emplace_back(std::format(
+          "Total: {} ({} objects)",
+          util::FormatBytes(total.bytes),
+          total.count));
+        return response;
+      }
+
+      // Subsystems of a component.
+      const auto& componentName = arguments[0];
+      const auto componentIter = reports.find(componentName);
+      if (componentIter == reports.cend())
+        return {std::format("No memory usage report of '{}'", componentName)};
+
+      const auto& componentReport = componentIter->second;
+      std::vector<std::string> response;
+      response.emplace_back(std::format(
+        "Memory usage of '{}' ({}s ago):",
+        componentName,
+        formatAge(componentReport)));
+
+      for (const auto& [subsystemName, usage] : componentReport.report)
+      {
+        response.emplace_back(std::format(
+          " {}: {} ({} objects)",
+          subsystemName,
+          util::FormatBytes(usage.bytes),
+          usage.count));
+      }
+      return response;
+    });
 }
 
 } // namespace server
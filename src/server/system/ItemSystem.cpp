@@ -29,6 +29,34 @@
 namespace server
 {
 
+namespace
+{
+
+//! Returns the UID of the first available item of a template.
+//! The available items are searched even if some of the items are still being retrieved.
+//! @param itemCache Item storage.
+//! @param itemUids UIDs of the items to search.
+//! @param itemTid TID of the item.
+//! @returns UID of the item or `data::InvalidUid` if no available item is of the template.
+data::Uid FindItem(
+  DataDirector::ItemStorage& itemCache,
+  const std::vector<data::Uid>& itemUids,
+  const data::Tid itemTid)
+{
+  auto foundItemUid = data::InvalidUid;
+  itemCache.View(
+    itemUids,
+    [&foundItemUid, itemTid](const data::Uid&, const data::Item& item)
+    {
+      if (foundItemUid == data::InvalidUid && item.tid() == itemTid)
+        foundItemUid = item.uid();
+    });
+
+  return foundItemUid;
+}
+
+} // anon namespace
+
 ItemSystem::ItemSystem(ServerInstance& serverInstance)
   : _serverInstance(serverInstance)
 {
@@ -38,35 +66,13 @@ data::Uid ItemSystem::GetItem(
   data::Character& character,
   data::Tid itemTid) const noexcept
 {
-  const auto searchItems = [this, &itemTid](const std::vector<data::Uid>& itemUids) -> data::Uid
-  {
-    const auto itemRecords = _serverInstance.GetDataDirector().GetItemCache().Get(itemUids);
-    if (not itemRecords)
-      return data::InvalidUid;
-
-    for (const auto& itemRecord : *itemRecords)
-    {
-      auto foundItemUid = data::InvalidUid;
-      itemRecord.Immutable([&foundItemUid, &itemTid](const data::Item& item)
-      {
-        if (item.tid() != itemTid)
-          return;
-
-        foundItemUid = item.uid();
-      });
+  auto& itemCache = _serverInstance.GetDataDirector().GetItemCache();
 
-      if (foundItemUid != data::InvalidUid)
-        return foundItemUid;
-    }
-
-    return data::InvalidUid;
-  };
-
-  auto foundUid = searchItems(character.inventory());
+  const auto foundUid = FindItem(itemCache, character.inventory(), itemTid);
   if (foundUid != data::InvalidUid)
     return foundUid;
 
-  return searchItems(character.characterEquipment());
+  return FindItem(itemCache, character.characterEquipment(), itemTid);
 }
 
 data::Uid ItemSystem::AddItem(
@@ -171,26 +177,10 @@ void ItemSystem::RemoveItem(
   data::Character& character,
   const data::Tid itemTid) const noexcept
 {
-  const auto itemRecords = _serverInstance.GetDataDirector().GetItemCache().Get(
-    character.inventory());
-  if (not itemRecords)
-    return;
-
-  auto itemUid{data::InvalidUid};
-  for (const auto& itemRecord : *itemRecords)
-  {
-    itemRecord.Mutable([&itemUid, &itemTid](
-      data::Item& item)
-    {
-      if (item.tid() != itemTid)
-        return;
-
-      itemUid = item.uid();
-    });
-
-    if (itemUid != data::InvalidUid)
-      break;
-  }
+  const auto itemUid = FindItem(
+    _serverInstance.GetDataDirector().GetItemCache(),
+    character.inventory(),
+    itemTid);
 
   if (itemUid != data::InvalidUid)
   {
@@ -206,78 +196,53 @@ ItemSystem::ConsumeVerdict ItemSystem::ConsumeItem(
   const data::Tid itemTid,
   const uint32_t count) const noexcept
 {
-  const auto itemRecords = _serverInstance.GetDataDirector().GetItemCache().Get(
-    character.inventory());
-  if (not itemRecords)
-    return {};
+  auto& itemCache = _serverInstance.GetDataDirector().GetItemCache();
 
-  for (const auto& itemRecord : *itemRecords)
-  {
-    ConsumeVerdict verdict{};
-
-    itemRecord.Mutable([&verdict, &itemTid, &count](
-      data::Item& item)
-    {
-      if (item.tid() != itemTid)
-        return;
+  // Only the record of the consumed item is patched.
+  const auto itemUid = FindItem(itemCache, character.inventory(), itemTid);
+  if (itemUid == data::InvalidUid)
+    return {};
 
-      verdict.itemUid = item.uid();
+  const auto itemRecord = itemCache.Get(itemUid);
+  if (not itemRecord)
+    return {};
 
-      if (static_cast<int64_t>(item.count()) - count >= 0)
-      {
-        item.count() = item.count() - count;
-        verdict.itemConsumed = true;
-        verdict.remainingItemCount = item.count();
-      }
-    });
+  ConsumeVerdict verdict{
+    .itemUid = itemUid};
 
-    if (verdict.itemUid != data::InvalidUid)
+  itemRecord->Mutable([&verdict, &count](
+    data::Item& item)
+  {
+    if (static_cast<int64_t>(item.count()) - count >= 0)
     {
-      if (verdict.remainingItemCount == 0)
-      {
-        _serverInstance.GetDataDirector().GetItemCache().Delete(verdict.itemUid);
-        const auto itemRange = std::ranges::remove(character.inventory(), verdict.itemUid);
-        character.inventory().erase(itemRange.begin(), itemRange.end());
+      item.count() = item.count() - count;
+      verdict.itemConsumed = true;
+      verdict.remainingItemCount = item.count();
+    }
+  });
 
-        verdict.itemUid = data::InvalidUid;
-      }
+  if (verdict.remainingItemCount == 0)
+  {
+    itemCache.Delete(verdict.itemUid);
+    const auto itemRange = std::ranges::remove(character.inventory(), verdict.itemUid);
+    character.inventory().erase(itemRange.begin(), itemRange.end());
 
-      return verdict;
-    }
+    verdict.itemUid = data::InvalidUid;
   }
 
-  return {};
+  return verdict;
 }
 
 bool ItemSystem::HasItem(
   const data::Character& character,
   const data::Tid itemTid) const noexcept
 {
-  const auto HasItemWithTid = [this, &itemTid](const std::vector<data::Uid>& itemUids)
-  {
-    const auto itemRecords = _serverInstance.GetDataDirector().GetItemCache().Get(itemUids);
-    if (not itemRecords)
-      return false;
-
-    for (const auto& itemRecord : *itemRecords)
-    {
-      bool isMatch = false;
-      itemRecord.Immutable([&isMatch, &itemTid](const data::Item& item)
-      {
-        isMatch = item.tid() == itemTid;
-      });
-
-      if (isMatch)
-        return true;
-    }
-
-    return false;
-  };
+  auto& itemCache = _serverInstance.GetDataDirector().GetItemCache();
 
-  if (HasItemWithTid(character.inventory()))
+  if (FindItem(itemCache, character.inventory(), itemTid) != data::InvalidUid)
     return true;
 
-  if (HasItemWithTid(character.characterEquipment()))
+  if (FindItem(itemCache, character.characterEquipment(), itemTid) != data::InvalidUid)
     return true;
 
   return false;
@@ -175,6 +175,14 @@ std::unordered_map<data::Uid, Room::Player>& Room::GetPlayers()
   return _players;
 }
 
+std::size_t Room::EstimateHeapSize() const
+{
+  return util::EstimateHeapSize(_details.name)
+    + util::EstimateHeapSize(_details.password)
+    + util::EstimateHeapSize(_queuedPlayers)
+    + util::EstimateHeapSize(_players);
+}
+
 void RoomSystem::CreateRoom(const std::function<void(Room&)>& consumer)
 {
   std::unique_lock roomsLock(_roomsLock);
@@ -225,6 +233,22 @@ std::vector<Room::Snapshot> RoomSystem::GetRoomsSnapshot()
   return rooms;
 }
 
+util::MemoryUsage RoomSystem::GetMemoryUsage()
+{
+  std::scoped_lock roomsLock(_roomsLock);
+
+  util::MemoryUsage usage{
+    .count = _rooms.size(),
+    .bytes = util::EstimateContainerHeapSize(_rooms)};
+  for (auto& entry : _rooms | std::views::values)
+  {
+    std::scoped_lock roomLock(entry.mutex);
+    usage.bytes += entry.room.EstimateHeapSize();
+  }
+
+  return usage;
+}
+
 void RoomSystem::DeleteRoom(uint32_t uid)
 {
   std::scoped_lock lock(_roomsLock);
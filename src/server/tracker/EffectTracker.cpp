@@ -0,0 +1,135 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "server/tracker/EffectTracker.hpp"
+
+#include <algorithm>
+
+namespace server::tracker
+{
+
+bool EffectTracker::Apply(
+  Oid attackerOid,
+  Oid targetOid,
+  const registry::Magic::SlotInfo& slotInfo,
+  Clock::time_point now)
+{
+  const auto& effectInfo = slotInfo.effect;
+  const auto expiryTimePoint = now + effectInfo.duration;
+
+  // Overlapping effects of the same type on the same racer are tracked as one effect,
+  // so that the first one to expire does not remove the effect of the later ones.
+  const auto effectIter = std::ranges::find_if(
+    _effects,
+    [targetOid, &slotInfo](const Effect& effect)
+    {
+      return effect.targetOid == targetOid
+        && effect.skillEffectId == slotInfo.skillEffectId;
+    });
+
+  if (effectIter != _effects.cend())
+  {
+    switch (effectInfo.stacking)
+    {
+      case registry::Magic::EffectInfo::Stacking::Ignore:
+        return false;
+      case registry::Magic::EffectInfo::Stacking::Refresh:
+        effectIter->attackerOid = attackerOid;
+        effectIter->magicType = slotInfo.type;
+        effectIter->state = effectInfo.state;
+        effectIter->expiryTimePoint = expiryTimePoint;
+        return true;
+    }
+  }
+
+  _effects.emplace_back(Effect{
+    .attackerOid = attackerOid,
+    .targetOid = targetOid,
+    .magicType = slotInfo.type,
+    .skillEffectId = slotInfo.skillEffectId,
+    .state = effectInfo.state,
+    .expiryTimePoint = expiryTimePoint});
+  return true;
+}
+
+void EffectTracker::AddObstacles(
+  const registry::Magic::SlotInfo& slotInfo,
+  uint16_t firstObstacleInstanceId,
+  uint16_t obstacleInstanceCount,
+  Clock::time_point now)
+{
+  _obstacles.emplace_back(Obstacles{
+    .magicType = slotInfo.type,
+    .firstObstacleInstanceId = firstObstacleInstanceId,
+    .obstacleInstanceCount = obstacleInstanceCount,
+    .expiryTimePoint = now + slotInfo.effect.obstacleLifetime});
+}
+
+void EffectTracker::Expire(
+  Clock::time_point now,
+  std::vector<Effect>& expiredEffects,
+  std::vector<Obstacles>& expiredObstacles)
+{
+  expiredEffects.clear();
+  expiredObstacles.clear();
+
+  std::erase_if(_effects, [now, &expiredEffects](const Effect& effect)
+  {
+    if (now < effect.expiryTimePoint)
+      return false;
+    expiredEffects.emplace_back(effect);
+    return true;
+  });
+
+  std::erase_if(_obstacles, [now, &expiredObstacles](const Obstacles& obstacles)
+  {
+    if (now < obstacles.expiryTimePoint)
+      return false;
+    expiredObstacles.emplace_back(obstacles);
+    return true;
+  });
+}
+
+bool EffectTracker::HasState(Oid targetOid, State state) const
+{
+  return std::ranges::any_of(_effects, [targetOid, state](const Effect& effect)
+  {
+    return effect.targetOid == targetOid && effect.state == state;
+  });
+}
+
+bool EffectTracker::IsEmpty() const
+{
+  return _effects.empty() && _obstacles.empty();
+}
+
+void EffectTracker::Clear()
+{
+  _effects.clear();
+  _obstacles.clear();
+}
+
+util::MemoryUsage EffectTracker::GetMemoryUsage() const
+{
+  return util::MemoryUsage{
+    .count = _effects.size() + _obstacles.size(),
+    .bytes = util::EstimateHeapSize(_effects) + util::EstimateHeapSize(_obstacles)};
+}
+
+} // namespace server::tracker
@@ -19,6 +19,8 @@
 
 #include "server/tracker/RaceTracker.hpp"
 
+#include <ranges>
+
 namespace server::tracker
 {
 
@@ -92,6 +94,18 @@ void RaceTracker::Clear()
   _nextObjectOid = 1;
 }
 
+util::MemoryUsage RaceTracker::GetMemoryUsage() const
+{
+  util::MemoryUsage usage{
+    .count = _racers.size() + _items.size(),
+    .bytes = util::EstimateContainerHeapSize(_racers) + util::EstimateContainerHeapSize(_items)};
+
+  for (const auto& racer : _racers | std::views::values)
+    usage.bytes += util::EstimateHeapSize(racer.trackedItems);
+
+  return usage;
+}
+
 uint16_t RaceTracker::GetNextObstacleInstanceIdAndIncrementBy(uint16_t increment)
 {
   const uint16_t nextId = _nextObstacleInstanceId;
@@ -87,4 +87,11 @@ const RanchTracker::ObjectMap& RanchTracker::GetHorses() const
   return _horses;
 }
 
+util::MemoryUsage RanchTracker::GetMemoryUsage() const
+{
+  return util::MemoryUsage{
+    .count = _characters.size() + _horses.size(),
+    .bytes = util::EstimateHeapSize(_characters) + util::EstimateHeapSize(_horses)};
+}
+
 } // namespace server::tracker
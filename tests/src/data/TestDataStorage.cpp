@@ -0,0 +1,457 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include <libserver/data/DataStorage.hpp>
+
+#include <cassert>
+#include <format>
+#include <map>
+#include <thread>
+
+namespace
+{
+
+using Storage = server::DataStorage<uint32_t, std::string>;
+using State = Storage::State;
+using server::RetrieveResult;
+
+//! A data source with scripted results of the retrieves.
+struct Source
+{
+  Storage MakeStorage(const server::DataStoragePolicy& policy)
+  {
+    return Storage(
+      [this](const uint32_t& key, std::string& data)
+      {
+        ++retrieveCounts[key];
+        const auto result = results.contains(key) ? results[key] : RetrieveResult::Absent;
+        if (result == RetrieveResult::Retrieved)
+          data = std::format("datum {}", key);
+        return result;
+      },
+      [this](const uint32_t&, std::string&)
+      {
+        ++storeCount;
+        return true;
+      },
+      [this](const uint32_t& key)
+      {
+        deletedKeys.emplace_back(key);
+        results.erase(key);
+        return true;
+      },
+      "test",
+      policy);
+  }
+
+  std::map<uint32_t, RetrieveResult> results;
+  std::map<uint32_t, uint32_t> retrieveCounts;
+  std::vector<uint32_t> deletedKeys;
+  uint32_t storeCount{0};
+};
+
+void TestPresent()
+{
+  Source source;
+  source.results[1] = RetrieveResult::Retrieved;
+  auto storage = source.MakeStorage({});
+
+  const auto missingRecord = storage.Get(1);
+  assert(not missingRecord);
+  assert(storage.GetState(1) == State::Loading);
+  // Requested again while loading, retrieved once.
+  const auto loadingRecord = storage.Get(1);
+  assert(not loadingRecord);
+  storage.Tick();
+  assert(source.retrieveCounts[1] == 1);
+
+  const auto record = storage.Get(1);
+  assert(record);
+  record->Immutable([](const std::string& data)
+  {
+    assert(data == "datum 1");
+  });
+
+  assert(storage.GetKeys() == std::vector<uint32_t>{1});
+
+  const auto statistics = storage.GetStatistics();
+  assert(statistics.hitCount == 1);
+  assert(statistics.missCount == 2);
+  assert(statistics.negativeEntryCount == 0);
+}
+
+void TestAbsent()
+{
+  Source source;
+  auto storage = source.MakeStorage({
+    .absentTtl = std::chrono::milliseconds(50)});
+
+  const auto missingRecord = storage.Get(7);
+  assert(not missingRecord);
+  storage.Tick();
+  assert(storage.GetState(7) == State::Absent);
+
+  // The absence is cached, the datum is not retrieved again.
+  for (int i = 0; i < 10; ++i)
+  {
+    const auto absentRecord = storage.Get(7);
+    assert(not absentRecord);
+  }
+  storage.Tick();
+  assert(source.retrieveCounts[7] == 1);
+
+  // Absent entries are not reported as keys.
+  assert(storage.GetKeys().empty());
+
+  auto statistics = storage.GetStatistics();
+  assert(statistics.negativeHitCount == 10);
+  assert(statistics.absentCount == 1);
+  assert(statistics.negativeEntryCount == 1);
+
+  // The expired absence is dropped by the tick.
+  std::this_thread::sleep_for(std::chrono::milliseconds(60));
+  storage.Tick();
+  assert(not storage.GetState(7));
+  assert(storage.GetStatistics().entryCount == 0);
+
+  // Once the datum appears it is retrieved.
+  source.results[7] = RetrieveResult::Retrieved;
+  const auto expiredRecord = storage.Get(7);
+  assert(not expiredRecord);
+  storage.Tick();
+  const auto appearedRecord = storage.Get(7);
+  assert(appearedRecord);
+  assert(source.retrieveCounts[7] == 2);
+
+  // A created datum replaces the absence.
+  const auto absentRecord = storage.Get(8);
+  assert(not absentRecord);
+  storage.Tick();
+  assert(storage.GetState(8) == State::Absent);
+  const auto created = storage.Create([]()
+  {
+    return std::pair<uint32_t, std::string>{8, "created"};
+  });
+  assert(created);
+  assert(storage.GetState(8) == State::Present);
+  assert(storage.GetStatistics().negativeEntryCount == 1);
+  storage.Tick();
+  assert(storage.GetStatistics().negativeEntryCount == 0);
+  assert(source.storeCount == 1);
+}
+
+void TestRetryBackoff()
+{
+  Source source;
+  source.results[3] = RetrieveResult::Failed;
+  auto storage = source.MakeStorage({
+    .retryBackoff = std::chrono::milliseconds(100),
+    .maxRetryBackoff = std::chrono::milliseconds(200)});
+
+  const auto missingRecord = storage.Get(3);
+  assert(not missingRecord);
+  storage.Tick();
+  assert(storage.GetState(3) == State::Failed);
+
+  // Not retried within the backoff.
+  const auto failedRecord = storage.Get(3);
+  assert(not failedRecord);
+  storage.Tick();
+  assert(source.retrieveCounts[3] == 1);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(120));
+  const auto retriedRecord = storage.Get(3);
+  assert(not retriedRecord);
+  assert(storage.GetState(3) == State::Loading);
+  storage.Tick();
+  assert(source.retrieveCounts[3] == 2);
+
+  // The backoff doubled.
+  std::this_thread::sleep_for(std::chrono::milliseconds(120));
+  const auto backedOffRecord = storage.Get(3);
+  assert(not backedOffRecord);
+  storage.Tick();
+  assert(source.retrieveCounts[3] == 2);
+
+  // The transient failure passes.
+  source.results[3] = RetrieveResult::Retrieved;
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  const auto recoveringRecord = storage.Get(3);
+  assert(not recoveringRecord);
+  storage.Tick();
+  const auto recoveredRecord = storage.Get(3);
+  assert(recoveredRecord);
+  assert(source.retrieveCounts[3] == 3);
+
+  const auto statistics = storage.GetStatistics();
+  assert(statistics.failureCount == 2);
+  assert(statistics.retryCount == 2);
+  assert(statistics.negativeEntryCount == 0);
+}
+
+void TestEviction()
+{
+  Source source;
+  auto storage = source.MakeStorage({
+    .maxNegativeEntries = 8});
+
+  for (uint32_t key = 0; key < 100; ++key)
+  {
+    const auto missingRecord = storage.Get(key);
+    assert(not missingRecord);
+  }
+  storage.Tick();
+
+  // Only the newest absent entries are kept.
+  const auto statistics = storage.GetStatistics();
+  assert(statistics.entryCount == 8);
+  assert(statistics.negativeEntryCount == 8);
+  assert(statistics.evictionCount == 92);
+
+  size_t absentCount = 0;
+  for (uint32_t key = 0; key < 100; ++key)
+  {
+    if (storage.GetState(key) == State::Absent)
+      ++absentCount;
+  }
+  assert(absentCount == 8);
+}
+
+void TestDelete()
+{
+  Source source;
+  source.results[5] = RetrieveResult::Retrieved;
+  auto storage = source.MakeStorage({});
+
+  const auto missingRecord = storage.Get(5);
+  assert(not missingRecord);
+  storage.Tick();
+  const auto presentRecord = storage.Get(5);
+  assert(presentRecord);
+
+  storage.Delete(5);
+  storage.Tick();
+  assert(source.deletedKeys == std::vector<uint32_t>{5});
+  assert(not storage.GetState(5));
+  assert(storage.GetStatistics().entryCount == 0);
+}
+
+void TestGetAfterDelete()
+{
+  Source source;
+  source.results[5] = RetrieveResult::Retrieved;
+  source.results[6] = RetrieveResult::Retrieved;
+  auto storage = source.MakeStorage({});
+
+  const auto missingRecord = storage.Get(5);
+  assert(not missingRecord);
+  const auto otherMissingRecord = storage.Get(6);
+  assert(not otherMissingRecord);
+  storage.Tick();
+
+  // Requested again within the tick of the delete, the datum is not resurrected.
+  storage.Delete(5);
+  const auto deletingRecord = storage.Get(5);
+  assert(not deletingRecord);
+  assert(storage.GetState(5) == State::Loading);
+  storage.Tick();
+  assert(source.deletedKeys == std::vector<uint32_t>{5});
+  assert(storage.GetState(5) == State::Absent);
+  const auto deletedRecord = storage.Get(5);
+  assert(not deletedRecord);
+
+  // Created again within the tick of the delete, the datum is kept.
+  storage.Delete(6);
+  storage.Create([]()
+  {
+    return std::make_pair(6u, std::string("created"));
+  });
+  storage.Tick();
+  assert(source.deletedKeys == std::vector<uint32_t>{5});
+  assert(storage.GetState(6) == State::Present);
+}
+
+void TestSnapshotReads()
+{
+  Source source;
+  source.results[2] = RetrieveResult::Retrieved;
+  auto storage = source.MakeStorage({
+    .snapshotReads = true});
+
+  const auto missingRecord = storage.Get(2);
+  assert(not missingRecord);
+  storage.Tick();
+
+  const auto record = storage.Get(2);
+  assert(record);
+  record->Immutable([](const std::string& data)
+  {
+    assert(data == "datum 2");
+  });
+
+  // The patched datum is published to the readers.
+  record->Mutable([](std::string& data)
+  {
+    data = "patched";
+  });
+  record->Immutable([](const std::string& data)
+  {
+    assert(data == "patched");
+  });
+
+  // The snapshot is read without the lock held by a writer.
+  record->Mutable([&record](std::string&)
+  {
+    record->Immutable([](const std::string& data)
+    {
+      assert(data == "patched");
+    });
+  });
+
+  // A snapshot replaced while it is read is reclaimed by a tick after the read,
+  // without another patch of the datum.
+  record->Immutable([&record, &storage](const std::string&)
+  {
+    record->Mutable([](std::string& data)
+    {
+      data = "patched again";
+    });
+    storage.Tick();
+    assert(storage.GetStatistics().retiredSnapshotCount == 1);
+  });
+  storage.Tick();
+  assert(storage.GetStatistics().retiredSnapshotCount == 0);
+}
+
+void TestEncodedForms()
+{
+  Source source;
+  source.results[4] = RetrieveResult::Retrieved;
+  auto storage = source.MakeStorage({});
+
+  const auto missingRecord = storage.Get(4);
+  assert(not missingRecord);
+  storage.Tick();
+  const auto record = storage.Get(4);
+  assert(record);
+
+  uint32_t encodeCount = 0;
+  const auto encoder = [&encodeCount](const std::string& data, std::vector<std::byte>& buffer)
+  {
+    ++encodeCount;
+    const auto bytes = std::as_bytes(std::span(data));
+    buffer.assign(bytes.begin(), bytes.end());
+  };
+
+  // Encoded on the first use and reused afterwards.
+  const auto first = record->GetEncoded(encoder);
+  const auto second = storage.Get(4)->GetEncoded(encoder);
+  assert(first == second);
+  assert(encodeCount == 1);
+  assert(first->size() == std::string("datum 4").size());
+
+  // Encoded again after a patch.
+  record->Mutable([](std::string& data)
+  {
+    data = "patched datum";
+  });
+  const auto third = record->GetEncoded(encoder);
+  assert(third != first);
+  assert(encodeCount == 2);
+  assert(third->size() == std::string("patched datum").size());
+
+  // The previous form stays valid for its holders.
+  assert(first->size() == std::string("datum 4").size());
+}
+
+void TestBulkGet()
+{
+  Source source;
+  source.results[1] = RetrieveResult::Retrieved;
+  source.results[2] = RetrieveResult::Retrieved;
+  source.results[3] = RetrieveResult::Absent;
+  auto storage = source.MakeStorage({});
+
+  const std::vector<uint32_t> keys{1, 2, 3};
+  std::vector<server::Record<std::string>> records;
+
+  // All of the data are requested in a single pass, the pending ones are not requested again.
+  auto availability = storage.Get(keys, records);
+  assert(availability.pendingCount == 3);
+  assert(records.empty());
+  availability = storage.Get(keys, records);
+  assert(availability.pendingCount == 3);
+  storage.Tick();
+  for (const auto key : keys)
+    assert(source.retrieveCounts[key] == 1);
+
+  // The available data are provided even though one is absent.
+  availability = storage.Get(keys, records);
+  assert(availability.availableCount == 2);
+  assert(availability.missingCount == 1);
+  assert(not availability.IsComplete());
+  assert(records.size() == 2);
+  records[1].Immutable([](const std::string& data)
+  {
+    assert(data == "datum 2");
+  });
+  const auto incompleteRecords = storage.Get(keys);
+  assert(not incompleteRecords);
+
+  // The storage of the caller is reused.
+  const auto* const recordData = records.data();
+  storage.Get(std::vector<uint32_t>{2}, records);
+  assert(records.size() == 1);
+  assert(records.data() == recordData);
+
+  // The patches of the bulk records are stored.
+  records[0].Mutable([](std::string& data)
+  {
+    data = "patched datum";
+  });
+  storage.Tick();
+  assert(source.storeCount == 1);
+
+  std::vector<std::string> viewed;
+  availability = storage.View(keys, [&viewed](const uint32_t& key, const std::string& data)
+  {
+    viewed.emplace_back(std::format("{}: {}", key, data));
+  });
+  assert(availability.availableCount == 2);
+  assert((viewed == std::vector<std::string>{"1: datum 1", "2: patched datum"}));
+
+  const std::vector<uint32_t> presentKeys{1, 2};
+  const auto presentRecords = storage.Get(presentKeys);
+  assert(presentRecords and presentRecords->size() == 2);
+}
+
+} // anon namespace
+
+int main()
+{
+  TestPresent();
+  TestAbsent();
+  TestRetryBackoff();
+  TestEviction();
+  TestDelete();
+  TestGetAfterDelete();
+  TestSnapshotReads();
+  TestEncodedForms();
+  TestBulkGet();
+}
@@ -0,0 +1,184 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include <libserver/network/Admission.hpp>
+
+#include <cassert>
+
+namespace
+{
+
+using server::network::AdmissionResult;
+using server::network::ConnectionAdmission;
+using Address = boost::asio::ip::address_v4;
+
+void TestRateLimit()
+{
+  ConnectionAdmission admission({
+    .maxConnectionsPerAddress = 100,
+    .burst = 4,
+    .refillPeriod = std::chrono::seconds(2)});
+
+  const Address address(0x0A000001);
+  const auto now = ConnectionAdmission::Clock::now();
+
+  // The burst is admitted, the connections after it are limited.
+  for (int idx = 0; idx < 4; ++idx)
+  {
+    const auto result = admission.Admit(address, now);
+    assert(result == AdmissionResult::Admitted);
+    admission.Release(address);
+  }
+  auto result = admission.Admit(address, now);
+  assert(result == AdmissionResult::RateLimited);
+
+  // Other addresses have their own buckets.
+  result = admission.Admit(Address(0x0A000002), now);
+  assert(result == AdmissionResult::Admitted);
+
+  // A token is regained every refill period.
+  result = admission.Admit(address, now + std::chrono::seconds(1));
+  assert(result == AdmissionResult::RateLimited);
+  result = admission.Admit(address, now + std::chrono::seconds(2));
+  assert(result == AdmissionResult::Admitted);
+  result = admission.Admit(address, now + std::chrono::seconds(2));
+  assert(result == AdmissionResult::RateLimited);
+
+  // The bucket does not grow past the burst.
+  const auto later = now + std::chrono::hours(1);
+  for (int idx = 0; idx < 4; ++idx)
+  {
+    result = admission.Admit(address, later);
+    assert(result == AdmissionResult::Admitted);
+  }
+  result = admission.Admit(address, later);
+  assert(result == AdmissionResult::RateLimited);
+
+  const auto statistics = admission.GetStatistics();
+  assert(statistics.admitted == 10);
+  assert(statistics.rejectedRateLimited == 4);
+  assert(statistics.trackedAddresses == 2);
+}
+
+void TestConnectionLimit()
+{
+  ConnectionAdmission admission({
+    .maxConnectionsPerAddress = 2,
+    .burst = 10});
+
+  const Address address(0x0A000001);
+  const auto now = ConnectionAdmission::Clock::now();
+
+  auto result = admission.Admit(address, now);
+  assert(result == AdmissionResult::Admitted);
+  result = admission.Admit(address, now);
+  assert(result == AdmissionResult::Admitted);
+  result = admission.Admit(address, now);
+  assert(result == AdmissionResult::TooManyConnections);
+
+  // A released connection makes room for another.
+  admission.Release(address);
+  result = admission.Admit(address, now);
+  assert(result == AdmissionResult::Admitted);
+
+  const auto statistics = admission.GetStatistics();
+  assert(statistics.admitted == 3);
+  assert(statistics.rejectedTooManyConnections == 1);
+}
+
+void TestEviction()
+{
+  // One entry per shard.
+  ConnectionAdmission admission({
+    .maxConnectionsPerAddress = 1,
+    .burst = 1,
+    .refillPeriod = std::chrono::hours(1),
+    .addressCapacity = 1});
+
+  const auto now = ConnectionAdmission::Clock::now();
+
+  // Scanning addresses never grow the table past its capacity.
+  for (uint32_t idx = 0; idx < 10'000; ++idx)
+  {
+    const Address address(0xC0A80000 + idx);
+    const auto result = admission.Admit(address, now);
+    assert(result == AdmissionResult::Admitted);
+    admission.Release(address);
+  }
+
+  auto statistics = admission.GetStatistics();
+  assert(statistics.admitted == 10'000);
+  assert(statistics.trackedAddresses <= 16);
+  assert(statistics.evictions == 10'000 - statistics.trackedAddresses);
+
+  // Addresses with connections are not evicted, a shard full of them rejects new addresses.
+  ConnectionAdmission fullAdmission({
+    .maxConnectionsPerAddress = 1,
+    .burst = 1,
+    .addressCapacity = 1});
+
+  uint32_t rejectedCount = 0;
+  for (uint32_t idx = 0; idx < 1'000; ++idx)
+  {
+    if (fullAdmission.Admit(Address(0xC0A80000 + idx), now) == AdmissionResult::TableFull)
+      ++rejectedCount;
+  }
+
+  statistics = fullAdmission.GetStatistics();
+  assert(statistics.admitted == 16);
+  assert(statistics.rejectedTableFull == rejectedCount);
+  assert(rejectedCount == 1'000 - 16);
+  assert(statistics.evictions == 0);
+}
+
+void TestTableConsistency()
+{
+  // Churn through many addresses in a small table and verify
+  // the tracked ones are still found after the backward shifts.
+  ConnectionAdmission admission({
+    .maxConnectionsPerAddress = 1,
+    .burst = 1,
+    .refillPeriod = std::chrono::hours(1),
+    .addressCapacity = 256});
+
+  const auto now = ConnectionAdmission::Clock::now();
+
+  for (uint32_t idx = 0; idx < 100'000; ++idx)
+  {
+    const Address address(idx * 7919);
+    const auto result = admission.Admit(address, now);
+    if (result == AdmissionResult::Admitted)
+      admission.Release(address);
+  }
+
+  // The most recently admitted address is still tracked with an empty bucket.
+  const auto result = admission.Admit(Address(99'999 * 7919), now);
+  assert(result == AdmissionResult::RateLimited);
+  assert(admission.GetStatistics().trackedAddresses <= 256);
+}
+
+} // anon namespace
+
+int main()
+{
+  TestRateLimit();
+  TestConnectionLimit();
+  TestEviction();
+  TestTableConsistency();
+}
@@ -0,0 +1,212 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include <libserver/network/ClientRegistry.hpp>
+
+#include <atomic>
+#include <cassert>
+#include <string>
+#include <thread>
+
+namespace
+{
+
+using server::network::ClientId;
+
+//! A context of a client.
+struct Context
+{
+  uint32_t characterUid{0};
+  std::string name;
+};
+
+using Registry = server::network::ClientRegistry<Context>;
+
+//! Makes a client ID the way the network server does, the generation in the upper 32 bits.
+constexpr ClientId MakeClientId(const uint32_t index, const uint32_t generation = 0)
+{
+  return static_cast<ClientId>(generation) << 32 | index;
+}
+
+void TestRegistry()
+{
+  Registry registry;
+  assert(registry.Empty());
+
+  registry.Emplace(MakeClientId(0)).characterUid = 10;
+  registry.Emplace(MakeClientId(1)).characterUid = 11;
+  registry.Emplace(MakeClientId(5)).characterUid = 15;
+  assert(registry.Size() == 3);
+
+  // Emplacing a registered client keeps its context.
+  const auto& emplacedContext = registry.Emplace(MakeClientId(1));
+  assert(emplacedContext.characterUid == 11);
+  assert(registry.Size() == 3);
+
+  assert(registry.Find(MakeClientId(5))->characterUid == 15);
+  assert(registry.Find(MakeClientId(2)) == nullptr);
+  assert(registry.Find(MakeClientId(100)) == nullptr);
+
+  // The last client takes the place of the erased one.
+  bool isErased = registry.Erase(MakeClientId(0));
+  assert(isErased);
+  isErased = registry.Erase(MakeClientId(0));
+  assert(not isErased);
+  assert(registry.Size() == 2);
+  assert(registry.begin()->first == MakeClientId(5));
+  assert(registry.Find(MakeClientId(5))->characterUid == 15);
+  assert(registry.Find(MakeClientId(1))->characterUid == 11);
+
+  // A stale ID does not resolve to the client reusing its slot.
+  registry.Emplace(MakeClientId(0, 1)).characterUid = 20;
+  assert(registry.Find(MakeClientId(0)) == nullptr);
+  isErased = registry.Erase(MakeClientId(0));
+  assert(not isErased);
+  assert(registry.Contains(MakeClientId(0, 1)));
+
+  // A client which was not erased is replaced by the client reusing its slot.
+  registry.Emplace(MakeClientId(1, 1));
+  assert(registry.Size() == 3);
+  assert(not registry.Contains(MakeClientId(1)));
+  assert(registry.Find(MakeClientId(1, 1))->characterUid == 0);
+
+  uint32_t characterUidSum = 0;
+  for (const auto& [clientId, context] : registry)
+    characterUidSum += context.characterUid;
+  assert(characterUidSum == 35);
+
+  bool isModified = registry.Modify(MakeClientId(5), [](Context& context)
+  {
+    context.characterUid = 25;
+  });
+  assert(isModified);
+  isModified = registry.Modify(MakeClientId(2), [](Context&)
+  {
+    assert(false);
+  });
+  assert(not isModified);
+
+  bool isVisited = registry.Visit(MakeClientId(5), [](const Context& context)
+  {
+    assert(context.characterUid == 25);
+  });
+  assert(isVisited);
+  isVisited = registry.Visit(MakeClientId(2), [](const Context&)
+  {
+    assert(false);
+  });
+  assert(not isVisited);
+
+  // The visit stops once the function returns `false`.
+  size_t visitCount = 0;
+  bool isVisitComplete = registry.VisitEach([&visitCount](ClientId, const Context&)
+  {
+    ++visitCount;
+    return false;
+  });
+  assert(not isVisitComplete);
+  assert(visitCount == 1);
+
+  visitCount = 0;
+  isVisitComplete = registry.VisitEach([&visitCount](ClientId, const Context&)
+  {
+    ++visitCount;
+  });
+  assert(isVisitComplete);
+  assert(visitCount == 3);
+
+  assert(registry.EstimateContainerHeapSize() > 0);
+}
+
+void TestConcurrentReads()
+{
+  constexpr uint32_t ClientCount = 64;
+  constexpr uint32_t RoundCount = 2000;
+
+  Registry registry;
+  std::atomic_bool shouldRun{true};
+
+  // The owner thread registers, modifies and erases the clients.
+  std::thread owner([&registry, &shouldRun]()
+  {
+    for (uint32_t round = 0; round < RoundCount; ++round)
+    {
+      for (uint32_t index = 0; index < ClientCount; ++index)
+      {
+        // The fields read by the other threads are modified exclusively.
+        registry.Emplace(MakeClientId(index, round));
+        registry.Modify(MakeClientId(index, round), [index](Context& context)
+        {
+          context.characterUid = index;
+          context.name = std::string(32, 'a');
+        });
+      }
+
+      for (uint32_t index = 0; index < ClientCount; index += 2)
+      {
+        registry.Modify(MakeClientId(index, round), [](Context& context)
+        {
+          context.name = std::string(48, 'b');
+        });
+      }
+
+      for (uint32_t index = 0; index < ClientCount; ++index)
+      {
+        const bool isErased = registry.Erase(MakeClientId(index, round));
+        assert(isErased);
+      }
+    }
+
+    shouldRun = false;
+  });
+
+  // The other threads read them.
+  std::thread reader([&registry, &shouldRun]()
+  {
+    while (shouldRun)
+    {
+      registry.VisitEach([](const ClientId clientId, const Context& context)
+      {
+        // A client might be visited before it is modified.
+        if (context.name.empty())
+          return;
+
+        assert(context.characterUid == static_cast<uint32_t>(clientId));
+        assert(context.name.size() == 32 || context.name.size() == 48);
+      });
+
+      registry.Visit(MakeClientId(1), [](const Context& context)
+      {
+        assert(context.name.empty() || context.characterUid == 1);
+      });
+    }
+  });
+
+  owner.join();
+  reader.join();
+  assert(registry.Empty());
+}
+
+} // anon namespace
+
+int main()
+{
+  TestRegistry();
+  TestConcurrentReads();
+}
@@ -0,0 +1,129 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include <libserver/network/Server.hpp>
+
+#include <cassert>
+#include <thread>
+
+namespace
+{
+
+namespace asio = boost::asio;
+
+//! Remembers the connected client of a server.
+class ClientHandler final
+  : public server::network::EventHandlerInterface
+{
+public:
+  void HandleNetworkTick() override
+  {
+  }
+
+  void OnClientConnected(server::network::ClientId clientId) override
+  {
+    connectedClientId = clientId;
+    isConnected = true;
+  }
+
+  void OnClientDisconnected(server::network::ClientId) override
+  {
+    isConnected = false;
+  }
+
+  size_t OnClientData(
+    server::network::ClientId,
+    const std::span<const std::byte>& data) override
+  {
+    return data.size();
+  }
+
+  std::atomic<server::network::ClientId> connectedClientId{0};
+  std::atomic_bool isConnected{false};
+};
+
+template<typename Predicate>
+void WaitFor(Predicate predicate)
+{
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (not predicate())
+  {
+    assert(std::chrono::steady_clock::now() < deadline);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+}
+
+void TestClientStatistics()
+{
+  ClientHandler handler;
+  server::network::Server server(handler);
+  std::thread serverThread([&server]()
+  {
+    server.Begin(asio::ip::address_v4::loopback(), 0);
+  });
+
+  WaitFor([&server]() { return server.GetPort() != 0; });
+  const asio::ip::tcp::endpoint endpoint(asio::ip::address_v4::loopback(), server.GetPort());
+
+  asio::io_context ioContext;
+  asio::ip::tcp::socket client(ioContext);
+  client.connect(endpoint);
+  WaitFor([&handler]() { return handler.isConnected.load(); });
+
+  const server::network::ClientId clientId = handler.connectedClientId;
+
+  const std::array<std::byte, 16> data{};
+  asio::write(client, asio::buffer(data));
+
+  // The statistics are updated every network tick.
+  std::optional<server::network::ClientStatistics> statistics;
+  WaitFor([&server, &statistics, clientId, &data]()
+  {
+    statistics = server.GetClientStatistics(clientId);
+    return statistics.has_value() && statistics->inboundBytes == data.size();
+  });
+  assert(statistics->inboundReads > 0);
+  assert(statistics->writeQueueDepth == 0);
+#ifdef __linux__
+  // The kernel measures the round-trip time from the handshake already.
+  assert(statistics->roundTripTime.count() > 0);
+#endif
+
+  // A client which is not connected has no statistics.
+  const auto unknownStatistics = server.GetClientStatistics(clientId + 1);
+  assert(not unknownStatistics.has_value());
+
+  // Nor does one which disconnected, once the next tick dropped it.
+  client.close();
+  WaitFor([&handler]() { return not handler.isConnected; });
+  WaitFor([&server, clientId]()
+  {
+    return not server.GetClientStatistics(clientId).has_value();
+  });
+
+  server.End();
+  serverThread.join();
+}
+
+} // anon namespace
+
+int main()
+{
+  TestClientStatistics();
+}
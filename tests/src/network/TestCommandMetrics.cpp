@@ -0,0 +1,150 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include <libserver/network/CommandMetrics.hpp>
+
+#include <cassert>
+
+namespace
+{
+
+using server::network::CommandMetrics;
+using server::network::HandlerError;
+using namespace std::chrono_literals;
+
+void TestRecording()
+{
+  CommandMetrics metrics(16);
+
+  metrics.RecordInbound(3, 40, 1us);
+  metrics.RecordHandled(3, 10us, false);
+  metrics.RecordInbound(3, 60, 1us);
+  metrics.RecordHandled(3, 20us, true);
+  metrics.RecordOutbound(4, 100, 2us);
+
+  // Out of range command IDs are not recorded.
+  metrics.RecordInbound(16, 10, 1us);
+
+  const auto snapshot = metrics.GetSnapshot();
+  assert(snapshot.size() == 2);
+
+  const auto& received = snapshot[0];
+  assert(received.commandId == 3);
+  assert(received.inboundCount == 2);
+  assert(received.outboundCount == 0);
+  assert(received.failureCount == 1);
+  assert(received.inboundSize.sum == 100);
+  assert(received.handlerTime.count == 2);
+  assert(received.handlerTime.max == 20'000);
+  assert(received.GetTotalTime() == 32'000);
+
+  const auto& sent = snapshot[1];
+  assert(sent.commandId == 4);
+  assert(sent.outboundCount == 1);
+  assert(sent.outboundSize.sum == 100);
+  assert(sent.serializeTime.sum == 2'000);
+}
+
+void TestTopCommands()
+{
+  CommandMetrics metrics(16);
+
+  // Command 1 is received often but is cheap,
+  // command 2 is received once but is expensive.
+  for (uint32_t idx = 0; idx < 100; ++idx)
+  {
+    metrics.RecordInbound(1, 8, 100ns);
+    metrics.RecordHandled(1, 100ns, false);
+  }
+  metrics.RecordInbound(2, 500, 1us);
+  metrics.RecordHandled(2, 1ms, false);
+  metrics.RecordOutbound(5, 20, 1us);
+
+  const auto byTime = metrics.GetTopCommands(2, CommandMetrics::Ranking::TotalTime);
+  assert(byTime.size() == 2);
+  assert(byTime[0].commandId == 2);
+  assert(byTime[1].commandId == 1);
+
+  const auto byCount = metrics.GetTopCommands(1, CommandMetrics::Ranking::Count);
+  assert(byCount.size() == 1);
+  assert(byCount[0].commandId == 1);
+
+  const auto byBytes = metrics.GetTopCommands(1, CommandMetrics::Ranking::Bytes);
+  assert(byBytes[0].commandId == 1);
+
+  // More commands requested than recorded.
+  assert(metrics.GetTopCommands(10, CommandMetrics::Ranking::HandlerTimeP99).size() == 3);
+}
+
+void TestErrors()
+{
+  CommandMetrics metrics(16);
+
+  // The dispatchers record a rejected command as a failure and count its kind.
+  metrics.RecordInbound(7, 10, 1us);
+  metrics.RecordHandled(7, 1us, true);
+  metrics.RecordError(7, HandlerError::UnknownClient);
+  metrics.RecordError(7, HandlerError::UnknownClient);
+  metrics.RecordError(7, HandlerError::InvalidCommand);
+
+  // Out of range command IDs and kinds are not recorded.
+  metrics.RecordError(16, HandlerError::UnknownClient);
+  metrics.RecordError(7, HandlerError::Count);
+
+  const auto snapshot = metrics.GetSnapshot();
+  assert(snapshot.size() == 1);
+
+  const auto& statistics = snapshot[0];
+  assert(statistics.failureCount == 1);
+  assert(statistics.errorCounts[static_cast<size_t>(HandlerError::UnknownClient)] == 2);
+  assert(statistics.errorCounts[static_cast<size_t>(HandlerError::InvalidCommand)] == 1);
+  assert(statistics.errorCounts[static_cast<size_t>(HandlerError::RecordUnavailable)] == 0);
+
+  static_assert(server::network::GetHandlerErrorName(HandlerError::InvalidState) == "invalid_state");
+}
+
+void TestUnreadable()
+{
+  CommandMetrics metrics(16);
+
+  metrics.RecordInbound(5, 10, 1us);
+  metrics.RecordHandled(5, 10us, false);
+  metrics.RecordUnreadable(5, 30);
+
+  const auto snapshot = metrics.GetSnapshot();
+  assert(snapshot.size() == 1);
+
+  // The unreadable commands are failures without a decode or handler time.
+  const auto& statistics = snapshot[0];
+  assert(statistics.inboundCount == 2);
+  assert(statistics.inboundSize.sum == 40);
+  assert(statistics.failureCount == 1);
+  assert(statistics.decodeTime.count == 1);
+  assert(statistics.handlerTime.count == 1);
+}
+
+} // anon namespace
+
+int main()
+{
+  TestRecording();
+  TestTopCommands();
+  TestErrors();
+  TestUnreadable();
+}
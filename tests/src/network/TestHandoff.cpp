@@ -0,0 +1,192 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include <libserver/network/Handoff.hpp>
+#include <libserver/network/Server.hpp>
+
+#include <cassert>
+#include <thread>
+
+namespace
+{
+
+namespace asio = boost::asio;
+namespace handoff = server::network::handoff;
+
+//! Counts the connections and the data of a server.
+class CountingHandler final
+  : public server::network::EventHandlerInterface
+{
+public:
+  void HandleNetworkTick() override
+  {
+  }
+
+  void OnClientConnected(server::network::ClientId) override
+  {
+    ++connectedCount;
+  }
+
+  void OnClientDisconnected(server::network::ClientId) override
+  {
+  }
+
+  size_t OnClientData(
+    server::network::ClientId,
+    const std::span<const std::byte>& data) override
+  {
+    receivedSize += data.size();
+    return data.size();
+  }
+
+  std::atomic_size_t connectedCount{0};
+  std::atomic_size_t receivedSize{0};
+};
+
+template<typename Predicate>
+void WaitFor(Predicate predicate)
+{
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (not predicate())
+  {
+    assert(std::chrono::steady_clock::now() < deadline);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+}
+
+void TestNoProvider()
+{
+  const auto path = std::filesystem::temp_directory_path() / "alicia_test_no_handoff";
+  std::filesystem::remove(path);
+
+  // Nobody serves the handoff, nothing is inherited.
+  const auto inheritedCount = handoff::InheritListeners(path, std::chrono::seconds(1));
+  assert(inheritedCount == 0);
+  const auto closedCount = handoff::CloseInheritedListeners();
+  assert(closedCount == 0);
+}
+
+void TestHandoff()
+{
+  const auto path = std::filesystem::temp_directory_path() / "alicia_test_handoff";
+
+  CountingHandler previousHandler;
+  server::network::Server previousServer(previousHandler);
+  std::thread previousServerThread([&previousServer]()
+  {
+    previousServer.Begin(asio::ip::address_v4::loopback(), 0);
+  });
+
+  WaitFor([&previousServer]() { return previousServer.GetPort() != 0; });
+  const auto port = previousServer.GetPort();
+  const asio::ip::tcp::endpoint endpoint(asio::ip::address_v4::loopback(), port);
+
+  asio::io_context ioContext;
+  asio::ip::tcp::socket previousClient(ioContext);
+  previousClient.connect(endpoint);
+  WaitFor([&previousHandler]() { return previousHandler.connectedCount == 1; });
+
+  handoff::Provider provider([&previousServer]()
+  {
+    std::vector<handoff::ListenerHandle> handles;
+    if (const auto handle = previousServer.GetListenerHandle())
+      handles.emplace_back(*handle);
+    return handles;
+  });
+
+  std::thread providerThread([&provider, &previousServer, &path]()
+  {
+    if (not provider.Serve(path))
+      return;
+
+    previousServer.StopAccepting();
+    previousServer.DisconnectAllClients();
+    WaitFor([&previousServer]() { return previousServer.GetClientCount() == 0; });
+    provider.Release();
+  });
+
+  // The provider serves the handoff once its thread runs.
+  size_t inheritedCount = 0;
+  WaitFor([&inheritedCount, &path]()
+  {
+    inheritedCount = handoff::InheritListeners(path, std::chrono::seconds(5));
+    return inheritedCount != 0;
+  });
+  assert(inheritedCount == 1);
+
+  // Only the user running the server may connect to the handoff socket.
+  assert(std::filesystem::status(path).permissions()
+    == (std::filesystem::perms::owner_read | std::filesystem::perms::owner_write));
+
+  // The previous server released once it disconnected its clients.
+  assert(previousServer.GetClientCount() == 0);
+
+  providerThread.join();
+  assert(not previousServer.GetListenerHandle());
+  // Let the previous server close its acceptor.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  // The next server adopts the socket bound to its endpoint, binding it again would fail.
+  CountingHandler nextHandler;
+  server::network::Server nextServer(nextHandler);
+  std::thread nextServerThread([&nextServer, port]()
+  {
+    nextServer.Begin(asio::ip::address_v4::loopback(), port);
+  });
+
+  WaitFor([&nextServer]() { return nextServer.GetPort() != 0; });
+  assert(nextServer.GetPort() == port);
+  const auto closedCount = handoff::CloseInheritedListeners();
+  assert(closedCount == 0);
+
+  // New clients connect to the next server.
+  asio::ip::tcp::socket nextClient(ioContext);
+  nextClient.connect(endpoint);
+  WaitFor([&nextHandler]() { return nextHandler.connectedCount == 1; });
+  assert(previousHandler.connectedCount == 1);
+
+  // The clients of the previous server were disconnected to reconnect to the next one.
+  std::array<std::byte, 4> data{};
+  boost::system::error_code readError;
+  asio::read(previousClient, asio::buffer(data), readError);
+  assert(readError == asio::error::eof || readError == asio::error::connection_reset);
+
+  asio::write(nextClient, asio::buffer(data));
+  WaitFor([&nextHandler, &data]() { return nextHandler.receivedSize == data.size(); });
+
+  previousClient.close();
+  nextClient.close();
+
+  previousServer.End();
+  nextServer.End();
+  previousServerThread.join();
+  nextServerThread.join();
+
+  std::filesystem::remove(path);
+}
+
+} // anon namespace
+
+int main()
+{
+#ifndef WIN32
+  TestNoProvider();
+  TestHandoff();
+#endif
+}
@@ -0,0 +1,176 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include <libserver/network/TrafficCapture.hpp>
+#include <libserver/network/command/CommandClientCodec.hpp>
+
+#include <cassert>
+#include <cstring>
+
+namespace
+{
+
+namespace capture = server::network::capture;
+
+std::vector<std::byte> MakeData(const size_t size, const uint8_t seed)
+{
+  std::vector<std::byte> data(size);
+  for (size_t idx = 0; idx < size; ++idx)
+    data[idx] = static_cast<std::byte>(seed + idx);
+  return data;
+}
+
+void TestCaptureRoundTrip()
+{
+  const auto path = std::filesystem::temp_directory_path() / "alicia_test_traffic.capture";
+
+  const auto smallData = MakeData(3, 1);
+  const auto largeData = MakeData(8192, 7);
+  const server::protocol::XorCode code{
+    std::byte{0x01}, std::byte{0x02}, std::byte{0x03}, std::byte{0x04}};
+
+  {
+    capture::Writer writer(path);
+    writer.WriteConnected(1);
+    writer.WriteCommand(1, 0x7, smallData);
+    writer.WriteCode(1, code);
+    writer.WriteConnected(300);
+    writer.WriteCommand(300, 0x1234, largeData);
+    writer.WriteCommand(1, 0x8, {});
+    writer.WriteDisconnected(300);
+    writer.WriteDisconnected(1);
+  }
+
+  capture::Reader reader(path);
+  capture::Record record;
+
+  const auto expect = [&](capture::RecordType type, server::network::ClientId clientId)
+  {
+    const auto previousTime = record.time;
+    const bool isRead = reader.Read(record);
+    assert(isRead);
+    assert(record.type == type);
+    assert(record.clientId == clientId);
+    assert(record.time >= previousTime);
+  };
+
+  expect(capture::RecordType::Connected, 1);
+  expect(capture::RecordType::Command, 1);
+  assert(record.commandId == 0x7);
+  assert(record.data == smallData);
+  expect(capture::RecordType::Code, 1);
+  assert(std::memcmp(record.data.data(), code.data(), code.size()) == 0);
+  expect(capture::RecordType::Connected, 300);
+  expect(capture::RecordType::Command, 300);
+  assert(record.commandId == 0x1234);
+  assert(record.data == largeData);
+  expect(capture::RecordType::Command, 1);
+  assert(record.commandId == 0x8);
+  assert(record.data.empty());
+  expect(capture::RecordType::Disconnected, 300);
+  expect(capture::RecordType::Disconnected, 1);
+  const bool isRead = reader.Read(record);
+  assert(not isRead);
+
+  std::filesystem::remove(path);
+}
+
+void TestInvalidCapture()
+{
+  const auto path = std::filesystem::temp_directory_path() / "alicia_test_invalid.capture";
+  {
+    std::ofstream file(path, std::ios::binary);
+    file << "not a capture";
+  }
+
+  bool threw = false;
+  try
+  {
+    capture::Reader reader(path);
+  }
+  catch (const std::runtime_error&)
+  {
+    threw = true;
+  }
+  assert(threw);
+
+  std::filesystem::remove(path);
+}
+
+//! Descrambles a command the way the command server does.
+std::vector<std::byte> Descramble(
+  server::CommandClient& client,
+  const std::span<const std::byte> frame)
+{
+  uint32_t magicValue{};
+  std::memcpy(&magicValue, frame.data(), sizeof(magicValue));
+  const auto magic = server::protocol::decode_message_magic(magicValue);
+  assert(magic.length == frame.size());
+
+  std::vector<std::byte> data(frame.begin() + sizeof(magicValue), frame.end());
+  if (data.empty())
+    return data;
+
+  client.RollCode();
+  const auto padding = static_cast<uint32_t>(client.GetRollingCodeInt()) & 7;
+  assert(padding < data.size());
+
+  for (size_t idx = 0; idx < data.size(); ++idx)
+    data[idx] ^= client.GetRollingCode()[idx % 4];
+  data.resize(data.size() - padding);
+  return data;
+}
+
+void TestCodec()
+{
+  server::CommandClientCodec codec;
+  server::CommandClient serverSide;
+
+  for (uint8_t idx = 0; idx < 16; ++idx)
+  {
+    // Reset the code midway, as the servers do after a login.
+    if (idx == 8)
+    {
+      codec.SetCode({});
+      serverSide.SetCode({});
+    }
+
+    const auto data = MakeData(idx * 5, idx);
+
+    std::vector<std::byte> buffer;
+    codec.Encode(0x7, data, buffer);
+
+    const auto magic = server::CommandClientCodec::PeekServerCommand(buffer);
+    assert(magic && magic->id == 0x7 && magic->length == buffer.size());
+    // A partial command is not peeked.
+    assert(not server::CommandClientCodec::PeekServerCommand(
+      std::span(buffer).first(buffer.size() - 1)) || buffer.size() == 4);
+
+    assert(Descramble(serverSide, buffer) == data);
+  }
+}
+
+} // anon namespace
+
+int main()
+{
+  TestCaptureRoundTrip();
+  TestInvalidCapture();
+  TestCodec();
+}
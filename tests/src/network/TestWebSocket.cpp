@@ -0,0 +1,113 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include <libserver/network/http/WebSocket.hpp>
+
+#include <cassert>
+#include <thread>
+
+namespace
+{
+
+namespace asio = boost::asio;
+namespace beast = boost::beast;
+namespace http = beast::http;
+
+void TestServer()
+{
+  server::websocket::Server server([](std::string_view target)
+  {
+    server::websocket::Response response;
+    if (target != "/metrics")
+      response.status = http::status::not_found;
+    else
+      response.body = "metric 1\n";
+    return response;
+  });
+
+  std::thread serverThread([&server]()
+  {
+    server.Begin(asio::ip::address_v4::loopback(), 0);
+  });
+
+  while (server.GetPort() == 0)
+    std::this_thread::yield();
+
+  asio::io_context ioContext;
+  const asio::ip::tcp::endpoint endpoint(asio::ip::address_v4::loopback(), server.GetPort());
+
+  // Plain HTTP request.
+  {
+    beast::tcp_stream stream(ioContext);
+    stream.connect(endpoint);
+
+    http::request<http::empty_body> request{http::verb::get, "/metrics", 11};
+    http::write(stream, request);
+
+    beast::flat_buffer buffer;
+    http::response<http::string_body> response;
+    http::read(stream, buffer, response);
+
+    assert(response.result() == http::status::ok);
+    assert(response.body() == "metric 1\n");
+  }
+
+  // Unknown target.
+  {
+    beast::tcp_stream stream(ioContext);
+    stream.connect(endpoint);
+
+    http::request<http::empty_body> request{http::verb::get, "/unknown", 11};
+    http::write(stream, request);
+
+    beast::flat_buffer buffer;
+    http::response<http::string_body> response;
+    http::read(stream, buffer, response);
+
+    assert(response.result() == http::status::not_found);
+  }
+
+  // WebSocket session receiving a broadcast.
+  {
+    beast::websocket::stream<beast::tcp_stream> stream(ioContext);
+    beast::get_lowest_layer(stream).connect(endpoint);
+    stream.handshake("127.0.0.1", "/live");
+
+    while (server.GetSessionCount() == 0)
+      std::this_thread::yield();
+
+    server.Broadcast("delta");
+
+    beast::flat_buffer buffer;
+    stream.read(buffer);
+    assert(beast::buffers_to_string(buffer.data()) == "delta");
+
+    stream.close(beast::websocket::close_code::normal);
+  }
+
+  server.End();
+  serverThread.join();
+}
+
+} // anon namespace
+
+int main()
+{
+  TestServer();
+}
@@ -0,0 +1,171 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include "libserver/network/command/proto/LobbyMessageDefinitions.hpp"
+#include "libserver/network/command/proto/RaceMessageDefinitions.hpp"
+#include "libserver/network/command/proto/RanchMessageDefinitions.hpp"
+
+#include <cassert>
+#include <vector>
+
+namespace
+{
+
+namespace protocol = server::protocol;
+
+//! Writes the command and reads it back as the other command type,
+//! the way a bot reads what the server wrote and the server reads what a bot wrote.
+template <typename Written, typename Read>
+Read RoundTrip(const Written& written)
+{
+  std::vector<std::byte> buffer(4096);
+
+  server::SinkStream sink(buffer);
+  sink.Write(written);
+
+  server::SourceStream source({buffer.data(), sink.GetCursor()});
+  Read read{};
+  source.Read(read);
+
+  // The whole command was consumed.
+  assert(source.GetCursor() == sink.GetCursor());
+  return read;
+}
+
+void TestLobbyCommands()
+{
+  const protocol::AcCmdCLLogin login{
+    .constant0 = 50,
+    .constant1 = 281,
+    .loginId = "bot0001",
+    .memberNo = 1,
+    .authKey = "token",
+    .val0 = 2};
+  const auto readLogin = RoundTrip<protocol::AcCmdCLLogin, protocol::AcCmdCLLogin>(login);
+  assert(readLogin.loginId == login.loginId);
+  assert(readLogin.authKey == login.authKey);
+  assert(readLogin.constant1 == login.constant1);
+
+  protocol::LobbyCommandLoginOK loginOk{
+    .uid = 42,
+    .name = "bot0001",
+    .notice = "Players online: 1",
+    .level = 60,
+    .carrots = 10'000,
+    .val6 = "val6",
+    .ranchAddress = 0x7F000001,
+    .ranchPort = 10031};
+  loginOk.equipmentItems.emplace_back(protocol::Item{.uid = 7, .tid = 30009, .count = 1});
+  loginOk.missions.emplace_back(protocol::LobbyCommandLoginOK::Mission{
+    .id = 3,
+    .progress = {{.id = 1, .value = 2}}});
+  loginOk.systemContent.values = {{4, 1}, {16, 1}};
+  loginOk.skillRanks.values = {{.id = 1, .rank = 2}};
+
+  const auto readLoginOk = RoundTrip<
+    protocol::LobbyCommandLoginOK, protocol::LobbyCommandLoginOK>(loginOk);
+  assert(readLoginOk.uid == loginOk.uid);
+  assert(readLoginOk.name == loginOk.name);
+  assert(readLoginOk.equipmentItems.size() == 1
+    && readLoginOk.equipmentItems[0].tid == 30009);
+  assert(readLoginOk.missions.size() == 1
+    && readLoginOk.missions[0].progress[0].value == 2);
+  assert(readLoginOk.systemContent.values == loginOk.systemContent.values);
+  assert(readLoginOk.ranchPort == loginOk.ranchPort);
+
+  const protocol::AcCmdCLMakeRoomOK makeRoomOk{
+    .roomUid = 5,
+    .oneTimePassword = 0xCAFE,
+    .raceServerAddress = 0x7F000001,
+    .raceServerPort = 10032};
+  const auto readMakeRoomOk = RoundTrip<
+    protocol::AcCmdCLMakeRoomOK, protocol::AcCmdCLMakeRoomOK>(makeRoomOk);
+  assert(readMakeRoomOk.roomUid == makeRoomOk.roomUid);
+  assert(readMakeRoomOk.oneTimePassword == makeRoomOk.oneTimePassword);
+  // The address is in the network byte order on the wire.
+  assert(readMakeRoomOk.raceServerAddress == makeRoomOk.raceServerAddress);
+}
+
+void TestRanchCommands()
+{
+  protocol::AcCmdCREnterRanchOK enterRanchOk{
+    .rancherUid = 42,
+    .rancherName = "bot0001",
+    .ranchName = "bot0001's ranch"};
+  enterRanchOk.horses.emplace_back(protocol::RanchHorse{.horseOid = 1});
+  enterRanchOk.characters.emplace_back(protocol::RanchCharacter{
+    .uid = 42,
+    .name = "bot0001",
+    .oid = 2});
+
+  const auto readEnterRanchOk = RoundTrip<
+    protocol::AcCmdCREnterRanchOK, protocol::AcCmdCREnterRanchOK>(enterRanchOk);
+  assert(readEnterRanchOk.horses.size() == 1);
+  assert(readEnterRanchOk.characters.size() == 1);
+  assert(readEnterRanchOk.characters[0].uid == 42
+    && readEnterRanchOk.characters[0].oid == 2);
+
+  protocol::AcCmdCRRanchSnapshot snapshot{
+    .type = protocol::AcCmdCRRanchSnapshot::Full};
+  snapshot.full.ranchIndex = 2;
+  snapshot.full.action = 0x1122334455667788;
+
+  const auto readSnapshot = RoundTrip<
+    protocol::AcCmdCRRanchSnapshot, protocol::AcCmdCRRanchSnapshot>(snapshot);
+  assert(readSnapshot.full.ranchIndex == 2);
+  assert(readSnapshot.full.action == snapshot.full.action);
+}
+
+void TestRaceCommands()
+{
+  const protocol::AcCmdCRRelay relay{
+    .oid = 1,
+    .member2 = 2,
+    .member3 = 3,
+    .data = {1, 2, 3, 4}};
+
+  // The relay notify has the same layout as the relay.
+  const auto notify = RoundTrip<protocol::AcCmdCRRelay, protocol::AcCmdCRRelayNotify>(relay);
+  assert(notify.oid == relay.oid);
+  assert(notify.data == relay.data);
+
+  const protocol::AcCmdUserRaceFinal raceFinal{
+    .oid = 1,
+    .courseTime = std::chrono::milliseconds{61'000},
+    .member3 = -1.0f};
+  const auto readRaceFinal = RoundTrip<
+    protocol::AcCmdUserRaceFinal, protocol::AcCmdUserRaceFinal>(raceFinal);
+  assert(readRaceFinal.courseTime == raceFinal.courseTime);
+  assert(readRaceFinal.member3 == raceFinal.member3);
+
+  protocol::AcCmdCRRaceResult raceResult{};
+  raceResult.member10 = {1, 2};
+  const auto readRaceResult = RoundTrip<
+    protocol::AcCmdCRRaceResult, protocol::AcCmdCRRaceResult>(raceResult);
+  assert(readRaceResult.member10 == raceResult.member10);
+}
+
+} // anon namespace
+
+int main()
+{
+  TestLobbyCommands();
+  TestRanchCommands();
+  TestRaceCommands();
+}
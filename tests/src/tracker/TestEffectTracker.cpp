@@ -0,0 +1,154 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include <server/tracker/EffectTracker.hpp>
+
+#include <cassert>
+#include <chrono>
+#include <vector>
+
+namespace
+{
+
+using server::tracker::EffectTracker;
+using Magic = server::registry::Magic;
+using State = EffectTracker::State;
+
+constexpr server::tracker::Oid AttackerOid = 1;
+constexpr server::tracker::Oid OtherAttackerOid = 2;
+constexpr server::tracker::Oid TargetOid = 3;
+
+//! Makes a magic slot of an effect lasting a second.
+Magic::SlotInfo MakeSlot(
+  const uint32_t skillEffectId,
+  const State state,
+  const Magic::EffectInfo::Stacking stacking = Magic::EffectInfo::Stacking::Refresh)
+{
+  Magic::SlotInfo slotInfo{};
+  slotInfo.type = skillEffectId * 10;
+  slotInfo.skillEffectId = skillEffectId;
+  slotInfo.effect.state = state;
+  slotInfo.effect.stacking = stacking;
+  slotInfo.effect.duration = std::chrono::seconds(1);
+  slotInfo.effect.obstacleLifetime = std::chrono::seconds(2);
+  return slotInfo;
+}
+
+void TestOverlappingApply()
+{
+  EffectTracker tracker;
+  const auto now = EffectTracker::Clock::now();
+  const auto shield = MakeSlot(1, State::Shield);
+  const auto darkness = MakeSlot(2, State::Darkness);
+
+  // Different effects on the same racer are tracked side by side.
+  assert(tracker.Apply(AttackerOid, TargetOid, shield, now));
+  assert(tracker.Apply(AttackerOid, TargetOid, darkness, now + std::chrono::milliseconds(500)));
+  assert(tracker.HasState(TargetOid, State::Shield));
+  assert(tracker.HasState(TargetOid, State::Darkness));
+  assert(tracker.GetMemoryUsage().count == 2);
+
+  // The first effect expires without taking the later one along.
+  std::vector<EffectTracker::Effect> expiredEffects;
+  std::vector<EffectTracker::Obstacles> expiredObstacles;
+  tracker.Expire(now + std::chrono::seconds(1), expiredEffects, expiredObstacles);
+  assert(expiredEffects.size() == 1);
+  assert(expiredEffects[0].state == State::Shield);
+  assert(not tracker.HasState(TargetOid, State::Shield));
+  assert(tracker.HasState(TargetOid, State::Darkness));
+
+  tracker.Expire(now + std::chrono::milliseconds(1500), expiredEffects, expiredObstacles);
+  assert(expiredEffects.size() == 1);
+  assert(expiredEffects[0].state == State::Darkness);
+  assert(tracker.IsEmpty());
+}
+
+void TestRefresh()
+{
+  EffectTracker tracker;
+  const auto now = EffectTracker::Clock::now();
+  const auto shield = MakeSlot(1, State::Shield);
+
+  // Applying an active effect again restarts it as one effect of the latest attacker.
+  assert(tracker.Apply(AttackerOid, TargetOid, shield, now));
+  assert(tracker.Apply(OtherAttackerOid, TargetOid, shield, now + std::chrono::milliseconds(500)));
+  assert(tracker.GetMemoryUsage().count == 1);
+
+  std::vector<EffectTracker::Effect> expiredEffects;
+  std::vector<EffectTracker::Obstacles> expiredObstacles;
+  tracker.Expire(now + std::chrono::seconds(1), expiredEffects, expiredObstacles);
+  assert(expiredEffects.empty());
+  assert(tracker.HasState(TargetOid, State::Shield));
+
+  tracker.Expire(now + std::chrono::milliseconds(1500), expiredEffects, expiredObstacles);
+  assert(expiredEffects.size() == 1);
+  assert(expiredEffects[0].attackerOid == OtherAttackerOid);
+
+  // An ignored effect keeps the current one and its expiry.
+  const auto hotRodding = MakeSlot(3, State::HotRodding, Magic::EffectInfo::Stacking::Ignore);
+  assert(tracker.Apply(AttackerOid, TargetOid, hotRodding, now));
+  assert(not tracker.Apply(OtherAttackerOid, TargetOid, hotRodding, now + std::chrono::milliseconds(500)));
+
+  tracker.Expire(now + std::chrono::seconds(1), expiredEffects, expiredObstacles);
+  assert(expiredEffects.size() == 1);
+  assert(expiredEffects[0].attackerOid == AttackerOid);
+  assert(tracker.IsEmpty());
+}
+
+void TestExpiryBoundary()
+{
+  EffectTracker tracker;
+  const auto now = EffectTracker::Clock::now();
+  const auto shield = MakeSlot(1, State::Shield);
+
+  tracker.Apply(AttackerOid, TargetOid, shield, now);
+  tracker.AddObstacles(shield, 100, 4, now);
+
+  // The effect and the obstacles are active until the tick of their expiry.
+  std::vector<EffectTracker::Effect> expiredEffects;
+  std::vector<EffectTracker::Obstacles> expiredObstacles;
+  tracker.Expire(
+    now + std::chrono::seconds(1) - EffectTracker::Clock::duration(1),
+    expiredEffects,
+    expiredObstacles);
+  assert(expiredEffects.empty());
+  assert(expiredObstacles.empty());
+
+  // The effect expires on the tick of its expiry.
+  tracker.Expire(now + std::chrono::seconds(1), expiredEffects, expiredObstacles);
+  assert(expiredEffects.size() == 1);
+  assert(expiredObstacles.empty());
+
+  // The obstacles expire on the tick of theirs, the outputs are cleared between the ticks.
+  tracker.Expire(now + std::chrono::seconds(2), expiredEffects, expiredObstacles);
+  assert(expiredEffects.empty());
+  assert(expiredObstacles.size() == 1);
+  assert(expiredObstacles[0].firstObstacleInstanceId == 100);
+  assert(expiredObstacles[0].obstacleInstanceCount == 4);
+  assert(tracker.IsEmpty());
+}
+
+} // anon namespace
+
+int main()
+{
+  TestOverlappingApply();
+  TestRefresh();
+  TestExpiryBoundary();
+}
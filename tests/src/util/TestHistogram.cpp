@@ -0,0 +1,115 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include <libserver/util/Histogram.hpp>
+
+#include <cassert>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+void TestBuckets()
+{
+  using server::util::Histogram;
+
+  // Every bucket's upper bound maps back to the bucket,
+  // and the next value maps to the next bucket.
+  for (uint32_t bucketIdx = 0; bucketIdx < Histogram::BucketCount - 1; ++bucketIdx)
+  {
+    const auto upperBound = Histogram::GetBucketUpperBound(bucketIdx);
+    assert(Histogram::GetBucketIndex(upperBound) == bucketIdx);
+    assert(Histogram::GetBucketIndex(upperBound + 1) == bucketIdx + 1);
+  }
+
+  // Values above the highest magnitude are clamped to the last bucket.
+  assert(Histogram::GetBucketIndex(std::numeric_limits<uint64_t>::max())
+    == Histogram::BucketCount - 1);
+}
+
+void TestPercentiles()
+{
+  server::util::Histogram histogram;
+
+  const auto emptySnapshot = histogram.GetSnapshot();
+  assert(emptySnapshot.count == 0);
+  assert(emptySnapshot.GetPercentile(50.0) == 0);
+
+  for (uint64_t value = 1; value <= 10'000; ++value)
+    histogram.Record(value);
+
+  const auto snapshot = histogram.GetSnapshot();
+  assert(snapshot.count == 10'000);
+  assert(snapshot.sum == 10'000ull * 10'001ull / 2);
+  assert(snapshot.max == 10'000);
+
+  // Within the relative error of the sub-buckets.
+  const auto withinError = [](uint64_t actual, uint64_t expected)
+  {
+    const auto error = expected / server::util::Histogram::SubBucketCount;
+    return actual >= expected && actual <= expected + error;
+  };
+
+  assert(withinError(snapshot.GetPercentile(50.0), 5'000));
+  assert(withinError(snapshot.GetPercentile(99.0), 9'900));
+  assert(snapshot.GetPercentile(100.0) == 10'000);
+
+  // Clamped values report the maximum.
+  histogram.Record(std::numeric_limits<uint64_t>::max() / 2);
+  assert(histogram.GetSnapshot().GetPercentile(100.0)
+    == std::numeric_limits<uint64_t>::max() / 2);
+}
+
+void TestConcurrentRecording()
+{
+  constexpr uint32_t ThreadCount = 4;
+  constexpr uint32_t RecordCount = 100'000;
+
+  server::util::Histogram histogram;
+
+  std::vector<std::thread> threads;
+  for (uint32_t threadIdx = 0; threadIdx < ThreadCount; ++threadIdx)
+  {
+    threads.emplace_back([&histogram, threadIdx]()
+    {
+      std::mt19937 generator(threadIdx);
+      std::uniform_int_distribution<uint64_t> valueDistribution(0, 1'000'000);
+      for (uint32_t recordIdx = 0; recordIdx < RecordCount; ++recordIdx)
+        histogram.Record(valueDistribution(generator));
+    });
+  }
+
+  for (auto& thread : threads)
+    thread.join();
+
+  assert(histogram.GetCount() == ThreadCount * RecordCount);
+  assert(histogram.GetSnapshot().count == ThreadCount * RecordCount);
+}
+
+} // anon namespace
+
+int main()
+{
+  TestBuckets();
+  TestPercentiles();
+  TestConcurrentRecording();
+}
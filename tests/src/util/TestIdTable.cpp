@@ -0,0 +1,115 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include <libserver/util/IdTable.hpp>
+
+#include <cassert>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+namespace
+{
+
+void TestDenseTable()
+{
+  std::vector<std::pair<uint32_t, std::string>> entries;
+  for (uint32_t id = 2; id <= 25; ++id)
+    entries.emplace_back(id, std::to_string(id));
+
+  const server::util::IdTable<std::string> table(std::move(entries));
+  assert(table.IsDense());
+  assert(table.Size() == 24);
+
+  for (uint32_t id = 2; id <= 25; ++id)
+  {
+    const auto value = table.Find(id);
+    assert(value != nullptr && *value == std::to_string(id));
+  }
+
+  // IDs outside the range, including the ones below the minimum ID.
+  assert(table.Find(0) == nullptr);
+  assert(table.Find(1) == nullptr);
+  assert(table.Find(26) == nullptr);
+  assert(table.Find(std::numeric_limits<uint32_t>::max()) == nullptr);
+}
+
+void TestSparseTable()
+{
+  constexpr uint32_t IdCount = 2048;
+
+  std::mt19937 generator(0xA11C1A);
+  std::uniform_int_distribution<uint32_t> idDistribution;
+
+  std::unordered_map<uint32_t, uint32_t> expected;
+  std::vector<std::pair<uint32_t, uint32_t>> entries;
+  while (expected.size() < IdCount)
+  {
+    const auto id = idDistribution(generator);
+    if (expected.try_emplace(id, id ^ 0xFFu).second)
+      entries.emplace_back(id, id ^ 0xFFu);
+  }
+
+  const server::util::IdTable<uint32_t> table(std::move(entries));
+  assert(not table.IsDense());
+  assert(table.Size() == IdCount);
+
+  for (const auto& [id, value] : expected)
+  {
+    const auto found = table.Find(id);
+    assert(found != nullptr && *found == value);
+  }
+
+  // The IDs and the values correspond to each other.
+  for (std::size_t idx = 0; idx < table.Size(); ++idx)
+    assert(table.GetValues()[idx] == (table.GetIds()[idx] ^ 0xFFu));
+
+  // IDs missing from the table.
+  for (uint32_t attempt = 0; attempt < IdCount; ++attempt)
+  {
+    const auto id = idDistribution(generator);
+    assert(table.Contains(id) == expected.contains(id));
+  }
+}
+
+void TestDuplicateIds()
+{
+  const server::util::IdTable<uint32_t> table({{10002, 1}, {99185, 2}, {10002, 3}});
+  assert(table.Size() == 2);
+  assert(*table.Find(10002) == 1);
+  assert(*table.Find(99185) == 2);
+}
+
+void TestEmptyTable()
+{
+  const server::util::IdTable<uint32_t> table;
+  assert(table.Empty());
+  assert(table.Find(0) == nullptr);
+  assert(table.Find(1) == nullptr);
+}
+
+} // namespace
+
+int main()
+{
+  TestDenseTable();
+  TestSparseTable();
+  TestDuplicateIds();
+  TestEmptyTable();
+}
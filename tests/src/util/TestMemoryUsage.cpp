@@ -0,0 +1,121 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+
+#include <libserver/util/MemoryUsage.hpp>
+
+#include <cassert>
+#include <chrono>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+void TestEstimates()
+{
+  using namespace server::util;
+
+  // Short strings fit the small string buffer.
+  const std::string shortString = "alicia";
+  assert(EstimateHeapSize(shortString) == 0);
+
+  const std::string longString(256, 'a');
+  assert(EstimateHeapSize(longString) >= longString.capacity());
+
+  // Trivially copyable values own no heap memory.
+  assert(EstimateHeapSize(42u) == 0);
+
+  std::vector<uint32_t> emptyVector;
+  assert(EstimateHeapSize(emptyVector) == 0);
+
+  const std::vector<uint32_t> vector(100);
+  assert(EstimateHeapSize(vector) >= 100 * sizeof(uint32_t));
+  assert(EstimateHeapSize(vector) == EstimateContainerHeapSize(vector));
+
+  // Nested containers add the heap of their elements.
+  std::map<std::string, std::vector<uint32_t>> map;
+  map[std::string(64, 'k')] = vector;
+  map["short"] = {};
+
+  const auto mapSize = EstimateHeapSize(map);
+  assert(mapSize >= EstimateContainerHeapSize(map) + EstimateHeapSize(vector) + 64);
+  assert(mapSize == EstimateContainerHeapSize(map)
+    + EstimateHeapSize(map.begin()->first)
+    + EstimateHeapSize(map.begin()->second)
+    + EstimateHeapSize(map.rbegin()->second));
+}
+
+void TestReports()
+{
+  using namespace server::util;
+
+  const MemoryUsageReport report{
+    {"first", MemoryUsage{.count = 2, .bytes = 100}},
+    {"second", MemoryUsage{.count = 3, .bytes = 50}}};
+
+  const auto total = GetTotal(report);
+  assert(total.count == 5);
+  assert(total.bytes == 150);
+
+  assert(FormatBytes(512) == "512 B");
+  assert(FormatBytes(1536) == "1.5 KiB");
+  assert(FormatBytes(3ull * 1024 * 1024) == "3.0 MiB");
+}
+
+void TestAccounting()
+{
+  using namespace server::util;
+  using namespace std::chrono_literals;
+
+  MemoryAccounting accounting;
+
+  // Components without a report are due.
+  assert(accounting.IsReportDue("lobby", 1h));
+
+  accounting.Publish("lobby", {{"users", MemoryUsage{.count = 1, .bytes = 64}}});
+  assert(not accounting.IsReportDue("lobby", 1h));
+  assert(accounting.IsReportDue("lobby", 0s));
+
+  const auto reports = accounting.GetReports();
+  assert(reports.size() == 1);
+  assert(reports.at("lobby").report.front().first == "users");
+  assert(reports.at("lobby").report.front().second.bytes == 64);
+
+  // Requested reports are due regardless of the interval.
+  std::this_thread::sleep_for(1ms);
+  accounting.RequestReports();
+  assert(accounting.IsReportDue("lobby", 1h));
+
+  std::this_thread::sleep_for(1ms);
+  accounting.Publish("lobby", {});
+  assert(not accounting.IsReportDue("lobby", 1h));
+  assert(accounting.GetReports().at("lobby").report.empty());
+}
+
+} // anon namespace
+
+int main()
+{
+  TestEstimates();
+  TestReports();
+  TestAccounting();
+}
@@ -0,0 +1,152 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include <libserver/util/SlabPool.hpp>
+
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+using server::util::SlabPool;
+
+void TestSizeClasses()
+{
+  assert(SlabPool::GetBlockSize(0) == SlabPool::MinBlockSize);
+  assert(SlabPool::GetBlockSize(1) == SlabPool::MinBlockSize);
+  assert(SlabPool::GetBlockSize(512) == 512);
+  assert(SlabPool::GetBlockSize(513) == 1024);
+  assert(SlabPool::GetBlockSize(SlabPool::MaxBlockSize) == SlabPool::MaxBlockSize);
+
+  SlabPool pool;
+
+  bool threw = false;
+  try
+  {
+    [[maybe_unused]] const auto block = pool.Acquire(SlabPool::MaxBlockSize + 1);
+  }
+  catch (const std::length_error&)
+  {
+    threw = true;
+  }
+  assert(threw);
+}
+
+void TestAcquireRelease()
+{
+  SlabPool pool;
+
+  {
+    auto first = pool.Acquire(1000);
+    auto second = pool.Acquire(1000);
+    assert(first.GetSize() == 1024);
+    assert(first.GetData() != second.GetData());
+
+    // The blocks are usable memory.
+    std::memset(first.GetData(), 0xAA, first.GetSize());
+    std::memset(second.GetData(), 0xBB, second.GetSize());
+    assert(first.GetData()[first.GetSize() - 1] == std::byte{0xAA});
+
+    const auto statistics = pool.GetStatistics();
+    assert(statistics.slabCount == 1);
+    assert(statistics.residentBytes == SlabPool::SlabSize);
+    assert(statistics.usedBlocks == 2);
+    assert(statistics.usedBytes == 2048);
+
+    // Moving transfers the ownership.
+    auto moved = std::move(first);
+    assert(not first);
+    assert(moved);
+
+    // A released block is reused.
+    const auto data = second.GetData();
+    second.Reset();
+    assert(not second);
+    const auto reused = pool.Acquire(1024);
+    assert(reused.GetData() == data);
+  }
+
+  const auto statistics = pool.GetStatistics();
+  assert(statistics.usedBlocks == 0);
+  assert(statistics.usedBytes == 0);
+  // A single empty slab is kept.
+  assert(statistics.slabCount == 1);
+}
+
+void TestSlabRelease()
+{
+  SlabPool pool;
+
+  const size_t blocksPerSlab = SlabPool::SlabSize / SlabPool::MaxBlockSize;
+
+  std::vector<SlabPool::Block> blocks;
+  for (size_t idx = 0; idx < blocksPerSlab * 4; ++idx)
+    blocks.emplace_back(pool.Acquire(SlabPool::MaxBlockSize));
+  assert(pool.GetStatistics().slabCount == 4);
+
+  // Emptied slabs are freed, but one.
+  blocks.clear();
+  assert(pool.GetStatistics().slabCount == 1);
+
+  // The empty slab is reused.
+  const auto block = pool.Acquire(SlabPool::MaxBlockSize);
+  assert(pool.GetStatistics().slabCount == 1);
+}
+
+void TestConcurrentRelease()
+{
+  SlabPool pool;
+
+  std::vector<std::thread> threads;
+  for (size_t thread = 0; thread < 4; ++thread)
+  {
+    threads.emplace_back([&pool, thread]()
+    {
+      std::vector<SlabPool::Block> blocks;
+      for (size_t iteration = 0; iteration < 10'000; ++iteration)
+      {
+        blocks.emplace_back(pool.Acquire(512 << ((iteration + thread) % 8)));
+        if (blocks.size() > 32)
+          blocks.erase(blocks.begin(), blocks.begin() + 16);
+      }
+    });
+  }
+
+  for (auto& thread : threads)
+    thread.join();
+
+  const auto statistics = pool.GetStatistics();
+  assert(statistics.usedBlocks == 0);
+  assert(statistics.usedBytes == 0);
+  assert(statistics.slabCount <= 8);
+}
+
+} // anon namespace
+
+int main()
+{
+  TestSizeClasses();
+  TestAcquireRelease();
+  TestSlabRelease();
+  TestConcurrentRelease();
+}
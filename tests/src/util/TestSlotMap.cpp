@@ -0,0 +1,233 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include <libserver/util/SlotMap.hpp>
+
+#include <array>
+#include <cassert>
+#include <random>
+#include <thread>
+
+namespace
+{
+
+using SlotMap = server::util::ConcurrentSlotMap<struct Object>;
+
+//! Count of the objects alive.
+std::atomic<int64_t> aliveCount{0};
+
+//! An object which records its destruction.
+struct Object
+{
+  static constexpr uint64_t Alive = 0xA11CEA11CE;
+  static constexpr uint64_t Destroyed = 0xDEADDEAD;
+
+  explicit Object(const SlotMap::Id id)
+    : id(id)
+  {
+    ++aliveCount;
+  }
+
+  ~Object()
+  {
+    magic = Destroyed;
+    --aliveCount;
+  }
+
+  SlotMap::Id id;
+  std::atomic<uint64_t> magic{Alive};
+  std::atomic<uint64_t> sendCount{0};
+};
+
+const auto makeObject = [](const SlotMap::Id id)
+{
+  return std::make_shared<Object>(id);
+};
+
+void TestSlotMap()
+{
+  SlotMap slotMap(2);
+
+  const auto first = slotMap.Emplace(makeObject);
+  const auto second = slotMap.Emplace(makeObject);
+  assert(first && second && *first != *second);
+  assert(slotMap.GetSize() == 2);
+
+  // The map is full.
+  const auto overflow = slotMap.Emplace(makeObject);
+  assert(not overflow);
+
+  bool isVisited = slotMap.Visit(*first, [&first](Object& object)
+  {
+    assert(object.id == *first);
+  });
+  assert(isVisited);
+
+  bool isErased = slotMap.Erase(*first);
+  assert(isErased);
+  isErased = slotMap.Erase(*first);
+  assert(not isErased);
+  assert(slotMap.GetSize() == 1);
+
+  // The erased ID is stale, also once its slot is reused.
+  const auto reused = slotMap.Emplace(makeObject);
+  assert(reused && *reused != *first);
+  isVisited = slotMap.Visit(*first, [](Object&)
+  {
+    assert(false);
+  });
+  assert(not isVisited);
+  const auto staleObject = slotMap.Get(*first);
+  assert(not staleObject);
+  const auto reusedObject = slotMap.Get(*reused);
+  assert(reusedObject and reusedObject->id == *reused);
+
+  size_t visitedCount = 0;
+  slotMap.ForEach([&visitedCount](const SlotMap::Id id, const Object& object)
+  {
+    assert(object.id == id);
+    ++visitedCount;
+  });
+  assert(visitedCount == 2);
+
+  // Out of range indices.
+  isVisited = slotMap.Visit(0xFFFF'FFFF, [](Object&) {});
+  assert(not isVisited);
+}
+
+void TestReclamation()
+{
+  SlotMap slotMap(1);
+  const auto id = slotMap.Emplace(makeObject);
+  std::weak_ptr<Object> weakObject = slotMap.Get(*id);
+
+  std::atomic_bool isVisiting{false};
+  std::atomic_bool shouldFinish{false};
+
+  std::thread visitor([&]()
+  {
+    slotMap.Visit(*id, [&](Object& object)
+    {
+      isVisiting = true;
+      while (not shouldFinish)
+        std::this_thread::yield();
+
+      // Still alive, even though erased.
+      assert(object.magic == Object::Alive);
+    });
+  });
+
+  while (not isVisiting)
+    std::this_thread::yield();
+
+  // The visitor keeps the erased object alive.
+  const bool isErased = slotMap.Erase(*id);
+  assert(isErased);
+  assert(slotMap.GetRetiredCount() == 1);
+  assert(not weakObject.expired());
+
+  shouldFinish = true;
+  visitor.join();
+
+  slotMap.Reclaim();
+  assert(slotMap.GetRetiredCount() == 0);
+  assert(weakObject.expired());
+}
+
+//! Connects and disconnects race against the sends of other threads.
+void TestStress()
+{
+  constexpr size_t Capacity = 64;
+  constexpr size_t SenderCount = 4;
+  constexpr size_t ChurnCount = 200'000;
+
+  {
+    SlotMap slotMap(Capacity);
+
+    // IDs the senders send to, some of them stale.
+    std::array<std::atomic<SlotMap::Id>, Capacity> ids{};
+    std::atomic_bool shouldRun{true};
+    std::atomic<uint64_t> sentCount{0};
+    std::atomic<uint64_t> staleCount{0};
+
+    std::vector<std::thread> senders;
+    for (size_t senderIdx = 0; senderIdx < SenderCount; ++senderIdx)
+    {
+      senders.emplace_back([&, senderIdx]()
+      {
+        std::mt19937 generator(senderIdx);
+        std::uniform_int_distribution<size_t> idxDistribution(0, Capacity - 1);
+
+        while (shouldRun.load(std::memory_order::relaxed))
+        {
+          const auto id = ids[idxDistribution(generator)].load(std::memory_order::relaxed);
+          const bool isSent = slotMap.Visit(id, [id](Object& object)
+          {
+            assert(object.magic == Object::Alive);
+            assert(object.id == id);
+            object.sendCount.fetch_add(1, std::memory_order::relaxed);
+          });
+
+          if (isSent)
+            sentCount.fetch_add(1, std::memory_order::relaxed);
+          else
+            staleCount.fetch_add(1, std::memory_order::relaxed);
+        }
+      });
+    }
+
+    // The owner thread connects and disconnects.
+    std::mt19937 generator(0xA11C1A);
+    std::uniform_int_distribution<size_t> idxDistribution(0, Capacity - 1);
+    for (size_t churnIdx = 0; churnIdx < ChurnCount; ++churnIdx)
+    {
+      const auto idx = idxDistribution(generator);
+      if (slotMap.Erase(ids[idx].load(std::memory_order::relaxed)))
+        continue;
+
+      if (const auto id = slotMap.Emplace(makeObject))
+        ids[idx].store(*id, std::memory_order::relaxed);
+
+      if (churnIdx % 1024 == 0)
+        slotMap.Reclaim();
+    }
+
+    shouldRun = false;
+    for (auto& sender : senders)
+      sender.join();
+
+    assert(sentCount > 0);
+    assert(staleCount > 0);
+
+    slotMap.Reclaim();
+    assert(slotMap.GetRetiredCount() == 0);
+    assert(aliveCount == static_cast<int64_t>(slotMap.GetSize()));
+  }
+
+  assert(aliveCount == 0);
+}
+
+} // anon namespace
+
+int main()
+{
+  TestSlotMap();
+  TestReclamation();
+  TestStress();
+}
@@ -0,0 +1,139 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include <libserver/util/Snapshot.hpp>
+
+#include <cassert>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+//! A value whose consistency is checked by the readers.
+struct Value
+{
+  Value(const uint64_t version)
+    : version(version)
+    , text(std::to_string(version))
+    , history(version % 64, version)
+  {
+  }
+
+  uint64_t version;
+  std::string text;
+  std::vector<uint64_t> history;
+};
+
+void TestSnapshot()
+{
+  server::util::SnapshotCell<Value> cell;
+
+  // Nothing is read before the first snapshot is published.
+  bool isRead = cell.Read([](const Value&)
+  {
+    assert(false);
+  });
+  assert(not isRead);
+
+  cell.Publish(Value(1));
+  isRead = cell.Read([](const Value& value)
+  {
+    assert(value.version == 1);
+  });
+  assert(isRead);
+
+  // With no reader the replaced snapshot is reclaimed right away.
+  cell.Publish(Value(2));
+  assert(cell.GetRetiredCount() == 0);
+
+  // A replaced snapshot stays alive while it is read.
+  cell.Read([&cell](const Value& value)
+  {
+    cell.Publish(Value(3));
+    assert(cell.GetRetiredCount() == 1);
+    assert(value.version == 2 && value.text == "2");
+  });
+
+  cell.Publish(Value(4));
+  assert(cell.GetRetiredCount() == 0);
+
+  // A replaced snapshot is reclaimed between the publishes once it is no longer read.
+  cell.Read([&cell](const Value&)
+  {
+    cell.Publish(Value(5));
+    const bool isReclaimed = cell.Reclaim();
+    assert(not isReclaimed);
+  });
+  assert(cell.GetRetiredCount() == 1);
+  const bool isReclaimed = cell.Reclaim();
+  assert(isReclaimed);
+  assert(cell.GetRetiredCount() == 0);
+}
+
+void TestStress()
+{
+  constexpr size_t ReaderCount = 4;
+  constexpr uint64_t VersionCount = 20'000;
+
+  server::util::SnapshotCell<Value> cell;
+  cell.Publish(Value(0));
+
+  std::atomic_bool isDone{false};
+  std::vector<std::thread> readers;
+  for (size_t idx = 0; idx < ReaderCount; ++idx)
+  {
+    readers.emplace_back([&cell, &isDone]()
+    {
+      uint64_t lastVersion = 0;
+      while (not isDone.load(std::memory_order::relaxed))
+      {
+        cell.Read([&lastVersion](const Value& value)
+        {
+          // The snapshot is consistent and never older than one read before.
+          assert(value.version >= lastVersion);
+          assert(value.text == std::to_string(value.version));
+          assert(value.history.size() == value.version % 64);
+          for (const auto entry : value.history)
+            assert(entry == value.version);
+          lastVersion = value.version;
+        });
+      }
+    });
+  }
+
+  for (uint64_t version = 1; version <= VersionCount; ++version)
+    cell.Publish(Value(version));
+
+  isDone = true;
+  for (auto& reader : readers)
+    reader.join();
+
+  cell.Publish(Value(VersionCount + 1));
+  assert(cell.GetRetiredCount() == 0);
+}
+
+} // anon namespace
+
+int main()
+{
+  TestSnapshot();
+  TestStress();
+}
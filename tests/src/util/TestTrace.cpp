@@ -0,0 +1,168 @@
+/**
+ * Alicia Server - dedicated server software
+ * Copyright (C) 2024 Story Of Alicia
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ **/
+
+#include <libserver/util/Trace.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+namespace
+{
+
+namespace trace = server::util::trace;
+
+//! Dumps the trace and returns the parsed spans, without the thread metadata.
+nlohmann::json DumpSpans(size_t& threadNameCount)
+{
+  const auto path = std::filesystem::temp_directory_path() / "alicia_test_trace.json";
+  const auto spanCount = trace::Dump(path);
+
+  std::ifstream file(path);
+  const auto json = nlohmann::json::parse(file);
+  file.close();
+  std::filesystem::remove(path);
+
+  threadNameCount = 0;
+  nlohmann::json spans = nlohmann::json::array();
+  for (const auto& event : json.at("traceEvents"))
+  {
+    if (event.at("ph") == "M")
+    {
+      ++threadNameCount;
+      continue;
+    }
+
+    assert(event.at("ph") == "X");
+    assert(event.at("dur").get<double>() >= 0.0);
+    spans.push_back(event);
+  }
+
+  assert(spans.size() == spanCount);
+  return spans;
+}
+
+void TestDisabled()
+{
+  trace::Clear();
+  trace::SetEnabled(false);
+
+  {
+    const trace::Span span("test", "disabled");
+  }
+
+  // The name of a disabled span is not looked up.
+  bool isNameSupplied = false;
+  {
+    const trace::Span span("test", [&isNameSupplied]()
+    {
+      isNameSupplied = true;
+      return std::string_view("supplied");
+    });
+  }
+  assert(not isNameSupplied);
+
+  size_t threadNameCount = 0;
+  assert(DumpSpans(threadNameCount).empty());
+}
+
+void TestSuppliedName()
+{
+  trace::Clear();
+  trace::SetEnabled(true);
+
+  std::thread([]()
+  {
+    const trace::Span span("test", []()
+    {
+      return std::string_view("supplied");
+    });
+  }).join();
+
+  trace::SetEnabled(false);
+
+  size_t threadNameCount = 0;
+  const auto spans = DumpSpans(threadNameCount);
+  assert(spans.size() == 1);
+  assert(spans[0].at("name") == "supplied");
+  trace::Clear();
+}
+
+void TestRecording()
+{
+  trace::Clear();
+  trace::SetEnabled(true);
+  trace::SetBufferCapacity(16);
+
+  // The thread records more spans than its buffer holds,
+  // only the newest spans are kept.
+  std::thread([]()
+  {
+    trace::SetThreadName("test \"thread\"");
+    for (int idx = 0; idx < 20; ++idx)
+    {
+      const trace::Span outer("test", "outer");
+      const trace::Span inner("test", "inner");
+    }
+  }).join();
+
+  trace::SetEnabled(false);
+
+  size_t threadNameCount = 0;
+  const auto spans = DumpSpans(threadNameCount);
+  assert(spans.size() == 16);
+  assert(threadNameCount == 1);
+
+  // Inner spans end first, the spans are in the order of their ends.
+  for (size_t idx = 0; idx < spans.size(); ++idx)
+  {
+    assert(spans[idx].at("cat") == "test");
+    assert(spans[idx].at("name") == (idx % 2 == 0 ? "inner" : "outer"));
+  }
+
+  // Outer spans enclose the inner spans.
+  const auto begin = [](const nlohmann::json& span)
+  {
+    return span.at("ts").get<double>();
+  };
+  const auto end = [&begin](const nlohmann::json& span)
+  {
+    return begin(span) + span.at("dur").get<double>();
+  };
+  assert(begin(spans[1]) <= begin(spans[0]));
+  assert(end(spans[1]) >= end(spans[0]));
+
+  // Buffers of the ended threads are forgotten by clearing.
+  trace::Clear();
+  assert(DumpSpans(threadNameCount).empty());
+  assert(threadNameCount == 0);
+}
+
+} // anon namespace
+
+int main()
+{
+  TestDisabled();
+  TestSuppliedName();
+  TestRecording();
+}